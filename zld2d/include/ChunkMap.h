@@ -0,0 +1,183 @@
+﻿//-----------------------------------------------------------------------------
+// File : ChunkMap.h
+// Desc : Chunked Tile Map.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <MapTile.h>
+#include <MapCamera.h>
+#include <TileCache.h>
+
+
+//-----------------------------------------------------------------------------
+// Forward Declarations.
+//-----------------------------------------------------------------------------
+class SpriteSystem;
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const int32_t  kChunkShift       = 4;
+static const int32_t  kChunkSize        = 1 << kChunkShift;         // 1チャンクの縦横タイル数.
+static const int32_t  kChunkMask        = kChunkSize - 1;
+static const uint32_t kChunkTileCount   = kChunkSize * kChunkSize;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TileChunk structure
+///////////////////////////////////////////////////////////////////////////////
+struct TileChunk
+{
+    Tile        Tiles[kChunkTileCount];     //!< タイル配列. 行優先.
+    int32_t     ChunkX;                     //!< チャンク座標X.
+    int32_t     ChunkY;                     //!< チャンク座標Y.
+    uint32_t    VisibleFrame;               //!< 最後に表示範囲に入った Cull() の通し番号.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ChunkMap class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      16x16 タイルのチャンク単位で持つ大きなタイルマップです.
+//!
+//! @note       タイル座標は32bit符号付きです. 書き込んだ範囲のチャンクだけを確保し，
+//!             確保していない場所は SetEmptyTile() で設定したタイルとして扱います.
+//!             Cull() で表示範囲に掛かるチャンクを求め，描画と更新はその範囲だけ行います.
+///////////////////////////////////////////////////////////////////////////////
+class ChunkMap
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    ChunkMap();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~ChunkMap();
+
+    //-------------------------------------------------------------------------
+    //! @brief      全てのチャンクを破棄します.
+    //-------------------------------------------------------------------------
+    void Clear();
+
+    //-------------------------------------------------------------------------
+    //! @brief      チャンクが無い場所のタイルを設定します.
+    //!
+    //! @note       チャンクを確保した時の初期値にもなります.
+    //-------------------------------------------------------------------------
+    void SetEmptyTile(const Tile& value);
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイルを設定します. 必要ならチャンクを確保します.
+    //-------------------------------------------------------------------------
+    void SetTile(int32_t tileX, int32_t tileY, const Tile& value);
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイル配列を貼り付けます.
+    //!
+    //! @param[in]      tileX       貼り付け先の左端のタイル座標.
+    //! @param[in]      tileY       貼り付け先の上端のタイル座標.
+    //! @param[in]      pTiles      タイル配列. 行優先.
+    //! @param[in]      w           横方向のタイル数.
+    //! @param[in]      h           縦方向のタイル数.
+    //! @note       部屋単位のマップ(kTileCountX x kTileCountY)を並べる時などに使います.
+    //-------------------------------------------------------------------------
+    void Paste(int32_t tileX, int32_t tileY, const Tile* pTiles, uint32_t w, uint32_t h);
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイルを取得します.
+    //-------------------------------------------------------------------------
+    const Tile& GetTile(int32_t tileX, int32_t tileY) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      チャンクを検索します.
+    //!
+    //! @return     確保していなければ nullptr を返却します.
+    //-------------------------------------------------------------------------
+    const TileChunk* FindChunk(int32_t chunkX, int32_t chunkY) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      表示範囲に掛かるチャンクを求めます.
+    //!
+    //! @param[in]      camera      カメラ.
+    //! @param[in]      margin      表示範囲の外側に含めるタイル数. 画面外の更新に使います.
+    //-------------------------------------------------------------------------
+    void Cull(const MapCamera& camera, int32_t margin);
+
+    //-------------------------------------------------------------------------
+    //! @brief      Cull() で求めたチャンクを取得します.
+    //-------------------------------------------------------------------------
+    const std::vector<const TileChunk*>& GetVisibleChunks() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイルが最後の Cull() の範囲に入っているかどうか?
+    //!
+    //! @note       範囲外のタイルにいるものは更新を止めてかまいません.
+    //-------------------------------------------------------------------------
+    bool IsActive(int32_t tileX, int32_t tileY) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      Cull() で求めた範囲のうち画面に掛かるタイルを描画します.
+    //!
+    //! @param[in]      sprite      スプライトシステム.
+    //! @param[in]      camera      Cull() に渡したカメラ.
+    //! @param[in]      resolver    テクスチャ番号からテクスチャ領域を引く関数.
+    //! @param[in]      playerY     前後関係を決めるキャラのY座標.
+    //-------------------------------------------------------------------------
+    void Draw(SpriteSystem& sprite, const MapCamera& camera, TileTextureResolver resolver, int playerY);
+
+    //-------------------------------------------------------------------------
+    //! @brief      確保しているチャンク数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetChunkCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      チャンクが使っているおおよそのメモリ量を取得します. 診断用です.
+    //-------------------------------------------------------------------------
+    size_t GetMemorySize() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::unordered_map<uint64_t, std::unique_ptr<TileChunk>>    m_Chunks;
+    std::vector<const TileChunk*>                               m_Visible;
+    std::vector<SpriteInstance>                                 m_Instances;    // 描画用の作業領域.
+    std::vector<ID3D11ShaderResourceView*>                      m_Textures;     // 描画用の作業領域.
+    Tile                                                        m_Empty;
+    uint32_t                                                    m_Frame;
+    TileRect                                                    m_Active;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    TileChunk* GetOrCreate(int32_t chunkX, int32_t chunkY);
+
+    ChunkMap            (const ChunkMap&) = delete;     // アクセス禁止.
+    ChunkMap& operator= (const ChunkMap&) = delete;     // アクセス禁止.
+};
@@ -68,7 +68,7 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      初期化処理を行います.
     //-------------------------------------------------------------------------
-    bool Init(IDWriteFactory* pFactory, ID2D1DeviceContext* pContext);
+    bool Init(IDWriteFactory* pFactory);
 
     //-------------------------------------------------------------------------
     //! @brief      終了処理を行います.
@@ -83,7 +83,7 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      会話メッセージを表示します.
     //-------------------------------------------------------------------------
-    void DrawMsg(ID2D1DeviceContext* context, bool upper = false);
+    void DrawMsg(SpriteSystem& sprite, bool upper = false);
 
     //-------------------------------------------------------------------------
     //! @brief      メッセージ受信時の処理です.
@@ -112,9 +112,9 @@ private:
     bool                m_IsDraw        = false;
     uint32_t            m_ScenarioId    = 0;
     uint32_t            m_EventId       = 0;
-    ID2D1DeviceContext* m_pContext      = nullptr;
 
     TextWriter                          m_Writer;
+    TextLayoutCache                     m_Layouts;  // シナリオを読み込むまで保持する.
     std::map<uint32_t, EventRecord>     m_Table;
 
     //=========================================================================
@@ -124,18 +124,29 @@ private:
     ///------------------------------------------------------------------------
     //! @brief      選択枝無しの会話メッセージを表示します.
     //-------------------------------------------------------------------------
-    void DrawEventMsg(const wchar_t* msg, bool upper);
+    void DrawEventMsg(SpriteSystem& sprite, const wchar_t* msg, bool upper);
 
     //-------------------------------------------------------------------------
     //! @brief      2択の会話メッセージを表示します.
     //-------------------------------------------------------------------------
     void DrawChoices2(
+        SpriteSystem&   sprite,
         const wchar_t*  msg,
         const wchar_t*  optionA,
         const wchar_t*  optionB,
         uint8_t         cursor,
         bool            upper);
 
+    //-------------------------------------------------------------------------
+    //! @brief      テキストを折り返して複数行に表示します.
+    //-------------------------------------------------------------------------
+    void DrawLines(
+        SpriteSystem&   sprite,
+        const wchar_t*  text,
+        int             firstLine,
+        uint32_t        maxLines,
+        bool            upper);
+
     //-------------------------------------------------------------------------
     //! @brief      シナリオをロードします.
     //-------------------------------------------------------------------------
@@ -17,7 +17,10 @@
 #include <asdxShader.h>
 #include <Player.h>
 #include <SpriteSystem.h>
+#include <SpriteBackendD3D11.h>
+#include <SpriteAnimation.h>
 #include <MapSystem.h>
+#include <MapWorld.h>
 #include <Hud.h>
 //#include <enemy/EnemyTest.h>
 #include <EventSystem.h>
@@ -52,14 +55,16 @@ private:
     // private variables.
     //=========================================================================
     asdx::GamePad               m_Pad;
-    asdx::RefPtr<ID2D1Bitmap1>  m_pBitmap2D;
     Player              m_Player;
+    SpriteBackendD3D11  m_SpriteBackend;
     SpriteSystem        m_Sprite;
+    SpriteAnimLibrary   m_AnimLibrary;
+    SpriteAnimSystem    m_AnimSystem;
     MapSystem           m_MapSystem;
     EventSystem         m_EventSystem;
     //EnemyTest           m_EnemyTest;
     Hud                 m_Hud;
-    MapInstance         m_MapData;
+    MapWorld            m_World;
     Switcher            m_Switcher;
 
     asdx::ColorTarget2D m_SceneColor;
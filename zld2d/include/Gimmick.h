@@ -13,13 +13,20 @@
 #include <UpdateContext.h>
 #include <SpriteSystem.h>
 #include <DirectionState.h>
-#include <MessageMgr.h>
+#include <GimmickGrid.h>
+#include <MapFormat.h>
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // Gimmick class
 ///////////////////////////////////////////////////////////////////////////////
-class Gimmick : public IMessageListener
+//! @brief      ギミックの共通部分です.
+//!
+//! @note       仮想関数は持ちません. ギミックは部屋が種類ごとの GimmickPool に並べて持ち，
+//!             MapSystem が具体的な型で呼び出します. 派生クラスは Reset() などを
+//!             同じ名前で定義し直して振る舞いを変えます.
+///////////////////////////////////////////////////////////////////////////////
+class Gimmick
 {
     //=========================================================================
     // list of friend classes and methods.
@@ -39,12 +46,17 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      コンストラクタです.
     //-------------------------------------------------------------------------
-    Gimmick();
+    explicit Gimmick(MAP_GIMMICK_TYPE type);
 
     //-------------------------------------------------------------------------
     //! @brief      デストラクタです.
     //-------------------------------------------------------------------------
-    virtual ~Gimmick();
+    ~Gimmick();
+
+    //-------------------------------------------------------------------------
+    //! @brief      種類を取得します.
+    //-------------------------------------------------------------------------
+    MAP_GIMMICK_TYPE GetType() const;
 
     //-------------------------------------------------------------------------
     //! @brief      タイル番号から位置を設定します.
@@ -57,32 +69,47 @@ public:
     Gimmick& SetSize(int w, int h);
 
     //-------------------------------------------------------------------------
-    //! @brief      テクスチャを設定します.
+    //! @brief      テクスチャ領域を設定します.
     //-------------------------------------------------------------------------
-    Gimmick& SetSRV(ID3D11ShaderResourceView* pSRV);
+    Gimmick& SetRegion(const TextureRegion& value);
+
+    //-------------------------------------------------------------------------
+    //! @brief      グリッドに登録します. 以降は位置が変わる度に登録し直されます.
+    //-------------------------------------------------------------------------
+    void Attach(GimmickGrid* pGrid);
+
+    //-------------------------------------------------------------------------
+    //! @brief      グリッドから外します.
+    //-------------------------------------------------------------------------
+    void Detach();
 
     //-------------------------------------------------------------------------
     //! @brief      状態をリセットします.
     //-------------------------------------------------------------------------
-    virtual void Reset();
+    void Reset();
 
     //-------------------------------------------------------------------------
     //! @brief      更新処理を行います.
     //-------------------------------------------------------------------------
-    virtual void Update(UpdateContext& context);
+    void Update(UpdateContext& context);
 
     //-------------------------------------------------------------------------
     //! @brief      プレイヤーが移動可能かチェックします.
-    //! 
+    //!
+    //! @note       グリッドで矩形が重なるギミックだけに問い合わせるので，
+    //!             重ならない矩形に対して false を返してはいけません.
     //! @retval true    移動可能です.
     //! @retval false   移動不可能です.
     //-------------------------------------------------------------------------
-    virtual bool CanMove(const Box& playerBox);
+    bool CanMove(const Box& playerBox);
 
     //-------------------------------------------------------------------------
     //! @brief      描画処理を行います.
+    //!
+    //! @param[in]      offsetX     スクロール量X.
+    //! @param[in]      offsetY     スクロール量Y.
     //-------------------------------------------------------------------------
-    virtual void Draw(SpriteSystem& sprite, int layer);
+    void Draw(SpriteSystem& sprite, int offsetX, int offsetY, int layer) const;
 
     //-------------------------------------------------------------------------
     //! @brief      バウンディングボックスを取得します.
@@ -90,22 +117,65 @@ public:
     Box GetBox() const;
 
     //-------------------------------------------------------------------------
-    //! @brief      シェーダリソースビューを取得します.
+    //! @brief      テクスチャ領域を取得します.
     //-------------------------------------------------------------------------
-    ID3D11ShaderResourceView* GetSRV() const;
+    const TextureRegion& GetRegion() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      配置テーブル(MapGimmickDesc)の番号を設定します.
+    //-------------------------------------------------------------------------
+    void SetDescIndex(uint32_t value);
+
+    //-------------------------------------------------------------------------
+    //! @brief      配置テーブル(MapGimmickDesc)の番号を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetDescIndex() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      配置時からの変化を書き出します.
+    //!
+    //! @param[out]     state       変化. Index は呼び出し側で設定します.
+    //! @retval true    配置時から変化している.
+    //! @retval false   配置時のままなので，書き出す必要が無い.
+    //-------------------------------------------------------------------------
+    bool SaveState(MapGimmickState& state) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      SaveState() で書き出した変化を適用します.
+    //!
+    //! @note       配置時の位置を設定した後，グリッドに登録する前に呼び出されます.
+    //-------------------------------------------------------------------------
+    void LoadState(const MapGimmickState& state);
 
 protected:
     //=========================================================================
     // protected variables.
     //=========================================================================
     Box                         m_Box;
-    ID3D11ShaderResourceView*   m_pSRV   = nullptr;
+    TextureRegion               m_Region;
     uint8_t                     m_Flags  = 0;
-    asdx::Vector2               m_Scroll = asdx::Vector2(0.0f, 0.0f);
+    MAP_GIMMICK_TYPE            m_Type;
+    GimmickGrid*                m_pGrid  = nullptr;
+    uint32_t                    m_GridId = kInvalidGridId;
+    uint32_t                    m_DescIndex = UINT32_MAX;
 
     //=========================================================================
     // protected methods.
     //=========================================================================
-    void OnScroll(const Message& msg);
-    void OnScrollCompleted();
+    void UpdateGrid();
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    // グリッドが this を保持し，デストラクタで Detach() するので複製も移動もさせない.
+    Gimmick             (const Gimmick&) = delete;  // アクセス禁止.
+    Gimmick& operator = (const Gimmick&) = delete;  // アクセス禁止.
+    Gimmick             (Gimmick&&) = delete;       // アクセス禁止.
+    Gimmick& operator = (Gimmick&&) = delete;       // アクセス禁止.
 };
@@ -0,0 +1,155 @@
+﻿//-----------------------------------------------------------------------------
+// File : GimmickGrid.h
+// Desc : Uniform Grid for Gimmick Queries.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <Box.h>
+
+
+//-----------------------------------------------------------------------------
+// Forward Declarations.
+//-----------------------------------------------------------------------------
+class Gimmick;
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kInvalidGridId = UINT32_MAX;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GimmickGrid class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      ギミックを矩形が掛かるセルに登録し，矩形と重なるものだけを引く一様グリッドです.
+//!
+//! @note       範囲外の位置は端のセルに丸めて登録するので，部屋の外に出たギミックも引けます.
+//!             ギミックが動いたら Move() で登録し直してください.
+///////////////////////////////////////////////////////////////////////////////
+class GimmickGrid
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    GimmickGrid();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~GimmickGrid();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います. 登録済みのギミックは全て外れます.
+    //!
+    //! @param[in]      originX     左上セルの左端X座標.
+    //! @param[in]      originY     左上セルの上端Y座標.
+    //! @param[in]      cellSize    セルの縦横サイズ(ピクセル).
+    //! @param[in]      countX      横方向のセル数.
+    //! @param[in]      countY      縦方向のセル数.
+    //-------------------------------------------------------------------------
+    void Init(int originX, int originY, int cellSize, uint32_t countX, uint32_t countY);
+
+    //-------------------------------------------------------------------------
+    //! @brief      全ての登録を外します.
+    //-------------------------------------------------------------------------
+    void Clear();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ギミックを登録します.
+    //!
+    //! @return     登録番号を返却します.
+    //-------------------------------------------------------------------------
+    uint32_t Insert(Gimmick* pGimmick, const Box& box);
+
+    //-------------------------------------------------------------------------
+    //! @brief      登録を外します.
+    //-------------------------------------------------------------------------
+    void Remove(uint32_t id);
+
+    //-------------------------------------------------------------------------
+    //! @brief      矩形を更新します. 掛かるセルが変わった時だけ登録し直します.
+    //-------------------------------------------------------------------------
+    void Move(uint32_t id, const Box& box);
+
+    //-------------------------------------------------------------------------
+    //! @brief      矩形と重なるギミックを取得します.
+    //!
+    //! @param[in]      box         検索する矩形.
+    //! @param[out]     result      重なるギミック. 先にクリアされます. 同じギミックは1度だけ入ります.
+    //-------------------------------------------------------------------------
+    void Query(const Box& box, std::vector<Gimmick*>& result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      登録数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCount() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // CellRange structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct CellRange
+    {
+        uint16_t    X0;
+        uint16_t    Y0;
+        uint16_t    X1;     // 含む.
+        uint16_t    Y1;     // 含む.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Entry structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        Gimmick*    pGimmick;   // nullptr なら空き.
+        Box         Bounds;
+        CellRange   Range;
+        uint32_t    Stamp;      // 最後に Query() で見つけた時の通し番号.
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<std::vector<uint32_t>>  m_Cells;
+    std::vector<Entry>                  m_Entries;
+    std::vector<uint32_t>               m_FreeIds;
+    int                                 m_OriginX;
+    int                                 m_OriginY;
+    int                                 m_CellSize;
+    uint32_t                            m_CountX;
+    uint32_t                            m_CountY;
+    uint32_t                            m_Count;
+    uint32_t                            m_Stamp;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    CellRange CalcRange(const Box& box) const;
+    void Link  (uint32_t id, const CellRange& range);
+    void Unlink(uint32_t id, const CellRange& range);
+
+    GimmickGrid            (const GimmickGrid&) = delete;   // アクセス禁止.
+    GimmickGrid& operator= (const GimmickGrid&) = delete;   // アクセス禁止.
+};
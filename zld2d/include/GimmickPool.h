@@ -0,0 +1,137 @@
+﻿//-----------------------------------------------------------------------------
+// File : GimmickPool.h
+// Desc : Contiguous Storage for Gimmicks.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GimmickPool class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      1種類のギミックを連続したメモリに並べて保持します.
+//!
+//! @note       グリッドがギミックのアドレスを保持するので，要素は確保した領域上に
+//!             直接構築し，破棄するまで移動もコピーもしません. Init() で指定した
+//!             容量を超えて追加してはいけません.
+//!             型ごとに保持するので，更新や描画は仮想関数を介さずに呼び出せます.
+///////////////////////////////////////////////////////////////////////////////
+template<typename T>
+class GimmickPool
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    GimmickPool()
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~GimmickPool()
+    { Clear(); }
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います. 保持しているギミックは全て破棄されます.
+    //!
+    //! @param[in]      capacity    保持できる最大数.
+    //-------------------------------------------------------------------------
+    void Init(uint32_t capacity)
+    {
+        Clear();
+
+        // 領域は部屋を入れ替えても使い回す.
+        if (m_BufferSize < capacity)
+        {
+            m_Buffer.reset(new Storage[capacity]);
+            m_BufferSize = capacity;
+        }
+
+        m_Capacity = capacity;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ギミックを破棄します. 領域は解放しません.
+    //-------------------------------------------------------------------------
+    void Clear()
+    {
+        // 追加と逆順に破棄する.
+        while(m_Count > 0)
+        {
+            m_Count--;
+            begin()[m_Count].~T();
+        }
+        m_Capacity = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ギミックを追加します.
+    //-------------------------------------------------------------------------
+    T& Add()
+    {
+        assert(m_Count < m_Capacity);
+        auto item = new (m_Buffer[m_Count].Bytes) T();
+        m_Count++;
+        return *item;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      保持している数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCount() const
+    { return m_Count; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      先頭と末尾を取得します.
+    //-------------------------------------------------------------------------
+    T*       begin()        { return reinterpret_cast<T*>(m_Buffer.get()); }
+    T*       end()          { return begin() + m_Count; }
+    const T* begin() const  { return reinterpret_cast<const T*>(m_Buffer.get()); }
+    const T* end()   const  { return begin() + m_Count; }
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Storage structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Storage
+    {
+        alignas(T) uint8_t  Bytes[sizeof(T)];   // 未構築の要素1つ分の領域.
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::unique_ptr<Storage[]>  m_Buffer;
+    uint32_t                    m_BufferSize = 0;   // 確保済みの要素数.
+    uint32_t                    m_Capacity   = 0;   // Init() で指定された容量.
+    uint32_t                    m_Count      = 0;   // 構築済みの要素数.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    GimmickPool             (const GimmickPool&) = delete;  // アクセス禁止.
+    GimmickPool& operator = (const GimmickPool&) = delete;  // アクセス禁止.
+};
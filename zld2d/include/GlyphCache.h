@@ -0,0 +1,274 @@
+﻿//-----------------------------------------------------------------------------
+// File : GlyphCache.h
+// Desc : Glyph Atlas Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <TextLayout.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GlyphBitmap structure
+///////////////////////////////////////////////////////////////////////////////
+struct GlyphBitmap
+{
+    int32_t                 OffsetX;    //!< ペン位置からビットマップ左端までのオフセット.
+    int32_t                 OffsetY;    //!< ベースラインからビットマップ上端までのオフセット(上が負).
+    uint32_t                Width;      //!< ビットマップの横幅.
+    uint32_t                Height;     //!< ビットマップの縦幅.
+    int32_t                 Advance;    //!< 次の文字までの送り幅.
+    std::vector<uint8_t>    Coverage;   //!< 被覆率(Width x Height).
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// IGlyphRasterizer interface
+///////////////////////////////////////////////////////////////////////////////
+struct IGlyphRasterizer : public ITextMetrics
+{
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    virtual ~IGlyphRasterizer()
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      1文字をラスタライズします.
+    //!
+    //! @param[in]      code        Unicode のコードポイントです.
+    //! @param[out]     result      ラスタライズ結果です. 空白は Width, Height が0になります.
+    //-------------------------------------------------------------------------
+    virtual bool Rasterize(uint32_t code, GlyphBitmap& result) = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      行の上端からベースラインまでの高さを取得します.
+    //-------------------------------------------------------------------------
+    virtual int32_t GetAscent() const = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      行の高さを取得します.
+    //-------------------------------------------------------------------------
+    virtual int32_t GetLineHeight() const = 0;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GlyphCacheDesc structure
+///////////////////////////////////////////////////////////////////////////////
+struct GlyphCacheDesc
+{
+    uint32_t    PageSize;       //!< ページの縦横サイズ.
+    uint32_t    PageCount;      //!< ページ数.
+    uint32_t    CellSize;       //!< 1文字分のセルの縦横サイズ. 縁取りの太さを含みます.
+    uint32_t    OutlineRadius;  //!< 縁取りの太さ.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GlyphEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct GlyphEntry
+{
+    uint32_t    Code;           //!< コードポイント.
+    uint16_t    Page;           //!< ページ番号.
+    uint16_t    Width;          //!< 塗りつぶしの横幅.
+    uint16_t    Height;         //!< 塗りつぶしの縦幅.
+    int16_t     OffsetX;        //!< ペン位置から塗りつぶしの左端までのオフセット.
+    int16_t     OffsetY;        //!< ベースラインから塗りつぶしの上端までのオフセット.
+    int16_t     Advance;        //!< 次の文字までの送り幅.
+    float       FillRect[4];    //!< 塗りつぶしのテクスチャ座標(u0, v0, u1, v1).
+    float       OutlineRect[4]; //!< 縁取りのテクスチャ座標(u0, v0, u1, v1).
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GlyphQuad structure
+///////////////////////////////////////////////////////////////////////////////
+struct GlyphQuad
+{
+    int32_t     X;              //!< 左上X座標.
+    int32_t     Y;              //!< 左上Y座標.
+    int32_t     W;              //!< 横幅.
+    int32_t     H;              //!< 縦幅.
+    uint16_t    Page;           //!< ページ番号.
+    bool        Outline;        //!< 縁取りかどうか?
+    float       TexRect[4];     //!< テクスチャ座標(u0, v0, u1, v1).
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GlyphCache class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      ラスタライズ済みの文字をページ単位のアトラスに保持します.
+//!
+//! @note       1文字につき塗りつぶしと縁取りの2セルを横に並べて確保します.
+//!             全ページが埋まった場合は最も長く使われていないページを丸ごと空けます.
+//!             現在のフレームで使ったページは追い出さないので，表示中の文字が消えることはありません.
+//!             ページの画素は被覆率のみを保持し，GPUへの転送は利用側が GetDirtyRows() を見て行います.
+///////////////////////////////////////////////////////////////////////////////
+class GlyphCache
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    GlyphCache();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~GlyphCache();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      pRasterizer     文字のラスタライザです.
+    //! @param[in]      desc            ページ構成です.
+    //-------------------------------------------------------------------------
+    bool Init(IGlyphRasterizer* pRasterizer, const GlyphCacheDesc& desc);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      フレームを進めます.
+    //!
+    //! @note       同じフレームで使った文字は追い出されません.
+    //-------------------------------------------------------------------------
+    void NewFrame();
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字を検索し，無ければラスタライズして追加します.
+    //!
+    //! @return     追加できない場合は nullptr を返却します.
+    //-------------------------------------------------------------------------
+    const GlyphEntry* Find(uint32_t code);
+
+    //-------------------------------------------------------------------------
+    //! @brief      テキストの横幅を求めます.
+    //-------------------------------------------------------------------------
+    int32_t Measure(const wchar_t* text);
+
+    //-------------------------------------------------------------------------
+    //! @brief      1行分のテキストの矩形を生成します.
+    //!
+    //! @param[in]      text        テキストです.
+    //! @param[in]      x           行の左端です.
+    //! @param[in]      y           行の上端です.
+    //! @param[out]     result      縁取り，塗りつぶしの順に矩形を追加します.
+    //! @return     追加した文字数を返却します.
+    //-------------------------------------------------------------------------
+    uint32_t BuildQuads(const wchar_t* text, int32_t x, int32_t y, std::vector<GlyphQuad>& result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      テキストの一部から1行分の矩形を生成します.
+    //!
+    //! @param[in]      length      テキストの長さ(コードユニット単位)です.
+    //-------------------------------------------------------------------------
+    uint32_t BuildQuads(const wchar_t* text, uint32_t length, int32_t x, int32_t y, std::vector<GlyphQuad>& result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      行の上端からベースラインまでの高さを取得します.
+    //-------------------------------------------------------------------------
+    int32_t GetAscent() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      行の高さを取得します.
+    //-------------------------------------------------------------------------
+    int32_t GetLineHeight() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページ構成を取得します.
+    //-------------------------------------------------------------------------
+    const GlyphCacheDesc& GetDesc() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページの被覆率を取得します(PageSize x PageSize).
+    //-------------------------------------------------------------------------
+    const uint8_t* GetPagePixels(uint32_t page) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページの更新された行範囲を取得します.
+    //!
+    //! @retval true    更新された行があります.
+    //! @retval false   更新された行はありません.
+    //-------------------------------------------------------------------------
+    bool GetDirtyRows(uint32_t page, uint32_t& top, uint32_t& bottom) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページの更新フラグを下ろします.
+    //-------------------------------------------------------------------------
+    void ClearDirty(uint32_t page);
+
+    //-------------------------------------------------------------------------
+    //! @brief      保持している文字数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetGlyphCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページを追い出した回数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetEvictCount() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Page structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Page
+    {
+        std::vector<uint8_t>    Pixels;         // 被覆率.
+        std::vector<uint32_t>   Codes;          // このページに入っている文字.
+        uint64_t                LastUsed;       // 最後に使ったフレーム.
+        uint32_t                DirtyTop;       // 更新された行の先頭.
+        uint32_t                DirtyBottom;    // 更新された行の末尾(含まない).
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    IGlyphRasterizer*                           m_pRasterizer;
+    GlyphCacheDesc                              m_Desc;
+    std::vector<Page>                           m_Pages;
+    std::unordered_map<uint32_t, GlyphEntry>    m_Entries;
+    GlyphBitmap                                 m_Bitmap;       // ラスタライズ用の作業領域.
+    std::vector<GlyphQuad>                      m_FillQuads;    // 縁取りの後ろに並べる塗りつぶし.
+    uint32_t                                    m_SlotColumns;  // 1ページの横に並ぶ文字数.
+    uint32_t                                    m_SlotsPerPage; // 1ページに入る文字数.
+    uint32_t                                    m_FillPage;     // 追加先のページ.
+    uint64_t                                    m_Frame;
+    uint32_t                                    m_EvictCount;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    bool AllocSlot(uint32_t& page, uint32_t& slot);
+    void Evict(uint32_t page);
+    void WriteGlyph(uint32_t page, uint32_t slot, GlyphEntry& entry);
+    void MarkDirty(Page& page, uint32_t top, uint32_t bottom);
+
+    GlyphCache              (const GlyphCache&) = delete;   // アクセス禁止.
+    GlyphCache& operator =  (const GlyphCache&) = delete;   // アクセス禁止.
+};
@@ -10,6 +10,7 @@
 //-----------------------------------------------------------------------------
 #include <SpriteSystem.h>
 #include <Player.h>
+#include <vector>
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -33,16 +34,26 @@ public:
     //=========================================================================
     Hud();
     ~Hud();
+    void Term(SpriteSystem& sprite);
     void Draw(SpriteSystem& sprite, const Player& player);
+    void DrawStats(SpriteSystem& sprite, const SpriteStats& stats);
+    void SetStatsVisible(bool visible);
+    bool IsStatsVisible() const;
 
 private:
     //=========================================================================
     // private variables.
     //=========================================================================
-    /* NOTHING */
+    SpriteRetainedList          m_Life;             // ライフの表示. 変化した時だけ更新する.
+    std::vector<SpriteHandle>   m_LifeHandles;      // 影とハートの順に2つずつ.
+    uint8_t                     m_CurLife;
+    uint8_t                     m_MaxLife;
+    std::vector<SpriteDesc>     m_StatsSprites;
+    bool                        m_StatsVisible;
 
     //=========================================================================
     // private methods.
     //=========================================================================
     void DrawLife(SpriteSystem& sprite, uint8_t curLife, uint8_t maxLife);
+    void UpdateLifeColor(uint8_t curLife);
 };
\ No newline at end of file
@@ -0,0 +1,109 @@
+﻿//-----------------------------------------------------------------------------
+// File : MapCamera.h
+// Desc : Scrolling Camera for Chunked Map.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <MapTile.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TileRect structure
+///////////////////////////////////////////////////////////////////////////////
+struct TileRect
+{
+    int32_t     X;      //!< 左端のタイル座標.
+    int32_t     Y;      //!< 上端のタイル座標.
+    int32_t     W;      //!< 横方向のタイル数.
+    int32_t     H;      //!< 縦方向のタイル数.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MapCamera structure
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      チャンクマップを連続スクロールするカメラです.
+//!
+//! @note       位置はタイル座標とタイル内のピクセル位置に分けて持つので，
+//!             ピクセル座標に直すと int を超える大きなマップでも扱えます.
+///////////////////////////////////////////////////////////////////////////////
+struct MapCamera
+{
+    int32_t     TileX   = 0;                // 左上のタイル座標X.
+    int32_t     TileY   = 0;                // 左上のタイル座標Y.
+    int         SubX    = 0;                // タイル内のピクセル位置X. [0, kTileSize).
+    int         SubY    = 0;                // タイル内のピクセル位置Y. [0, kTileSize).
+    int         Width   = kTileTotalW;      // 表示幅(ピクセル).
+    int         Height  = kTileTotalH;      // 表示高さ(ピクセル).
+    int         ScreenX = kTileOffsetX;     // 表示先の左上X座標.
+    int         ScreenY = kTileOffsetY;     // 表示先の左上Y座標.
+
+    //-------------------------------------------------------------------------
+    //! @brief      ピクセル単位で移動します.
+    //-------------------------------------------------------------------------
+    void Move(int dx, int dy)
+    {
+        Normalize(TileX, SubX, dx);
+        Normalize(TileY, SubY, dy);
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      指定タイルの中心が画面中央に来るように移動します.
+    //-------------------------------------------------------------------------
+    void LookAt(int32_t tileX, int32_t tileY)
+    {
+        TileX = tileX;
+        TileY = tileY;
+        SubX  = 0;
+        SubY  = 0;
+        Move(kTileSize / 2 - Width / 2, kTileSize / 2 - Height / 2);
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      表示範囲に掛かるタイルの範囲を取得します.
+    //-------------------------------------------------------------------------
+    TileRect GetVisibleRect() const
+    {
+        TileRect result;
+        result.X = TileX;
+        result.Y = TileY;
+        result.W = (SubX + Width  + kTileSize - 1) / kTileSize;
+        result.H = (SubY + Height + kTileSize - 1) / kTileSize;
+        return result;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイル座標から画面上のピクセル位置を求めます.
+    //!
+    //! @note       表示範囲付近のタイルに対して使います.
+    //-------------------------------------------------------------------------
+    void ToScreen(int32_t tileX, int32_t tileY, int& x, int& y) const
+    {
+        x = ScreenX + int(int64_t(tileX) - TileX) * kTileSize - SubX;
+        y = ScreenY + int(int64_t(tileY) - TileY) * kTileSize - SubY;
+    }
+
+private:
+    //-------------------------------------------------------------------------
+    //! @brief      タイル内の位置が [0, kTileSize) に収まるように繰り上げます.
+    //-------------------------------------------------------------------------
+    static void Normalize(int32_t& tile, int& sub, int delta)
+    {
+        auto pos   = int64_t(sub) + delta;
+        auto carry = pos / kTileSize;
+        auto rest  = pos % kTileSize;
+        if (rest < 0)
+        {
+            rest  += kTileSize;
+            carry -= 1;
+        }
+
+        tile = int32_t(int64_t(tile) + carry);
+        sub  = int(rest);
+    }
+};
@@ -0,0 +1,181 @@
+﻿//-----------------------------------------------------------------------------
+// File : MapFormat.h
+// Desc : Binary Map File Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <MapTile.h>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kMapFileMagic     = 0x50414d5a;   // 'Z', 'M', 'A', 'P'
+static const uint16_t kMapFileVersion   = 2;
+static const uint32_t kMapFileAlignment = 16;           // 各ブロックの先頭アライメント.
+static const uint32_t kMaxTilePalette   = 256;          // タイル種別の最大数. タイル番号は1byte.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MAP_FILE_FLAG enum
+///////////////////////////////////////////////////////////////////////////////
+enum MAP_FILE_FLAG : uint32_t
+{
+    MAP_FILE_FLAG_CHECKSUM  = 0x1,      //!< Checksum が有効.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MAP_GIMMICK_TYPE enum
+///////////////////////////////////////////////////////////////////////////////
+enum MAP_GIMMICK_TYPE : uint16_t
+{
+    MAP_GIMMICK_BLOCK,      //!< 押して動かすブロック.
+
+    MAP_GIMMICK_COUNT,
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MapFileHeader structure
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      マップファイルのヘッダです. ファイルの先頭に置きます.
+//!
+//! @note       ファイルの構成は ヘッダ, タイル番号配列, パレット, ギミックテーブル の順です.
+//!             タイル番号配列は各タイルのパレット番号(1byte)で，パレットは
+//!             Tile の配列をそのまま書き出したものです.
+//!             ロード時はマッピングした領域をそのまま使います.
+///////////////////////////////////////////////////////////////////////////////
+struct MapFileHeader
+{
+    uint32_t    Magic;          //!< kMapFileMagic.
+    uint16_t    Version;        //!< kMapFileVersion.
+    uint16_t    HeaderSize;     //!< sizeof(MapFileHeader).
+    uint32_t    FileSize;       //!< ファイルサイズ.
+    uint32_t    Flags;          //!< MAP_FILE_FLAG の組み合わせ.
+    uint16_t    TileCountX;     //!< 横方向のタイル数.
+    uint16_t    TileCountY;     //!< 縦方向のタイル数.
+    uint16_t    PaletteStride;  //!< sizeof(Tile).
+    uint16_t    GimmickStride;  //!< sizeof(MapGimmickDesc).
+    uint32_t    TileOffset;     //!< ファイル先頭からタイル番号配列までのオフセット.
+    uint32_t    PaletteOffset;  //!< ファイル先頭からパレットまでのオフセット.
+    uint32_t    PaletteCount;   //!< パレットのタイル種別数. [1, kMaxTilePalette].
+    uint32_t    GimmickOffset;  //!< ファイル先頭からギミックテーブルまでのオフセット.
+    uint32_t    GimmickCount;   //!< ギミック数.
+    uint32_t    Checksum;       //!< ヘッダより後ろの FNV-1a ハッシュ値.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MapGimmickDesc structure
+///////////////////////////////////////////////////////////////////////////////
+struct MapGimmickDesc
+{
+    uint16_t    Type;           //!< MAP_GIMMICK_TYPE.
+    uint8_t     TileX;          //!< 配置するタイル番号X.
+    uint8_t     TileY;          //!< 配置するタイル番号Y.
+    uint16_t    Width;          //!< 横幅.
+    uint16_t    Height;         //!< 縦幅.
+    uint16_t    TextureId;      //!< テクスチャ番号.
+    uint8_t     Dir;            //!< 可動方向(DIRECTION_STATE).
+    uint8_t     Reserved;       //!< 予約領域. 0 にします.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MapGimmickState structure
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      ギミックの配置時(MapGimmickDesc)からの変化です.
+//!
+//! @note       変化したギミックの分だけセーブデータに書き出し，部屋の読み込み時に適用します.
+///////////////////////////////////////////////////////////////////////////////
+struct MapGimmickState
+{
+    uint16_t    Index;          //!< ギミックテーブルの番号.
+    uint8_t     TileX;          //!< 現在のタイル番号X.
+    uint8_t     TileY;          //!< 現在のタイル番号Y.
+    uint8_t     Flags;          //!< ギミック種別毎の状態ビット.
+    uint8_t     Reserved;       //!< 予約領域. 0 にします.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MapFileView structure
+///////////////////////////////////////////////////////////////////////////////
+struct MapFileView
+{
+    const MapFileHeader*    pHeader;        //!< ヘッダ.
+    uint8_t*                pTileIndices;   //!< タイル番号配列(kTileCountX * kTileCountY). 全てパレット数未満です.
+    const Tile*             pPalette;       //!< パレット.
+    uint32_t                PaletteCount;   //!< パレットのタイル種別数.
+    const MapGimmickDesc*   pGimmicks;      //!< ギミックテーブル.
+    uint32_t                GimmickCount;   //!< ギミック数.
+};
+
+static_assert(sizeof(Tile)           ==  5, "Tile layout is part of the map file format.");
+static_assert(sizeof(MapFileHeader)  == 48, "MapFileHeader layout is part of the map file format.");
+static_assert(sizeof(MapGimmickDesc) == 12, "MapGimmickDesc layout is part of the map file format.");
+static_assert(sizeof(MapGimmickState) ==  6, "MapGimmickState layout is part of the save file format.");
+
+
+//-----------------------------------------------------------------------------
+//! @brief      マップファイルのチェックサムを計算します.
+//-----------------------------------------------------------------------------
+uint32_t CalcMapChecksum(const void* pData, size_t size);
+
+//-----------------------------------------------------------------------------
+//! @brief      メモリ上のマップファイルを検証し，各ブロックを指すように設定します.
+//!
+//! @param[in]      pData       マップファイルの先頭. 16byte 境界に置かれている必要があります.
+//! @param[in]      size        マップファイルのサイズ.
+//! @param[out]     result      各ブロックへのポインタ.
+//! @retval true    検証に成功.
+//! @retval false   検証に失敗.
+//-----------------------------------------------------------------------------
+bool ResolveMapFile(uint8_t* pData, size_t size, MapFileView& result);
+
+//-----------------------------------------------------------------------------
+//! @brief      マップファイルを書き出します.
+//!
+//! @param[in]      path            ファイルパス.
+//! @param[in]      pTileIndices    タイル番号配列(kTileCountX * kTileCountY).
+//! @param[in]      pPalette        パレット.
+//! @param[in]      paletteCount    パレットのタイル種別数.
+//! @param[in]      pGimmicks       ギミックテーブル.
+//! @param[in]      gimmickCount    ギミック数.
+//! @param[in]      checksum        チェックサムを付けるかどうか.
+//! @retval true    書き出しに成功.
+//! @retval false   書き出しに失敗.
+//-----------------------------------------------------------------------------
+bool WriteMapFile(
+    const char*             path,
+    const uint8_t*          pTileIndices,
+    const Tile*             pPalette,
+    uint32_t                paletteCount,
+    const MapGimmickDesc*   pGimmicks,
+    uint32_t                gimmickCount,
+    bool                    checksum);
+
+//-----------------------------------------------------------------------------
+//! @brief      タイル配列からパレットを作ってマップファイルを書き出します.
+//!
+//! @param[in]      path            ファイルパス.
+//! @param[in]      pTiles          タイル配列(kTileCountX * kTileCountY). 種別は kMaxTilePalette 以下にします.
+//! @param[in]      pGimmicks       ギミックテーブル.
+//! @param[in]      gimmickCount    ギミック数.
+//! @param[in]      checksum        チェックサムを付けるかどうか.
+//! @retval true    書き出しに成功.
+//! @retval false   書き出しに失敗.
+//-----------------------------------------------------------------------------
+bool WriteMapFile(
+    const char*             path,
+    const Tile*             pTiles,
+    const MapGimmickDesc*   pGimmicks,
+    uint32_t                gimmickCount,
+    bool                    checksum);
@@ -9,90 +9,29 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <cstdint>
-#include <list>
+#include <vector>
 #include <SpriteSystem.h>
 #include <asdxTexture.h>
 #include <DirectionState.h>
 #include <UpdateContext.h>
 #include <Box.h>
 #include <MessageMgr.h>
+#include <MapTile.h>
+#include <TileLayer.h>
+#include <TileCache.h>
+#include <MapFormat.h>
+#include <MappedFile.h>
+#include <GimmickGrid.h>
+#include <GimmickPool.h>
+#include <gimmick/Block.h>
+#include <PathFinder.h>
 
 
 //-----------------------------------------------------------------------------
 // Forward Declarations.
 //-----------------------------------------------------------------------------
 class Gimmick;
-
-//-----------------------------------------------------------------------------
-// Constant Values.
-//-----------------------------------------------------------------------------
-static const uint8_t kTileCountX        = 19;
-static const uint8_t kTileCountY        = 11;
-static const uint8_t kTileTotalCount    = kTileCountX * kTileCountY;
-static const uint8_t kTileSize          = 64;
-static const int     kMarginX           = 32;   // (1280 - kTileSize * kTileCountX) / 2;
-static const int     kMarginY           = 8;    // (720 - kTileSize * kTileCountY) / 2;
-static const int     kTileOffsetX       = kMarginX;
-static const int     kTileOffsetY       = kMarginY;
-static const int     kTileTotalW        = kTileSize * kTileCountX;
-static const int     kTileTotalH        = kTileSize * kTileCountY;
-static const int     kScrollFrame       = 64;
-static const float   kMapScrollX        = float(kTileTotalW) / float(kScrollFrame);
-static const float   kMapScrollY        = float(kTileTotalH) / float(kScrollFrame);
-static const float   kCharaScrollX      = float(kTileSize * (kTileCountX - 2) - kTileSize / 2) / float(kScrollFrame);   // 左右1タイル分を除く + 半キャラ分補正.
-static const float   kCharaScrollY      = float(kTileSize * (kTileCountY - 2) - kTileSize / 2) / float(kScrollFrame);   // 上下1タイル分を除く + 半キャラ分補正.
-static const int     kMapMaxiX          = kTileOffsetX + kTileSize * (kTileCountX - 1);
-static const int     kMapMaxiY          = kTileOffsetY + kTileSize * (kTileCountY - 1);
-
-
-///////////////////////////////////////////////////////////////////////////////
-// Tile structure
-///////////////////////////////////////////////////////////////////////////////
-struct Tile
-{
-    uint8_t     TextureId;      //!< テクスチャ番号.
-    bool        Moveable;       //!< 移動可能.
-    bool        Scrollable;     //!< スクロールによるマップ切り替え.
-    bool        Switchable;     //!< 場面転換によるマップ切り替え(階段など).
-    bool        Fallable;       //!< 床無しで落ちる.
-};
-
-//-----------------------------------------------------------------------------
-//      タイルインデックスを計算します.
-//-----------------------------------------------------------------------------
-inline Vector2i CalcTileIndex(int posX, int posY)
-{
-    auto ix = (posX - kTileOffsetX) / kTileSize;
-    auto iy = (posY - kTileOffsetY) / kTileSize;
-
-    if (ix >= (kTileCountX - 1))
-    { ix = kTileCountX - 1; }
-    else if (ix < 0)
-    { ix = 0; }
-    
-    if (iy >= (kTileCountY - 1))
-    { iy = kTileCountY - 1; }
-    else if (iy < 0)
-    { iy = 0; }
-
-    return Vector2i(ix, iy);
-};
-
-//-----------------------------------------------------------------------------
-//      タイルIDを計算します.
-//-----------------------------------------------------------------------------
-inline uint8_t CalcTileId(const Vector2i& index)
-{ return uint8_t(index.x) + uint8_t(index.y) * kTileCountX; }
-
-//-----------------------------------------------------------------------------
-//      タイルインデックスから位置座標を求めます.
-//-----------------------------------------------------------------------------
-inline Vector2i CalcPosFromTile(int tileX, int tileY)
-{
-    return Vector2i(
-        kTileOffsetX + kTileSize * tileX,
-        kTileOffsetY + kTileSize * tileY);
-}
+class MapWorld;
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -100,8 +39,14 @@ inline Vector2i CalcPosFromTile(int tileX, int tileY)
 ///////////////////////////////////////////////////////////////////////////////
 struct MapInstance
 {
-    Tile                Tile[kTileCountX * kTileCountY] = {};
-    std::list<Gimmick*> Gimmicks;
+    TileLayer               Layer;                      //!< タイル. ロードしたファイルのマッピングを直接指します.
+    const MapGimmickDesc*   GimmickDescs    = nullptr;  //!< ギミックの配置. Gimmicks はここから生成します.
+    uint32_t                GimmickCount    = 0;        //!< ギミックの配置数.
+    GimmickGrid             Grid;       //!< ギミックの位置による索引. ギミックより先に宣言して後に破棄させます.
+    GimmickPool<Block>      Blocks;     //!< ブロック. 種類を増やしたら ForEachGimmick() にも追加すること.
+    PathFinder              Path;       //!< 敵の経路探索. 通行可否は UpdatePath() で作り直します.
+    TileCache               Cache;      //!< 展開済みタイルスプライト. Layer を書き換えたら InvalidateCache() を呼ぶこと.
+    MappedFile              File;       //!< マッピングしたマップファイル.
 
     //-------------------------------------------------------------------------
     //! @brief      ファイルからロードを行います.
@@ -112,6 +57,28 @@ struct MapInstance
     //-------------------------------------------------------------------------
     bool Load(const char* path);
 
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルをマッピングして検証します. ギミックは生成しません.
+    //!
+    //! @note       別スレッドから呼び出せます. 使う前にメインスレッドで Activate() を呼びます.
+    //-------------------------------------------------------------------------
+    bool LoadFile(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ギミックを生成し，タイルのスプライトを展開します.
+    //!
+    //! @param[in]      pStates     配置時からの変化. Index の昇順に並べます.
+    //! @param[in]      stateCount  変化の数.
+    //-------------------------------------------------------------------------
+    void Activate(const MapGimmickState* pStates = nullptr, uint32_t stateCount = 0);
+
+    //-------------------------------------------------------------------------
+    //! @brief      配置時から変化したギミックの状態を取得します.
+    //!
+    //! @param[out]     result      Index の昇順に並べた変化. 先にクリアされます.
+    //-------------------------------------------------------------------------
+    void CaptureState(std::vector<MapGimmickState>& result) const;
+
     //-------------------------------------------------------------------------
     //! @brief      ファイルにセーブを行います.
     //! 
@@ -125,6 +92,43 @@ struct MapInstance
     //! @brief      破棄処理を行います.
     //-------------------------------------------------------------------------
     void Dispose();
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイルのスプライトキャッシュを無効にします.
+    //-------------------------------------------------------------------------
+    void InvalidateCache();
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイルとギミックの配置から経路探索の通行可否を作り直します.
+    //-------------------------------------------------------------------------
+    void UpdatePath();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ギミックの数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetGimmickCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      全てのギミックを種類ごとにまとめて処理します.
+    //!
+    //! @note       func は具体的な型の参照で呼び出されるので，汎用ラムダを渡します.
+    //-------------------------------------------------------------------------
+    template<typename Func>
+    void ForEachGimmick(Func func)
+    {
+        for(auto& itr : Blocks)
+        { func(itr); }
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      全てのギミックを種類ごとにまとめて処理します.
+    //-------------------------------------------------------------------------
+    template<typename Func>
+    void ForEachGimmick(Func func) const
+    {
+        for(auto& itr : Blocks)
+        { func(itr); }
+    }
 };
 
 
@@ -162,7 +166,7 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      タイルを取得します.
     //-------------------------------------------------------------------------
-    Tile GetTile(uint8_t id) const;
+    Tile GetTile(uint32_t id) const;
 
     //-------------------------------------------------------------------------
     //! @brief      更新処理を行います.
@@ -179,6 +183,37 @@ public:
     //-------------------------------------------------------------------------
     bool CanMove(const Box& nextBox);
 
+    //-------------------------------------------------------------------------
+    //! @brief      矩形と重なるギミックを取得します.
+    //!
+    //! @param[in]      box         検索する矩形.
+    //! @param[out]     result      重なるギミック. 先にクリアされます.
+    //-------------------------------------------------------------------------
+    void QueryGimmicks(const Box& box, std::vector<Gimmick*>& result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      フローフィールドの目標を設定します.
+    //!
+    //! @note       中心が乗ったタイルが変わった後，最初に GetFlowDir() で引いた時だけ作り直します.
+    //-------------------------------------------------------------------------
+    void SetPathGoal(const Box& box);
+
+    //-------------------------------------------------------------------------
+    //! @brief      目標に近づくための移動方向を取得します.
+    //!
+    //! @param[in]      box         中心が乗ったタイルで引きます.
+    //-------------------------------------------------------------------------
+    DIRECTION_STATE GetFlowDir(const Box& box);
+
+    //-------------------------------------------------------------------------
+    //! @brief      A* で経路を求めます.
+    //!
+    //! @param[in]      from        開始の矩形. 中心が乗ったタイルから探します.
+    //! @param[in]      to          目標の矩形. 中心が乗ったタイルまで探します.
+    //! @param[out]     path        開始の次のタイルから目標までのタイルID.
+    //-------------------------------------------------------------------------
+    bool FindPath(const Box& from, const Box& to, std::vector<uint32_t>& path);
+
     //-------------------------------------------------------------------------
     //! @brief      ギミックの状態をリセットします.
     //-------------------------------------------------------------------------
@@ -189,6 +224,13 @@ public:
     //-------------------------------------------------------------------------
     void OnMessage(const Message& msg) override;
 
+    //-------------------------------------------------------------------------
+    //! @brief      部屋の接続を設定します.
+    //!
+    //! @note       設定するとスクロール開始時に隣の部屋へ切り替えます.
+    //-------------------------------------------------------------------------
+    void SetWorld(MapWorld* value);
+
     //-------------------------------------------------------------------------
     //! @brief      場面切り替え中かどうか?
     //-------------------------------------------------------------------------
@@ -203,6 +245,7 @@ private:
     //=========================================================================
     // private variables.
     //=========================================================================
+    MapWorld*       m_pWorld        = nullptr;
     MapInstance*    m_Data          = nullptr;
     MapInstance*    m_Next          = nullptr;
     asdx::Vector2   m_Scroll        = asdx::Vector2(0.0f, 0.0f);
@@ -210,6 +253,8 @@ private:
     bool            m_IsScroll      = false;
     uint8_t         m_ScrollFrame   = 0;
     uint8_t         m_ScrollDir     = 0;
+    std::vector<SpriteDesc> m_Sprites;
+    std::vector<Gimmick*>   m_Hits;     // CanMove() の作業領域.
 
     //=========================================================================
     // private methods.
@@ -220,5 +265,15 @@ private:
     //-------------------------------------------------------------------------
     void Scroll(DIRECTION_STATE dir);
     void Change();
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュしたタイルを平行移動して描画します.
+    //-------------------------------------------------------------------------
+    void DrawTiles(
+        SpriteSystem&   sprite,
+        MapInstance*    instance,
+        int             offsetX,
+        int             offsetY,
+        int             playerY);
 };
 
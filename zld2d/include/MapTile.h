@@ -0,0 +1,84 @@
+﻿//-----------------------------------------------------------------------------
+// File : MapTile.h
+// Desc : Map Tile Definition.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <Vector2i.h>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint8_t kTileCountX        = 19;
+static const uint8_t kTileCountY        = 11;
+static const uint32_t kTileTotalCount   = uint32_t(kTileCountX) * kTileCountY;
+static const uint8_t kTileSize          = 64;
+static const int     kMarginX           = 32;   // (1280 - kTileSize * kTileCountX) / 2;
+static const int     kMarginY           = 8;    // (720 - kTileSize * kTileCountY) / 2;
+static const int     kTileOffsetX       = kMarginX;
+static const int     kTileOffsetY       = kMarginY;
+static const int     kTileTotalW        = kTileSize * kTileCountX;
+static const int     kTileTotalH        = kTileSize * kTileCountY;
+static const int     kScrollFrame       = 64;
+static const float   kMapScrollX        = float(kTileTotalW) / float(kScrollFrame);
+static const float   kMapScrollY        = float(kTileTotalH) / float(kScrollFrame);
+static const float   kCharaScrollX      = float(kTileSize * (kTileCountX - 2) - kTileSize / 2) / float(kScrollFrame);   // 左右1タイル分を除く + 半キャラ分補正.
+static const float   kCharaScrollY      = float(kTileSize * (kTileCountY - 2) - kTileSize / 2) / float(kScrollFrame);   // 上下1タイル分を除く + 半キャラ分補正.
+static const int     kMapMaxiX          = kTileOffsetX + kTileSize * (kTileCountX - 1);
+static const int     kMapMaxiY          = kTileOffsetY + kTileSize * (kTileCountY - 1);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Tile structure
+///////////////////////////////////////////////////////////////////////////////
+struct Tile
+{
+    uint8_t     TextureId;      //!< テクスチャ番号.
+    bool        Moveable;       //!< 移動可能.
+    bool        Scrollable;     //!< スクロールによるマップ切り替え.
+    bool        Switchable;     //!< 場面転換によるマップ切り替え(階段など).
+    bool        Fallable;       //!< 床無しで落ちる.
+};
+
+//-----------------------------------------------------------------------------
+//      タイルインデックスを計算します.
+//-----------------------------------------------------------------------------
+inline Vector2i CalcTileIndex(int posX, int posY)
+{
+    auto ix = (posX - kTileOffsetX) / kTileSize;
+    auto iy = (posY - kTileOffsetY) / kTileSize;
+
+    if (ix >= (kTileCountX - 1))
+    { ix = kTileCountX - 1; }
+    else if (ix < 0)
+    { ix = 0; }
+    
+    if (iy >= (kTileCountY - 1))
+    { iy = kTileCountY - 1; }
+    else if (iy < 0)
+    { iy = 0; }
+
+    return Vector2i(ix, iy);
+};
+
+//-----------------------------------------------------------------------------
+//      タイルIDを計算します.
+//-----------------------------------------------------------------------------
+inline uint32_t CalcTileId(const Vector2i& index)
+{ return uint32_t(index.x) + uint32_t(index.y) * kTileCountX; }
+
+//-----------------------------------------------------------------------------
+//      タイルインデックスから位置座標を求めます.
+//-----------------------------------------------------------------------------
+inline Vector2i CalcPosFromTile(int tileX, int tileY)
+{
+    return Vector2i(
+        kTileOffsetX + kTileSize * tileX,
+        kTileOffsetY + kTileSize * tileY);
+}
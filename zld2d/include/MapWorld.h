@@ -0,0 +1,289 @@
+﻿//-----------------------------------------------------------------------------
+// File : MapWorld.h
+// Desc : Room Graph and Residency.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <DirectionState.h>
+#include <MapSystem.h>
+#include <SaveFormat.h>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kInvalidRoomId    = UINT32_MAX;
+static const uint32_t kRoomLinkCount    = 4;    // DIRECTION_LEFT ～ DIRECTION_DOWN.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MapWorld class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      部屋の接続を管理し，隣の部屋を裏で読み込んでおきます.
+//!
+//! @note       部屋に入ると隣接する部屋をワーカースレッドで読み込みます.
+//!             ファイルのマッピングと検証はワーカースレッド，ギミックの生成は
+//!             Update() を呼んだメインスレッドで行います.
+//!             常駐できる部屋の数は Init() で指定し，足りなくなると
+//!             現在の部屋から最も遠い部屋を追い出します.
+///////////////////////////////////////////////////////////////////////////////
+class MapWorld
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    MapWorld();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~MapWorld();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      budget      常駐できる部屋の数. 現在の部屋と隣接する4部屋で5以上を推奨します.
+    //-------------------------------------------------------------------------
+    bool Init(uint32_t budget);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      部屋の接続をファイルから読み込みます.
+    //!
+    //! @note       書式は res/map/world.txt を参照してください.
+    //-------------------------------------------------------------------------
+    bool LoadGraph(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      部屋を追加します.
+    //!
+    //! @return     部屋番号を返却します. 同じ名前が既にある場合は kInvalidRoomId を返却します.
+    //-------------------------------------------------------------------------
+    uint32_t AddRoom(const char* name, const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      部屋を接続します. 逆方向の接続も設定します.
+    //-------------------------------------------------------------------------
+    bool Link(uint32_t from, DIRECTION_STATE dir, uint32_t to);
+
+    //-------------------------------------------------------------------------
+    //! @brief      名前から部屋番号を検索します.
+    //-------------------------------------------------------------------------
+    uint32_t FindRoom(const char* name) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      開始する部屋を読み込み，隣の部屋の先読みを開始します.
+    //!
+    //! @note       開始する部屋は同期で読み込みます.
+    //-------------------------------------------------------------------------
+    bool Start(uint32_t room);
+
+    //-------------------------------------------------------------------------
+    //! @brief      読み込みが完了した部屋を反映し，不足している先読みを要求します.
+    //!
+    //! @note       1フレームに1回，メインスレッドから呼び出します.
+    //-------------------------------------------------------------------------
+    void Update();
+
+    //-------------------------------------------------------------------------
+    //! @brief      隣の部屋に移動します.
+    //!
+    //! @retval true    移動しました.
+    //! @retval false   その方向に部屋がありません.
+    //-------------------------------------------------------------------------
+    bool Enter(DIRECTION_STATE dir);
+
+    //-------------------------------------------------------------------------
+    //! @brief      現在の部屋を取得します.
+    //-------------------------------------------------------------------------
+    MapInstance* GetCurrent() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      隣の部屋を取得します.
+    //!
+    //! @note       先読みが間に合っていない場合はその場で読み込み，同期読み込みとして数えます.
+    //! @return     その方向に部屋が無い場合は nullptr を返却します.
+    //-------------------------------------------------------------------------
+    MapInstance* GetNeighbor(DIRECTION_STATE dir);
+
+    //-------------------------------------------------------------------------
+    //! @brief      現在の部屋番号を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCurrentRoom() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      隣の部屋番号を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetLink(uint32_t room, DIRECTION_STATE dir) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      部屋数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetRoomCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      部屋が常駐しているかどうか?
+    //-------------------------------------------------------------------------
+    bool IsResident(uint32_t room) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      読み込み中の部屋が無いかどうか?
+    //-------------------------------------------------------------------------
+    bool IsIdle() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      常駐している部屋の数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetResidentCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      先読みで読み込んだ回数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetAsyncLoadCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      先読みが間に合わずに同期で読み込んだ(または待った)回数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetSyncLoadCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      部屋を追い出した回数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetEvictCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      全部屋の配置時からの変化を取得します.
+    //!
+    //! @param[out]     result      変化のある部屋だけを部屋番号の順に並べたもの.
+    //-------------------------------------------------------------------------
+    void CaptureState(std::vector<RoomState>& result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      全部屋の配置時からの変化を設定します. 含まれない部屋は配置時に戻ります.
+    //!
+    //! @note       変化は次に部屋を読み込んだ時に適用するので，Start() より前に呼び出します.
+    //! @retval true    設定に成功.
+    //! @retval false   常駐している部屋があるので設定できない.
+    //-------------------------------------------------------------------------
+    bool RestoreState(const std::vector<RoomState>& states);
+
+    //-------------------------------------------------------------------------
+    //! @brief      全部屋の配置時からの変化をセーブファイルに書き出します.
+    //-------------------------------------------------------------------------
+    bool SaveState(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      セーブファイルから全部屋の配置時からの変化を読み込みます.
+    //!
+    //! @note       Start() より前に呼び出します.
+    //-------------------------------------------------------------------------
+    bool LoadState(const char* path);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // ROOM_STATE enum
+    ///////////////////////////////////////////////////////////////////////////
+    enum ROOM_STATE : uint8_t
+    {
+        ROOM_STATE_NONE,        // 読み込まれていない.
+        ROOM_STATE_LOADING,     // ワーカースレッドで読み込み中.
+        ROOM_STATE_RESIDENT,    // 常駐している.
+        ROOM_STATE_FAILED,      // 読み込みに失敗した. 再試行しない.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Room structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Room
+    {
+        std::string     Name;
+        std::string     Path;
+        uint32_t        Links[kRoomLinkCount];
+        uint32_t        Slot;       // 常駐先のスロット番号.
+        uint32_t        Distance;   // 現在の部屋からの距離. 最後に求めた時のもの.
+        uint32_t        Visit;      // Distance を求めた時の Enter() の通し番号.
+        ROOM_STATE      State;
+        std::vector<MapGimmickState> Delta;     // 追い出した時の配置時からの変化. 読み込み時に適用する.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // LoadJob structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct LoadJob
+    {
+        uint32_t        Room;
+        uint32_t        Slot;
+        std::string     Path;
+        bool            Success;
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<Room>                           m_Rooms;
+    std::unordered_map<std::string, uint32_t>   m_RoomIds;
+    std::unique_ptr<MapInstance[]>              m_Slots;
+    std::vector<uint32_t>                       m_SlotRooms;    // スロットを使っている部屋番号.
+    std::vector<uint32_t>                       m_Search;       // 距離を求めるための作業領域.
+    uint32_t                                    m_Budget;
+    uint32_t                                    m_Current;
+    uint32_t                                    m_Visit;
+    uint32_t                                    m_LoadingCount;
+    uint32_t                                    m_AsyncLoadCount;
+    uint32_t                                    m_SyncLoadCount;
+    uint32_t                                    m_EvictCount;
+
+    std::thread                                 m_Worker;
+    std::mutex                                  m_Mutex;
+    std::condition_variable                     m_Signal;
+    std::deque<LoadJob>                         m_Requests;     // m_Mutex で保護.
+    std::vector<LoadJob>                        m_Completes;    // m_Mutex で保護.
+    std::vector<LoadJob>                        m_Finished;     // m_Completes から取り出した完了分.
+    bool                                        m_Quit;         // m_Mutex で保護.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    void WorkerMain();
+    void Commit(bool wait);
+    void Prefetch();
+    void UpdateDistance();
+    bool LoadSync(uint32_t room);
+    uint32_t AllocSlot();
+    void Evict(uint32_t room);
+
+    MapWorld            (const MapWorld&) = delete;     // アクセス禁止.
+    MapWorld& operator= (const MapWorld&) = delete;     // アクセス禁止.
+};
@@ -0,0 +1,85 @@
+﻿//-----------------------------------------------------------------------------
+// File : MappedFile.h
+// Desc : Memory Mapped File.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      ファイルをコピーオンライトでメモリにマッピングします.
+//!
+//! @note       マッピングした領域は書き換えられますが，ファイルには反映されません.
+///////////////////////////////////////////////////////////////////////////////
+class MappedFile
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    MappedFile();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~MappedFile();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルをマッピングします.
+    //!
+    //! @param[in]      path        ファイルパス.
+    //! @retval true    マッピングに成功.
+    //! @retval false   マッピングに失敗.
+    //-------------------------------------------------------------------------
+    bool Open(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      マッピングを解除します.
+    //-------------------------------------------------------------------------
+    void Close();
+
+    //-------------------------------------------------------------------------
+    //! @brief      マッピングした領域の先頭を取得します.
+    //-------------------------------------------------------------------------
+    uint8_t* GetData() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      マッピングした領域のサイズを取得します.
+    //-------------------------------------------------------------------------
+    size_t GetSize() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    uint8_t*    m_pData;
+    size_t      m_Size;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    MappedFile              (const MappedFile&) = delete;   // アクセス禁止.
+    MappedFile& operator =  (const MappedFile&) = delete;   // アクセス禁止.
+};
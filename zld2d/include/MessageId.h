@@ -24,4 +24,5 @@ enum MESSAGE_ID : unsigned int
     MESSAGE_ID_EVENT_UPDATE_CURSOR, // 選択肢カーソル更新.
     MESSAGE_ID_SWITCHER_REQUEST,    // スイッチャーに要求.
     MESSAGE_ID_SWITCHER_COMPLETE,   // スイッチャー処理終了. 
+    MESSAGE_ID_GIMMICK_MOVED,       // ギミックの移動完了.
 };
@@ -0,0 +1,152 @@
+﻿//-----------------------------------------------------------------------------
+// File : PathFinder.h
+// Desc : Path Finding over Room Tiles.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <MapTile.h>
+#include <TileLayer.h>
+#include <DirectionState.h>
+#include <Box.h>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kInvalidTileId   = UINT32_MAX;
+static const uint16_t kInvalidPathDist = UINT16_MAX;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// PathFinder class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      1部屋分のタイルの通行可否から経路を求めます.
+//!
+//! @note       単発の問い合わせは FindPath() (A*) で求めます.
+//!             目標(プレイヤー)に向かう敵は，目標から幅優先で求めた
+//!             フローフィールドを共有し，GetFlowDir() で次の方向を引きます.
+//!             フローフィールドは目標のタイルか通行可否が変わった後，最初に GetFlowDir() か
+//!             GetFlowDist() で引いた時だけ作り直します. 引く敵がいなければ作り直しません.
+///////////////////////////////////////////////////////////////////////////////
+class PathFinder
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    PathFinder();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~PathFinder();
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイルの移動可能属性から通行可否を設定します.
+    //!
+    //! @note       続けて AddObstacle() で塞ぐギミックを登録します.
+    //-------------------------------------------------------------------------
+    void SetLayer(const TileLayer& layer);
+
+    //-------------------------------------------------------------------------
+    //! @brief      矩形が掛かるタイルを通行不可にします.
+    //-------------------------------------------------------------------------
+    void AddObstacle(const Box& box);
+
+    //-------------------------------------------------------------------------
+    //! @brief      通行可否と目標を破棄します.
+    //-------------------------------------------------------------------------
+    void Reset();
+
+    //-------------------------------------------------------------------------
+    //! @brief      通行可能かどうか?
+    //-------------------------------------------------------------------------
+    bool IsWalkable(uint32_t id) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      A* で経路を求めます.
+    //!
+    //! @param[in]      start       開始タイルID.
+    //! @param[in]      goal        目標タイルID.
+    //! @param[out]     path        開始の次のタイルから目標までのタイルID. 先にクリアされます.
+    //! @retval true    経路が見つかった.
+    //! @retval false   経路が無い.
+    //-------------------------------------------------------------------------
+    bool FindPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      フローフィールドの目標を設定します. タイルが変わった時だけ作り直しを予約します.
+    //-------------------------------------------------------------------------
+    void SetGoal(uint32_t id);
+
+    //-------------------------------------------------------------------------
+    //! @brief      フローフィールドの目標を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetGoal() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      予約されていればフローフィールドを作り直します.
+    //!
+    //! @retval true    作り直した.
+    //! @retval false   作り直す必要が無かった.
+    //-------------------------------------------------------------------------
+    bool Update();
+
+    //-------------------------------------------------------------------------
+    //! @brief      目標に近づくための移動方向を取得します.
+    //!
+    //! @return     目標のタイルか，目標に辿り着けない場合は DIRECTION_NONE を返却します.
+    //-------------------------------------------------------------------------
+    DIRECTION_STATE GetFlowDir(uint32_t id);
+
+    //-------------------------------------------------------------------------
+    //! @brief      目標までの歩数を取得します. 辿り着けない場合は kInvalidPathDist を返却します.
+    //-------------------------------------------------------------------------
+    uint16_t GetFlowDist(uint32_t id);
+
+private:
+    static_assert(kTileCountX <= 32, "A row of tiles must fit in a 32bit word.");
+    static_assert(kTileTotalCount <= UINT16_MAX, "Tile id must fit in 16bit.");
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    uint32_t                m_Walk[kTileCountY];        // ビット i が列 i の通行可否.
+    uint16_t                m_Dist[kTileTotalCount];    // フローフィールドの歩数.
+    uint8_t                 m_Flow[kTileTotalCount];    // フローフィールドの方向.
+    uint16_t                m_Cost[kTileTotalCount];    // A* の開始からの歩数.
+    uint16_t                m_Parent[kTileTotalCount];  // A* の1つ前のタイル.
+    uint32_t                m_Visit[kTileTotalCount];   // A* で開いた時の通し番号.
+    std::vector<uint32_t>   m_Open;                     // A* の候補. 上位16bitが推定歩数.
+    uint32_t                m_Search;
+    uint32_t                m_Goal;
+    bool                    m_Dirty;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    void BuildFlow();
+
+    PathFinder              (const PathFinder&) = delete;   // アクセス禁止.
+    PathFinder& operator =  (const PathFinder&) = delete;   // アクセス禁止.
+};
@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <asdxTexture.h>
 #include <SpriteSystem.h>
+#include <SpriteAnimation.h>
 #include <UpdateContext.h>
 #include <DirectionState.h>
 #include <Box.h>
@@ -59,7 +60,7 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      初期化処理を行います.
     //-------------------------------------------------------------------------
-    bool Init();
+    bool Init(SpriteAnimSystem& anim, const SpriteAnimLibrary& library);
 
     //-------------------------------------------------------------------------
     //! @brief      終了処理を行います.
@@ -121,13 +122,16 @@ private:
     uint8_t             m_MaxLife           = 3;                // 最大HP.
     DIRECTION_STATE     m_Direction         = DIRECTION_LEFT;   // 移動方向.
     uint32_t            m_Frame             = 0;                // フレーム数.
-    uint8_t             m_AnimFrame         = 0;                // スプライトアニメーション用フレームカウンター.
     int                 m_NonDamageFrame    = 0;                // 残り無敵時間
     uint8_t             m_Flags             = 0;                // 汎用フラグ.
     asdx::Vector2       m_Scroll            = asdx::Vector2(0.0f, 0.0f);    // スクロール量.
     uint8_t             m_SelectOption      = 0;                // 分岐選択肢の項目.
-    asdx::Texture2D     m_PlayerTexture[12];
-    asdx::Texture2D     m_WeaponTexture[4];
+    SpriteAnimSystem*   m_pAnim             = nullptr;          // アニメーションシステム.
+    SpriteAnimHandle    m_BodyAnim          = kInvalidSpriteAnimHandle; // キャラのアニメーション.
+    SpriteAnimHandle    m_WeaponAnim        = kInvalidSpriteAnimHandle; // 武器のアニメーション.
+    SpriteAnimClipId    m_ClipWalk          = kInvalidSpriteAnimClip;   // 歩きクリップ.
+    SpriteAnimClipId    m_ClipAttack        = kInvalidSpriteAnimClip;   // 攻撃クリップ.
+    SpriteAnimClipId    m_ClipSpear         = kInvalidSpriteAnimClip;   // 武器クリップ.
 
 
     //=========================================================================
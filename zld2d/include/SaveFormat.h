@@ -0,0 +1,97 @@
+﻿//-----------------------------------------------------------------------------
+// File : SaveFormat.h
+// Desc : Binary Save File Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <MapFormat.h>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kSaveFileMagic   = 0x5641535a;   // 'Z', 'S', 'A', 'V'
+static const uint16_t kSaveFileVersion = 1;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SaveFileHeader structure
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      セーブファイルのヘッダです. ファイルの先頭に置きます.
+//!
+//! @note       ヘッダの後ろに SaveRoomHeader, 部屋の名前(終端文字無し),
+//!             MapGimmickState の配列 を部屋の数だけ詰めて並べます.
+//!             アライメントは取らないので，読み込み時はコピーして使います.
+///////////////////////////////////////////////////////////////////////////////
+struct SaveFileHeader
+{
+    uint32_t    Magic;          //!< kSaveFileMagic.
+    uint16_t    Version;        //!< kSaveFileVersion.
+    uint16_t    HeaderSize;     //!< sizeof(SaveFileHeader).
+    uint32_t    FileSize;       //!< ファイルサイズ.
+    uint32_t    RoomCount;      //!< 部屋数.
+    uint32_t    Checksum;       //!< ヘッダより後ろの FNV-1a ハッシュ値.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SaveRoomHeader structure
+///////////////////////////////////////////////////////////////////////////////
+struct SaveRoomHeader
+{
+    uint16_t    NameLength;     //!< 部屋の名前のバイト数.
+    uint16_t    StateCount;     //!< MapGimmickState の数.
+};
+
+static_assert(sizeof(SaveFileHeader) == 20, "SaveFileHeader layout is part of the save file format.");
+static_assert(sizeof(SaveRoomHeader) ==  4, "SaveRoomHeader layout is part of the save file format.");
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RoomState structure
+///////////////////////////////////////////////////////////////////////////////
+struct RoomState
+{
+    std::string                     Name;       //!< 部屋の名前.
+    std::vector<MapGimmickState>    Gimmicks;   //!< 配置時から変化したギミック. Index の昇順.
+};
+
+
+//-----------------------------------------------------------------------------
+//! @brief      セーブデータをメモリ上に書き出します.
+//!
+//! @param[in]      rooms       部屋毎の状態.
+//! @param[out]     result      セーブデータ.
+//! @retval true    書き出しに成功.
+//! @retval false   書き出しに失敗.
+//-----------------------------------------------------------------------------
+bool WriteSaveData(const std::vector<RoomState>& rooms, std::vector<uint8_t>& result);
+
+//-----------------------------------------------------------------------------
+//! @brief      メモリ上のセーブデータを検証して読み込みます.
+//!
+//! @param[in]      pData       セーブデータの先頭.
+//! @param[in]      size        セーブデータのサイズ.
+//! @param[out]     result      部屋毎の状態.
+//! @retval true    読み込みに成功.
+//! @retval false   読み込みに失敗.
+//-----------------------------------------------------------------------------
+bool ReadSaveData(const uint8_t* pData, size_t size, std::vector<RoomState>& result);
+
+//-----------------------------------------------------------------------------
+//! @brief      セーブファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteSaveFile(const char* path, const std::vector<RoomState>& rooms);
+
+//-----------------------------------------------------------------------------
+//! @brief      セーブファイルを読み込みます.
+//-----------------------------------------------------------------------------
+bool ReadSaveFile(const char* path, std::vector<RoomState>& result);
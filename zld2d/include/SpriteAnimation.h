@@ -0,0 +1,285 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteAnimation.h
+// Desc : Sprite Sheet Animation.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <SpriteFormat.h>
+
+
+//-----------------------------------------------------------------------------
+// Type Definitions.
+//-----------------------------------------------------------------------------
+typedef uint16_t SpriteAnimClipId;
+typedef uint32_t SpriteAnimHandle;
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const SpriteAnimClipId   kInvalidSpriteAnimClip      = UINT16_MAX;
+static const SpriteAnimHandle   kInvalidSpriteAnimHandle    = UINT32_MAX;
+static const uint32_t           kSpriteAnimDirCount         = 4;    // 向き違いの最大数(DIRECTION_STATE の LEFT, RIGHT, UP, DOWN).
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteAnimClip structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteAnimClip
+{
+    std::string     Name;           //!< クリップ名.
+    uint32_t        FirstRegion;    //!< SpriteAnimLibrary が保持する領域の開始番号.
+    uint32_t        FirstTick;      //!< SpriteAnimLibrary が保持する経過フレーム→コマ番号表の開始番号.
+    uint16_t        FrameCount;     //!< コマ数.
+    uint8_t         DirCount;       //!< 向き違いの数(1 または kSpriteAnimDirCount).
+    bool            Loop;           //!< ループするかどうか.
+    uint32_t        Length;         //!< 1周のフレーム数(各コマの表示フレーム数の合計).
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteAnimLibrary class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      スプライトシートのアニメーションクリップを保持します.
+//!
+//! @note       クリップはテキストファイルから読み込みます. 書式は次の通りで,
+//!             各項目はハードタブで区切ります. '#' で始まる行はコメントです.
+//!
+//!             root    <画像パスの前に付けるディレクトリ>
+//!             grid    <列数>  <行数>                      以降の画像をこの格子で分割します.
+//!             clip    <クリップ名>  <loop | once>
+//!             frame   <表示フレーム数>  <画像>  [<画像> <画像> <画像>]
+//!
+//!             frame に画像を4つ並べると左・右・上・下の向き違いになります.
+//!             画像は "パス" または格子のセル番号を付けた "パス:番号" で指定します.
+//!             使用する画像はまとめて TextureMgr に読み込むので，1キャラ分が1枚のアトラスに入ります.
+///////////////////////////////////////////////////////////////////////////////
+class SpriteAnimLibrary
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    friend class SpriteAnimSystem;
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SpriteAnimLibrary();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~SpriteAnimLibrary();
+
+    //-------------------------------------------------------------------------
+    //! @brief      クリップ定義ファイルを読み込みます.
+    //-------------------------------------------------------------------------
+    bool Load(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      全てのクリップを破棄します.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      クリップを追加します.
+    //!
+    //! @param[in]      dirCount    向き違いの数です(1 または kSpriteAnimDirCount).
+    //! @return     追加したクリップ番号を返却します. 追加できない場合は kInvalidSpriteAnimClip を返却します.
+    //-------------------------------------------------------------------------
+    SpriteAnimClipId AddClip(const char* name, bool loop, uint32_t dirCount);
+
+    //-------------------------------------------------------------------------
+    //! @brief      最後に追加したクリップにコマを追加します.
+    //!
+    //! @param[in]      duration    表示フレーム数です.
+    //! @param[in]      pRegions    向き違いの数だけ並べた領域です.
+    //-------------------------------------------------------------------------
+    bool AddFrame(uint32_t duration, const TextureRegion* pRegions);
+
+    //-------------------------------------------------------------------------
+    //! @brief      名前からクリップ番号を検索します.
+    //!
+    //! @return     見つからない場合は kInvalidSpriteAnimClip を返却します.
+    //-------------------------------------------------------------------------
+    SpriteAnimClipId Find(const char* name) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      クリップを取得します.
+    //-------------------------------------------------------------------------
+    const SpriteAnimClip& GetClip(SpriteAnimClipId id) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      クリップ数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetClipCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      コマの領域を取得します.
+    //-------------------------------------------------------------------------
+    const TextureRegion& GetRegion(SpriteAnimClipId id, uint32_t frame, uint32_t dir) const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<SpriteAnimClip>     m_Clips;
+    std::vector<TextureRegion>      m_Regions;      // [クリップ][コマ][向き] の順に並べた領域.
+    std::vector<uint16_t>           m_TickToFrame;  // [クリップ][経過フレーム] からコマ番号を引く表.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    SpriteAnimLibrary           (const SpriteAnimLibrary&) = delete;    // アクセス禁止.
+    SpriteAnimLibrary& operator=(const SpriteAnimLibrary&) = delete;    // アクセス禁止.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteAnimSystem class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      多数のキャラのアニメーションをまとめて更新します.
+//!
+//! @note       再生状態は配列毎に詰めて保持し，Update() で全キャラを1回の走査で進めます.
+//!             コマの決定は経過フレームからの表引きなので，キャラ毎の分岐はループ判定だけです.
+///////////////////////////////////////////////////////////////////////////////
+class SpriteAnimSystem
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SpriteAnimSystem();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~SpriteAnimSystem();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      pLibrary    再生するクリップを保持するライブラリです.
+    //! @param[in]      capacity    生成できる最大キャラ数です.
+    //-------------------------------------------------------------------------
+    bool Init(const SpriteAnimLibrary* pLibrary, uint32_t capacity);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      再生状態を生成します.
+    //!
+    //! @return     生成できない場合は kInvalidSpriteAnimHandle を返却します.
+    //-------------------------------------------------------------------------
+    SpriteAnimHandle Create(SpriteAnimClipId clip, uint8_t dir = 0);
+
+    //-------------------------------------------------------------------------
+    //! @brief      再生状態を破棄します.
+    //-------------------------------------------------------------------------
+    void Destroy(SpriteAnimHandle handle);
+
+    //-------------------------------------------------------------------------
+    //! @brief      クリップを再生します.
+    //!
+    //! @param[in]      restart     false の場合，再生中のクリップと同じであれば続きから再生します.
+    //-------------------------------------------------------------------------
+    void Play(SpriteAnimHandle handle, SpriteAnimClipId clip, bool restart = false);
+
+    //-------------------------------------------------------------------------
+    //! @brief      向きを設定します.
+    //-------------------------------------------------------------------------
+    void SetDirection(SpriteAnimHandle handle, uint8_t dir);
+
+    //-------------------------------------------------------------------------
+    //! @brief      一時停止するかどうかを設定します.
+    //-------------------------------------------------------------------------
+    void SetPaused(SpriteAnimHandle handle, bool paused);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ループしないクリップが最後まで再生されたかどうか?
+    //-------------------------------------------------------------------------
+    bool IsFinished(SpriteAnimHandle handle) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      全キャラのアニメーションを進めます.
+    //!
+    //! @param[in]      ticks       進めるフレーム数です.
+    //-------------------------------------------------------------------------
+    void Update(uint32_t ticks = 1);
+
+    //-------------------------------------------------------------------------
+    //! @brief      現在のコマ番号を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetFrame(SpriteAnimHandle handle) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      現在のコマの領域を取得します.
+    //-------------------------------------------------------------------------
+    const TextureRegion& GetRegion(SpriteAnimHandle handle) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      生成済みの再生状態の数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCount() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    const SpriteAnimLibrary*        m_pLibrary;
+    uint32_t                        m_Capacity;
+    uint32_t                        m_Count;
+
+    // 再生状態. 生成済みのものを先頭から詰めて保持する.
+    std::vector<SpriteAnimClipId>   m_Clip;
+    std::vector<uint8_t>            m_Dir;
+    std::vector<uint8_t>            m_Paused;
+    std::vector<uint32_t>           m_Time;         // クリップの先頭からの経過フレーム.
+    std::vector<uint16_t>           m_Frame;        // Update() で求めたコマ番号.
+    std::vector<SpriteAnimHandle>   m_Handles;      // 詰めた位置からハンドルを引く.
+
+    std::vector<uint32_t>           m_Slots;        // ハンドルから詰めた位置を引く.
+    std::vector<SpriteAnimHandle>   m_FreeHandles;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    uint32_t Find(SpriteAnimHandle handle) const;
+    void Evaluate(uint32_t index);
+
+    SpriteAnimSystem            (const SpriteAnimSystem&) = delete;     // アクセス禁止.
+    SpriteAnimSystem& operator= (const SpriteAnimSystem&) = delete;     // アクセス禁止.
+};
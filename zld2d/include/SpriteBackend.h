@@ -0,0 +1,90 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteBackend.h
+// Desc : Sprite Render Backend Interface.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <asdxMath.h>
+#include <SpriteFormat.h>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kSpritePageSize         = 512;    // 1ページ(インスタンスバッファ1回分)のスプライト数.
+static const uint32_t kSpriteRetainedCapacity = 4096;   // 常駐インスタンスバッファのスプライト数.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ISpriteBackend interface
+///////////////////////////////////////////////////////////////////////////////
+struct ISpriteBackend
+{
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    virtual ~ISpriteBackend()
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      描画を開始します.
+    //!
+    //! @param[in]      transform       スクリーン座標から射影空間への変換行列です.
+    //-------------------------------------------------------------------------
+    virtual void Begin(const asdx::Matrix& transform) = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      インスタンスデータの書き込み先を取得します.
+    //!
+    //! @param[in]      count       書き込むスプライト数. kSpritePageSize 以下です.
+    //! @return     書き込み先を返却します. 失敗時は nullptr を返却します.
+    //! @note       前のページの内容は破棄されます.
+    //-------------------------------------------------------------------------
+    virtual SpriteInstance* MapPage(uint32_t count) = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      インスタンスデータの書き込みを終了します.
+    //-------------------------------------------------------------------------
+    virtual void UnmapPage() = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャを設定します.
+    //-------------------------------------------------------------------------
+    virtual void SetTexture(ID3D11ShaderResourceView* pSRV) = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      現在のページのスプライトを描画します.
+    //!
+    //! @param[in]      start       ページ内での開始スプライト番号.
+    //! @param[in]      count       スプライト数.
+    //-------------------------------------------------------------------------
+    virtual void Draw(uint32_t start, uint32_t count) = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      常駐インスタンスバッファの一部を更新します.
+    //!
+    //! @param[in]      offset      更新開始位置. kSpriteRetainedCapacity 未満です.
+    //! @param[in]      pInstances  転送するスプライトです.
+    //! @param[in]      count       スプライト数.
+    //! @note       ページとは違い，更新しなかった範囲の内容は次のフレームでも保持されます.
+    //-------------------------------------------------------------------------
+    virtual bool UpdateRetained(uint32_t offset, const SpriteInstance* pInstances, uint32_t count) = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      常駐インスタンスバッファのスプライトを描画します.
+    //!
+    //! @param[in]      start       常駐インスタンスバッファ内での開始スプライト番号.
+    //! @param[in]      count       スプライト数.
+    //-------------------------------------------------------------------------
+    virtual void DrawRetained(uint32_t start, uint32_t count) = 0;
+
+    //-------------------------------------------------------------------------
+    //! @brief      描画を終了します.
+    //-------------------------------------------------------------------------
+    virtual void End() = 0;
+};
@@ -0,0 +1,127 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteBackendD3D11.h
+// Desc : Direct3D 11 Sprite Render Backend.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <d3d11.h>
+#include <asdxRef.h>
+#include <SpriteBackend.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteBackendD3D11 class
+///////////////////////////////////////////////////////////////////////////////
+class SpriteBackendD3D11 : public ISpriteBackend
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SpriteBackendD3D11();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~SpriteBackendD3D11();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      pDevice         デバイスです.
+    //! @param[in]      pContext        描画に使うデバイスコンテキストです.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //-------------------------------------------------------------------------
+    bool Init(ID3D11Device* pDevice, ID3D11DeviceContext* pContext);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      パイプラインを設定し，描画を開始します.
+    //-------------------------------------------------------------------------
+    void Begin(const asdx::Matrix& transform) override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      インスタンスバッファをマップします.
+    //-------------------------------------------------------------------------
+    SpriteInstance* MapPage(uint32_t count) override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      インスタンスバッファをアンマップします.
+    //-------------------------------------------------------------------------
+    void UnmapPage() override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャを設定します.
+    //-------------------------------------------------------------------------
+    void SetTexture(ID3D11ShaderResourceView* pSRV) override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      インスタンス描画を発行します.
+    //-------------------------------------------------------------------------
+    void Draw(uint32_t start, uint32_t count) override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      常駐インスタンスバッファの一部を更新します.
+    //-------------------------------------------------------------------------
+    bool UpdateRetained(uint32_t offset, const SpriteInstance* pInstances, uint32_t count) override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      常駐インスタンスバッファからインスタンス描画を発行します.
+    //-------------------------------------------------------------------------
+    void DrawRetained(uint32_t start, uint32_t count) override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      シェーダとリソースをアンバインドします.
+    //-------------------------------------------------------------------------
+    void End() override;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    static const uint32_t                   InputElementCount = 4;
+    static const D3D11_INPUT_ELEMENT_DESC   InputElements[ InputElementCount ];
+
+    asdx::RefPtr<ID3D11VertexShader>    m_pVS;
+    asdx::RefPtr<ID3D11PixelShader>     m_pPS;
+    asdx::RefPtr<ID3D11Buffer>          m_pVB;
+    asdx::RefPtr<ID3D11Buffer>          m_pRetainedVB;
+    asdx::RefPtr<ID3D11Buffer>          m_pCB;
+    asdx::RefPtr<ID3D11InputLayout>     m_pIL;
+    ID3D11DeviceContext*                m_pContext;
+    ID3D11Buffer*                       m_pBoundVB;     // 現在設定しているインスタンスバッファ.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    SpriteBackendD3D11             (const SpriteBackendD3D11&) = delete;    // アクセス禁止.
+    SpriteBackendD3D11& operator = (const SpriteBackendD3D11&) = delete;    // アクセス禁止.
+
+    //-------------------------------------------------------------------------
+    //! @brief      インスタンスバッファを設定します.
+    //-------------------------------------------------------------------------
+    void BindVB(ID3D11Buffer* pVB);
+};
@@ -0,0 +1,143 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteBatch.h
+// Desc : Sprite Draw Command Builder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <SpriteFormat.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteDrawCommand structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteDrawCommand
+{
+    const void* pTexture;   //!< テクスチャハンドル.
+    uint32_t    Page;       //!< ページ番号.
+    uint32_t    Start;      //!< ページ内での開始スプライト番号.
+    uint32_t    Count;      //!< スプライト数.
+    uint16_t    Layer;      //!< 深度レイヤー. 1つのコマンドには同じレイヤーのスプライトだけが含まれます.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteBatch class
+///////////////////////////////////////////////////////////////////////////////
+class SpriteBatch
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SpriteBatch();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~SpriteBatch();
+
+    //-------------------------------------------------------------------------
+    //! @brief      メモリを予約します.
+    //-------------------------------------------------------------------------
+    void Reserve(uint32_t count);
+
+    //-------------------------------------------------------------------------
+    //! @brief      記録したスプライトとコマンドを破棄します.
+    //-------------------------------------------------------------------------
+    void Clear();
+
+    //-------------------------------------------------------------------------
+    //! @brief      スプライトから描画コマンドを構築します.
+    //!
+    //! @param[in]      pInstances      パック済みのスプライトです. レイヤーを参照します.
+    //! @param[in]      ppTextures      スプライト毎のテクスチャハンドルです.
+    //! @param[in]      count           スプライト数.
+    //! @param[in]      groupByTexture  true なら同じレイヤー内をテクスチャ毎にまとめます.
+    //! @param[in]      pageSize        1ページに格納できるスプライト数. コマンドはページ境界で分割されます.
+    //! @note       スプライトは常に奥から手前(レイヤー降順)に並べるので，深度テスト無しで描画できます.
+    //!             基数ソートなので O(n) で，同じキーの中では記録順を保ちます.
+    //-------------------------------------------------------------------------
+    void Build(
+        const SpriteInstance*   pInstances,
+        const void* const*      ppTextures,
+        uint32_t                count,
+        bool                    groupByTexture,
+        uint32_t                pageSize);
+
+    //-------------------------------------------------------------------------
+    //! @brief      構築に使ったスプライト数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetSpriteCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      描画順に並べたスプライト番号を取得します.
+    //!
+    //! @note       記録順のまま描画できる場合は空になります.
+    //-------------------------------------------------------------------------
+    const std::vector<uint32_t>& GetOrder() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      描画コマンドを取得します.
+    //-------------------------------------------------------------------------
+    const std::vector<SpriteDrawCommand>& GetCommands() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページ数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetPageCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      記録順から並べ替えたかどうか?
+    //!
+    //! @note       false の場合は GetOrder() を使わずに記録順のまま転送できます.
+    //-------------------------------------------------------------------------
+    bool IsSorted() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<uint32_t>                       m_Keys;
+    std::vector<uint32_t>                       m_TempKeys;
+    std::vector<uint32_t>                       m_Order;
+    std::vector<uint32_t>                       m_TempOrder;
+    std::vector<SpriteDrawCommand>              m_Commands;
+    std::unordered_map<const void*, uint32_t>   m_TextureIds;
+    uint32_t                                    m_Count     = 0;
+    uint32_t                                    m_PageCount = 0;
+    bool                                        m_Sorted    = false;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    SpriteBatch             (const SpriteBatch&) = delete;  // アクセス禁止.
+    SpriteBatch& operator = (const SpriteBatch&) = delete;  // アクセス禁止.
+
+    //-------------------------------------------------------------------------
+    //! @brief      m_Keys を基数ソートし，並び順を m_Order に格納します.
+    //!
+    //! @return     並べ替えが不要だった場合は false を返却します.
+    //-------------------------------------------------------------------------
+    bool RadixSort(uint32_t count);
+};
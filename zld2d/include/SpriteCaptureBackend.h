@@ -0,0 +1,169 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteCaptureBackend.h
+// Desc : Recording Sprite Render Backend.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <SpriteBackend.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SPRITE_CAPTURE_OP enum
+///////////////////////////////////////////////////////////////////////////////
+enum SPRITE_CAPTURE_OP
+{
+    SPRITE_CAPTURE_BEGIN = 0,   //!< 描画開始. Hash = 変換行列のハッシュ.
+    SPRITE_CAPTURE_UPLOAD,      //!< 転送. Arg0 = スプライト数, Arg1 = バイト数, Hash = 内容のハッシュ.
+    SPRITE_CAPTURE_TEXTURE,     //!< テクスチャ設定. Arg0 = テクスチャ番号.
+    SPRITE_CAPTURE_DRAW,        //!< 描画. Arg0 = 開始番号, Arg1 = スプライト数.
+    SPRITE_CAPTURE_END,         //!< 描画終了.
+    SPRITE_CAPTURE_RETAINED_UPLOAD, //!< 常駐バッファの部分転送. Arg0 = 開始位置, Arg1 = スプライト数, Hash = 内容のハッシュ.
+    SPRITE_CAPTURE_RETAINED_DRAW,   //!< 常駐バッファからの描画. Arg0 = 開始番号, Arg1 = スプライト数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteCaptureCommand structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteCaptureCommand
+{
+    uint32_t    Op;         //!< SPRITE_CAPTURE_OP.
+    uint32_t    Arg0;       //!< 引数0.
+    uint32_t    Arg1;       //!< 引数1.
+    uint64_t    Hash;       //!< ハッシュ値(FNV-1a 64bit).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteFrameCapture structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteFrameCapture
+{
+    std::vector<SpriteCaptureCommand>   Commands;           //!< 記録したコマンド.
+    uint32_t                            FrameCount  = 0;    //!< Begin() の回数.
+    uint32_t                            DrawCount   = 0;    //!< ドローコール数.
+    uint32_t                            BindCount   = 0;    //!< テクスチャ設定回数.
+    uint32_t                            UploadCount = 0;    //!< 転送回数.
+    uint64_t                            UploadBytes = 0;    //!< 転送バイト数.
+
+    //-------------------------------------------------------------------------
+    //! @brief      記録を破棄します.
+    //-------------------------------------------------------------------------
+    void Clear();
+
+    //-------------------------------------------------------------------------
+    //! @brief      コマンドを追加し，集計を更新します.
+    //-------------------------------------------------------------------------
+    void Push(uint32_t op, uint32_t arg0, uint32_t arg1, uint64_t hash);
+
+    //-------------------------------------------------------------------------
+    //! @brief      テキスト形式に変換します.
+    //!
+    //! @note       1行1コマンドなので diff でビルド間の差分を確認できます.
+    //-------------------------------------------------------------------------
+    std::string Serialize() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      テキスト形式から復元します.
+    //-------------------------------------------------------------------------
+    bool Deserialize(const std::string& text);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルに保存します.
+    //-------------------------------------------------------------------------
+    bool Save(const char* path) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルから読み込みます.
+    //-------------------------------------------------------------------------
+    bool Load(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      最初に食い違うコマンド番号を取得します.
+    //!
+    //! @return     一致する場合は UINT32_MAX を返却します.
+    //-------------------------------------------------------------------------
+    uint32_t FindMismatch(const SpriteFrameCapture& other) const;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteCaptureBackend class
+///////////////////////////////////////////////////////////////////////////////
+class SpriteCaptureBackend : public ISpriteBackend
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SpriteCaptureBackend();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~SpriteCaptureBackend();
+
+    //-------------------------------------------------------------------------
+    //! @brief      記録とテクスチャ番号を破棄します.
+    //-------------------------------------------------------------------------
+    void Clear();
+
+    //-------------------------------------------------------------------------
+    //! @brief      記録したキャプチャを取得します.
+    //-------------------------------------------------------------------------
+    const SpriteFrameCapture& GetCapture() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      最後に転送されたページを取得します.
+    //-------------------------------------------------------------------------
+    const SpriteInstance* GetPage() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      最後に転送されたスプライト数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetPageCount() const;
+
+    void            Begin    (const asdx::Matrix& transform) override;
+    SpriteInstance* MapPage  (uint32_t count) override;
+    void            UnmapPage() override;
+    void            SetTexture(ID3D11ShaderResourceView* pSRV) override;
+    void            Draw     (uint32_t start, uint32_t count) override;
+    bool            UpdateRetained(uint32_t offset, const SpriteInstance* pInstances, uint32_t count) override;
+    void            DrawRetained  (uint32_t start, uint32_t count) override;
+    void            End      () override;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    SpriteFrameCapture                          m_Capture;
+    std::vector<SpriteInstance>                 m_Page;
+    uint32_t                                    m_MapCount;
+    std::unordered_map<const void*, uint32_t>   m_TextureIds;   // SRVのアドレスはビルド毎に変わるので出現順の番号に置き換える.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    SpriteCaptureBackend             (const SpriteCaptureBackend&) = delete;    // アクセス禁止.
+    SpriteCaptureBackend& operator = (const SpriteCaptureBackend&) = delete;    // アクセス禁止.
+};
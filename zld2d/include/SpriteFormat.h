@@ -0,0 +1,272 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteFormat.h
+// Desc : Packed Sprite Instance Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+
+
+//-----------------------------------------------------------------------------
+// Forward Declarations.
+//-----------------------------------------------------------------------------
+struct ID3D11ShaderResourceView;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteInstance structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteInstance
+{
+    int16_t     Rect[4];        //!< 位置とサイズ(x, y, w, h). ピクセル単位.
+    uint16_t    TexRect[4];     //!< テクスチャ座標(u0, v0, u1, v1). [0, 65535]に量子化.
+    uint32_t    Color;          //!< RGBA8カラー. Rが最下位バイト.
+    uint16_t    Layer;          //!< 深度レイヤー.
+    uint16_t    Reserved;       //!< 予約領域.
+};
+static_assert(sizeof(SpriteInstance) == 24, "SpriteInstance size mismatch.");
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteVertex structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteVertex
+{
+    float   Position[3];    //!< 位置座標(x, y, layerDepth).
+    float   Color[4];       //!< 頂点カラー.
+    float   TexCoord[3];    //!< テクスチャ座標(u, v, 0).
+};
+static_assert(sizeof(SpriteVertex) == 40, "SpriteVertex size mismatch.");
+
+///////////////////////////////////////////////////////////////////////////////
+// TextureRegion structure
+///////////////////////////////////////////////////////////////////////////////
+struct TextureRegion
+{
+    ID3D11ShaderResourceView*   pSRV;           //!< テクスチャ(アトラス)です.
+    float                       TexRect[4];     //!< テクスチャ内の矩形(u0, v0, u1, v1).
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャ全体を指す領域として生成します.
+    //-------------------------------------------------------------------------
+    TextureRegion(ID3D11ShaderResourceView* srv = nullptr)
+    : pSRV(srv)
+    {
+        TexRect[0] = 0.0f;
+        TexRect[1] = 0.0f;
+        TexRect[2] = 1.0f;
+        TexRect[3] = 1.0f;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャ内の矩形を指定して生成します.
+    //-------------------------------------------------------------------------
+    TextureRegion(ID3D11ShaderResourceView* srv, float u0, float v0, float u1, float v1)
+    : pSRV(srv)
+    {
+        TexRect[0] = u0;
+        TexRect[1] = v0;
+        TexRect[2] = u1;
+        TexRect[3] = v1;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteDesc structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteDesc
+{
+    ID3D11ShaderResourceView*   pSRV;           //!< テクスチャです.
+    int32_t                     Rect[4];        //!< 位置とサイズ(x, y, w, h). ピクセル単位.
+    float                       TexRect[4];     //!< テクスチャ座標(u0, v0, u1, v1).
+    float                       Color[4];       //!< カラー(r, g, b, a).
+    int32_t                     Layer;          //!< 深度レイヤー.
+    int32_t                     Reserved;       //!< 予約領域.
+};
+static_assert(sizeof(SpriteDesc) == 56 + sizeof(void*), "SpriteDesc size mismatch.");
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kSpriteInstanceBytes  = sizeof(SpriteInstance);       // 1スプライトあたりの転送量.
+static const uint32_t kSpriteVertexBytes    = sizeof(SpriteVertex) * 4;     // 旧形式(4頂点展開)での1スプライトあたりの転送量.
+static const float    kSpriteLayerScale     = 1.0f / 256.0f;                // レイヤーから深度値への変換係数(SpriteInstVS.hlslと合わせること).
+
+
+//-----------------------------------------------------------------------------
+//      [0, 1]の値を8bitに量子化します.
+//-----------------------------------------------------------------------------
+inline uint32_t QuantizeUnorm8(float value)
+{
+    if (!(value > 0.0f)) { return 0; }
+    if (value >= 1.0f)   { return 255; }
+    return uint32_t(value * 255.0f + 0.5f);
+}
+
+//-----------------------------------------------------------------------------
+//      [0, 1]の値を16bitに量子化します.
+//-----------------------------------------------------------------------------
+inline uint16_t QuantizeUnorm16(float value)
+{
+    if (!(value > 0.0f)) { return 0; }
+    if (value >= 1.0f)   { return 65535; }
+    return uint16_t(value * 65535.0f + 0.5f);
+}
+
+//-----------------------------------------------------------------------------
+//      整数値を16bitに飽和させます.
+//-----------------------------------------------------------------------------
+inline int16_t SaturateInt16(int value)
+{
+    if (value < INT16_MIN) { return INT16_MIN; }
+    if (value > INT16_MAX) { return INT16_MAX; }
+    return int16_t(value);
+}
+
+//-----------------------------------------------------------------------------
+//      カラーをRGBA8にパックします.
+//-----------------------------------------------------------------------------
+inline uint32_t PackColor(float r, float g, float b, float a)
+{
+    return QuantizeUnorm8(r)
+        | (QuantizeUnorm8(g) << 8)
+        | (QuantizeUnorm8(b) << 16)
+        | (QuantizeUnorm8(a) << 24);
+}
+
+//-----------------------------------------------------------------------------
+//      RGBA8カラーを展開します.
+//-----------------------------------------------------------------------------
+inline void UnpackColor(uint32_t color, float result[4])
+{
+    const float kScale = 1.0f / 255.0f;
+    result[0] = float((color >>  0) & 0xff) * kScale;
+    result[1] = float((color >>  8) & 0xff) * kScale;
+    result[2] = float((color >> 16) & 0xff) * kScale;
+    result[3] = float((color >> 24) & 0xff) * kScale;
+}
+
+//-----------------------------------------------------------------------------
+//      スプライトをパックします.
+//-----------------------------------------------------------------------------
+inline SpriteInstance PackSprite
+(
+    int         x,
+    int         y,
+    int         w,
+    int         h,
+    float       u0,
+    float       v0,
+    float       u1,
+    float       v1,
+    uint32_t    color,
+    int         layerDepth
+)
+{
+    SpriteInstance result;
+    result.Rect[0]    = SaturateInt16(x);
+    result.Rect[1]    = SaturateInt16(y);
+    result.Rect[2]    = SaturateInt16(w);
+    result.Rect[3]    = SaturateInt16(h);
+    result.TexRect[0] = QuantizeUnorm16(u0);
+    result.TexRect[1] = QuantizeUnorm16(v0);
+    result.TexRect[2] = QuantizeUnorm16(u1);
+    result.TexRect[3] = QuantizeUnorm16(v1);
+    result.Color      = color;
+    result.Layer      = uint16_t((layerDepth < 0) ? 0 : (layerDepth > UINT16_MAX) ? UINT16_MAX : layerDepth);
+    result.Reserved   = 0;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      スプライトを4頂点に展開します.
+//
+//      SpriteInstVS.hlsl と同じ展開を行うCPU側の参照実装です.
+//      頂点順は 0:左上, 1:右上, 2:左下, 3:右下 (トライアングルストリップ).
+//-----------------------------------------------------------------------------
+inline void ExpandSprite(const SpriteInstance& sprite, SpriteVertex result[4])
+{
+    const float kUVScale = 1.0f / 65535.0f;
+
+    float x0 = float(sprite.Rect[0]);
+    float y0 = float(sprite.Rect[1]);
+    float x1 = x0 + float(sprite.Rect[2]);
+    float y1 = y0 + float(sprite.Rect[3]);
+    float u0 = float(sprite.TexRect[0]) * kUVScale;
+    float v0 = float(sprite.TexRect[1]) * kUVScale;
+    float u1 = float(sprite.TexRect[2]) * kUVScale;
+    float v1 = float(sprite.TexRect[3]) * kUVScale;
+    float z  = float(sprite.Layer);
+
+    float color[4];
+    UnpackColor(sprite.Color, color);
+
+    const float kX[4] = { x0, x1, x0, x1 };
+    const float kY[4] = { y0, y0, y1, y1 };
+    const float kU[4] = { u0, u1, u0, u1 };
+    const float kV[4] = { v1, v1, v0, v0 };
+
+    for(auto i=0; i<4; ++i)
+    {
+        result[i].Position[0] = kX[i];
+        result[i].Position[1] = kY[i];
+        result[i].Position[2] = z;
+        result[i].Color[0]    = color[0];
+        result[i].Color[1]    = color[1];
+        result[i].Color[2]    = color[2];
+        result[i].Color[3]    = color[3];
+        result[i].TexCoord[0] = kU[i];
+        result[i].TexCoord[1] = kV[i];
+        result[i].TexCoord[2] = 0.0f;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      スプライト記述子を設定します.
+//-----------------------------------------------------------------------------
+inline void SetSpriteDesc
+(
+    SpriteDesc&             desc,
+    const TextureRegion&    region,
+    int                     x,
+    int                     y,
+    int                     w,
+    int                     h,
+    int                     layerDepth
+)
+{
+    desc.pSRV       = region.pSRV;
+    desc.Rect[0]    = x;
+    desc.Rect[1]    = y;
+    desc.Rect[2]    = w;
+    desc.Rect[3]    = h;
+    desc.TexRect[0] = region.TexRect[0];
+    desc.TexRect[1] = region.TexRect[1];
+    desc.TexRect[2] = region.TexRect[2];
+    desc.TexRect[3] = region.TexRect[3];
+    desc.Color[0]   = 1.0f;
+    desc.Color[1]   = 1.0f;
+    desc.Color[2]   = 1.0f;
+    desc.Color[3]   = 1.0f;
+    desc.Layer      = layerDepth;
+    desc.Reserved   = 0;
+}
+
+//-----------------------------------------------------------------------------
+//! @brief      スプライト記述子をまとめてパックします(スカラー版).
+//!
+//! @param[in]      pDescs      スプライト記述子の配列.
+//! @param[in]      count       スプライト数.
+//! @param[out]     pResult     パック結果の格納先. count 個分の領域が必要です.
+//-----------------------------------------------------------------------------
+void PackSpritesScalar(const SpriteDesc* pDescs, uint32_t count, SpriteInstance* pResult);
+
+//-----------------------------------------------------------------------------
+//! @brief      スプライト記述子をまとめてパックします.
+//!
+//! @note       ビルド設定に応じてSSE2/AVX2版を使います. 結果はスカラー版と一致します.
+//-----------------------------------------------------------------------------
+void PackSprites(const SpriteDesc* pDescs, uint32_t count, SpriteInstance* pResult);
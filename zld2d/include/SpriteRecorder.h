@@ -0,0 +1,211 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteRecorder.h
+// Desc : Sprite Command Recorder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxMath.h>
+#include <Box.h>
+#include <SpriteFormat.h>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kSpriteMaxCount = 262144;     // 1フレームに記録できる最大スプライト数.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteRecorder class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      スプライトをパックして記録します.
+//!
+//! @note       1つのレコーダーは1つのスレッドからだけ使ってください.
+//!             レコーダー同士は何も共有しないので，スレッド毎にレコーダーを
+//!             用意すればロック無しで並列に記録できます.
+//!             記録した内容は SpriteSystem::Submit() でまとめます.
+///////////////////////////////////////////////////////////////////////////////
+class SpriteRecorder
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SpriteRecorder();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~SpriteRecorder();
+
+    //-------------------------------------------------------------------------
+    //! @brief      メモリを予約します.
+    //-------------------------------------------------------------------------
+    void Reserve(uint32_t count);
+
+    //-------------------------------------------------------------------------
+    //! @brief      記録したスプライトと統計を破棄します.
+    //!
+    //! @note       カラーとカリング矩形の設定は保持します.
+    //-------------------------------------------------------------------------
+    void Reset();
+
+    //-------------------------------------------------------------------------
+    //! @brief      メモリを解放します.
+    //-------------------------------------------------------------------------
+    void Release();
+
+    //-------------------------------------------------------------------------
+    //! @brief      頂点カラーを設定します.
+    //-------------------------------------------------------------------------
+    void SetColor(float r, float g, float b, float a);
+
+    //-------------------------------------------------------------------------
+    //! @brief      カリング矩形を設定します.
+    //-------------------------------------------------------------------------
+    void SetCullRect(const Box& rect);
+
+    //-------------------------------------------------------------------------
+    //! @brief      カリング矩形を解除します.
+    //-------------------------------------------------------------------------
+    void ResetCullRect();
+
+    //-------------------------------------------------------------------------
+    //! @brief      スプライトを記録します.
+    //!
+    //! @param[in]      texture     テクスチャ領域です.
+    //! @param[in]      x           描画開始位置Xです.
+    //! @param[in]      y           描画開始位置Yです.
+    //! @param[in]      w           スプライトの横幅です.
+    //! @param[in]      h           スプライトの縦幅です.
+    //! @param[in]      uv0         左下のテクスチャ座標です. テクスチャ領域内の座標です.
+    //! @param[in]      uv1         右上のテクスチャ座標です. テクスチャ領域内の座標です.
+    //! @param[in]      layerDepth  深度レイヤーです.
+    //-------------------------------------------------------------------------
+    void Draw(
+        const TextureRegion&    texture,
+        int                     x,
+        int                     y,
+        int                     w,
+        int                     h,
+        const asdx::Vector2&    uv0,
+        const asdx::Vector2&    uv1,
+        int                     layerDepth);
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャ領域全体を使うスプライトを記録します.
+    //-------------------------------------------------------------------------
+    void Draw(const TextureRegion& texture, int x, int y, int w, int h, int layerDepth);
+
+    //-------------------------------------------------------------------------
+    //! @brief      スプライトをまとめて記録します.
+    //!
+    //! @note       カラーは記述子のものを使い，SetColor() の設定は参照しません.
+    //-------------------------------------------------------------------------
+    void DrawBatch(const SpriteDesc* pDescs, uint32_t count);
+
+    //-------------------------------------------------------------------------
+    //! @brief      パック済みのスプライトを平行移動して記録します.
+    //!
+    //! @param[in]      layerDepth  深度レイヤーです. スプライトのレイヤーを上書きします.
+    //-------------------------------------------------------------------------
+    void DrawInstances(
+        const SpriteInstance*               pInstances,
+        ID3D11ShaderResourceView* const*    ppSRV,
+        uint32_t                            count,
+        int                                 offsetX,
+        int                                 offsetY,
+        int                                 layerDepth);
+
+    //-------------------------------------------------------------------------
+    //! @brief      別のレコーダーの内容を末尾に追加します.
+    //-------------------------------------------------------------------------
+    void Append(const SpriteRecorder& other);
+
+    //-------------------------------------------------------------------------
+    //! @brief      記録したスプライト数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      上限を超えて破棄されたスプライト数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetDroppedCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      カリングされたスプライト数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCulledCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      頂点カラーを取得します.
+    //-------------------------------------------------------------------------
+    const asdx::Vector4& GetColor() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      パック済みのスプライトを取得します.
+    //-------------------------------------------------------------------------
+    const SpriteInstance* GetInstances() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      スプライト毎のテクスチャを取得します.
+    //-------------------------------------------------------------------------
+    const void* const* GetTextures() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<SpriteInstance>     m_Instances;
+    std::vector<const void*>        m_Textures;
+    uint32_t                        m_Count;
+    uint32_t                        m_DroppedCount;
+    uint32_t                        m_CulledCount;
+    Box                             m_CullRect;
+    bool                            m_EnableCull;
+    asdx::Vector4                   m_Color;
+    uint32_t                        m_PackedColor;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    SpriteRecorder             (const SpriteRecorder&) = delete;    // アクセス禁止.
+    SpriteRecorder& operator = (const SpriteRecorder&) = delete;    // アクセス禁止.
+
+    //-------------------------------------------------------------------------
+    //! @brief      記録領域を確保します.
+    //!
+    //! @return     記録できるスプライト数を返却します. 上限を超えた分は破棄として数えます.
+    //-------------------------------------------------------------------------
+    uint32_t Allocate(uint32_t count);
+
+    //-------------------------------------------------------------------------
+    //! @brief      スプライト記述子をパックして記録します.
+    //-------------------------------------------------------------------------
+    void AppendBatch(const SpriteDesc* pDescs, uint32_t count);
+
+    //-------------------------------------------------------------------------
+    //! @brief      カリング矩形の完全に外側にあるかどうか?
+    //-------------------------------------------------------------------------
+    bool IsCulled(int x, int y, int w, int h) const;
+};
@@ -0,0 +1,231 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteRetainedList.h
+// Desc : Retained Mode Sprite List.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxMath.h>
+#include <SpriteBatch.h>
+#include <SpriteFormat.h>
+
+
+//-----------------------------------------------------------------------------
+// Type Definitions.
+//-----------------------------------------------------------------------------
+typedef uint32_t SpriteHandle;
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const SpriteHandle kInvalidSpriteHandle = UINT32_MAX;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteDirtyRange structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteDirtyRange
+{
+    uint32_t    Start;      //!< 開始位置.
+    uint32_t    Count;      //!< スプライト数.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteRetainedList class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      毎フレーム記録し直さずに描画し続けるスプライトのリストです.
+//!
+//! @note       位置やカラーの変更はそのスプライトだけを更新対象にし,
+//!             SpriteSystem::DrawRetained() で変更のあった範囲だけを転送します.
+//!             生成・破棄・テクスチャやレイヤーの変更は並び順を作り直すので全体を転送します.
+///////////////////////////////////////////////////////////////////////////////
+class SpriteRetainedList
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    friend class SpriteSystem;
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SpriteRetainedList();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~SpriteRetainedList();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      capacity    生成できる最大スプライト数です.
+    //-------------------------------------------------------------------------
+    bool Init(uint32_t capacity);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //!
+    //! @note       SpriteSystem の領域は SpriteSystem::ReleaseRetained() で解放してください.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      スプライトを生成します.
+    //!
+    //! @return     ハンドルを返却します. 上限を超えた場合は kInvalidSpriteHandle を返却します.
+    //-------------------------------------------------------------------------
+    SpriteHandle Create(
+        const TextureRegion&    texture,
+        int                     x,
+        int                     y,
+        int                     w,
+        int                     h,
+        int                     layerDepth,
+        const asdx::Vector4&    color);
+
+    //-------------------------------------------------------------------------
+    //! @brief      スプライトを破棄します.
+    //-------------------------------------------------------------------------
+    void Destroy(SpriteHandle handle);
+
+    //-------------------------------------------------------------------------
+    //! @brief      全てのスプライトを破棄します.
+    //-------------------------------------------------------------------------
+    void Clear();
+
+    //-------------------------------------------------------------------------
+    //! @brief      位置を設定します.
+    //-------------------------------------------------------------------------
+    void SetPosition(SpriteHandle handle, int x, int y);
+
+    //-------------------------------------------------------------------------
+    //! @brief      カラーを設定します.
+    //-------------------------------------------------------------------------
+    void SetColor(SpriteHandle handle, float r, float g, float b, float a);
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャを設定します.
+    //!
+    //! @note       テクスチャ(SRV)が変わる場合は並び順を作り直します.
+    //-------------------------------------------------------------------------
+    void SetTexture(SpriteHandle handle, const TextureRegion& texture);
+
+    //-------------------------------------------------------------------------
+    //! @brief      表示するかどうかを設定します.
+    //-------------------------------------------------------------------------
+    void SetVisible(SpriteHandle handle, bool visible);
+
+    //-------------------------------------------------------------------------
+    //! @brief      変更を並び順に反映します.
+    //!
+    //! @note       SpriteSystem::End() から呼ばれます.
+    //-------------------------------------------------------------------------
+    void Flush();
+
+    //-------------------------------------------------------------------------
+    //! @brief      転送が必要な範囲を取得します.
+    //!
+    //! @param[out]     result      転送範囲. Flush() 後の並び順での位置です.
+    //! @note       離れた範囲は近ければ1つにまとめます.
+    //-------------------------------------------------------------------------
+    void GetDirtyRanges(std::vector<SpriteDirtyRange>& result) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      転送済みとして更新フラグを下ろします.
+    //-------------------------------------------------------------------------
+    void ClearDirty();
+
+    //-------------------------------------------------------------------------
+    //! @brief      全体を転送対象にします.
+    //-------------------------------------------------------------------------
+    void MarkAllDirty();
+
+    //-------------------------------------------------------------------------
+    //! @brief      並び順を作り直す必要があるかどうか?
+    //-------------------------------------------------------------------------
+    bool IsLayoutDirty() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      最大スプライト数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCapacity() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      描画するスプライト数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      描画順に並べたスプライトを取得します.
+    //-------------------------------------------------------------------------
+    const SpriteInstance* GetInstances() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      描画コマンドを取得します.
+    //!
+    //! @note       Start はリスト内での位置です. Page は使いません.
+    //!             コマンドはテクスチャとレイヤーが変わる位置で分割されます.
+    //-------------------------------------------------------------------------
+    const std::vector<SpriteDrawCommand>& GetCommands() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Record structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Record
+    {
+        SpriteInstance  Instance;       //!< パック済みのスプライト.
+        const void*     pTexture;       //!< テクスチャ.
+        uint32_t        Position;       //!< 描画順での位置. 描画しない場合は UINT32_MAX.
+        bool            Alive;          //!< 生成済みかどうか.
+        bool            Visible;        //!< 表示するかどうか.
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<Record>             m_Records;
+    std::vector<SpriteHandle>       m_FreeHandles;
+    std::vector<SpriteInstance>     m_Instances;
+    std::vector<uint8_t>            m_Dirty;
+    std::vector<uint64_t>           m_Keys;
+    std::vector<SpriteDrawCommand>  m_Commands;
+    uint32_t                        m_Capacity;
+    uint32_t                        m_DirtyCount;
+    bool                            m_LayoutDirty;
+    uint32_t                        m_Region;       // SpriteSystem 内の転送先. 未確保なら UINT32_MAX.
+    uint32_t                        m_RegionSize;   // SpriteSystem 内で確保したスプライト数.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    SpriteRetainedList             (const SpriteRetainedList&) = delete;    // アクセス禁止.
+    SpriteRetainedList& operator = (const SpriteRetainedList&) = delete;    // アクセス禁止.
+
+    //-------------------------------------------------------------------------
+    //! @brief      有効なハンドルであればレコードを返却します.
+    //-------------------------------------------------------------------------
+    Record* Find(SpriteHandle handle);
+
+    //-------------------------------------------------------------------------
+    //! @brief      レコードの内容を描画順の配列に書き込み，更新対象にします.
+    //-------------------------------------------------------------------------
+    void Write(const Record& record);
+};
@@ -0,0 +1,215 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteSoftwareBackend.h
+// Desc : Software Rasterizer Sprite Render Backend.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <SpriteBackend.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteSoftwareBackend class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      GPUを使わずにスプライトを描画するバックエンドです.
+//!
+//! @note       SpriteInstVS.hlsl + SpritePS.hlsl と同じ結果になるように描画します.
+//!             (LinearClampサンプリング, 頂点カラー乗算, 深度テスト無し,
+//!              SRC_ALPHA / INV_SRC_ALPHA のαブレンド)
+//!             タイル内のスプライトは発行順に塗るので，奥から手前の順序が保たれます.
+//!             描画は End() でタイル単位に分割して複数スレッドで行います.
+///////////////////////////////////////////////////////////////////////////////
+class SpriteSoftwareBackend : public ISpriteBackend
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SpriteSoftwareBackend();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~SpriteSoftwareBackend();
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      width           レンダーターゲットの横幅です.
+    //! @param[in]      height          レンダーターゲットの縦幅です.
+    //! @param[in]      threadCount     描画スレッド数. 0 ならコア数に合わせます.
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //-------------------------------------------------------------------------
+    bool Init(uint32_t width, uint32_t height, uint32_t threadCount = 0);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      カラーをクリアします.
+    //-------------------------------------------------------------------------
+    void Clear(float r, float g, float b, float a);
+
+    //-------------------------------------------------------------------------
+    //! @brief      シザー矩形を設定します.
+    //-------------------------------------------------------------------------
+    void SetScissor(int x, int y, int w, int h);
+
+    //-------------------------------------------------------------------------
+    //! @brief      シザー矩形をレンダーターゲット全体に戻します.
+    //-------------------------------------------------------------------------
+    void ResetScissor();
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャを登録します.
+    //!
+    //! @param[in]      pSRV        描画時に SetTexture() で渡されるキーです.
+    //! @param[in]      width       横幅です.
+    //! @param[in]      height      縦幅です.
+    //! @param[in]      pitch       1行あたりのバイト数です.
+    //! @param[in]      pPixels     RGBA8のピクセルデータ. 内部にコピーします.
+    //-------------------------------------------------------------------------
+    bool RegisterTexture(
+        ID3D11ShaderResourceView*   pSRV,
+        uint32_t                    width,
+        uint32_t                    height,
+        uint32_t                    pitch,
+        const void*                 pPixels);
+
+    //-------------------------------------------------------------------------
+    //! @brief      テクスチャの登録を解除します.
+    //-------------------------------------------------------------------------
+    void UnregisterTexture(ID3D11ShaderResourceView* pSRV);
+
+    //-------------------------------------------------------------------------
+    //! @brief      画面切り替えを合成します.
+    //!
+    //! @note       SwitchPS.hlsl と同じ計算で全画面に合成します.
+    //!             radius が 0 以下ならフェード, それ以外は穴あきになります.
+    //-------------------------------------------------------------------------
+    void ApplySwitch(const asdx::Vector4& color, const asdx::Vector2& center, float radius);
+
+    //-------------------------------------------------------------------------
+    //! @brief      レンダーターゲットをTGA形式で保存します.
+    //-------------------------------------------------------------------------
+    bool SaveTGA(const char* path) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      レンダーターゲットのピクセルデータ(RGBA8)を取得します.
+    //-------------------------------------------------------------------------
+    const uint32_t* GetPixels() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      レンダーターゲットの横幅を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetWidth() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      レンダーターゲットの縦幅を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetHeight() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      描画スレッド数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetThreadCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      シェーディングしたピクセル数の累計を取得します.
+    //!
+    //! @note       フィルレートの計測用です. Clear() ではリセットされません.
+    //-------------------------------------------------------------------------
+    uint64_t GetShadedPixelCount() const;
+
+    void            Begin     (const asdx::Matrix& transform) override;
+    SpriteInstance* MapPage   (uint32_t count) override;
+    void            UnmapPage () override;
+    void            SetTexture(ID3D11ShaderResourceView* pSRV) override;
+    void            Draw      (uint32_t start, uint32_t count) override;
+    bool            UpdateRetained(uint32_t offset, const SpriteInstance* pInstances, uint32_t count) override;
+    void            DrawRetained  (uint32_t start, uint32_t count) override;
+    void            End       () override;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Texture structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Texture
+    {
+        uint32_t                Width;
+        uint32_t                Height;
+        std::vector<uint32_t>   Pixels;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Quad structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Quad
+    {
+        const Texture*  pTexture;       //!< テクスチャ. nullptr なら黒(α=0)をサンプルします.
+        int             Bounds[4];      //!< 塗りつぶすピクセル範囲(x0, y0, x1, y1). x1, y1 は含みません.
+        float           Origin[2];      //!< 頂点0のピクセル座標.
+        float           TexCoord[2];    //!< 頂点0のテクスチャ座標.
+        float           Gradient[2];    //!< 1ピクセルあたりのテクスチャ座標の変化量(du/dx, dv/dy).
+        float           Color[4];       //!< 頂点カラー.
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    uint32_t                                                m_Width;
+    uint32_t                                                m_Height;
+    uint32_t                                                m_ThreadCount;
+    int                                                     m_Scissor[4];
+    std::vector<uint32_t>                                   m_Color;
+    std::unordered_map<const void*, Texture>                m_Textures;
+    const Texture*                                          m_pCurrTexture;
+    float                                                   m_Scale [2];
+    float                                                   m_Offset[2];
+    std::vector<SpriteInstance>                             m_Page;
+    std::vector<SpriteInstance>                             m_Retained;
+    std::vector<Quad>                                       m_Quads;
+    std::vector<std::vector<uint32_t>>                      m_Bins;
+    uint64_t                                                m_ShadedPixels;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    SpriteSoftwareBackend             (const SpriteSoftwareBackend&) = delete;  // アクセス禁止.
+    SpriteSoftwareBackend& operator = (const SpriteSoftwareBackend&) = delete;  // アクセス禁止.
+
+    //-------------------------------------------------------------------------
+    //! @brief      スプライトを矩形に変換して記録します.
+    //-------------------------------------------------------------------------
+    void AddQuads(const SpriteInstance* pSprites, uint32_t count);
+
+    //-------------------------------------------------------------------------
+    //! @brief      1タイル分のスプライトを描画します.
+    //!
+    //! @return     シェーディングしたピクセル数を返却します.
+    //-------------------------------------------------------------------------
+    uint64_t RasterizeTile(uint32_t tileIndex);
+};
@@ -0,0 +1,148 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteStats.h
+// Desc : Sprite Pipeline Statistics.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kSpriteStatsHistory = 120;    // 最小・平均・最大を求めるフレーム数.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SPRITE_STAT enum
+///////////////////////////////////////////////////////////////////////////////
+enum SPRITE_STAT
+{
+    SPRITE_STAT_SUBMITTED = 0,      //!< 描画したスプライト数(常駐スプライトを含む).
+    SPRITE_STAT_DROPPED,            //!< 上限を超えて破棄されたスプライト数.
+    SPRITE_STAT_CULLED,             //!< カリングされたスプライト数.
+    SPRITE_STAT_DRAW_CALLS,         //!< ドローコール数.
+    SPRITE_STAT_TEXTURE_SWITCHES,   //!< テクスチャ(SRV)の切り替え回数.
+    SPRITE_STAT_STATE_CHANGES,      //!< パイプライン設定とインスタンスバッファの切り替え回数.
+    SPRITE_STAT_UPLOAD_BYTES,       //!< インスタンスバッファに転送したバイト数.
+    SPRITE_STAT_RECORD_TIME,        //!< Begin() から End() までのCPU時間(マイクロ秒).
+    SPRITE_STAT_SUBMIT_TIME,        //!< End() のCPU時間(マイクロ秒).
+    SPRITE_STAT_COUNT,
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteFrameStats structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteFrameStats
+{
+    uint64_t    Values[SPRITE_STAT_COUNT] = {};     //!< SPRITE_STAT 毎の値.
+
+    //-------------------------------------------------------------------------
+    //! @brief      全ての値を0にします.
+    //-------------------------------------------------------------------------
+    void Clear();
+
+    //-------------------------------------------------------------------------
+    //! @brief      値を加算します.
+    //-------------------------------------------------------------------------
+    void Add(const SpriteFrameStats& other);
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteStatSummary structure
+///////////////////////////////////////////////////////////////////////////////
+struct SpriteStatSummary
+{
+    uint64_t    Last;       //!< 直前のフレームの値.
+    uint64_t    Min;        //!< 最小値.
+    uint64_t    Max;        //!< 最大値.
+    double      Avg;        //!< 平均値.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteStats class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      スプライト描画の統計を直近 kSpriteStatsHistory フレーム分保持します.
+///////////////////////////////////////////////////////////////////////////////
+class SpriteStats
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SpriteStats();
+
+    //-------------------------------------------------------------------------
+    //! @brief      履歴を破棄します.
+    //-------------------------------------------------------------------------
+    void Reset();
+
+    //-------------------------------------------------------------------------
+    //! @brief      1フレーム分の統計を追加します.
+    //!
+    //! @note       最も古いフレームは履歴から外れます.
+    //-------------------------------------------------------------------------
+    void Push(const SpriteFrameStats& frame);
+
+    //-------------------------------------------------------------------------
+    //! @brief      直前のフレームの統計を取得します.
+    //-------------------------------------------------------------------------
+    const SpriteFrameStats& GetLast() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      履歴の最小・平均・最大を取得します.
+    //-------------------------------------------------------------------------
+    SpriteStatSummary GetSummary(SPRITE_STAT stat) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      古い順に i 番目のフレームの値を取得します.
+    //!
+    //! @param[in]      index       GetFrameCount() 未満の番号です.
+    //-------------------------------------------------------------------------
+    uint64_t GetHistory(SPRITE_STAT stat, uint32_t index) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      履歴に保持しているフレーム数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetFrameCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      項目名を取得します.
+    //-------------------------------------------------------------------------
+    static const char* GetName(SPRITE_STAT stat);
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    SpriteFrameStats    m_History[kSpriteStatsHistory];
+    uint64_t            m_Sum[SPRITE_STAT_COUNT];
+    uint32_t            m_Head;         // 次に書き込む位置.
+    uint32_t            m_Count;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
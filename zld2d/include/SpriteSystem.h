@@ -8,11 +8,16 @@
 //-------------------------------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------------------------------
-#include <d3d11.h>
 #include <asdxMath.h>
-#include <asdxRef.h>
 #include <vector>
+#include <chrono>
 #include <Box.h>
+#include <SpriteBatch.h>
+#include <SpriteFormat.h>
+#include <SpriteBackend.h>
+#include <SpriteRecorder.h>
+#include <SpriteRetainedList.h>
+#include <SpriteStats.h>
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -48,13 +53,13 @@ public:
     //---------------------------------------------------------------------------------------------
     //! @brief      初期化処理を行います.
     //!
-    //! @param[in]      pDevice         デバイスです.
+    //! @param[in]      pBackend        描画バックエンドです. 終了処理まで保持します.
     //! @param[in]      screenWidth     スクリーンの横幅です.
     //! @param[in]      screenHeight    スクリーンの縦幅です.
     //! @retval true    初期化に成功.
     //! @retval false   初期化に失敗.
     //---------------------------------------------------------------------------------------------
-    bool Init( ID3D11Device* pDevice, float screenWidth, float screenHeight );
+    bool Init( ISpriteBackend* pBackend, float screenWidth, float screenHeight );
 
     //---------------------------------------------------------------------------------------------
     //! @brief      終了処理を行います.
@@ -63,21 +68,18 @@ public:
 
     //---------------------------------------------------------------------------------------------
     //! @brief      描画開始処理を行います.
-    //!
-    //! @param[in]      pDeviceContext      デバイスコンテキストです.
-    //! @param[in]      shaderType          設定するシェーダのタイプです.
     //---------------------------------------------------------------------------------------------
-    void Begin( ID3D11DeviceContext* pDeviceContext );
+    void Begin();
 
     //---------------------------------------------------------------------------------------------
     //! @brief      スプライトを描画します.
     //---------------------------------------------------------------------------------------------
-    void Draw(ID3D11ShaderResourceView* pSRV, const Box& box);
+    void Draw(const TextureRegion& texture, const Box& box);
 
     //---------------------------------------------------------------------------------------------
     //! @brief      スプライトを描画します.
     //---------------------------------------------------------------------------------------------
-    void Draw(ID3D11ShaderResourceView* pSRV, const Box& box, int layerDepth);
+    void Draw(const TextureRegion& texture, const Box& box, int layerDepth);
 
     //---------------------------------------------------------------------------------------------
     //! @brief      スプライトを描画します.
@@ -87,7 +89,7 @@ public:
     //! @param[in]      w           スプライトの横幅です.
     //! @param[in]      h           スプライトの縦幅です.
     //---------------------------------------------------------------------------------------------
-    void Draw( ID3D11ShaderResourceView* pSRV, const int x, const int y, const int w, const int h );
+    void Draw( const TextureRegion& texture, const int x, const int y, const int w, const int h );
 
     //---------------------------------------------------------------------------------------------
     //! @brief      スプライトを描画します.
@@ -99,7 +101,7 @@ public:
     //! @param[in]      uv0         左下のテクスチャ座標です.
     //! @param[in]      uv1         右上のテクスチャ座標です.
     //---------------------------------------------------------------------------------------------
-    void Draw( ID3D11ShaderResourceView* pSRV, const int x, const int y, const int w, const int h, const asdx::Vector2& uv0, const asdx::Vector2& uv1 );
+    void Draw( const TextureRegion& texture, const int x, const int y, const int w, const int h, const asdx::Vector2& uv0, const asdx::Vector2& uv1 );
 
     //---------------------------------------------------------------------------------------------
     //! @brief      スプライトを描画します.
@@ -110,7 +112,7 @@ public:
     //! @param[in]      h           スプライトの縦幅です.
     //! @param[in]      layerDepth  深度レイヤーです.
     //---------------------------------------------------------------------------------------------
-    void Draw( ID3D11ShaderResourceView* pSRV, const int x, const int y, const int w, const int h, const int layerDepth );
+    void Draw( const TextureRegion& texture, const int x, const int y, const int w, const int h, const int layerDepth );
 
     //---------------------------------------------------------------------------------------------
     //! @brief      スプライトを描画します.
@@ -123,14 +125,65 @@ public:
     //! @param[in]      uv1         右上のテクスチャ座標です.
     //! @param[in]      layerDepth  深度レイヤーです.
     //---------------------------------------------------------------------------------------------
-    void Draw( ID3D11ShaderResourceView* pSRV, const int x, const int y, const int w, const int h, const asdx::Vector2& uv0, const asdx::Vector2& uv1, const int layerDepth );
+    void Draw( const TextureRegion& texture, const int x, const int y, const int w, const int h, const asdx::Vector2& uv0, const asdx::Vector2& uv1, const int layerDepth );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      スプライトをまとめて描画します.
+    //!
+    //! @param[in]      pDescs      スプライト記述子の配列です.
+    //! @param[in]      count       スプライト数です.
+    //! @note       カラーは記述子のものを使い，SetColor() の設定は参照しません.
+    //---------------------------------------------------------------------------------------------
+    void DrawBatch( const SpriteDesc* pDescs, uint32_t count );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      パック済みのスプライトを平行移動して描画します.
+    //!
+    //! @param[in]      pInstances  パック済みのスプライトです.
+    //! @param[in]      ppSRV       スプライト毎のテクスチャです.
+    //! @param[in]      count       スプライト数です.
+    //! @param[in]      offsetX     X方向の移動量です.
+    //! @param[in]      offsetY     Y方向の移動量です.
+    //! @param[in]      layerDepth  深度レイヤーです. スプライトのレイヤーを上書きします.
+    //---------------------------------------------------------------------------------------------
+    void DrawInstances(
+        const SpriteInstance*               pInstances,
+        ID3D11ShaderResourceView* const*    ppSRV,
+        uint32_t                            count,
+        int                                 offsetX,
+        int                                 offsetY,
+        int                                 layerDepth );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      別スレッドで記録したスプライトを追加します.
+    //!
+    //! @param[in]      recorder    記録済みのレコーダーです. 記録したスレッドとの同期は呼び出し側で行ってください.
+    //! @note       Begin() と End() の間で呼び出してください. 追加した順に記録順が決まるので,
+    //!             毎フレーム同じ順に追加すれば記録スレッドの実行順に依らず同じ描画結果になります.
+    //---------------------------------------------------------------------------------------------
+    void Submit( const SpriteRecorder& recorder );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐スプライトのリストを描画します.
+    //!
+    //! @param[in]      list        描画するリストです. End() まで保持してください.
+    //! @note       Begin() と End() の間で呼び出してください. 前のフレームから変更のあった範囲だけを
+    //!             常駐インスタンスバッファに転送します. 記録したスプライトとはレイヤー順に混ぜて描画し,
+    //!             同じレイヤーでは記録したスプライトの後に描画します.
+    //---------------------------------------------------------------------------------------------
+    void DrawRetained( SpriteRetainedList& list );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐スプライトのリストに割り当てた常駐インスタンスバッファの領域を解放します.
+    //---------------------------------------------------------------------------------------------
+    void ReleaseRetained( SpriteRetainedList& list );
 
     //---------------------------------------------------------------------------------------------
     //! @brief      描画終了処理を行います.
     //!
-    //! @param[in]      pDeviceContext      デバイスコンテキストです.
+    //! @note       記録したスプライトをまとめてバックエンドに発行します.
     //---------------------------------------------------------------------------------------------
-    void End( ID3D11DeviceContext* pDeviceContext );
+    void End();
 
     //---------------------------------------------------------------------------------------------
     //! @brief      スクリーンサイズを設定します.
@@ -150,6 +203,88 @@ public:
     //---------------------------------------------------------------------------------------------
     void SetColor( float r, float g, float b, float a );
 
+    //---------------------------------------------------------------------------------------------
+    //! @brief      カリング矩形を設定します.
+    //!
+    //! @param[in]      rect        カリング矩形です. 完全に外側にあるスプライトは記録されません.
+    //! @note       シザー矩形と合わせて設定してください. ResetCullRect() を呼ぶまで有効です.
+    //---------------------------------------------------------------------------------------------
+    void SetCullRect( const Box& rect );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      カリング矩形を解除します.
+    //---------------------------------------------------------------------------------------------
+    void ResetCullRect();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      描画前にスプライトをソートするかどうかを設定します.
+    //!
+    //! @param[in]      enable      true なら同じレイヤー内をテクスチャ毎にまとめてからドローコールを発行します.
+    //! @note       レイヤー順(奥から手前)の並べ替えは設定に関わらず常に行います.
+    //---------------------------------------------------------------------------------------------
+    void SetSortMode( bool enable );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      描画前にスプライトをソートするかどうか?
+    //---------------------------------------------------------------------------------------------
+    bool GetSortMode() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      直前の End() で発行したドローコール数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetDrawCallCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      直前の End() でバックエンドに転送したバイト数を取得します.
+    //!
+    //! @note       ページの転送と常駐インスタンスバッファの部分転送の合計です. 診断用です.
+    //---------------------------------------------------------------------------------------------
+    uint64_t GetUploadedBytes() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計を集計するかどうかを設定します.
+    //!
+    //! @param[in]      enable      true なら End() 毎に統計を集計します. 無効時は時刻の取得も行いません.
+    //---------------------------------------------------------------------------------------------
+    void SetStatsEnabled( bool enable );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計を集計するかどうか?
+    //---------------------------------------------------------------------------------------------
+    bool IsStatsEnabled() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1フレーム分の統計を確定し，履歴に追加します.
+    //!
+    //! @note       1フレームに複数回 Begin() / End() する場合は，その合計が1フレーム分になります.
+    //!             フレームの最後に1回呼び出してください.
+    //---------------------------------------------------------------------------------------------
+    void FlushStats();
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      統計の履歴を取得します.
+    //---------------------------------------------------------------------------------------------
+    const SpriteStats& GetStats() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      現在のフレームで記録されたスプライト数を取得します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetSpriteCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      上限(MAX_SPRITES)を超えて破棄されたスプライト数を取得します.
+    //!
+    //! @note       Begin() でリセットされます. 診断用です.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetDroppedCount() const;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      カリング矩形の外側にあり記録されなかったスプライト数を取得します.
+    //!
+    //! @note       Begin() でリセットされます. 診断用です.
+    //---------------------------------------------------------------------------------------------
+    uint32_t GetCulledCount() const;
+
     //---------------------------------------------------------------------------------------------
     //! @brief      スクリーンサイズを取得します.
     //!
@@ -165,44 +300,85 @@ public:
     asdx::Vector4 GetColor() const;
 
 protected:
+    typedef std::chrono::steady_clock StatsClock;
+
     ///////////////////////////////////////////////////////////////////////////////////////////////
-    // Vertex structure
+    // RetainedRegion structure
     ///////////////////////////////////////////////////////////////////////////////////////////////
-    struct Vertex
+    struct RetainedRegion
     {
-        asdx::Vector3 Position;     //!< 位置座標です.
-        asdx::Vector4 Color;        //!< 頂点カラーです.
-        asdx::Vector3 TexCoord;     //!< テクスチャ座標です.
+        uint32_t    Offset;     //!< 常駐インスタンスバッファ内の開始位置.
+        uint32_t    Count;      //!< スプライト数.
     };
 
     //=============================================================================================
     // protectecd variables.
     //=============================================================================================
-    static const size_t                     InputElementCount = 3;
-    static const D3D11_INPUT_ELEMENT_DESC   InputElements[ InputElementCount ];
-
-    static const size_t     NUM_SPRITES             = 512;
-    static const size_t     NUM_VERTEX_PER_SPRITE   = 4;
-    static const size_t     NUM_INDEX_PER_SPRITE    = 6;
-
-    asdx::RefPtr<ID3D11VertexShader> m_pVS;
-    asdx::RefPtr<ID3D11PixelShader>  m_pPS;
-    asdx::RefPtr<ID3D11Buffer>       m_pVB;
-    asdx::RefPtr<ID3D11Buffer>       m_pIB;
-    asdx::RefPtr<ID3D11Buffer>       m_pCB;
-    asdx::RefPtr<ID3D11InputLayout>  m_pIL;
-    std::vector<ID3D11ShaderResourceView*> m_SRV;
-
-    uint32_t        m_SpriteCount;
+    static const size_t     NUM_SPRITES             = kSpritePageSize;  // 1ページ(インスタンスバッファ1回分)のスプライト数.
+    static const size_t     MAX_SPRITES             = kSpriteMaxCount;  // 1フレームに記録できる最大スプライト数.
+
+    ISpriteBackend*         m_pBackend;
+    SpriteRecorder          m_Recorder;
+    SpriteBatch             m_Batch;
+
+    std::vector<SpriteRetainedList*>    m_RetainedLists;    // 現在のフレームで描画する常駐スプライトのリスト.
+    std::vector<RetainedRegion>         m_FreeRegions;      // 常駐インスタンスバッファの空き領域(開始位置順).
+    std::vector<SpriteDirtyRange>       m_DirtyRanges;
+    std::vector<SpriteDrawCommand>      m_RetainedCommands; // 常駐スプライトの描画コマンド(レイヤー降順). Start は常駐インスタンスバッファ内の位置.
+
+    uint32_t        m_DrawCallCount;
+    uint64_t        m_UploadedBytes;
+    uint32_t        m_TextureSwitchCount;
+    uint32_t        m_StateChangeCount;
+    const void*     m_pBoundTexture;
+    bool            m_IsTextureBound;
+    bool            m_IsRetainedBound;
+
+    bool                    m_EnableStats;
+    SpriteFrameStats        m_FrameStats;   // FlushStats() までの End() の合計.
+    SpriteStats             m_Stats;
+    StatsClock::time_point  m_BeginTime;
+    bool            m_Sort;
     asdx::Vector2   m_ScreenSize;
-    asdx::Vector4   m_Color;
     asdx::Matrix    m_Transform;
-    std::vector<Vertex> m_Vertices;
 
     //=============================================================================================
     // protected methods.
     //=============================================================================================
-    /* NOTHING */
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      1ページ分のインスタンスデータをインスタンスバッファに転送します.
+    //---------------------------------------------------------------------------------------------
+    bool UploadPage( uint32_t page );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐スプライトのリストの変更をバックエンドに転送し，描画コマンドを集めます.
+    //---------------------------------------------------------------------------------------------
+    void UploadRetained( SpriteRetainedList& list );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      描画コマンドを発行します.
+    //!
+    //! @param[in]      retained    true なら常駐インスタンスバッファから描画します.
+    //---------------------------------------------------------------------------------------------
+    void IssueDraw( const SpriteDrawCommand& cmd, bool retained );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      End() の統計を現在のフレームに加算します.
+    //---------------------------------------------------------------------------------------------
+    void AccumulateStats( const StatsClock::time_point& start );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐インスタンスバッファの領域を確保します.
+    //!
+    //! @return     開始位置を返却します. 空きが無い場合は UINT32_MAX を返却します.
+    //---------------------------------------------------------------------------------------------
+    uint32_t AllocRegion( uint32_t count );
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      常駐インスタンスバッファの領域を解放します.
+    //---------------------------------------------------------------------------------------------
+    void FreeRegion( uint32_t offset, uint32_t count );
 
 private:
     //=============================================================================================
@@ -59,6 +59,9 @@ public:
     void Term();
     void Update(float elaspedTime, const asdx::Vector2& player);
     bool IsDraw() const;
+    const asdx::Vector4& GetColor() const;
+    const asdx::Vector2& GetCenter() const;
+    float GetRadius() const;
     void Bind(ID3D11DeviceContext* pContext);
     void Unbind(ID3D11DeviceContext* pContext);
     void OnMessage(const Message& msg) override;
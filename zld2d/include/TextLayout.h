@@ -0,0 +1,313 @@
+﻿//-----------------------------------------------------------------------------
+// File : TextLayout.h
+// Desc : Text Layout.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ITextMetrics interface
+///////////////////////////////////////////////////////////////////////////////
+struct ITextMetrics
+{
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    virtual ~ITextMetrics()
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字の送り幅を取得します.
+    //!
+    //! @param[in]      code        Unicode のコードポイントです.
+    //-------------------------------------------------------------------------
+    virtual int32_t GetAdvance(uint32_t code) = 0;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextLayoutBox structure
+///////////////////////////////////////////////////////////////////////////////
+struct TextLayoutBox
+{
+    int32_t     Width;      //!< 行の最大幅.
+    uint32_t    MaxLines;   //!< 最大行数. 0 の場合は制限しません.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextLine structure
+///////////////////////////////////////////////////////////////////////////////
+struct TextLine
+{
+    uint32_t    Offset;     //!< 行の先頭位置(コードユニット単位).
+    uint32_t    Length;     //!< 行の長さ(コードユニット単位). 行末の空白と改行は含みません.
+    int32_t     Width;      //!< 行の横幅.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextLayoutResult structure
+///////////////////////////////////////////////////////////////////////////////
+struct TextLayoutResult
+{
+    const TextLine* pLines;     //!< 行の配列.
+    uint32_t        LineCount;  //!< 行数.
+    int32_t         Width;      //!< 最も長い行の横幅.
+    bool            Truncated;  //!< 最大行数に収まらなかったかどうか?
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextLayout class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      テキストを計測し，ボックスの幅で改行位置を決めます.
+//!
+//! @note       和文は文字間で，欧文は空白で折り返します.
+//!             行頭禁則文字は前の行へ追い出し，句読点は行末へのぶら下げを許します.
+//!             行末禁則文字は次の文字と一緒に次の行へ送ります.
+//!             '\n' は強制改行として扱います.
+///////////////////////////////////////////////////////////////////////////////
+class TextLayout
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      UTF-16 のテキストを行に分割します.
+    //!
+    //! @param[in]      pMetrics    文字の送り幅です.
+    //! @param[in]      text        null終端のテキストです.
+    //! @param[in]      box         レイアウトするボックスです.
+    //! @param[out]     lines       行を追加します.
+    //! @param[out]     result      行数などを設定します. pLines は設定しません.
+    //-------------------------------------------------------------------------
+    void Layout(
+        ITextMetrics*           pMetrics,
+        const wchar_t*          text,
+        const TextLayoutBox&    box,
+        std::vector<TextLine>&  lines,
+        TextLayoutResult&       result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      UTF-8 のテキストを行に分割します.
+    //!
+    //! @note       行の位置と長さはバイト単位になります.
+    //-------------------------------------------------------------------------
+    void Layout(
+        ITextMetrics*           pMetrics,
+        const char*             text,
+        const TextLayoutBox&    box,
+        std::vector<TextLine>&  lines,
+        TextLayoutResult&       result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      行頭に置けない文字かどうか?
+    //-------------------------------------------------------------------------
+    static bool IsNoStart(uint32_t code);
+
+    //-------------------------------------------------------------------------
+    //! @brief      行末に置けない文字かどうか?
+    //-------------------------------------------------------------------------
+    static bool IsNoEnd(uint32_t code);
+
+    //-------------------------------------------------------------------------
+    //! @brief      行末にぶら下げてよい文字かどうか?
+    //-------------------------------------------------------------------------
+    static bool IsHanging(uint32_t code);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Glyph structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Glyph
+    {
+        uint32_t    Code;       // コードポイント.
+        uint32_t    Offset;     // 先頭位置(コードユニット単位).
+        int32_t     Advance;    // 送り幅.
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<Glyph>  m_Glyphs;   // デコード済みの文字. 末尾は終端位置の番兵.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    void Break(const TextLayoutBox& box, std::vector<TextLine>& lines, TextLayoutResult& result);
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextLayoutCache class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      レイアウト結果を (テキストのハッシュ, スタイル, ボックス) で保持します.
+//!
+//! @note       追い出しは行いません. シナリオの読み込み時など，表示するテキストが
+//!             入れ替わるときに Clear() を呼び出してください.
+///////////////////////////////////////////////////////////////////////////////
+class TextLayoutCache
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    TextLayoutCache();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~TextLayoutCache();
+
+    //-------------------------------------------------------------------------
+    //! @brief      レイアウト結果を取得します. 無ければレイアウトして追加します.
+    //!
+    //! @param[in]      pMetrics    文字の送り幅です.
+    //! @param[in]      text        null終端のテキストです.
+    //! @param[in]      style       フォントなどの識別値です. 同じ値には同じ pMetrics を渡します.
+    //! @param[in]      box         レイアウトするボックスです.
+    //! @param[out]     result      レイアウト結果です. pLines は次に追加が起こるまで有効です.
+    //-------------------------------------------------------------------------
+    bool Get(
+        ITextMetrics*           pMetrics,
+        const wchar_t*          text,
+        uint32_t                style,
+        const TextLayoutBox&    box,
+        TextLayoutResult&       result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      UTF-8 のテキストのレイアウト結果を取得します.
+    //-------------------------------------------------------------------------
+    bool Get(
+        ITextMetrics*           pMetrics,
+        const char*             text,
+        uint32_t                style,
+        const TextLayoutBox&    box,
+        TextLayoutResult&       result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      保持しているレイアウト結果を破棄します.
+    //-------------------------------------------------------------------------
+    void Clear();
+
+    //-------------------------------------------------------------------------
+    //! @brief      保持しているレイアウト結果の数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetEntryCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュにヒットした回数を取得します.
+    //-------------------------------------------------------------------------
+    uint64_t GetHitCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュにヒットしなかった回数を取得します.
+    //-------------------------------------------------------------------------
+    uint64_t GetMissCount() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Key structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Key
+    {
+        uint64_t    Hash;       // テキストのハッシュ値.
+        uint32_t    Length;     // テキストの長さ(コードユニット単位).
+        uint32_t    Style;      // スタイル.
+        int32_t     Width;      // ボックスの幅.
+        uint32_t    MaxLines;   // ボックスの最大行数.
+
+        bool operator == (const Key& value) const
+        {
+            return Hash     == value.Hash
+                && Length   == value.Length
+                && Style    == value.Style
+                && Width    == value.Width
+                && MaxLines == value.MaxLines;
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // KeyHasher structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct KeyHasher
+    {
+        size_t operator () (const Key& key) const
+        {
+            auto h = key.Hash;
+            h ^= (uint64_t(key.Style) << 32) | uint32_t(key.Width);
+            h ^= (uint64_t(key.MaxLines) << 48) ^ key.Length;
+            return size_t(h ^ (h >> 29));
+        }
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Entry structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        uint32_t    FirstLine;  // m_Lines 内の先頭位置.
+        uint32_t    LineCount;  // 行数.
+        int32_t     Width;      // 最も長い行の横幅.
+        bool        Truncated;  // 最大行数に収まらなかったかどうか?
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    TextLayout                                  m_Layout;
+    std::unordered_map<Key, Entry, KeyHasher>   m_Entries;
+    std::vector<TextLine>                       m_Lines;
+    uint64_t                                    m_HitCount;
+    uint64_t                                    m_MissCount;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    template<typename T>
+    bool GetImpl(
+        ITextMetrics*           pMetrics,
+        const T*                text,
+        uint32_t                style,
+        const TextLayoutBox&    box,
+        TextLayoutResult&       result);
+
+    TextLayoutCache             (const TextLayoutCache&) = delete;  // アクセス禁止.
+    TextLayoutCache& operator = (const TextLayoutCache&) = delete;  // アクセス禁止.
+};
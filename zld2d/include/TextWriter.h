@@ -8,14 +8,91 @@
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
+#include <vector>
 #include <asdxRef.h>
-#include <d2d1_1.h>
+#include <asdxMath.h>
+#include <d3d11.h>
 #include <dwrite_1.h>
+#include <GlyphCache.h>
+#include <SpriteSystem.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GlyphRasterizerDW class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      DirectWrite で1文字ずつラスタライズします.
+///////////////////////////////////////////////////////////////////////////////
+class GlyphRasterizerDW : public IGlyphRasterizer
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //-------------------------------------------------------------------------
+    bool Init(IDWriteFactory* pFactory, const wchar_t* fontName, float fontSize);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      1文字をラスタライズします.
+    //-------------------------------------------------------------------------
+    bool Rasterize(uint32_t code, GlyphBitmap& result) override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字の送り幅を取得します.
+    //-------------------------------------------------------------------------
+    int32_t GetAdvance(uint32_t code) override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      行の上端からベースラインまでの高さを取得します.
+    //-------------------------------------------------------------------------
+    int32_t GetAscent() const override;
+
+    //-------------------------------------------------------------------------
+    //! @brief      行の高さを取得します.
+    //-------------------------------------------------------------------------
+    int32_t GetLineHeight() const override;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    asdx::RefPtr<IDWriteFactory>    m_Factory;
+    asdx::RefPtr<IDWriteFontFace>   m_FontFace;
+    std::vector<uint8_t>            m_Buffer;           // ClearType 3x1 の作業領域.
+    float                           m_FontSize      = 0.0f;
+    float                           m_Scale         = 0.0f; // デザイン単位からピクセルへの変換係数.
+    int32_t                         m_Ascent        = 0;
+    int32_t                         m_LineHeight    = 0;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // TextWriter class
 ///////////////////////////////////////////////////////////////////////////////
+//! @brief      文字をアトラスにキャッシュし，スプライトとして描画します.
+///////////////////////////////////////////////////////////////////////////////
 class TextWriter
 {
     //=========================================================================
@@ -46,27 +123,53 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      初期化処理を行います.
     //-------------------------------------------------------------------------
-    bool Init(IDWriteFactory* pFactory, ID2D1DeviceContext* pContext, const wchar_t* fontName, float size);
+    bool Init(IDWriteFactory* pFactory, const wchar_t* fontName, float size);
 
     //-------------------------------------------------------------------------
     //! @brief      終了処理を行います.
     //-------------------------------------------------------------------------
     void Term();
 
+    //-------------------------------------------------------------------------
+    //! @brief      フレームを進めます.
+    //!
+    //! @note       描画前に1フレームに1回呼び出します.
+    //-------------------------------------------------------------------------
+    void NewFrame();
+
     //-------------------------------------------------------------------------
     //! @brief      カラーを設定します.
     //-------------------------------------------------------------------------
     void SetColor(float r, float g, float b, float a);
 
     //-------------------------------------------------------------------------
-    //! @brief      テキストを描画します.
+    //! @brief      テキストを左寄せで描画します.
+    //-------------------------------------------------------------------------
+    void Draw(SpriteSystem& sprite, const wchar_t* text, float x, float y);
+
+    //-------------------------------------------------------------------------
+    //! @brief      メッセージウィンドウの行にテキストを中央寄せで描画します.
+    //-------------------------------------------------------------------------
+    void DrawLine(SpriteSystem& sprite, const wchar_t* text, int line, bool upper = false);
+
+    //-------------------------------------------------------------------------
+    //! @brief      レイアウト済みの行をメッセージウィンドウの行に中央寄せで描画します.
+    //!
+    //! @param[in]      text        レイアウトしたテキストです.
+    //! @param[in]      layout      TextLayout で求めた行です.
+    //! @param[in]      line        表示する行番号です.
     //-------------------------------------------------------------------------
-    void Draw(ID2D1DeviceContext* pContext, const wchar_t* text, float x, float y);
+    void DrawLine(SpriteSystem& sprite, const wchar_t* text, const TextLine& layout, int line, bool upper = false);
 
     //-------------------------------------------------------------------------
-    //! @brief      テキストを描画します.
+    //! @brief      レイアウト用の文字の送り幅を取得します.
     //-------------------------------------------------------------------------
-    void DrawLine(ID2D1DeviceContext* pContext, const wchar_t* text, int line, bool upper = false);
+    ITextMetrics* GetMetrics();
+
+    //-------------------------------------------------------------------------
+    //! @brief      メッセージウィンドウの行の横幅を取得します.
+    //-------------------------------------------------------------------------
+    int GetLineWidth() const;
 
     //-------------------------------------------------------------------------
     //! @brief      フォントサイズを取得します.
@@ -79,12 +182,12 @@ public:
     void SetOutlineColor(float r, float g, float b, float a);
 
     //-------------------------------------------------------------------------
-    //! @brief      縁取りフラグを設定します.
+    //! @brief      縁取りするかどうかを設定します.
     //-------------------------------------------------------------------------
     void SetOutline(bool enable);
 
     //-------------------------------------------------------------------------
-    //! @brief      縁取りフラグを取得します.
+    //! @brief      縁取りするかどうか?
     //-------------------------------------------------------------------------
     bool GetOutline() const;
 
@@ -92,14 +195,20 @@ private:
     //=========================================================================
     // private varaibles.
     //=========================================================================
-    asdx::RefPtr<IDWriteTextFormat>     m_Format;
-    asdx::RefPtr<ID2D1SolidColorBrush>  m_Brush;
-    asdx::RefPtr<ID2D1SolidColorBrush>  m_OutlineBrush;
-    float                               m_FontSize;
-    bool                                m_Outline;
+    GlyphRasterizerDW                                       m_Rasterizer;
+    GlyphCache                                              m_Cache;
+    std::vector<asdx::RefPtr<ID3D11Texture2D>>              m_PageTextures;
+    std::vector<asdx::RefPtr<ID3D11ShaderResourceView>>    m_PageSRVs;
+    std::vector<uint32_t>                                   m_Upload;       // 転送用のRGBA.
+    std::vector<GlyphQuad>                                  m_Quads;
+    asdx::Vector4                                           m_Color;
+    asdx::Vector4                                           m_OutlineColor;
+    float                                                   m_FontSize;
+    bool                                                    m_Outline;
 
     //=========================================================================
     // private methods.
     //=========================================================================
-    /* NOTHING */
+    void DrawGlyphs(SpriteSystem& sprite, const wchar_t* text, uint32_t length, int x, int y);
+    void UploadPages();
 };
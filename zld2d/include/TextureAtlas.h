@@ -0,0 +1,286 @@
+﻿//-----------------------------------------------------------------------------
+// File : TextureAtlas.h
+// Desc : Texture Atlas Builder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AtlasRect structure
+///////////////////////////////////////////////////////////////////////////////
+struct AtlasRect
+{
+    uint32_t    X;      //!< 左上X座標.
+    uint32_t    Y;      //!< 左上Y座標.
+    uint32_t    W;      //!< 横幅.
+    uint32_t    H;      //!< 縦幅.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// AtlasEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct AtlasEntry
+{
+    uint32_t    Page;           //!< 格納先のページ番号.
+    AtlasRect   Rect;           //!< ページ内での画像の矩形(パディングを含まない).
+    float       TexRect[4];     //!< ページ内でのテクスチャ座標(u0, v0, u1, v1).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// AtlasReport structure
+///////////////////////////////////////////////////////////////////////////////
+struct AtlasReport
+{
+    uint32_t    Width;          //!< ページの横幅.
+    uint32_t    Height;         //!< ページの縦幅.
+    uint32_t    ImageCount;     //!< 格納した画像数.
+    uint64_t    ImagePixels;    //!< 画像が占めるピクセル数.
+    uint64_t    PackedPixels;   //!< パディングを含めて確保したピクセル数.
+    float       Occupancy;      //!< 占有率(ImagePixels / (Width * Height)).
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SkylinePacker class
+///////////////////////////////////////////////////////////////////////////////
+class SkylinePacker
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    SkylinePacker();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~SkylinePacker();
+
+    //-------------------------------------------------------------------------
+    //! @brief      領域サイズを設定して空の状態にします.
+    //-------------------------------------------------------------------------
+    void Init(uint32_t width, uint32_t height);
+
+    //-------------------------------------------------------------------------
+    //! @brief      矩形を配置します.
+    //!
+    //! @param[in]      w           配置する矩形の横幅.
+    //! @param[in]      h           配置する矩形の縦幅.
+    //! @param[out]     result      配置された矩形.
+    //! @retval true    配置に成功.
+    //! @retval false   空きが足りません.
+    //-------------------------------------------------------------------------
+    bool Insert(uint32_t w, uint32_t h, AtlasRect& result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      配置済みの面積を取得します.
+    //-------------------------------------------------------------------------
+    uint64_t GetUsedArea() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      横幅を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetWidth() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      縦幅を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetHeight() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Segment structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Segment
+    {
+        uint32_t    X;      //!< 開始X座標.
+        uint32_t    Y;      //!< 高さ.
+        uint32_t    W;      //!< 横幅.
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<Segment>    m_Skyline;
+    uint32_t                m_Width     = 0;
+    uint32_t                m_Height    = 0;
+    uint64_t                m_UsedArea  = 0;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    bool Fit(size_t index, uint32_t w, uint32_t h, uint32_t& y) const;
+
+    SkylinePacker             (const SkylinePacker&) = delete;  // アクセス禁止.
+    SkylinePacker& operator = (const SkylinePacker&) = delete;  // アクセス禁止.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextureAtlas class
+///////////////////////////////////////////////////////////////////////////////
+class TextureAtlas
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    TextureAtlas();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~TextureAtlas();
+
+    //-------------------------------------------------------------------------
+    //! @brief      登録した画像と構築結果を破棄します.
+    //-------------------------------------------------------------------------
+    void Reset();
+
+    //-------------------------------------------------------------------------
+    //! @brief      画像を登録します.
+    //!
+    //! @param[in]      width       画像の横幅.
+    //! @param[in]      height      画像の縦幅.
+    //! @param[in]      pitch       1行あたりのバイト数.
+    //! @param[in]      pPixels     RGBA8のピクセルデータ. Build() を呼ぶまで保持しておくこと.
+    //! @return     エントリー番号を返却します.
+    //-------------------------------------------------------------------------
+    uint32_t Add(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* pPixels);
+
+    //-------------------------------------------------------------------------
+    //! @brief      登録した画像を詰め込んでアトラスを構築します.
+    //!
+    //! @param[in]      padding     画像の周囲に確保するピクセル数. 端のピクセルを引き延ばして埋めます.
+    //! @param[in]      maxSize     ページの最大サイズ. 1ページに収まらない分は新しいページに詰めます.
+    //! @retval true    構築に成功.
+    //! @retval false   パディングを含めて maxSize を超える画像があります.
+    //-------------------------------------------------------------------------
+    bool Build(uint32_t padding, uint32_t maxSize);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページ数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetPageCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページの横幅を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetWidth(uint32_t page) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページの縦幅を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetHeight(uint32_t page) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページのピクセルデータ(RGBA8)を取得します.
+    //-------------------------------------------------------------------------
+    const std::vector<uint8_t>& GetPixels(uint32_t page) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      エントリー数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetEntryCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      エントリーを取得します.
+    //-------------------------------------------------------------------------
+    const AtlasEntry& GetEntry(uint32_t index) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ページの占有率レポートを取得します.
+    //-------------------------------------------------------------------------
+    AtlasReport GetReport(uint32_t page) const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Source structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Source
+    {
+        uint32_t        Width;
+        uint32_t        Height;
+        uint32_t        Pitch;
+        const uint8_t*  pPixels;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Page structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Page
+    {
+        uint32_t                Width;
+        uint32_t                Height;
+        uint64_t                PackedPixels;
+        std::vector<uint8_t>    Pixels;
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<Source>     m_Sources;
+    std::vector<AtlasEntry> m_Entries;
+    std::vector<Page>       m_Pages;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    bool BuildPage(const std::vector<uint32_t>& order, uint32_t padding, uint32_t maxSize);
+    bool Pack(uint32_t width, uint32_t height, uint32_t padding, const std::vector<uint32_t>& order);
+    void Blit(const Source& src, Page& page, const AtlasRect& rect, uint32_t padding);
+
+    TextureAtlas             (const TextureAtlas&) = delete;    // アクセス禁止.
+    TextureAtlas& operator = (const TextureAtlas&) = delete;    // アクセス禁止.
+};
+
+//-----------------------------------------------------------------------------
+//! @brief      画像内のテクスチャ座標をアトラス内のテクスチャ座標に変換します.
+//!
+//! @param[in]      texRect     アトラス内の矩形(u0, v0, u1, v1).
+//! @param[in]      u           画像内のテクスチャ座標U.
+//! @param[in]      v           画像内のテクスチャ座標V.
+//! @param[out]     resultU     アトラス内のテクスチャ座標U.
+//! @param[out]     resultV     アトラス内のテクスチャ座標V.
+//-----------------------------------------------------------------------------
+inline void RemapTexCoord(const float texRect[4], float u, float v, float& resultU, float& resultV)
+{
+    resultU = texRect[0] + (texRect[2] - texRect[0]) * u;
+    resultV = texRect[1] + (texRect[3] - texRect[1]) * v;
+}
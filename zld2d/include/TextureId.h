@@ -23,4 +23,26 @@ enum TEXTURE_ID : unsigned int
     TEXTURE_HUD_WINDOW,         // HUD-メッセージウィンドウ.
     TEXTURE_HUD_SELECT_CURSOR,  // 選択肢カーソル.
     TEXTURE_HUD_HOLE,           // ピンホール.
+
+    TEXTURE_COUNT,
 };
+
+// テクスチャ名. マップのソースから TEXTURE_ID を引くのに使う.
+// TEXTURE_IDと同じ順番で定義すること!!
+static const char* kTextureNames[] = {
+    // 単色系.
+    "white",
+
+    // マップ系.
+    "map_rock",
+    "map_tree",
+    "map_block",
+
+    // HUD系.
+    "hud_life",
+    "hud_window",
+    "hud_select_cursor",
+    "hud_hole",
+};
+
+static_assert(sizeof(kTextureNames) / sizeof(kTextureNames[0]) == TEXTURE_COUNT, "kTextureNames must match TEXTURE_ID.");
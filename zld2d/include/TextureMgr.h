@@ -8,7 +8,12 @@
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
+#include <list>
+#include <vector>
 #include <asdxTexture.h>
+#include <asdxRef.h>
+#include <SpriteFormat.h>
+#include <TextureAtlas.h>
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -38,8 +43,14 @@ public:
 
     //-------------------------------------------------------------------------
     //! @brief      テクスチャをロードします.
+    //!
+    //! @param[in]      count           テクスチャ数.
+    //! @param[in]      paths           テクスチャパス.
+    //! @param[out]     pFirstIndex     先頭テクスチャの番号の格納先.
+    //! @note       1回のロードでまとめて1枚のアトラスに詰め込みます.
+    //!             RGBA8以外のテクスチャは単独のテクスチャとして扱います.
     //-------------------------------------------------------------------------
-    bool Load(uint32_t count, const char** paths);
+    bool Load(uint32_t count, const char** paths, uint32_t* pFirstIndex = nullptr);
 
     //-------------------------------------------------------------------------
     //! @brief      テクスチャを破棄します.
@@ -47,16 +58,29 @@ public:
     void Term();
 
     //-------------------------------------------------------------------------
-    //! @brief      テクスチャを取得します.
+    //! @brief      テクスチャ領域を取得します.
     //-------------------------------------------------------------------------
-    ID3D11ShaderResourceView* GetSRV(uint32_t index);
+    const TextureRegion& GetRegion(uint32_t index) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      アトラスのページ数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetAtlasCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      アトラスのページの占有率レポートを取得します.
+    //-------------------------------------------------------------------------
+    const AtlasReport& GetAtlasReport(uint32_t index) const;
 
 private:
     //=========================================================================
     // private variables.
     //=========================================================================
-    static TextureMgr               s_Instance;
-    std::vector<asdx::Texture2D>    m_Textures;
+    static TextureMgr                                       s_Instance;
+    std::list<asdx::Texture2D>                              m_Textures;     // アトラスに入れなかったテクスチャ.
+    std::vector<asdx::RefPtr<ID3D11ShaderResourceView>>    m_Atlases;
+    std::vector<AtlasReport>                                m_Reports;
+    std::vector<TextureRegion>                              m_Regions;
 
     //=========================================================================
     // private methods.
@@ -72,12 +96,27 @@ private:
     //-------------------------------------------------------------------------
     ~TextureMgr();
 
+    //-------------------------------------------------------------------------
+    //! @brief      単独のテクスチャとして生成します.
+    //-------------------------------------------------------------------------
+    bool CreateStandalone(const char* path, const asdx::ResTexture& res, TextureRegion& result);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ロードに失敗した分を取り消します.
+    //!
+    //! @param[in]      firstRegion     取り消す最初の領域番号.
+    //! @param[in]      textureCount    ロード前の単独テクスチャ数.
+    //-------------------------------------------------------------------------
+    void Rollback(uint32_t firstRegion, size_t textureCount);
+
     TextureMgr              (const TextureMgr&) = delete;   // アクセス禁止.
     TextureMgr& operator =  (const TextureMgr&) = delete;   // アクセス禁止.
 };
 
 //-----------------------------------------------------------------------------
 //! @brief      テクスチャを取得します.
+//!
+//! @return     アトラスとアトラス内の矩形の組を返却します.
 //-----------------------------------------------------------------------------
-inline ID3D11ShaderResourceView* GetTexture(uint32_t index)
-{ return TextureMgr::Instance().GetSRV(index); }
+inline const TextureRegion& GetTexture(uint32_t index)
+{ return TextureMgr::Instance().GetRegion(index); }
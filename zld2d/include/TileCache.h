@@ -0,0 +1,123 @@
+﻿//-----------------------------------------------------------------------------
+// File : TileCache.h
+// Desc : Pre-Expanded Tile Layer Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <MapTile.h>
+#include <TileLayer.h>
+#include <SpriteFormat.h>
+
+
+//-----------------------------------------------------------------------------
+// Type Definitions.
+//-----------------------------------------------------------------------------
+typedef const TextureRegion& (*TileTextureResolver)(uint32_t textureId);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TileCacheRange structure
+///////////////////////////////////////////////////////////////////////////////
+struct TileCacheRange
+{
+    uint32_t    Start;      //!< 開始番号.
+    uint32_t    Count;      //!< スプライト数.
+    int         Y;          //!< 行の上端Y座標. 障害物でない場合は0.
+    bool        Obstacle;   //!< 移動不可タイルの行かどうか.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TileCache class
+///////////////////////////////////////////////////////////////////////////////
+class TileCache
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    TileCache();
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~TileCache();
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュを無効にします. 次の Build() で作り直されます.
+    //-------------------------------------------------------------------------
+    void Invalidate();
+
+    //-------------------------------------------------------------------------
+    //! @brief      作り直しが必要かどうか?
+    //-------------------------------------------------------------------------
+    bool IsDirty() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイルからスプライトを展開してキャッシュします.
+    //!
+    //! @param[in]      layer       1部屋分のタイル.
+    //! @param[in]      resolver    テクスチャ番号からテクスチャ領域を引く関数.
+    //! @note       無効になっていなければ何もしません.
+    //-------------------------------------------------------------------------
+    void Build(const TileLayer& layer, TileTextureResolver resolver);
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュしたスプライトを取得します.
+    //!
+    //! @note       位置は kTileOffsetX/Y を含むスクロール無しの画面座標です.
+    //-------------------------------------------------------------------------
+    const SpriteInstance* GetInstances() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      スプライト毎のテクスチャを取得します.
+    //-------------------------------------------------------------------------
+    ID3D11ShaderResourceView* const* GetTextures() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      描画範囲を取得します.
+    //!
+    //! @note       先頭が移動可能タイル，以降は移動不可タイルを行毎にまとめた範囲です.
+    //-------------------------------------------------------------------------
+    const std::vector<TileCacheRange>& GetRanges() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュを構築した回数を取得します. 診断用です.
+    //-------------------------------------------------------------------------
+    uint32_t GetBuildCount() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<SpriteInstance>             m_Instances;
+    std::vector<ID3D11ShaderResourceView*>  m_Textures;
+    std::vector<TileCacheRange>             m_Ranges;
+    uint32_t                                m_BuildCount    = 0;
+    bool                                    m_Dirty         = true;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    void Push(const Tile& tile, TileTextureResolver resolver, int x, int y);
+};
@@ -0,0 +1,145 @@
+﻿//-----------------------------------------------------------------------------
+// File : TileLayer.h
+// Desc : Palette Indexed Tile Layer with Collision Bitsets.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <MapTile.h>
+#include <Box.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TILE_FLAG enum
+///////////////////////////////////////////////////////////////////////////////
+enum TILE_FLAG
+{
+    TILE_FLAG_MOVEABLE,     //!< Tile::Moveable.
+    TILE_FLAG_SCROLLABLE,   //!< Tile::Scrollable.
+    TILE_FLAG_SWITCHABLE,   //!< Tile::Switchable.
+    TILE_FLAG_FALLABLE,     //!< Tile::Fallable.
+
+    TILE_FLAG_COUNT,
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TileLayer class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      1部屋分のタイルをパレット番号で持ち，属性を行毎のビット列に展開します.
+//!
+//! @note       タイル番号配列とパレットは外部(マッピングしたマップファイル)を指します.
+//!             ビット列は1行 kTileCountX ビットを1ワードに詰めたもので，
+//!             矩形に掛かる全タイルの判定を行数分のビット演算で行えます.
+///////////////////////////////////////////////////////////////////////////////
+class TileLayer
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    TileLayer();
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイル番号配列とパレットを設定し，ビット列を構築します.
+    //!
+    //! @param[in]      pIndices        タイル番号配列(kTileTotalCount). 全てパレット数未満であること.
+    //! @param[in]      pPalette        パレット.
+    //! @param[in]      paletteCount    パレットのタイル種別数.
+    //-------------------------------------------------------------------------
+    void Init(uint8_t* pIndices, const Tile* pPalette, uint32_t paletteCount);
+
+    //-------------------------------------------------------------------------
+    //! @brief      設定を解除します.
+    //-------------------------------------------------------------------------
+    void Reset();
+
+    //-------------------------------------------------------------------------
+    //! @brief      設定済みかどうか?
+    //-------------------------------------------------------------------------
+    bool IsValid() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイルを取得します.
+    //-------------------------------------------------------------------------
+    const Tile& GetTile(uint32_t id) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      パレット番号を取得します.
+    //-------------------------------------------------------------------------
+    uint8_t GetIndex(uint32_t id) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      パレット番号を書き換えます. ビット列も更新します.
+    //!
+    //! @note       スプライトキャッシュは呼び出し側で無効にしてください.
+    //-------------------------------------------------------------------------
+    void SetIndex(uint32_t id, uint8_t index);
+
+    //-------------------------------------------------------------------------
+    //! @brief      矩形に掛かる全てのタイルが属性を持つかどうか?
+    //!
+    //! @param[in]      flag        属性.
+    //! @param[in]      box         画面座標の矩形. 部屋の外に出た部分は端のタイルで判定します.
+    //-------------------------------------------------------------------------
+    bool TestAll(TILE_FLAG flag, const Box& box) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      矩形に掛かるタイルのどれかが属性を持つかどうか?
+    //-------------------------------------------------------------------------
+    bool TestAny(TILE_FLAG flag, const Box& box) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      1行分のビット列を取得します. ビット i が列 i に対応します.
+    //-------------------------------------------------------------------------
+    uint32_t GetRowBits(TILE_FLAG flag, uint32_t row) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      タイル番号配列を取得します.
+    //-------------------------------------------------------------------------
+    const uint8_t* GetIndices() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      パレットを取得します.
+    //-------------------------------------------------------------------------
+    const Tile* GetPalette() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      パレットのタイル種別数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetPaletteCount() const;
+
+private:
+    static_assert(kTileCountX <= 32, "A row of tiles must fit in a 32bit word.");
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    uint8_t*        m_pIndices;
+    const Tile*     m_pPalette;
+    uint32_t        m_PaletteCount;
+    uint32_t        m_Bits[TILE_FLAG_COUNT][kTileCountY];
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    void UpdateBits(uint32_t id);
+};
@@ -0,0 +1,43 @@
+﻿//-----------------------------------------------------------------------------
+// File : ChaseComponent.h
+// Desc : Enemy Component Chasing the Player.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <Enemy.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ChaseComponent class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      マップのフローフィールドに沿ってプレイヤーを追いかけます.
+//!
+//! @note       1タイルずつ移動し，タイルに揃った時だけ次の方向を引きます.
+//!             敵の矩形はタイルに揃った位置から始めてください.
+///////////////////////////////////////////////////////////////////////////////
+class ChaseComponent : public IEnemyComponent
+{
+public:
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //!
+    //! @param[in]      speed       1フレームの移動ピクセル数. kTileSize を割り切れる値にしてください.
+    //-------------------------------------------------------------------------
+    explicit ChaseComponent(int speed = 2);
+
+    //-------------------------------------------------------------------------
+    //! @brief      更新処理を行います.
+    //-------------------------------------------------------------------------
+    void Update(UpdateContext& context, Enemy& enemy) override;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    int     m_Speed;
+    int     m_Remain = 0;   // 次のタイルに揃うまでのピクセル数.
+};
@@ -44,7 +44,7 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      フラグと位置をリセットします.
     //-------------------------------------------------------------------------
-    void Reset() override;
+    void Reset();
 
     //-------------------------------------------------------------------------
     //! @brief      可動方向を指定します.
@@ -54,17 +54,22 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      プレイヤーが移動可能かチェックします.
     //-------------------------------------------------------------------------
-    bool CanMove(const Box& playerBox) override;
+    bool CanMove(const Box& playerBox);
 
     //-------------------------------------------------------------------------
     //! @brief      更新処理を行います.
     //-------------------------------------------------------------------------
-    void Update(UpdateContext& context) override;
+    void Update(UpdateContext& context);
 
     //-------------------------------------------------------------------------
-    //! @brief      メッセージ受信処理を行います.
+    //! @brief      押し終わっていれば移動先のタイルを書き出します.
     //-------------------------------------------------------------------------
-    void OnMessage(const Message& msg) override;
+    bool SaveState(MapGimmickState& state) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      押し終わった状態にします.
+    //-------------------------------------------------------------------------
+    void LoadState(const MapGimmickState& state);
 
 private:
     //=========================================================================
@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------------------
+// File : SpriteInstVS.hlsl
+// Desc : Instanced Sprite Vertex Shader.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const float kLayerScale = 1.0f / 256.0f;    // SpriteFormat.h  kSpriteLayerScale ƍ킹邱.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// VSInput structure
+///////////////////////////////////////////////////////////////////////////////
+struct VSInput
+{
+    int4    Rect     : RECT;            //!< ʒuƃTCY(x, y, w, h)ł.
+    float4  TexRect  : TEXRECT;         //!< eNX`W(u0, v0, u1, v1)ł.
+    float4  Color    : VTXCOLOR;        //!< _J[ł.
+    uint2   Layer    : LAYER;           //!< [xC[ł.
+    uint    VertexId : SV_VertexID;     //!< _ԍł.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VSOutput structure
+///////////////////////////////////////////////////////////////////////////////
+struct VSOutput
+{
+    float4  Position : SV_POSITION;     //!< ʒuWł.
+    float4  Color    : VTXCOLOR;        //!< _J[ł.
+    float3  TexCoord : TEXCOORD0;       //!< eNX`Wł.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CbPerOnceVS constant buffer
+///////////////////////////////////////////////////////////////////////////////
+cbuffer CbPerOnceVS : register( b0 )
+{
+    float4x4 TransformMtx;   //!< ϊsł.
+};
+
+
+//-----------------------------------------------------------------------------
+//! @brief      _VF[_CGg[|Cgł.
+//-----------------------------------------------------------------------------
+VSOutput main( VSInput input )
+{
+    VSOutput output = (VSOutput)0;
+
+    // _ԍ`̊p߂. 0:, 1:E, 2:, 3:E.
+    float2 corner = float2( input.VertexId & 0x1, input.VertexId >> 1 );
+
+    float2 pos = float2( input.Rect.xy ) + corner * float2( input.Rect.zw );
+
+    // 256 𒴂郌C[͍ŉ([x 1.0)Ɋۂ߂ĕ`悷.
+    // ȑO̒_`ł͐[x 1.0 𒴂XvCg̓Nbvĕ`悳Ȃ.
+    // [xeXg͎gȂ̂ŁCs̏ SpriteBatch ̕בւŌ܂.
+    float  z   = saturate( float( input.Layer.x ) * kLayerScale );
+
+    output.Position   = mul( TransformMtx, float4( pos, z, 1.0f ) );
+    output.Color      = input.Color;
+    output.TexCoord.x = lerp( input.TexRect.x, input.TexRect.z, corner.x );
+    output.TexCoord.y = lerp( input.TexRect.w, input.TexRect.y, corner.y );
+    output.TexCoord.z = 0.0f;
+
+    return output;
+}
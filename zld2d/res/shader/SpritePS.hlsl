@@ -58,9 +58,6 @@ PSOutput main( VSOutput input )
     // eNX`tFb`J[ƒ_J[Z.
     output.Color = TextureMap.Sample( TextureSmp, input.TexCoord.xy ) * input.Color;
 
-    if (output.Color.a <= 0.0f)
-    { discard; }
-
     // _[^[Qbgɏo.
     return output;
 }
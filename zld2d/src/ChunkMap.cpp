@@ -0,0 +1,309 @@
+﻿//-----------------------------------------------------------------------------
+// File : ChunkMap.cpp
+// Desc : Chunked Tile Map.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cassert>
+#include <algorithm>
+#include <ChunkMap.h>
+#include <SpriteSystem.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kWhite       = 0xffffffff;
+static const int      kFrontLayer  = 0;     // キャラより手前.
+static const int      kBackLayer   = 2;     // キャラより奥.
+
+//-----------------------------------------------------------------------------
+//      タイル座標からチャンク座標を求めます. 負の座標も切り下げます.
+//-----------------------------------------------------------------------------
+inline int32_t ToChunk(int64_t tile)
+{ return int32_t(tile >> kChunkShift); }
+
+//-----------------------------------------------------------------------------
+//      チャンク内のタイル番号を求めます.
+//-----------------------------------------------------------------------------
+inline uint32_t ToLocal(int32_t tileX, int32_t tileY)
+{ return uint32_t(tileY & kChunkMask) * kChunkSize + uint32_t(tileX & kChunkMask); }
+
+//-----------------------------------------------------------------------------
+//      チャンク座標から検索キーを作ります.
+//-----------------------------------------------------------------------------
+inline uint64_t MakeKey(int32_t chunkX, int32_t chunkY)
+{ return (uint64_t(uint32_t(chunkX)) << 32) | uint64_t(uint32_t(chunkY)); }
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ChunkMap class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ChunkMap::ChunkMap()
+: m_Empty   ()
+, m_Frame   (0)
+, m_Active  ()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+ChunkMap::~ChunkMap()
+{ Clear(); }
+
+//-----------------------------------------------------------------------------
+//      全てのチャンクを破棄します.
+//-----------------------------------------------------------------------------
+void ChunkMap::Clear()
+{
+    m_Chunks   .clear();
+    m_Visible  .clear();
+    m_Instances.clear();
+    m_Textures .clear();
+    m_Active = TileRect();
+}
+
+//-----------------------------------------------------------------------------
+//      チャンクが無い場所のタイルを設定します.
+//-----------------------------------------------------------------------------
+void ChunkMap::SetEmptyTile(const Tile& value)
+{ m_Empty = value; }
+
+//-----------------------------------------------------------------------------
+//      タイルを設定します.
+//-----------------------------------------------------------------------------
+void ChunkMap::SetTile(int32_t tileX, int32_t tileY, const Tile& value)
+{
+    auto chunk = GetOrCreate(ToChunk(tileX), ToChunk(tileY));
+    chunk->Tiles[ToLocal(tileX, tileY)] = value;
+}
+
+//-----------------------------------------------------------------------------
+//      タイル配列を貼り付けます.
+//-----------------------------------------------------------------------------
+void ChunkMap::Paste(int32_t tileX, int32_t tileY, const Tile* pTiles, uint32_t w, uint32_t h)
+{
+    assert(pTiles != nullptr);
+
+    for(auto row=0u; row<h; ++row)
+    {
+        auto y   = int32_t(tileY + int32_t(row));
+        auto col = 0u;
+
+        // チャンクの境界までまとめてコピーする.
+        while(col < w)
+        {
+            auto x     = int32_t(tileX + int32_t(col));
+            auto chunk = GetOrCreate(ToChunk(x), ToChunk(y));
+            auto count = std::min<uint32_t>(w - col, uint32_t(kChunkSize - (x & kChunkMask)));
+
+            std::copy(
+                pTiles + row * w + col,
+                pTiles + row * w + col + count,
+                chunk->Tiles + ToLocal(x, y));
+
+            col += count;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      タイルを取得します.
+//-----------------------------------------------------------------------------
+const Tile& ChunkMap::GetTile(int32_t tileX, int32_t tileY) const
+{
+    auto chunk = FindChunk(ToChunk(tileX), ToChunk(tileY));
+    if (chunk == nullptr)
+    { return m_Empty; }
+
+    return chunk->Tiles[ToLocal(tileX, tileY)];
+}
+
+//-----------------------------------------------------------------------------
+//      チャンクを検索します.
+//-----------------------------------------------------------------------------
+const TileChunk* ChunkMap::FindChunk(int32_t chunkX, int32_t chunkY) const
+{
+    auto itr = m_Chunks.find(MakeKey(chunkX, chunkY));
+    if (itr == m_Chunks.end())
+    { return nullptr; }
+
+    return itr->second.get();
+}
+
+//-----------------------------------------------------------------------------
+//      表示範囲に掛かるチャンクを求めます.
+//-----------------------------------------------------------------------------
+void ChunkMap::Cull(const MapCamera& camera, int32_t margin)
+{
+    m_Frame++;
+    m_Visible.clear();
+
+    auto rect = camera.GetVisibleRect();
+    m_Active.X = int32_t(int64_t(rect.X) - margin);
+    m_Active.Y = int32_t(int64_t(rect.Y) - margin);
+    m_Active.W = rect.W + margin * 2;
+    m_Active.H = rect.H + margin * 2;
+
+    auto x0 = ToChunk(m_Active.X);
+    auto y0 = ToChunk(m_Active.Y);
+    auto x1 = ToChunk(int64_t(m_Active.X) + m_Active.W - 1);
+    auto y1 = ToChunk(int64_t(m_Active.Y) + m_Active.H - 1);
+
+    // 画面に掛かるチャンクは高々数個なので，範囲を総当たりで引く.
+    for(auto cy=int64_t(y0); cy<=y1; ++cy)
+    {
+        for(auto cx=int64_t(x0); cx<=x1; ++cx)
+        {
+            auto itr = m_Chunks.find(MakeKey(int32_t(cx), int32_t(cy)));
+            if (itr == m_Chunks.end())
+            { continue; }
+
+            itr->second->VisibleFrame = m_Frame;
+            m_Visible.push_back(itr->second.get());
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      Cull() で求めたチャンクを取得します.
+//-----------------------------------------------------------------------------
+const std::vector<const TileChunk*>& ChunkMap::GetVisibleChunks() const
+{ return m_Visible; }
+
+//-----------------------------------------------------------------------------
+//      タイルが最後の Cull() の範囲に入っているかどうか?
+//-----------------------------------------------------------------------------
+bool ChunkMap::IsActive(int32_t tileX, int32_t tileY) const
+{
+    auto dx = int64_t(tileX) - m_Active.X;
+    auto dy = int64_t(tileY) - m_Active.Y;
+    return 0 <= dx && dx < m_Active.W
+        && 0 <= dy && dy < m_Active.H;
+}
+
+//-----------------------------------------------------------------------------
+//      画面に掛かるタイルを描画します.
+//-----------------------------------------------------------------------------
+void ChunkMap::Draw(SpriteSystem& sprite, const MapCamera& camera, TileTextureResolver resolver, int playerY)
+{
+    assert(resolver != nullptr);
+
+    auto rect = camera.GetVisibleRect();
+
+    m_Instances.clear();
+    m_Textures .clear();
+
+    // 奥に表示するタイルを前半，手前に表示するタイルを後半に詰める.
+    uint32_t backCount = 0;
+    for(auto pass=0; pass<2; ++pass)
+    {
+        for(auto chunk : m_Visible)
+        {
+            auto baseX = int64_t(chunk->ChunkX) * kChunkSize;
+            auto baseY = int64_t(chunk->ChunkY) * kChunkSize;
+
+            // チャンクのうち画面に掛かる範囲だけ展開する.
+            auto x0 = int32_t(std::max<int64_t>(0, rect.X - baseX));
+            auto y0 = int32_t(std::max<int64_t>(0, rect.Y - baseY));
+            auto x1 = int32_t(std::min<int64_t>(kChunkSize, rect.X + int64_t(rect.W) - baseX));
+            auto y1 = int32_t(std::min<int64_t>(kChunkSize, rect.Y + int64_t(rect.H) - baseY));
+
+            for(auto ly=y0; ly<y1; ++ly)
+            {
+                int x, y;
+                camera.ToScreen(int32_t(baseX + x0), int32_t(baseY + ly), x, y);
+
+                // キャラよりもY座標が下側の障害物は手前に表示.
+                auto frontRow = (playerY < y);
+
+                for(auto lx=x0; lx<x1; ++lx, x+=kTileSize)
+                {
+                    auto& tile  = chunk->Tiles[ly * kChunkSize + lx];
+                    auto  front = !tile.Moveable && frontRow;
+                    if (front != (pass == 1))
+                    { continue; }
+
+                    auto& region = resolver(tile.TextureId);
+                    m_Instances.push_back(PackSprite(
+                        x, y, kTileSize, kTileSize,
+                        region.TexRect[0], region.TexRect[1], region.TexRect[2], region.TexRect[3],
+                        kWhite,
+                        0));
+                    m_Textures.push_back(region.pSRV);
+                }
+            }
+        }
+
+        if (pass == 0)
+        { backCount = uint32_t(m_Instances.size()); }
+    }
+
+    auto totalCount = uint32_t(m_Instances.size());
+
+    if (backCount > 0)
+    {
+        sprite.DrawInstances(
+            m_Instances.data(),
+            m_Textures .data(),
+            backCount,
+            0, 0,
+            kBackLayer);
+    }
+
+    if (totalCount > backCount)
+    {
+        sprite.DrawInstances(
+            m_Instances.data() + backCount,
+            m_Textures .data() + backCount,
+            totalCount - backCount,
+            0, 0,
+            kFrontLayer);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      確保しているチャンク数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t ChunkMap::GetChunkCount() const
+{ return uint32_t(m_Chunks.size()); }
+
+//-----------------------------------------------------------------------------
+//      チャンクが使っているおおよそのメモリ量を取得します.
+//-----------------------------------------------------------------------------
+size_t ChunkMap::GetMemorySize() const
+{
+    // ノードはキー, ポインタ, 次ノードへのポインタ程度として見積もる.
+    auto nodeSize = sizeof(uint64_t) + sizeof(std::unique_ptr<TileChunk>) + sizeof(void*);
+    return m_Chunks.size() * (sizeof(TileChunk) + nodeSize)
+         + m_Chunks.bucket_count() * sizeof(void*);
+}
+
+//-----------------------------------------------------------------------------
+//      チャンクを取得します. 無ければ確保します.
+//-----------------------------------------------------------------------------
+TileChunk* ChunkMap::GetOrCreate(int32_t chunkX, int32_t chunkY)
+{
+    auto& chunk = m_Chunks[MakeKey(chunkX, chunkY)];
+    if (!chunk)
+    {
+        chunk.reset(new TileChunk());
+        std::fill(chunk->Tiles, chunk->Tiles + kChunkTileCount, m_Empty);
+        chunk->ChunkX       = chunkX;
+        chunk->ChunkY       = chunkY;
+        chunk->VisibleFrame = 0;
+    }
+
+    return chunk.get();
+}
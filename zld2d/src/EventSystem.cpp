@@ -27,9 +27,13 @@ static const int      kWndHeight        = 200;  // メッセージウィンド
 static const int      kWndPosX          = 140;  // メッセージウィンドウX座標.
 static const int      kWndUpperY        = 64;   // メッセージウィンドウY座標(上側に表示する場合).
 static const int      kWndLowerY        = 488;  // メッセージウィンドウY座標(下側に表示する場合).
+static const int      kWndLayer         = 2;    // メッセージウィンドウのレイヤー. 文字(0, 1)より奥に描く.
 static const float    kWndColor[]       = { 0.5f, 0.5f, 0.5f, 0.8f }; // ウィンドウ乗算カラー.
 static const float    kTextColor[]      = { 1.0f, 1.0f, 1.0f, 1.0f }; // テキスト乗算カラー.
 static const float    kActiveColor[]    = { 0.1f, 1.0f, 0.1f, 1.0f }; // アクティブカラー.
+static const uint32_t kTextStyle        = 0;    // レイアウトキャッシュのスタイル. フォントは1種類のみ.
+static const uint32_t kMsgLines         = 4;    // 選択肢無しのメッセージの最大行数.
+static const uint32_t kChoiceMsgLines   = 2;    // 選択肢付きのメッセージの最大行数. 3, 4行目は選択肢.
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -126,14 +130,12 @@ EventSystem::~EventSystem()
 //-----------------------------------------------------------------------------
 //      初期化処理を行います.
 //-----------------------------------------------------------------------------
-bool EventSystem::Init(IDWriteFactory* pFactory, ID2D1DeviceContext* pContext)
+bool EventSystem::Init(IDWriteFactory* pFactory)
 {
-    m_pContext = pContext;
-
     if (!LoadScenario(m_ScenarioId))
     { return false; }
 
-    return m_Writer.Init(pFactory, pContext, kFontName, kFontSize);
+    return m_Writer.Init(pFactory, kFontName, kFontSize);
 }
 
 //-----------------------------------------------------------------------------
@@ -178,7 +180,7 @@ void EventSystem::DrawWindow(SpriteSystem& sprite, bool upper)
     sprite.SetColor(kWndColor[0], kWndColor[1], kWndColor[2], kWndColor[3]);
     sprite.Draw(
         GetTexture(TEXTURE_HUD_WINDOW),
-        kWndPosX, kY, kWndWidth, kWndHeight, 0);
+        kWndPosX, kY, kWndWidth, kWndHeight, kWndLayer);
 
     auto& record = m_Table.at(m_EventId);
     if (record.HasBrunch)
@@ -199,8 +201,11 @@ void EventSystem::DrawWindow(SpriteSystem& sprite, bool upper)
 //-----------------------------------------------------------------------------
 //      会話メッセージを表示します.
 //-----------------------------------------------------------------------------
-void EventSystem::DrawMsg(ID2D1DeviceContext* context, bool upper)
+void EventSystem::DrawMsg(SpriteSystem& sprite, bool upper)
 {
+    // 表示していないフレームも進めて，使われなくなった文字を追い出せるようにする.
+    m_Writer.NewFrame();
+
     if (!m_IsDraw || m_Table.empty())
     { return; }
 
@@ -213,6 +218,7 @@ void EventSystem::DrawMsg(ID2D1DeviceContext* context, bool upper)
     if (record.HasBrunch)
     {
         DrawChoices2(
+            sprite,
             record.Text,
             record.OptionA,
             record.OptionB,
@@ -220,15 +226,15 @@ void EventSystem::DrawMsg(ID2D1DeviceContext* context, bool upper)
             upper);
     }
     else
-    { DrawEventMsg(record.Text, upper); }
+    { DrawEventMsg(sprite, record.Text, upper); }
 }
 
 //-----------------------------------------------------------------------------
 //      選択無しの会話メッセージを表示します.
 //-----------------------------------------------------------------------------
-void EventSystem::DrawEventMsg(const wchar_t* msg, bool upper)
+void EventSystem::DrawEventMsg(SpriteSystem& sprite, const wchar_t* msg, bool upper)
 {
-    m_Writer.DrawLine(m_pContext, msg, 0, upper);
+    DrawLines(sprite, msg, 0, kMsgLines, upper);
 }
 
 //-----------------------------------------------------------------------------
@@ -236,6 +242,7 @@ void EventSystem::DrawEventMsg(const wchar_t* msg, bool upper)
 //-----------------------------------------------------------------------------
 void EventSystem::DrawChoices2
 (
+    SpriteSystem&  sprite,
     const wchar_t* msg,
     const wchar_t* optionA,
     const wchar_t* optionB,
@@ -243,23 +250,48 @@ void EventSystem::DrawChoices2
     bool           upper
 )
 {
-    m_Writer.DrawLine(m_pContext, msg, 0, upper);
+    DrawLines(sprite, msg, 0, kChoiceMsgLines, upper);
 
     if (cursor == 0)
     { SetActiveColor(); }
     else
     { SetDefaultColor(); }
-    m_Writer.DrawLine(m_pContext, optionA, 2, upper);
+    DrawLines(sprite, optionA, 2, 1, upper);
 
     if (cursor == 1)
     { SetActiveColor(); }
     else
     { SetDefaultColor(); }
-    m_Writer.DrawLine(m_pContext, optionB, 3, upper);
+    DrawLines(sprite, optionB, 3, 1, upper);
 
     SetDefaultColor();
 }
 
+//-----------------------------------------------------------------------------
+//      テキストを折り返して複数行に表示します.
+//-----------------------------------------------------------------------------
+void EventSystem::DrawLines
+(
+    SpriteSystem&   sprite,
+    const wchar_t*  text,
+    int             firstLine,
+    uint32_t        maxLines,
+    bool            upper
+)
+{
+    // 同じテキストは2回目以降キャッシュから取り出すだけになる.
+    TextLayoutBox box;
+    box.Width    = m_Writer.GetLineWidth();
+    box.MaxLines = maxLines;
+
+    TextLayoutResult layout;
+    if (!m_Layouts.Get(m_Writer.GetMetrics(), text, kTextStyle, box, layout))
+    { return; }
+
+    for(auto i=0u; i<layout.LineCount; ++i)
+    { m_Writer.DrawLine(sprite, text, layout.pLines[i], firstLine + int(i), upper); }
+}
+
 //-----------------------------------------------------------------------------
 //      アクティブカラーを設定します.
 //-----------------------------------------------------------------------------
@@ -381,5 +413,8 @@ bool EventSystem::LoadScenario(uint32_t scenarioId)
     // テーブル差し替え.
     m_Table = table;
 
+    // 前のシナリオのテキストのレイアウトは不要になる.
+    m_Layouts.Clear();
+
     return true;
 }
\ No newline at end of file
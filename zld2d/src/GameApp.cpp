@@ -9,9 +9,9 @@
 //-----------------------------------------------------------------------------
 #include <GameApp.h>
 #include <asdxLogger.h>
+#include <asdxMisc.h>
 #include <asdxRenderState.h>
 #include <asdxColorMatrix.h>
-#include <gimmick/Block.h>
 #include <TextureId.h>
 #include <TextureMgr.h>
 
@@ -38,6 +38,12 @@ static const char* kTexturePath[] = {
     "../res/texture/hud/hole.tga",
 };
 
+static_assert(_countof(kTexturePath) == TEXTURE_COUNT, "kTexturePath must match TEXTURE_ID.");
+
+static const uint32_t kAnimCapacity = 256;  // アニメーションを再生できる最大数.
+static const uint32_t kRoomBudget   = 9;    // 常駐できる部屋の数. 現在の部屋 + 隣接 + 2つ先の一部.
+static const char*    kSavePath     = "world.sav";  // 部屋の変化のセーブファイル.
+
 } // namespace
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -69,8 +75,15 @@ bool GameApp::OnInit()
     // プレイヤー0として設定.
     m_Pad.SetPlayerIndex(0);
 
+    // スプライト描画バックエンド初期化.
+    if (!m_SpriteBackend.Init(m_pDevice, m_pDeviceContext))
+    {
+        ELOGA("Error : SpriteBackendD3D11::Init() Failed.");
+        return false;
+    }
+
     // スプライトシステム初期化.
-    if (!m_Sprite.Init(m_pDevice, float(m_Width), float(m_Height)))
+    if (!m_Sprite.Init(&m_SpriteBackend, float(m_Width), float(m_Height)))
     {    
         ELOGA("Error : Sprite::Init() Failed.");
         return false;
@@ -84,7 +97,7 @@ bool GameApp::OnInit()
     }
 
     // イベントシステム初期化.
-    if (!m_EventSystem.Init(m_pFactoryDW.GetPtr(), m_pDeviceContext2D.GetPtr()))
+    if (!m_EventSystem.Init(m_pFactoryDW.GetPtr()))
     {
         ELOGA("Error : EventSystem::Init() Failed.");
         return false;
@@ -102,8 +115,21 @@ bool GameApp::OnInit()
         }
     }
 
+    // アニメーションクリップ初期化.
+    if (!m_AnimLibrary.Load("../res/anim/player.anim"))
+    {
+        ELOGA("Error : SpriteAnimLibrary::Load() Failed.");
+        return false;
+    }
+
+    if (!m_AnimSystem.Init(&m_AnimLibrary, kAnimCapacity))
+    {
+        ELOGA("Error : SpriteAnimSystem::Init() Failed.");
+        return false;
+    }
+
     // プレイヤー初期化
-    if (!m_Player.Init())
+    if (!m_Player.Init(m_AnimSystem, m_AnimLibrary))
     {
         ELOGA("Error : Player::Init() Failed");
         return false;
@@ -123,52 +149,35 @@ bool GameApp::OnInit()
 
     //m_Block.Init( 300, 400, 64, 64, DIRECTION_RIGHT, GetGameMap(GAMEMAP_TEXTURE_ROCK));
 
-    auto block = new Block();
-    block->SetTilePos(4, 5).SetSize(64, 64).SetSRV(GetTexture(TEXTURE_MAP_BLOCK));
-    //block->SetDir(DIRECTION_RIGHT);
-    m_MapData.Gimmicks.push_back(block);
+    // マップ読み込み.
+    if (!m_World.Init(kRoomBudget))
+    {
+        ELOGA("Error : MapWorld::Init() Failed.");
+        return false;
+    }
 
-    // テスト用タイルデータ.
+    if (!m_World.LoadGraph("../res/map/world.txt"))
     {
-        uint8_t id = 0;
-        for(uint8_t i=0; i<kTileCountY; ++i)
-        for(uint8_t j=0; j<kTileCountX; ++j)
-        {
-            if ((i == 5 && j == 0) || (i == 0 && j == 10) || (j == (kTileCountX - 1) && i == 5) || (j == 10 && i == (kTileCountY - 1)))
-            {
-                Tile tile = {};
-                tile.Moveable = true;
-                tile.Switchable = false;
-                tile.Scrollable = true;
-                tile.TextureId = TEXTURE_WHITE;
-                m_MapData.Tile[id] = tile;
-            }
-            else if (i == 0 || j == 0 || j == (kTileCountX - 1) || i == (kTileCountY - 1)
-                || (i == 3 && j == 4) || ( i == 8 && j == 11 ))
-            {
-                Tile tile = {};
-                tile.Moveable = false;
-                tile.Switchable = false;
-                tile.Scrollable = false;
-                tile.TextureId = TEXTURE_MAP_TREE;
-                m_MapData.Tile[id] = tile;
-            }
-            else
-            {
-                Tile tile = {};
-                tile.Moveable = true;
-                tile.Scrollable = false;
-                tile.Switchable = false;
-                tile.TextureId = TEXTURE_WHITE;
-                m_MapData.Tile[id] = tile;
-            }
-
-            id++;
-        }
+        ELOGA("Error : MapWorld::LoadGraph() Failed.");
+        return false;
     }
 
-    m_MapSystem.SetData(&m_MapData);
-    m_MapSystem.SetNext(&m_MapData);
+    // 前回までの部屋の変化があれば引き継ぐ. 部屋を読み込む前に設定しておく.
+    {
+        std::string savePath;
+        if (asdx::SearchFilePathA(kSavePath, savePath) && !m_World.LoadState(savePath.c_str()))
+        { WLOGA("Warning : MapWorld::LoadState() Failed. path = %s", savePath.c_str()); }
+    }
+
+    if (!m_World.Start(m_World.FindRoom("room_000")))
+    {
+        ELOGA("Error : MapWorld::Start() Failed.");
+        return false;
+    }
+
+    m_MapSystem.SetWorld(&m_World);
+    m_MapSystem.SetData(m_World.GetCurrent());
+    m_MapSystem.SetNext(m_World.GetCurrent());
 
 
     // カラーターゲット生成.
@@ -256,30 +265,6 @@ bool GameApp::OnInit()
         }
     }
 
-    // テキスト描画用ビットマップ作成.
-    {
-        // IDXGISurfaceを取得.
-        asdx::RefPtr<IDXGISurface> pSurface;
-        auto hr = m_pSwapChain->GetBuffer( 0, IID_IDXGISurface, reinterpret_cast<void**>(pSurface.GetAddress()) );
-        if ( FAILED( hr ) )
-        {
-            ELOG( "Error : IDXGISwapChain::GetBuffer() Failed." );
-            return false;
-        }
-
-        // D2Dビットマップを生成.
-        const auto bitmapProp = D2D1::BitmapProperties1(
-            D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
-            D2D1::PixelFormat( m_SwapChainFormat, D2D1_ALPHA_MODE_PREMULTIPLIED ) );
-
-        hr = m_pDeviceContext2D->CreateBitmapFromDxgiSurface( pSurface.GetPtr(), bitmapProp, m_pBitmap2D.GetAddress() );
-        if ( FAILED( hr ) )
-        {
-            ELOG( "Error : ID2D1DeviceContext::CreateBitmapFromDxgiSurface() Failed." );
-            return false;
-        }
-    }
-
     return true;
 }
 
@@ -288,7 +273,6 @@ bool GameApp::OnInit()
 //-----------------------------------------------------------------------------
 void GameApp::OnTerm()
 {
-    m_pBitmap2D.Reset();
     m_TriangleVB.Term();
 
     m_SurfaceVS.Term();
@@ -297,9 +281,17 @@ void GameApp::OnTerm()
 
     m_SceneColor.Release();
 
+    m_Hud.Term(m_Sprite);
     m_Sprite.Term();
+    m_SpriteBackend.Term();
     m_Player.Term();
 
+    if (!m_World.SaveState(kSavePath))
+    { WLOGA("Warning : MapWorld::SaveState() Failed. path = %s", kSavePath); }
+    m_World.Term();
+    m_AnimSystem.Term();
+    m_AnimLibrary.Term();
+
     m_Switcher.Term();
 
     //m_EnemyTest.Term();
@@ -327,12 +319,21 @@ void GameApp::OnFrameMove(asdx::FrameEventArgs& args)
     // プレイヤー更新.
     m_Player.Update(context);
 
+    // 先読みが完了した部屋を反映.
+    m_World.Update();
+
+    // 敵が追いかける目標. 作り直しは敵が方向を引いた時に行うので，追いかける敵がいなければ掛からない.
+    m_MapSystem.SetPathGoal(m_Player.GetBox());
+
     // マップ更新.
     m_MapSystem.Update(context);
 
     //// 敵更新.
     //m_EnemyTest.Update(context);
 
+    // 全キャラのアニメーションをまとめて進める.
+    m_AnimSystem.Update();
+
     // スイッチャー更新.
     {
         auto w = float(m_Width);
@@ -361,19 +362,17 @@ void GameApp::OnFrameRender(asdx::FrameEventArgs& args)
 {
     auto pMainRTV = m_SceneColor.GetTargetView();
     auto pRTV = m_ColorTarget2D.GetTargetView();
-    auto pDSV = m_DepthTarget2D.GetTargetView();
-    if (pRTV == nullptr || pDSV == nullptr || pMainRTV == nullptr)
+    if (pRTV == nullptr || pMainRTV == nullptr)
     { return; }
 
-    // 会話メッセージを表示する場合.
-    auto showMsg = true;
+    // メッセージウィンドウを上側に表示するかどうか.
     auto upper = (m_Player.GetBox().Pos.y >= 424);
     {
         // ターゲットをクリア.
         m_pDeviceContext->ClearRenderTargetView(pMainRTV, m_ClearColor);
-        m_pDeviceContext->ClearDepthStencilView(pDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
 
-        m_pDeviceContext->OMSetRenderTargets(1, &pMainRTV, pDSV);
+        // スプライトはレイヤー順に並べて奥から描くので深度バッファは使わない.
+        m_pDeviceContext->OMSetRenderTargets(1, &pMainRTV, nullptr);
 
         D3D11_VIEWPORT viewport = {};
         viewport.TopLeftX   = 0;
@@ -395,15 +394,22 @@ void GameApp::OnFrameRender(asdx::FrameEventArgs& args)
 
         auto pSmp = asdx::RenderState::GetInstance().GetSmp(asdx::SamplerType::LinearClamp);
         auto pBS  = asdx::RenderState::GetInstance().GetBS(asdx::BlendType::AlphaBlend);
-        auto pDSS = asdx::RenderState::GetInstance().GetDSS(asdx::DepthType::Default);
+        auto pDSS = asdx::RenderState::GetInstance().GetDSS(asdx::DepthType::None);
 
         float blendFactor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
         UINT mask = 0xffffff;
         m_pDeviceContext->OMSetBlendState(pBS, blendFactor, mask);
         m_pDeviceContext->OMSetDepthStencilState(pDSS, 0);
 
+        // シザー矩形の外側はスプライトの段階で捨てる.
+        m_Sprite.SetCullRect(Box(
+            scissor.left,
+            scissor.top,
+            scissor.right  - scissor.left,
+            scissor.bottom - scissor.top));
+
         // スプライト描画開始.
-        m_Sprite.Begin(m_pDeviceContext);
+        m_Sprite.Begin();
         m_Sprite.SetColor(1.0f, 1.0f, 1.0f, 1.0f);
 
         // マップ描画.
@@ -416,12 +422,13 @@ void GameApp::OnFrameRender(asdx::FrameEventArgs& args)
         m_Player.Draw(m_Sprite);
 
         // スプライト描画終了.
-        m_Sprite.End(m_pDeviceContext);
+        m_Sprite.End();
+        m_Sprite.ResetCullRect();
     }
 
     // スワップチェインに描画.
     {
-        m_pDeviceContext->OMSetRenderTargets(1, &pRTV, pDSV);
+        m_pDeviceContext->OMSetRenderTargets(1, &pRTV, nullptr);
 
         D3D11_VIEWPORT viewport = {};
         viewport.TopLeftX   = 0;
@@ -441,7 +448,7 @@ void GameApp::OnFrameRender(asdx::FrameEventArgs& args)
         m_pDeviceContext->RSSetScissorRects(1, &scissor);
 
         auto pBS  = asdx::RenderState::GetInstance().GetBS(asdx::BlendType::AlphaBlend);
-        auto pDSS = asdx::RenderState::GetInstance().GetDSS(asdx::DepthType::Default);
+        auto pDSS = asdx::RenderState::GetInstance().GetDSS(asdx::DepthType::None);
 
         float blendFactor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
         UINT mask = 0xffffff;
@@ -471,7 +478,7 @@ void GameApp::OnFrameRender(asdx::FrameEventArgs& args)
         }
 
         // スプライト描画開始.
-        m_Sprite.Begin(m_pDeviceContext);
+        m_Sprite.Begin();
         m_Sprite.SetColor(1.0f, 1.0f, 1.0f, 1.0f);
 
         // HUD表示.
@@ -480,24 +487,21 @@ void GameApp::OnFrameRender(asdx::FrameEventArgs& args)
         // メッセージウィンドウ枠表示.
         m_EventSystem.DrawWindow(m_Sprite, upper);
 
+        // 会話メッセージ表示.
+        m_EventSystem.DrawMsg(m_Sprite, upper);
+
+        // スプライト描画の統計表示.
+        m_Hud.DrawStats(m_Sprite, m_Sprite.GetStats());
+
         // スプライト描画終了.
-        m_Sprite.End(m_pDeviceContext);
+        m_Sprite.End();
 
         ID3D11ShaderResourceView* pNullSRV[] = { nullptr };
         m_pDeviceContext->PSSetShaderResources(0, 1, pNullSRV);
     }
 
-    // メッセージ描画.
-    if (showMsg)
-    {
-        auto context = m_pDeviceContext2D.GetPtr();
-        context->BeginDraw();
-        context->SetTarget(m_pBitmap2D.GetPtr());
-
-        m_EventSystem.DrawMsg(context, upper);
-
-        m_pDeviceContext2D->EndDraw();
-    }
+    // 2回分の Begin() / End() を1フレームの統計としてまとめる.
+    m_Sprite.FlushStats();
 
     // 画面に表示.
     Present(1);
@@ -546,6 +550,13 @@ void GameApp::OnResize(const asdx::ResizeEventArgs& args)
 //-----------------------------------------------------------------------------
 void GameApp::OnKey(const asdx::KeyEventArgs& args)
 {
+    // F3 でスプライト描画の統計表示を切り替え.
+    if (args.IsKeyDown && args.KeyCode == VK_F3)
+    {
+        auto visible = !m_Hud.IsStatsVisible();
+        m_Hud.SetStatsVisible(visible);
+        m_Sprite.SetStatsEnabled(visible);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -19,18 +19,21 @@
 //-----------------------------------------------------------------------------
 //      コンストラクタです.
 //-----------------------------------------------------------------------------
-Gimmick::Gimmick()
-{
-    MessageMgr::Instance().Add(this);
-}
+Gimmick::Gimmick(MAP_GIMMICK_TYPE type)
+: m_Type(type)
+{ /* DO_NOTHING */ }
 
 //-----------------------------------------------------------------------------
 //      デストラクタです.
 //-----------------------------------------------------------------------------
 Gimmick::~Gimmick()
-{
-    MessageMgr::Instance().Remove(this);
-}
+{ Detach(); }
+
+//-----------------------------------------------------------------------------
+//      種類を取得します.
+//-----------------------------------------------------------------------------
+MAP_GIMMICK_TYPE Gimmick::GetType() const
+{ return m_Type; }
 
 //-----------------------------------------------------------------------------
 //      タイル番号から位置を設定します.
@@ -38,6 +41,7 @@ Gimmick::~Gimmick()
 Gimmick& Gimmick::SetTilePos(int tileX, int tileY)
 {
     m_Box.Pos = CalcPosFromTile(tileX, tileY);
+    UpdateGrid();
     return *this;
 }
 
@@ -48,18 +52,46 @@ Gimmick& Gimmick::SetSize(int w, int h)
 {
     m_Box.Size.x = w;
     m_Box.Size.y = h;
+    UpdateGrid();
     return *this;
 }
 
 //-----------------------------------------------------------------------------
-//      テクスチャを設定します.
+//      テクスチャ領域を設定します.
 //-----------------------------------------------------------------------------
-Gimmick& Gimmick::SetSRV(ID3D11ShaderResourceView* pSRV)
+Gimmick& Gimmick::SetRegion(const TextureRegion& value)
 {
-    m_pSRV = pSRV;
+    m_Region = value;
     return *this;
 }
 
+//-----------------------------------------------------------------------------
+//      グリッドに登録します.
+//-----------------------------------------------------------------------------
+void Gimmick::Attach(GimmickGrid* pGrid)
+{
+    Detach();
+
+    if (pGrid == nullptr)
+    { return; }
+
+    m_pGrid  = pGrid;
+    m_GridId = pGrid->Insert(this, m_Box);
+}
+
+//-----------------------------------------------------------------------------
+//      グリッドから外します.
+//-----------------------------------------------------------------------------
+void Gimmick::Detach()
+{
+    if (m_pGrid == nullptr)
+    { return; }
+
+    m_pGrid->Remove(m_GridId);
+    m_pGrid  = nullptr;
+    m_GridId = kInvalidGridId;
+}
+
 //-----------------------------------------------------------------------------
 //      状態をリセットします.
 //-----------------------------------------------------------------------------
@@ -81,12 +113,12 @@ bool Gimmick::CanMove(const Box& playerBox)
 //-----------------------------------------------------------------------------
 //      描画処理を行います.
 //-----------------------------------------------------------------------------
-void Gimmick::Draw(SpriteSystem& sprite, int layer)
-{ 
+void Gimmick::Draw(SpriteSystem& sprite, int offsetX, int offsetY, int layer) const
+{
     sprite.Draw(
-        m_pSRV,
-        m_Box.Pos.x + int(m_Scroll.x),
-        m_Box.Pos.y + int(m_Scroll.y),
+        m_Region,
+        m_Box.Pos.x + offsetX,
+        m_Box.Pos.y + offsetY,
         m_Box.Size.x,
         m_Box.Size.y,
         layer);
@@ -99,46 +131,40 @@ Box Gimmick::GetBox() const
 { return m_Box; }
 
 //-----------------------------------------------------------------------------
-//      シェーダリソースビューを取得します.
+//      配置テーブルの番号を設定します.
 //-----------------------------------------------------------------------------
-ID3D11ShaderResourceView* Gimmick::GetSRV() const
-{ return m_pSRV; }
+void Gimmick::SetDescIndex(uint32_t value)
+{ m_DescIndex = value; }
 
 //-----------------------------------------------------------------------------
-//      スクロール処理を行います.
+//      配置テーブルの番号を取得します.
 //-----------------------------------------------------------------------------
-void Gimmick::OnScroll(const Message& msg)
-{
-    auto dir = *msg.GetAs<uint8_t>();
-    switch(dir)
-    {
-    case DIRECTION_LEFT:
-        if (m_Scroll.x < kMapMaxiX)
-        { m_Scroll.x += kMapScrollX; }
-        break;
-
-    case DIRECTION_RIGHT:
-        if (m_Scroll.x > -kMapMaxiX)
-        { m_Scroll.x -= kMapScrollX; }
-        break;
-
-    case DIRECTION_UP:
-        if (m_Scroll.y < kMapMaxiY)
-        { m_Scroll.y += kMapScrollY; }
-        break;
-
-    case DIRECTION_DOWN:
-        if (m_Scroll.y > -kMapMaxiY)
-        { m_Scroll.y -= kMapScrollY; }
-        break;
-    }
-}
+uint32_t Gimmick::GetDescIndex() const
+{ return m_DescIndex; }
+
+//-----------------------------------------------------------------------------
+//      配置時からの変化を書き出します.
+//-----------------------------------------------------------------------------
+bool Gimmick::SaveState(MapGimmickState& state) const
+{ return false; }
+
+//-----------------------------------------------------------------------------
+//      配置時からの変化を適用します.
+//-----------------------------------------------------------------------------
+void Gimmick::LoadState(const MapGimmickState& state)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      テクスチャ領域を取得します.
+//-----------------------------------------------------------------------------
+const TextureRegion& Gimmick::GetRegion() const
+{ return m_Region; }
 
 //-----------------------------------------------------------------------------
-//      スクロール完了時の処理です.
+//      位置が変わったのでグリッドに登録し直します.
 //-----------------------------------------------------------------------------
-void Gimmick::OnScrollCompleted()
+void Gimmick::UpdateGrid()
 {
-    m_Scroll.x = 0;
-    m_Scroll.y = 0;
+    if (m_pGrid != nullptr)
+    { m_pGrid->Move(m_GridId, m_Box); }
 }
@@ -0,0 +1,243 @@
+﻿//-----------------------------------------------------------------------------
+// File : GimmickGrid.cpp
+// Desc : Uniform Grid for Gimmick Queries.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cassert>
+#include <algorithm>
+#include <GimmickGrid.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      座標からセル番号を求めます. 範囲外は端のセルに丸めます.
+//-----------------------------------------------------------------------------
+inline uint16_t ToCell(int pos, int origin, int cellSize, uint32_t count)
+{
+    auto cell = (pos - origin) / cellSize;
+    return uint16_t(std::min(std::max(cell, 0), int(count) - 1));
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GimmickGrid class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+GimmickGrid::GimmickGrid()
+: m_OriginX (0)
+, m_OriginY (0)
+, m_CellSize(1)
+, m_CountX  (0)
+, m_CountY  (0)
+, m_Count   (0)
+, m_Stamp   (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+GimmickGrid::~GimmickGrid()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+void GimmickGrid::Init(int originX, int originY, int cellSize, uint32_t countX, uint32_t countY)
+{
+    assert(cellSize > 0);
+    assert(0 < countX && countX <= UINT16_MAX);
+    assert(0 < countY && countY <= UINT16_MAX);
+
+    m_OriginX  = originX;
+    m_OriginY  = originY;
+    m_CellSize = cellSize;
+    m_CountX   = countX;
+    m_CountY   = countY;
+
+    m_Cells.clear();
+    m_Cells.resize(countX * countY);
+
+    m_Entries.clear();
+    m_FreeIds.clear();
+    m_Count = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      全ての登録を外します.
+//-----------------------------------------------------------------------------
+void GimmickGrid::Clear()
+{
+    // セルの容量は次の部屋でも使い回す.
+    for(auto& itr : m_Cells)
+    { itr.clear(); }
+
+    m_Entries.clear();
+    m_FreeIds.clear();
+    m_Count = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      ギミックを登録します.
+//-----------------------------------------------------------------------------
+uint32_t GimmickGrid::Insert(Gimmick* pGimmick, const Box& box)
+{
+    assert(pGimmick != nullptr);
+    assert(!m_Cells.empty());
+
+    uint32_t id;
+    if (!m_FreeIds.empty())
+    {
+        id = m_FreeIds.back();
+        m_FreeIds.pop_back();
+    }
+    else
+    {
+        id = uint32_t(m_Entries.size());
+        m_Entries.push_back(Entry());
+    }
+
+    auto& entry = m_Entries[id];
+    entry.pGimmick = pGimmick;
+    entry.Bounds   = box;
+    entry.Range    = CalcRange(box);
+    entry.Stamp    = m_Stamp;
+
+    Link(id, entry.Range);
+    m_Count++;
+
+    return id;
+}
+
+//-----------------------------------------------------------------------------
+//      登録を外します.
+//-----------------------------------------------------------------------------
+void GimmickGrid::Remove(uint32_t id)
+{
+    if (id >= m_Entries.size() || m_Entries[id].pGimmick == nullptr)
+    { return; }
+
+    auto& entry = m_Entries[id];
+    Unlink(id, entry.Range);
+    entry.pGimmick = nullptr;
+
+    m_FreeIds.push_back(id);
+    m_Count--;
+}
+
+//-----------------------------------------------------------------------------
+//      矩形を更新します.
+//-----------------------------------------------------------------------------
+void GimmickGrid::Move(uint32_t id, const Box& box)
+{
+    assert(id < m_Entries.size() && m_Entries[id].pGimmick != nullptr);
+
+    auto& entry = m_Entries[id];
+    entry.Bounds = box;
+
+    // 1タイル押す間はほとんどセルをまたがないので，範囲が変わった時だけ付け替える.
+    auto range = CalcRange(box);
+    if (range.X0 == entry.Range.X0 && range.Y0 == entry.Range.Y0
+     && range.X1 == entry.Range.X1 && range.Y1 == entry.Range.Y1)
+    { return; }
+
+    Unlink(id, entry.Range);
+    entry.Range = range;
+    Link(id, entry.Range);
+}
+
+//-----------------------------------------------------------------------------
+//      矩形と重なるギミックを取得します.
+//-----------------------------------------------------------------------------
+void GimmickGrid::Query(const Box& box, std::vector<Gimmick*>& result)
+{
+    result.clear();
+
+    if (m_Count == 0)
+    { return; }
+
+    // 複数セルに登録されたギミックを1度だけ返すために通し番号で印を付ける.
+    m_Stamp++;
+
+    auto range = CalcRange(box);
+    for(auto y=range.Y0; y<=range.Y1; ++y)
+    {
+        auto pRow = &m_Cells[y * m_CountX];
+        for(auto x=range.X0; x<=range.X1; ++x)
+        {
+            for(auto id : pRow[x])
+            {
+                auto& entry = m_Entries[id];
+                if (entry.Stamp == m_Stamp)
+                { continue; }
+
+                entry.Stamp = m_Stamp;
+                if (IsHit(box, entry.Bounds))
+                { result.push_back(entry.pGimmick); }
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      登録数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t GimmickGrid::GetCount() const
+{ return m_Count; }
+
+//-----------------------------------------------------------------------------
+//      矩形が掛かるセルの範囲を求めます.
+//-----------------------------------------------------------------------------
+GimmickGrid::CellRange GimmickGrid::CalcRange(const Box& box) const
+{
+    // 右端・下端は矩形に含まれる最後のピクセルで求める.
+    auto w = std::max(box.Size.x, 1);
+    auto h = std::max(box.Size.y, 1);
+
+    CellRange result;
+    result.X0 = ToCell(box.Pos.x,         m_OriginX, m_CellSize, m_CountX);
+    result.Y0 = ToCell(box.Pos.y,         m_OriginY, m_CellSize, m_CountY);
+    result.X1 = ToCell(box.Pos.x + w - 1, m_OriginX, m_CellSize, m_CountX);
+    result.Y1 = ToCell(box.Pos.y + h - 1, m_OriginY, m_CellSize, m_CountY);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      セルに登録します.
+//-----------------------------------------------------------------------------
+void GimmickGrid::Link(uint32_t id, const CellRange& range)
+{
+    for(auto y=range.Y0; y<=range.Y1; ++y)
+    {
+        for(auto x=range.X0; x<=range.X1; ++x)
+        { m_Cells[y * m_CountX + x].push_back(id); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      セルから外します.
+//-----------------------------------------------------------------------------
+void GimmickGrid::Unlink(uint32_t id, const CellRange& range)
+{
+    for(auto y=range.Y0; y<=range.Y1; ++y)
+    {
+        for(auto x=range.X0; x<=range.X1; ++x)
+        {
+            // セル内の順序は問わないので末尾と入れ替えて詰める.
+            auto& cell = m_Cells[y * m_CountX + x];
+            auto  itr  = std::find(cell.begin(), cell.end(), id);
+            assert(itr != cell.end());
+            *itr = cell.back();
+            cell.pop_back();
+        }
+    }
+}
@@ -0,0 +1,470 @@
+﻿//-----------------------------------------------------------------------------
+// File : GlyphCache.cpp
+// Desc : Glyph Atlas Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <GlyphCache.h>
+#include <cassert>
+#include <cstring>
+#include <cwchar>
+#include <algorithm>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      次の文字のコードポイントを取得し，読み取り位置を進めます.
+//-----------------------------------------------------------------------------
+uint32_t NextCode(const wchar_t*& text)
+{
+    uint32_t code = uint32_t(*text++);
+
+    // wchar_t が UTF-16 の場合はサロゲートペアを結合する.
+    if (sizeof(wchar_t) == 2 && 0xD800 <= code && code <= 0xDBFF)
+    {
+        uint32_t low = uint32_t(*text);
+        if (0xDC00 <= low && low <= 0xDFFF)
+        {
+            text++;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+    }
+
+    return code;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GlyphCache class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+GlyphCache::GlyphCache()
+: m_pRasterizer (nullptr)
+, m_Desc        ()
+, m_SlotColumns (0)
+, m_SlotsPerPage(0)
+, m_FillPage    (0)
+, m_Frame       (0)
+, m_EvictCount  (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+GlyphCache::~GlyphCache()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool GlyphCache::Init(IGlyphRasterizer* pRasterizer, const GlyphCacheDesc& desc)
+{
+    if (pRasterizer == nullptr
+     || desc.PageCount == 0
+     || desc.CellSize <= desc.OutlineRadius * 2
+     || desc.PageSize < desc.CellSize * 2)
+    { return false; }
+
+    m_pRasterizer  = pRasterizer;
+    m_Desc         = desc;
+    m_SlotColumns  = desc.PageSize / (desc.CellSize * 2);
+    m_SlotsPerPage = m_SlotColumns * (desc.PageSize / desc.CellSize);
+    m_FillPage     = 0;
+    m_Frame        = 0;
+    m_EvictCount   = 0;
+
+    m_Pages.resize(desc.PageCount);
+    for(auto& page : m_Pages)
+    {
+        page.Pixels.assign(desc.PageSize * desc.PageSize, 0);
+        page.Codes .clear();
+        page.Codes .reserve(m_SlotsPerPage);
+        page.LastUsed    = 0;
+        page.DirtyTop    = 0;
+        page.DirtyBottom = desc.PageSize;   // 初回は全体を転送する.
+    }
+
+    m_Entries.clear();
+    m_Entries.reserve(m_SlotsPerPage * desc.PageCount);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void GlyphCache::Term()
+{
+    m_Pages    .clear();
+    m_Entries  .clear();
+    m_FillQuads.clear();
+
+    m_pRasterizer  = nullptr;
+    m_SlotColumns  = 0;
+    m_SlotsPerPage = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      フレームを進めます.
+//-----------------------------------------------------------------------------
+void GlyphCache::NewFrame()
+{ m_Frame++; }
+
+//-----------------------------------------------------------------------------
+//      文字を検索し，無ければラスタライズして追加します.
+//-----------------------------------------------------------------------------
+const GlyphEntry* GlyphCache::Find(uint32_t code)
+{
+    auto itr = m_Entries.find(code);
+    if (itr != m_Entries.end())
+    {
+        m_Pages[itr->second.Page].LastUsed = m_Frame;
+        return &itr->second;
+    }
+
+    if (m_pRasterizer == nullptr)
+    { return nullptr; }
+
+    m_Bitmap.OffsetX = 0;
+    m_Bitmap.OffsetY = 0;
+    m_Bitmap.Width   = 0;
+    m_Bitmap.Height  = 0;
+    m_Bitmap.Advance = 0;
+    m_Bitmap.Coverage.clear();
+
+    if (!m_pRasterizer->Rasterize(code, m_Bitmap))
+    { return nullptr; }
+
+    uint32_t page = 0;
+    uint32_t slot = 0;
+    if (!AllocSlot(page, slot))
+    { return nullptr; }
+
+    GlyphEntry entry = {};
+    entry.Code    = code;
+    entry.Page    = uint16_t(page);
+    entry.Advance = int16_t(m_Bitmap.Advance);
+    WriteGlyph(page, slot, entry);
+
+    m_Pages[page].Codes.push_back(code);
+    m_Pages[page].LastUsed = m_Frame;
+
+    return &m_Entries.emplace(code, entry).first->second;
+}
+
+//-----------------------------------------------------------------------------
+//      テキストの横幅を求めます.
+//-----------------------------------------------------------------------------
+int32_t GlyphCache::Measure(const wchar_t* text)
+{
+    if (text == nullptr)
+    { return 0; }
+
+    int32_t width = 0;
+    while(*text != L'\0')
+    {
+        auto entry = Find(NextCode(text));
+        if (entry != nullptr)
+        { width += entry->Advance; }
+    }
+
+    return width;
+}
+
+//-----------------------------------------------------------------------------
+//      1行分のテキストの矩形を生成します.
+//-----------------------------------------------------------------------------
+uint32_t GlyphCache::BuildQuads
+(
+    const wchar_t*          text,
+    int32_t                 x,
+    int32_t                 y,
+    std::vector<GlyphQuad>& result
+)
+{
+    if (text == nullptr)
+    { return 0; }
+
+    return BuildQuads(text, uint32_t(wcslen(text)), x, y, result);
+}
+
+//-----------------------------------------------------------------------------
+//      テキストの一部から1行分の矩形を生成します.
+//-----------------------------------------------------------------------------
+uint32_t GlyphCache::BuildQuads
+(
+    const wchar_t*          text,
+    uint32_t                length,
+    int32_t                 x,
+    int32_t                 y,
+    std::vector<GlyphQuad>& result
+)
+{
+    if (text == nullptr)
+    { return 0; }
+
+    m_FillQuads.clear();
+
+    auto baseline = y + GetAscent();
+    auto penX     = x;
+    auto count    = 0u;
+    auto end      = text + length;
+
+    while(text < end && *text != L'\0')
+    {
+        auto entry = Find(NextCode(text));
+        if (entry == nullptr)
+        { continue; }
+
+        if (entry->Width > 0 && entry->Height > 0)
+        {
+            GlyphQuad quad;
+            quad.X       = penX + entry->OffsetX;
+            quad.Y       = baseline + entry->OffsetY;
+            quad.W       = entry->Width;
+            quad.H       = entry->Height;
+            quad.Page    = entry->Page;
+            quad.Outline = false;
+            memcpy(quad.TexRect, entry->FillRect, sizeof(quad.TexRect));
+            m_FillQuads.push_back(quad);
+
+            // 縁取りは塗りつぶしと同じ矩形で，テクスチャ座標だけが異なる.
+            if (m_Desc.OutlineRadius > 0)
+            {
+                quad.Outline = true;
+                memcpy(quad.TexRect, entry->OutlineRect, sizeof(quad.TexRect));
+                result.push_back(quad);
+            }
+
+            count++;
+        }
+
+        penX += entry->Advance;
+    }
+
+    result.insert(result.end(), m_FillQuads.begin(), m_FillQuads.end());
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//      行の上端からベースラインまでの高さを取得します.
+//-----------------------------------------------------------------------------
+int32_t GlyphCache::GetAscent() const
+{ return (m_pRasterizer != nullptr) ? m_pRasterizer->GetAscent() : 0; }
+
+//-----------------------------------------------------------------------------
+//      行の高さを取得します.
+//-----------------------------------------------------------------------------
+int32_t GlyphCache::GetLineHeight() const
+{ return (m_pRasterizer != nullptr) ? m_pRasterizer->GetLineHeight() : 0; }
+
+//-----------------------------------------------------------------------------
+//      ページ構成を取得します.
+//-----------------------------------------------------------------------------
+const GlyphCacheDesc& GlyphCache::GetDesc() const
+{ return m_Desc; }
+
+//-----------------------------------------------------------------------------
+//      ページの被覆率を取得します.
+//-----------------------------------------------------------------------------
+const uint8_t* GlyphCache::GetPagePixels(uint32_t page) const
+{
+    assert(page < m_Pages.size());
+    return m_Pages[page].Pixels.data();
+}
+
+//-----------------------------------------------------------------------------
+//      ページの更新された行範囲を取得します.
+//-----------------------------------------------------------------------------
+bool GlyphCache::GetDirtyRows(uint32_t page, uint32_t& top, uint32_t& bottom) const
+{
+    assert(page < m_Pages.size());
+    top    = m_Pages[page].DirtyTop;
+    bottom = m_Pages[page].DirtyBottom;
+    return top < bottom;
+}
+
+//-----------------------------------------------------------------------------
+//      ページの更新フラグを下ろします.
+//-----------------------------------------------------------------------------
+void GlyphCache::ClearDirty(uint32_t page)
+{
+    assert(page < m_Pages.size());
+    m_Pages[page].DirtyTop    = m_Desc.PageSize;
+    m_Pages[page].DirtyBottom = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      保持している文字数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t GlyphCache::GetGlyphCount() const
+{ return uint32_t(m_Entries.size()); }
+
+//-----------------------------------------------------------------------------
+//      ページを追い出した回数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t GlyphCache::GetEvictCount() const
+{ return m_EvictCount; }
+
+//-----------------------------------------------------------------------------
+//      文字を書き込むセルを確保します.
+//-----------------------------------------------------------------------------
+bool GlyphCache::AllocSlot(uint32_t& page, uint32_t& slot)
+{
+    // ページ単位で追い出すので，セルは常に先頭から順に埋まる.
+    if (m_Pages[m_FillPage].Codes.size() >= m_SlotsPerPage)
+    {
+        auto found = false;
+        for(auto i=0u; i<m_Pages.size(); ++i)
+        {
+            if (m_Pages[i].Codes.size() < m_SlotsPerPage)
+            {
+                m_FillPage = i;
+                found      = true;
+                break;
+            }
+        }
+
+        // 空きが無ければ最も長く使われていないページを空ける.
+        if (!found)
+        {
+            auto lru = UINT32_MAX;
+            for(auto i=0u; i<m_Pages.size(); ++i)
+            {
+                // 現在のフレームで使ったページは表示中なので追い出さない.
+                if (m_Pages[i].LastUsed == m_Frame)
+                { continue; }
+
+                if (lru == UINT32_MAX || m_Pages[i].LastUsed < m_Pages[lru].LastUsed)
+                { lru = i; }
+            }
+
+            if (lru == UINT32_MAX)
+            { return false; }
+
+            Evict(lru);
+            m_FillPage = lru;
+        }
+    }
+
+    page = m_FillPage;
+    slot = uint32_t(m_Pages[page].Codes.size());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ページの文字を全て破棄します.
+//-----------------------------------------------------------------------------
+void GlyphCache::Evict(uint32_t page)
+{
+    for(auto code : m_Pages[page].Codes)
+    { m_Entries.erase(code); }
+
+    m_Pages[page].Codes.clear();
+    m_EvictCount++;
+}
+
+//-----------------------------------------------------------------------------
+//      ラスタライズ結果をセルに書き込みます.
+//-----------------------------------------------------------------------------
+void GlyphCache::WriteGlyph(uint32_t pageIndex, uint32_t slot, GlyphEntry& entry)
+{
+    auto& page   = m_Pages[pageIndex];
+    auto  cell   = m_Desc.CellSize;
+    auto  radius = int32_t(m_Desc.OutlineRadius);
+    auto  stride = m_Desc.PageSize;
+    auto  fillX  = (slot % m_SlotColumns) * cell * 2;
+    auto  lineX  = fillX + cell;
+    auto  cellY  = (slot / m_SlotColumns) * cell;
+
+    // 前に入っていた文字を消す.
+    for(auto y=0u; y<cell; ++y)
+    { memset(&page.Pixels[(cellY + y) * stride + fillX], 0, cell * 2); }
+
+    // 縁取りの太さだけ広げた矩形を塗りつぶしと縁取りで共有する.
+    // 線形補間で隣のセルがにじまないように，右端と下端の1ピクセルは空けておく.
+    auto w = std::min(m_Bitmap.Width  + radius * 2, cell - 1);
+    auto h = std::min(m_Bitmap.Height + radius * 2, cell - 1);
+    if (m_Bitmap.Width == 0 || m_Bitmap.Height == 0)
+    {
+        w = 0;
+        h = 0;
+    }
+
+    auto src = m_Bitmap.Coverage.data();
+    auto srcW = int32_t(m_Bitmap.Width);
+    auto srcH = int32_t(m_Bitmap.Height);
+
+    for(auto y=0u; y<h; ++y)
+    {
+        auto dstFill = &page.Pixels[(cellY + y) * stride + fillX];
+        auto dstLine = &page.Pixels[(cellY + y) * stride + lineX];
+        auto sy      = int32_t(y) - radius;
+
+        for(auto x=0u; x<w; ++x)
+        {
+            auto sx = int32_t(x) - radius;
+
+            if (0 <= sx && sx < srcW && 0 <= sy && sy < srcH)
+            { dstFill[x] = src[sy * srcW + sx]; }
+
+            // 縁取りは半径内の被覆率の最大値(膨張)とする.
+            uint8_t value = 0;
+            for(auto dy=-radius; dy<=radius; ++dy)
+            {
+                auto py = sy + dy;
+                if (py < 0 || py >= srcH)
+                { continue; }
+
+                for(auto dx=-radius; dx<=radius; ++dx)
+                {
+                    auto px = sx + dx;
+                    if (px < 0 || px >= srcW)
+                    { continue; }
+
+                    // 角を少し丸めた円形の範囲にする.
+                    if (dx * dx + dy * dy > radius * radius + radius)
+                    { continue; }
+
+                    value = std::max(value, src[py * srcW + px]);
+                }
+            }
+            dstLine[x] = value;
+        }
+    }
+
+    auto size = float(stride);
+    entry.Width   = uint16_t(w);
+    entry.Height  = uint16_t(h);
+    entry.OffsetX = int16_t(m_Bitmap.OffsetX - radius);
+    entry.OffsetY = int16_t(m_Bitmap.OffsetY - radius);
+
+    entry.FillRect[0] = float(fillX)     / size;
+    entry.FillRect[1] = float(cellY)     / size;
+    entry.FillRect[2] = float(fillX + w) / size;
+    entry.FillRect[3] = float(cellY + h) / size;
+
+    entry.OutlineRect[0] = float(lineX)     / size;
+    entry.OutlineRect[1] = float(cellY)     / size;
+    entry.OutlineRect[2] = float(lineX + w) / size;
+    entry.OutlineRect[3] = float(cellY + h) / size;
+
+    MarkDirty(page, cellY, cellY + cell);
+}
+
+//-----------------------------------------------------------------------------
+//      更新された行範囲を広げます.
+//-----------------------------------------------------------------------------
+void GlyphCache::MarkDirty(Page& page, uint32_t top, uint32_t bottom)
+{
+    page.DirtyTop    = std::min(page.DirtyTop,    top);
+    page.DirtyBottom = std::max(page.DirtyBottom, bottom);
+}
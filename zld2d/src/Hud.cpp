@@ -22,6 +22,34 @@ static const int kLifeOffsetX = 32;
 static const int kLifeOffsetY = 8;
 static const int kLifeSize    = 32;
 static const int kLifeShadowOffset = 4;
+static const uint32_t kLifeCapacity = 512;      // 影とハートの2枚 x uint8_t の最大ライフ.
+
+static const int kStatsMargin      = 8;
+static const int kStatsGraphHeight = 32;
+static const int kStatsGraphWidth  = int(kSpriteStatsHistory);  // 1フレーム1ピクセル.
+
+// グラフに表示する項目とカラー.
+static const struct StatsGraph
+{
+    SPRITE_STAT Stat;
+    float       Color[4];
+} kStatsGraphs[] = {
+    { SPRITE_STAT_DRAW_CALLS,       { 0.3f, 1.0f, 0.3f, 0.9f } },
+    { SPRITE_STAT_TEXTURE_SWITCHES, { 0.3f, 0.8f, 1.0f, 0.9f } },
+    { SPRITE_STAT_UPLOAD_BYTES,     { 1.0f, 0.8f, 0.2f, 0.9f } },
+    { SPRITE_STAT_SUBMIT_TIME,      { 1.0f, 0.3f, 0.3f, 0.9f } },
+};
+
+//-----------------------------------------------------------------------------
+//      スプライト記述子のカラーを設定します.
+//-----------------------------------------------------------------------------
+inline void SetColor(SpriteDesc& desc, float r, float g, float b, float a)
+{
+    desc.Color[0] = r;
+    desc.Color[1] = g;
+    desc.Color[2] = b;
+    desc.Color[3] = a;
+}
 
 } // namespace
 
@@ -34,7 +62,10 @@ static const int kLifeShadowOffset = 4;
 //      コンストラクタです.
 //-----------------------------------------------------------------------------
 Hud::Hud()
-{ /* DO_NOTHING */ }
+: m_CurLife(0)
+, m_MaxLife(0)
+, m_StatsVisible(false)
+{ m_Life.Init(kLifeCapacity); }
 
 //-----------------------------------------------------------------------------
 //      デストラクタです.
@@ -42,6 +73,18 @@ Hud::Hud()
 Hud::~Hud()
 { /* DO_NOTHING */ }
 
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void Hud::Term(SpriteSystem& sprite)
+{
+    sprite.ReleaseRetained(m_Life);
+    m_Life.Clear();
+    m_LifeHandles.clear();
+    m_CurLife = 0;
+    m_MaxLife = 0;
+}
+
 //-----------------------------------------------------------------------------
 //      描画処理を行います.
 //-----------------------------------------------------------------------------
@@ -56,44 +99,121 @@ void Hud::Draw(SpriteSystem& sprite, const Player& player)
 //-----------------------------------------------------------------------------
 void Hud::DrawLife(SpriteSystem& sprite, uint8_t curLife, uint8_t maxLife)
 {
-    for(auto i=1; i<=maxLife; ++i)
+    // 最大ライフが変わった時だけハートを作り直す.
+    if (maxLife != m_MaxLife)
+    {
+        m_Life.Clear();
+        m_LifeHandles.resize(maxLife * 2);
+
+        auto& tex   = GetTexture(TEXTURE_HUD_LIFE);
+        auto  color = asdx::Vector4(1.0f, 1.0f, 1.0f, 1.0f);
+        for(auto i=0; i<maxLife; ++i)
+        {
+            auto x = kLifeOffsetX + kLifeSize * i;
+            auto y = kLifeOffsetY;
+
+            // 同じレイヤーなので生成順に描画される. 影を先に作る.
+            m_LifeHandles[i * 2 + 0] = m_Life.Create(tex, x + kLifeShadowOffset, y + kLifeShadowOffset, kLifeSize, kLifeSize, 0, color);
+            m_LifeHandles[i * 2 + 1] = m_Life.Create(tex, x, y, kLifeSize, kLifeSize, 0, color);
+        }
+
+        m_MaxLife = maxLife;
+        UpdateLifeColor(curLife);
+    }
+    else if (curLife != m_CurLife)
+    {
+        // 変化したハートのカラーだけを更新する.
+        UpdateLifeColor(curLife);
+    }
+
+    sprite.DrawRetained(m_Life);
+}
+
+//-----------------------------------------------------------------------------
+//      ライフに合わせてハートのカラーを設定します.
+//-----------------------------------------------------------------------------
+void Hud::UpdateLifeColor(uint8_t curLife)
+{
+    for(auto i=0; i<m_MaxLife; ++i)
     {
-        if (i <= curLife)
+        auto shadow = m_LifeHandles[i * 2 + 0];
+        auto heart  = m_LifeHandles[i * 2 + 1];
+
+        if (i < curLife)
         {
-            sprite.SetColor(0.1f, 0.1f, 0.1f, 1.0f);
-            sprite.Draw(
-                GetTexture(TEXTURE_HUD_LIFE),
-                kLifeOffsetX + kLifeSize * (i - 1) + kLifeShadowOffset,
-                kLifeOffsetY + kLifeShadowOffset,
-                kLifeSize,
-                kLifeSize);
-
-            sprite.SetColor(1.0f, 0.0f, 0.0f, 1.0f);
-            sprite.Draw(
-                GetTexture(TEXTURE_HUD_LIFE),
-                kLifeOffsetX + kLifeSize * (i - 1),
-                kLifeOffsetY,
-                kLifeSize,
-                kLifeSize);
+            m_Life.SetColor(shadow, 0.1f, 0.1f, 0.1f, 1.0f);
+            m_Life.SetColor(heart,  1.0f, 0.0f, 0.0f, 1.0f);
         }
         else
         {
-            sprite.SetColor(0.9f, 0.9f, 0.9f, 0.75f);
-            sprite.Draw(
-                GetTexture(TEXTURE_HUD_LIFE),
-                kLifeOffsetX + kLifeSize * (i - 1) + kLifeShadowOffset,
-                kLifeOffsetY + kLifeShadowOffset,
-                kLifeSize,
-                kLifeSize);
-
-            sprite.SetColor(0.1f, 0.1f, 0.1f, 0.75f);
-            sprite.Draw(
-                GetTexture(TEXTURE_HUD_LIFE),
-                kLifeOffsetX + kLifeSize * (i - 1),
-                kLifeOffsetY,
-                kLifeSize,
-                kLifeSize);
+            m_Life.SetColor(shadow, 0.9f, 0.9f, 0.9f, 0.75f);
+            m_Life.SetColor(heart,  0.1f, 0.1f, 0.1f, 0.75f);
         }
     }
+
+    m_CurLife = curLife;
 }
 
+//-----------------------------------------------------------------------------
+//      スプライト描画の統計をグラフで表示します.
+//-----------------------------------------------------------------------------
+void Hud::DrawStats(SpriteSystem& sprite, const SpriteStats& stats)
+{
+    if (!m_StatsVisible || stats.GetFrameCount() == 0)
+    { return; }
+
+    auto& tex    = GetTexture(TEXTURE_WHITE);
+    auto  frames = stats.GetFrameCount();
+    auto  left   = int(sprite.GetScreenSize().x) - kStatsGraphWidth - kStatsMargin;
+    auto  top    = kStatsMargin;
+
+    m_StatsSprites.clear();
+
+    for(auto& graph : kStatsGraphs)
+    {
+        auto summary = stats.GetSummary(graph.Stat);
+        auto scale   = (summary.Max > 0) ? float(kStatsGraphHeight) / float(summary.Max) : 0.0f;
+        auto bottom  = top + kStatsGraphHeight;
+
+        // 背景.
+        SpriteDesc desc;
+        SetSpriteDesc(desc, tex, left, top, kStatsGraphWidth, kStatsGraphHeight, 0);
+        SetColor(desc, 0.0f, 0.0f, 0.0f, 0.5f);
+        m_StatsSprites.push_back(desc);
+
+        // 古いフレームから右詰めで棒グラフを並べる. 高さは履歴の最大値で正規化.
+        for(auto i=0u; i<frames; ++i)
+        {
+            auto h = int(float(stats.GetHistory(graph.Stat, i)) * scale + 0.5f);
+            if (h <= 0)
+            { continue; }
+
+            auto x = left + kStatsGraphWidth - int(frames) + int(i);
+            SetSpriteDesc(desc, tex, x, bottom - h, 1, h, 0);
+            SetColor(desc, graph.Color[0], graph.Color[1], graph.Color[2], graph.Color[3]);
+            m_StatsSprites.push_back(desc);
+        }
+
+        // 平均値の線.
+        auto avg = int(float(summary.Avg) * scale + 0.5f);
+        SetSpriteDesc(desc, tex, left, bottom - avg, kStatsGraphWidth, 1, 0);
+        SetColor(desc, 1.0f, 1.0f, 1.0f, 0.75f);
+        m_StatsSprites.push_back(desc);
+
+        top = bottom + kStatsMargin;
+    }
+
+    sprite.DrawBatch(m_StatsSprites.data(), uint32_t(m_StatsSprites.size()));
+}
+
+//-----------------------------------------------------------------------------
+//      統計を表示するかどうかを設定します.
+//-----------------------------------------------------------------------------
+void Hud::SetStatsVisible(bool visible)
+{ m_StatsVisible = visible; }
+
+//-----------------------------------------------------------------------------
+//      統計を表示するかどうか?
+//-----------------------------------------------------------------------------
+bool Hud::IsStatsVisible() const
+{ return m_StatsVisible; }
@@ -0,0 +1,319 @@
+﻿//-----------------------------------------------------------------------------
+// File : MapFormat.cpp
+// Desc : Binary Map File Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MapFormat.h>
+#include <asdxLogger.h>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kTileArraySize = kTileTotalCount;     // 1タイル1byte.
+
+// Tile の bool メンバーの位置.
+static const size_t kTileFlagOffsets[] = {
+    offsetof(Tile, Moveable),
+    offsetof(Tile, Scrollable),
+    offsetof(Tile, Switchable),
+    offsetof(Tile, Fallable),
+};
+
+//-----------------------------------------------------------------------------
+//      アライメントに切り上げます.
+//-----------------------------------------------------------------------------
+inline uint32_t AlignUp(uint32_t value)
+{ return (value + kMapFileAlignment - 1) & ~(kMapFileAlignment - 1); }
+
+//-----------------------------------------------------------------------------
+//      ブロックがファイルに収まっているかどうか?
+//-----------------------------------------------------------------------------
+inline bool IsInside(uint32_t offset, uint64_t size, uint32_t fileSize, uint32_t headerSize)
+{
+    return offset >= headerSize
+        && (offset % kMapFileAlignment) == 0
+        && uint64_t(offset) + size <= fileSize;
+}
+
+//-----------------------------------------------------------------------------
+//      タイル種別が同じかどうか? bool は 0/1 以外も真として比較します.
+//-----------------------------------------------------------------------------
+inline bool IsSameTile(const Tile& lhs, const Tile& rhs)
+{
+    return lhs.TextureId  == rhs.TextureId
+        && !lhs.Moveable   == !rhs.Moveable
+        && !lhs.Scrollable == !rhs.Scrollable
+        && !lhs.Switchable == !rhs.Switchable
+        && !lhs.Fallable   == !rhs.Fallable;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      マップファイルのチェックサムを計算します.
+//-----------------------------------------------------------------------------
+uint32_t CalcMapChecksum(const void* pData, size_t size)
+{
+    auto ptr  = static_cast<const uint8_t*>(pData);
+    auto hash = 0x811c9dc5u;
+    for(size_t i=0; i<size; ++i)
+    {
+        hash ^= ptr[i];
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+//-----------------------------------------------------------------------------
+//      メモリ上のマップファイルを検証し，各ブロックを指すように設定します.
+//-----------------------------------------------------------------------------
+bool ResolveMapFile(uint8_t* pData, size_t size, MapFileView& result)
+{
+    if (pData == nullptr || size < sizeof(MapFileHeader))
+    {
+        ELOGA("Error : Invalid Map File. size = %zu", size);
+        return false;
+    }
+
+    auto pHeader = reinterpret_cast<const MapFileHeader*>(pData);
+    if (pHeader->Magic != kMapFileMagic)
+    {
+        ELOGA("Error : Invalid Map File Magic. magic = 0x%x", pHeader->Magic);
+        return false;
+    }
+
+    if (pHeader->Version != kMapFileVersion)
+    {
+        ELOGA("Error : Unsupported Map File Version. version = %u", pHeader->Version);
+        return false;
+    }
+
+    if (pHeader->HeaderSize    != sizeof(MapFileHeader)
+     || pHeader->FileSize      != size
+     || pHeader->TileCountX    != kTileCountX
+     || pHeader->TileCountY    != kTileCountY
+     || pHeader->PaletteStride != sizeof(Tile)
+     || pHeader->GimmickStride != sizeof(MapGimmickDesc)
+     || pHeader->PaletteCount  == 0
+     || pHeader->PaletteCount  >  kMaxTilePalette)
+    {
+        ELOGA("Error : Map File Layout Mismatch.");
+        return false;
+    }
+
+    auto paletteSize = uint64_t(pHeader->PaletteCount) * sizeof(Tile);
+    auto gimmickSize = uint64_t(pHeader->GimmickCount) * sizeof(MapGimmickDesc);
+    if (!IsInside(pHeader->TileOffset,    kTileArraySize, pHeader->FileSize, pHeader->HeaderSize)
+     || !IsInside(pHeader->PaletteOffset, paletteSize,    pHeader->FileSize, pHeader->HeaderSize)
+     || !IsInside(pHeader->GimmickOffset, gimmickSize,    pHeader->FileSize, pHeader->HeaderSize))
+    {
+        ELOGA("Error : Map File Block Out Of Range.");
+        return false;
+    }
+
+    if (pHeader->Flags & MAP_FILE_FLAG_CHECKSUM)
+    {
+        auto checksum = CalcMapChecksum(pData + pHeader->HeaderSize, size - pHeader->HeaderSize);
+        if (checksum != pHeader->Checksum)
+        {
+            ELOGA("Error : Map File Checksum Mismatch. expected = 0x%x, actual = 0x%x", pHeader->Checksum, checksum);
+            return false;
+        }
+    }
+
+    // 範囲外のパレット番号があると参照時に毎回確認が要るので，ここで弾いておく.
+    auto pIndices = pData + pHeader->TileOffset;
+    for(auto i=0u; i<kTileArraySize; ++i)
+    {
+        if (pIndices[i] >= pHeader->PaletteCount)
+        {
+            ELOGA("Error : Map File Tile Index Out Of Range. index = %u", pIndices[i]);
+            return false;
+        }
+    }
+
+    // 0/1 以外の値が入った bool を読むのは未定義動作なので，bool として触る前にバイト値で確認する.
+    auto pPalette = pData + pHeader->PaletteOffset;
+    for(auto i=0u; i<pHeader->PaletteCount; ++i)
+    {
+        for(auto offset : kTileFlagOffsets)
+        {
+            auto value = pPalette[i * sizeof(Tile) + offset];
+            if (value > 1)
+            {
+                ELOGA("Error : Map File Invalid Tile Flag. palette = %u, offset = %u, value = %u",
+                    i, uint32_t(offset), value);
+                return false;
+            }
+        }
+    }
+
+    // オフセットをポインタに直すだけで，中身は変換しない.
+    result.pHeader      = pHeader;
+    result.pTileIndices = pIndices;
+    result.pPalette     = reinterpret_cast<const Tile*>(pPalette);
+    result.PaletteCount = pHeader->PaletteCount;
+    result.pGimmicks    = reinterpret_cast<const MapGimmickDesc*>(pData + pHeader->GimmickOffset);
+    result.GimmickCount = pHeader->GimmickCount;
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      マップファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteMapFile
+(
+    const char*             path,
+    const uint8_t*          pTileIndices,
+    const Tile*             pPalette,
+    uint32_t                paletteCount,
+    const MapGimmickDesc*   pGimmicks,
+    uint32_t                gimmickCount,
+    bool                    checksum
+)
+{
+    if (path == nullptr || pTileIndices == nullptr || pPalette == nullptr
+     || paletteCount == 0 || paletteCount > kMaxTilePalette
+     || (pGimmicks == nullptr && gimmickCount > 0))
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    for(auto i=0u; i<kTileArraySize; ++i)
+    {
+        if (pTileIndices[i] >= paletteCount)
+        {
+            ELOGA("Error : Tile Index Out Of Range. index = %u", pTileIndices[i]);
+            return false;
+        }
+    }
+
+    auto tileOffset    = AlignUp(uint32_t(sizeof(MapFileHeader)));
+    auto paletteOffset = AlignUp(tileOffset + kTileArraySize);
+    auto gimmickOffset = AlignUp(paletteOffset + paletteCount * uint32_t(sizeof(Tile)));
+    auto fileSize      = AlignUp(gimmickOffset + gimmickCount * uint32_t(sizeof(MapGimmickDesc)));
+
+    // パディングも含めて0埋めしておき，同じ内容なら同じバイト列になるようにする.
+    std::vector<uint8_t> buffer(fileSize, 0);
+
+    MapFileHeader header = {};
+    header.Magic         = kMapFileMagic;
+    header.Version       = kMapFileVersion;
+    header.HeaderSize    = uint16_t(sizeof(MapFileHeader));
+    header.FileSize      = fileSize;
+    header.Flags         = checksum ? uint32_t(MAP_FILE_FLAG_CHECKSUM) : 0u;
+    header.TileCountX    = kTileCountX;
+    header.TileCountY    = kTileCountY;
+    header.PaletteStride = uint16_t(sizeof(Tile));
+    header.GimmickStride = uint16_t(sizeof(MapGimmickDesc));
+    header.TileOffset    = tileOffset;
+    header.PaletteOffset = paletteOffset;
+    header.PaletteCount  = paletteCount;
+    header.GimmickOffset = gimmickOffset;
+    header.GimmickCount  = gimmickCount;
+
+    memcpy(buffer.data() + tileOffset, pTileIndices, kTileArraySize);
+
+    // bool のメンバーは 0/1 に揃えて書き出す.
+    auto pDstPalette = reinterpret_cast<Tile*>(buffer.data() + paletteOffset);
+    for(auto i=0u; i<paletteCount; ++i)
+    {
+        pDstPalette[i].TextureId  = pPalette[i].TextureId;
+        pDstPalette[i].Moveable   = pPalette[i].Moveable;
+        pDstPalette[i].Scrollable = pPalette[i].Scrollable;
+        pDstPalette[i].Switchable = pPalette[i].Switchable;
+        pDstPalette[i].Fallable   = pPalette[i].Fallable;
+    }
+
+    if (gimmickCount > 0)
+    { memcpy(buffer.data() + gimmickOffset, pGimmicks, gimmickCount * sizeof(MapGimmickDesc)); }
+
+    if (checksum)
+    { header.Checksum = CalcMapChecksum(buffer.data() + sizeof(MapFileHeader), fileSize - sizeof(MapFileHeader)); }
+
+    memcpy(buffer.data(), &header, sizeof(header));
+
+    FILE* pFile = nullptr;
+    auto err = fopen_s(&pFile, path, "wb");
+    if (err != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    auto written = fwrite(buffer.data(), 1, buffer.size(), pFile);
+    fclose(pFile);
+
+    if (written != buffer.size())
+    {
+        ELOGA("Error : File Write Failed. path = %s", path);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      タイル配列からパレットを作ってマップファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteMapFile
+(
+    const char*             path,
+    const Tile*             pTiles,
+    const MapGimmickDesc*   pGimmicks,
+    uint32_t                gimmickCount,
+    bool                    checksum
+)
+{
+    if (pTiles == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    // 出てきた順にパレットへ登録する. 種別は高々数十なので線形探索で十分.
+    std::vector<Tile> palette;
+    uint8_t indices[kTileArraySize];
+
+    for(auto i=0u; i<kTileArraySize; ++i)
+    {
+        auto index = 0u;
+        while(index < palette.size() && !IsSameTile(palette[index], pTiles[i]))
+        { index++; }
+
+        if (index == palette.size())
+        {
+            if (palette.size() == kMaxTilePalette)
+            {
+                ELOGA("Error : Too Many Tile Types. path = %s", path);
+                return false;
+            }
+            palette.push_back(pTiles[i]);
+        }
+
+        indices[i] = uint8_t(index);
+    }
+
+    return WriteMapFile(
+        path,
+        indices,
+        palette.data(),
+        uint32_t(palette.size()),
+        pGimmicks,
+        gimmickCount,
+        checksum);
+}
@@ -8,14 +8,100 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <cassert>
+#include <algorithm>
 #include <MapSystem.h>
 #include <asdxLogger.h>
 #include <Gimmick.h>
+#include <gimmick/Block.h>
+#include <MapWorld.h>
 #include <Player.h>
 #include <MessageId.h>
 #include <TextureMgr.h>
 
 
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const int kMoveInset = 4;    // タイルとの当たり判定で上下左右をサイズの 1/kMoveInset ずつ縮める.
+
+//-----------------------------------------------------------------------------
+//      配置情報が正しいかどうか?
+//-----------------------------------------------------------------------------
+bool IsValidDesc(const MapGimmickDesc& desc)
+{
+    if (desc.Type >= MAP_GIMMICK_COUNT)
+    {
+        WLOGA("Warning : Unknown Gimmick Type. type = %u", desc.Type);
+        return false;
+    }
+
+    if (desc.TileX >= kTileCountX || desc.TileY >= kTileCountY || desc.Dir > DIRECTION_NONE)
+    {
+        WLOGA("Warning : Invalid Gimmick Placement. tile = (%u, %u), dir = %u", desc.TileX, desc.TileY, desc.Dir);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      配置情報からギミックを設定し，グリッドに登録します.
+//-----------------------------------------------------------------------------
+template<typename T>
+void SetupGimmick
+(
+    T&                      gimmick,
+    const MapGimmickDesc&   desc,
+    uint32_t                index,
+    const MapGimmickState*  pState,
+    GimmickGrid&            grid
+)
+{
+    gimmick.SetTilePos(desc.TileX, desc.TileY)
+           .SetSize(desc.Width, desc.Height)
+           .SetRegion(GetTexture(desc.TextureId));
+    gimmick.SetDescIndex(index);
+
+    if (pState != nullptr)
+    { gimmick.LoadState(*pState); }
+
+    gimmick.Attach(&grid);
+}
+
+//-----------------------------------------------------------------------------
+//      プレイヤーが移動可能かチェックします. 種類ごとの CanMove() を呼び出します.
+//-----------------------------------------------------------------------------
+bool CanMoveGimmick(Gimmick& gimmick, const Box& playerBox)
+{
+    switch(gimmick.GetType())
+    {
+    case MAP_GIMMICK_BLOCK:
+        return static_cast<Block&>(gimmick).CanMove(playerBox);
+
+    default:
+        // Gimmick::CanMove() は仮想関数ではないので，種類ごとの判定が抜けても気付けない.
+        // 種類を追加したら case も追加すること.
+        assert(false && "Unknown Gimmick Type.");
+        ELOGA("Error : Unknown Gimmick Type. type = %u", uint32_t(gimmick.GetType()));
+        return false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      矩形の中心が乗ったタイルIDを求めます.
+//-----------------------------------------------------------------------------
+inline uint32_t CalcCenterTileId(const Box& box)
+{
+    return CalcTileId(CalcTileIndex(
+        box.Pos.x + box.Size.x / 2,
+        box.Pos.y + box.Size.y / 2));
+}
+
+} // namespace
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // MapInstance structure
 ///////////////////////////////////////////////////////////////////////////////
@@ -25,17 +111,145 @@
 //-----------------------------------------------------------------------------
 bool MapInstance::Load(const char* path)
 {
-    // TODO : Implementation.
+    if (!LoadFile(path))
+    { return false; }
+
+    Activate();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルをマッピングして検証します.
+//-----------------------------------------------------------------------------
+bool MapInstance::LoadFile(const char* path)
+{
+    Dispose();
+
+    if (!File.Open(path))
+    {
+        ELOGA("Error : MappedFile::Open() Failed. path = %s", path);
+        return false;
+    }
+
+    // マッピングした領域をそのまま使うので，ポインタを設定するだけ.
+    MapFileView view = {};
+    if (!ResolveMapFile(File.GetData(), File.GetSize(), view))
+    {
+        ELOGA("Error : ResolveMapFile() Failed. path = %s", path);
+        File.Close();
+        return false;
+    }
+
+    Layer.Init(view.pTileIndices, view.pPalette, view.PaletteCount);
+    GimmickDescs = view.pGimmicks;
+    GimmickCount = view.GimmickCount;
+
     return true;
 }
 
+//-----------------------------------------------------------------------------
+//      ギミックを生成し，タイルのスプライトを展開します.
+//-----------------------------------------------------------------------------
+void MapInstance::Activate(const MapGimmickState* pStates, uint32_t stateCount)
+{
+    assert(pStates != nullptr || stateCount == 0);
+
+    Grid.Init(kTileOffsetX, kTileOffsetY, kTileSize, kTileCountX, kTileCountY);
+
+    // グリッドがアドレスを持つので，種類ごとの数を数えて先に必要な分だけ確保する.
+    uint32_t counts[MAP_GIMMICK_COUNT] = {};
+    for(auto i=0u; i<GimmickCount; ++i)
+    {
+        if (GimmickDescs[i].Type < MAP_GIMMICK_COUNT)
+        { counts[GimmickDescs[i].Type]++; }
+    }
+
+    Blocks.Init(counts[MAP_GIMMICK_BLOCK]);
+
+    // テクスチャの参照を伴うのでメインスレッドで生成する.
+    // 変化は番号の昇順なので，配置テーブルと並べて突き合わせる.
+    auto state = 0u;
+    for(auto i=0u; i<GimmickCount; ++i)
+    {
+        auto& desc = GimmickDescs[i];
+        if (!IsValidDesc(desc))
+        { continue; }
+
+        while(state < stateCount && pStates[state].Index < i)
+        { state++; }
+
+        auto pState = (state < stateCount && pStates[state].Index == i) ? &pStates[state] : nullptr;
+
+        switch(desc.Type)
+        {
+        case MAP_GIMMICK_BLOCK:
+            {
+                auto& block = Blocks.Add();
+                block.SetDir(DIRECTION_STATE(desc.Dir));
+                SetupGimmick(block, desc, i, pState, Grid);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    UpdatePath();
+
+    InvalidateCache();
+
+    // 最初の描画で展開しなくて済むように，ここで展開しておく.
+    if (Layer.IsValid())
+    { Cache.Build(Layer, GetTexture); }
+}
+
+//-----------------------------------------------------------------------------
+//      配置時から変化したギミックの状態を取得します.
+//-----------------------------------------------------------------------------
+void MapInstance::CaptureState(std::vector<MapGimmickState>& result) const
+{
+    result.clear();
+
+    ForEachGimmick([&](const auto& gimmick)
+    {
+        auto index = gimmick.GetDescIndex();
+        if (index > UINT16_MAX)
+        { return; }
+
+        MapGimmickState state = {};
+        if (!gimmick.SaveState(state))
+        { return; }
+
+        state.Index    = uint16_t(index);
+        state.Reserved = 0;
+        result.push_back(state);
+    });
+
+    // 種類ごとには配置テーブルの順に並んでいるので，種類をまたいで並べ直す.
+    std::sort(result.begin(), result.end(), [](const MapGimmickState& lhs, const MapGimmickState& rhs)
+    { return lhs.Index < rhs.Index; });
+}
+
 //-----------------------------------------------------------------------------
 //      セーブ処理を行います.
 //-----------------------------------------------------------------------------
 bool MapInstance::Save(const char* path)
 {
-    // TODO : Implmenetation.
-    return true;
+    if (!Layer.IsValid())
+    {
+        ELOGA("Error : Map Not Loaded.");
+        return false;
+    }
+
+    return WriteMapFile(
+        path,
+        Layer.GetIndices(),
+        Layer.GetPalette(),
+        Layer.GetPaletteCount(),
+        GimmickDescs,
+        GimmickCount,
+        true);
 }
 
 //-----------------------------------------------------------------------------
@@ -43,9 +257,49 @@ bool MapInstance::Save(const char* path)
 //-----------------------------------------------------------------------------
 void MapInstance::Dispose()
 {
-    // TODO : Implementation.
+    // 部屋がギミックの寿命を持つ. 破棄時にグリッドから外れるので，グリッドより先に破棄する.
+    Blocks.Clear();
+    Grid.Clear();
+    Path.Reset();
+
+    Layer.Reset();
+    GimmickDescs = nullptr;
+    GimmickCount = 0;
+
+    File.Close();
+    InvalidateCache();
 }
 
+//-----------------------------------------------------------------------------
+//      タイルのスプライトキャッシュを無効にします.
+//-----------------------------------------------------------------------------
+void MapInstance::InvalidateCache()
+{ Cache.Invalidate(); }
+
+//-----------------------------------------------------------------------------
+//      経路探索の通行可否を作り直します.
+//-----------------------------------------------------------------------------
+void MapInstance::UpdatePath()
+{
+    if (!Layer.IsValid())
+    {
+        Path.Reset();
+        return;
+    }
+
+    Path.SetLayer(Layer);
+
+    // ギミックは全て重なると移動できないので，掛かるタイルを塞ぐ.
+    ForEachGimmick([&](const auto& gimmick)
+    { Path.AddObstacle(gimmick.GetBox()); });
+}
+
+//-----------------------------------------------------------------------------
+//      ギミックの数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MapInstance::GetGimmickCount() const
+{ return Blocks.GetCount(); }
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // MapSystem class
@@ -69,6 +323,12 @@ MapSystem::~MapSystem()
     MessageMgr::Instance().Remove(this);
 }
 
+//-----------------------------------------------------------------------------
+//      部屋の接続を設定します.
+//-----------------------------------------------------------------------------
+void MapSystem::SetWorld(MapWorld* value)
+{ m_pWorld = value; }
+
 //-----------------------------------------------------------------------------
 //      現在のマップデータを設定します.
 //-----------------------------------------------------------------------------
@@ -84,10 +344,10 @@ void MapSystem::SetNext(MapInstance* instance)
 //-----------------------------------------------------------------------------
 //      タイルを取得します.
 //-----------------------------------------------------------------------------
-Tile MapSystem::GetTile(uint8_t id) const
+Tile MapSystem::GetTile(uint32_t id) const
 {
     assert(id < kTileTotalCount);
-    return m_Data->Tile[id];
+    return m_Data->Layer.GetTile(id);
 }
 
 //-----------------------------------------------------------------------------
@@ -95,34 +355,21 @@ Tile MapSystem::GetTile(uint8_t id) const
 //-----------------------------------------------------------------------------
 void MapSystem::Draw(SpriteSystem& sprite, int playerY)
 {
-    auto idx = 0;
-    for(auto i=0u; i<kTileCountY; ++i)
-    for(auto j=0u; j<kTileCountX; ++j)
-    {
-        auto tile = m_Data->Tile[idx];
-        idx++;
-
-        auto pSRV = GetTexture(tile.TextureId);
-        auto step = (float)(j) / kTileCountX;
+    DrawTiles(sprite, m_Data, int(m_Scroll.x), int(m_Scroll.y), playerY);
 
-        auto x = int(kTileOffsetX + kTileSize * j) + int(m_Scroll.x);
-        auto y = int(kTileOffsetY + kTileSize * i) + int(m_Scroll.y);
+    // ギミックもタイルと同じだけスクロールさせる.
+    auto scrollX = int(m_Scroll.x);
+    auto scrollY = int(m_Scroll.y);
 
-        // キャラよりもY座標が下側なら手前に表示されるように調整.
-        auto z = (!tile.Moveable && (playerY < y)) ? 0 : 2;
-
-        sprite.Draw(pSRV, x, y, kTileSize, kTileSize, z);
-    }
-
-    for(auto& itr : m_Data->Gimmicks)
+    m_Data->ForEachGimmick([&](const auto& gimmick)
     {
-        auto y = itr->GetBox().Pos.y;
+        auto y = gimmick.GetBox().Pos.y;
 
         // キャラよりもY座標が下側なら手前に表示されるように調整.
         auto z = (playerY < y) ? 0 : 2;
 
-        itr->Draw(sprite, z);
-    }
+        gimmick.Draw(sprite, scrollX, scrollY, z);
+    });
 
     // 次のマップを表示.
     if (m_IsScroll)
@@ -132,32 +379,57 @@ void MapSystem::Draw(SpriteSystem& sprite, int playerY)
         pos.x += int(m_Scroll.x);
         pos.y += int(m_Scroll.y);
 
-        idx = 0;
-        for(auto i=0u; i<kTileCountY; ++i)
-        for(auto j=0u; j<kTileCountX; ++j)
+        DrawTiles(sprite, m_Next, pos.x, pos.y, playerY);
+
+        m_Sprites.resize(m_Next->GetGimmickCount());
+
+        size_t idx = 0;
+        m_Next->ForEachGimmick([&](const auto& gimmick)
         {
-            auto tile = m_Next->Tile[idx];
+            auto box = gimmick.GetBox();
+            auto x = int(pos.x + box.Pos.x);
+            auto y = int(pos.y + box.Pos.y);
+
+            SetSpriteDesc(m_Sprites[idx], gimmick.GetRegion(), x, y, box.Size.x, box.Size.y, 2);
             idx++;
+        });
 
-            auto pSRV = GetTexture(tile.TextureId);
-            auto x = int(pos.x + kTileSize * j) + kTileOffsetX;
-            auto y = int(pos.y + kTileSize * i) + kTileOffsetY;
+        sprite.DrawBatch(m_Sprites.data(), uint32_t(m_Sprites.size()));
+    }
+}
 
-            // キャラよりもY座標が下側なら手前に表示されるように調整.
-            auto z = (!tile.Moveable && (playerY < y)) ? 0 : 2;
+//-----------------------------------------------------------------------------
+//      キャッシュしたタイルを平行移動して描画します.
+//-----------------------------------------------------------------------------
+void MapSystem::DrawTiles
+(
+    SpriteSystem&   sprite,
+    MapInstance*    instance,
+    int             offsetX,
+    int             offsetY,
+    int             playerY
+)
+{
+    // タイルが書き換えられた時だけ展開し直す.
+    instance->Cache.Build(instance->Layer, GetTexture);
 
-            sprite.Draw(pSRV, x, y, kTileSize, kTileSize, z);
-        }
+    auto pInstances = instance->Cache.GetInstances();
+    auto pTextures  = instance->Cache.GetTextures();
 
-        for(auto& itr : m_Next->Gimmicks)
-        {
-            auto box  = itr->GetBox();
-            auto pSRV = itr->GetSRV();
-            auto x = int(pos.x + box.Pos.x);
-            auto y = int(pos.y + box.Pos.y);
+    for(auto& range : instance->Cache.GetRanges())
+    {
+        auto y = range.Y + offsetY;
 
-            sprite.Draw(pSRV, x, y, box.Size.x, box.Size.y, 2);
-        }
+        // キャラよりもY座標が下側なら手前に表示されるように調整.
+        auto z = (range.Obstacle && (playerY < y)) ? 0 : 2;
+
+        sprite.DrawInstances(
+            pInstances + range.Start,
+            pTextures  + range.Start,
+            range.Count,
+            offsetX,
+            offsetY,
+            z);
     }
 }
 
@@ -166,32 +438,42 @@ void MapSystem::Draw(SpriteSystem& sprite, int playerY)
 //-----------------------------------------------------------------------------
 bool MapSystem::CanMove(const Box& nextBox)
 {
-    // 半キャラ分の可動を許した方が可動領域が広くて操作しやすかったので，
-    // 半キャラ分許容する.
-    auto idx = CalcTileIndex(
+    auto& layer = m_Data->Layer;
+
+    // 場面切り替えはキャラの中心が乗ったタイルで判定する.
+    Box center(
         nextBox.Pos.x + nextBox.Size.x / 2,
-        nextBox.Pos.y + nextBox.Size.y / 2);
-    auto id  = CalcTileId(idx);
+        nextBox.Pos.y + nextBox.Size.y / 2,
+        1, 1);
 
-    if (m_Data->Tile[id].Switchable)
+    if (layer.TestAny(TILE_FLAG_SWITCHABLE, center))
     {
         if (!m_IsSwitch)
         { m_IsSwitch = true; }
     }
-    else if (m_Data->Tile[id].Scrollable)
+    else if (layer.TestAny(TILE_FLAG_SCROLLABLE, center))
     {
         if (!m_IsScroll)
         { m_IsScroll = true; }
     }
 
+    // 半キャラ分の可動を許した方が可動領域が広くて操作しやすかったので，
+    // 上下左右を縮めた矩形が掛かる全タイルで判定する.
+    Box foot(
+        nextBox.Pos.x  + nextBox.Size.x / kMoveInset,
+        nextBox.Pos.y  + nextBox.Size.y / kMoveInset,
+        nextBox.Size.x - nextBox.Size.x / kMoveInset * 2,
+        nextBox.Size.y - nextBox.Size.y / kMoveInset * 2);
+
     // 移動しちゃダメなタイルなら処理終了.
-    if (!m_Data->Tile[id].Moveable)
+    if (!layer.TestAll(TILE_FLAG_MOVEABLE, foot))
     { return false; }
 
-    // 移動できないものがあるかどうかチェック.
-    for(auto& itr : m_Data->Gimmicks)
+    // 移動できないものがあるかどうかチェック. 重なっているギミックだけ調べる.
+    m_Data->Grid.Query(nextBox, m_Hits);
+    for(auto& itr : m_Hits)
     {
-        if (!itr->CanMove(nextBox))
+        if (!CanMoveGimmick(*itr, nextBox))
         { return false; }
     }
 
@@ -199,6 +481,30 @@ bool MapSystem::CanMove(const Box& nextBox)
     return true;
 }
 
+//-----------------------------------------------------------------------------
+//      矩形と重なるギミックを取得します.
+//-----------------------------------------------------------------------------
+void MapSystem::QueryGimmicks(const Box& box, std::vector<Gimmick*>& result)
+{ m_Data->Grid.Query(box, result); }
+
+//-----------------------------------------------------------------------------
+//      フローフィールドの目標を設定します.
+//-----------------------------------------------------------------------------
+void MapSystem::SetPathGoal(const Box& box)
+{ m_Data->Path.SetGoal(CalcCenterTileId(box)); }
+
+//-----------------------------------------------------------------------------
+//      目標に近づくための移動方向を取得します.
+//-----------------------------------------------------------------------------
+DIRECTION_STATE MapSystem::GetFlowDir(const Box& box)
+{ return m_Data->Path.GetFlowDir(CalcCenterTileId(box)); }
+
+//-----------------------------------------------------------------------------
+//      A* で経路を求めます.
+//-----------------------------------------------------------------------------
+bool MapSystem::FindPath(const Box& from, const Box& to, std::vector<uint32_t>& path)
+{ return m_Data->Path.FindPath(CalcCenterTileId(from), CalcCenterTileId(to), path); }
+
 //-----------------------------------------------------------------------------
 //      更新処理を行います.
 //-----------------------------------------------------------------------------
@@ -219,8 +525,9 @@ void MapSystem::Update(UpdateContext& context)
         SendMsg(msg);
     }
 
-    for(auto& itr : m_Data->Gimmicks)
-    { itr->Update(context); }
+    // 種類ごとに連続して並んでいるので，仮想関数を介さずにまとめて更新する.
+    for(auto& itr : m_Data->Blocks)
+    { itr.Update(context); }
 }
 
 
@@ -229,8 +536,11 @@ void MapSystem::Update(UpdateContext& context)
 //-----------------------------------------------------------------------------
 void MapSystem::Reset()
 {
-    for(auto& itr : m_Data->Gimmicks)
-    { itr->Reset(); }
+    m_Data->ForEachGimmick([](auto& gimmick)
+    { gimmick.Reset(); });
+
+    // 動かしたブロックが元に戻るので塞ぐタイルも戻す.
+    m_Data->UpdatePath();
 }
 
 //-----------------------------------------------------------------------------
@@ -250,6 +560,13 @@ bool MapSystem::IsScroll() const
 //-----------------------------------------------------------------------------
 void MapSystem::Scroll(DIRECTION_STATE dir)
 {
+    // スクロール開始時に隣の部屋を取り出す. 先読み済みなので読み込みは起こらない.
+    if (m_ScrollFrame == 0 && m_pWorld != nullptr)
+    {
+        auto next = m_pWorld->GetNeighbor(dir);
+        m_Next = (next != nullptr) ? next : m_Data;
+    }
+
     m_ScrollDir = dir;
 
     if (m_ScrollFrame < kScrollFrame)
@@ -298,13 +615,11 @@ void MapSystem::Scroll(DIRECTION_STATE dir)
 //-----------------------------------------------------------------------------
 void MapSystem::Change()
 {
-    // 次のデータが無かったら読み込み.
-    if (m_Next == nullptr)
-    {
-    }
+    // 隣の部屋に入ったことを伝えて，その先の部屋を先読みさせる.
+    if (m_pWorld != nullptr && m_Next != m_Data)
+    { m_pWorld->Enter(DIRECTION_STATE(m_ScrollDir)); }
 
     // 次のマップに差し替え.
-    auto data = m_Data;
     m_Data = m_Next;
     m_Next = m_Data;
 
@@ -336,6 +651,10 @@ void MapSystem::OnMessage(const Message& msg)
         { Change(); }
         break;
 
+    case MESSAGE_ID_GIMMICK_MOVED:
+        { m_Data->UpdatePath(); }
+        break;
+
     default:
         break;
     }
@@ -0,0 +1,797 @@
+﻿//-----------------------------------------------------------------------------
+// File : MapWorld.cpp
+// Desc : Room Graph and Residency.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MapWorld.h>
+#include <asdxLogger.h>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t   kMaxLineLength  = 1024;     // 1行の最大文字数.
+static const uint32_t   kMaxTokens      = 8;        // 1行の最大項目数.
+static const uint32_t   kMinBudget      = 5;        // 現在の部屋 + 隣接する4部屋.
+static const uint32_t   kSearchDepth    = 8;        // 距離を求める深さ. これより遠い部屋は最も遠いとみなす.
+static const uint32_t   kFarDistance    = UINT32_MAX;
+static const size_t     kPageSize       = 4096;     // 先読み時にページを触れておく間隔.
+
+// 方向名. DIRECTION_STATE の順.
+static const char* kDirNames[kRoomLinkCount] = {
+    "left",
+    "right",
+    "up",
+    "down",
+};
+
+//-----------------------------------------------------------------------------
+//      逆方向を取得します.
+//-----------------------------------------------------------------------------
+inline uint32_t Opposite(uint32_t dir)
+{ return dir ^ 0x1; }   // LEFT <-> RIGHT, UP <-> DOWN.
+
+//-----------------------------------------------------------------------------
+//      行をハードタブで分割します.
+//-----------------------------------------------------------------------------
+uint32_t SplitLine(char* line, char** tokens, uint32_t maxTokens)
+{
+    // 改行を取り除く.
+    auto len = strlen(line);
+    while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+    { line[--len] = '\0'; }
+
+    if (len == 0 || line[0] == '#')
+    { return 0; }
+
+    auto count = 0u;
+    auto head  = line;
+    while(count < maxTokens)
+    {
+        auto tab = strchr(head, '\t');
+        if (tab != nullptr)
+        { *tab = '\0'; }
+
+        // 連続したタブは1つの区切りとみなす.
+        if (head[0] != '\0')
+        { tokens[count++] = head; }
+
+        if (tab == nullptr)
+        { break; }
+
+        head = tab + 1;
+    }
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//      方向名から方向を取得します.
+//-----------------------------------------------------------------------------
+uint32_t FindDir(const char* name)
+{
+    for(auto i=0u; i<kRoomLinkCount; ++i)
+    {
+        if (strcmp(kDirNames[i], name) == 0)
+        { return i; }
+    }
+
+    return kRoomLinkCount;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MapWorld class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+MapWorld::MapWorld()
+: m_Budget          (0)
+, m_Current         (kInvalidRoomId)
+, m_Visit           (0)
+, m_LoadingCount    (0)
+, m_AsyncLoadCount  (0)
+, m_SyncLoadCount   (0)
+, m_EvictCount      (0)
+, m_Quit            (false)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+MapWorld::~MapWorld()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool MapWorld::Init(uint32_t budget)
+{
+    Term();
+
+    if (budget == 0)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    if (budget < kMinBudget)
+    { WLOGA("Warning : Residency Budget Is Too Small. budget = %u", budget); }
+
+    m_Budget = budget;
+    m_Slots.reset(new MapInstance[budget]);
+    m_SlotRooms.assign(budget, kInvalidRoomId);
+
+    m_Current        = kInvalidRoomId;
+    m_Visit          = 0;
+    m_LoadingCount   = 0;
+    m_AsyncLoadCount = 0;
+    m_SyncLoadCount  = 0;
+    m_EvictCount     = 0;
+    m_Quit           = false;
+
+    m_Worker = std::thread(&MapWorld::WorkerMain, this);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void MapWorld::Term()
+{
+    if (m_Worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Quit = true;
+        }
+        m_Signal.notify_all();
+        m_Worker.join();
+    }
+
+    // 読み込み中だったスロットも含めて全て破棄する.
+    for(auto i=0u; i<m_Budget; ++i)
+    { m_Slots[i].Dispose(); }
+
+    m_Slots.reset();
+    m_SlotRooms.clear();
+    m_Requests .clear();
+    m_Completes.clear();
+    m_Finished .clear();
+    m_Rooms    .clear();
+    m_RoomIds  .clear();
+    m_Search   .clear();
+
+    m_Budget       = 0;
+    m_Current      = kInvalidRoomId;
+    m_LoadingCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      部屋の接続をファイルから読み込みます.
+//-----------------------------------------------------------------------------
+bool MapWorld::LoadGraph(const char* path)
+{
+    FILE* pFile = nullptr;
+
+    auto err = fopen_s(&pFile, path, "r");
+    if (err != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    std::string root;
+    uint32_t    lineNo = 0;
+    bool        result = true;
+
+    char  line[kMaxLineLength];
+    char* tokens[kMaxTokens];
+
+    while(fgets(line, kMaxLineLength, pFile) != nullptr)
+    {
+        lineNo++;
+
+        // UTF-8 BOM は読み飛ばす.
+        auto head = line;
+        if (lineNo == 1 && strncmp(head, "\xEF\xBB\xBF", 3) == 0)
+        { head += 3; }
+
+        auto count = SplitLine(head, tokens, kMaxTokens);
+        if (count == 0)
+        { continue; }
+
+        if (strcmp(tokens[0], "root") == 0 && count == 2)
+        {
+            root = tokens[1];
+        }
+        else if (strcmp(tokens[0], "room") == 0 && count == 3)
+        {
+            auto fullPath = root + tokens[2];
+            if (AddRoom(tokens[1], fullPath.c_str()) == kInvalidRoomId)
+            {
+                ELOGA("Error : Duplicate Room. path = %s, line = %u", path, lineNo);
+                result = false;
+                break;
+            }
+        }
+        else if (strcmp(tokens[0], "link") == 0 && count == 4)
+        {
+            auto from = FindRoom(tokens[1]);
+            auto dir  = FindDir(tokens[2]);
+            auto to   = FindRoom(tokens[3]);
+            if (from == kInvalidRoomId || to == kInvalidRoomId || dir >= kRoomLinkCount
+             || !Link(from, DIRECTION_STATE(dir), to))
+            {
+                ELOGA("Error : Invalid Link. path = %s, line = %u", path, lineNo);
+                result = false;
+                break;
+            }
+        }
+        else
+        {
+            ELOGA("Error : Invalid Line. path = %s, line = %u", path, lineNo);
+            result = false;
+            break;
+        }
+    }
+
+    fclose(pFile);
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      部屋を追加します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::AddRoom(const char* name, const char* path)
+{
+    if (name == nullptr || path == nullptr)
+    { return kInvalidRoomId; }
+
+    auto id = uint32_t(m_Rooms.size());
+    if (!m_RoomIds.emplace(name, id).second)
+    { return kInvalidRoomId; }
+
+    Room room;
+    room.Name     = name;
+    room.Path     = path;
+    room.Slot     = kInvalidRoomId;
+    room.Distance = kFarDistance;
+    room.Visit    = 0;
+    room.State    = ROOM_STATE_NONE;
+    for(auto i=0u; i<kRoomLinkCount; ++i)
+    { room.Links[i] = kInvalidRoomId; }
+
+    m_Rooms.push_back(room);
+    return id;
+}
+
+//-----------------------------------------------------------------------------
+//      部屋を接続します.
+//-----------------------------------------------------------------------------
+bool MapWorld::Link(uint32_t from, DIRECTION_STATE dir, uint32_t to)
+{
+    if (from >= m_Rooms.size() || to >= m_Rooms.size() || dir >= kRoomLinkCount)
+    { return false; }
+
+    m_Rooms[from].Links[dir]           = to;
+    m_Rooms[to  ].Links[Opposite(dir)] = from;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      名前から部屋番号を検索します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::FindRoom(const char* name) const
+{
+    auto itr = m_RoomIds.find(name);
+    if (itr == m_RoomIds.end())
+    { return kInvalidRoomId; }
+
+    return itr->second;
+}
+
+//-----------------------------------------------------------------------------
+//      開始する部屋を読み込みます.
+//-----------------------------------------------------------------------------
+bool MapWorld::Start(uint32_t room)
+{
+    if (room >= m_Rooms.size() || m_Budget == 0)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    m_Current = room;
+    UpdateDistance();
+
+    if (m_Rooms[room].State == ROOM_STATE_LOADING)
+    {
+        while(m_Rooms[room].State == ROOM_STATE_LOADING)
+        { Commit(true); }
+    }
+    else if (m_Rooms[room].State != ROOM_STATE_RESIDENT)
+    {
+        if (!LoadSync(room))
+        {
+            ELOGA("Error : Start Room Load Failed. room = %s", m_Rooms[room].Name.c_str());
+            return false;
+        }
+    }
+
+    Prefetch();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      読み込みが完了した部屋を反映し，不足している先読みを要求します.
+//-----------------------------------------------------------------------------
+void MapWorld::Update()
+{
+    if (m_Current == kInvalidRoomId)
+    { return; }
+
+    Commit(false);
+    Prefetch();
+}
+
+//-----------------------------------------------------------------------------
+//      隣の部屋に移動します.
+//-----------------------------------------------------------------------------
+bool MapWorld::Enter(DIRECTION_STATE dir)
+{
+    if (GetNeighbor(dir) == nullptr)
+    { return false; }
+
+    m_Current = m_Rooms[m_Current].Links[dir];
+    UpdateDistance();
+    Prefetch();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      現在の部屋を取得します.
+//-----------------------------------------------------------------------------
+MapInstance* MapWorld::GetCurrent() const
+{
+    if (m_Current == kInvalidRoomId || m_Rooms[m_Current].State != ROOM_STATE_RESIDENT)
+    { return nullptr; }
+
+    return &m_Slots[m_Rooms[m_Current].Slot];
+}
+
+//-----------------------------------------------------------------------------
+//      隣の部屋を取得します.
+//-----------------------------------------------------------------------------
+MapInstance* MapWorld::GetNeighbor(DIRECTION_STATE dir)
+{
+    if (m_Current == kInvalidRoomId || dir >= kRoomLinkCount)
+    { return nullptr; }
+
+    auto id = m_Rooms[m_Current].Links[dir];
+    if (id == kInvalidRoomId)
+    { return nullptr; }
+
+    auto& room = m_Rooms[id];
+    if (room.State == ROOM_STATE_LOADING)
+    {
+        // 先読みが終わるまで待つ.
+        m_SyncLoadCount++;
+        while(room.State == ROOM_STATE_LOADING)
+        { Commit(true); }
+    }
+    else if (room.State == ROOM_STATE_NONE)
+    {
+        // 先読みを要求する前に来てしまった.
+        m_SyncLoadCount++;
+        LoadSync(id);
+    }
+
+    if (room.State != ROOM_STATE_RESIDENT)
+    { return nullptr; }
+
+    return &m_Slots[room.Slot];
+}
+
+//-----------------------------------------------------------------------------
+//      現在の部屋番号を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::GetCurrentRoom() const
+{ return m_Current; }
+
+//-----------------------------------------------------------------------------
+//      隣の部屋番号を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::GetLink(uint32_t room, DIRECTION_STATE dir) const
+{
+    if (room >= m_Rooms.size() || dir >= kRoomLinkCount)
+    { return kInvalidRoomId; }
+
+    return m_Rooms[room].Links[dir];
+}
+
+//-----------------------------------------------------------------------------
+//      部屋数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::GetRoomCount() const
+{ return uint32_t(m_Rooms.size()); }
+
+//-----------------------------------------------------------------------------
+//      部屋が常駐しているかどうか?
+//-----------------------------------------------------------------------------
+bool MapWorld::IsResident(uint32_t room) const
+{ return room < m_Rooms.size() && m_Rooms[room].State == ROOM_STATE_RESIDENT; }
+
+//-----------------------------------------------------------------------------
+//      読み込み中の部屋が無いかどうか?
+//-----------------------------------------------------------------------------
+bool MapWorld::IsIdle() const
+{ return m_LoadingCount == 0; }
+
+//-----------------------------------------------------------------------------
+//      常駐している部屋の数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::GetResidentCount() const
+{
+    auto count = 0u;
+    for(auto& itr : m_SlotRooms)
+    {
+        if (itr != kInvalidRoomId && m_Rooms[itr].State == ROOM_STATE_RESIDENT)
+        { count++; }
+    }
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//      先読みで読み込んだ回数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::GetAsyncLoadCount() const
+{ return m_AsyncLoadCount; }
+
+//-----------------------------------------------------------------------------
+//      同期で読み込んだ回数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::GetSyncLoadCount() const
+{ return m_SyncLoadCount; }
+
+//-----------------------------------------------------------------------------
+//      部屋を追い出した回数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::GetEvictCount() const
+{ return m_EvictCount; }
+
+//-----------------------------------------------------------------------------
+//      全部屋の配置時からの変化を取得します.
+//-----------------------------------------------------------------------------
+void MapWorld::CaptureState(std::vector<RoomState>& result)
+{
+    result.clear();
+
+    for(auto& room : m_Rooms)
+    {
+        // 常駐している部屋は生きているギミックから取り直す.
+        if (room.State == ROOM_STATE_RESIDENT)
+        { m_Slots[room.Slot].CaptureState(room.Delta); }
+
+        if (room.Delta.empty())
+        { continue; }
+
+        RoomState state;
+        state.Name     = room.Name;
+        state.Gimmicks = room.Delta;
+        result.push_back(std::move(state));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      全部屋の配置時からの変化を設定します.
+//-----------------------------------------------------------------------------
+bool MapWorld::RestoreState(const std::vector<RoomState>& states)
+{
+    for(auto& room : m_Rooms)
+    {
+        if (room.State == ROOM_STATE_RESIDENT || room.State == ROOM_STATE_LOADING)
+        {
+            ELOGA("Error : Room Already Loaded. room = %s", room.Name.c_str());
+            return false;
+        }
+    }
+
+    for(auto& room : m_Rooms)
+    { room.Delta.clear(); }
+
+    for(auto& state : states)
+    {
+        // 部屋の構成が変わってもセーブデータを使えるように，名前で引いて無い部屋は読み飛ばす.
+        auto id = FindRoom(state.Name.c_str());
+        if (id == kInvalidRoomId)
+        {
+            WLOGA("Warning : Unknown Room In Save Data. room = %s", state.Name.c_str());
+            continue;
+        }
+
+        auto& delta = m_Rooms[id].Delta;
+        delta = state.Gimmicks;
+
+        // Activate() で配置テーブルと突き合わせるので昇順にしておく.
+        std::sort(delta.begin(), delta.end(),
+            [](const MapGimmickState& lhs, const MapGimmickState& rhs)
+            { return lhs.Index < rhs.Index; });
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      全部屋の配置時からの変化をセーブファイルに書き出します.
+//-----------------------------------------------------------------------------
+bool MapWorld::SaveState(const char* path)
+{
+    std::vector<RoomState> states;
+    CaptureState(states);
+    return WriteSaveFile(path, states);
+}
+
+//-----------------------------------------------------------------------------
+//      セーブファイルから全部屋の配置時からの変化を読み込みます.
+//-----------------------------------------------------------------------------
+bool MapWorld::LoadState(const char* path)
+{
+    std::vector<RoomState> states;
+    if (!ReadSaveFile(path, states))
+    { return false; }
+
+    return RestoreState(states);
+}
+
+//-----------------------------------------------------------------------------
+//      ワーカースレッドの処理です.
+//-----------------------------------------------------------------------------
+void MapWorld::WorkerMain()
+{
+    for(;;)
+    {
+        LoadJob job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Signal.wait(lock, [this]{ return m_Quit || !m_Requests.empty(); });
+            if (m_Quit)
+            { return; }
+
+            job = std::move(m_Requests.front());
+            m_Requests.pop_front();
+        }
+
+        // スロットはジョブが完了するまでメインスレッドから触られない.
+        auto& slot = m_Slots[job.Slot];
+        job.Success = slot.LoadFile(job.Path.c_str());
+
+        // メインスレッドで初めて触れた時にページフォルトしないようにしておく.
+        if (job.Success)
+        {
+            volatile uint8_t sum = 0;
+            auto pData = slot.File.GetData();
+            auto size  = slot.File.GetSize();
+            for(size_t i=0; i<size; i+=kPageSize)
+            { sum += pData[i]; }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Completes.push_back(std::move(job));
+        }
+        m_Signal.notify_all();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ワーカースレッドで読み込みが完了した部屋を反映します.
+//-----------------------------------------------------------------------------
+void MapWorld::Commit(bool wait)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (wait)
+        { m_Signal.wait(lock, [this]{ return !m_Completes.empty(); }); }
+
+        m_Finished.swap(m_Completes);
+    }
+
+    for(auto& job : m_Finished)
+    {
+        auto& room = m_Rooms[job.Room];
+        m_LoadingCount--;
+
+        if (job.Success)
+        {
+            m_Slots[job.Slot].Activate(room.Delta.data(), uint32_t(room.Delta.size()));
+            room.State = ROOM_STATE_RESIDENT;
+            m_AsyncLoadCount++;
+        }
+        else
+        {
+            ELOGA("Error : Room Load Failed. room = %s", room.Name.c_str());
+            m_Slots[job.Slot].Dispose();
+            m_SlotRooms[job.Slot] = kInvalidRoomId;
+            room.Slot  = kInvalidRoomId;
+            room.State = ROOM_STATE_FAILED;
+        }
+    }
+
+    m_Finished.clear();
+}
+
+//-----------------------------------------------------------------------------
+//      隣接する部屋の読み込みを要求します.
+//-----------------------------------------------------------------------------
+void MapWorld::Prefetch()
+{
+    auto requested = false;
+    auto& current  = m_Rooms[m_Current];
+
+    for(auto i=0u; i<kRoomLinkCount; ++i)
+    {
+        auto id = current.Links[i];
+        if (id == kInvalidRoomId || m_Rooms[id].State != ROOM_STATE_NONE)
+        { continue; }
+
+        // 隣接する部屋ばかりで空きが作れない場合は諦める.
+        auto slot = AllocSlot();
+        if (slot == kInvalidRoomId)
+        { break; }
+
+        auto& room = m_Rooms[id];
+        room.Slot  = slot;
+        room.State = ROOM_STATE_LOADING;
+        m_SlotRooms[slot] = id;
+        m_LoadingCount++;
+
+        LoadJob job;
+        job.Room    = id;
+        job.Slot    = slot;
+        job.Path    = room.Path;
+        job.Success = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Requests.push_back(std::move(job));
+        }
+        requested = true;
+    }
+
+    if (requested)
+    { m_Signal.notify_all(); }
+}
+
+//-----------------------------------------------------------------------------
+//      現在の部屋から各部屋までの距離を求めます.
+//-----------------------------------------------------------------------------
+void MapWorld::UpdateDistance()
+{
+    // 探索しなかった部屋は Visit が一致しないので最も遠いとみなされる.
+    m_Visit++;
+
+    m_Search.clear();
+    m_Search.push_back(m_Current);
+    m_Rooms[m_Current].Visit    = m_Visit;
+    m_Rooms[m_Current].Distance = 0;
+
+    for(size_t i=0; i<m_Search.size(); ++i)
+    {
+        auto& room = m_Rooms[m_Search[i]];
+        if (room.Distance >= kSearchDepth)
+        { continue; }
+
+        for(auto j=0u; j<kRoomLinkCount; ++j)
+        {
+            auto id = room.Links[j];
+            if (id == kInvalidRoomId || m_Rooms[id].Visit == m_Visit)
+            { continue; }
+
+            m_Rooms[id].Visit    = m_Visit;
+            m_Rooms[id].Distance = room.Distance + 1;
+            m_Search.push_back(id);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      部屋を同期で読み込みます.
+//-----------------------------------------------------------------------------
+bool MapWorld::LoadSync(uint32_t room)
+{
+    auto slot = AllocSlot();
+
+    // 空きが無ければ読み込み中の部屋が終わるのを待つ. 終われば遠い部屋から追い出せる.
+    while(slot == kInvalidRoomId && m_LoadingCount > 0)
+    {
+        Commit(true);
+        slot = AllocSlot();
+    }
+
+    if (slot == kInvalidRoomId)
+    {
+        ELOGA("Error : Residency Budget Exhausted. room = %s", m_Rooms[room].Name.c_str());
+        return false;
+    }
+
+    auto& instance = m_Slots[slot];
+    if (!instance.LoadFile(m_Rooms[room].Path.c_str()))
+    {
+        m_Rooms[room].State = ROOM_STATE_FAILED;
+        return false;
+    }
+
+    auto& delta = m_Rooms[room].Delta;
+    instance.Activate(delta.data(), uint32_t(delta.size()));
+
+    m_Rooms[room].Slot  = slot;
+    m_Rooms[room].State = ROOM_STATE_RESIDENT;
+    m_SlotRooms[slot]   = room;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      空きスロットを確保します. 空きが無ければ最も遠い部屋を追い出します.
+//-----------------------------------------------------------------------------
+uint32_t MapWorld::AllocSlot()
+{
+    auto victim      = kInvalidRoomId;
+    auto maxDistance = 1u;   // 現在の部屋と隣接する部屋は追い出さない.
+
+    for(auto i=0u; i<m_Budget; ++i)
+    {
+        auto id = m_SlotRooms[i];
+        if (id == kInvalidRoomId)
+        { return i; }
+
+        // 読み込み中のスロットはワーカースレッドが使っている.
+        auto& room = m_Rooms[id];
+        if (room.State != ROOM_STATE_RESIDENT)
+        { continue; }
+
+        auto distance = (room.Visit == m_Visit) ? room.Distance : kFarDistance;
+        if (distance > maxDistance)
+        {
+            maxDistance = distance;
+            victim      = id;
+        }
+    }
+
+    if (victim == kInvalidRoomId)
+    { return kInvalidRoomId; }
+
+    auto slot = m_Rooms[victim].Slot;
+    Evict(victim);
+    return slot;
+}
+
+//-----------------------------------------------------------------------------
+//      部屋を追い出します.
+//-----------------------------------------------------------------------------
+void MapWorld::Evict(uint32_t room)
+{
+    // 部屋の変化はギミックと一緒に消えるので，破棄する前に控えておく.
+    auto slot = m_Rooms[room].Slot;
+    m_Slots[slot].CaptureState(m_Rooms[room].Delta);
+    m_Slots[slot].Dispose();
+
+    m_SlotRooms[slot]   = kInvalidRoomId;
+    m_Rooms[room].Slot  = kInvalidRoomId;
+    m_Rooms[room].State = ROOM_STATE_NONE;
+    m_EvictCount++;
+}
@@ -0,0 +1,149 @@
+﻿//-----------------------------------------------------------------------------
+// File : MappedFile.cpp
+// Desc : Memory Mapped File.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MappedFile.h>
+#include <asdxLogger.h>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+MappedFile::MappedFile()
+: m_pData   (nullptr)
+, m_Size    (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{ Close(); }
+
+//-----------------------------------------------------------------------------
+//      ファイルをマッピングします.
+//-----------------------------------------------------------------------------
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+#if defined(_WIN32)
+    auto hFile = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(hFile, &size) || size.QuadPart == 0)
+    {
+        ELOGA("Error : Invalid File Size. path = %s", path);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    auto hMapping = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    CloseHandle(hFile);
+    if (hMapping == nullptr)
+    {
+        ELOGA("Error : CreateFileMappingA() Failed. path = %s", path);
+        return false;
+    }
+
+    // ビューがマッピングを参照し続けるので，ハンドルはすぐ閉じてよい.
+    auto pData = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(hMapping);
+    if (pData == nullptr)
+    {
+        ELOGA("Error : MapViewOfFile() Failed. path = %s", path);
+        return false;
+    }
+
+    m_pData = static_cast<uint8_t*>(pData);
+    m_Size  = size_t(size.QuadPart);
+#else
+    auto fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    struct stat info = {};
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        ELOGA("Error : Invalid File Size. path = %s", path);
+        close(fd);
+        return false;
+    }
+
+    auto pData = mmap(nullptr, size_t(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (pData == MAP_FAILED)
+    {
+        ELOGA("Error : mmap() Failed. path = %s", path);
+        return false;
+    }
+
+    m_pData = static_cast<uint8_t*>(pData);
+    m_Size  = size_t(info.st_size);
+#endif
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      マッピングを解除します.
+//-----------------------------------------------------------------------------
+void MappedFile::Close()
+{
+    if (m_pData == nullptr)
+    { return; }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(m_pData);
+#else
+    munmap(m_pData, m_Size);
+#endif
+
+    m_pData = nullptr;
+    m_Size  = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      マッピングした領域の先頭を取得します.
+//-----------------------------------------------------------------------------
+uint8_t* MappedFile::GetData() const
+{ return m_pData; }
+
+//-----------------------------------------------------------------------------
+//      マッピングした領域のサイズを取得します.
+//-----------------------------------------------------------------------------
+size_t MappedFile::GetSize() const
+{ return m_Size; }
@@ -0,0 +1,316 @@
+﻿//-----------------------------------------------------------------------------
+// File : PathFinder.cpp
+// Desc : Path Finding over Room Tiles.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <PathFinder.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kDirCount = 4;    // DIRECTION_LEFT ～ DIRECTION_DOWN.
+
+//-----------------------------------------------------------------------------
+//      隣のタイルIDを求めます. 部屋の外なら kInvalidTileId を返却します.
+//-----------------------------------------------------------------------------
+inline uint32_t GetNeighbor(uint32_t id, uint32_t dir)
+{
+    auto x = id % kTileCountX;
+    auto y = id / kTileCountX;
+
+    switch(dir)
+    {
+    case DIRECTION_LEFT:  return (x > 0)               ? id - 1           : kInvalidTileId;
+    case DIRECTION_RIGHT: return (x + 1 < kTileCountX) ? id + 1           : kInvalidTileId;
+    case DIRECTION_UP:    return (y > 0)               ? id - kTileCountX : kInvalidTileId;
+    case DIRECTION_DOWN:  return (y + 1 < kTileCountY) ? id + kTileCountX : kInvalidTileId;
+    default:              return kInvalidTileId;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      逆向きの方向を求めます.
+//-----------------------------------------------------------------------------
+inline uint32_t GetReverse(uint32_t dir)
+{ return dir ^ 1; }     // LEFT <-> RIGHT, UP <-> DOWN.
+
+//-----------------------------------------------------------------------------
+//      タイル間のマンハッタン距離を求めます.
+//-----------------------------------------------------------------------------
+inline uint32_t CalcDistance(uint32_t a, uint32_t b)
+{
+    auto dx = abs(int(a % kTileCountX) - int(b % kTileCountX));
+    auto dy = abs(int(a / kTileCountX) - int(b / kTileCountX));
+    return uint32_t(dx + dy);
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// PathFinder class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+PathFinder::PathFinder()
+: m_Search  (0)
+, m_Goal    (kInvalidTileId)
+, m_Dirty   (false)
+{
+    memset(m_Walk,  0, sizeof(m_Walk));
+    memset(m_Visit, 0, sizeof(m_Visit));
+    m_Open.reserve(kTileTotalCount);
+
+    std::fill(std::begin(m_Dist), std::end(m_Dist), kInvalidPathDist);
+    std::fill(std::begin(m_Flow), std::end(m_Flow), uint8_t(DIRECTION_NONE));
+}
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+PathFinder::~PathFinder()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      タイルの移動可能属性から通行可否を設定します.
+//-----------------------------------------------------------------------------
+void PathFinder::SetLayer(const TileLayer& layer)
+{
+    for(auto row=0u; row<kTileCountY; ++row)
+    { m_Walk[row] = layer.GetRowBits(TILE_FLAG_MOVEABLE, row); }
+
+    m_Dirty = true;
+}
+
+//-----------------------------------------------------------------------------
+//      矩形が掛かるタイルを通行不可にします.
+//-----------------------------------------------------------------------------
+void PathFinder::AddObstacle(const Box& box)
+{
+    if (box.Size.x <= 0 || box.Size.y <= 0)
+    { return; }
+
+    // 右端・下端は矩形に含まれる最後のピクセルで求める.
+    auto i0 = CalcTileIndex(box.Pos.x, box.Pos.y);
+    auto i1 = CalcTileIndex(box.Pos.x + box.Size.x - 1, box.Pos.y + box.Size.y - 1);
+
+    auto mask = ((2u << i1.x) - 1) & ~((1u << i0.x) - 1);
+    for(auto row=i0.y; row<=i1.y; ++row)
+    { m_Walk[row] &= ~mask; }
+
+    m_Dirty = true;
+}
+
+//-----------------------------------------------------------------------------
+//      通行可否と目標を破棄します.
+//-----------------------------------------------------------------------------
+void PathFinder::Reset()
+{
+    memset(m_Walk, 0, sizeof(m_Walk));
+    std::fill(std::begin(m_Dist), std::end(m_Dist), kInvalidPathDist);
+    std::fill(std::begin(m_Flow), std::end(m_Flow), uint8_t(DIRECTION_NONE));
+
+    m_Goal  = kInvalidTileId;
+    m_Dirty = false;
+}
+
+//-----------------------------------------------------------------------------
+//      通行可能かどうか?
+//-----------------------------------------------------------------------------
+bool PathFinder::IsWalkable(uint32_t id) const
+{
+    assert(id < kTileTotalCount);
+    return (m_Walk[id / kTileCountX] & (1u << (id % kTileCountX))) != 0;
+}
+
+//-----------------------------------------------------------------------------
+//      A* で経路を求めます.
+//-----------------------------------------------------------------------------
+bool PathFinder::FindPath(uint32_t start, uint32_t goal, std::vector<uint32_t>& path)
+{
+    path.clear();
+
+    if (start >= kTileTotalCount || goal >= kTileTotalCount)
+    { return false; }
+
+    if (start == goal)
+    { return true; }
+
+    // 訪問済みの印は通し番号で付けて，毎回のクリアを省く.
+    m_Search++;
+    if (m_Search == 0)
+    {
+        memset(m_Visit, 0, sizeof(m_Visit));
+        m_Search = 1;
+    }
+
+    m_Open.clear();
+    m_Visit [start] = m_Search;
+    m_Cost  [start] = 0;
+    m_Parent[start] = uint16_t(start);
+    m_Open.push_back((CalcDistance(start, goal) << 16) | start);
+
+    auto found = false;
+    while(!m_Open.empty())
+    {
+        std::pop_heap(m_Open.begin(), m_Open.end(), std::greater<uint32_t>());
+        auto item = m_Open.back();
+        m_Open.pop_back();
+
+        auto id = item & 0xffff;
+        if (id == goal)
+        {
+            found = true;
+            break;
+        }
+
+        // 後からより短い歩数で積み直した候補があれば，古い方は捨てる.
+        if ((item >> 16) != m_Cost[id] + CalcDistance(id, goal))
+        { continue; }
+
+        auto cost = uint16_t(m_Cost[id] + 1);
+        for(auto dir=0u; dir<kDirCount; ++dir)
+        {
+            auto next = GetNeighbor(id, dir);
+            if (next == kInvalidTileId)
+            { continue; }
+
+            // 目標はプレイヤーが乗っているタイルなので，通行不可でも辿り着けることにする.
+            if (next != goal && !IsWalkable(next))
+            { continue; }
+
+            if (m_Visit[next] == m_Search && m_Cost[next] <= cost)
+            { continue; }
+
+            m_Visit [next] = m_Search;
+            m_Cost  [next] = cost;
+            m_Parent[next] = uint16_t(id);
+
+            m_Open.push_back(((cost + CalcDistance(next, goal)) << 16) | next);
+            std::push_heap(m_Open.begin(), m_Open.end(), std::greater<uint32_t>());
+        }
+    }
+
+    if (!found)
+    { return false; }
+
+    for(auto id=goal; id!=start; id=m_Parent[id])
+    { path.push_back(id); }
+    std::reverse(path.begin(), path.end());
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      フローフィールドの目標を設定します.
+//-----------------------------------------------------------------------------
+void PathFinder::SetGoal(uint32_t id)
+{
+    assert(id < kTileTotalCount || id == kInvalidTileId);
+
+    if (m_Goal == id)
+    { return; }
+
+    m_Goal  = id;
+    m_Dirty = true;
+}
+
+//-----------------------------------------------------------------------------
+//      フローフィールドの目標を取得します.
+//-----------------------------------------------------------------------------
+uint32_t PathFinder::GetGoal() const
+{ return m_Goal; }
+
+//-----------------------------------------------------------------------------
+//      予約されていればフローフィールドを作り直します.
+//-----------------------------------------------------------------------------
+bool PathFinder::Update()
+{
+    if (!m_Dirty)
+    { return false; }
+
+    BuildFlow();
+    m_Dirty = false;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      目標に近づくための移動方向を取得します.
+//-----------------------------------------------------------------------------
+DIRECTION_STATE PathFinder::GetFlowDir(uint32_t id)
+{
+    if (id >= kTileTotalCount)
+    { return DIRECTION_NONE; }
+
+    Update();
+
+    return DIRECTION_STATE(m_Flow[id]);
+}
+
+//-----------------------------------------------------------------------------
+//      目標までの歩数を取得します.
+//-----------------------------------------------------------------------------
+uint16_t PathFinder::GetFlowDist(uint32_t id)
+{
+    if (id >= kTileTotalCount)
+    { return kInvalidPathDist; }
+
+    Update();
+
+    return m_Dist[id];
+}
+
+//-----------------------------------------------------------------------------
+//      目標から幅優先でフローフィールドを構築します.
+//-----------------------------------------------------------------------------
+void PathFinder::BuildFlow()
+{
+    std::fill(std::begin(m_Dist), std::end(m_Dist), kInvalidPathDist);
+    std::fill(std::begin(m_Flow), std::end(m_Flow), uint8_t(DIRECTION_NONE));
+
+    if (m_Goal == kInvalidTileId)
+    { return; }
+
+    // 全タイルが1度ずつしか入らないので，固定長のキューで足りる.
+    uint16_t queue[kTileTotalCount];
+    auto head = 0u;
+    auto tail = 0u;
+
+    m_Dist[m_Goal] = 0;
+    queue[tail++]  = uint16_t(m_Goal);
+
+    while(head < tail)
+    {
+        auto id   = queue[head++];
+        auto dist = uint16_t(m_Dist[id] + 1);
+
+        for(auto dir=0u; dir<kDirCount; ++dir)
+        {
+            auto next = GetNeighbor(id, dir);
+            if (next == kInvalidTileId || m_Dist[next] != kInvalidPathDist)
+            { continue; }
+
+            if (!IsWalkable(next))
+            { continue; }
+
+            // 隣から見ると，今のタイルへ向かう方向が目標への近道.
+            m_Dist[next] = dist;
+            m_Flow[next] = uint8_t(GetReverse(dir));
+            queue[tail++] = uint16_t(next);
+        }
+    }
+}
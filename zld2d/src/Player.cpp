@@ -26,35 +26,10 @@ namespace {
 //-----------------------------------------------------------------------------
 // Constant Values.
 //-----------------------------------------------------------------------------
-static const int    kAnimFrame      = 4;
 static const int    kNonDamageFrame = 180;
 static const int    kAdvancedPixel  = 8;
 static const int    kSize           = 64;
 
-// キャラテクスチャ.
-static const char* kPlayerTextures[] = {
-    "../res/texture/player/PlayerL_0.tga",  // 0
-    "../res/texture/player/PlayerL_1.tga",  // 1
-    "../res/texture/player/PlayerL_A.tga",  // 2
-    "../res/texture/player/PlayerR_0.tga",  // 3
-    "../res/texture/player/PlayerR_1.tga",  // 4
-    "../res/texture/player/PlayerR_A.tga",  // 5
-    "../res/texture/player/PlayerB_0.tga",  // 6
-    "../res/texture/player/PlayerB_1.tga",  // 7
-    "../res/texture/player/PlayerB_A.tga",  // 8
-    "../res/texture/player/PlayerF_0.tga",  // 9
-    "../res/texture/player/PlayerF_1.tga",  // 10
-    "../res/texture/player/PlayerF_A.tga",  // 11
-};
-
-// 武器テクスチャ.
-static const char* kSpearTextures[] = {
-    "../res/texture/player/Spear_L.tga",
-    "../res/texture/player/Spear_R.tga",
-    "../res/texture/player/Spear_B.tga",
-    "../res/texture/player/Spear_F.tga"
-};
-
 // 武器表示オフセット.
 static const Vector2i kOffset[] = {
     { -64,  0 },
@@ -71,50 +46,6 @@ enum PLAYER_STATE
     PLAYER_STATE_SWITCH = 0x1 << 2
 };
 
-//-----------------------------------------------------------------------------
-//      テクスチャ番号取得.
-//-----------------------------------------------------------------------------
-int GetPlayerId(int state, int dir, int frame)
-{
-    int result = dir * 3;
-    if (state == PLAYER_ACTION_NONE)
-    { result += frame; }
-    else if (state == PLAYER_ACTION_ATTACK)
-    { result += 2; }
-
-    return result;
-}
-
-//-----------------------------------------------------------------------------
-//      テクスチャをロードします.
-//-----------------------------------------------------------------------------
-bool LoadTexture(const char* path, asdx::Texture2D& result)
-{
-    std::string texturePath;
-    if (!asdx::SearchFilePathA(path, texturePath))
-    {
-        ELOGA("Error : File Not Found. path = %s", path);
-        return false;
-    }
-
-    asdx::ResTexture res;
-    if (!res.LoadFromFileA(texturePath.c_str()))
-    {
-        ELOGA("Error : ResTexsture::LoadFromFileA() Failed. path = %s", texturePath.c_str());
-        return false;
-    }
-
-    auto pDevice  = asdx::DeviceContext::Instance().GetDevice();
-    auto pContext = asdx::DeviceContext::Instance().GetContext();
-    if (!result.Create(pDevice, pContext, res))
-    {
-        ELOGA("Error : Texture2D::Create() Failed. path = %s", texturePath.c_str());
-        return false;
-    }
-
-    return true;
-}
-
 } // namespace
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -138,18 +69,26 @@ Player::~Player()
 //-----------------------------------------------------------------------------
 //      初期化処理を行います.
 //-----------------------------------------------------------------------------
-bool Player::Init()
+bool Player::Init(SpriteAnimSystem& anim, const SpriteAnimLibrary& library)
 {
-    for(auto i=0; i<12; ++i)
+    m_ClipWalk   = library.Find("player_walk");
+    m_ClipAttack = library.Find("player_attack");
+    m_ClipSpear  = library.Find("player_spear");
+    if (m_ClipWalk   == kInvalidSpriteAnimClip
+     || m_ClipAttack == kInvalidSpriteAnimClip
+     || m_ClipSpear  == kInvalidSpriteAnimClip)
     {
-        if (!LoadTexture(kPlayerTextures[i], m_PlayerTexture[i]))
-        { return false; }
+        ELOGA("Error : Player Animation Clip Not Found.");
+        return false;
     }
 
-    for(auto i=0; i<4; ++i)
+    m_pAnim      = &anim;
+    m_BodyAnim   = anim.Create(m_ClipWalk,  m_Direction);
+    m_WeaponAnim = anim.Create(m_ClipSpear, m_Direction);
+    if (m_BodyAnim == kInvalidSpriteAnimHandle || m_WeaponAnim == kInvalidSpriteAnimHandle)
     {
-        if (!LoadTexture(kSpearTextures[i], m_WeaponTexture[i]))
-        { return false; }
+        ELOGA("Error : SpriteAnimSystem::Create() Failed.");
+        return false;
     }
 
     SetTilePos(3, 5);
@@ -165,13 +104,17 @@ bool Player::Init()
 //-----------------------------------------------------------------------------
 void Player::Term()
 {
-    MessageMgr::Instance().Remove(this);
+    if (m_pAnim != nullptr)
+    {
+        m_pAnim->Destroy(m_BodyAnim);
+        m_pAnim->Destroy(m_WeaponAnim);
+        m_pAnim = nullptr;
+    }
 
-    for(auto i=0; i<12; ++i)
-    { m_PlayerTexture[i].Release(); }
+    m_BodyAnim   = kInvalidSpriteAnimHandle;
+    m_WeaponAnim = kInvalidSpriteAnimHandle;
 
-    for(auto i=0; i<4; ++i)
-    { m_WeaponTexture[i].Release(); }
+    MessageMgr::Instance().Remove(this);
 }
 
 //-----------------------------------------------------------------------------
@@ -213,12 +156,15 @@ void Player::Action(UpdateContext& context)
 {
     // イベント中以外.
     if (context.IsEvent)
-    { return; }
+    {
+        m_pAnim->SetPaused(m_BodyAnim, true);
+        return;
+    }
 
     int x = 0;
     int y = 0;
 
-    auto next = (m_Frame % kAnimFrame) == 0;
+    auto animate = false;
 
     // スロール中でないとき.
     if (!context.Map->IsScroll())
@@ -250,8 +196,8 @@ void Player::Action(UpdateContext& context)
                 y = -1;
             }
 
-            if ((x != 0 || y != 0) && next)
-            { m_AnimFrame = (m_AnimFrame + 1) & 0x1; }
+            // 移動中だけ歩きアニメーションを進める.
+            animate = (x != 0 || y != 0);
         }
 
         if (context.Pad->IsDown(asdx::PAD_A))
@@ -263,6 +209,8 @@ void Player::Action(UpdateContext& context)
             m_HitBox.Pos.y  = m_Box.Pos.y + offset.y;
 
             m_Action = PLAYER_ACTION_ATTACK;
+            m_pAnim->Play(m_BodyAnim,   m_ClipAttack, true);
+            m_pAnim->Play(m_WeaponAnim, m_ClipSpear,  true);
 
             // 攻撃判定を設定.
             context.BoxYellow = &m_HitBox;
@@ -278,17 +226,22 @@ void Player::Action(UpdateContext& context)
     else
     {
         // スクロール中はアニメーション更新する.
-        if (next)
-        {
-            m_AnimFrame = (m_AnimFrame + 1) & 0x1;
+        animate = true;
 
-            // 歩きに強制的に戻す.
-            m_Action = PLAYER_ACTION_NONE;
-        }
+        // 歩きに強制的に戻す.
+        m_Action = PLAYER_ACTION_NONE;
     }
 
     context.PlayerDir = m_Direction;
 
+    // 攻撃が終わったら歩きに戻す. 歩き中は続きから再生する.
+    if (m_Action == PLAYER_ACTION_NONE)
+    { m_pAnim->Play(m_BodyAnim, m_ClipWalk); }
+
+    m_pAnim->SetDirection(m_BodyAnim,   m_Direction);
+    m_pAnim->SetDirection(m_WeaponAnim, m_Direction);
+    m_pAnim->SetPaused   (m_BodyAnim,   !animate && m_Action == PLAYER_ACTION_NONE);
+
     auto box = m_Box;
     box.Pos.x += int(x * kAdvancedPixel);
     box.Pos.y -= int(y * kAdvancedPixel);
@@ -379,23 +332,22 @@ void Player::Draw(SpriteSystem& sprite)
     // キャラ描画
     if (m_NonDamageFrame % 3 == 0)
     {
-        auto id   = GetPlayerId(m_Action, m_Direction, m_AnimFrame);
-        auto pSRV = m_PlayerTexture[id].GetSRV();
-        auto box  = m_Box;
+        auto& tex = m_pAnim->GetRegion(m_BodyAnim);
+        auto  box = m_Box;
         box.Pos.x += int(m_Scroll.x);
         box.Pos.y += int(m_Scroll.y);
 
-        sprite.Draw(pSRV, box, 1);
+        sprite.Draw(tex, box, 1);
     }
 
     // 武器描画.
     if (m_Action == PLAYER_ACTION_ATTACK)
     {
-        auto pSRV = m_WeaponTexture[m_Direction].GetSRV();
-        auto box  = m_HitBox;
+        auto& tex = m_pAnim->GetRegion(m_WeaponAnim);
+        auto  box = m_HitBox;
         box.Pos.x += int(m_Scroll.x);
         box.Pos.y += int(m_Scroll.y);
-        sprite.Draw(pSRV, box, 1);
+        sprite.Draw(tex, box, 1);
     }
 }
 
@@ -503,7 +455,7 @@ void Player::OnScrollComplted()
 
     m_Scroll.x  = 0;
     m_Scroll.y  = 0;
-    m_AnimFrame = 0;
+    m_pAnim->Play(m_BodyAnim, m_ClipWalk, true);
     m_Flags &= ~(PLAYER_STATE_SCROLL);
 }
 
@@ -0,0 +1,229 @@
+﻿//-----------------------------------------------------------------------------
+// File : SaveFormat.cpp
+// Desc : Binary Save File Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <SaveFormat.h>
+#include <MappedFile.h>
+#include <asdxLogger.h>
+#include <cstdio>
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      バッファの末尾に追加します.
+//-----------------------------------------------------------------------------
+inline void Append(std::vector<uint8_t>& buffer, const void* pData, size_t size)
+{
+    auto ptr = static_cast<const uint8_t*>(pData);
+    buffer.insert(buffer.end(), ptr, ptr + size);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      セーブデータをメモリ上に書き出します.
+//-----------------------------------------------------------------------------
+bool WriteSaveData(const std::vector<RoomState>& rooms, std::vector<uint8_t>& result)
+{
+    result.clear();
+
+    auto size = sizeof(SaveFileHeader);
+    for(auto& room : rooms)
+    {
+        if (room.Name.empty() || room.Name.size() > UINT16_MAX || room.Gimmicks.size() > UINT16_MAX)
+        {
+            ELOGA("Error : Invalid Room State. name = %s", room.Name.c_str());
+            return false;
+        }
+
+        size += sizeof(SaveRoomHeader) + room.Name.size() + room.Gimmicks.size() * sizeof(MapGimmickState);
+    }
+
+    if (size > UINT32_MAX)
+    {
+        ELOGA("Error : Save Data Too Large. size = %zu", size);
+        return false;
+    }
+
+    result.reserve(size);
+    result.resize(sizeof(SaveFileHeader));
+
+    for(auto& room : rooms)
+    {
+        SaveRoomHeader roomHeader = {};
+        roomHeader.NameLength = uint16_t(room.Name.size());
+        roomHeader.StateCount = uint16_t(room.Gimmicks.size());
+
+        Append(result, &roomHeader, sizeof(roomHeader));
+        Append(result, room.Name.data(), room.Name.size());
+        if (!room.Gimmicks.empty())
+        { Append(result, room.Gimmicks.data(), room.Gimmicks.size() * sizeof(MapGimmickState)); }
+    }
+
+    SaveFileHeader header = {};
+    header.Magic      = kSaveFileMagic;
+    header.Version    = kSaveFileVersion;
+    header.HeaderSize = uint16_t(sizeof(SaveFileHeader));
+    header.FileSize   = uint32_t(size);
+    header.RoomCount  = uint32_t(rooms.size());
+    header.Checksum   = CalcMapChecksum(result.data() + sizeof(SaveFileHeader), size - sizeof(SaveFileHeader));
+
+    memcpy(result.data(), &header, sizeof(header));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      メモリ上のセーブデータを検証して読み込みます.
+//-----------------------------------------------------------------------------
+bool ReadSaveData(const uint8_t* pData, size_t size, std::vector<RoomState>& result)
+{
+    result.clear();
+
+    if (pData == nullptr || size < sizeof(SaveFileHeader))
+    {
+        ELOGA("Error : Invalid Save Data. size = %zu", size);
+        return false;
+    }
+
+    SaveFileHeader header;
+    memcpy(&header, pData, sizeof(header));
+
+    if (header.Magic != kSaveFileMagic)
+    {
+        ELOGA("Error : Invalid Save Data Magic. magic = 0x%x", header.Magic);
+        return false;
+    }
+
+    if (header.Version != kSaveFileVersion)
+    {
+        ELOGA("Error : Unsupported Save Data Version. version = %u", header.Version);
+        return false;
+    }
+
+    if (header.HeaderSize != sizeof(SaveFileHeader) || header.FileSize != size)
+    {
+        ELOGA("Error : Save Data Layout Mismatch.");
+        return false;
+    }
+
+    auto checksum = CalcMapChecksum(pData + header.HeaderSize, size - header.HeaderSize);
+    if (checksum != header.Checksum)
+    {
+        ELOGA("Error : Save Data Checksum Mismatch. expected = 0x%x, actual = 0x%x", header.Checksum, checksum);
+        return false;
+    }
+
+    // 1部屋は最低でもヘッダと1文字の名前を持つので，それより多い部屋数は壊れている.
+    if (header.RoomCount > (size - header.HeaderSize) / (sizeof(SaveRoomHeader) + 1))
+    {
+        ELOGA("Error : Save Data Room Count Out Of Range. count = %u", header.RoomCount);
+        return false;
+    }
+
+    // 部屋毎にサイズを確かめながら読み進める. 1部屋でも壊れていれば全体を失敗とする.
+    auto offset = size_t(header.HeaderSize);
+    result.resize(header.RoomCount);
+
+    for(auto& room : result)
+    {
+        SaveRoomHeader roomHeader;
+        if (size - offset < sizeof(roomHeader))
+        {
+            ELOGA("Error : Save Data Room Out Of Range.");
+            result.clear();
+            return false;
+        }
+
+        memcpy(&roomHeader, pData + offset, sizeof(roomHeader));
+        offset += sizeof(roomHeader);
+
+        auto stateSize = size_t(roomHeader.StateCount) * sizeof(MapGimmickState);
+        if (roomHeader.NameLength == 0 || size - offset < roomHeader.NameLength + stateSize)
+        {
+            ELOGA("Error : Save Data Room Out Of Range.");
+            result.clear();
+            return false;
+        }
+
+        room.Name.assign(reinterpret_cast<const char*>(pData + offset), roomHeader.NameLength);
+        offset += roomHeader.NameLength;
+
+        room.Gimmicks.resize(roomHeader.StateCount);
+        if (stateSize > 0)
+        { memcpy(room.Gimmicks.data(), pData + offset, stateSize); }
+        offset += stateSize;
+    }
+
+    if (offset != size)
+    {
+        ELOGA("Error : Save Data Size Mismatch. expected = %zu, actual = %zu", offset, size);
+        result.clear();
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      セーブファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteSaveFile(const char* path, const std::vector<RoomState>& rooms)
+{
+    if (path == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    std::vector<uint8_t> buffer;
+    if (!WriteSaveData(rooms, buffer))
+    { return false; }
+
+    FILE* pFile = nullptr;
+    auto err = fopen_s(&pFile, path, "wb");
+    if (err != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    auto written = fwrite(buffer.data(), 1, buffer.size(), pFile);
+    fclose(pFile);
+
+    if (written != buffer.size())
+    {
+        ELOGA("Error : File Write Failed. path = %s", path);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      セーブファイルを読み込みます.
+//-----------------------------------------------------------------------------
+bool ReadSaveFile(const char* path, std::vector<RoomState>& result)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        ELOGA("Error : MappedFile::Open() Failed. path = %s", path);
+        return false;
+    }
+
+    if (!ReadSaveData(file.GetData(), file.GetSize(), result))
+    {
+        ELOGA("Error : ReadSaveData() Failed. path = %s", path);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,680 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteAnimation.cpp
+// Desc : Sprite Sheet Animation.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <SpriteAnimation.h>
+#include <TextureMgr.h>
+#include <asdxLogger.h>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t       kMaxLineLength  = 1024;     // 1行の最大文字数.
+static const uint32_t       kMaxTokens      = 8;        // 1行の最大項目数.
+static const uint32_t       kMaxClipLength  = 0xffff;   // 1周の最大フレーム数.
+static const TextureRegion  kNullRegion;                // 無効なハンドルの場合に返す領域.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AnimImage structure
+///////////////////////////////////////////////////////////////////////////////
+struct AnimImage
+{
+    uint32_t    Path;       // 画像パスの番号.
+    uint32_t    Cell;       // 格子のセル番号.
+    uint32_t    Columns;    // 格子の列数.
+    uint32_t    Rows;       // 格子の行数.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// AnimFrameDef structure
+///////////////////////////////////////////////////////////////////////////////
+struct AnimFrameDef
+{
+    uint32_t    Duration;
+    uint32_t    ImageCount;
+    AnimImage   Images[kSpriteAnimDirCount];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// AnimClipDef structure
+///////////////////////////////////////////////////////////////////////////////
+struct AnimClipDef
+{
+    std::string                 Name;
+    bool                        Loop;
+    std::vector<AnimFrameDef>   Frames;
+};
+
+//-----------------------------------------------------------------------------
+//      行をハードタブで分割します.
+//-----------------------------------------------------------------------------
+uint32_t SplitLine(char* line, char** tokens, uint32_t maxTokens)
+{
+    // 改行を取り除く.
+    auto len = strlen(line);
+    while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+    { line[--len] = '\0'; }
+
+    if (len == 0 || line[0] == '#')
+    { return 0; }
+
+    auto count = 0u;
+    auto head  = line;
+    while(count < maxTokens)
+    {
+        auto tab = strchr(head, '\t');
+        if (tab != nullptr)
+        { *tab = '\0'; }
+
+        // 連続したタブは1つの区切りとみなす.
+        if (head[0] != '\0')
+        { tokens[count++] = head; }
+
+        if (tab == nullptr)
+        { break; }
+
+        head = tab + 1;
+    }
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//      格子のセルの領域を求めます.
+//-----------------------------------------------------------------------------
+TextureRegion GetCellRegion(const TextureRegion& region, const AnimImage& image)
+{
+    if (image.Columns <= 1 && image.Rows <= 1)
+    { return region; }
+
+    auto col = image.Cell % image.Columns;
+    auto row = image.Cell / image.Columns;
+    auto du  = (region.TexRect[2] - region.TexRect[0]) / float(image.Columns);
+    auto dv  = (region.TexRect[3] - region.TexRect[1]) / float(image.Rows);
+    auto u0  = region.TexRect[0] + du * float(col);
+    auto v0  = region.TexRect[1] + dv * float(row);
+
+    return TextureRegion(region.pSRV, u0, v0, u0 + du, v0 + dv);
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteAnimLibrary class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SpriteAnimLibrary::SpriteAnimLibrary()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SpriteAnimLibrary::~SpriteAnimLibrary()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      クリップ定義ファイルを読み込みます.
+//-----------------------------------------------------------------------------
+bool SpriteAnimLibrary::Load(const char* path)
+{
+    FILE* pFile = nullptr;
+
+    auto err = fopen_s(&pFile, path, "r");
+    if (err != 0)
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    std::vector<AnimClipDef>                    clips;
+    std::vector<std::string>                    paths;
+    std::unordered_map<std::string, uint32_t>   pathIds;
+    std::string                                 root;
+
+    uint32_t columns = 1;
+    uint32_t rows    = 1;
+    uint32_t lineNo  = 0;
+    bool     result  = true;
+
+    char  line[kMaxLineLength];
+    char* tokens[kMaxTokens];
+
+    while(fgets(line, kMaxLineLength, pFile) != nullptr)
+    {
+        lineNo++;
+
+        // UTF-8 BOM は読み飛ばす.
+        auto head = line;
+        if (lineNo == 1 && strncmp(head, "\xEF\xBB\xBF", 3) == 0)
+        { head += 3; }
+
+        auto count = SplitLine(head, tokens, kMaxTokens);
+        if (count == 0)
+        { continue; }
+
+        if (strcmp(tokens[0], "root") == 0 && count == 2)
+        {
+            root = tokens[1];
+        }
+        else if (strcmp(tokens[0], "grid") == 0 && count == 3)
+        {
+            columns = std::max(1, atoi(tokens[1]));
+            rows    = std::max(1, atoi(tokens[2]));
+        }
+        else if (strcmp(tokens[0], "clip") == 0 && count == 3)
+        {
+            AnimClipDef def;
+            def.Name = tokens[1];
+            def.Loop = (strcmp(tokens[2], "loop") == 0);
+            clips.push_back(def);
+        }
+        else if (strcmp(tokens[0], "frame") == 0
+              && !clips.empty()
+              && (count == 3 || count == 2 + kSpriteAnimDirCount))
+        {
+            auto& def = clips.back();
+
+            AnimFrameDef frame = {};
+            frame.Duration   = uint32_t(std::max(1, atoi(tokens[1])));
+            frame.ImageCount = count - 2;
+
+            if (!def.Frames.empty() && def.Frames.front().ImageCount != frame.ImageCount)
+            {
+                ELOGA("Error : Direction Count Mismatch. path = %s, line = %u", path, lineNo);
+                result = false;
+                break;
+            }
+
+            for(auto i=0u; i<frame.ImageCount; ++i)
+            {
+                // "パス:セル番号" の場合はセル番号を切り離す.
+                auto name  = tokens[2 + i];
+                auto colon = strrchr(name, ':');
+                auto cell  = 0u;
+                if (colon != nullptr)
+                {
+                    *colon = '\0';
+                    cell   = uint32_t(atoi(colon + 1));
+                }
+
+                if (cell >= columns * rows)
+                {
+                    ELOGA("Error : Invalid Cell Index. path = %s, line = %u", path, lineNo);
+                    result = false;
+                    break;
+                }
+
+                auto fullPath = root + name;
+                auto itr = pathIds.find(fullPath);
+                if (itr == pathIds.end())
+                {
+                    itr = pathIds.emplace(fullPath, uint32_t(paths.size())).first;
+                    paths.push_back(fullPath);
+                }
+
+                frame.Images[i].Path    = itr->second;
+                frame.Images[i].Cell    = cell;
+                frame.Images[i].Columns = columns;
+                frame.Images[i].Rows    = rows;
+            }
+
+            if (!result)
+            { break; }
+
+            def.Frames.push_back(frame);
+        }
+        else
+        {
+            ELOGA("Error : Invalid Line. path = %s, line = %u", path, lineNo);
+            result = false;
+            break;
+        }
+    }
+
+    fclose(pFile);
+
+    if (!result || paths.empty())
+    { return false; }
+
+    // 使う画像はまとめて読み込んで，同じアトラスに入るようにする.
+    std::vector<const char*> pathPtrs;
+    pathPtrs.reserve(paths.size());
+    for(auto& itr : paths)
+    { pathPtrs.push_back(itr.c_str()); }
+
+    uint32_t base = 0;
+    if (!TextureMgr::Instance().Load(uint32_t(pathPtrs.size()), pathPtrs.data(), &base))
+    {
+        ELOGA("Error : TextureMgr::Load() Failed. path = %s", path);
+        return false;
+    }
+
+    auto pSRV = GetTexture(base).pSRV;
+    for(auto i=1u; i<paths.size(); ++i)
+    {
+        if (GetTexture(base + i).pSRV != pSRV)
+        {
+            WLOGA("Warning : Animation Images Span Multiple Textures. path = %s", path);
+            break;
+        }
+    }
+
+    for(auto& def : clips)
+    {
+        auto dirCount = (def.Frames.empty()) ? 1 : def.Frames.front().ImageCount;
+        if (AddClip(def.Name.c_str(), def.Loop, dirCount) == kInvalidSpriteAnimClip)
+        {
+            ELOGA("Error : SpriteAnimLibrary::AddClip() Failed. clip = %s", def.Name.c_str());
+            return false;
+        }
+
+        for(auto& frame : def.Frames)
+        {
+            TextureRegion regions[kSpriteAnimDirCount];
+            for(auto i=0u; i<frame.ImageCount; ++i)
+            {
+                auto& image = frame.Images[i];
+                regions[i] = GetCellRegion(GetTexture(base + image.Path), image);
+            }
+
+            if (!AddFrame(frame.Duration, regions))
+            {
+                ELOGA("Error : SpriteAnimLibrary::AddFrame() Failed. clip = %s", def.Name.c_str());
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      全てのクリップを破棄します.
+//-----------------------------------------------------------------------------
+void SpriteAnimLibrary::Term()
+{
+    m_Clips      .clear();
+    m_Regions    .clear();
+    m_TickToFrame.clear();
+}
+
+//-----------------------------------------------------------------------------
+//      クリップを追加します.
+//-----------------------------------------------------------------------------
+SpriteAnimClipId SpriteAnimLibrary::AddClip(const char* name, bool loop, uint32_t dirCount)
+{
+    if (dirCount != 1 && dirCount != kSpriteAnimDirCount)
+    { return kInvalidSpriteAnimClip; }
+
+    if (m_Clips.size() >= kInvalidSpriteAnimClip)
+    { return kInvalidSpriteAnimClip; }
+
+    SpriteAnimClip clip;
+    clip.Name        = name;
+    clip.FirstRegion = uint32_t(m_Regions.size());
+    clip.FirstTick   = uint32_t(m_TickToFrame.size());
+    clip.FrameCount  = 0;
+    clip.DirCount    = uint8_t(dirCount);
+    clip.Loop        = loop;
+    clip.Length      = 0;
+    m_Clips.push_back(clip);
+
+    return SpriteAnimClipId(m_Clips.size() - 1);
+}
+
+//-----------------------------------------------------------------------------
+//      最後に追加したクリップにコマを追加します.
+//-----------------------------------------------------------------------------
+bool SpriteAnimLibrary::AddFrame(uint32_t duration, const TextureRegion* pRegions)
+{
+    if (m_Clips.empty() || duration == 0 || pRegions == nullptr)
+    { return false; }
+
+    auto& clip = m_Clips.back();
+    if (clip.FrameCount == UINT16_MAX || clip.Length + duration > kMaxClipLength)
+    { return false; }
+
+    for(auto i=0u; i<clip.DirCount; ++i)
+    { m_Regions.push_back(pRegions[i]); }
+
+    // 経過フレームからコマ番号を引けるように，表示フレーム数だけ並べる.
+    m_TickToFrame.insert(m_TickToFrame.end(), duration, clip.FrameCount);
+
+    clip.FrameCount++;
+    clip.Length += duration;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      名前からクリップ番号を検索します.
+//-----------------------------------------------------------------------------
+SpriteAnimClipId SpriteAnimLibrary::Find(const char* name) const
+{
+    for(size_t i=0; i<m_Clips.size(); ++i)
+    {
+        if (m_Clips[i].Name == name)
+        { return SpriteAnimClipId(i); }
+    }
+
+    return kInvalidSpriteAnimClip;
+}
+
+//-----------------------------------------------------------------------------
+//      クリップを取得します.
+//-----------------------------------------------------------------------------
+const SpriteAnimClip& SpriteAnimLibrary::GetClip(SpriteAnimClipId id) const
+{
+    assert(id < m_Clips.size());
+    return m_Clips[id];
+}
+
+//-----------------------------------------------------------------------------
+//      クリップ数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteAnimLibrary::GetClipCount() const
+{ return uint32_t(m_Clips.size()); }
+
+//-----------------------------------------------------------------------------
+//      コマの領域を取得します.
+//-----------------------------------------------------------------------------
+const TextureRegion& SpriteAnimLibrary::GetRegion(SpriteAnimClipId id, uint32_t frame, uint32_t dir) const
+{
+    if (id >= m_Clips.size())
+    { return kNullRegion; }
+
+    auto& clip = m_Clips[id];
+    if (frame >= clip.FrameCount)
+    { return kNullRegion; }
+
+    // 向き違いの無いクリップは全ての向きで同じコマを使う.
+    if (dir >= clip.DirCount)
+    { dir = 0; }
+
+    return m_Regions[clip.FirstRegion + frame * clip.DirCount + dir];
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteAnimSystem class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SpriteAnimSystem::SpriteAnimSystem()
+: m_pLibrary(nullptr)
+, m_Capacity(0)
+, m_Count   (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SpriteAnimSystem::~SpriteAnimSystem()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool SpriteAnimSystem::Init(const SpriteAnimLibrary* pLibrary, uint32_t capacity)
+{
+    if (pLibrary == nullptr || capacity == 0)
+    { return false; }
+
+    m_pLibrary = pLibrary;
+    m_Capacity = capacity;
+    m_Count    = 0;
+
+    m_Clip   .resize(capacity);
+    m_Dir    .resize(capacity);
+    m_Paused .resize(capacity);
+    m_Time   .resize(capacity);
+    m_Frame  .resize(capacity);
+    m_Handles.resize(capacity);
+
+    m_Slots      .clear();
+    m_FreeHandles.clear();
+    m_Slots      .reserve(capacity);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void SpriteAnimSystem::Term()
+{
+    m_Clip       .clear();
+    m_Dir        .clear();
+    m_Paused     .clear();
+    m_Time       .clear();
+    m_Frame      .clear();
+    m_Handles    .clear();
+    m_Slots      .clear();
+    m_FreeHandles.clear();
+
+    m_pLibrary = nullptr;
+    m_Capacity = 0;
+    m_Count    = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      再生状態を生成します.
+//-----------------------------------------------------------------------------
+SpriteAnimHandle SpriteAnimSystem::Create(SpriteAnimClipId clip, uint8_t dir)
+{
+    if (m_Count >= m_Capacity || clip >= m_pLibrary->GetClipCount())
+    { return kInvalidSpriteAnimHandle; }
+
+    SpriteAnimHandle handle;
+    if (!m_FreeHandles.empty())
+    {
+        handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+    }
+    else
+    {
+        handle = SpriteAnimHandle(m_Slots.size());
+        m_Slots.push_back(UINT32_MAX);
+    }
+
+    auto index = m_Count++;
+    m_Slots  [handle] = index;
+    m_Handles[index]  = handle;
+    m_Clip   [index]  = clip;
+    m_Dir    [index]  = dir;
+    m_Paused [index]  = 0;
+    m_Time   [index]  = 0;
+    Evaluate(index);
+
+    return handle;
+}
+
+//-----------------------------------------------------------------------------
+//      再生状態を破棄します.
+//-----------------------------------------------------------------------------
+void SpriteAnimSystem::Destroy(SpriteAnimHandle handle)
+{
+    auto index = Find(handle);
+    if (index == UINT32_MAX)
+    { return; }
+
+    // 末尾の再生状態を空いた位置に移して詰めたままにする.
+    auto last = m_Count - 1;
+    if (index != last)
+    {
+        m_Clip   [index] = m_Clip   [last];
+        m_Dir    [index] = m_Dir    [last];
+        m_Paused [index] = m_Paused [last];
+        m_Time   [index] = m_Time   [last];
+        m_Frame  [index] = m_Frame  [last];
+        m_Handles[index] = m_Handles[last];
+        m_Slots[m_Handles[index]] = index;
+    }
+
+    m_Slots[handle] = UINT32_MAX;
+    m_FreeHandles.push_back(handle);
+    m_Count--;
+}
+
+//-----------------------------------------------------------------------------
+//      クリップを再生します.
+//-----------------------------------------------------------------------------
+void SpriteAnimSystem::Play(SpriteAnimHandle handle, SpriteAnimClipId clip, bool restart)
+{
+    auto index = Find(handle);
+    if (index == UINT32_MAX || clip >= m_pLibrary->GetClipCount())
+    { return; }
+
+    if (m_Clip[index] == clip && !restart)
+    { return; }
+
+    m_Clip[index] = clip;
+    m_Time[index] = 0;
+    Evaluate(index);
+}
+
+//-----------------------------------------------------------------------------
+//      向きを設定します.
+//-----------------------------------------------------------------------------
+void SpriteAnimSystem::SetDirection(SpriteAnimHandle handle, uint8_t dir)
+{
+    auto index = Find(handle);
+    if (index == UINT32_MAX)
+    { return; }
+
+    m_Dir[index] = dir;
+}
+
+//-----------------------------------------------------------------------------
+//      一時停止するかどうかを設定します.
+//-----------------------------------------------------------------------------
+void SpriteAnimSystem::SetPaused(SpriteAnimHandle handle, bool paused)
+{
+    auto index = Find(handle);
+    if (index == UINT32_MAX)
+    { return; }
+
+    m_Paused[index] = (paused) ? 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+//      ループしないクリップが最後まで再生されたかどうか?
+//-----------------------------------------------------------------------------
+bool SpriteAnimSystem::IsFinished(SpriteAnimHandle handle) const
+{
+    auto index = Find(handle);
+    if (index == UINT32_MAX)
+    { return true; }
+
+    auto& clip = m_pLibrary->m_Clips[m_Clip[index]];
+    return !clip.Loop && m_Time[index] + 1 >= clip.Length;
+}
+
+//-----------------------------------------------------------------------------
+//      全キャラのアニメーションを進めます.
+//-----------------------------------------------------------------------------
+void SpriteAnimSystem::Update(uint32_t ticks)
+{
+    if (ticks == 0)
+    { return; }
+
+    auto pClips = m_pLibrary->m_Clips.data();
+    auto pTable = m_pLibrary->m_TickToFrame.data();
+
+    for(auto i=0u; i<m_Count; ++i)
+    {
+        auto& clip = pClips[m_Clip[i]];
+        if (clip.Length == 0)
+        { continue; }
+
+        // 一時停止中は進めない.
+        auto time = m_Time[i] + ((m_Paused[i] != 0) ? 0 : ticks);
+        if (time >= clip.Length)
+        {
+            // 1周を超えた時だけ割り算する.
+            if (clip.Loop)
+            { time %= clip.Length; }
+            else
+            { time = clip.Length - 1; }
+        }
+
+        m_Time [i] = time;
+        m_Frame[i] = pTable[clip.FirstTick + time];
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      現在のコマ番号を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteAnimSystem::GetFrame(SpriteAnimHandle handle) const
+{
+    auto index = Find(handle);
+    if (index == UINT32_MAX)
+    { return 0; }
+
+    return m_Frame[index];
+}
+
+//-----------------------------------------------------------------------------
+//      現在のコマの領域を取得します.
+//-----------------------------------------------------------------------------
+const TextureRegion& SpriteAnimSystem::GetRegion(SpriteAnimHandle handle) const
+{
+    auto index = Find(handle);
+    if (index == UINT32_MAX)
+    { return kNullRegion; }
+
+    return m_pLibrary->GetRegion(m_Clip[index], m_Frame[index], m_Dir[index]);
+}
+
+//-----------------------------------------------------------------------------
+//      生成済みの再生状態の数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteAnimSystem::GetCount() const
+{ return m_Count; }
+
+//-----------------------------------------------------------------------------
+//      ハンドルから詰めた位置を検索します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteAnimSystem::Find(SpriteAnimHandle handle) const
+{
+    if (handle >= m_Slots.size())
+    { return UINT32_MAX; }
+
+    return m_Slots[handle];
+}
+
+//-----------------------------------------------------------------------------
+//      現在の経過フレームからコマ番号を求めます.
+//-----------------------------------------------------------------------------
+void SpriteAnimSystem::Evaluate(uint32_t index)
+{
+    auto& clip = m_pLibrary->m_Clips[m_Clip[index]];
+    if (clip.Length == 0)
+    {
+        m_Frame[index] = 0;
+        return;
+    }
+
+    auto time = std::min(m_Time[index], clip.Length - 1);
+    m_Frame[index] = m_pLibrary->m_TickToFrame[clip.FirstTick + time];
+}
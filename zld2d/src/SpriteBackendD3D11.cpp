@@ -0,0 +1,286 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteBackendD3D11.cpp
+// Desc : Direct3D 11 Sprite Render Backend.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <SpriteBackendD3D11.h>
+#include <asdxLogger.h>
+#include <asdxRenderState.h>
+
+
+namespace {
+
+#include "../res/shader/Compiled/SpriteInstVS.inc"
+#include "../res/shader/Compiled/SpritePS.inc"
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kVertexPerSprite = 4;     // 頂点シェーダで展開する頂点数.
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteBackendD3D11 class
+///////////////////////////////////////////////////////////////////////////////
+
+// 入力要素です. 1スプライト1インスタンスで，頂点シェーダで4頂点に展開します.
+const D3D11_INPUT_ELEMENT_DESC SpriteBackendD3D11::InputElements[ SpriteBackendD3D11::InputElementCount ] = {
+    { "RECT",     0, DXGI_FORMAT_R16G16B16A16_SINT,  0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "TEXRECT",  0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "VTXCOLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM,     0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+    { "LAYER",    0, DXGI_FORMAT_R16G16_UINT,        0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+};
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SpriteBackendD3D11::SpriteBackendD3D11()
+: m_pContext(nullptr)
+, m_pBoundVB(nullptr)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SpriteBackendD3D11::~SpriteBackendD3D11()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      初期化処理です.
+//-----------------------------------------------------------------------------
+bool SpriteBackendD3D11::Init(ID3D11Device* pDevice, ID3D11DeviceContext* pContext)
+{
+    if (pDevice == nullptr || pContext == nullptr)
+    {
+        ELOG("Error : Invalid Argument.");
+        return false;
+    }
+
+    HRESULT hr = S_OK;
+
+    // インスタンスバッファの生成.
+    {
+        D3D11_BUFFER_DESC desc;
+        ZeroMemory(&desc, sizeof(desc));
+        desc.BindFlags      = D3D11_BIND_VERTEX_BUFFER;
+        desc.Usage          = D3D11_USAGE_DYNAMIC;
+        desc.ByteWidth      = sizeof(SpriteInstance) * kSpritePageSize;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+        hr = pDevice->CreateBuffer(&desc, nullptr, m_pVB.GetAddress());
+        if (FAILED(hr))
+        {
+            ELOG("Error : ID3D11Device::CreateBuffer() Failed.");
+            return false;
+        }
+    }
+
+    // 常駐インスタンスバッファの生成. 変更のあった範囲だけを UpdateSubresource() で更新します.
+    {
+        D3D11_BUFFER_DESC desc;
+        ZeroMemory(&desc, sizeof(desc));
+        desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        desc.Usage     = D3D11_USAGE_DEFAULT;
+        desc.ByteWidth = sizeof(SpriteInstance) * kSpriteRetainedCapacity;
+
+        hr = pDevice->CreateBuffer(&desc, nullptr, m_pRetainedVB.GetAddress());
+        if (FAILED(hr))
+        {
+            ELOG("Error : ID3D11Device::CreateBuffer() Failed.");
+            return false;
+        }
+    }
+
+    // 頂点シェーダと入力レイアウトの生成.
+    {
+        hr = pDevice->CreateVertexShader(SpriteInstVS, sizeof(SpriteInstVS), nullptr, m_pVS.GetAddress());
+        if (FAILED(hr))
+        {
+            ELOG("Error : ID3D11Device::CreateVertexShader() Failed.");
+            return false;
+        }
+
+        hr = pDevice->CreateInputLayout(InputElements, InputElementCount, SpriteInstVS, sizeof(SpriteInstVS), m_pIL.GetAddress());
+        if (FAILED(hr))
+        {
+            ELOG("Error : ID3D11Device::CreateInputLayout() Failed.");
+            return false;
+        }
+    }
+
+    // ピクセルシェーダの生成.
+    {
+        hr = pDevice->CreatePixelShader(SpritePS, sizeof(SpritePS), nullptr, m_pPS.GetAddress());
+        if (FAILED(hr))
+        {
+            ELOG("Error : ID3D11Device::CreatePixelShader() Failed.");
+            return false;
+        }
+    }
+
+    // 定数バッファの生成.
+    {
+        D3D11_BUFFER_DESC desc;
+        ZeroMemory(&desc, sizeof(desc));
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        desc.ByteWidth = sizeof(asdx::Matrix);
+        desc.Usage     = D3D11_USAGE_DEFAULT;
+
+        hr = pDevice->CreateBuffer(&desc, nullptr, m_pCB.GetAddress());
+        if (FAILED(hr))
+        {
+            ELOG("Error : ID3D11Device::CreateBuffer() Failed.");
+            return false;
+        }
+    }
+
+    m_pContext = pContext;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理です.
+//-----------------------------------------------------------------------------
+void SpriteBackendD3D11::Term()
+{
+    m_pVS.Reset();
+    m_pPS.Reset();
+    m_pVB.Reset();
+    m_pRetainedVB.Reset();
+    m_pCB.Reset();
+    m_pIL.Reset();
+    m_pContext = nullptr;
+    m_pBoundVB = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      描画を開始します.
+//-----------------------------------------------------------------------------
+void SpriteBackendD3D11::Begin(const asdx::Matrix& transform)
+{
+    // 4頂点のストリップで矩形を描きます.
+    m_pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    m_pContext->IASetInputLayout(m_pIL.GetPtr());
+
+    m_pContext->VSSetShader(m_pVS.GetPtr(), nullptr, 0);
+    m_pContext->PSSetShader(m_pPS.GetPtr(), nullptr, 0);
+    m_pContext->GSSetShader(nullptr, nullptr, 0);
+    m_pContext->HSSetShader(nullptr, nullptr, 0);
+    m_pContext->DSSetShader(nullptr, nullptr, 0);
+
+    // インスタンスバッファを設定します. インデックスバッファは使いません.
+    m_pBoundVB = nullptr;
+    BindVB(m_pVB.GetPtr());
+    m_pContext->IASetIndexBuffer(nullptr, DXGI_FORMAT_R16_UINT, 0);
+
+    m_pContext->UpdateSubresource(m_pCB.GetPtr(), 0, nullptr, &transform, 0, 0);
+    m_pContext->VSSetConstantBuffers(0, 1, m_pCB.GetAddress());
+
+    auto pSmp = asdx::RenderState::GetInstance().GetSmp(asdx::SamplerType::LinearClamp);
+    m_pContext->PSSetSamplers(0, 1, &pSmp);
+}
+
+//-----------------------------------------------------------------------------
+//      インスタンスバッファをマップします.
+//-----------------------------------------------------------------------------
+SpriteInstance* SpriteBackendD3D11::MapPage(uint32_t count)
+{
+    if (count > kSpritePageSize)
+    { return nullptr; }
+
+    D3D11_MAPPED_SUBRESOURCE mappedBuffer;
+    auto hr = m_pContext->Map(m_pVB.GetPtr(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer);
+    if (FAILED(hr))
+    { return nullptr; }
+
+    return reinterpret_cast<SpriteInstance*>(mappedBuffer.pData);
+}
+
+//-----------------------------------------------------------------------------
+//      インスタンスバッファをアンマップします.
+//-----------------------------------------------------------------------------
+void SpriteBackendD3D11::UnmapPage()
+{ m_pContext->Unmap(m_pVB.GetPtr(), 0); }
+
+//-----------------------------------------------------------------------------
+//      テクスチャを設定します.
+//-----------------------------------------------------------------------------
+void SpriteBackendD3D11::SetTexture(ID3D11ShaderResourceView* pSRV)
+{ m_pContext->PSSetShaderResources(0, 1, &pSRV); }
+
+//-----------------------------------------------------------------------------
+//      インスタンス描画を発行します.
+//-----------------------------------------------------------------------------
+void SpriteBackendD3D11::Draw(uint32_t start, uint32_t count)
+{
+    BindVB(m_pVB.GetPtr());
+    m_pContext->DrawInstanced(kVertexPerSprite, count, 0, start);
+}
+
+//-----------------------------------------------------------------------------
+//      常駐インスタンスバッファの一部を更新します.
+//-----------------------------------------------------------------------------
+bool SpriteBackendD3D11::UpdateRetained(uint32_t offset, const SpriteInstance* pInstances, uint32_t count)
+{
+    if (pInstances == nullptr || count == 0 || offset + count > kSpriteRetainedCapacity)
+    { return false; }
+
+    // 変更のあった範囲だけを転送します.
+    D3D11_BOX box;
+    box.left   = offset * sizeof(SpriteInstance);
+    box.right  = (offset + count) * sizeof(SpriteInstance);
+    box.top    = 0;
+    box.bottom = 1;
+    box.front  = 0;
+    box.back   = 1;
+
+    m_pContext->UpdateSubresource(m_pRetainedVB.GetPtr(), 0, &box, pInstances, 0, 0);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      常駐インスタンスバッファからインスタンス描画を発行します.
+//-----------------------------------------------------------------------------
+void SpriteBackendD3D11::DrawRetained(uint32_t start, uint32_t count)
+{
+    BindVB(m_pRetainedVB.GetPtr());
+    m_pContext->DrawInstanced(kVertexPerSprite, count, 0, start);
+}
+
+//-----------------------------------------------------------------------------
+//      描画を終了します.
+//-----------------------------------------------------------------------------
+void SpriteBackendD3D11::End()
+{
+    // シェーダをアンバインド.
+    m_pContext->VSSetShader(nullptr, nullptr, 0);
+    m_pContext->PSSetShader(nullptr, nullptr, 0);
+    m_pContext->GSSetShader(nullptr, nullptr, 0);
+    m_pContext->HSSetShader(nullptr, nullptr, 0);
+    m_pContext->DSSetShader(nullptr, nullptr, 0);
+
+    ID3D11ShaderResourceView* pNullSRV[ 1 ] = { nullptr };
+    ID3D11SamplerState*       pNullSmp[ 1 ] = { nullptr };
+    m_pContext->PSSetShaderResources(0, 1, pNullSRV);
+    m_pContext->PSSetSamplers(0, 1, pNullSmp);
+}
+
+//-----------------------------------------------------------------------------
+//      インスタンスバッファを設定します.
+//-----------------------------------------------------------------------------
+void SpriteBackendD3D11::BindVB(ID3D11Buffer* pVB)
+{
+    if (m_pBoundVB == pVB)
+    { return; }
+
+    uint32_t stride = sizeof(SpriteInstance);
+    uint32_t offset = 0;
+    m_pContext->IASetVertexBuffers(0, 1, &pVB, &stride, &offset);
+    m_pBoundVB = pVB;
+}
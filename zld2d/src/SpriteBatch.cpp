@@ -0,0 +1,251 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteBatch.cpp
+// Desc : Sprite Draw Command Builder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cassert>
+#include <algorithm>
+#include <SpriteBatch.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kRadixBits   = 8;                         // 1パスで処理するビット数.
+static const uint32_t kRadixSize   = 1 << kRadixBits;           // バケット数.
+static const uint32_t kRadixMask   = kRadixSize - 1;
+static const uint32_t kRadixPasses = 32 / kRadixBits;           // 32bitキーのパス数.
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteBatch class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SpriteBatch::SpriteBatch()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SpriteBatch::~SpriteBatch()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      メモリを予約します.
+//-----------------------------------------------------------------------------
+void SpriteBatch::Reserve(uint32_t count)
+{
+    m_Keys     .reserve(count);
+    m_TempKeys .reserve(count);
+    m_Order    .reserve(count);
+    m_TempOrder.reserve(count);
+    m_Commands .reserve(count);
+}
+
+//-----------------------------------------------------------------------------
+//      記録したスプライトとコマンドを破棄します.
+//-----------------------------------------------------------------------------
+void SpriteBatch::Clear()
+{
+    m_Keys     .clear();
+    m_TempKeys .clear();
+    m_Order    .clear();
+    m_TempOrder.clear();
+    m_Commands .clear();
+    m_Count     = 0;
+    m_PageCount = 0;
+    m_Sorted    = false;
+}
+
+//-----------------------------------------------------------------------------
+//      描画コマンドを構築します.
+//-----------------------------------------------------------------------------
+void SpriteBatch::Build
+(
+    const SpriteInstance*   pInstances,
+    const void* const*      ppTextures,
+    uint32_t                count,
+    bool                    groupByTexture,
+    uint32_t                pageSize
+)
+{
+    assert(pageSize > 0);
+
+    m_Commands.clear();
+    m_Order   .clear();
+    m_Sorted    = false;
+    m_Count     = count;
+    m_PageCount = 0;
+
+    if (count == 0)
+    { return; }
+
+    m_PageCount = (count + pageSize - 1) / pageSize;
+
+    // 32bitキー = 奥から手前(レイヤー降順) | テクスチャ番号.
+    // テクスチャ番号は記録順に初出で割り振るので，アドレスに依存せず毎回同じ結果になる.
+    // 同じキーの中では記録順を保つので，同じレイヤーの重なりは記録順のまま描画される.
+    m_Keys.resize(count);
+    if (groupByTexture)
+    {
+        m_TextureIds.clear();
+
+        const void* pPrevTex = nullptr;
+        uint32_t    prevId   = 0;
+        for(auto i=0u; i<count; ++i)
+        {
+            auto pTex = ppTextures[i];
+            if (i == 0 || pTex != pPrevTex)
+            {
+                auto result = m_TextureIds.emplace(pTex, uint32_t(m_TextureIds.size()));
+                pPrevTex = pTex;
+                prevId   = std::min<uint32_t>(result.first->second, 0xffff);
+            }
+
+            m_Keys[i] = (uint32_t(0xffff - pInstances[i].Layer) << 16) | prevId;
+        }
+    }
+    else
+    {
+        for(auto i=0u; i<count; ++i)
+        { m_Keys[i] = uint32_t(0xffff - pInstances[i].Layer) << 16; }
+    }
+
+    m_Sorted = RadixSort(count);
+
+    // 同じテクスチャ・同じレイヤーが連続する区間を1つの描画コマンドにまとめる.
+    // ページをまたぐ区間は頂点バッファを差し替えるので分割する.
+    for(auto i=0u; i<count; ++i)
+    {
+        auto  idx   = (m_Sorted) ? m_Order[i] : i;
+        auto  pTex  = ppTextures[idx];
+        auto  layer = pInstances[idx].Layer;
+        auto  page  = i / pageSize;
+
+        if (!m_Commands.empty()
+          && m_Commands.back().pTexture == pTex
+          && m_Commands.back().Page     == page
+          && m_Commands.back().Layer    == layer)
+        {
+            m_Commands.back().Count++;
+            continue;
+        }
+
+        SpriteDrawCommand cmd;
+        cmd.pTexture = pTex;
+        cmd.Page     = page;
+        cmd.Start    = i - page * pageSize;
+        cmd.Count    = 1;
+        cmd.Layer    = layer;
+        m_Commands.push_back(cmd);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      構築に使ったスプライト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteBatch::GetSpriteCount() const
+{ return m_Count; }
+
+//-----------------------------------------------------------------------------
+//      描画順に並べたスプライト番号を取得します.
+//-----------------------------------------------------------------------------
+const std::vector<uint32_t>& SpriteBatch::GetOrder() const
+{ return m_Order; }
+
+//-----------------------------------------------------------------------------
+//      描画コマンドを取得します.
+//-----------------------------------------------------------------------------
+const std::vector<SpriteDrawCommand>& SpriteBatch::GetCommands() const
+{ return m_Commands; }
+
+//-----------------------------------------------------------------------------
+//      ページ数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteBatch::GetPageCount() const
+{ return m_PageCount; }
+
+//-----------------------------------------------------------------------------
+//      記録順から並べ替えたかどうか?
+//-----------------------------------------------------------------------------
+bool SpriteBatch::IsSorted() const
+{ return m_Sorted; }
+
+//-----------------------------------------------------------------------------
+//      m_Keys を基数ソートし，並び順を m_Order に格納します.
+//-----------------------------------------------------------------------------
+bool SpriteBatch::RadixSort(uint32_t count)
+{
+    // 既に並んでいれば記録順のまま描画できる(レイヤーが1つしか無い場合など).
+    auto sorted = true;
+    for(auto i=1u; i<count; ++i)
+    {
+        if (m_Keys[i - 1] > m_Keys[i])
+        {
+            sorted = false;
+            break;
+        }
+    }
+
+    if (sorted)
+    { return false; }
+
+    // 全パス分のヒストグラムを1回の走査で求める.
+    uint32_t histogram[kRadixPasses][kRadixSize] = {};
+    for(auto i=0u; i<count; ++i)
+    {
+        auto key = m_Keys[i];
+        for(auto pass=0u; pass<kRadixPasses; ++pass)
+        { histogram[pass][(key >> (pass * kRadixBits)) & kRadixMask]++; }
+    }
+
+    m_TempKeys .resize(count);
+    m_TempOrder.resize(count);
+    m_Order    .resize(count);
+    for(auto i=0u; i<count; ++i)
+    { m_Order[i] = i; }
+
+    // 下位の桁から安定な分配を繰り返す(LSD基数ソート).
+    for(auto pass=0u; pass<kRadixPasses; ++pass)
+    {
+        auto  shift  = pass * kRadixBits;
+        auto& bucket = histogram[pass];
+
+        // 全てのキーでこの桁が同じなら並びは変わらない.
+        if (bucket[(m_Keys[0] >> shift) & kRadixMask] == count)
+        { continue; }
+
+        // 累積和を各バケットの書き込み位置にする.
+        auto offset = 0u;
+        for(auto b=0u; b<kRadixSize; ++b)
+        {
+            auto n = bucket[b];
+            bucket[b] = offset;
+            offset += n;
+        }
+
+        for(auto i=0u; i<count; ++i)
+        {
+            auto key = m_Keys[i];
+            auto dst = bucket[(key >> shift) & kRadixMask]++;
+            m_TempKeys [dst] = key;
+            m_TempOrder[dst] = m_Order[i];
+        }
+
+        m_Keys .swap(m_TempKeys);
+        m_Order.swap(m_TempOrder);
+    }
+
+    return true;
+}
@@ -0,0 +1,414 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteCaptureBackend.cpp
+// Desc : Recording Sprite Render Backend.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <SpriteCaptureBackend.h>
+#include <asdxLogger.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char*    kCaptureHeader = "# sprite capture v1";   // ファイルの先頭行.
+static const uint32_t kNullTextureId = UINT32_MAX;              // nullptr を設定した場合のテクスチャ番号.
+
+//-----------------------------------------------------------------------------
+//      FNV-1a でハッシュ値を計算します.
+//-----------------------------------------------------------------------------
+uint64_t CalcHash(const void* pData, size_t size)
+{
+    auto ptr  = static_cast<const uint8_t*>(pData);
+    auto hash = uint64_t(14695981039346656037ull);
+    for(size_t i=0; i<size; ++i)
+    {
+        hash ^= ptr[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteFrameCapture structure
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      記録を破棄します.
+//-----------------------------------------------------------------------------
+void SpriteFrameCapture::Clear()
+{
+    Commands.clear();
+    FrameCount  = 0;
+    DrawCount   = 0;
+    BindCount   = 0;
+    UploadCount = 0;
+    UploadBytes = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      コマンドを追加し，集計を更新します.
+//-----------------------------------------------------------------------------
+void SpriteFrameCapture::Push(uint32_t op, uint32_t arg0, uint32_t arg1, uint64_t hash)
+{
+    SpriteCaptureCommand cmd;
+    cmd.Op   = op;
+    cmd.Arg0 = arg0;
+    cmd.Arg1 = arg1;
+    cmd.Hash = hash;
+    Commands.push_back(cmd);
+
+    switch(op)
+    {
+    case SPRITE_CAPTURE_BEGIN:   FrameCount++; break;
+    case SPRITE_CAPTURE_UPLOAD:  UploadCount++; UploadBytes += arg1; break;
+    case SPRITE_CAPTURE_TEXTURE: BindCount++; break;
+    case SPRITE_CAPTURE_DRAW:    DrawCount++; break;
+    case SPRITE_CAPTURE_RETAINED_UPLOAD: UploadCount++; UploadBytes += uint64_t(arg1) * sizeof(SpriteInstance); break;
+    case SPRITE_CAPTURE_RETAINED_DRAW:   DrawCount++; break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      テキスト形式に変換します.
+//-----------------------------------------------------------------------------
+std::string SpriteFrameCapture::Serialize() const
+{
+    std::string result;
+    result.reserve(Commands.size() * 32 + 128);
+
+    char line[128];
+    result += kCaptureHeader;
+    result += "\n";
+
+    snprintf(line, sizeof(line), "# frames %u draws %u binds %u uploads %u bytes %" PRIu64 "\n",
+        FrameCount, DrawCount, BindCount, UploadCount, UploadBytes);
+    result += line;
+
+    for(auto& cmd : Commands)
+    {
+        switch(cmd.Op)
+        {
+        case SPRITE_CAPTURE_BEGIN:
+            snprintf(line, sizeof(line), "begin %016" PRIx64 "\n", cmd.Hash);
+            break;
+
+        case SPRITE_CAPTURE_UPLOAD:
+            snprintf(line, sizeof(line), "upload %u %u %016" PRIx64 "\n", cmd.Arg0, cmd.Arg1, cmd.Hash);
+            break;
+
+        case SPRITE_CAPTURE_TEXTURE:
+            if (cmd.Arg0 == kNullTextureId)
+            { snprintf(line, sizeof(line), "texture -\n"); }
+            else
+            { snprintf(line, sizeof(line), "texture %u\n", cmd.Arg0); }
+            break;
+
+        case SPRITE_CAPTURE_DRAW:
+            snprintf(line, sizeof(line), "draw %u %u\n", cmd.Arg0, cmd.Arg1);
+            break;
+
+        case SPRITE_CAPTURE_END:
+            snprintf(line, sizeof(line), "end\n");
+            break;
+
+        case SPRITE_CAPTURE_RETAINED_UPLOAD:
+            snprintf(line, sizeof(line), "rupload %u %u %016" PRIx64 "\n", cmd.Arg0, cmd.Arg1, cmd.Hash);
+            break;
+
+        case SPRITE_CAPTURE_RETAINED_DRAW:
+            snprintf(line, sizeof(line), "rdraw %u %u\n", cmd.Arg0, cmd.Arg1);
+            break;
+
+        default:
+            continue;
+        }
+
+        result += line;
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      テキスト形式から復元します.
+//-----------------------------------------------------------------------------
+bool SpriteFrameCapture::Deserialize(const std::string& text)
+{
+    Clear();
+
+    std::istringstream stream(text);
+    std::string line;
+    auto lineNo = 0;
+
+    while(std::getline(stream, line))
+    {
+        lineNo++;
+
+        if (!line.empty() && line.back() == '\r')
+        { line.pop_back(); }
+
+        if (line.empty())
+        { continue; }
+
+        if (lineNo == 1 && line != kCaptureHeader)
+        {
+            ELOGA("Error : Invalid sprite capture header.");
+            return false;
+        }
+
+        // コメント行(集計値を含む)は読み込み時に再計算するので読み飛ばす.
+        if (line[0] == '#')
+        { continue; }
+
+        std::istringstream tokens(line);
+        std::string op;
+        tokens >> op;
+
+        uint32_t arg0 = 0;
+        uint32_t arg1 = 0;
+        uint64_t hash = 0;
+
+        if (op == "begin")
+        {
+            tokens >> std::hex >> hash;
+            Push(SPRITE_CAPTURE_BEGIN, 0, 0, hash);
+        }
+        else if (op == "upload")
+        {
+            tokens >> arg0 >> arg1 >> std::hex >> hash;
+            Push(SPRITE_CAPTURE_UPLOAD, arg0, arg1, hash);
+        }
+        else if (op == "texture")
+        {
+            std::string id;
+            tokens >> id;
+            arg0 = (id == "-") ? kNullTextureId : uint32_t(strtoul(id.c_str(), nullptr, 10));
+            Push(SPRITE_CAPTURE_TEXTURE, arg0, 0, 0);
+        }
+        else if (op == "draw")
+        {
+            tokens >> arg0 >> arg1;
+            Push(SPRITE_CAPTURE_DRAW, arg0, arg1, 0);
+        }
+        else if (op == "end")
+        {
+            Push(SPRITE_CAPTURE_END, 0, 0, 0);
+        }
+        else if (op == "rupload")
+        {
+            tokens >> arg0 >> arg1 >> std::hex >> hash;
+            Push(SPRITE_CAPTURE_RETAINED_UPLOAD, arg0, arg1, hash);
+        }
+        else if (op == "rdraw")
+        {
+            tokens >> arg0 >> arg1;
+            Push(SPRITE_CAPTURE_RETAINED_DRAW, arg0, arg1, 0);
+        }
+        else
+        {
+            ELOGA("Error : Unknown sprite capture command. line = %d", lineNo);
+            return false;
+        }
+
+        if (tokens.fail())
+        {
+            ELOGA("Error : Invalid sprite capture arguments. line = %d", lineNo);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルに保存します.
+//-----------------------------------------------------------------------------
+bool SpriteFrameCapture::Save(const char* path) const
+{
+    std::ofstream stream(path, std::ios::out | std::ios::binary);
+    if (!stream.is_open())
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    auto text = Serialize();
+    stream.write(text.data(), text.size());
+    return stream.good();
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルから読み込みます.
+//-----------------------------------------------------------------------------
+bool SpriteFrameCapture::Load(const char* path)
+{
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    if (!stream.is_open())
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+    return Deserialize(buffer.str());
+}
+
+//-----------------------------------------------------------------------------
+//      最初に食い違うコマンド番号を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteFrameCapture::FindMismatch(const SpriteFrameCapture& other) const
+{
+    auto count = (Commands.size() < other.Commands.size()) ? Commands.size() : other.Commands.size();
+    for(size_t i=0; i<count; ++i)
+    {
+        auto& a = Commands[i];
+        auto& b = other.Commands[i];
+        if (a.Op != b.Op || a.Arg0 != b.Arg0 || a.Arg1 != b.Arg1 || a.Hash != b.Hash)
+        { return uint32_t(i); }
+    }
+
+    if (Commands.size() != other.Commands.size())
+    { return uint32_t(count); }
+
+    return UINT32_MAX;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteCaptureBackend class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SpriteCaptureBackend::SpriteCaptureBackend()
+: m_MapCount(0)
+{ m_Page.resize(kSpritePageSize); }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SpriteCaptureBackend::~SpriteCaptureBackend()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      記録とテクスチャ番号を破棄します.
+//-----------------------------------------------------------------------------
+void SpriteCaptureBackend::Clear()
+{
+    m_Capture   .Clear();
+    m_TextureIds.clear();
+    m_MapCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      記録したキャプチャを取得します.
+//-----------------------------------------------------------------------------
+const SpriteFrameCapture& SpriteCaptureBackend::GetCapture() const
+{ return m_Capture; }
+
+//-----------------------------------------------------------------------------
+//      最後に転送されたページを取得します.
+//-----------------------------------------------------------------------------
+const SpriteInstance* SpriteCaptureBackend::GetPage() const
+{ return m_Page.data(); }
+
+//-----------------------------------------------------------------------------
+//      最後に転送されたスプライト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteCaptureBackend::GetPageCount() const
+{ return m_MapCount; }
+
+//-----------------------------------------------------------------------------
+//      描画開始を記録します.
+//-----------------------------------------------------------------------------
+void SpriteCaptureBackend::Begin(const asdx::Matrix& transform)
+{ m_Capture.Push(SPRITE_CAPTURE_BEGIN, 0, 0, CalcHash(&transform, sizeof(transform))); }
+
+//-----------------------------------------------------------------------------
+//      書き込み先を返却します.
+//-----------------------------------------------------------------------------
+SpriteInstance* SpriteCaptureBackend::MapPage(uint32_t count)
+{
+    if (count > kSpritePageSize)
+    { return nullptr; }
+
+    m_MapCount = count;
+    return m_Page.data();
+}
+
+//-----------------------------------------------------------------------------
+//      転送を記録します.
+//-----------------------------------------------------------------------------
+void SpriteCaptureBackend::UnmapPage()
+{
+    auto bytes = uint32_t(sizeof(SpriteInstance) * m_MapCount);
+    m_Capture.Push(SPRITE_CAPTURE_UPLOAD, m_MapCount, bytes, CalcHash(m_Page.data(), bytes));
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャ設定を記録します.
+//-----------------------------------------------------------------------------
+void SpriteCaptureBackend::SetTexture(ID3D11ShaderResourceView* pSRV)
+{
+    auto id = kNullTextureId;
+    if (pSRV != nullptr)
+    {
+        auto itr = m_TextureIds.find(pSRV);
+        if (itr == m_TextureIds.end())
+        {
+            id = uint32_t(m_TextureIds.size());
+            m_TextureIds[pSRV] = id;
+        }
+        else
+        { id = itr->second; }
+    }
+
+    m_Capture.Push(SPRITE_CAPTURE_TEXTURE, id, 0, 0);
+}
+
+//-----------------------------------------------------------------------------
+//      描画を記録します.
+//-----------------------------------------------------------------------------
+void SpriteCaptureBackend::Draw(uint32_t start, uint32_t count)
+{ m_Capture.Push(SPRITE_CAPTURE_DRAW, start, count, 0); }
+
+//-----------------------------------------------------------------------------
+//      常駐バッファの部分転送を記録します.
+//-----------------------------------------------------------------------------
+bool SpriteCaptureBackend::UpdateRetained(uint32_t offset, const SpriteInstance* pInstances, uint32_t count)
+{
+    if (pInstances == nullptr || count == 0 || offset + count > kSpriteRetainedCapacity)
+    { return false; }
+
+    auto hash = CalcHash(pInstances, sizeof(SpriteInstance) * count);
+    m_Capture.Push(SPRITE_CAPTURE_RETAINED_UPLOAD, offset, count, hash);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      常駐バッファからの描画を記録します.
+//-----------------------------------------------------------------------------
+void SpriteCaptureBackend::DrawRetained(uint32_t start, uint32_t count)
+{ m_Capture.Push(SPRITE_CAPTURE_RETAINED_DRAW, start, count, 0); }
+
+//-----------------------------------------------------------------------------
+//      描画終了を記録します.
+//-----------------------------------------------------------------------------
+void SpriteCaptureBackend::End()
+{ m_Capture.Push(SPRITE_CAPTURE_END, 0, 0, 0); }
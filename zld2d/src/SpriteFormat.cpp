@@ -0,0 +1,174 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteFormat.cpp
+// Desc : Packed Sprite Instance Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <SpriteFormat.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define SPRITE_PACK_AVX2    1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define SPRITE_PACK_SSE2    1
+#endif
+
+
+namespace {
+
+#if SPRITE_PACK_SSE2
+//-----------------------------------------------------------------------------
+//      [0, 1]にクランプして scale 倍し，四捨五入した整数値に変換します.
+//
+//      max(v, 0) を先に取るのでNaNは0になり，QuantizeUnorm8/16 と同じ結果になります.
+//-----------------------------------------------------------------------------
+inline __m128i QuantizeSSE2(__m128 value, __m128 scale)
+{
+    auto v = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), _mm_set1_ps(0.5f)));
+}
+
+//-----------------------------------------------------------------------------
+//      1スプライト分をパックします(SSE2版).
+//-----------------------------------------------------------------------------
+inline void PackSpriteSSE2(const SpriteDesc& desc, SpriteInstance& result)
+{
+    const auto kScale16 = _mm_set1_ps(65535.0f);
+    const auto kScale8  = _mm_set1_ps(255.0f);
+    const auto kBias    = _mm_set1_epi32(32768);
+    const auto kSign    = _mm_set_epi16(
+        int16_t(0x8000), int16_t(0x8000), int16_t(0x8000), int16_t(0x8000), 0, 0, 0, 0);
+
+    auto rect  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(desc.Rect));
+    auto uv    = QuantizeSSE2(_mm_loadu_ps(desc.TexRect), kScale16);
+    auto color = QuantizeSSE2(_mm_loadu_ps(desc.Color),   kScale8);
+
+    // SSE2には符号なし16bitへのパックが無いので，バイアスを掛けて符号付きでパックしてから戻す.
+    // 矩形は packs の飽和がそのまま SaturateInt16 と同じ動作になります.
+    auto packed = _mm_packs_epi32(rect, _mm_sub_epi32(uv, kBias));
+    packed = _mm_xor_si128(packed, kSign);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result.Rect), packed);
+
+    // カラーは 32bit → 16bit → 8bit と2段階でパック.
+    auto rgba = _mm_packus_epi16(_mm_packs_epi32(color, color), _mm_setzero_si128());
+    result.Color = uint32_t(_mm_cvtsi128_si32(rgba));
+
+    auto layer = desc.Layer;
+    result.Layer    = uint16_t((layer < 0) ? 0 : (layer > UINT16_MAX) ? UINT16_MAX : layer);
+    result.Reserved = 0;
+}
+#endif//SPRITE_PACK_SSE2
+
+#if SPRITE_PACK_AVX2
+//-----------------------------------------------------------------------------
+//      2スプライト分をパックします(AVX2版).
+//
+//      レーン0に1つ目，レーン1に2つ目のスプライトを乗せて同時に量子化します.
+//-----------------------------------------------------------------------------
+inline void PackSprite2AVX2(const SpriteDesc* pDescs, SpriteInstance* pResult)
+{
+    const auto kScale16 = _mm256_set1_ps(65535.0f);
+    const auto kScale8  = _mm256_set1_ps(255.0f);
+    const auto kHalf    = _mm256_set1_ps(0.5f);
+    const auto kOne     = _mm256_set1_ps(1.0f);
+    const auto kBias    = _mm256_set1_epi32(32768);
+    const auto kSign    = _mm256_set_epi16(
+        int16_t(0x8000), int16_t(0x8000), int16_t(0x8000), int16_t(0x8000), 0, 0, 0, 0,
+        int16_t(0x8000), int16_t(0x8000), int16_t(0x8000), int16_t(0x8000), 0, 0, 0, 0);
+
+    auto rect = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pDescs[0].Rect))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDescs[1].Rect)), 1);
+    auto uv = _mm256_insertf128_ps(
+        _mm256_castps128_ps256(_mm_loadu_ps(pDescs[0].TexRect)),
+        _mm_loadu_ps(pDescs[1].TexRect), 1);
+    auto color = _mm256_insertf128_ps(
+        _mm256_castps128_ps256(_mm_loadu_ps(pDescs[0].Color)),
+        _mm_loadu_ps(pDescs[1].Color), 1);
+
+    uv    = _mm256_min_ps(_mm256_max_ps(uv,    _mm256_setzero_ps()), kOne);
+    color = _mm256_min_ps(_mm256_max_ps(color, _mm256_setzero_ps()), kOne);
+
+    auto uvi    = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(uv,    kScale16), kHalf));
+    auto colori = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(color, kScale8),  kHalf));
+
+    // packs はレーン毎に動作するので，レーン0/1がそのまま各スプライトの16byteになる.
+    auto packed = _mm256_xor_si256(_mm256_packs_epi32(rect, _mm256_sub_epi32(uvi, kBias)), kSign);
+    auto rgba   = _mm256_packus_epi16(_mm256_packs_epi32(colori, colori), _mm256_setzero_si256());
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pResult[0].Rect), _mm256_castsi256_si128(packed));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pResult[1].Rect), _mm256_extracti128_si256(packed, 1));
+
+    pResult[0].Color = uint32_t(_mm256_extract_epi32(rgba, 0));
+    pResult[1].Color = uint32_t(_mm256_extract_epi32(rgba, 4));
+
+    for(auto i=0; i<2; ++i)
+    {
+        auto layer = pDescs[i].Layer;
+        pResult[i].Layer    = uint16_t((layer < 0) ? 0 : (layer > UINT16_MAX) ? UINT16_MAX : layer);
+        pResult[i].Reserved = 0;
+    }
+}
+#endif//SPRITE_PACK_AVX2
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      スプライト記述子をまとめてパックします(スカラー版).
+//-----------------------------------------------------------------------------
+void PackSpritesScalar(const SpriteDesc* pDescs, uint32_t count, SpriteInstance* pResult)
+{
+    for(auto i=0u; i<count; ++i)
+    {
+        auto& desc = pDescs[i];
+        pResult[i] = PackSprite(
+            desc.Rect[0], desc.Rect[1], desc.Rect[2], desc.Rect[3],
+            desc.TexRect[0], desc.TexRect[1], desc.TexRect[2], desc.TexRect[3],
+            PackColor(desc.Color[0], desc.Color[1], desc.Color[2], desc.Color[3]),
+            desc.Layer);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      スプライト記述子をまとめてパックします.
+//-----------------------------------------------------------------------------
+void PackSprites(const SpriteDesc* pDescs, uint32_t count, SpriteInstance* pResult)
+{
+    auto i = 0u;
+
+#if SPRITE_PACK_AVX2
+    // 1ループで8スプライト.
+    for(; i + 8 <= count; i += 8)
+    {
+        PackSprite2AVX2(pDescs + i + 0, pResult + i + 0);
+        PackSprite2AVX2(pDescs + i + 2, pResult + i + 2);
+        PackSprite2AVX2(pDescs + i + 4, pResult + i + 4);
+        PackSprite2AVX2(pDescs + i + 6, pResult + i + 6);
+    }
+#endif
+
+#if SPRITE_PACK_SSE2
+    // 1ループで4スプライト.
+    for(; i + 4 <= count; i += 4)
+    {
+        PackSpriteSSE2(pDescs[i + 0], pResult[i + 0]);
+        PackSpriteSSE2(pDescs[i + 1], pResult[i + 1]);
+        PackSpriteSSE2(pDescs[i + 2], pResult[i + 2]);
+        PackSpriteSSE2(pDescs[i + 3], pResult[i + 3]);
+    }
+
+    for(; i < count; ++i)
+    { PackSpriteSSE2(pDescs[i], pResult[i]); }
+#endif
+
+    // 残りはスカラー版で処理.
+    if (i < count)
+    { PackSpritesScalar(pDescs + i, count - i, pResult + i); }
+}
@@ -0,0 +1,345 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteRecorder.cpp
+// Desc : Sprite Command Recorder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <SpriteRecorder.h>
+#include <TextureAtlas.h>
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kInitialCapacity = 512;   // 最初に確保するスプライト数.
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteRecorder class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SpriteRecorder::SpriteRecorder()
+: m_Count       (0)
+, m_DroppedCount(0)
+, m_CulledCount (0)
+, m_CullRect    (0, 0, 0, 0)
+, m_EnableCull  (false)
+, m_Color       (1.0f, 1.0f, 1.0f, 1.0f)
+, m_PackedColor (0xffffffff)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SpriteRecorder::~SpriteRecorder()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      メモリを予約します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::Reserve(uint32_t count)
+{
+    if (count > kSpriteMaxCount)
+    { count = kSpriteMaxCount; }
+
+    if (m_Instances.size() < count)
+    {
+        m_Instances.resize(count);
+        m_Textures .resize(count);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      記録したスプライトと統計を破棄します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::Reset()
+{
+    m_Count        = 0;
+    m_DroppedCount = 0;
+    m_CulledCount  = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      メモリを解放します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::Release()
+{
+    Reset();
+    m_Instances.clear();
+    m_Instances.shrink_to_fit();
+    m_Textures .clear();
+    m_Textures .shrink_to_fit();
+}
+
+//-----------------------------------------------------------------------------
+//      頂点カラーを設定します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::SetColor(float r, float g, float b, float a)
+{
+    m_Color.x = r;
+    m_Color.y = g;
+    m_Color.z = b;
+    m_Color.w = a;
+
+    // スプライト毎に変換しなくて済むようにパックしておく.
+    m_PackedColor = PackColor(r, g, b, a);
+}
+
+//-----------------------------------------------------------------------------
+//      カリング矩形を設定します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::SetCullRect(const Box& rect)
+{
+    m_CullRect   = rect;
+    m_EnableCull = true;
+}
+
+//-----------------------------------------------------------------------------
+//      カリング矩形を解除します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::ResetCullRect()
+{ m_EnableCull = false; }
+
+//-----------------------------------------------------------------------------
+//      スプライトを記録します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::Draw
+(
+    const TextureRegion&    texture,
+    int                     x,
+    int                     y,
+    int                     w,
+    int                     h,
+    const asdx::Vector2&    uv0,
+    const asdx::Vector2&    uv1,
+    int                     layerDepth
+)
+{
+    // 見えないスプライトは展開する前に捨てる.
+    if (IsCulled(x, y, w, h))
+    {
+        m_CulledCount++;
+        return;
+    }
+
+    if (Allocate(1) == 0)
+    { return; }
+
+    // アトラス内の領域にテクスチャ座標を変換.
+    float u0, v0, u1, v1;
+    RemapTexCoord(texture.TexRect, uv0.x, uv0.y, u0, v0);
+    RemapTexCoord(texture.TexRect, uv1.x, uv1.y, u1, v1);
+
+    // 1スプライト1レコードにパックして記録. 4頂点への展開は頂点シェーダで行う.
+    m_Instances[m_Count] = PackSprite(
+        x, y, w, h,
+        u0, v0, u1, v1,
+        m_PackedColor,
+        layerDepth);
+    m_Textures[m_Count] = texture.pSRV;
+
+    m_Count++;
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャ領域全体を使うスプライトを記録します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::Draw(const TextureRegion& texture, int x, int y, int w, int h, int layerDepth)
+{ Draw(texture, x, y, w, h, asdx::Vector2(0.0f, 0.0f), asdx::Vector2(1.0f, 1.0f), layerDepth); }
+
+//-----------------------------------------------------------------------------
+//      スプライトをまとめて記録します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::DrawBatch(const SpriteDesc* pDescs, uint32_t count)
+{
+    if (pDescs == nullptr || count == 0)
+    { return; }
+
+    if (!m_EnableCull)
+    {
+        AppendBatch(pDescs, count);
+        return;
+    }
+
+    // カリングされたスプライトを飛ばして，見える区間毎にまとめてパックする.
+    auto start = 0u;
+    for(auto i=0u; i<count; ++i)
+    {
+        auto& rect = pDescs[i].Rect;
+        if (!IsCulled(rect[0], rect[1], rect[2], rect[3]))
+        { continue; }
+
+        m_CulledCount++;
+        AppendBatch(pDescs + start, i - start);
+        start = i + 1;
+    }
+
+    AppendBatch(pDescs + start, count - start);
+}
+
+//-----------------------------------------------------------------------------
+//      パック済みのスプライトを平行移動して記録します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::DrawInstances
+(
+    const SpriteInstance*               pInstances,
+    ID3D11ShaderResourceView* const*    ppSRV,
+    uint32_t                            count,
+    int                                 offsetX,
+    int                                 offsetY,
+    int                                 layerDepth
+)
+{
+    if (pInstances == nullptr || ppSRV == nullptr || count == 0)
+    { return; }
+
+    auto layer = uint16_t(asdx::Clamp<int>(layerDepth, 0, UINT16_MAX));
+
+    // 展開済みなので平行移動とレイヤーの上書きだけ行う.
+    for(auto i=0u; i<count; ++i)
+    {
+        auto& src = pInstances[i];
+        auto  x   = src.Rect[0] + offsetX;
+        auto  y   = src.Rect[1] + offsetY;
+
+        if (IsCulled(x, y, src.Rect[2], src.Rect[3]))
+        {
+            m_CulledCount++;
+            continue;
+        }
+
+        if (Allocate(1) == 0)
+        { continue; }
+
+        auto& dst = m_Instances[m_Count];
+        dst         = src;
+        dst.Rect[0] = SaturateInt16(x);
+        dst.Rect[1] = SaturateInt16(y);
+        dst.Layer   = layer;
+        m_Textures[m_Count] = ppSRV[i];
+
+        m_Count++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      別のレコーダーの内容を末尾に追加します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::Append(const SpriteRecorder& other)
+{
+    m_CulledCount  += other.m_CulledCount;
+    m_DroppedCount += other.m_DroppedCount;
+
+    auto count = Allocate(other.m_Count);
+    if (count == 0)
+    { return; }
+
+    memcpy(&m_Instances[m_Count], other.m_Instances.data(), sizeof(SpriteInstance) * count);
+    memcpy(&m_Textures [m_Count], other.m_Textures .data(), sizeof(const void*)    * count);
+
+    m_Count += count;
+}
+
+//-----------------------------------------------------------------------------
+//      記録したスプライト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteRecorder::GetCount() const
+{ return m_Count; }
+
+//-----------------------------------------------------------------------------
+//      上限を超えて破棄されたスプライト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteRecorder::GetDroppedCount() const
+{ return m_DroppedCount; }
+
+//-----------------------------------------------------------------------------
+//      カリングされたスプライト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteRecorder::GetCulledCount() const
+{ return m_CulledCount; }
+
+//-----------------------------------------------------------------------------
+//      頂点カラーを取得します.
+//-----------------------------------------------------------------------------
+const asdx::Vector4& SpriteRecorder::GetColor() const
+{ return m_Color; }
+
+//-----------------------------------------------------------------------------
+//      パック済みのスプライトを取得します.
+//-----------------------------------------------------------------------------
+const SpriteInstance* SpriteRecorder::GetInstances() const
+{ return m_Instances.data(); }
+
+//-----------------------------------------------------------------------------
+//      スプライト毎のテクスチャを取得します.
+//-----------------------------------------------------------------------------
+const void* const* SpriteRecorder::GetTextures() const
+{ return m_Textures.data(); }
+
+//-----------------------------------------------------------------------------
+//      記録領域を確保します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteRecorder::Allocate(uint32_t count)
+{
+    // 最大スプライト数を超える分は破棄.
+    auto rest = kSpriteMaxCount - m_Count;
+    if (count > rest)
+    {
+        m_DroppedCount += count - rest;
+        count = rest;
+    }
+
+    // 足りなければ倍々で拡張.
+    auto required = m_Count + count;
+    if (required > m_Instances.size())
+    {
+        auto capacity = asdx::Max<uint32_t>(uint32_t(m_Instances.size()), kInitialCapacity);
+        while (capacity < required)
+        { capacity *= 2; }
+
+        m_Instances.resize(capacity);
+        m_Textures .resize(capacity);
+    }
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//      スプライト記述子をパックして記録します.
+//-----------------------------------------------------------------------------
+void SpriteRecorder::AppendBatch(const SpriteDesc* pDescs, uint32_t count)
+{
+    count = Allocate(count);
+    if (count == 0)
+    { return; }
+
+    // SIMDでまとめてパック.
+    PackSprites(pDescs, count, &m_Instances[m_Count]);
+
+    for(auto i=0u; i<count; ++i)
+    { m_Textures[m_Count + i] = pDescs[i].pSRV; }
+
+    m_Count += count;
+}
+
+//-----------------------------------------------------------------------------
+//      カリング矩形の完全に外側にあるかどうか?
+//-----------------------------------------------------------------------------
+bool SpriteRecorder::IsCulled(int x, int y, int w, int h) const
+{
+    if (!m_EnableCull)
+    { return false; }
+
+    return !IsHit(Box(x, y, w, h), m_CullRect);
+}
@@ -0,0 +1,396 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteRetainedList.cpp
+// Desc : Retained Mode Sprite List.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <SpriteRetainedList.h>
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kDirtyMergeGap = 4;   // これ以下の隙間しかない転送範囲は1つにまとめる.
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteRetainedList class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SpriteRetainedList::SpriteRetainedList()
+: m_Capacity    (0)
+, m_DirtyCount  (0)
+, m_LayoutDirty (false)
+, m_Region      (UINT32_MAX)
+, m_RegionSize  (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SpriteRetainedList::~SpriteRetainedList()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      初期化処理です.
+//-----------------------------------------------------------------------------
+bool SpriteRetainedList::Init(uint32_t capacity)
+{
+    if (capacity == 0)
+    { return false; }
+
+    m_Capacity = capacity;
+    m_Records  .reserve(capacity);
+    m_Instances.reserve(capacity);
+    m_Keys     .reserve(capacity);
+    m_Dirty    .assign(capacity, 0);
+
+    m_DirtyCount  = 0;
+    m_LayoutDirty = false;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理です.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::Term()
+{
+    m_Records    .clear();
+    m_FreeHandles.clear();
+    m_Instances  .clear();
+    m_Dirty      .clear();
+    m_Keys       .clear();
+    m_Commands   .clear();
+
+    m_Capacity    = 0;
+    m_DirtyCount  = 0;
+    m_LayoutDirty = false;
+}
+
+//-----------------------------------------------------------------------------
+//      スプライトを生成します.
+//-----------------------------------------------------------------------------
+SpriteHandle SpriteRetainedList::Create
+(
+    const TextureRegion&    texture,
+    int                     x,
+    int                     y,
+    int                     w,
+    int                     h,
+    int                     layerDepth,
+    const asdx::Vector4&    color
+)
+{
+    SpriteHandle handle;
+    if (!m_FreeHandles.empty())
+    {
+        handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+    }
+    else if (m_Records.size() < m_Capacity)
+    {
+        handle = SpriteHandle(m_Records.size());
+        m_Records.emplace_back();
+    }
+    else
+    { return kInvalidSpriteHandle; }
+
+    auto& record = m_Records[handle];
+    record.Instance = PackSprite(
+        x, y, w, h,
+        texture.TexRect[0], texture.TexRect[1], texture.TexRect[2], texture.TexRect[3],
+        PackColor(color.x, color.y, color.z, color.w),
+        layerDepth);
+    record.pTexture = texture.pSRV;
+    record.Position = UINT32_MAX;
+    record.Alive    = true;
+    record.Visible  = true;
+
+    m_LayoutDirty = true;
+    return handle;
+}
+
+//-----------------------------------------------------------------------------
+//      スプライトを破棄します.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::Destroy(SpriteHandle handle)
+{
+    auto record = Find(handle);
+    if (record == nullptr)
+    { return; }
+
+    record->Alive    = false;
+    record->Position = UINT32_MAX;
+    m_FreeHandles.push_back(handle);
+    m_LayoutDirty = true;
+}
+
+//-----------------------------------------------------------------------------
+//      全てのスプライトを破棄します.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::Clear()
+{
+    m_Records    .clear();
+    m_FreeHandles.clear();
+    m_LayoutDirty = true;
+}
+
+//-----------------------------------------------------------------------------
+//      位置を設定します.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::SetPosition(SpriteHandle handle, int x, int y)
+{
+    auto record = Find(handle);
+    if (record == nullptr)
+    { return; }
+
+    auto& inst = record->Instance;
+    auto  px   = SaturateInt16(x);
+    auto  py   = SaturateInt16(y);
+    if (inst.Rect[0] == px && inst.Rect[1] == py)
+    { return; }
+
+    inst.Rect[0] = px;
+    inst.Rect[1] = py;
+    Write(*record);
+}
+
+//-----------------------------------------------------------------------------
+//      カラーを設定します.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::SetColor(SpriteHandle handle, float r, float g, float b, float a)
+{
+    auto record = Find(handle);
+    if (record == nullptr)
+    { return; }
+
+    auto color = PackColor(r, g, b, a);
+    if (record->Instance.Color == color)
+    { return; }
+
+    record->Instance.Color = color;
+    Write(*record);
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャを設定します.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::SetTexture(SpriteHandle handle, const TextureRegion& texture)
+{
+    auto record = Find(handle);
+    if (record == nullptr)
+    { return; }
+
+    auto& inst = record->Instance;
+    inst.TexRect[0] = QuantizeUnorm16(texture.TexRect[0]);
+    inst.TexRect[1] = QuantizeUnorm16(texture.TexRect[1]);
+    inst.TexRect[2] = QuantizeUnorm16(texture.TexRect[2]);
+    inst.TexRect[3] = QuantizeUnorm16(texture.TexRect[3]);
+
+    // テクスチャが変わると描画コマンドの区切りが変わる.
+    if (record->pTexture != texture.pSRV)
+    {
+        record->pTexture = texture.pSRV;
+        m_LayoutDirty = true;
+        return;
+    }
+
+    Write(*record);
+}
+
+//-----------------------------------------------------------------------------
+//      表示するかどうかを設定します.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::SetVisible(SpriteHandle handle, bool visible)
+{
+    auto record = Find(handle);
+    if (record == nullptr || record->Visible == visible)
+    { return; }
+
+    record->Visible = visible;
+    m_LayoutDirty   = true;
+}
+
+//-----------------------------------------------------------------------------
+//      変更を並び順に反映します.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::Flush()
+{
+    if (!m_LayoutDirty)
+    { return; }
+
+    m_LayoutDirty = false;
+
+    // (奥から手前, テクスチャ, 生成順) のキーで並べる. 描画コマンドはレイヤー毎に分け,
+    // SpriteSystem で記録したスプライトのコマンドとレイヤー順に混ぜて描画する.
+    std::unordered_map<const void*, uint32_t> textureIds;
+    m_Keys.clear();
+    for(auto i=0u; i<m_Records.size(); ++i)
+    {
+        auto& record = m_Records[i];
+        record.Position = UINT32_MAX;
+        if (!record.Alive || !record.Visible)
+        { continue; }
+
+        auto texId = textureIds.emplace(record.pTexture, uint32_t(textureIds.size())).first->second;
+        auto layer = uint64_t(0xffff - record.Instance.Layer);
+        m_Keys.push_back((layer << 48) | (uint64_t(std::min<uint32_t>(texId, 0xffff)) << 32) | i);
+    }
+
+    std::sort(m_Keys.begin(), m_Keys.end());
+
+    m_Instances.resize(m_Keys.size());
+    m_Commands .clear();
+
+    for(auto i=0u; i<m_Keys.size(); ++i)
+    {
+        auto& record = m_Records[uint32_t(m_Keys[i])];
+        record.Position = i;
+        m_Instances[i]  = record.Instance;
+
+        if (!m_Commands.empty()
+          && m_Commands.back().pTexture == record.pTexture
+          && m_Commands.back().Layer    == record.Instance.Layer)
+        {
+            m_Commands.back().Count++;
+            continue;
+        }
+
+        SpriteDrawCommand cmd;
+        cmd.pTexture = record.pTexture;
+        cmd.Page     = 0;
+        cmd.Start    = i;
+        cmd.Count    = 1;
+        cmd.Layer    = record.Instance.Layer;
+        m_Commands.push_back(cmd);
+    }
+
+    MarkAllDirty();
+}
+
+//-----------------------------------------------------------------------------
+//      転送が必要な範囲を取得します.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::GetDirtyRanges(std::vector<SpriteDirtyRange>& result) const
+{
+    result.clear();
+
+    if (m_DirtyCount == 0)
+    { return; }
+
+    auto count = uint32_t(m_Instances.size());
+    for(auto i=0u; i<count; ++i)
+    {
+        if (!m_Dirty[i])
+        { continue; }
+
+        // 隙間が小さければ転送回数を減らすために前の範囲に含める.
+        if (!result.empty())
+        {
+            auto& last = result.back();
+            if (i - (last.Start + last.Count) <= kDirtyMergeGap)
+            {
+                last.Count = i - last.Start + 1;
+                continue;
+            }
+        }
+
+        SpriteDirtyRange range;
+        range.Start = i;
+        range.Count = 1;
+        result.push_back(range);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      転送済みとして更新フラグを下ろします.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::ClearDirty()
+{
+    if (m_DirtyCount == 0)
+    { return; }
+
+    std::fill(m_Dirty.begin(), m_Dirty.end(), uint8_t(0));
+    m_DirtyCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      全体を転送対象にします.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::MarkAllDirty()
+{
+    auto count = uint32_t(m_Instances.size());
+    std::fill(m_Dirty.begin(), m_Dirty.begin() + count, uint8_t(1));
+    m_DirtyCount = count;
+}
+
+//-----------------------------------------------------------------------------
+//      並び順を作り直す必要があるかどうか?
+//-----------------------------------------------------------------------------
+bool SpriteRetainedList::IsLayoutDirty() const
+{ return m_LayoutDirty; }
+
+//-----------------------------------------------------------------------------
+//      最大スプライト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteRetainedList::GetCapacity() const
+{ return m_Capacity; }
+
+//-----------------------------------------------------------------------------
+//      描画するスプライト数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteRetainedList::GetCount() const
+{ return uint32_t(m_Instances.size()); }
+
+//-----------------------------------------------------------------------------
+//      描画順に並べたスプライトを取得します.
+//-----------------------------------------------------------------------------
+const SpriteInstance* SpriteRetainedList::GetInstances() const
+{ return m_Instances.data(); }
+
+//-----------------------------------------------------------------------------
+//      描画コマンドを取得します.
+//-----------------------------------------------------------------------------
+const std::vector<SpriteDrawCommand>& SpriteRetainedList::GetCommands() const
+{ return m_Commands; }
+
+//-----------------------------------------------------------------------------
+//      有効なハンドルであればレコードを返却します.
+//-----------------------------------------------------------------------------
+SpriteRetainedList::Record* SpriteRetainedList::Find(SpriteHandle handle)
+{
+    if (handle >= m_Records.size() || !m_Records[handle].Alive)
+    { return nullptr; }
+
+    return &m_Records[handle];
+}
+
+//-----------------------------------------------------------------------------
+//      レコードの内容を描画順の配列に書き込み，更新対象にします.
+//-----------------------------------------------------------------------------
+void SpriteRetainedList::Write(const Record& record)
+{
+    // 並び順を作り直す場合は Flush() でまとめて書き込む.
+    if (m_LayoutDirty || record.Position == UINT32_MAX)
+    { return; }
+
+    m_Instances[record.Position] = record.Instance;
+
+    if (!m_Dirty[record.Position])
+    {
+        m_Dirty[record.Position] = 1;
+        m_DirtyCount++;
+    }
+}
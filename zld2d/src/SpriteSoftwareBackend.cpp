@@ -0,0 +1,651 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteSoftwareBackend.cpp
+// Desc : Software Rasterizer Sprite Render Backend.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <SpriteSoftwareBackend.h>
+#include <asdxLogger.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPRITE_RASTER_SSE2     1
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const int      kTileSize     = 64;       // タイルのピクセル数.
+static const float    kInv255       = 1.0f / 255.0f;
+
+//-----------------------------------------------------------------------------
+//      [0, 1]のカラーをRGBA8にパックします.
+//-----------------------------------------------------------------------------
+inline uint32_t PackPixel(const float color[4])
+{
+    uint32_t result = 0;
+    for(auto i=0; i<4; ++i)
+    {
+        auto c = std::nearbyint(color[i] * 255.0f);
+        c = (c < 0.0f) ? 0.0f : (c > 255.0f) ? 255.0f : c;
+        result |= uint32_t(c) << (i * 8);
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      smoothstep です.
+//-----------------------------------------------------------------------------
+inline float SmoothStep(float a, float b, float x)
+{
+    auto t = asdx::Saturate((x - a) / (b - a));
+    return t * t * (3.0f - 2.0f * t);
+}
+
+#if SPRITE_RASTER_SSE2
+//-----------------------------------------------------------------------------
+//      RGBA8を float4 に展開します.
+//-----------------------------------------------------------------------------
+inline __m128 LoadTexel(uint32_t texel)
+{
+    auto zero = _mm_setzero_si128();
+    auto v    = _mm_cvtsi32_si128(int(texel));
+    v = _mm_unpacklo_epi8 (v, zero);
+    v = _mm_unpacklo_epi16(v, zero);
+    return _mm_cvtepi32_ps(v);
+}
+
+//-----------------------------------------------------------------------------
+//      [0, 255]の float4 をRGBA8にパックします.
+//-----------------------------------------------------------------------------
+inline uint32_t StoreTexel(__m128 value)
+{
+    auto v = _mm_cvtps_epi32(value);    // 最近接偶数丸め(nearbyint と同じ).
+    v = _mm_packs_epi32 (v, v);
+    v = _mm_packus_epi16(v, v);
+    return uint32_t(_mm_cvtsi128_si32(v));
+}
+#endif
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteSoftwareBackend class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SpriteSoftwareBackend::SpriteSoftwareBackend()
+: m_Width       (0)
+, m_Height      (0)
+, m_ThreadCount (1)
+, m_pCurrTexture(nullptr)
+, m_ShadedPixels(0)
+{
+    m_Scissor[0] = m_Scissor[1] = m_Scissor[2] = m_Scissor[3] = 0;
+    m_Scale [0] = m_Scale [1] = 1.0f;
+    m_Offset[0] = m_Offset[1] = 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SpriteSoftwareBackend::~SpriteSoftwareBackend()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      初期化処理です.
+//-----------------------------------------------------------------------------
+bool SpriteSoftwareBackend::Init(uint32_t width, uint32_t height, uint32_t threadCount)
+{
+    if (width == 0 || height == 0 || width > INT16_MAX || height > INT16_MAX)
+    {
+        ELOGA("Error : Invalid Argument. width = %u, height = %u", width, height);
+        return false;
+    }
+
+    m_Width  = width;
+    m_Height = height;
+
+    if (threadCount == 0)
+    { threadCount = std::thread::hardware_concurrency(); }
+    m_ThreadCount = (threadCount > 0) ? threadCount : 1;
+
+    m_Color.resize(size_t(width) * height);
+    m_Page .resize(kSpritePageSize);
+    m_Retained.resize(kSpriteRetainedCapacity);
+
+    auto tileX = (width  + kTileSize - 1) / kTileSize;
+    auto tileY = (height + kTileSize - 1) / kTileSize;
+    m_Bins.resize(tileX * tileY);
+
+    ResetScissor();
+    Clear(0.0f, 0.0f, 0.0f, 0.0f);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理です.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::Term()
+{
+    m_Color   .clear();
+    m_Textures.clear();
+    m_Page    .clear();
+    m_Retained.clear();
+    m_Quads   .clear();
+    m_Bins    .clear();
+
+    m_Width        = 0;
+    m_Height       = 0;
+    m_pCurrTexture = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      カラーをクリアします.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::Clear(float r, float g, float b, float a)
+{
+    const float color[4] = { r, g, b, a };
+    std::fill(m_Color.begin(), m_Color.end(), PackPixel(color));
+}
+
+//-----------------------------------------------------------------------------
+//      シザー矩形を設定します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::SetScissor(int x, int y, int w, int h)
+{
+    m_Scissor[0] = asdx::Clamp<int>(x,     0, int(m_Width));
+    m_Scissor[1] = asdx::Clamp<int>(y,     0, int(m_Height));
+    m_Scissor[2] = asdx::Clamp<int>(x + w, 0, int(m_Width));
+    m_Scissor[3] = asdx::Clamp<int>(y + h, 0, int(m_Height));
+}
+
+//-----------------------------------------------------------------------------
+//      シザー矩形をレンダーターゲット全体に戻します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::ResetScissor()
+{ SetScissor(0, 0, int(m_Width), int(m_Height)); }
+
+//-----------------------------------------------------------------------------
+//      テクスチャを登録します.
+//-----------------------------------------------------------------------------
+bool SpriteSoftwareBackend::RegisterTexture
+(
+    ID3D11ShaderResourceView*   pSRV,
+    uint32_t                    width,
+    uint32_t                    height,
+    uint32_t                    pitch,
+    const void*                 pPixels
+)
+{
+    if (pSRV == nullptr || pPixels == nullptr || width == 0 || height == 0 || pitch < width * 4)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto& texture = m_Textures[pSRV];
+    texture.Width  = width;
+    texture.Height = height;
+    texture.Pixels.resize(size_t(width) * height);
+
+    auto src = static_cast<const uint8_t*>(pPixels);
+    for(auto y=0u; y<height; ++y)
+    { memcpy(&texture.Pixels[size_t(y) * width], src + size_t(y) * pitch, width * 4); }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャの登録を解除します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::UnregisterTexture(ID3D11ShaderResourceView* pSRV)
+{ m_Textures.erase(pSRV); }
+
+//-----------------------------------------------------------------------------
+//      画面切り替えを合成します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::ApplySwitch
+(
+    const asdx::Vector4&    color,
+    const asdx::Vector2&    center,
+    float                   radius
+)
+{
+    auto invW = 1.0f / float(m_Width);
+    auto invH = 1.0f / float(m_Height);
+
+    for(auto y=0u; y<m_Height; ++y)
+    {
+        auto v   = (float(y) + 0.5f) * invH;
+        auto row = &m_Color[size_t(y) * m_Width];
+
+        for(auto x=0u; x<m_Width; ++x)
+        {
+            // SwitchPS.hlsl と同じ計算.
+            auto a = color.w;
+            if (radius > 0.0f)
+            {
+                auto dx = center.x - (float(x) + 0.5f) * invW;
+                auto dy = center.y - v;
+                a = SmoothStep(radius - 0.1f, radius, sqrtf(dx * dx + dy * dy));
+            }
+
+            float dst[4];
+            UnpackColor(row[x], dst);
+
+            const float src[4] = { color.x, color.y, color.z, a };
+            for(auto i=0; i<4; ++i)
+            { dst[i] = src[i] * a + dst[i] * (1.0f - a); }
+
+            row[x] = PackPixel(dst);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      レンダーターゲットをTGA形式で保存します.
+//-----------------------------------------------------------------------------
+bool SpriteSoftwareBackend::SaveTGA(const char* path) const
+{
+    std::ofstream stream(path, std::ios::out | std::ios::binary);
+    if (!stream.is_open())
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    // 無圧縮32bit, 左上原点.
+    uint8_t header[18] = {};
+    header[ 2] = 2;
+    header[12] = uint8_t(m_Width  & 0xff);
+    header[13] = uint8_t(m_Width  >> 8);
+    header[14] = uint8_t(m_Height & 0xff);
+    header[15] = uint8_t(m_Height >> 8);
+    header[16] = 32;
+    header[17] = 0x28;
+    stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    // RGBA -> BGRA.
+    std::vector<uint32_t> row(m_Width);
+    for(auto y=0u; y<m_Height; ++y)
+    {
+        auto src = &m_Color[size_t(y) * m_Width];
+        for(auto x=0u; x<m_Width; ++x)
+        {
+            auto c = src[x];
+            row[x] = (c & 0xff00ff00) | ((c & 0xff) << 16) | ((c >> 16) & 0xff);
+        }
+        stream.write(reinterpret_cast<const char*>(row.data()), m_Width * 4);
+    }
+
+    return stream.good();
+}
+
+//-----------------------------------------------------------------------------
+//      ピクセルデータを取得します.
+//-----------------------------------------------------------------------------
+const uint32_t* SpriteSoftwareBackend::GetPixels() const
+{ return m_Color.data(); }
+
+//-----------------------------------------------------------------------------
+//      横幅を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteSoftwareBackend::GetWidth() const
+{ return m_Width; }
+
+//-----------------------------------------------------------------------------
+//      縦幅を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteSoftwareBackend::GetHeight() const
+{ return m_Height; }
+
+//-----------------------------------------------------------------------------
+//      描画スレッド数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteSoftwareBackend::GetThreadCount() const
+{ return m_ThreadCount; }
+
+//-----------------------------------------------------------------------------
+//      シェーディングしたピクセル数の累計を取得します.
+//-----------------------------------------------------------------------------
+uint64_t SpriteSoftwareBackend::GetShadedPixelCount() const
+{ return m_ShadedPixels; }
+
+//-----------------------------------------------------------------------------
+//      描画を開始します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::Begin(const asdx::Matrix& transform)
+{
+    // スプライトの変換は拡大と平行移動だけなので，ビューポート変換と合わせて
+    // スクリーン座標 -> ピクセル座標の1次式にしておく.
+    auto halfW = float(m_Width)  * 0.5f;
+    auto halfH = float(m_Height) * 0.5f;
+    m_Scale [0] =  transform._11 * halfW;
+    m_Scale [1] = -transform._22 * halfH;
+    m_Offset[0] = (transform._41 + 1.0f) * halfW;
+    m_Offset[1] = (1.0f - transform._42) * halfH;
+
+    m_pCurrTexture = nullptr;
+    m_Quads.clear();
+}
+
+//-----------------------------------------------------------------------------
+//      書き込み先を返却します.
+//-----------------------------------------------------------------------------
+SpriteInstance* SpriteSoftwareBackend::MapPage(uint32_t count)
+{
+    if (count > kSpritePageSize || m_Page.empty())
+    { return nullptr; }
+
+    return m_Page.data();
+}
+
+//-----------------------------------------------------------------------------
+//      書き込みを終了します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::UnmapPage()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      テクスチャを設定します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::SetTexture(ID3D11ShaderResourceView* pSRV)
+{
+    // 登録されていないテクスチャはGPUでSRVが無い場合と同じく0をサンプルする.
+    auto itr = m_Textures.find(pSRV);
+    m_pCurrTexture = (itr != m_Textures.end()) ? &itr->second : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      描画するスプライトを記録します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::Draw(uint32_t start, uint32_t count)
+{
+    if (start >= kSpritePageSize || m_Page.empty())
+    { return; }
+
+    AddQuads(&m_Page[start], asdx::Min(count, kSpritePageSize - start));
+}
+
+//-----------------------------------------------------------------------------
+//      常駐バッファの一部を更新します.
+//-----------------------------------------------------------------------------
+bool SpriteSoftwareBackend::UpdateRetained(uint32_t offset, const SpriteInstance* pInstances, uint32_t count)
+{
+    if (pInstances == nullptr || count == 0 || offset + count > m_Retained.size())
+    { return false; }
+
+    memcpy(&m_Retained[offset], pInstances, sizeof(SpriteInstance) * count);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      常駐バッファのスプライトを記録します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::DrawRetained(uint32_t start, uint32_t count)
+{
+    if (start >= m_Retained.size())
+    { return; }
+
+    AddQuads(&m_Retained[start], asdx::Min(count, uint32_t(m_Retained.size()) - start));
+}
+
+//-----------------------------------------------------------------------------
+//      記録したスプライトを描画します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::End()
+{
+    if (m_Quads.empty())
+    { return; }
+
+    // タイル毎に重なるスプライトを記録順のまま振り分ける.
+    auto tileX = (m_Width + kTileSize - 1) / kTileSize;
+    for(auto& bin : m_Bins)
+    { bin.clear(); }
+
+    for(auto i=0u; i<m_Quads.size(); ++i)
+    {
+        auto& quad = m_Quads[i];
+        auto tx0 = quad.Bounds[0] / kTileSize;
+        auto ty0 = quad.Bounds[1] / kTileSize;
+        auto tx1 = (quad.Bounds[2] - 1) / kTileSize;
+        auto ty1 = (quad.Bounds[3] - 1) / kTileSize;
+
+        for(auto ty=ty0; ty<=ty1; ++ty)
+        {
+            for(auto tx=tx0; tx<=tx1; ++tx)
+            { m_Bins[ty * tileX + tx].push_back(i); }
+        }
+    }
+
+    // タイル同士は書き込み先が重ならないので，スレッド間で同期は不要.
+    auto tileCount = uint32_t(m_Bins.size());
+    auto threadCount = asdx::Min(m_ThreadCount, tileCount);
+
+    if (threadCount <= 1)
+    {
+        for(auto i=0u; i<tileCount; ++i)
+        { m_ShadedPixels += RasterizeTile(i); }
+        return;
+    }
+
+    std::atomic<uint32_t> nextTile(0);
+    std::atomic<uint64_t> shaded  (0);
+
+    auto worker = [&]()
+    {
+        uint64_t local = 0;
+        for(;;)
+        {
+            auto tile = nextTile.fetch_add(1);
+            if (tile >= tileCount)
+            { break; }
+            local += RasterizeTile(tile);
+        }
+        shaded += local;
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for(auto i=1u; i<threadCount; ++i)
+    { threads.emplace_back(worker); }
+
+    worker();
+
+    for(auto& thread : threads)
+    { thread.join(); }
+
+    m_ShadedPixels += shaded;
+}
+
+//-----------------------------------------------------------------------------
+//      1タイル分のスプライトを描画します.
+//-----------------------------------------------------------------------------
+uint64_t SpriteSoftwareBackend::RasterizeTile(uint32_t tileIndex)
+{
+    auto& bin = m_Bins[tileIndex];
+    if (bin.empty())
+    { return 0; }
+
+    auto tileX  = (m_Width + kTileSize - 1) / kTileSize;
+    auto left   = int(tileIndex % tileX) * kTileSize;
+    auto top    = int(tileIndex / tileX) * kTileSize;
+    auto right  = asdx::Min<int>(left + kTileSize, int(m_Width));
+    auto bottom = asdx::Min<int>(top  + kTileSize, int(m_Height));
+
+    uint64_t shaded = 0;
+
+    for(auto index : bin)
+    {
+        auto& quad = m_Quads[index];
+        auto  x0   = asdx::Max(quad.Bounds[0], left);
+        auto  y0   = asdx::Max(quad.Bounds[1], top);
+        auto  x1   = asdx::Min(quad.Bounds[2], right);
+        auto  y1   = asdx::Min(quad.Bounds[3], bottom);
+
+        auto& tex   = *quad.pTexture;
+        auto  texW  = int(tex.Width);
+        auto  texH  = int(tex.Height);
+        auto  texel = tex.Pixels.data();
+
+        shaded += uint64_t(x1 - x0) * uint64_t(y1 - y0);
+
+    #if SPRITE_RASTER_SSE2
+        auto color   = _mm_loadu_ps(quad.Color);
+        auto scale   = _mm_mul_ps(color, _mm_set1_ps(kInv255));  // テクセル[0, 255] x 頂点カラー.
+        auto one     = _mm_set1_ps(1.0f);
+        auto c255    = _mm_set1_ps(255.0f);
+    #endif
+
+        for(auto y=y0; y<y1; ++y)
+        {
+            // 行内ではvが一定なので縦方向のフェッチ位置と重みは行毎に求める.
+            auto v   = quad.TexCoord[1] + (float(y) + 0.5f - quad.Origin[1]) * quad.Gradient[1];
+            auto ty  = v * float(texH) - 0.5f;
+            auto fy  = std::floor(ty);
+            auto wy  = ty - fy;
+            auto iy0 = asdx::Clamp<int>(int(fy),     0, texH - 1);
+            auto iy1 = asdx::Clamp<int>(int(fy) + 1, 0, texH - 1);
+            auto row0 = texel + size_t(iy0) * texW;
+            auto row1 = texel + size_t(iy1) * texW;
+
+            auto dstColor = &m_Color[size_t(y) * m_Width];
+
+            auto u  = quad.TexCoord[0] + (float(x0) + 0.5f - quad.Origin[0]) * quad.Gradient[0];
+            auto du = quad.Gradient[0];
+
+            for(auto x=x0; x<x1; ++x, u += du)
+            {
+                auto tx  = u * float(texW) - 0.5f;
+                auto fx  = std::floor(tx);
+                auto wx  = tx - fx;
+                auto ix0 = asdx::Clamp<int>(int(fx),     0, texW - 1);
+                auto ix1 = asdx::Clamp<int>(int(fx) + 1, 0, texW - 1);
+
+            #if SPRITE_RASTER_SSE2
+                // バイリニア補間.
+                auto t00 = LoadTexel(row0[ix0]);
+                auto t10 = LoadTexel(row0[ix1]);
+                auto t01 = LoadTexel(row1[ix0]);
+                auto t11 = LoadTexel(row1[ix1]);
+                auto vwx = _mm_set1_ps(wx);
+                auto upper = _mm_add_ps(t00, _mm_mul_ps(_mm_sub_ps(t10, t00), vwx));
+                auto lower = _mm_add_ps(t01, _mm_mul_ps(_mm_sub_ps(t11, t01), vwx));
+                auto smp  = _mm_add_ps(upper, _mm_mul_ps(_mm_sub_ps(lower, upper), _mm_set1_ps(wy)));
+
+                // テクスチャ x 頂点カラー.
+                auto src = _mm_mul_ps(smp, scale);
+                auto a   = _mm_cvtss_f32(_mm_shuffle_ps(src, src, _MM_SHUFFLE(3, 3, 3, 3)));
+
+                // α = 0 はブレンドしても変化しないので飛ばす.
+                if (a <= 0.0f)
+                { continue; }
+
+                // SRC_ALPHA / INV_SRC_ALPHA でブレンド.
+                auto va  = _mm_set1_ps(a);
+                auto dst = _mm_mul_ps(LoadTexel(dstColor[x]), _mm_set1_ps(kInv255));
+                auto out = _mm_add_ps(_mm_mul_ps(src, va), _mm_mul_ps(dst, _mm_sub_ps(one, va)));
+                out = _mm_min_ps(_mm_max_ps(_mm_mul_ps(out, c255), _mm_setzero_ps()), c255);
+                dstColor[x] = StoreTexel(out);
+            #else
+                float t00[4], t10[4], t01[4], t11[4], dst[4];
+                UnpackColor(row0[ix0], t00);
+                UnpackColor(row0[ix1], t10);
+                UnpackColor(row1[ix0], t01);
+                UnpackColor(row1[ix1], t11);
+                UnpackColor(dstColor[x], dst);
+
+                float src[4];
+                for(auto i=0; i<4; ++i)
+                {
+                    auto upper = t00[i] + (t10[i] - t00[i]) * wx;
+                    auto lower = t01[i] + (t11[i] - t01[i]) * wx;
+                    src[i] = (upper + (lower - upper) * wy) * quad.Color[i];
+                }
+
+                auto a = src[3];
+                if (a <= 0.0f)
+                { continue; }
+
+                for(auto i=0; i<4; ++i)
+                { dst[i] = src[i] * a + dst[i] * (1.0f - a); }
+
+                dstColor[x] = PackPixel(dst);
+            #endif
+            }
+        }
+    }
+
+    return shaded;
+}
+
+//-----------------------------------------------------------------------------
+//      スプライトを矩形に変換して記録します.
+//-----------------------------------------------------------------------------
+void SpriteSoftwareBackend::AddQuads(const SpriteInstance* pSprites, uint32_t count)
+{
+    const float kUVScale = 1.0f / 65535.0f;
+
+    // テクスチャが無いと全ピクセルが破棄されるので何もしない.
+    if (m_pCurrTexture == nullptr)
+    { return; }
+
+    for(auto i=0u; i<count; ++i)
+    {
+        auto& sprite = pSprites[i];
+
+        // SpriteInstVS.hlsl は深度を [0, 1] に丸めるので，レイヤーでは破棄しない.
+        // 深度テストも使わないので，前後関係は描画順だけで決まる.
+
+        // SpriteInstVS.hlsl と同じく，頂点0(左上)は (u0, v1), 頂点3(右下)は (u1, v0).
+        auto x0 = float(sprite.Rect[0]) * m_Scale[0] + m_Offset[0];
+        auto y0 = float(sprite.Rect[1]) * m_Scale[1] + m_Offset[1];
+        auto x1 = float(sprite.Rect[0] + sprite.Rect[2]) * m_Scale[0] + m_Offset[0];
+        auto y1 = float(sprite.Rect[1] + sprite.Rect[3]) * m_Scale[1] + m_Offset[1];
+        auto u0 = float(sprite.TexRect[0]) * kUVScale;
+        auto v0 = float(sprite.TexRect[1]) * kUVScale;
+        auto u1 = float(sprite.TexRect[2]) * kUVScale;
+        auto v1 = float(sprite.TexRect[3]) * kUVScale;
+
+        if (x0 == x1 || y0 == y1)
+        { continue; }
+
+        // ピクセル中心が内側にあるピクセルを塗る(左上ルール).
+        Quad quad;
+        quad.Bounds[0] = asdx::Max<int>(int(std::ceil(asdx::Min(x0, x1) - 0.5f)), m_Scissor[0]);
+        quad.Bounds[1] = asdx::Max<int>(int(std::ceil(asdx::Min(y0, y1) - 0.5f)), m_Scissor[1]);
+        quad.Bounds[2] = asdx::Min<int>(int(std::ceil(asdx::Max(x0, x1) - 0.5f)), m_Scissor[2]);
+        quad.Bounds[3] = asdx::Min<int>(int(std::ceil(asdx::Max(y0, y1) - 0.5f)), m_Scissor[3]);
+
+        if (quad.Bounds[0] >= quad.Bounds[2] || quad.Bounds[1] >= quad.Bounds[3])
+        { continue; }
+
+        quad.pTexture    = m_pCurrTexture;
+        quad.Origin  [0] = x0;
+        quad.Origin  [1] = y0;
+        quad.TexCoord[0] = u0;
+        quad.TexCoord[1] = v1;
+        quad.Gradient[0] = (u1 - u0) / (x1 - x0);
+        quad.Gradient[1] = (v0 - v1) / (y1 - y0);
+        UnpackColor(sprite.Color, quad.Color);
+
+        m_Quads.push_back(quad);
+    }
+}
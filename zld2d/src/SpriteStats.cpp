@@ -0,0 +1,159 @@
+﻿//-----------------------------------------------------------------------------
+// File : SpriteStats.cpp
+// Desc : Sprite Pipeline Statistics.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <SpriteStats.h>
+#include <cassert>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char* kStatNames[SPRITE_STAT_COUNT] = {
+    "submitted",
+    "dropped",
+    "culled",
+    "draw calls",
+    "texture switches",
+    "state changes",
+    "upload bytes",
+    "record us",
+    "submit us",
+};
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteFrameStats structure
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      全ての値を0にします.
+//-----------------------------------------------------------------------------
+void SpriteFrameStats::Clear()
+{
+    for(auto i=0; i<SPRITE_STAT_COUNT; ++i)
+    { Values[i] = 0; }
+}
+
+//-----------------------------------------------------------------------------
+//      値を加算します.
+//-----------------------------------------------------------------------------
+void SpriteFrameStats::Add(const SpriteFrameStats& other)
+{
+    for(auto i=0; i<SPRITE_STAT_COUNT; ++i)
+    { Values[i] += other.Values[i]; }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SpriteStats class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SpriteStats::SpriteStats()
+{ Reset(); }
+
+//-----------------------------------------------------------------------------
+//      履歴を破棄します.
+//-----------------------------------------------------------------------------
+void SpriteStats::Reset()
+{
+    for(auto i=0u; i<kSpriteStatsHistory; ++i)
+    { m_History[i].Clear(); }
+
+    for(auto i=0; i<SPRITE_STAT_COUNT; ++i)
+    { m_Sum[i] = 0; }
+
+    m_Head  = 0;
+    m_Count = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      1フレーム分の統計を追加します.
+//-----------------------------------------------------------------------------
+void SpriteStats::Push(const SpriteFrameStats& frame)
+{
+    // 平均は合計を差分更新して求める.
+    auto& slot = m_History[m_Head];
+    for(auto i=0; i<SPRITE_STAT_COUNT; ++i)
+    { m_Sum[i] += frame.Values[i] - slot.Values[i]; }
+
+    slot   = frame;
+    m_Head = (m_Head + 1) % kSpriteStatsHistory;
+
+    if (m_Count < kSpriteStatsHistory)
+    { m_Count++; }
+}
+
+//-----------------------------------------------------------------------------
+//      直前のフレームの統計を取得します.
+//-----------------------------------------------------------------------------
+const SpriteFrameStats& SpriteStats::GetLast() const
+{ return m_History[(m_Head + kSpriteStatsHistory - 1) % kSpriteStatsHistory]; }
+
+//-----------------------------------------------------------------------------
+//      履歴の最小・平均・最大を取得します.
+//-----------------------------------------------------------------------------
+SpriteStatSummary SpriteStats::GetSummary(SPRITE_STAT stat) const
+{
+    assert(stat < SPRITE_STAT_COUNT);
+
+    SpriteStatSummary result = {};
+    if (m_Count == 0)
+    { return result; }
+
+    result.Last = GetLast().Values[stat];
+    result.Min  = UINT64_MAX;
+    result.Max  = 0;
+    result.Avg  = double(m_Sum[stat]) / double(m_Count);
+
+    // 最小・最大は表示する時だけ必要なので，毎フレームは更新せずにここで走査する.
+    for(auto i=0u; i<m_Count; ++i)
+    {
+        auto value = GetHistory(stat, i);
+        if (value < result.Min) { result.Min = value; }
+        if (value > result.Max) { result.Max = value; }
+    }
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      古い順に i 番目のフレームの値を取得します.
+//-----------------------------------------------------------------------------
+uint64_t SpriteStats::GetHistory(SPRITE_STAT stat, uint32_t index) const
+{
+    assert(stat < SPRITE_STAT_COUNT);
+    assert(index < m_Count);
+
+    auto oldest = (m_Head + kSpriteStatsHistory - m_Count) % kSpriteStatsHistory;
+    return m_History[(oldest + index) % kSpriteStatsHistory].Values[stat];
+}
+
+//-----------------------------------------------------------------------------
+//      履歴に保持しているフレーム数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SpriteStats::GetFrameCount() const
+{ return m_Count; }
+
+//-----------------------------------------------------------------------------
+//      項目名を取得します.
+//-----------------------------------------------------------------------------
+const char* SpriteStats::GetName(SPRITE_STAT stat)
+{
+    if (stat >= SPRITE_STAT_COUNT)
+    { return "unknown"; }
+
+    return kStatNames[stat];
+}
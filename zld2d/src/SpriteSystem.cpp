@@ -10,43 +10,31 @@
 #include <SpriteSystem.h>
 #include <asdxMisc.h>
 #include <asdxLogger.h>
-#include <asdxRenderState.h>
+#include <algorithm>
+#include <cstring>
 #include <vector>
 
 
-namespace {
-
-#include "../../asdx11/res/shaders/Compiled/SpriteVS.inc"
-#include "../res/shader/Compiled/SpritePS.inc"
-
-} // namespace
-
-
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // SpriteSystem class
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-// 入力要素です.
-const D3D11_INPUT_ELEMENT_DESC SpriteSystem::InputElements[ SpriteSystem::InputElementCount ] = {
-    { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "VTXCOLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD", 0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
-};
-
 //-------------------------------------------------------------------------------------------------
 //      コンストラクタです.
 //-------------------------------------------------------------------------------------------------
 SpriteSystem::SpriteSystem()
-: m_pVS          ( nullptr )
-, m_pPS          ( nullptr )
-, m_pVB          ( nullptr )
-, m_pIB          ( nullptr )
-, m_pCB          ( nullptr )
-, m_pIL          ( nullptr )
-, m_SpriteCount  ( 0 )
+: m_pBackend     ( nullptr )
+, m_DrawCallCount( 0 )
+, m_UploadedBytes( 0 )
+, m_TextureSwitchCount( 0 )
+, m_StateChangeCount  ( 0 )
+, m_pBoundTexture     ( nullptr )
+, m_IsTextureBound    ( false )
+, m_IsRetainedBound   ( false )
+, m_EnableStats       ( false )
+, m_Sort         ( false )
 , m_ScreenSize   ( 1.0f, 1.0f )
-, m_Color        ( 1.0f, 1.0f, 1.0f, 1.0f )
 , m_Transform    ( asdx::Matrix::CreateIdentity() )
 { /* DO_NOTHING */ }
 
@@ -61,140 +49,28 @@ SpriteSystem::~SpriteSystem()
 //-------------------------------------------------------------------------------------------------
 bool SpriteSystem::Init
 (
-    ID3D11Device*   pDevice,
+    ISpriteBackend* pBackend,
     float           screenWidth,
     float           screenHeight
 )
 {
-    HRESULT hr = S_OK;
-
-    m_Vertices.resize(NUM_SPRITES * NUM_VERTEX_PER_SPRITE);
-    m_SRV.resize(NUM_SPRITES);
-
-    // 頂点バッファの生成.
-    {
-        // 頂点バッファの設定.
-        D3D11_BUFFER_DESC desc;
-        ZeroMemory( &desc, sizeof( D3D11_BUFFER_DESC ) );
-        desc.BindFlags      = D3D11_BIND_VERTEX_BUFFER;
-        desc.Usage          = D3D11_USAGE_DYNAMIC;
-        desc.ByteWidth      = sizeof( SpriteSystem::Vertex ) * NUM_SPRITES * NUM_VERTEX_PER_SPRITE;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-
-        // 頂点バッファの生成.
-        hr = pDevice->CreateBuffer( &desc, nullptr, m_pVB.GetAddress() );
-        if ( FAILED( hr ) )
-        {
-            // エラーログ出力.
-            ELOG( "Error : ID3D11Device::CreateBuffer() Failed." );
-            return false;
-        }
-    }
-
-    // インデックスバッファの生成.
-    {
-        // インデックスバッファの設定.
-        D3D11_BUFFER_DESC desc;
-        ZeroMemory( &desc, sizeof( D3D11_BUFFER_DESC ) );
-        desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        desc.Usage     = D3D11_USAGE_DEFAULT;
-        desc.ByteWidth = sizeof( uint16_t ) * NUM_SPRITES * NUM_INDEX_PER_SPRITE;
-
-        // インデックスバッファのメモリを確保.
-        std::vector< uint16_t > indices;
-        indices.reserve( NUM_SPRITES * NUM_INDEX_PER_SPRITE );
-
-        // インデックス設定.
-        for( uint16_t i=0; i<NUM_SPRITES * NUM_INDEX_PER_SPRITE; i+=NUM_VERTEX_PER_SPRITE )
-        {
-            indices.push_back( i + 0 );
-            indices.push_back( i + 1 );
-            indices.push_back( i + 2 );
-
-            indices.push_back( i + 1 );
-            indices.push_back( i + 3 );
-            indices.push_back( i + 2 );
-        }
-
-        // サブリソースデータの設定.
-        D3D11_SUBRESOURCE_DATA res;
-        ZeroMemory( &res, sizeof( D3D11_SUBRESOURCE_DATA ) );
-        res.pSysMem = &indices.front();
-
-        // インデックスバッファ生成.
-        hr = pDevice->CreateBuffer( &desc, &res, m_pIB.GetAddress() );
-        if ( FAILED( hr ) )
-        {
-            // エラーログ出力.
-            ELOG( "Error : ID3D11Device::CreateBuffer() Failed." );
-
-            // インデックスをクリア.
-            indices.clear();
-
-            // 異常終了.
-            return false;
-        }
-
-        // インデックスをクリア.
-        indices.clear();
-    }
-
-    // 頂点シェーダの生成.
+    if ( pBackend == nullptr )
     {
-        // 頂点シェーダ生成.
-        hr = pDevice->CreateVertexShader( SpriteVS, sizeof( SpriteVS ), nullptr, m_pVS.GetAddress() );
-        if ( FAILED( hr ) )
-        {
-            // エラーログ出力.
-            ELOG( "Error : ID3D11Device::CreateVertexShader() Failed." );
-
-            // 異常終了.
-            return false;
-        }
-        
-        // 入力レイアウトを生成.
-        hr = pDevice->CreateInputLayout( SpriteSystem::InputElements, SpriteSystem::InputElementCount, SpriteVS, sizeof( SpriteVS ), m_pIL.GetAddress() );
-        if ( FAILED( hr ) )
-        {
-            // エラーログ出力.
-            ELOG( "Error : ID3D11Device::CreateInputLayout() Failed. ");
-
-            // 異常終了.
-            return false;
-        }
+        ELOG( "Error : Invalid Argument." );
+        return false;
     }
 
-    {
-        // ピクセルシェーダ生成.
-        hr = pDevice->CreatePixelShader( SpritePS, sizeof( SpritePS ), nullptr, m_pPS.GetAddress() );
-        if ( FAILED( hr ) )
-        {
-            ELOG( "Error : ID3D11Device::CreatePixelShader() Failed." );
-
-            return false;
-        }
-    }
+    m_pBackend = pBackend;
 
-    // 定数バッファの生成.
-    {
-        // 定数バッファの設定.
-        D3D11_BUFFER_DESC desc;
-        ZeroMemory( &desc, sizeof( D3D11_BUFFER_DESC ) );
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        desc.ByteWidth = sizeof( asdx::Matrix );
-        desc.Usage     = D3D11_USAGE_DEFAULT;
-
-        // 定数バッファ生成.
-        hr = pDevice->CreateBuffer( &desc, nullptr, m_pCB.GetAddress() );
-        if ( FAILED( hr ) )
-        {
-            // エラーログ出力.
-            ELOG( "Error : ID3D11Device::CreateBuffer() Failed." );
+    m_Recorder.Reserve(NUM_SPRITES);
+    m_Batch   .Reserve(NUM_SPRITES);
 
-            // 異常終了.
-            return false;
-        }
-    }
+    // 常駐インスタンスバッファ全体を空き領域にする.
+    RetainedRegion region;
+    region.Offset = 0;
+    region.Count  = kSpriteRetainedCapacity;
+    m_FreeRegions.clear();
+    m_FreeRegions.push_back(region);
 
     SetScreenSize( screenWidth, screenHeight );
 
@@ -206,20 +82,22 @@ bool SpriteSystem::Init
 //-------------------------------------------------------------------------------------------------
 void SpriteSystem::Term()
 {
-    m_pVS.Reset();
-    m_pPS.Reset();
-    m_pVB.Reset();
-    m_pIB.Reset();
-    m_pCB.Reset();
-    m_pIL.Reset();
+    m_pBackend = nullptr;
 
     m_ScreenSize.x  = 0.0f;
     m_ScreenSize.y  = 0.0f;
-    m_Color         = asdx::Vector4( 1.0f, 1.0f, 1.0f, 1.0f );
-    m_SpriteCount   = 0;
-
-    m_Vertices.clear();
-    m_SRV     .clear();
+    m_DrawCallCount = 0;
+    m_UploadedBytes = 0;
+
+    m_RetainedLists.clear();
+    m_FreeRegions  .clear();
+    m_DirtyRanges  .clear();
+    m_RetainedCommands.clear();
+
+    m_Recorder.SetColor( 1.0f, 1.0f, 1.0f, 1.0f );
+    m_Recorder.ResetCullRect();
+    m_Recorder.Release();
+    m_Batch   .Clear();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -244,13 +122,96 @@ void SpriteSystem::SetScreenSize( float width, float height )
 //      頂点カラーを設定します.
 //-------------------------------------------------------------------------------------------------
 void SpriteSystem::SetColor( float r, float g, float b, float a )
+{ m_Recorder.SetColor( r, g, b, a ); }
+
+//-------------------------------------------------------------------------------------------------
+//      カリング矩形を設定します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::SetCullRect( const Box& rect )
+{ m_Recorder.SetCullRect( rect ); }
+
+//-------------------------------------------------------------------------------------------------
+//      カリング矩形を解除します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::ResetCullRect()
+{ m_Recorder.ResetCullRect(); }
+
+//-------------------------------------------------------------------------------------------------
+//      描画前にスプライトをソートするかどうかを設定します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::SetSortMode( bool enable )
+{ m_Sort = enable; }
+
+//-------------------------------------------------------------------------------------------------
+//      描画前にスプライトをソートするかどうか?
+//-------------------------------------------------------------------------------------------------
+bool SpriteSystem::GetSortMode() const
+{ return m_Sort; }
+
+//-------------------------------------------------------------------------------------------------
+//      直前の End() で発行したドローコール数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t SpriteSystem::GetDrawCallCount() const
+{ return m_DrawCallCount; }
+
+//-------------------------------------------------------------------------------------------------
+//      直前の End() でバックエンドに転送したバイト数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint64_t SpriteSystem::GetUploadedBytes() const
+{ return m_UploadedBytes; }
+
+//-------------------------------------------------------------------------------------------------
+//      統計を集計するかどうかを設定します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::SetStatsEnabled( bool enable )
+{
+    m_EnableStats = enable;
+    m_FrameStats.Clear();
+    m_BeginTime = StatsClock::now();
+}
+
+//-------------------------------------------------------------------------------------------------
+//      統計を集計するかどうか?
+//-------------------------------------------------------------------------------------------------
+bool SpriteSystem::IsStatsEnabled() const
+{ return m_EnableStats; }
+
+//-------------------------------------------------------------------------------------------------
+//      1フレーム分の統計を確定し，履歴に追加します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::FlushStats()
 {
-    m_Color.x = r;
-    m_Color.y = g;
-    m_Color.z = b;
-    m_Color.w = a;
+    if ( !m_EnableStats )
+    { return; }
+
+    m_Stats.Push( m_FrameStats );
+    m_FrameStats.Clear();
 }
 
+//-------------------------------------------------------------------------------------------------
+//      統計の履歴を取得します.
+//-------------------------------------------------------------------------------------------------
+const SpriteStats& SpriteSystem::GetStats() const
+{ return m_Stats; }
+
+//-------------------------------------------------------------------------------------------------
+//      現在のフレームで記録されたスプライト数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t SpriteSystem::GetSpriteCount() const
+{ return m_Recorder.GetCount(); }
+
+//-------------------------------------------------------------------------------------------------
+//      上限を超えて破棄されたスプライト数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t SpriteSystem::GetDroppedCount() const
+{ return m_Recorder.GetDroppedCount(); }
+
+//-------------------------------------------------------------------------------------------------
+//      カリングされたスプライト数を取得します.
+//-------------------------------------------------------------------------------------------------
+uint32_t SpriteSystem::GetCulledCount() const
+{ return m_Recorder.GetCulledCount(); }
+
 //-------------------------------------------------------------------------------------------------
 //      スクリーンサイズを取得します.
 //-------------------------------------------------------------------------------------------------
@@ -261,200 +222,352 @@ asdx::Vector2 SpriteSystem::GetScreenSize() const
 //      頂点カラーを取得します.
 //-------------------------------------------------------------------------------------------------
 asdx::Vector4 SpriteSystem::GetColor() const
-{ return m_Color; }
+{ return m_Recorder.GetColor(); }
 
 //-------------------------------------------------------------------------------------------------
 //      描画開始処理です.
 //-------------------------------------------------------------------------------------------------
-void SpriteSystem::Begin( ID3D11DeviceContext* pDeviceContext )
+void SpriteSystem::Begin()
 {
     // スプライト数をリセット.
-    m_SpriteCount = 0;
-
-    // プリミティブトポロジーを設定します.
-    pDeviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-
-    // 入力レイアウトを設定します.
-    pDeviceContext->IASetInputLayout( m_pIL.GetPtr() );
-
-    ID3D11VertexShader* pVS = m_pVS.GetPtr();
-    ID3D11PixelShader*  pPS = m_pPS.GetPtr();
-
-    // シェーダを設定します.
-    pDeviceContext->VSSetShader( pVS,     nullptr, 0 );
-    pDeviceContext->PSSetShader( pPS,     nullptr, 0 );
-    pDeviceContext->GSSetShader( nullptr, nullptr, 0 );
-    pDeviceContext->HSSetShader( nullptr, nullptr, 0 );
-    pDeviceContext->DSSetShader( nullptr, nullptr, 0 );
+    m_Recorder.Reset();
+    m_Batch   .Clear();
+    m_RetainedLists.clear();
 
-    uint32_t stride = sizeof( SpriteSystem::Vertex );
-    uint32_t offset = 0;
-
-    // 頂点バッファとインデックスバッファを設定します.
-    pDeviceContext->IASetVertexBuffers( 0, 1, m_pVB.GetAddress(), &stride, &offset );
-    pDeviceContext->IASetIndexBuffer( m_pIB.GetPtr(), DXGI_FORMAT_R16_UINT, 0 );
-
-    // 定数バッファを更新し，設定します.
-    pDeviceContext->UpdateSubresource( m_pCB.GetPtr(), 0, nullptr, &m_Transform, 0, 0 );
-    pDeviceContext->VSSetConstantBuffers( 0, 1, m_pCB.GetAddress() );
+    if ( m_EnableStats )
+    { m_BeginTime = StatsClock::now(); }
 }
 
 //-------------------------------------------------------------------------------------------------
 //      頂点バッファを更新します.
 //-------------------------------------------------------------------------------------------------
-void SpriteSystem::Draw(ID3D11ShaderResourceView* pSRV, const Box& box)
-{ Draw(pSRV, box.Pos.x, box.Pos.y, box.Size.x, box.Size.y, asdx::Vector2(0.0f, 0.0f), asdx::Vector2(1.0f, 1.0f), 0); }
+void SpriteSystem::Draw(const TextureRegion& texture, const Box& box)
+{ Draw(texture, box.Pos.x, box.Pos.y, box.Size.x, box.Size.y, asdx::Vector2(0.0f, 0.0f), asdx::Vector2(1.0f, 1.0f), 0); }
 
 //-------------------------------------------------------------------------------------------------
 //      頂点バッファを更新します.
 //-------------------------------------------------------------------------------------------------
-void SpriteSystem::Draw(ID3D11ShaderResourceView* pSRV, const Box& box, int layerDepth)
-{ Draw(pSRV, box.Pos.x, box.Pos.y, box.Size.x, box.Size.y, asdx::Vector2(0.0f, 0.0f), asdx::Vector2(1.0f, 1.0f), layerDepth); }
+void SpriteSystem::Draw(const TextureRegion& texture, const Box& box, int layerDepth)
+{ Draw(texture, box.Pos.x, box.Pos.y, box.Size.x, box.Size.y, asdx::Vector2(0.0f, 0.0f), asdx::Vector2(1.0f, 1.0f), layerDepth); }
 
 //-------------------------------------------------------------------------------------------------
 //      頂点バッファを更新します.
 //-------------------------------------------------------------------------------------------------
-void SpriteSystem::Draw(ID3D11ShaderResourceView* pSRV, const int x, const int y, const int w, const int h )
-{ Draw(pSRV, x, y, w, h, asdx::Vector2( 0.0f, 0.0f ), asdx::Vector2( 1.0f, 1.0f ), 0 ); }
+void SpriteSystem::Draw(const TextureRegion& texture, const int x, const int y, const int w, const int h )
+{ Draw(texture, x, y, w, h, asdx::Vector2( 0.0f, 0.0f ), asdx::Vector2( 1.0f, 1.0f ), 0 ); }
 
 //-------------------------------------------------------------------------------------------------
 //      頂点バッファを更新します.
 //-------------------------------------------------------------------------------------------------
-void SpriteSystem::Draw(ID3D11ShaderResourceView* pSRV, const int x, const int y, const int w, const int h, const asdx::Vector2& uv0, const asdx::Vector2& uv1 )
-{ Draw(pSRV, x, y, w, h, uv0, uv1, 0 ); }
+void SpriteSystem::Draw(const TextureRegion& texture, const int x, const int y, const int w, const int h, const asdx::Vector2& uv0, const asdx::Vector2& uv1 )
+{ Draw(texture, x, y, w, h, uv0, uv1, 0 ); }
 
 //-------------------------------------------------------------------------------------------------
 //      頂点バッファを更新します.
 //-------------------------------------------------------------------------------------------------
-void SpriteSystem::Draw(ID3D11ShaderResourceView* pSRV, const int x, const int y, const int w, const int h, const int layerDepth )
-{ Draw(pSRV, x, y, w, h, asdx::Vector2( 0.0f, 0.0f ), asdx::Vector2( 1.0f, 1.0f ), layerDepth ); }
+void SpriteSystem::Draw(const TextureRegion& texture, const int x, const int y, const int w, const int h, const int layerDepth )
+{ Draw(texture, x, y, w, h, asdx::Vector2( 0.0f, 0.0f ), asdx::Vector2( 1.0f, 1.0f ), layerDepth ); }
 
 //-------------------------------------------------------------------------------------------------
 //      頂点バッファを更新します.
 //-------------------------------------------------------------------------------------------------
-void SpriteSystem::Draw(ID3D11ShaderResourceView* pSRV, const int x, const int y, const int w, const int h, const asdx::Vector2& uv0, const asdx::Vector2& uv1, const int layerDepth )
+void SpriteSystem::Draw(const TextureRegion& texture, const int x, const int y, const int w, const int h, const asdx::Vector2& uv0, const asdx::Vector2& uv1, const int layerDepth )
+{ m_Recorder.Draw( texture, x, y, w, h, uv0, uv1, layerDepth ); }
+
+//-------------------------------------------------------------------------------------------------
+//      スプライトをまとめて描画します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::DrawBatch( const SpriteDesc* pDescs, uint32_t count )
+{ m_Recorder.DrawBatch( pDescs, count ); }
+
+//-------------------------------------------------------------------------------------------------
+//      パック済みのスプライトを平行移動して描画します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::DrawInstances
+(
+    const SpriteInstance*               pInstances,
+    ID3D11ShaderResourceView* const*    ppSRV,
+    uint32_t                            count,
+    int                                 offsetX,
+    int                                 offsetY,
+    int                                 layerDepth
+)
+{ m_Recorder.DrawInstances( pInstances, ppSRV, count, offsetX, offsetY, layerDepth ); }
+
+//-------------------------------------------------------------------------------------------------
+//      別スレッドで記録したスプライトを追加します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::Submit( const SpriteRecorder& recorder )
+{ m_Recorder.Append( recorder ); }
+
+//-------------------------------------------------------------------------------------------------
+//      常駐スプライトのリストを描画します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::DrawRetained( SpriteRetainedList& list )
+{ m_RetainedLists.push_back( &list ); }
+
+//-------------------------------------------------------------------------------------------------
+//      常駐スプライトのリストに割り当てた領域を解放します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::ReleaseRetained( SpriteRetainedList& list )
 {
-    // 最大スプライト数を超えないかチェック.
-    if ( m_SpriteCount + 1 > NUM_SPRITES )
+    if ( list.m_Region == UINT32_MAX )
     { return; }
 
-    float posX = static_cast<float>( x );
-    float posY = static_cast<float>( y );
-
-    float width   = static_cast<float>( w );
-    float height  = static_cast<float>( h );
-    float depth   = static_cast<float>( layerDepth );
-    float surface = 0.0f;
-
-    // 頂点データのポインタ取得.
-    auto pVertices = &m_Vertices[ m_SpriteCount * NUM_VERTEX_PER_SPRITE ];
-
-    // テクスチャ座標
-    float u0 = uv0.x;
-    float u1 = uv1.x;
-    float v0 = uv0.y;
-    float v1 = uv1.y;
-
-    // 位置座標.
-    float x0 = posX;
-    float x1 = posX + width;
-    float y0 = posY;
-    float y1 = posY + height;
-
-    // Vertex : 0
-    pVertices[ 0 ].Position.x = x0;
-    pVertices[ 0 ].Position.y = y0;
-    pVertices[ 0 ].Position.z = depth;
-    pVertices[ 0 ].Color      = m_Color;
-    pVertices[ 0 ].TexCoord.x = u0;
-    pVertices[ 0 ].TexCoord.y = v1;
-    pVertices[ 0 ].TexCoord.z = surface;
-
-    // Vertex : 1
-    pVertices[ 1 ].Position.x = x1;
-    pVertices[ 1 ].Position.y = y0;
-    pVertices[ 1 ].Position.z = depth;
-    pVertices[ 1 ].Color      = m_Color;
-    pVertices[ 1 ].TexCoord.x = u1;
-    pVertices[ 1 ].TexCoord.y = v1;
-    pVertices[ 1 ].TexCoord.z = surface;
-
-    // Vertex : 2
-    pVertices[ 2 ].Position.x = x0;
-    pVertices[ 2 ].Position.y = y1;
-    pVertices[ 2 ].Position.z = depth;
-    pVertices[ 2 ].Color      = m_Color;
-    pVertices[ 2 ].TexCoord.x = u0;
-    pVertices[ 2 ].TexCoord.y = v0;
-    pVertices[ 2 ].TexCoord.z = surface;
-
-    // Vertex : 3
-    pVertices[ 3 ].Position.x = x1;
-    pVertices[ 3 ].Position.y = y1;
-    pVertices[ 3 ].Position.z = depth;
-    pVertices[ 3 ].Color      = m_Color;
-    pVertices[ 3 ].TexCoord.x = u1;
-    pVertices[ 3 ].TexCoord.y = v0;
-    pVertices[ 3 ].TexCoord.z = surface;
-
-    m_SRV[m_SpriteCount] = pSRV;
-
-    // スプライト数をカウントアップします.
-    m_SpriteCount++;
+    FreeRegion( list.m_Region, list.m_RegionSize );
+    list.m_Region     = UINT32_MAX;
+    list.m_RegionSize = 0;
 }
 
 //-------------------------------------------------------------------------------------------------
 //      描画終了処理です.
 //-------------------------------------------------------------------------------------------------
-void SpriteSystem::End( ID3D11DeviceContext* pDeviceContext )
+void SpriteSystem::End()
 {
-    D3D11_MAPPED_SUBRESOURCE mappedBuffer;
+    m_DrawCallCount      = 0;
+    m_TextureSwitchCount = 0;
+    m_StateChangeCount   = 0;
+    m_UploadedBytes      = 0;
 
-    // マップします.
-    auto hr = pDeviceContext->Map( m_pVB.GetPtr(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer );
-    if ( FAILED( hr ) )
+    if ( m_pBackend == nullptr )
     { return; }
 
-    // 頂点データのポインタ取得.
-    auto pVertices = reinterpret_cast<SpriteSystem::Vertex*>(mappedBuffer.pData);
+    // 無効時は時刻も取らない.
+    auto start = ( m_EnableStats ) ? StatsClock::now() : StatsClock::time_point();
+
+    // レイヤー順(奥から手前)に並べ，同じテクスチャ・レイヤーが連続する区間をまとめ,
+    // ページ単位に分割した描画コマンドを構築. 深度テストは使わない.
+    m_Batch.Build(
+        m_Recorder.GetInstances(),
+        m_Recorder.GetTextures(),
+        m_Recorder.GetCount(),
+        m_Sort,
+        NUM_SPRITES );
+
+    m_pBackend->Begin( m_Transform );
+    m_pBoundTexture    = nullptr;
+    m_IsTextureBound   = false;
+    m_IsRetainedBound  = false;
+    m_StateChangeCount = 1;
+
+    // 常駐スプライトは変更のあった範囲だけを先に転送しておく.
+    m_RetainedCommands.clear();
+    for(auto pList : m_RetainedLists)
+    { UploadRetained( *pList ); }
+
+    std::stable_sort( m_RetainedCommands.begin(), m_RetainedCommands.end(),
+        []( const SpriteDrawCommand& lhs, const SpriteDrawCommand& rhs )
+        { return lhs.Layer > rhs.Layer; } );
+
+    // スプライトを描画. 同じテクスチャの区間は1回のドローコールで描く.
+    // ページが切り替わったらインスタンスバッファを詰め直してから描画を続ける.
+    // 常駐スプライトは奥にあるものから順に間に挟む.
+    auto retained = m_RetainedCommands.begin();
+    auto currPage = UINT32_MAX;
+    for(auto& cmd : m_Batch.GetCommands())
+    {
+        for(; retained != m_RetainedCommands.end() && retained->Layer > cmd.Layer; ++retained)
+        { IssueDraw( *retained, true ); }
+
+        if ( cmd.Page != currPage )
+        {
+            if ( !UploadPage( cmd.Page ) )
+            { break; }
+
+            currPage = cmd.Page;
+        }
+
+        IssueDraw( cmd, false );
+    }
+
+    // 残りの常駐スプライトを描画.
+    for(; retained != m_RetainedCommands.end(); ++retained)
+    { IssueDraw( *retained, true ); }
+
+    m_pBackend->End();
+
+    if ( m_EnableStats )
+    { AccumulateStats( start ); }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      1ページ分のインスタンスデータをバックエンドに転送します.
+//-------------------------------------------------------------------------------------------------
+bool SpriteSystem::UploadPage( uint32_t page )
+{
+    auto first = page * uint32_t( NUM_SPRITES );
+    auto count = asdx::Min<uint32_t>( m_Recorder.GetCount() - first, uint32_t( NUM_SPRITES ) );
+
+    // 書き込み先を取得します.
+    auto pInstances = m_pBackend->MapPage( count );
+    if ( pInstances == nullptr )
+    { return false; }
 
-    // がばっとコピる.
-    memcpy( pVertices, m_Vertices.data(), sizeof( SpriteSystem::Vertex ) * m_SpriteCount * NUM_VERTEX_PER_SPRITE );
+    auto pSrc = m_Recorder.GetInstances();
+    if ( m_Batch.IsSorted() )
+    {
+        // 描画順に並べ替えながらコピー.
+        auto& order = m_Batch.GetOrder();
+        for( auto i=0u; i<count; ++i )
+        { pInstances[ i ] = pSrc[ order[ first + i ] ]; }
+    }
+    else
+    {
+        // がばっとコピる.
+        memcpy( pInstances, pSrc + first, sizeof( SpriteInstance ) * count );
+    }
 
-    // アンマップします.
-    pDeviceContext->Unmap( m_pVB.GetPtr(), 0 );
+    m_pBackend->UnmapPage();
+    m_UploadedBytes += sizeof( SpriteInstance ) * count;
 
-    ID3D11ShaderResourceView* pPrevSRV = nullptr;
+    return true;
+}
 
-    auto pSmp = asdx::RenderState::GetInstance().GetSmp(asdx::SamplerType::LinearClamp);
-    pDeviceContext->PSSetSamplers(0, 1, &pSmp);
+//-------------------------------------------------------------------------------------------------
+//      常駐スプライトのリストの変更をバックエンドに転送し，描画コマンドを集めます.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::UploadRetained( SpriteRetainedList& list )
+{
+    list.Flush();
 
-    // スプライトを描画.
-    uint32_t offset = 0;
-    for(auto i=0u; i<m_SpriteCount; ++i)
+    // 初めて描画する場合は領域を確保して全体を転送する.
+    if ( list.m_Region == UINT32_MAX )
     {
-        auto pSRV = m_SRV[i];
-        if (pPrevSRV != pSRV)
+        auto offset = AllocRegion( list.GetCapacity() );
+        if ( offset == UINT32_MAX )
         {
-            pDeviceContext->PSSetShaderResources(0, 1, &pSRV);
-            pPrevSRV = pSRV;
+            ELOGA( "Error : Retained sprite buffer is full. capacity = %u", list.GetCapacity() );
+            return;
         }
 
-        pDeviceContext->DrawIndexed( NUM_INDEX_PER_SPRITE, offset, 0 );
-        offset += NUM_INDEX_PER_SPRITE;
+        list.m_Region     = offset;
+        list.m_RegionSize = list.GetCapacity();
+        list.MarkAllDirty();
     }
 
-    // シェーダをアンバイド.
-    pDeviceContext->VSSetShader( nullptr, nullptr, 0 );
-    pDeviceContext->PSSetShader( nullptr, nullptr, 0 );
-    pDeviceContext->GSSetShader( nullptr, nullptr, 0 );
-    pDeviceContext->HSSetShader( nullptr, nullptr, 0 );
-    pDeviceContext->DSSetShader( nullptr, nullptr, 0 );
- 
-    ID3D11ShaderResourceView* pNullSRV[ 1 ] = { nullptr };
-    ID3D11SamplerState*       pNullSmp[ 1 ] = { nullptr };
-    pDeviceContext->PSSetShaderResources( 0, 1, pNullSRV );
-    pDeviceContext->PSSetSamplers( 0, 1, pNullSmp );
+    auto pSrc = list.GetInstances();
+    list.GetDirtyRanges( m_DirtyRanges );
+    for(auto& range : m_DirtyRanges)
+    {
+        if ( m_pBackend->UpdateRetained( list.m_Region + range.Start, pSrc + range.Start, range.Count ) )
+        { m_UploadedBytes += sizeof( SpriteInstance ) * range.Count; }
+    }
+    list.ClearDirty();
+
+    for(auto cmd : list.GetCommands())
+    {
+        cmd.Start += list.m_Region;
+        m_RetainedCommands.push_back( cmd );
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      常駐インスタンスバッファの領域を確保します.
+//-------------------------------------------------------------------------------------------------
+uint32_t SpriteSystem::AllocRegion( uint32_t count )
+{
+    // 最初に見つかった十分な大きさの空き領域から切り出す.
+    for(auto itr = m_FreeRegions.begin(); itr != m_FreeRegions.end(); ++itr)
+    {
+        if ( itr->Count < count )
+        { continue; }
+
+        auto offset = itr->Offset;
+        itr->Offset += count;
+        itr->Count  -= count;
+
+        if ( itr->Count == 0 )
+        { m_FreeRegions.erase( itr ); }
+
+        return offset;
+    }
+
+    return UINT32_MAX;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      常駐インスタンスバッファの領域を解放します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::FreeRegion( uint32_t offset, uint32_t count )
+{
+    // 開始位置順に挿入し，隣接する空き領域と結合する.
+    auto itr = m_FreeRegions.begin();
+    while ( itr != m_FreeRegions.end() && itr->Offset < offset )
+    { ++itr; }
+
+    RetainedRegion region;
+    region.Offset = offset;
+    region.Count  = count;
+    itr = m_FreeRegions.insert( itr, region );
+
+    auto next = itr + 1;
+    if ( next != m_FreeRegions.end() && itr->Offset + itr->Count == next->Offset )
+    {
+        itr->Count += next->Count;
+        m_FreeRegions.erase( next );
+    }
+
+    if ( itr != m_FreeRegions.begin() )
+    {
+        auto prev = itr - 1;
+        if ( prev->Offset + prev->Count == itr->Offset )
+        {
+            prev->Count += itr->Count;
+            m_FreeRegions.erase( itr );
+        }
+    }
 }
 
+//-------------------------------------------------------------------------------------------------
+//      描画コマンドを発行します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::IssueDraw( const SpriteDrawCommand& cmd, bool retained )
+{
+    // 同じテクスチャが続く場合は設定し直さない.
+    if ( !m_IsTextureBound || m_pBoundTexture != cmd.pTexture )
+    {
+        auto pSRV = static_cast<ID3D11ShaderResourceView*>(const_cast<void*>(cmd.pTexture));
+        m_pBackend->SetTexture( pSRV );
+
+        m_pBoundTexture  = cmd.pTexture;
+        m_IsTextureBound = true;
+        m_TextureSwitchCount++;
+    }
+
+    // ページと常駐インスタンスバッファの切り替えはバックエンドで頂点バッファの差し替えになる.
+    if ( m_IsRetainedBound != retained )
+    {
+        m_IsRetainedBound = retained;
+        m_StateChangeCount++;
+    }
+
+    if ( retained )
+    { m_pBackend->DrawRetained( cmd.Start, cmd.Count ); }
+    else
+    { m_pBackend->Draw( cmd.Start, cmd.Count ); }
 
+    m_DrawCallCount++;
+}
+
+//-------------------------------------------------------------------------------------------------
+//      End() の統計を現在のフレームに加算します.
+//-------------------------------------------------------------------------------------------------
+void SpriteSystem::AccumulateStats( const StatsClock::time_point& start )
+{
+    auto end = StatsClock::now();
+
+    auto submitted = uint64_t( m_Recorder.GetCount() );
+    for(auto pList : m_RetainedLists)
+    { submitted += pList->GetCount(); }
+
+    auto& values = m_FrameStats.Values;
+    values[ SPRITE_STAT_SUBMITTED ]        += submitted;
+    values[ SPRITE_STAT_DROPPED ]          += m_Recorder.GetDroppedCount();
+    values[ SPRITE_STAT_CULLED ]           += m_Recorder.GetCulledCount();
+    values[ SPRITE_STAT_DRAW_CALLS ]       += m_DrawCallCount;
+    values[ SPRITE_STAT_TEXTURE_SWITCHES ] += m_TextureSwitchCount;
+    values[ SPRITE_STAT_STATE_CHANGES ]    += m_StateChangeCount;
+    values[ SPRITE_STAT_UPLOAD_BYTES ]     += m_UploadedBytes;
+    values[ SPRITE_STAT_RECORD_TIME ]      += std::chrono::duration_cast<std::chrono::microseconds>( start - m_BeginTime ).count();
+    values[ SPRITE_STAT_SUBMIT_TIME ]      += std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+}
@@ -167,6 +167,24 @@ void Switcher::Update(float elapsedTime, const asdx::Vector2& player)
 bool Switcher::IsDraw() const
 { return m_Type != SWITCH_TYPE_NONE; }
 
+//-----------------------------------------------------------------------------
+//      合成カラーを取得します.
+//-----------------------------------------------------------------------------
+const asdx::Vector4& Switcher::GetColor() const
+{ return m_Color; }
+
+//-----------------------------------------------------------------------------
+//      穴の中心(テクスチャ座標)を取得します.
+//-----------------------------------------------------------------------------
+const asdx::Vector2& Switcher::GetCenter() const
+{ return m_Center; }
+
+//-----------------------------------------------------------------------------
+//      穴の半径を取得します. 0以下ならフェードです.
+//-----------------------------------------------------------------------------
+float Switcher::GetRadius() const
+{ return m_Radius; }
+
 //-----------------------------------------------------------------------------
 //      シェーダをバインドします.
 //-----------------------------------------------------------------------------
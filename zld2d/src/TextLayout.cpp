@@ -0,0 +1,472 @@
+﻿//-----------------------------------------------------------------------------
+// File : TextLayout.cpp
+// Desc : Text Layout.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TextLayout.h>
+#include <algorithm>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint64_t kFnvOffset = 0xcbf29ce484222325ull;   // FNV-1a 初期値.
+static const uint64_t kFnvPrime  = 0x00000100000001b3ull;   // FNV-1a 乗数.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CodeTable structure
+///////////////////////////////////////////////////////////////////////////////
+struct CodeTable
+{
+    std::vector<uint32_t>   Codes;
+
+    explicit CodeTable(const char16_t* chars)
+    {
+        for(; *chars != u'\0'; ++chars)
+        { Codes.push_back(uint32_t(*chars)); }
+
+        std::sort(Codes.begin(), Codes.end());
+    }
+
+    bool Contains(uint32_t code) const
+    { return std::binary_search(Codes.begin(), Codes.end(), code); }
+};
+
+// 行頭禁則文字.
+static const CodeTable kNoStart(
+    u")]}>,.!?:;%"
+    u"、。，．・：；？！゛゜ヽヾゝゞ々ー〜～…‥％"
+    u"）］｝〉》」』】〕〗〙〟’”"
+    u"ぁぃぅぇぉっゃゅょゎゕゖァィゥェォッャュョヮヵヶ"
+    u"｡｣､･ｰｧｨｩｪｫｯｬｭｮ");
+
+// 行末禁則文字.
+static const CodeTable kNoEnd(
+    u"([{<"
+    u"（［｛〈《「『【〔〖〘〝‘“｢");
+
+// ぶら下げを許す文字.
+static const CodeTable kHanging(
+    u",."
+    u"、。，．｡､");
+
+//-----------------------------------------------------------------------------
+//      空白かどうか?
+//-----------------------------------------------------------------------------
+inline bool IsSpace(uint32_t code)
+{ return code == 0x20 || code == 0x09 || code == 0x3000; }
+
+//-----------------------------------------------------------------------------
+//      和文など，文字間で折り返せる文字かどうか?
+//-----------------------------------------------------------------------------
+inline bool IsWide(uint32_t code)
+{ return code >= 0x2E80; }
+
+//-----------------------------------------------------------------------------
+//      2文字の間で改行できるかどうか?
+//-----------------------------------------------------------------------------
+bool CanBreak(uint32_t prev, uint32_t code)
+{
+    // 空白の並びの途中では改行せず，空白の後ろで改行する.
+    if (IsSpace(code))
+    { return false; }
+
+    if (IsSpace(prev))
+    { return !TextLayout::IsNoStart(code); }
+
+    if (TextLayout::IsNoEnd(prev) || TextLayout::IsNoStart(code))
+    { return false; }
+
+    return IsWide(prev) || IsWide(code);
+}
+
+//-----------------------------------------------------------------------------
+//      UTF-16 の次の文字を取得し，読み取り位置を進めます.
+//-----------------------------------------------------------------------------
+uint32_t NextCode(const wchar_t*& text)
+{
+    uint32_t code = uint32_t(*text++);
+
+    // wchar_t が UTF-16 の場合はサロゲートペアを結合する.
+    if (sizeof(wchar_t) == 2 && 0xD800 <= code && code <= 0xDBFF)
+    {
+        uint32_t low = uint32_t(*text);
+        if (0xDC00 <= low && low <= 0xDFFF)
+        {
+            text++;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+    }
+
+    return code;
+}
+
+//-----------------------------------------------------------------------------
+//      UTF-8 の次の文字を取得し，読み取り位置を進めます.
+//-----------------------------------------------------------------------------
+uint32_t NextCode(const char*& text)
+{
+    auto c = uint8_t(*text++);
+    if (c < 0x80)
+    { return c; }
+
+    uint32_t code  = 0;
+    uint32_t count = 0;
+    if      ((c & 0xE0) == 0xC0) { code = c & 0x1F; count = 1; }
+    else if ((c & 0xF0) == 0xE0) { code = c & 0x0F; count = 2; }
+    else if ((c & 0xF8) == 0xF0) { code = c & 0x07; count = 3; }
+    else
+    { return 0xFFFD; }
+
+    for(auto i=0u; i<count; ++i)
+    {
+        // 途中で途切れている場合は置換文字にして，続きのバイトは次の文字として読む.
+        auto next = uint8_t(*text);
+        if ((next & 0xC0) != 0x80)
+        { return 0xFFFD; }
+
+        code = (code << 6) | (next & 0x3F);
+        text++;
+    }
+
+    return code;
+}
+
+//-----------------------------------------------------------------------------
+//      テキストのハッシュ値と長さを求めます.
+//-----------------------------------------------------------------------------
+template<typename T>
+uint64_t HashText(const T* text, uint32_t& length)
+{
+    // 同じ並びでも UTF-8 と UTF-16 で行の位置が異なるので，初期値を変えておく.
+    auto hash = kFnvOffset ^ sizeof(T);
+    auto ptr  = text;
+    for(; *ptr != 0; ++ptr)
+    {
+        hash ^= uint64_t(*ptr);
+        hash *= kFnvPrime;
+    }
+
+    length = uint32_t(ptr - text);
+    return hash;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextLayout class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      UTF-16 のテキストを行に分割します.
+//-----------------------------------------------------------------------------
+void TextLayout::Layout
+(
+    ITextMetrics*           pMetrics,
+    const wchar_t*          text,
+    const TextLayoutBox&    box,
+    std::vector<TextLine>&  lines,
+    TextLayoutResult&       result
+)
+{
+    m_Glyphs.clear();
+
+    auto ptr = text;
+    while(*ptr != L'\0')
+    {
+        Glyph glyph;
+        glyph.Offset  = uint32_t(ptr - text);
+        glyph.Code    = NextCode(ptr);
+        glyph.Advance = (glyph.Code == L'\n') ? 0 : pMetrics->GetAdvance(glyph.Code);
+        m_Glyphs.push_back(glyph);
+    }
+
+    m_Glyphs.push_back(Glyph{ 0, uint32_t(ptr - text), 0 });
+
+    Break(box, lines, result);
+}
+
+//-----------------------------------------------------------------------------
+//      UTF-8 のテキストを行に分割します.
+//-----------------------------------------------------------------------------
+void TextLayout::Layout
+(
+    ITextMetrics*           pMetrics,
+    const char*             text,
+    const TextLayoutBox&    box,
+    std::vector<TextLine>&  lines,
+    TextLayoutResult&       result
+)
+{
+    m_Glyphs.clear();
+
+    auto ptr = text;
+    while(*ptr != '\0')
+    {
+        Glyph glyph;
+        glyph.Offset  = uint32_t(ptr - text);
+        glyph.Code    = NextCode(ptr);
+        glyph.Advance = (glyph.Code == '\n') ? 0 : pMetrics->GetAdvance(glyph.Code);
+        m_Glyphs.push_back(glyph);
+    }
+
+    m_Glyphs.push_back(Glyph{ 0, uint32_t(ptr - text), 0 });
+
+    Break(box, lines, result);
+}
+
+//-----------------------------------------------------------------------------
+//      行頭に置けない文字かどうか?
+//-----------------------------------------------------------------------------
+bool TextLayout::IsNoStart(uint32_t code)
+{ return kNoStart.Contains(code); }
+
+//-----------------------------------------------------------------------------
+//      行末に置けない文字かどうか?
+//-----------------------------------------------------------------------------
+bool TextLayout::IsNoEnd(uint32_t code)
+{ return kNoEnd.Contains(code); }
+
+//-----------------------------------------------------------------------------
+//      行末にぶら下げてよい文字かどうか?
+//-----------------------------------------------------------------------------
+bool TextLayout::IsHanging(uint32_t code)
+{ return kHanging.Contains(code); }
+
+//-----------------------------------------------------------------------------
+//      デコード済みの文字を行に分割します.
+//-----------------------------------------------------------------------------
+void TextLayout::Break
+(
+    const TextLayoutBox&    box,
+    std::vector<TextLine>&  lines,
+    TextLayoutResult&       result
+)
+{
+    result.pLines    = nullptr;
+    result.LineCount = 0;
+    result.Width     = 0;
+    result.Truncated = false;
+
+    const auto& glyphs = m_Glyphs;
+    const auto  count  = uint32_t(glyphs.size() - 1);
+
+    // 行末の空白を除いて行を追加する.
+    auto emit = [&](uint32_t begin, uint32_t end) -> bool
+    {
+        if (box.MaxLines > 0 && result.LineCount >= box.MaxLines)
+        {
+            result.Truncated = true;
+            return false;
+        }
+
+        while(end > begin && IsSpace(glyphs[end - 1].Code))
+        { end--; }
+
+        int32_t width = 0;
+        for(auto i=begin; i<end; ++i)
+        { width += glyphs[i].Advance; }
+
+        TextLine line;
+        line.Offset = glyphs[begin].Offset;
+        line.Length = glyphs[end].Offset - glyphs[begin].Offset;
+        line.Width  = width;
+        lines.push_back(line);
+
+        result.LineCount++;
+        result.Width = std::max(result.Width, width);
+        return true;
+    };
+
+    uint32_t lineStart = 0;
+    uint32_t breakPos  = 0;     // 直近の改行できる位置. lineStart 以下なら無し.
+    int32_t  width     = 0;
+    uint32_t i         = 0;
+
+    while(i < count)
+    {
+        auto code = glyphs[i].Code;
+
+        // 強制改行.
+        if (code == '\n')
+        {
+            if (!emit(lineStart, i))
+            { return; }
+
+            i++;
+            lineStart = i;
+            breakPos  = 0;
+            width     = 0;
+            continue;
+        }
+
+        if (i > lineStart && CanBreak(glyphs[i - 1].Code, code))
+        { breakPos = i; }
+
+        // 空白と句読点ははみ出しても行末に残す.
+        // ぶら下げは1行に1文字までなので，既にはみ出している場合は句読点も追い出す.
+        auto hanging  = IsHanging(code) && (width <= box.Width);
+        auto overflow = (i > lineStart)
+                     && (width + glyphs[i].Advance > box.Width)
+                     && !IsSpace(code)
+                     && !hanging;
+        if (overflow)
+        {
+            auto end = (breakPos > lineStart) ? breakPos : i;
+
+            // 改行できる位置が無い場合でも，行頭禁則文字は前の文字ごと追い出す.
+            if (end == i && IsNoStart(code) && i - 1 > lineStart)
+            { end = i - 1; }
+
+            if (!emit(lineStart, end))
+            { return; }
+
+            // 次の行の先頭の空白は詰める.
+            i = end;
+            while(i < count && IsSpace(glyphs[i].Code))
+            { i++; }
+
+            lineStart = i;
+            breakPos  = 0;
+            width     = 0;
+            continue;
+        }
+
+        width += glyphs[i].Advance;
+        i++;
+    }
+
+    if (lineStart < count)
+    { emit(lineStart, count); }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextLayoutCache class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+TextLayoutCache::TextLayoutCache()
+: m_HitCount    (0)
+, m_MissCount   (0)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+TextLayoutCache::~TextLayoutCache()
+{ Clear(); }
+
+//-----------------------------------------------------------------------------
+//      レイアウト結果を取得します.
+//-----------------------------------------------------------------------------
+bool TextLayoutCache::Get
+(
+    ITextMetrics*           pMetrics,
+    const wchar_t*          text,
+    uint32_t                style,
+    const TextLayoutBox&    box,
+    TextLayoutResult&       result
+)
+{ return GetImpl(pMetrics, text, style, box, result); }
+
+//-----------------------------------------------------------------------------
+//      UTF-8 のテキストのレイアウト結果を取得します.
+//-----------------------------------------------------------------------------
+bool TextLayoutCache::Get
+(
+    ITextMetrics*           pMetrics,
+    const char*             text,
+    uint32_t                style,
+    const TextLayoutBox&    box,
+    TextLayoutResult&       result
+)
+{ return GetImpl(pMetrics, text, style, box, result); }
+
+//-----------------------------------------------------------------------------
+//      保持しているレイアウト結果を破棄します.
+//-----------------------------------------------------------------------------
+void TextLayoutCache::Clear()
+{
+    m_Entries.clear();
+    m_Lines  .clear();
+}
+
+//-----------------------------------------------------------------------------
+//      保持しているレイアウト結果の数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TextLayoutCache::GetEntryCount() const
+{ return uint32_t(m_Entries.size()); }
+
+//-----------------------------------------------------------------------------
+//      キャッシュにヒットした回数を取得します.
+//-----------------------------------------------------------------------------
+uint64_t TextLayoutCache::GetHitCount() const
+{ return m_HitCount; }
+
+//-----------------------------------------------------------------------------
+//      キャッシュにヒットしなかった回数を取得します.
+//-----------------------------------------------------------------------------
+uint64_t TextLayoutCache::GetMissCount() const
+{ return m_MissCount; }
+
+//-----------------------------------------------------------------------------
+//      レイアウト結果を取得します.
+//-----------------------------------------------------------------------------
+template<typename T>
+bool TextLayoutCache::GetImpl
+(
+    ITextMetrics*           pMetrics,
+    const T*                text,
+    uint32_t                style,
+    const TextLayoutBox&    box,
+    TextLayoutResult&       result
+)
+{
+    if (pMetrics == nullptr || text == nullptr)
+    { return false; }
+
+    Key key;
+    key.Hash     = HashText(text, key.Length);
+    key.Style    = style;
+    key.Width    = box.Width;
+    key.MaxLines = box.MaxLines;
+
+    auto itr = m_Entries.find(key);
+    if (itr != m_Entries.end())
+    {
+        auto& entry = itr->second;
+        result.pLines    = (entry.LineCount > 0) ? &m_Lines[entry.FirstLine] : nullptr;
+        result.LineCount = entry.LineCount;
+        result.Width     = entry.Width;
+        result.Truncated = entry.Truncated;
+
+        m_HitCount++;
+        return true;
+    }
+
+    auto first = uint32_t(m_Lines.size());
+    m_Layout.Layout(pMetrics, text, box, m_Lines, result);
+
+    Entry entry;
+    entry.FirstLine = first;
+    entry.LineCount = result.LineCount;
+    entry.Width     = result.Width;
+    entry.Truncated = result.Truncated;
+    m_Entries.emplace(key, entry);
+
+    result.pLines = (result.LineCount > 0) ? &m_Lines[first] : nullptr;
+
+    m_MissCount++;
+    return true;
+}
@@ -8,8 +8,239 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <cassert>
+#include <cmath>
+#include <cwchar>
 #include <TextWriter.h>
 #include <asdxLogger.h>
+#include <asdxDeviceContext.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t   kPageSize       = 1024; // アトラス1ページの縦横サイズ.
+static const uint32_t   kPageCount      = 4;    // ページ数. 1ページ当たり32px文字が約300字入る.
+static const uint32_t   kOutlineRadius  = 1;    // 縁取りの太さ(従来の上下左右1pixelずらしに相当).
+static const uint32_t   kCellPadding    = 4;    // はみ出す文字のためのセルの余白.
+static const int        kFillLayer      = 0;    // 塗りつぶしのレイヤー.
+static const int        kOutlineLayer   = 1;    // 縁取りのレイヤー. 塗りつぶしより奥に描く.
+static const int        kLineWidth      = 958;  // メッセージウィンドウの行の横幅.
+static const int        kLineHeight     = 42;   // 32px文字サイズ + 10px上下間隔.
+static const int        kLineX          = 182;  // メッセージウィンドウの行の左端.
+static const int        kLineUpperY     = 86;   // 1行目の上端(上側に表示する場合).
+static const int        kLineLowerY     = 504;  // 1行目の上端(下側に表示する場合).
+
+// 見つからない場合に使うフォント.
+static const wchar_t* kFallbackFonts[] = {
+    L"MS Gothic",
+    L"Meiryo",
+};
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// GlyphRasterizerDW class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool GlyphRasterizerDW::Init(IDWriteFactory* pFactory, const wchar_t* fontName, float fontSize)
+{
+    asdx::RefPtr<IDWriteFontCollection> pCollection;
+    auto hr = pFactory->GetSystemFontCollection(pCollection.GetAddress());
+    if (FAILED(hr))
+    {
+        ELOGA("Error : IDWriteFactory::GetSystemFontCollection() Failed. errcode = 0x%x", hr);
+        return false;
+    }
+
+    // 指定フォントが無い場合は代わりのフォントを探す.
+    UINT32 index  = 0;
+    BOOL   exists = FALSE;
+    hr = pCollection->FindFamilyName(fontName, &index, &exists);
+    for(auto i=0u; i<_countof(kFallbackFonts) && (FAILED(hr) || !exists); ++i)
+    { hr = pCollection->FindFamilyName(kFallbackFonts[i], &index, &exists); }
+
+    if (FAILED(hr) || !exists)
+    {
+        ELOGA("Error : Font Not Found.");
+        return false;
+    }
+
+    asdx::RefPtr<IDWriteFontFamily> pFamily;
+    hr = pCollection->GetFontFamily(index, pFamily.GetAddress());
+    if (FAILED(hr))
+    {
+        ELOGA("Error : IDWriteFontCollection::GetFontFamily() Failed. errcode = 0x%x", hr);
+        return false;
+    }
+
+    asdx::RefPtr<IDWriteFont> pFont;
+    hr = pFamily->GetFirstMatchingFont(
+        DWRITE_FONT_WEIGHT_BOLD,
+        DWRITE_FONT_STRETCH_NORMAL,
+        DWRITE_FONT_STYLE_NORMAL,
+        pFont.GetAddress());
+    if (FAILED(hr))
+    {
+        ELOGA("Error : IDWriteFontFamily::GetFirstMatchingFont() Failed. errcode = 0x%x", hr);
+        return false;
+    }
+
+    hr = pFont->CreateFontFace(m_FontFace.GetAddress());
+    if (FAILED(hr))
+    {
+        ELOGA("Error : IDWriteFont::CreateFontFace() Failed. errcode = 0x%x", hr);
+        return false;
+    }
+
+    DWRITE_FONT_METRICS metrics = {};
+    m_FontFace->GetMetrics(&metrics);
+
+    m_Factory    = pFactory;
+    m_FontSize   = fontSize;
+    m_Scale      = fontSize / float(metrics.designUnitsPerEm);
+    m_Ascent     = int32_t(ceilf(metrics.ascent * m_Scale));
+    m_LineHeight = int32_t(ceilf((metrics.ascent + metrics.descent + metrics.lineGap) * m_Scale));
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void GlyphRasterizerDW::Term()
+{
+    m_FontFace.Reset();
+    m_Factory .Reset();
+    m_Buffer  .clear();
+}
+
+//-----------------------------------------------------------------------------
+//      1文字をラスタライズします.
+//-----------------------------------------------------------------------------
+bool GlyphRasterizerDW::Rasterize(uint32_t code, GlyphBitmap& result)
+{
+    if (m_FontFace.GetPtr() == nullptr)
+    { return false; }
+
+    UINT32 codePoint = code;
+    UINT16 glyph     = 0;
+    auto hr = m_FontFace->GetGlyphIndices(&codePoint, 1, &glyph);
+    if (FAILED(hr))
+    { return false; }
+
+    DWRITE_GLYPH_METRICS glyphMetrics = {};
+    hr = m_FontFace->GetDesignGlyphMetrics(&glyph, 1, &glyphMetrics);
+    if (FAILED(hr))
+    { return false; }
+
+    result.Advance = int32_t(floorf(glyphMetrics.advanceWidth * m_Scale + 0.5f));
+
+    FLOAT               advance = 0.0f;
+    DWRITE_GLYPH_OFFSET offset  = {};
+
+    DWRITE_GLYPH_RUN run = {};
+    run.fontFace        = m_FontFace.GetPtr();
+    run.fontEmSize      = m_FontSize;
+    run.glyphCount      = 1;
+    run.glyphIndices    = &glyph;
+    run.glyphAdvances   = &advance;
+    run.glyphOffsets    = &offset;
+
+    asdx::RefPtr<IDWriteGlyphRunAnalysis> pAnalysis;
+    hr = m_Factory->CreateGlyphRunAnalysis(
+        &run,
+        1.0f,
+        nullptr,
+        DWRITE_RENDERING_MODE_NATURAL,
+        DWRITE_MEASURING_MODE_NATURAL,
+        0.0f,
+        0.0f,
+        pAnalysis.GetAddress());
+    if (FAILED(hr))
+    { return false; }
+
+    RECT bounds = {};
+    hr = pAnalysis->GetAlphaTextureBounds(DWRITE_TEXTURE_CLEARTYPE_3x1, &bounds);
+    if (FAILED(hr))
+    { return false; }
+
+    // 空白などは描画する画素が無い.
+    if (bounds.right <= bounds.left || bounds.bottom <= bounds.top)
+    {
+        result.Width  = 0;
+        result.Height = 0;
+        return true;
+    }
+
+    auto w = uint32_t(bounds.right  - bounds.left);
+    auto h = uint32_t(bounds.bottom - bounds.top);
+    m_Buffer.resize(w * h * 3);
+
+    hr = pAnalysis->CreateAlphaTexture(
+        DWRITE_TEXTURE_CLEARTYPE_3x1,
+        &bounds,
+        m_Buffer.data(),
+        UINT32(m_Buffer.size()));
+    if (FAILED(hr))
+    { return false; }
+
+    // サブピクセル毎の被覆率を平均してグレースケールにする.
+    result.OffsetX = bounds.left;
+    result.OffsetY = bounds.top;
+    result.Width   = w;
+    result.Height  = h;
+    result.Coverage.resize(w * h);
+    for(auto i=0u; i<w * h; ++i)
+    {
+        auto sum = uint32_t(m_Buffer[i * 3 + 0])
+                 + uint32_t(m_Buffer[i * 3 + 1])
+                 + uint32_t(m_Buffer[i * 3 + 2]);
+        result.Coverage[i] = uint8_t(sum / 3);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      文字の送り幅を取得します.
+//-----------------------------------------------------------------------------
+int32_t GlyphRasterizerDW::GetAdvance(uint32_t code)
+{
+    if (m_FontFace.GetPtr() == nullptr)
+    { return 0; }
+
+    UINT32 codePoint = code;
+    UINT16 glyph     = 0;
+    auto hr = m_FontFace->GetGlyphIndices(&codePoint, 1, &glyph);
+    if (FAILED(hr))
+    { return 0; }
+
+    DWRITE_GLYPH_METRICS glyphMetrics = {};
+    hr = m_FontFace->GetDesignGlyphMetrics(&glyph, 1, &glyphMetrics);
+    if (FAILED(hr))
+    { return 0; }
+
+    // Rasterize() と同じ丸めにして，レイアウトした幅と描画位置を一致させる.
+    return int32_t(floorf(glyphMetrics.advanceWidth * m_Scale + 0.5f));
+}
+
+//-----------------------------------------------------------------------------
+//      行の上端からベースラインまでの高さを取得します.
+//-----------------------------------------------------------------------------
+int32_t GlyphRasterizerDW::GetAscent() const
+{ return m_Ascent; }
+
+//-----------------------------------------------------------------------------
+//      行の高さを取得します.
+//-----------------------------------------------------------------------------
+int32_t GlyphRasterizerDW::GetLineHeight() const
+{ return m_LineHeight; }
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -20,6 +251,10 @@
 //      コンストラクタです.
 //-----------------------------------------------------------------------------
 TextWriter::TextWriter()
+: m_Color       (1.0f, 1.0f, 1.0f, 1.0f)
+, m_OutlineColor(0.0f, 0.0f, 1.0f, 1.0f)
+, m_FontSize    (0.0f)
+, m_Outline     (true)
 { /* DO_NOTHING */ }
 
 //-----------------------------------------------------------------------------
@@ -34,7 +269,6 @@ TextWriter::~TextWriter()
 bool TextWriter::Init
 (
     IDWriteFactory*     pFactory,
-    ID2D1DeviceContext* pContext,
     const wchar_t*      fontName,
     float               fontSize
 )
@@ -45,36 +279,55 @@ bool TextWriter::Init
         return false;
     }
 
-    // テキストフォーマットの生成.
-    auto hr = pFactory->CreateTextFormat(
-        fontName,
-        nullptr,
-        DWRITE_FONT_WEIGHT_BOLD,
-        DWRITE_FONT_STYLE_NORMAL,
-        DWRITE_FONT_STRETCH_NORMAL,
-        fontSize,
-        L"",
-        m_Format.GetAddress() );
-    if (FAILED(hr))
+    if (!m_Rasterizer.Init(pFactory, fontName, fontSize))
     {
-        ELOGA("Error : IDWriteFactory::CreateTextFormat() Failed. errcode = 0x%x", hr);
+        ELOGA("Error : GlyphRasterizerDW::Init() Failed.");
         return false;
     }
 
-    // カラーブラシを生成.
-    hr = pContext->CreateSolidColorBrush( D2D1::ColorF(D2D1::ColorF::White), m_Brush.GetAddress() );
-    if ( FAILED( hr ) )
+    GlyphCacheDesc desc = {};
+    desc.PageSize       = kPageSize;
+    desc.PageCount      = kPageCount;
+    desc.CellSize       = uint32_t(ceilf(fontSize)) + kOutlineRadius * 2 + kCellPadding;
+    desc.OutlineRadius  = kOutlineRadius;
+
+    if (!m_Cache.Init(&m_Rasterizer, desc))
     {
-        ELOG("Error : ID2D1DeviceContext::CreateSolidBrush() Failed. errcode = 0x%x", hr);
+        ELOGA("Error : GlyphCache::Init() Failed.");
         return false;
     }
 
-    // カラーブラシを生成.
-    hr = pContext->CreateSolidColorBrush( D2D1::ColorF(D2D1::ColorF::Blue), m_OutlineBrush.GetAddress() );
-    if ( FAILED( hr ) )
+    // ページ毎のテクスチャを生成. 内容は描画時に変更のあった行だけ転送する.
+    auto pDevice = asdx::DeviceContext::Instance().GetDevice();
+
+    m_PageTextures.resize(kPageCount);
+    m_PageSRVs    .resize(kPageCount);
+    for(auto i=0u; i<kPageCount; ++i)
     {
-        ELOG("Error : ID2D1DeviceContext::CreateSolidBrush() Failed. errcode = 0x%x", hr);
-        return false;
+        D3D11_TEXTURE2D_DESC texDesc = {};
+        texDesc.Width              = kPageSize;
+        texDesc.Height             = kPageSize;
+        texDesc.MipLevels          = 1;
+        texDesc.ArraySize          = 1;
+        texDesc.Format             = DXGI_FORMAT_R8G8B8A8_UNORM;
+        texDesc.SampleDesc.Count   = 1;
+        texDesc.SampleDesc.Quality = 0;
+        texDesc.Usage              = D3D11_USAGE_DEFAULT;
+        texDesc.BindFlags          = D3D11_BIND_SHADER_RESOURCE;
+
+        auto hr = pDevice->CreateTexture2D(&texDesc, nullptr, m_PageTextures[i].GetAddress());
+        if (FAILED(hr))
+        {
+            ELOGA("Error : ID3D11Device::CreateTexture2D() Failed. errcode = 0x%x", hr);
+            return false;
+        }
+
+        hr = pDevice->CreateShaderResourceView(m_PageTextures[i].GetPtr(), nullptr, m_PageSRVs[i].GetAddress());
+        if (FAILED(hr))
+        {
+            ELOGA("Error : ID3D11Device::CreateShaderResourceView() Failed. errcode = 0x%x", hr);
+            return false;
+        }
     }
 
     m_FontSize = fontSize;
@@ -88,121 +341,87 @@ bool TextWriter::Init
 //-----------------------------------------------------------------------------
 void TextWriter::Term()
 {
-    m_OutlineBrush.Reset();
-    m_Brush .Reset();
-    m_Format.Reset();
+    m_PageSRVs    .clear();
+    m_PageTextures.clear();
+    m_Upload      .clear();
+    m_Quads       .clear();
+    m_Cache       .Term();
+    m_Rasterizer  .Term();
 }
 
+//-----------------------------------------------------------------------------
+//      フレームを進めます.
+//-----------------------------------------------------------------------------
+void TextWriter::NewFrame()
+{ m_Cache.NewFrame(); }
+
 //-----------------------------------------------------------------------------
 //      カラーを設定します.
 //-----------------------------------------------------------------------------
 void TextWriter::SetColor(float r, float g, float b, float a)
-{
-    D2D_COLOR_F color = {};
-    color.r = r;
-    color.g = g;
-    color.b = b;
-    color.a = a;
-    m_Brush->SetColor(color);
-}
+{ m_Color = asdx::Vector4(r, g, b, a); }
 
 //-----------------------------------------------------------------------------
 //      テキストを描画します.
 //-----------------------------------------------------------------------------
-void TextWriter::Draw(ID2D1DeviceContext* pContext, const wchar_t* text, float x, float y)
+void TextWriter::Draw(SpriteSystem& sprite, const wchar_t* text, float x, float y)
 {
-    UINT length = UINT(wcslen(text));
-    if (length == 0)
+    if (text == nullptr || text[0] == L'\0')
     { return; }
 
-    D2D_RECT_F rect = {};
-    rect.left   = x;
-    rect.top    = y;
-    rect.right  = x + m_FontSize * 2.0f * length;
-    rect.bottom = y + m_FontSize;
-
-    // 左寄せ.
-    m_Format->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
-
-    // 上下左右に1pixelずらして描く.
-    if (m_Outline)
-    {
-        auto r = rect;
-        r.left--;
-        r.right--;
-        pContext->DrawText(text, length, m_Format.GetPtr(), &r, m_OutlineBrush.GetPtr());
-
-        r = rect;
-        r.left++;
-        r.right++;
-        pContext->DrawText(text, length, m_Format.GetPtr(), &r, m_OutlineBrush.GetPtr());
-
-        r = rect;
-        r.top++;
-        r.bottom++;
-        pContext->DrawText(text, length, m_Format.GetPtr(), &r, m_OutlineBrush.GetPtr());
-
-        r = rect;
-        r.top--;
-        r.bottom--;
-        pContext->DrawText(text, length, m_Format.GetPtr(), &r, m_OutlineBrush.GetPtr());
-    }
-
-    pContext->DrawText(text, length, m_Format.GetPtr(), &rect, m_Brush.GetPtr());
+    DrawGlyphs(sprite, text, uint32_t(wcslen(text)), int(x), int(y));
 }
 
 //-----------------------------------------------------------------------------
 //      テキストを描画します.
 //-----------------------------------------------------------------------------
-void TextWriter::DrawLine(ID2D1DeviceContext* pContext, const wchar_t* text, int line, bool upper)
+void TextWriter::DrawLine(SpriteSystem& sprite, const wchar_t* text, int line, bool upper)
 {
     assert(0 <= line && line < 4);
-    UINT length = UINT(wcslen(text));
-
-    if (length == 0)
+    if (text == nullptr || text[0] == L'\0')
     { return; }
 
-    static const float kW = 958.0f;
-    static const float kH = 42.0f; // 32px文字サイズ + 10px上下間隔.
-    static const float kX = 182.0f;
-    const float kY = (upper) ? 86.0f : 504.0f;
-
-    D2D_RECT_F rect = {};
-    rect.left   = kX;
-    rect.top    = kY + line * kH;
-    rect.right  = kX + kW;
-    rect.bottom = kY + m_FontSize + line * kH;
+    const int top = (upper) ? kLineUpperY : kLineLowerY;
 
     // 中央寄せ
-    m_Format->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
+    auto width = m_Cache.Measure(text);
+    DrawGlyphs(sprite, text, uint32_t(wcslen(text)), kLineX + (kLineWidth - width) / 2, top + line * kLineHeight);
+}
 
-    // 上下左右に1pixelずらして描く.
-    if (m_Outline)
-    {
-        auto r = rect;
-        r.left--;
-        r.right--;
-        pContext->DrawText(text, length, m_Format.GetPtr(), &r, m_OutlineBrush.GetPtr());
-
-        r = rect;
-        r.left++;
-        r.right++;
-        pContext->DrawText(text, length, m_Format.GetPtr(), &r, m_OutlineBrush.GetPtr());
-
-        r = rect;
-        r.top++;
-        r.bottom++;
-        pContext->DrawText(text, length, m_Format.GetPtr(), &r, m_OutlineBrush.GetPtr());
-
-        r = rect;
-        r.top--;
-        r.bottom--;
-        pContext->DrawText(text, length, m_Format.GetPtr(), &r, m_OutlineBrush.GetPtr());
-    }
+//-----------------------------------------------------------------------------
+//      レイアウト済みの行を描画します.
+//-----------------------------------------------------------------------------
+void TextWriter::DrawLine
+(
+    SpriteSystem&   sprite,
+    const wchar_t*  text,
+    const TextLine& layout,
+    int             line,
+    bool            upper
+)
+{
+    assert(0 <= line && line < 4);
+    if (text == nullptr || layout.Length == 0)
+    { return; }
+
+    const int top = (upper) ? kLineUpperY : kLineLowerY;
 
-    pContext->DrawText(text, length, m_Format.GetPtr(), &rect, m_Brush.GetPtr());
+    // 中央寄せ. 幅はレイアウト時に求めてあるので計測しない.
+    DrawGlyphs(sprite, text + layout.Offset, layout.Length, kLineX + (kLineWidth - layout.Width) / 2, top + line * kLineHeight);
 }
 
+//-----------------------------------------------------------------------------
+//      レイアウト用の文字の送り幅を取得します.
+//-----------------------------------------------------------------------------
+ITextMetrics* TextWriter::GetMetrics()
+{ return &m_Rasterizer; }
+
+//-----------------------------------------------------------------------------
+//      メッセージウィンドウの行の横幅を取得します.
+//-----------------------------------------------------------------------------
+int TextWriter::GetLineWidth() const
+{ return kLineWidth; }
+
 //-----------------------------------------------------------------------------
 //      フォントサイズを取得します.
 //-----------------------------------------------------------------------------
@@ -213,14 +432,7 @@ float TextWriter::GetFontSize() const
 //      縁取りカラーを設定します.
 //-----------------------------------------------------------------------------
 void TextWriter::SetOutlineColor(float r, float g, float b, float a)
-{
-    D2D_COLOR_F color = {};
-    color.r = r;
-    color.g = g;
-    color.b = b;
-    color.a = a;
-    m_OutlineBrush->SetColor(color);
-}
+{ m_OutlineColor = asdx::Vector4(r, g, b, a); }
 
 //-----------------------------------------------------------------------------
 //      縁取りフラグを設定します.
@@ -232,4 +444,78 @@ void TextWriter::SetOutline(bool enable)
 //      縁取りフラグを取得します.
 //-----------------------------------------------------------------------------
 bool TextWriter::GetOutline() const
-{ return m_Outline; }
\ No newline at end of file
+{ return m_Outline; }
+
+//-----------------------------------------------------------------------------
+//      文字の矩形をスプライトとして描画します.
+//-----------------------------------------------------------------------------
+void TextWriter::DrawGlyphs(SpriteSystem& sprite, const wchar_t* text, uint32_t length, int x, int y)
+{
+    m_Quads.clear();
+    m_Cache.BuildQuads(text, length, x, y, m_Quads);
+
+    // 新しくラスタライズした文字を描画前に転送しておく.
+    UploadPages();
+
+    // 縁取りは塗りつぶしより奥のレイヤーに置くので，ページをまたいでも塗りつぶしを隠さない.
+    sprite.SetColor(m_OutlineColor.x, m_OutlineColor.y, m_OutlineColor.z, m_OutlineColor.w);
+    for(auto& quad : m_Quads)
+    {
+        if (!quad.Outline)
+        { continue; }
+
+        if (!m_Outline)
+        { break; }
+
+        TextureRegion region(m_PageSRVs[quad.Page].GetPtr(),
+            quad.TexRect[0], quad.TexRect[1], quad.TexRect[2], quad.TexRect[3]);
+        sprite.Draw(region, quad.X, quad.Y, quad.W, quad.H, kOutlineLayer);
+    }
+
+    sprite.SetColor(m_Color.x, m_Color.y, m_Color.z, m_Color.w);
+    for(auto& quad : m_Quads)
+    {
+        if (quad.Outline)
+        { continue; }
+
+        TextureRegion region(m_PageSRVs[quad.Page].GetPtr(),
+            quad.TexRect[0], quad.TexRect[1], quad.TexRect[2], quad.TexRect[3]);
+        sprite.Draw(region, quad.X, quad.Y, quad.W, quad.H, kFillLayer);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      更新されたページの行をテクスチャに転送します.
+//-----------------------------------------------------------------------------
+void TextWriter::UploadPages()
+{
+    auto pContext = asdx::DeviceContext::Instance().GetContext();
+
+    for(auto i=0u; i<m_PageTextures.size(); ++i)
+    {
+        uint32_t top    = 0;
+        uint32_t bottom = 0;
+        if (!m_Cache.GetDirtyRows(i, top, bottom))
+        { continue; }
+
+        // 被覆率をアルファにした白色のRGBAに展開する. スプライトのカラーがそのまま文字色になる.
+        auto pixels = m_Cache.GetPagePixels(i) + top * kPageSize;
+        auto count  = (bottom - top) * kPageSize;
+        m_Upload.resize(count);
+        for(auto j=0u; j<count; ++j)
+        { m_Upload[j] = 0x00ffffff | (uint32_t(pixels[j]) << 24); }
+
+        D3D11_BOX box = {};
+        box.left    = 0;
+        box.right   = kPageSize;
+        box.top     = top;
+        box.bottom  = bottom;
+        box.front   = 0;
+        box.back    = 1;
+
+        pContext->UpdateSubresource(
+            m_PageTextures[i].GetPtr(), 0, &box, m_Upload.data(), kPageSize * 4, 0);
+
+        m_Cache.ClearDirty(i);
+    }
+}
@@ -0,0 +1,528 @@
+﻿//-----------------------------------------------------------------------------
+// File : TextureAtlas.cpp
+// Desc : Texture Atlas Builder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <TextureAtlas.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kBytePerPixel = 4;    // RGBA8.
+static const uint32_t kMinAtlasSize = 64;   // アトラスの最小サイズ.
+
+//-----------------------------------------------------------------------------
+//      value 以上の最小の2のべき乗を求めます.
+//-----------------------------------------------------------------------------
+inline uint32_t NextPow2(uint32_t value)
+{
+    auto result = 1u;
+    while(result < value)
+    { result <<= 1; }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      値を範囲内に収めます.
+//-----------------------------------------------------------------------------
+inline int ClampIndex(int value, int count)
+{
+    if (value < 0)      { return 0; }
+    if (value >= count) { return count - 1; }
+    return value;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SkylinePacker class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+SkylinePacker::SkylinePacker()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+SkylinePacker::~SkylinePacker()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      領域サイズを設定して空の状態にします.
+//-----------------------------------------------------------------------------
+void SkylinePacker::Init(uint32_t width, uint32_t height)
+{
+    m_Width    = width;
+    m_Height   = height;
+    m_UsedArea = 0;
+
+    m_Skyline.clear();
+
+    Segment seg;
+    seg.X = 0;
+    seg.Y = 0;
+    seg.W = width;
+    m_Skyline.push_back(seg);
+}
+
+//-----------------------------------------------------------------------------
+//      矩形を配置します.
+//-----------------------------------------------------------------------------
+bool SkylinePacker::Insert(uint32_t w, uint32_t h, AtlasRect& result)
+{
+    if (w == 0 || h == 0)
+    { return false; }
+
+    // Bottom-Left 規則. 上端が最も低くなる位置を選び，同じなら残る隙間が狭い方を選ぶ.
+    auto bestIndex  = m_Skyline.size();
+    auto bestTop    = UINT32_MAX;
+    auto bestWidth  = UINT32_MAX;
+    auto bestY      = 0u;
+
+    for(size_t i=0; i<m_Skyline.size(); ++i)
+    {
+        uint32_t y;
+        if (!Fit(i, w, h, y))
+        { continue; }
+
+        auto top = y + h;
+        if (top < bestTop || (top == bestTop && m_Skyline[i].W < bestWidth))
+        {
+            bestIndex = i;
+            bestTop   = top;
+            bestWidth = m_Skyline[i].W;
+            bestY     = y;
+        }
+    }
+
+    if (bestIndex == m_Skyline.size())
+    { return false; }
+
+    result.X = m_Skyline[bestIndex].X;
+    result.Y = bestY;
+    result.W = w;
+    result.H = h;
+
+    // 新しいセグメントを挿入して，覆われたセグメントを削るか取り除く.
+    Segment seg;
+    seg.X = result.X;
+    seg.Y = bestTop;
+    seg.W = w;
+    m_Skyline.insert(m_Skyline.begin() + bestIndex, seg);
+
+    auto right = seg.X + seg.W;
+    for(auto i = bestIndex + 1; i < m_Skyline.size(); )
+    {
+        auto& cur = m_Skyline[i];
+        if (cur.X >= right)
+        { break; }
+
+        auto curRight = cur.X + cur.W;
+        if (curRight <= right)
+        {
+            m_Skyline.erase(m_Skyline.begin() + i);
+            continue;
+        }
+
+        cur.W = curRight - right;
+        cur.X = right;
+        break;
+    }
+
+    // 同じ高さで隣り合うセグメントを結合.
+    for(size_t i=0; i + 1 < m_Skyline.size(); )
+    {
+        if (m_Skyline[i].Y == m_Skyline[i + 1].Y)
+        {
+            m_Skyline[i].W += m_Skyline[i + 1].W;
+            m_Skyline.erase(m_Skyline.begin() + i + 1);
+            continue;
+        }
+        ++i;
+    }
+
+    m_UsedArea += uint64_t(w) * uint64_t(h);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      指定セグメントの左端に置けるかチェックし，置ける場合は下端のY座標を求めます.
+//-----------------------------------------------------------------------------
+bool SkylinePacker::Fit(size_t index, uint32_t w, uint32_t h, uint32_t& y) const
+{
+    auto x = m_Skyline[index].X;
+    if (x + w > m_Width)
+    { return false; }
+
+    y = 0;
+    auto rest = w;
+    for(auto i=index; rest > 0; ++i)
+    {
+        if (i >= m_Skyline.size())
+        { return false; }
+
+        y = std::max(y, m_Skyline[i].Y);
+        if (y + h > m_Height)
+        { return false; }
+
+        rest = (m_Skyline[i].W >= rest) ? 0 : rest - m_Skyline[i].W;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      配置済みの面積を取得します.
+//-----------------------------------------------------------------------------
+uint64_t SkylinePacker::GetUsedArea() const
+{ return m_UsedArea; }
+
+//-----------------------------------------------------------------------------
+//      横幅を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SkylinePacker::GetWidth() const
+{ return m_Width; }
+
+//-----------------------------------------------------------------------------
+//      縦幅を取得します.
+//-----------------------------------------------------------------------------
+uint32_t SkylinePacker::GetHeight() const
+{ return m_Height; }
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextureAtlas class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+TextureAtlas::TextureAtlas()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+TextureAtlas::~TextureAtlas()
+{ Reset(); }
+
+//-----------------------------------------------------------------------------
+//      登録した画像と構築結果を破棄します.
+//-----------------------------------------------------------------------------
+void TextureAtlas::Reset()
+{
+    m_Sources.clear();
+    m_Entries.clear();
+    m_Pages  .clear();
+}
+
+//-----------------------------------------------------------------------------
+//      画像を登録します.
+//-----------------------------------------------------------------------------
+uint32_t TextureAtlas::Add(uint32_t width, uint32_t height, uint32_t pitch, const uint8_t* pPixels)
+{
+    assert(width > 0 && height > 0);
+    assert(pitch >= width * kBytePerPixel);
+    assert(pPixels != nullptr);
+
+    Source src;
+    src.Width   = width;
+    src.Height  = height;
+    src.Pitch   = pitch;
+    src.pPixels = pPixels;
+    m_Sources.push_back(src);
+
+    return uint32_t(m_Sources.size() - 1);
+}
+
+//-----------------------------------------------------------------------------
+//      登録した画像を詰め込んでアトラスを構築します.
+//-----------------------------------------------------------------------------
+bool TextureAtlas::Build(uint32_t padding, uint32_t maxSize)
+{
+    m_Entries.clear();
+    m_Pages  .clear();
+
+    if (m_Sources.empty())
+    { return true; }
+
+    // 背の高い順に詰めると隙間が減る.
+    std::vector<uint32_t> order(m_Sources.size());
+    for(size_t i=0; i<order.size(); ++i)
+    { order[i] = uint32_t(i); }
+
+    std::stable_sort(order.begin(), order.end(),
+        [this](uint32_t lhs, uint32_t rhs)
+        {
+            auto& a = m_Sources[lhs];
+            auto& b = m_Sources[rhs];
+            if (a.Height != b.Height)
+            { return a.Height > b.Height; }
+            return a.Width > b.Width;
+        });
+
+    m_Entries.resize(m_Sources.size());
+
+    // 1ページに収まればそれで終わり.
+    if (BuildPage(order, padding, maxSize))
+    { return true; }
+
+    // 収まらない分は新しいページに送る. 先に最大サイズのページへ振り分けて，
+    // 後から各ページを収まる最小サイズで詰め直す.
+    std::vector<std::unique_ptr<SkylinePacker>> packers;
+    std::vector<std::vector<uint32_t>>          groups;
+
+    for(auto idx : order)
+    {
+        auto& src = m_Sources[idx];
+        auto  w   = src.Width  + padding * 2;
+        auto  h   = src.Height + padding * 2;
+
+        AtlasRect rect;
+        auto page = packers.size();
+        for(size_t i=0; i<packers.size(); ++i)
+        {
+            if (packers[i]->Insert(w, h, rect))
+            {
+                page = i;
+                break;
+            }
+        }
+
+        if (page == packers.size())
+        {
+            packers.emplace_back(new SkylinePacker());
+            packers.back()->Init(maxSize, maxSize);
+            groups .emplace_back();
+
+            if (!packers.back()->Insert(w, h, rect))
+            {
+                m_Entries.clear();
+                return false;
+            }
+        }
+
+        groups[page].push_back(idx);
+    }
+
+    for(auto& group : groups)
+    {
+        if (!BuildPage(group, padding, maxSize))
+        {
+            m_Entries.clear();
+            m_Pages  .clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      画像を収まる最小のサイズで1ページに詰め込みます.
+//-----------------------------------------------------------------------------
+bool TextureAtlas::BuildPage(const std::vector<uint32_t>& order, uint32_t padding, uint32_t maxSize)
+{
+    // 総面積と最大の辺から初期サイズを決める.
+    uint64_t area    = 0;
+    uint32_t longest = 0;
+    for(auto idx : order)
+    {
+        auto& src = m_Sources[idx];
+        auto  w   = src.Width  + padding * 2;
+        auto  h   = src.Height + padding * 2;
+        area   += uint64_t(w) * uint64_t(h);
+        longest = std::max(longest, std::max(w, h));
+    }
+
+    auto w = NextPow2(std::max(longest, kMinAtlasSize));
+    auto h = w;
+    while(uint64_t(w) * uint64_t(h) < area)
+    {
+        if (w <= h) { w <<= 1; }
+        else        { h <<= 1; }
+    }
+
+    // 収まるまで交互に広げる.
+    while(w <= maxSize && h <= maxSize)
+    {
+        if (Pack(w, h, padding, order))
+        { return true; }
+
+        if (w <= h) { w <<= 1; }
+        else        { h <<= 1; }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      指定サイズの新しいページに詰め込みます.
+//-----------------------------------------------------------------------------
+bool TextureAtlas::Pack(uint32_t width, uint32_t height, uint32_t padding, const std::vector<uint32_t>& order)
+{
+    SkylinePacker packer;
+    packer.Init(width, height);
+
+    std::vector<AtlasRect> rects(order.size());
+    for(size_t i=0; i<order.size(); ++i)
+    {
+        auto& src = m_Sources[order[i]];
+        if (!packer.Insert(src.Width + padding * 2, src.Height + padding * 2, rects[i]))
+        { return false; }
+    }
+
+    auto index = uint32_t(m_Pages.size());
+    m_Pages.emplace_back();
+
+    auto& page = m_Pages.back();
+    page.Width        = width;
+    page.Height       = height;
+    page.PackedPixels = packer.GetUsedArea();
+    page.Pixels.assign(size_t(width) * size_t(height) * kBytePerPixel, 0);
+
+    auto invW = 1.0f / float(width);
+    auto invH = 1.0f / float(height);
+
+    for(size_t i=0; i<order.size(); ++i)
+    {
+        auto& src   = m_Sources[order[i]];
+        auto& entry = m_Entries[order[i]];
+
+        entry.Page   = index;
+        entry.Rect.X = rects[i].X + padding;
+        entry.Rect.Y = rects[i].Y + padding;
+        entry.Rect.W = src.Width;
+        entry.Rect.H = src.Height;
+
+        entry.TexRect[0] = float(entry.Rect.X) * invW;
+        entry.TexRect[1] = float(entry.Rect.Y) * invH;
+        entry.TexRect[2] = float(entry.Rect.X + entry.Rect.W) * invW;
+        entry.TexRect[3] = float(entry.Rect.Y + entry.Rect.H) * invH;
+
+        Blit(src, page, entry.Rect, padding);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      画像をページに書き込みます.
+//
+//      パディング部分は端のピクセルで埋めて，バイリニア補間で隣の画像が滲まないようにします.
+//-----------------------------------------------------------------------------
+void TextureAtlas::Blit(const Source& src, Page& page, const AtlasRect& rect, uint32_t padding)
+{
+    auto pad = int(padding);
+    auto w   = int(src.Width);
+    auto h   = int(src.Height);
+
+    for(auto y=-pad; y<h + pad; ++y)
+    {
+        auto srcRow = src.pPixels + size_t(ClampIndex(y, h)) * src.Pitch;
+        auto dstRow = &page.Pixels[(size_t(int(rect.Y) + y) * page.Width) * kBytePerPixel];
+
+        // 内側はまとめてコピー.
+        auto pDst = dstRow + size_t(rect.X) * kBytePerPixel;
+        memcpy(pDst, srcRow, size_t(w) * kBytePerPixel);
+
+        // 左右のパディング.
+        auto pLast = srcRow + size_t(w - 1) * kBytePerPixel;
+        for(auto x=1; x<=pad; ++x)
+        {
+            memcpy(pDst - x * kBytePerPixel,           srcRow, kBytePerPixel);
+            memcpy(pDst + (w + x - 1) * kBytePerPixel, pLast,  kBytePerPixel);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ページ数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TextureAtlas::GetPageCount() const
+{ return uint32_t(m_Pages.size()); }
+
+//-----------------------------------------------------------------------------
+//      ページの横幅を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TextureAtlas::GetWidth(uint32_t page) const
+{
+    assert(page < m_Pages.size());
+    return m_Pages[page].Width;
+}
+
+//-----------------------------------------------------------------------------
+//      ページの縦幅を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TextureAtlas::GetHeight(uint32_t page) const
+{
+    assert(page < m_Pages.size());
+    return m_Pages[page].Height;
+}
+
+//-----------------------------------------------------------------------------
+//      ページのピクセルデータを取得します.
+//-----------------------------------------------------------------------------
+const std::vector<uint8_t>& TextureAtlas::GetPixels(uint32_t page) const
+{
+    assert(page < m_Pages.size());
+    return m_Pages[page].Pixels;
+}
+
+//-----------------------------------------------------------------------------
+//      エントリー数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TextureAtlas::GetEntryCount() const
+{ return uint32_t(m_Entries.size()); }
+
+//-----------------------------------------------------------------------------
+//      エントリーを取得します.
+//-----------------------------------------------------------------------------
+const AtlasEntry& TextureAtlas::GetEntry(uint32_t index) const
+{
+    assert(index < m_Entries.size());
+    return m_Entries[index];
+}
+
+//-----------------------------------------------------------------------------
+//      ページの占有率レポートを取得します.
+//-----------------------------------------------------------------------------
+AtlasReport TextureAtlas::GetReport(uint32_t page) const
+{
+    assert(page < m_Pages.size());
+    auto& info = m_Pages[page];
+
+    AtlasReport result = {};
+    result.Width        = info.Width;
+    result.Height       = info.Height;
+    result.PackedPixels = info.PackedPixels;
+
+    for(auto& entry : m_Entries)
+    {
+        if (entry.Page != page)
+        { continue; }
+
+        result.ImageCount++;
+        result.ImagePixels += uint64_t(entry.Rect.W) * uint64_t(entry.Rect.H);
+    }
+
+    auto total = uint64_t(info.Width) * uint64_t(info.Height);
+    result.Occupancy = (total > 0) ? float(double(result.ImagePixels) / double(total)) : 0.0f;
+
+    return result;
+}
@@ -8,6 +8,7 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <cassert>
+#include <memory>
 #include <asdxMisc.h>
 #include <asdxLogger.h>
 #include <asdxDeviceContext.h>
@@ -17,9 +18,15 @@
 namespace {
 
 //-----------------------------------------------------------------------------
-//      テクスチャをロードします.
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kAtlasPadding = 2;        // 画像間のパディング(バイリニア補間の滲み対策).
+static const uint32_t kMaxAtlasSize = 4096;     // アトラスの最大サイズ.
+
 //-----------------------------------------------------------------------------
-bool LoadTexture2D(const char* path, asdx::Texture2D& result)
+//      テクスチャリソースをロードします.
+//-----------------------------------------------------------------------------
+bool LoadResTexture(const char* path, asdx::ResTexture& result)
 {
     std::string texturePath;
     if (!asdx::SearchFilePathA(path, texturePath))
@@ -28,18 +35,63 @@ bool LoadTexture2D(const char* path, asdx::Texture2D& result)
         return false;
     }
 
-    asdx::ResTexture res;
-    if (!res.LoadFromFileA(texturePath.c_str()))
+    if (!result.LoadFromFileA(texturePath.c_str()))
     {
         ELOGA("Error : ResTexsture::LoadFromFileA() Failed. path = %s", texturePath.c_str());
         return false;
     }
 
-    auto pDevice  = asdx::DeviceContext::Instance().GetDevice();
-    auto pContext = asdx::DeviceContext::Instance().GetContext();
-    if (!result.Create(pDevice, pContext, res))
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      アトラスに詰め込めるかどうか?
+//-----------------------------------------------------------------------------
+bool IsPackable(const asdx::ResTexture& res)
+{
+    // ミップマップは先頭のみ使います. スプライトは等倍表示が前提です.
+    return res.Format       == DXGI_FORMAT_R8G8B8A8_UNORM
+        && res.SurfaceCount == 1
+        && res.Depth        <= 1
+        && res.pResources   != nullptr
+        && res.Width        <= kMaxAtlasSize
+        && res.Height       <= kMaxAtlasSize;
+}
+
+//-----------------------------------------------------------------------------
+//      アトラスからシェーダリソースビューを生成します.
+//-----------------------------------------------------------------------------
+bool CreateAtlasSRV(const TextureAtlas& atlas, uint32_t page, ID3D11ShaderResourceView** ppSRV)
+{
+    auto pDevice = asdx::DeviceContext::Instance().GetDevice();
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width              = atlas.GetWidth(page);
+    desc.Height             = atlas.GetHeight(page);
+    desc.MipLevels          = 1;
+    desc.ArraySize          = 1;
+    desc.Format             = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count   = 1;
+    desc.SampleDesc.Quality = 0;
+    desc.Usage              = D3D11_USAGE_IMMUTABLE;
+    desc.BindFlags          = D3D11_BIND_SHADER_RESOURCE;
+
+    D3D11_SUBRESOURCE_DATA res = {};
+    res.pSysMem     = atlas.GetPixels(page).data();
+    res.SysMemPitch = atlas.GetWidth(page) * 4;
+
+    asdx::RefPtr<ID3D11Texture2D> pTexture;
+    auto hr = pDevice->CreateTexture2D(&desc, &res, pTexture.GetAddress());
+    if (FAILED(hr))
+    {
+        ELOGA("Error : ID3D11Device::CreateTexture2D() Failed. errcode = 0x%x", hr);
+        return false;
+    }
+
+    hr = pDevice->CreateShaderResourceView(pTexture.GetPtr(), nullptr, ppSRV);
+    if (FAILED(hr))
     {
-        ELOGA("Error : Texture2D::Create() Failed. path = %s", texturePath.c_str());
+        ELOGA("Error : ID3D11Device::CreateShaderResourceView() Failed. errcode = 0x%x", hr);
         return false;
     }
 
@@ -74,34 +126,167 @@ TextureMgr& TextureMgr::Instance()
 //-----------------------------------------------------------------------------
 //      テクスチャをロードします.
 //-----------------------------------------------------------------------------
-bool TextureMgr::Load(uint32_t count, const char** paths)
+bool TextureMgr::Load(uint32_t count, const char** paths, uint32_t* pFirstIndex)
 {
-    m_Textures.resize(count);
+    auto first = uint32_t(m_Regions.size());
+    if (pFirstIndex != nullptr)
+    { *pFirstIndex = first; }
+
+    // 失敗したら，ここで追加した領域と単独テクスチャを取り消す.
+    // 領域が残ると GetRegion() が無効な領域を返してしまう.
+    auto textureCount = m_Textures.size();
+    m_Regions.resize(first + count);
+
+    // ピクセルデータはアトラス構築が終わるまで保持しておく.
+    std::unique_ptr<asdx::ResTexture[]> resources(new asdx::ResTexture[count]);
+    std::vector<uint32_t> packed;
+    TextureAtlas atlas;
+
     for(auto i=0u; i<count; ++i)
     {
-        if (!LoadTexture2D(paths[i], m_Textures[i]))
-        { return false; }
+        auto& res = resources[i];
+        if (!LoadResTexture(paths[i], res))
+        {
+            Rollback(first, textureCount);
+            return false;
+        }
+
+        if (IsPackable(res))
+        {
+            auto& sub = res.pResources[0];
+            atlas.Add(sub.Width, sub.Height, sub.Pitch, sub.pPixels);
+            packed.push_back(i);
+            continue;
+        }
+
+        if (!CreateStandalone(paths[i], res, m_Regions[first + i]))
+        {
+            Rollback(first, textureCount);
+            return false;
+        }
+    }
+
+    if (packed.empty())
+    { return true; }
+
+    // アトラスを構築. 1ページに収まらない分は次のページに入る.
+    // 最大サイズを超える画像があれば単独のテクスチャにする.
+    if (!atlas.Build(kAtlasPadding, kMaxAtlasSize))
+    {
+        ELOGA("Error : TextureAtlas::Build() Failed. Fallback to standalone textures.");
+        for(auto i : packed)
+        {
+            if (!CreateStandalone(paths[i], resources[i], m_Regions[first + i]))
+            {
+                Rollback(first, textureCount);
+                return false;
+            }
+        }
+        return true;
     }
 
+    std::vector<asdx::RefPtr<ID3D11ShaderResourceView>> pages(atlas.GetPageCount());
+    for(auto i=0u; i<atlas.GetPageCount(); ++i)
+    {
+        if (!CreateAtlasSRV(atlas, i, pages[i].GetAddress()))
+        {
+            Rollback(first, textureCount);
+            return false;
+        }
+    }
+
+    for(size_t j=0; j<packed.size(); ++j)
+    {
+        auto& entry = atlas.GetEntry(uint32_t(j));
+        m_Regions[first + packed[j]] = TextureRegion(
+            pages[entry.Page].GetPtr(),
+            entry.TexRect[0],
+            entry.TexRect[1],
+            entry.TexRect[2],
+            entry.TexRect[3]);
+    }
+
+    for(auto i=0u; i<atlas.GetPageCount(); ++i)
+    {
+        auto report = atlas.GetReport(i);
+        ILOGA("Info : Texture Atlas Page %u, %u x %u, images = %u, occupancy = %.1f%%",
+            i, report.Width, report.Height, report.ImageCount, report.Occupancy * 100.0f);
+
+        m_Atlases.push_back(pages[i]);
+        m_Reports.push_back(report);
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      単独のテクスチャとして生成します.
+//-----------------------------------------------------------------------------
+bool TextureMgr::CreateStandalone(const char* path, const asdx::ResTexture& res, TextureRegion& result)
+{
+    m_Textures.emplace_back();
+    auto& texture = m_Textures.back();
+
+    auto pDevice  = asdx::DeviceContext::Instance().GetDevice();
+    auto pContext = asdx::DeviceContext::Instance().GetContext();
+    if (!texture.Create(pDevice, pContext, res))
+    {
+        ELOGA("Error : Texture2D::Create() Failed. path = %s", path);
+        return false;
+    }
+
+    result = TextureRegion(texture.GetSRV());
     return true;
 }
 
+//-----------------------------------------------------------------------------
+//      ロードに失敗した分を取り消します.
+//-----------------------------------------------------------------------------
+void TextureMgr::Rollback(uint32_t firstRegion, size_t textureCount)
+{
+    m_Regions.resize(firstRegion);
+
+    while(m_Textures.size() > textureCount)
+    {
+        m_Textures.back().Release();
+        m_Textures.pop_back();
+    }
+}
+
 //-----------------------------------------------------------------------------
 //      テクスチャを破棄します.
 //-----------------------------------------------------------------------------
 void TextureMgr::Term()
 {
-    for(size_t i=0; i<m_Textures.size(); ++i)
-    { m_Textures[i].Release(); }
+    for(auto& itr : m_Textures)
+    { itr.Release(); }
 
     m_Textures.clear();
+    m_Atlases .clear();
+    m_Reports .clear();
+    m_Regions .clear();
 }
 
 //-----------------------------------------------------------------------------
-//      テクスチャを取得します.
+//      テクスチャ領域を取得します.
 //-----------------------------------------------------------------------------
-ID3D11ShaderResourceView* TextureMgr::GetSRV(uint32_t index)
+const TextureRegion& TextureMgr::GetRegion(uint32_t index) const
 {
-    assert(index < m_Textures.size());
-    return m_Textures[index].GetSRV();
-}
\ No newline at end of file
+    assert(index < m_Regions.size());
+    return m_Regions[index];
+}
+
+//-----------------------------------------------------------------------------
+//      アトラス数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TextureMgr::GetAtlasCount() const
+{ return uint32_t(m_Atlases.size()); }
+
+//-----------------------------------------------------------------------------
+//      アトラスの占有率レポートを取得します.
+//-----------------------------------------------------------------------------
+const AtlasReport& TextureMgr::GetAtlasReport(uint32_t index) const
+{
+    assert(index < m_Reports.size());
+    return m_Reports[index];
+}
@@ -0,0 +1,166 @@
+﻿//-----------------------------------------------------------------------------
+// File : TileCache.cpp
+// Desc : Pre-Expanded Tile Layer Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cassert>
+#include <TileCache.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kWhite = 0xffffffff;
+
+//-----------------------------------------------------------------------------
+//      タイルの位置を求めます.
+//-----------------------------------------------------------------------------
+inline void CalcTilePos(uint32_t index, int& x, int& y)
+{
+    x = kTileOffsetX + kTileSize * int(index % kTileCountX);
+    y = kTileOffsetY + kTileSize * int(index / kTileCountX);
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TileCache class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+TileCache::TileCache()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+TileCache::~TileCache()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      キャッシュを無効にします.
+//-----------------------------------------------------------------------------
+void TileCache::Invalidate()
+{ m_Dirty = true; }
+
+//-----------------------------------------------------------------------------
+//      作り直しが必要かどうか?
+//-----------------------------------------------------------------------------
+bool TileCache::IsDirty() const
+{ return m_Dirty; }
+
+//-----------------------------------------------------------------------------
+//      タイルからスプライトを展開してキャッシュします.
+//-----------------------------------------------------------------------------
+void TileCache::Build(const TileLayer& layer, TileTextureResolver resolver)
+{
+    assert(layer.IsValid());
+    assert(resolver != nullptr);
+
+    if (!m_Dirty)
+    { return; }
+
+    m_Instances.clear();
+    m_Textures .clear();
+    m_Ranges   .clear();
+    m_Instances.reserve(kTileTotalCount);
+    m_Textures .reserve(kTileTotalCount);
+
+    // 移動可能タイルは常に奥に表示するので1つの範囲にまとめる.
+    {
+        TileCacheRange range = {};
+        range.Start    = 0;
+        range.Obstacle = false;
+
+        for(auto i=0u; i<kTileTotalCount; ++i)
+        {
+            auto& tile = layer.GetTile(i);
+            if (!tile.Moveable)
+            { continue; }
+
+            int x, y;
+            CalcTilePos(i, x, y);
+            Push(tile, resolver, x, y);
+        }
+
+        range.Count = uint32_t(m_Instances.size());
+        if (range.Count > 0)
+        { m_Ranges.push_back(range); }
+    }
+
+    // 移動不可タイルはプレイヤーとの前後関係が行単位で変わるので，行毎にまとめる.
+    for(auto row=0u; row<kTileCountY; ++row)
+    {
+        TileCacheRange range = {};
+        range.Start    = uint32_t(m_Instances.size());
+        range.Y        = kTileOffsetY + kTileSize * int(row);
+        range.Obstacle = true;
+
+        for(auto col=0u; col<kTileCountX; ++col)
+        {
+            auto  idx  = row * kTileCountX + col;
+            auto& tile = layer.GetTile(idx);
+            if (tile.Moveable)
+            { continue; }
+
+            int x, y;
+            CalcTilePos(idx, x, y);
+            Push(tile, resolver, x, y);
+        }
+
+        range.Count = uint32_t(m_Instances.size()) - range.Start;
+        if (range.Count > 0)
+        { m_Ranges.push_back(range); }
+    }
+
+    m_BuildCount++;
+    m_Dirty = false;
+}
+
+//-----------------------------------------------------------------------------
+//      1タイル分のスプライトを追加します.
+//-----------------------------------------------------------------------------
+void TileCache::Push(const Tile& tile, TileTextureResolver resolver, int x, int y)
+{
+    auto& region = resolver(tile.TextureId);
+
+    m_Instances.push_back(PackSprite(
+        x, y, kTileSize, kTileSize,
+        region.TexRect[0], region.TexRect[1], region.TexRect[2], region.TexRect[3],
+        kWhite,
+        0));
+    m_Textures.push_back(region.pSRV);
+}
+
+//-----------------------------------------------------------------------------
+//      キャッシュしたスプライトを取得します.
+//-----------------------------------------------------------------------------
+const SpriteInstance* TileCache::GetInstances() const
+{ return m_Instances.data(); }
+
+//-----------------------------------------------------------------------------
+//      スプライト毎のテクスチャを取得します.
+//-----------------------------------------------------------------------------
+ID3D11ShaderResourceView* const* TileCache::GetTextures() const
+{ return m_Textures.data(); }
+
+//-----------------------------------------------------------------------------
+//      描画範囲を取得します.
+//-----------------------------------------------------------------------------
+const std::vector<TileCacheRange>& TileCache::GetRanges() const
+{ return m_Ranges; }
+
+//-----------------------------------------------------------------------------
+//      キャッシュを構築した回数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TileCache::GetBuildCount() const
+{ return m_BuildCount; }
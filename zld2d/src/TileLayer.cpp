@@ -0,0 +1,214 @@
+﻿//-----------------------------------------------------------------------------
+// File : TileLayer.cpp
+// Desc : Palette Indexed Tile Layer with Collision Bitsets.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <TileLayer.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      タイルが属性を持つかどうか?
+//-----------------------------------------------------------------------------
+inline bool HasFlag(const Tile& tile, uint32_t flag)
+{
+    switch(flag)
+    {
+    case TILE_FLAG_MOVEABLE:    return tile.Moveable;
+    case TILE_FLAG_SCROLLABLE:  return tile.Scrollable;
+    case TILE_FLAG_SWITCHABLE:  return tile.Switchable;
+    case TILE_FLAG_FALLABLE:    return tile.Fallable;
+    default:                    return false;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ピクセル位置からタイル番号を求めます. 範囲外は端のタイルに丸めます.
+//-----------------------------------------------------------------------------
+inline int ToTile(int pos, int offset, int count)
+{ return std::min(std::max((pos - offset) / kTileSize, 0), count - 1); }
+
+//-----------------------------------------------------------------------------
+//      矩形に掛かる行の範囲と列のマスクを求めます.
+//-----------------------------------------------------------------------------
+inline void CalcRange(const Box& box, uint32_t& rowBegin, uint32_t& rowEnd, uint32_t& mask)
+{
+    // 右端・下端は矩形に含まれる最後のピクセルで求める.
+    auto w  = std::max(box.Size.x, 1);
+    auto h  = std::max(box.Size.y, 1);
+    auto x0 = ToTile(box.Pos.x,         kTileOffsetX, kTileCountX);
+    auto y0 = ToTile(box.Pos.y,         kTileOffsetY, kTileCountY);
+    auto x1 = ToTile(box.Pos.x + w - 1, kTileOffsetX, kTileCountX);
+    auto y1 = ToTile(box.Pos.y + h - 1, kTileOffsetY, kTileCountY);
+
+    rowBegin = uint32_t(y0);
+    rowEnd   = uint32_t(y1) + 1;
+
+    // x0 列から x1 列までのビットを立てる. x1 < 31 なのでシフトは溢れない.
+    mask = ((2u << x1) - 1) & ~((1u << x0) - 1);
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TileLayer class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+TileLayer::TileLayer()
+: m_pIndices    (nullptr)
+, m_pPalette    (nullptr)
+, m_PaletteCount(0)
+{ memset(m_Bits, 0, sizeof(m_Bits)); }
+
+//-----------------------------------------------------------------------------
+//      タイル番号配列とパレットを設定し，ビット列を構築します.
+//-----------------------------------------------------------------------------
+void TileLayer::Init(uint8_t* pIndices, const Tile* pPalette, uint32_t paletteCount)
+{
+    assert(pIndices != nullptr);
+    assert(pPalette != nullptr);
+    assert(paletteCount > 0);
+
+    m_pIndices     = pIndices;
+    m_pPalette     = pPalette;
+    m_PaletteCount = paletteCount;
+
+    memset(m_Bits, 0, sizeof(m_Bits));
+    for(auto i=0u; i<kTileTotalCount; ++i)
+    { UpdateBits(i); }
+}
+
+//-----------------------------------------------------------------------------
+//      設定を解除します.
+//-----------------------------------------------------------------------------
+void TileLayer::Reset()
+{
+    m_pIndices     = nullptr;
+    m_pPalette     = nullptr;
+    m_PaletteCount = 0;
+    memset(m_Bits, 0, sizeof(m_Bits));
+}
+
+//-----------------------------------------------------------------------------
+//      設定済みかどうか?
+//-----------------------------------------------------------------------------
+bool TileLayer::IsValid() const
+{ return m_pIndices != nullptr; }
+
+//-----------------------------------------------------------------------------
+//      タイルを取得します.
+//-----------------------------------------------------------------------------
+const Tile& TileLayer::GetTile(uint32_t id) const
+{
+    assert(id < kTileTotalCount);
+    return m_pPalette[m_pIndices[id]];
+}
+
+//-----------------------------------------------------------------------------
+//      パレット番号を取得します.
+//-----------------------------------------------------------------------------
+uint8_t TileLayer::GetIndex(uint32_t id) const
+{
+    assert(id < kTileTotalCount);
+    return m_pIndices[id];
+}
+
+//-----------------------------------------------------------------------------
+//      パレット番号を書き換えます.
+//-----------------------------------------------------------------------------
+void TileLayer::SetIndex(uint32_t id, uint8_t index)
+{
+    assert(id < kTileTotalCount);
+    assert(index < m_PaletteCount);
+
+    m_pIndices[id] = index;
+    UpdateBits(id);
+}
+
+//-----------------------------------------------------------------------------
+//      矩形に掛かる全てのタイルが属性を持つかどうか?
+//-----------------------------------------------------------------------------
+bool TileLayer::TestAll(TILE_FLAG flag, const Box& box) const
+{
+    uint32_t rowBegin, rowEnd, mask;
+    CalcRange(box, rowBegin, rowEnd, mask);
+
+    // 途中で抜けると分岐予測が外れやすいので，最後にまとめて判定する.
+    auto miss = 0u;
+    for(auto row=rowBegin; row<rowEnd; ++row)
+    { miss |= ~m_Bits[flag][row]; }
+
+    return (miss & mask) == 0;
+}
+
+//-----------------------------------------------------------------------------
+//      矩形に掛かるタイルのどれかが属性を持つかどうか?
+//-----------------------------------------------------------------------------
+bool TileLayer::TestAny(TILE_FLAG flag, const Box& box) const
+{
+    uint32_t rowBegin, rowEnd, mask;
+    CalcRange(box, rowBegin, rowEnd, mask);
+
+    auto bits = 0u;
+    for(auto row=rowBegin; row<rowEnd; ++row)
+    { bits |= m_Bits[flag][row]; }
+
+    return (bits & mask) != 0;
+}
+
+//-----------------------------------------------------------------------------
+//      1行分のビット列を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TileLayer::GetRowBits(TILE_FLAG flag, uint32_t row) const
+{
+    assert(row < kTileCountY);
+    return m_Bits[flag][row];
+}
+
+//-----------------------------------------------------------------------------
+//      タイル番号配列を取得します.
+//-----------------------------------------------------------------------------
+const uint8_t* TileLayer::GetIndices() const
+{ return m_pIndices; }
+
+//-----------------------------------------------------------------------------
+//      パレットを取得します.
+//-----------------------------------------------------------------------------
+const Tile* TileLayer::GetPalette() const
+{ return m_pPalette; }
+
+//-----------------------------------------------------------------------------
+//      パレットのタイル種別数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TileLayer::GetPaletteCount() const
+{ return m_PaletteCount; }
+
+//-----------------------------------------------------------------------------
+//      1タイル分のビットを更新します.
+//-----------------------------------------------------------------------------
+void TileLayer::UpdateBits(uint32_t id)
+{
+    auto& tile = m_pPalette[m_pIndices[id]];
+    auto  row  = id / kTileCountX;
+    auto  bit  = 1u << (id % kTileCountX);
+
+    for(auto i=0u; i<TILE_FLAG_COUNT; ++i)
+    {
+        if (HasFlag(tile, i))
+        { m_Bits[i][row] |= bit; }
+        else
+        { m_Bits[i][row] &= ~bit; }
+    }
+}
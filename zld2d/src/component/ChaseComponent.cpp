@@ -0,0 +1,51 @@
+﻿//-----------------------------------------------------------------------------
+// File : ChaseComponent.cpp
+// Desc : Enemy Component Chasing the Player.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cassert>
+#include <component/ChaseComponent.h>
+#include <MapSystem.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ChaseComponent class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ChaseComponent::ChaseComponent(int speed)
+: m_Speed(speed)
+{ assert(speed > 0 && (kTileSize % speed) == 0); }
+
+//-----------------------------------------------------------------------------
+//      更新処理を行います.
+//-----------------------------------------------------------------------------
+void ChaseComponent::Update(UpdateContext& context, Enemy& enemy)
+{
+    if (context.Map == nullptr || context.Map->IsScroll() || context.Map->IsSwitch())
+    { return; }
+
+    // MapSystem::CanMove() はスクロールの判定も兼ねるので使わず，
+    // 通行可能なタイルだけを辿るフローフィールドに従う.
+    if (m_Remain == 0)
+    {
+        auto dir = context.Map->GetFlowDir(enemy.GetBox());
+        if (dir == DIRECTION_NONE)
+        { return; }
+
+        enemy.SetDir(dir);
+        m_Remain = kTileSize;
+    }
+
+    auto box = enemy.GetBox();
+    box.Pos += GetMoveDir(enemy.GetDir()) * m_Speed;
+    enemy.SetBox(box);
+
+    m_Remain -= m_Speed;
+}
@@ -11,6 +11,7 @@
 #include <gimmick/Block.h>
 #include <MapSystem.h>
 #include <asdxLogger.h>
+#include <MessageMgr.h>
 #include <MessageId.h>
 
 
@@ -34,14 +35,15 @@ static const int        kDetectFrame = 30;
 //      コンストラクタです.
 //-----------------------------------------------------------------------------
 Block::Block()
-: m_Frame(kDetectFrame)
+: Gimmick(MAP_GIMMICK_BLOCK)
+, m_Frame(kDetectFrame)
 { /* DO_NOTHING */ }
 
 //-----------------------------------------------------------------------------
 //      デストラクタです.
 //-----------------------------------------------------------------------------
 Block::~Block()
-{ m_pSRV = nullptr; }
+{ m_Region = TextureRegion(); }
 
 //-----------------------------------------------------------------------------
 //      移動方向を設定します.
@@ -61,8 +63,10 @@ void Block::Reset()
     m_Moved    = 0;
     m_Flags    = 0;
     m_Frame    = kDetectFrame;
+    m_CurrHit  = false;
     m_PrevHit  = false;
     m_Dir      = m_InitDir;
+    UpdateGrid();
 }
 
 //-----------------------------------------------------------------------------
@@ -113,31 +117,66 @@ void Block::Update(UpdateContext& context)
     {
         m_Box.Pos += GetMoveDir(m_Dir) * kMovePixel;
         m_Moved   += kMovePixel;
+        UpdateGrid();
 
-        // タイルサイズ分移動したら完了.
+        // タイルサイズ分移動したら完了. 塞ぐタイルが変わったので経路を作り直してもらう.
         if (m_Moved >= kTileSize)
-        { m_Flags = kComplete; }
+        {
+            m_Flags = kComplete;
+
+            Message msg(MESSAGE_ID_GIMMICK_MOVED);
+            SendMsg(msg);
+        }
     }
 
+    // CanMove() は重なった時しか呼ばれないので，毎フレーム落としておく.
     m_PrevHit = m_CurrHit;
+    m_CurrHit = false;
 }
 
 //-----------------------------------------------------------------------------
-//      メッセージ受信処理を行います.
+//      押し終わっていれば移動先のタイルを書き出します.
 //-----------------------------------------------------------------------------
-void Block::OnMessage(const Message& msg)
+bool Block::SaveState(MapGimmickState& state) const
 {
-    switch(msg.GetType())
-    {
-    case MESSAGE_ID_MAP_SCROLL:
-        OnScroll(msg);
-        break;
+    // 押している途中で部屋を出た場合は配置時に戻す.
+    if (m_Flags != kComplete)
+    { return false; }
+
+    auto index = CalcTileIndex(m_Box.Pos.x, m_Box.Pos.y);
+    state.TileX = uint8_t(index.x);
+    state.TileY = uint8_t(index.y);
+    state.Flags = 0;
+    return true;
+}
 
-    case MESSAGE_ID_MAP_CHANGED:
-        OnScrollCompleted();
-        break;
+//-----------------------------------------------------------------------------
+//      押し終わった状態にします.
+//-----------------------------------------------------------------------------
+void Block::LoadState(const MapGimmickState& state)
+{
+    // 1タイル分ずれた方向を押した方向とする. Reset() で配置時に戻せるように揃えておく.
+    auto pos = CalcPosFromTile(state.TileX, state.TileY);
+    auto dir = DIRECTION_NONE;
+    for(auto i=0; i<DIRECTION_NONE; ++i)
+    {
+        auto moved = m_Box.Pos + GetMoveDir(DIRECTION_STATE(i)) * kTileSize;
+        if (moved.x == pos.x && moved.y == pos.y)
+        {
+            dir = DIRECTION_STATE(i);
+            break;
+        }
+    }
 
-    default:
-        break;
+    if (dir == DIRECTION_NONE)
+    {
+        WLOGA("Warning : Invalid Block State. tile = (%u, %u)", state.TileX, state.TileY);
+        return;
     }
+
+    m_Box.Pos = pos;
+    m_Dir     = dir;
+    m_Moved   = kTileSize;
+    m_Flags   = kComplete;
+    UpdateGrid();
 }
@@ -0,0 +1,90 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestCommon.h
+// Desc : Common Helpers for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+
+//-----------------------------------------------------------------------------
+// Macros
+//-----------------------------------------------------------------------------
+
+// 条件が偽なら失敗を記録します. 続きのチェックも実行します.
+#define CHECK(x)                                                            \
+    do {                                                                    \
+        if (!(x))                                                           \
+        {                                                                   \
+            fprintf(stderr, "%s(%d) : CHECK(%s) failed.\n",                 \
+                __FILE__, __LINE__, #x);                                    \
+            ++TestFailCount();                                              \
+        }                                                                   \
+    } while(0)
+
+// 値が一致しなければ失敗を記録します. 比較した値も表示します.
+#define CHECK_EQ(a, b)                                                      \
+    do {                                                                    \
+        auto lhs_ = (a);                                                    \
+        auto rhs_ = (b);                                                    \
+        if (!(lhs_ == rhs_))                                                \
+        {                                                                   \
+            fprintf(stderr, "%s(%d) : CHECK_EQ(%s, %s) failed. %lld != %lld\n", \
+                __FILE__, __LINE__, #a, #b,                                 \
+                static_cast<long long>(lhs_), static_cast<long long>(rhs_)); \
+            ++TestFailCount();                                              \
+        }                                                                   \
+    } while(0)
+
+
+//-----------------------------------------------------------------------------
+//      失敗数を取得します.
+//-----------------------------------------------------------------------------
+inline uint32_t& TestFailCount()
+{
+    static uint32_t s_Count = 0;
+    return s_Count;
+}
+
+//-----------------------------------------------------------------------------
+//      テストを実行します.
+//-----------------------------------------------------------------------------
+template<typename Func>
+inline void RunTest(const char* name, Func func)
+{
+    auto prev = TestFailCount();
+    func();
+    printf("[%s] %s\n", (TestFailCount() == prev) ? "  OK  " : "FAILED", name);
+}
+
+//-----------------------------------------------------------------------------
+//      テスト結果から終了コードを求めます.
+//-----------------------------------------------------------------------------
+inline int TestResult()
+{ return (TestFailCount() == 0) ? EXIT_SUCCESS : EXIT_FAILURE; }
+
+//-----------------------------------------------------------------------------
+//      処理時間を計測します. 結果はミリ秒で返します.
+//-----------------------------------------------------------------------------
+template<typename Func>
+inline double MeasureMsec(Func func)
+{
+    auto begin = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+//-----------------------------------------------------------------------------
+//      ダミーのシェーダリソースビューを作ります. アドレスの比較にだけ使います.
+//-----------------------------------------------------------------------------
+template<typename T>
+inline T* FakePointer(uintptr_t id)
+{ return reinterpret_cast<T*>((id + 1) * 64); }
@@ -0,0 +1,106 @@
+﻿//-----------------------------------------------------------------------------
+// File : TestTextureMgr.cpp
+// Desc : Texture Manager for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TextureMgr.h>
+#include <TestCommon.h>
+#include <cassert>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// TextureMgr class
+///////////////////////////////////////////////////////////////////////////////
+//  TextureMgr.cpp は D3D11 でテクスチャを作るので，テストでは画像を読まずに
+//  1回のロードを1枚のダミーのアトラスとし，画像を横に並べた領域を割り当てる.
+//  領域番号の扱いは本体と同じ.
+TextureMgr TextureMgr::s_Instance = {};
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+TextureMgr::TextureMgr()
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+TextureMgr::~TextureMgr()
+{ Term(); }
+
+//-----------------------------------------------------------------------------
+//      シングルトンインスタンスを取得します.
+//-----------------------------------------------------------------------------
+TextureMgr& TextureMgr::Instance()
+{ return s_Instance; }
+
+//-----------------------------------------------------------------------------
+//      テクスチャをロードします.
+//-----------------------------------------------------------------------------
+bool TextureMgr::Load(uint32_t count, const char** paths, uint32_t* pFirstIndex)
+{
+    (void)paths;
+
+    auto first = uint32_t(m_Regions.size());
+    if (pFirstIndex != nullptr)
+    { *pFirstIndex = first; }
+
+    auto pSRV = FakePointer<ID3D11ShaderResourceView>(1000 + m_Atlases.size());
+    for(auto i=0u; i<count; ++i)
+    { m_Regions.push_back(TextureRegion(pSRV, float(i) / count, 0.0f, float(i + 1) / count, 1.0f)); }
+
+    AtlasReport report = {};
+    report.ImageCount = count;
+    m_Atlases.emplace_back();
+    m_Reports.push_back(report);
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ロードに失敗した分を取り消します.
+//-----------------------------------------------------------------------------
+void TextureMgr::Rollback(uint32_t firstRegion, size_t textureCount)
+{
+    (void)textureCount;
+    m_Regions.resize(firstRegion);
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャを破棄します.
+//-----------------------------------------------------------------------------
+void TextureMgr::Term()
+{
+    m_Textures.clear();
+    m_Atlases .clear();
+    m_Reports .clear();
+    m_Regions .clear();
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャ領域を取得します.
+//-----------------------------------------------------------------------------
+const TextureRegion& TextureMgr::GetRegion(uint32_t index) const
+{
+    assert(index < m_Regions.size());
+    return m_Regions[index];
+}
+
+//-----------------------------------------------------------------------------
+//      アトラス数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t TextureMgr::GetAtlasCount() const
+{ return uint32_t(m_Atlases.size()); }
+
+//-----------------------------------------------------------------------------
+//      アトラスの占有率レポートを取得します.
+//-----------------------------------------------------------------------------
+const AtlasReport& TextureMgr::GetAtlasReport(uint32_t index) const
+{
+    assert(index < m_Reports.size());
+    return m_Reports[index];
+}
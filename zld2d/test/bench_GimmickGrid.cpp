@@ -0,0 +1,144 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_GimmickGrid.cpp
+// Desc : Benchmark for Gimmick Grid.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <GimmickGrid.h>
+#include <MapTile.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kQueryCount   = 1024;
+static const uint32_t kTrialCount   = 5;
+static const uint32_t kPerCell      = 4;    // セルあたりのギミック数の目安.
+
+//-----------------------------------------------------------------------------
+//      1回あたりの時間(ナノ秒)を計測します. 最も速かった回を返します.
+//-----------------------------------------------------------------------------
+template<typename Func>
+double MeasureNsec(uint32_t repeat, uint32_t count, Func func)
+{
+    auto best = 1e30;
+    for(auto trial=0u; trial<kTrialCount; ++trial)
+    {
+        auto msec = MeasureMsec([&]()
+        {
+            for(auto i=0u; i<repeat; ++i)
+            { func(); }
+        });
+        best = std::min(best, msec * 1e6 / (double(repeat) * count));
+    }
+    return best;
+}
+
+//-----------------------------------------------------------------------------
+//      ギミックを n 個配置して計測します.
+//-----------------------------------------------------------------------------
+void Run(uint32_t n, bool scaled, uint32_t& sum)
+{
+    // scaled なら密度が一定になるように部屋を広げる.
+    auto countX = uint32_t(kTileCountX);
+    auto countY = uint32_t(kTileCountY);
+    if (scaled)
+    {
+        auto cells = std::max(1u, n / kPerCell);
+        countX = std::max(countX, uint32_t(std::sqrt(cells * 16.0 / 9.0)));
+        countY = std::max(countY, cells / countX + 1);
+    }
+    auto w = int(countX * kTileSize);
+    auto h = int(countY * kTileSize);
+
+    asdx::PCG rng(n);
+
+    GimmickGrid grid;
+    grid.Init(0, 0, kTileSize, countX, countY);
+
+    std::vector<Box>      boxes(n);
+    std::vector<uint32_t> ids  (n);
+    for(auto i=0u; i<n; ++i)
+    {
+        boxes[i] = Box(int(rng.GetAsU32() % w), int(rng.GetAsU32() % h), kTileSize, kTileSize);
+        ids  [i] = grid.Insert(FakePointer<Gimmick>(i), boxes[i]);
+    }
+
+    std::vector<Box> queries(kQueryCount);
+    for(auto& box : queries)
+    { box = Box(int(rng.GetAsU32() % w), int(rng.GetAsU32() % h), 48, 48); }
+
+    // 以前の CanMove() のように全件を調べる場合.
+    auto scan = MeasureNsec(std::max(1u, 2000u / n), kQueryCount, [&]()
+    {
+        for(auto& query : queries)
+        {
+            for(auto& box : boxes)
+            { sum += IsHit(query, box) ? 1 : 0; }
+        }
+    });
+
+    // 部屋が狭いまま数が増えると1セルあたりの数も増えるので，回数を減らす.
+    std::vector<Gimmick*> hits;
+    auto hitCount = 0.0;
+    for(auto& box : queries)
+    {
+        grid.Query(box, hits);
+        hitCount += double(hits.size());
+    }
+
+    auto query = MeasureNsec(scaled ? 200u : std::max(1u, 200000u / n), kQueryCount, [&]()
+    {
+        for(auto& box : queries)
+        {
+            grid.Query(box, hits);
+            sum += uint32_t(hits.size());
+        }
+    });
+
+    // Block が 2px ずつ押される相当の移動.
+    auto moveCount = std::min(n, 1000u);
+    auto move = MeasureNsec(64, moveCount, [&]()
+    {
+        for(auto i=0u; i<moveCount; ++i)
+        {
+            boxes[i].Pos.x = (boxes[i].Pos.x + 2) % w;
+            grid.Move(ids[i], boxes[i]);
+        }
+    });
+
+    printf("  %6u gimmicks, %4u x %4u cells : scan %10.1f ns, grid query %8.1f ns (%6.1f hits), move %5.1f ns\n",
+        n, countX, countY, scan, query, hitCount / kQueryCount, move);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    uint32_t sum = 0;
+
+    printf("GimmickGrid : area scaled with count (about %u gimmicks per cell)\n", kPerCell);
+    for(auto n : { 10u, 1000u, 100000u })
+    { Run(n, true, sum); }
+
+    printf("GimmickGrid : fixed room (%u x %u cells)\n", uint32_t(kTileCountX), uint32_t(kTileCountY));
+    for(auto n : { 10u, 1000u, 100000u })
+    { Run(n, false, sum); }
+
+    printf("  (sum %u)\n", sum);
+    return 0;
+}
@@ -0,0 +1,153 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_GimmickPool.cpp
+// Desc : Benchmark for Gimmick Update and Collision.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <MapSystem.h>
+#include <MessageMgr.h>
+#include <TextureId.h>
+#include <TextureMgr.h>
+#include <asdxMath.h>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kFrameCount   = 200;
+static const uint32_t kBoxCount     = 64;      // 1フレームあたりの当たり判定の回数.
+static const uint32_t kLoadCount    = 20;
+static const char*    kPath         = "obj/bench_GimmickPool.map";
+
+//-----------------------------------------------------------------------------
+//      ブロックを n 個置いた部屋を書き出します.
+//-----------------------------------------------------------------------------
+bool WriteRoom(uint32_t n, asdx::PCG& rng)
+{
+    Tile tiles[kTileTotalCount] = {};
+    for(auto& itr : tiles)
+    { itr.Moveable = true; }
+
+    std::vector<MapGimmickDesc> gimmicks(n);
+    for(auto& itr : gimmicks)
+    {
+        itr = {};
+        itr.Type   = MAP_GIMMICK_BLOCK;
+        itr.TileX  = uint8_t(1 + rng.GetAsU32() % (kTileCountX - 2));
+        itr.TileY  = uint8_t(1 + rng.GetAsU32() % (kTileCountY - 2));
+        itr.Width  = kTileSize;
+        itr.Height = kTileSize;
+        itr.Dir    = uint8_t(rng.GetAsU32() % (DIRECTION_NONE + 1));
+    }
+
+    return WriteMapFile(kPath, tiles, gimmicks.data(), n, true);
+}
+
+//-----------------------------------------------------------------------------
+//      ギミックを n 個配置して計測します.
+//-----------------------------------------------------------------------------
+bool Run(uint32_t n)
+{
+    asdx::PCG rng(n);
+    if (!WriteRoom(n, rng))
+    { return false; }
+
+    // 部屋の出入り.
+    MapInstance instance;
+    auto load = MeasureMsec([&]()
+    {
+        for(auto i=0u; i<kLoadCount; ++i)
+        {
+            instance.Load(kPath);
+            instance.Dispose();
+        }
+    });
+
+    if (!instance.Load(kPath))
+    { return false; }
+    instance.Activate();
+
+    MapSystem system;
+    system.SetData(&instance);
+
+    std::vector<Box> boxes(kBoxCount);
+    for(auto& itr : boxes)
+    {
+        itr = Box(
+            kTileOffsetX + int(rng.GetAsU32() % (kTileSize * (kTileCountX - 1))),
+            kTileOffsetY + int(rng.GetAsU32() % (kTileSize * (kTileCountY - 1))),
+            48, 48);
+    }
+
+    Box red = boxes[0];
+    UpdateContext context = {};
+    context.Map    = &system;
+    context.BoxRed = &red;
+
+    // 当たり判定で重なったブロックは押され始めるので，更新も実際に動く分を含む.
+    auto update    = 0.0;
+    auto collision = 0.0;
+    auto moveable  = 0u;
+    for(auto frame=0u; frame<kFrameCount; ++frame)
+    {
+        context.PlayerDir = uint8_t((frame / 40) % 4);
+
+        collision += MeasureMsec([&]()
+        {
+            for(auto& box : boxes)
+            { moveable += system.CanMove(box) ? 1 : 0; }
+        });
+
+        update += MeasureMsec([&]()
+        { system.Update(context); });
+
+        MessageMgr::Instance().Process();
+    }
+
+    printf("  %6u gimmicks : update %8.1f us / frame (%5.2f ns / gimmick), collision %7.2f us / query, load + dispose %8.1f us (%u)\n",
+        n,
+        update * 1000.0 / kFrameCount,
+        update * 1e6 / (double(kFrameCount) * n),
+        collision * 1000.0 / (double(kFrameCount) * kBoxCount),
+        load * 1000.0 / kLoadCount,
+        moveable);
+
+    system.SetData(nullptr);
+    instance.Dispose();
+    return true;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    if (!MessageMgr::Instance().Init(1 << 22))
+    { return 1; }
+
+    // ギミックがテクスチャ領域を引くので，先に登録しておく.
+    if (!TextureMgr::Instance().Load(TEXTURE_COUNT, kTextureNames))
+    { return 1; }
+
+    printf("GimmickPool : %u frames, %u collision queries per frame, blocks in one 19x11 room\n", kFrameCount, kBoxCount);
+    for(auto n : { 100u, 1000u, 10000u, 50000u })
+    {
+        if (!Run(n))
+        { return 1; }
+    }
+
+    remove(kPath);
+    TextureMgr::Instance().Term();
+    MessageMgr::Instance().Term();
+    return 0;
+}
@@ -0,0 +1,140 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_GlyphCache.cpp
+// Desc : Benchmark for Glyph Atlas Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <GlyphCache.h>
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kFontSize     = 24;
+static const uint32_t kLineLength   = 40;
+static const uint32_t kRepeat       = 100000;
+static const uint32_t kColdCount    = 200;      // 1回の計測でラスタライズする文字数.
+static const uint32_t kTrialCount   = 5;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// BoxFont class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      どの文字も同じ大きさの矩形を返すフォントです. ラスタライズの費用は含みません.
+///////////////////////////////////////////////////////////////////////////////
+class BoxFont : public IGlyphRasterizer
+{
+public:
+    bool Rasterize(uint32_t code, GlyphBitmap& result) override
+    {
+        result.Advance  = int32_t(kFontSize);
+        result.OffsetX  = 1;
+        result.OffsetY  = -int32_t(kFontSize) + 4;
+        result.Width    = kFontSize - 2;
+        result.Height   = kFontSize - 2;
+        result.Coverage.assign(result.Width * result.Height, uint8_t(code));
+        return true;
+    }
+
+    int32_t GetAdvance(uint32_t) override
+    { return int32_t(kFontSize); }
+
+    int32_t GetAscent() const override
+    { return int32_t(kFontSize) - 4; }
+
+    int32_t GetLineHeight() const override
+    { return int32_t(kFontSize) + 4; }
+};
+
+//-----------------------------------------------------------------------------
+//      TextWriter と同じ設定を取得します.
+//-----------------------------------------------------------------------------
+GlyphCacheDesc GetDesc()
+{
+    GlyphCacheDesc desc = {};
+    desc.PageSize       = 1024;
+    desc.PageCount      = 4;
+    desc.CellSize       = kFontSize + 2 + 4;
+    desc.OutlineRadius  = 1;
+    return desc;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    BoxFont font;
+
+    // 会話1行分(ひらがな 40 文字).
+    wchar_t line[kLineLength + 1] = {};
+    for(auto i=0u; i<kLineLength; ++i)
+    { line[i] = wchar_t(0x3042 + i); }
+
+    printf("GlyphCache : %upx glyphs, outline 1, best of %u\n", kFontSize, kTrialCount);
+
+    // 全ての文字がキャッシュ済みの行.
+    {
+        GlyphCache cache;
+        if (!cache.Init(&font, GetDesc()))
+        { return 1; }
+
+        std::vector<GlyphQuad> quads;
+        cache.NewFrame();
+        cache.BuildQuads(line, 0, 0, quads);
+
+        auto best = 1e30;
+        auto sum  = 0u;
+        for(auto trial=0u; trial<kTrialCount; ++trial)
+        {
+            auto time = MeasureMsec([&]
+            {
+                for(auto i=0u; i<kRepeat; ++i)
+                {
+                    quads.clear();
+                    sum += cache.BuildQuads(line, 0, 0, quads);
+                }
+            });
+            best = std::min(best, time);
+        }
+
+        printf("  cached %u-glyph line : %6.3f us (%zu quads, sum %u)\n",
+            kLineLength, best * 1000.0 / kRepeat, quads.size(), sum);
+        cache.Term();
+    }
+
+    // 毎回ラスタライズしてアトラスに書き込む場合.
+    {
+        auto best = 1e30;
+        for(auto trial=0u; trial<kTrialCount; ++trial)
+        {
+            GlyphCache cache;
+            if (!cache.Init(&font, GetDesc()))
+            { return 1; }
+            cache.NewFrame();
+
+            auto time = MeasureMsec([&]
+            {
+                for(auto i=0u; i<kColdCount; ++i)
+                { cache.Find(0x4e00 + i); }
+            });
+            best = std::min(best, time);
+            cache.Term();
+        }
+
+        printf("  first use of a glyph : %6.3f us\n", best * 1000.0 / kColdCount);
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_MapFormat.cpp
+// Desc : Benchmark for Binary Map File Loading.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <MapFormat.h>
+#include <MappedFile.h>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kLoadCount = 20000;
+
+//-----------------------------------------------------------------------------
+//      マッピングして検証します.
+//-----------------------------------------------------------------------------
+uint32_t LoadMapped(const char* path)
+{
+    MappedFile  file;
+    MapFileView view = {};
+    if (!file.Open(path) || !ResolveMapFile(file.GetData(), file.GetSize(), view))
+    { return 0; }
+
+    return view.pTileIndices[100];
+}
+
+//-----------------------------------------------------------------------------
+//      ファイル全体を読み込んでから検証します.
+//-----------------------------------------------------------------------------
+uint32_t LoadRead(const char* path, std::vector<uint64_t>& buffer)
+{
+    FILE* pFile = fopen(path, "rb");
+    if (pFile == nullptr)
+    { return 0; }
+
+    fseek(pFile, 0, SEEK_END);
+    auto size = size_t(ftell(pFile));
+    fseek(pFile, 0, SEEK_SET);
+
+    buffer.resize((size + 7) / 8);
+    auto pData = reinterpret_cast<uint8_t*>(buffer.data());
+    auto count = fread(pData, 1, size, pFile);
+    fclose(pFile);
+
+    MapFileView view = {};
+    if (count != size || !ResolveMapFile(pData, size, view))
+    { return 0; }
+
+    return view.pTileIndices[100];
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    const char* kPath      = "../res/map/room_000.map";
+    const char* kPlainPath = "obj/bench_MapFormat.map";
+
+    // チェックサム無しの版を作る.
+    {
+        MappedFile  file;
+        MapFileView view = {};
+        if (!file.Open(kPath) || !ResolveMapFile(file.GetData(), file.GetSize(), view))
+        {
+            fprintf(stderr, "Error : Map Load Failed. path = %s\n", kPath);
+            return 1;
+        }
+
+        WriteMapFile(kPlainPath, view.pTileIndices, view.pPalette, view.PaletteCount, view.pGimmicks, view.GimmickCount, false);
+        printf("MapFormat : %s (%zu bytes), %u loads\n", kPath, file.GetSize(), kLoadCount);
+    }
+
+    std::vector<uint64_t> buffer;
+    uint32_t sum = 0;
+
+    auto mapped = MeasureMsec([&]
+    {
+        for(auto i=0u; i<kLoadCount; ++i)
+        { sum += LoadMapped(kPath); }
+    });
+    auto mappedPlain = MeasureMsec([&]
+    {
+        for(auto i=0u; i<kLoadCount; ++i)
+        { sum += LoadMapped(kPlainPath); }
+    });
+    auto read = MeasureMsec([&]
+    {
+        for(auto i=0u; i<kLoadCount; ++i)
+        { sum += LoadRead(kPath, buffer); }
+    });
+    auto readPlain = MeasureMsec([&]
+    {
+        for(auto i=0u; i<kLoadCount; ++i)
+        { sum += LoadRead(kPlainPath, buffer); }
+    });
+
+    printf("  mmap  + resolve (checksum)    : %6.2f us\n", mapped      * 1000.0 / kLoadCount);
+    printf("  mmap  + resolve (no checksum) : %6.2f us\n", mappedPlain * 1000.0 / kLoadCount);
+    printf("  fread + resolve (checksum)    : %6.2f us\n", read        * 1000.0 / kLoadCount);
+    printf("  fread + resolve (no checksum) : %6.2f us\n", readPlain   * 1000.0 / kLoadCount);
+    printf("  (checksum %u)\n", sum);
+
+    remove(kPlainPath);
+    return 0;
+}
@@ -0,0 +1,179 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_MapSource.cpp
+// Desc : Benchmark for Map Compiler Text Sources.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <MapSource.h>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char*    kWorkDir      = "obj/bench_MapSource";
+static const uint32_t kWorldX       = 25;
+static const uint32_t kWorldY       = 20;      // 25 x 20 = 500 部屋.
+static const uint32_t kGimmickCount = 8;
+static const uint32_t kTrialCount   = 5;
+
+
+//-----------------------------------------------------------------------------
+//      テキストファイルを書き出します.
+//-----------------------------------------------------------------------------
+bool WriteText(const std::string& path, const std::string& text)
+{
+    auto pFile = fopen(path.c_str(), "wb");
+    if (pFile == nullptr)
+    { return false; }
+
+    fwrite(text.data(), 1, text.size(), pFile);
+    fclose(pFile);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      部屋名を取得します.
+//-----------------------------------------------------------------------------
+std::string GetRoomName(uint32_t x, uint32_t y)
+{
+    char name[32];
+    sprintf(name, "room_%02u_%02u", x, y);
+    return name;
+}
+
+//-----------------------------------------------------------------------------
+//      格子状に繋がった部屋ソースと接続ファイルを書き出します.
+//      スクロールタイルは接続のある境界の中央にだけ置きます.
+//-----------------------------------------------------------------------------
+bool WriteWorld()
+{
+    std::string world;
+    std::string links;
+    for(auto y=0u; y<kWorldY; ++y)
+    {
+        for(auto x=0u; x<kWorldX; ++x)
+        {
+            auto name = GetRoomName(x, y);
+            world += "room\t" + name + "\t" + name + ".map\n";
+            if (x + 1 < kWorldX)
+            { links += "link\t" + name + "\tright\t" + GetRoomName(x + 1, y) + "\n"; }
+            if (y + 1 < kWorldY)
+            { links += "link\t" + name + "\tdown\t" + GetRoomName(x, y + 1) + "\n"; }
+
+            std::string room =
+                "tile\tT\tmap_tree\n"
+                "tile\tS\twhite\tmove\tscroll\n"
+                "tile\t.\twhite\tmove\n";
+            for(auto r=0; r<kTileCountY; ++r)
+            {
+                std::string row(kTileCountX, '.');
+                if (r == 0 || r == kTileCountY - 1)
+                { row.assign(kTileCountX, 'T'); }
+                row.front() = row.back() = 'T';
+
+                if (r == kTileCountY / 2)
+                {
+                    if (x > 0)           { row.front() = 'S'; }
+                    if (x + 1 < kWorldX) { row.back()  = 'S'; }
+                }
+                if (r == 0 && y > 0)
+                { row[kTileCountX / 2] = 'S'; }
+                if (r == kTileCountY - 1 && y + 1 < kWorldY)
+                { row[kTileCountX / 2] = 'S'; }
+
+                room += "row\t" + row + "\n";
+            }
+            for(auto i=0u; i<kGimmickCount; ++i)
+            {
+                room += "gimmick\tblock\t" + std::to_string(2 + i * 2) + "\t"
+                      + std::to_string(2 + i % 7) + "\tmap_block\tnone\n";
+            }
+
+            if (!WriteText(std::string(kWorkDir) + "/" + name + ".room", room))
+            { return false; }
+        }
+    }
+
+    return WriteText(std::string(kWorkDir) + "/world.txt", world + links);
+}
+
+//-----------------------------------------------------------------------------
+//      mapc と同じ手順で全部屋を読み込んで検証し，必要なら書き出します(1スレッド).
+//-----------------------------------------------------------------------------
+bool Compile(bool write)
+{
+    auto worldPath = std::string(kWorkDir) + "/world.txt";
+
+    WorldSource world;
+    if (!LoadWorldSource(worldPath.c_str(), world))
+    { return false; }
+
+    std::vector<RoomSource> rooms(world.Rooms.size());
+    for(size_t i=0; i<rooms.size(); ++i)
+    {
+        auto path = std::string(kWorkDir) + "/" + world.Rooms[i].Name + ".room";
+        if (!LoadRoomSource(path.c_str(), rooms[i]))
+        { return false; }
+    }
+
+    if (!ValidateLinks(worldPath.c_str(), world, rooms, true))
+    { return false; }
+
+    if (write)
+    {
+        for(size_t i=0; i<rooms.size(); ++i)
+        {
+            auto  path = std::string(kWorkDir) + "/" + world.Rooms[i].File;
+            auto& room = rooms[i];
+            if (!WriteMapFile(path.c_str(), room.Tiles, room.Gimmicks.data(), uint32_t(room.Gimmicks.size()), true))
+            { return false; }
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    std::error_code err;
+    std::filesystem::create_directories(kWorkDir, err);
+    if (!WriteWorld())
+    {
+        fprintf(stderr, "Error : World Write Failed. path = %s\n", kWorkDir);
+        return 1;
+    }
+
+    printf("MapSource : %u rooms (%u x %u grid, %u blocks each), 1 thread, best of %u\n",
+        kWorldX * kWorldY, kWorldX, kWorldY, kGimmickCount, kTrialCount);
+
+    auto ok    = true;
+    auto build = 1e30;
+    auto parse = 1e30;
+    for(auto trial=0u; trial<kTrialCount; ++trial)
+    {
+        build = std::min(build, MeasureMsec([&]{ ok &= Compile(true);  }));
+        parse = std::min(parse, MeasureMsec([&]{ ok &= Compile(false); }));
+    }
+
+    printf("  parse + validate + write all : %7.1f ms\n", build);
+    printf("  parse + validate only        : %7.1f ms\n", parse);
+
+    std::filesystem::remove_all(kWorkDir, err);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_PathFinder.cpp
+// Desc : Benchmark for Path Finder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <PathFinder.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kFrameCount   = 600;      // 10秒分.
+static const uint32_t kGoalFrame    = 16;       // プレイヤーが1タイル進むフレーム数.
+static const uint32_t kTrialCount   = 5;
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    asdx::PCG rng(11);
+
+    // 1/4 が通行不可のランダムな部屋.
+    Tile palette[2] = {};
+    palette[1].Moveable = true;
+
+    std::vector<uint8_t> indices(kTileTotalCount);
+    for(auto& itr : indices)
+    { itr = (rng.GetAsU32() % 100) < 25 ? 0 : 1; }
+
+    TileLayer layer;
+    layer.Init(indices.data(), palette, 2);
+
+    PathFinder finder;
+    finder.SetLayer(layer);
+
+    std::vector<uint32_t> walkable;
+    for(auto i=0u; i<kTileTotalCount; ++i)
+    {
+        if (finder.IsWalkable(i))
+        { walkable.push_back(i); }
+    }
+
+    // プレイヤーは kGoalFrame ごとに別のタイルへ移る.
+    std::vector<uint32_t> goals(kFrameCount);
+    for(auto frame=0u; frame<kFrameCount; ++frame)
+    {
+        goals[frame] = (frame % kGoalFrame == 0)
+            ? walkable[rng.GetAsU32() % walkable.size()]
+            : goals[frame - 1];
+    }
+
+    printf("PathFinder : %u frames, goal moves every %u frames, best of %u (us / frame)\n",
+        kFrameCount, kGoalFrame, kTrialCount);
+
+    std::vector<uint32_t> path;
+    uint32_t sum = 0;
+    for(auto agentCount : { 100u, 300u, 1000u })
+    {
+        std::vector<uint32_t> agents(agentCount);
+        for(auto& itr : agents)
+        { itr = walkable[rng.GetAsU32() % walkable.size()]; }
+
+        // 敵ごとに毎フレーム A* で求める場合.
+        auto astar = 1e30;
+        for(auto trial=0u; trial<kTrialCount; ++trial)
+        {
+            auto msec = MeasureMsec([&]()
+            {
+                for(auto frame=0u; frame<kFrameCount; ++frame)
+                {
+                    for(auto agent : agents)
+                    {
+                        finder.FindPath(agent, goals[frame], path);
+                        sum += path.empty() ? 0 : path[0];
+                    }
+                }
+            });
+            astar = std::min(astar, msec * 1000.0 / kFrameCount);
+        }
+
+        // フローフィールドを共有する場合. 目標のタイルが変わった後の最初の1回で作り直す.
+        auto flow = 1e30;
+        for(auto trial=0u; trial<kTrialCount; ++trial)
+        {
+            auto msec = MeasureMsec([&]()
+            {
+                for(auto frame=0u; frame<kFrameCount; ++frame)
+                {
+                    finder.SetGoal(goals[frame]);
+                    for(auto agent : agents)
+                    { sum += finder.GetFlowDir(agent); }
+                }
+            });
+            flow = std::min(flow, msec * 1000.0 / kFrameCount);
+        }
+
+        printf("  %4u agents : A* per agent %9.1f, shared flow field %6.2f\n", agentCount, astar, flow);
+    }
+
+    // 作り直し1回分.
+    auto rebuildCount = 10000u;
+    auto rebuild = MeasureMsec([&]()
+    {
+        for(auto i=0u; i<rebuildCount; ++i)
+        {
+            finder.SetGoal(walkable[i % walkable.size()]);
+            finder.Update();
+        }
+    });
+    printf("  flow field rebuild : %.2f us\n", rebuild * 1000.0 / rebuildCount);
+
+    // 引く敵がいなければ目標が変わっても作り直さない.
+    auto idle = MeasureMsec([&]()
+    {
+        for(auto i=0u; i<rebuildCount; ++i)
+        { finder.SetGoal(walkable[i % walkable.size()]); }
+    });
+    printf("  SetGoal without agents : %.3f us\n", idle * 1000.0 / rebuildCount);
+    printf("  (sum %u)\n", sum);
+    return 0;
+}
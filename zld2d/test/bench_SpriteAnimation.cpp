@@ -0,0 +1,64 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_SpriteAnimation.cpp
+// Desc : Benchmark for Sprite Sheet Animation.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteAnimation.h>
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    const uint32_t kFrameCount = 200;
+
+    // 長さの異なるループ/非ループのクリップ.
+    SpriteAnimLibrary library;
+    for(auto c=0u; c<8; ++c)
+    {
+        char name[32];
+        sprintf(name, "clip%u", c);
+        library.AddClip(name, (c % 4) != 3, 1);
+        for(auto f=0u; f<2 + c; ++f)
+        {
+            TextureRegion region(FakePointer<ID3D11ShaderResourceView>(c * 16 + f));
+            library.AddFrame(2 + (f % 5), &region);
+        }
+    }
+
+    printf("SpriteAnimSystem::Update, %u frames\n", kFrameCount);
+    printf("%8s %14s %14s\n", "actors", "update[us]", "per actor[ns]");
+
+    for(auto count : { 1000u, 10000u, 100000u })
+    {
+        SpriteAnimSystem system;
+        system.Init(&library, count);
+        for(auto i=0u; i<count; ++i)
+        {
+            auto handle = system.Create(SpriteAnimClipId(i % 8));
+            system.SetPaused(handle, (i % 10) == 0);
+        }
+
+        uint64_t sum = 0;
+        auto msec = MeasureMsec([&]
+        {
+            for(auto f=0u; f<kFrameCount; ++f)
+            {
+                system.Update();
+                sum += system.GetFrame(f % count);
+            }
+        });
+
+        auto us = msec * 1000.0 / kFrameCount;
+        printf("%8u %14.1f %14.2f  (checksum %llu)\n", count, us, us * 1000.0 / count, (unsigned long long)sum);
+        system.Term();
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_SpriteBatch.cpp
+// Desc : Benchmark for SpriteBatch Radix Sort.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteBatch.h>
+#include <SpriteBackend.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    const uint32_t kRepeat = 50;
+
+    printf("SpriteBatch::Build (radix) vs 64bit keys + std::sort, %u repeats\n", kRepeat);
+    printf("%8s %8s %12s %12s %8s\n", "sprites", "layers", "radix[us]", "sort[us]", "draws");
+
+    for(auto count : { 10000u, 30000u, 100000u })
+    {
+        for(auto layerCount : { 4u, 64u, 65536u })
+        {
+            asdx::PCG rng(count + layerCount);
+            std::vector<SpriteInstance> instances(count);
+            std::vector<const void*>    textures (count);
+            for(auto i=0u; i<count; ++i)
+            {
+                instances[i].Layer = uint16_t(rng.GetAsU32() % layerCount);
+                textures [i]       = FakePointer<const void>(rng.GetAsU32() % 13);
+            }
+
+            SpriteBatch batch;
+            batch.Reserve(count);
+            auto radix = MeasureMsec([&]
+            {
+                for(auto r=0u; r<kRepeat; ++r)
+                { batch.Build(instances.data(), textures.data(), count, true, kSpritePageSize); }
+            });
+
+            // 以前の並べ替え. (レイヤー, テクスチャ番号, 記録順) の64bitキーを比較ソートする.
+            std::unordered_map<const void*, uint32_t> ids;
+            std::vector<uint64_t> keys(count);
+            auto sort = MeasureMsec([&]
+            {
+                for(auto r=0u; r<kRepeat; ++r)
+                {
+                    ids.clear();
+                    for(auto i=0u; i<count; ++i)
+                    {
+                        auto id = ids.emplace(textures[i], uint32_t(ids.size())).first->second;
+                        keys[i] = (uint64_t(0xffff - instances[i].Layer) << 48) | (uint64_t(id) << 32) | i;
+                    }
+                    std::sort(keys.begin(), keys.end());
+                }
+            });
+
+            printf("%8u %8u %12.1f %12.1f %8zu\n",
+                count, layerCount, radix * 1000.0 / kRepeat, sort * 1000.0 / kRepeat, batch.GetCommands().size());
+        }
+    }
+
+    return 0;
+}
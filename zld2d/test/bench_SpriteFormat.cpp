@@ -0,0 +1,108 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_SpriteFormat.cpp
+// Desc : Benchmark for Packed Sprite Instance Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteFormat.h>
+#include <asdxMath.h>
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+#if defined(TEST_SPRITE_PACK_AVX2)
+    if (!__builtin_cpu_supports("avx2"))
+    {
+        printf("AVX2 is not supported on this CPU. skipped.\n");
+        return 0;
+    }
+    const char* kPackPath = "AVX2";
+#else
+    const char* kPackPath = "SSE2";
+#endif
+
+    // 1フレーム分の記録と転送量を，以前の4頂点展開(4 x 40byte)と比べる.
+    printf("SpriteInstance (%u bytes) vs 4 x SpriteVertex (%u bytes) per sprite\n",
+        kSpriteInstanceBytes, kSpriteVertexBytes);
+    printf("%8s %14s %14s %12s %12s\n", "sprites", "inst[B/frame]", "vtx[B/frame]", "inst[us]", "vtx[us]");
+
+    // 418 はスクロール中の2部屋分のタイル数.
+    for(auto count : { 418u, 10000u, 100000u })
+    {
+        asdx::PCG rng(count);
+        std::vector<SpriteDesc> descs(count);
+        for(auto& desc : descs)
+        {
+            SetSpriteDesc(desc, TextureRegion(), int(rng.GetAsU32() % 1920), int(rng.GetAsU32() % 1080), 64, 64, int(rng.GetAsU32() % 256));
+            desc.Color[3] = float(rng.GetAsU32() % 256) / 255.0f;
+        }
+
+        std::vector<SpriteInstance> instances(count);
+        std::vector<SpriteVertex>   vertices (count * 4);
+
+        auto repeat = 20000000u / count;
+        auto inst = MeasureMsec([&]
+        {
+            for(auto r=0u; r<repeat; ++r)
+            { PackSpritesScalar(descs.data(), count, instances.data()); }
+        });
+
+        auto vtx = MeasureMsec([&]
+        {
+            for(auto r=0u; r<repeat; ++r)
+            {
+                PackSpritesScalar(descs.data(), count, instances.data());
+                for(auto i=0u; i<count; ++i)
+                { ExpandSprite(instances[i], &vertices[i * 4]); }
+            }
+        });
+
+        printf("%8u %14u %14u %12.1f %12.1f\n",
+            count, count * kSpriteInstanceBytes, count * kSpriteVertexBytes,
+            inst * 1000.0 / repeat, vtx * 1000.0 / repeat);
+    }
+
+    // PackSprites (SIMD版) とスカラー版のスループット.
+    printf("\nPackSprites (%s) vs PackSpritesScalar\n", kPackPath);
+    printf("%8s %18s %18s\n", "sprites", "scalar[sprites/us]", "simd[sprites/us]");
+
+    for(auto count : { 1000u, 100000u })
+    {
+        asdx::PCG rng(count);
+        std::vector<SpriteDesc> descs(count);
+        for(auto& desc : descs)
+        {
+            SetSpriteDesc(desc, TextureRegion(nullptr, 0.1f, 0.2f, 0.3f, 0.4f),
+                int(rng.GetAsU32() % 1920), int(rng.GetAsU32() % 1080), 64, 64, int(rng.GetAsU32() % 256));
+            desc.Color[3] = float(rng.GetAsU32() % 256) / 255.0f;
+        }
+
+        std::vector<SpriteInstance> instances(count);
+
+        auto repeat = 20000000u / count;
+        auto scalar = MeasureMsec([&]
+        {
+            for(auto r=0u; r<repeat; ++r)
+            { PackSpritesScalar(descs.data(), count, instances.data()); }
+        });
+
+        auto simd = MeasureMsec([&]
+        {
+            for(auto r=0u; r<repeat; ++r)
+            { PackSprites(descs.data(), count, instances.data()); }
+        });
+
+        auto total = double(count) * repeat / 1000.0;
+        printf("%8u %18.1f %18.1f\n", count, total / scalar, total / simd);
+    }
+
+    return 0;
+}
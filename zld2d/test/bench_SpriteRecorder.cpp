@@ -0,0 +1,95 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_SpriteRecorder.cpp
+// Desc : Benchmark for Multi-Threaded Sprite Recording.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteSystem.h>
+#include <SpriteCaptureBackend.h>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kSpriteCount = 100000;
+static const uint32_t kFrameCount  = 20;
+
+//-----------------------------------------------------------------------------
+//      [begin, end) のスプライトを記録します.
+//-----------------------------------------------------------------------------
+void Record(SpriteRecorder& recorder, uint32_t begin, uint32_t end)
+{
+    for(auto i=begin; i<end; ++i)
+    {
+        TextureRegion region(FakePointer<ID3D11ShaderResourceView>(i % 7));
+        recorder.SetColor(1.0f, 1.0f, 1.0f, float(i % 4) / 3.0f);
+        recorder.Draw(region, int(i % 1280), int((i / 1280) % 720), 16, 16, int((i * 7) % 5));
+    }
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    printf("SpriteRecorder : %u sprites, %u frames, hardware threads = %u\n",
+        kSpriteCount, kFrameCount, std::thread::hardware_concurrency());
+    printf("%8s %12s %12s\n", "threads", "record[ms]", "frame[ms]");
+
+    for(auto threadCount=1u; threadCount<=8; threadCount*=2)
+    {
+        SpriteCaptureBackend backend;
+        SpriteSystem sprite;
+        sprite.Init(&backend, 1280.0f, 720.0f);
+        sprite.SetSortMode(true);
+
+        std::vector<SpriteRecorder> recorders(threadCount);
+        for(auto& recorder : recorders)
+        { recorder.Reserve(kSpriteCount / threadCount + 1); }
+
+        double record = 0.0;
+        double total  = MeasureMsec([&]
+        {
+            for(auto f=0u; f<kFrameCount; ++f)
+            {
+                backend.Clear();
+                for(auto& recorder : recorders)
+                { recorder.Reset(); }
+
+                record += MeasureMsec([&]
+                {
+                    std::vector<std::thread> threads;
+                    for(auto t=0u; t<threadCount; ++t)
+                    {
+                        auto begin = kSpriteCount * t       / threadCount;
+                        auto end   = kSpriteCount * (t + 1) / threadCount;
+                        threads.emplace_back(Record, std::ref(recorders[t]), begin, end);
+                    }
+                    for(auto& thread : threads)
+                    { thread.join(); }
+                });
+
+                sprite.Begin();
+                for(auto& recorder : recorders)
+                { sprite.Submit(recorder); }
+                sprite.End();
+            }
+        });
+
+        printf("%8u %12.2f %12.2f\n", threadCount, record / kFrameCount, total / kFrameCount);
+        sprite.Term();
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_SpriteSoftwareBackend.cpp
+// Desc : Benchmark for Software Sprite Backend.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteSystem.h>
+#include <SpriteSoftwareBackend.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kWidth        = 1280;
+static const uint32_t kHeight       = 720;
+static const uint32_t kSpriteCount  = 1000;
+static const uint32_t kFrameCount   = 5;
+static const uint32_t kTrialCount   = 3;
+
+
+//-----------------------------------------------------------------------------
+//      部屋1枚分のタイルとランダムな半透明スプライトを用意します.
+//-----------------------------------------------------------------------------
+std::vector<SpriteDesc> MakeScene()
+{
+    std::vector<SpriteDesc> result;
+
+    for(auto y=0; y<11; ++y)
+    {
+        for(auto x=0; x<19; ++x)
+        {
+            SpriteDesc desc;
+            TextureRegion region(FakePointer<ID3D11ShaderResourceView>((x + y) % 2));
+            SetSpriteDesc(desc, region, 32 + x * 64, 8 + y * 64, 64, 64, 15);
+            result.push_back(desc);
+        }
+    }
+
+    asdx::PCG rng(1);
+    for(auto i=0u; i<kSpriteCount; ++i)
+    {
+        SpriteDesc desc;
+        TextureRegion region(FakePointer<ID3D11ShaderResourceView>(rng.GetAsU32() % 2));
+        auto w = int(16 + rng.GetAsU32() % 112);
+        auto h = int(16 + rng.GetAsU32() % 112);
+        SetSpriteDesc(desc, region,
+            int(rng.GetAsU32() % kWidth)  - w / 2,
+            int(rng.GetAsU32() % kHeight) - h / 2,
+            w, h, int(rng.GetAsU32() % 15));
+        desc.Color[3] = 0.5f;
+        result.push_back(desc);
+    }
+
+    return result;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    uint32_t checker[16 * 16];
+    uint32_t gradient[32 * 32];
+    for(auto i=0u; i<16 * 16; ++i)
+    { checker[i] = (((i % 16) / 4 + (i / 16) / 4) % 2 == 0) ? 0xff808080 : 0xffc0c0c0; }
+    for(auto i=0u; i<32 * 32; ++i)
+    { gradient[i] = 0x80000000 | ((i % 32) * 8) | (((i / 32) * 8) << 8); }
+
+    auto scene = MakeScene();
+
+    printf("SpriteSoftwareBackend : %ux%u, %u sprites, %u frames, best of %u, End() time\n",
+        kWidth, kHeight, uint32_t(scene.size()), kFrameCount, kTrialCount);
+    printf("hardware threads : %u\n", std::thread::hardware_concurrency());
+    printf("%8s %12s %14s %14s\n", "threads", "frame[ms]", "pixels/frame", "Mpixels/s");
+
+    for(auto threadCount : { 1u, 2u, 4u, 8u })
+    {
+        SpriteSoftwareBackend backend;
+        backend.Init(kWidth, kHeight, threadCount);
+        backend.RegisterTexture(FakePointer<ID3D11ShaderResourceView>(0), 16, 16, 16 * 4, checker);
+        backend.RegisterTexture(FakePointer<ID3D11ShaderResourceView>(1), 32, 32, 32 * 4, gradient);
+
+        SpriteSystem sprite;
+        sprite.Init(&backend, float(kWidth), float(kHeight));
+        sprite.SetSortMode(true);
+
+        auto best   = 1e30;
+        auto pixels = 0.0;
+        for(auto trial=0u; trial<kTrialCount; ++trial)
+        {
+            auto before = backend.GetShadedPixelCount();
+            auto time   = 0.0;
+            for(auto f=0u; f<kFrameCount; ++f)
+            {
+                backend.Clear(0.0f, 0.0f, 0.0f, 1.0f);
+                sprite.Begin();
+                sprite.DrawBatch(scene.data(), uint32_t(scene.size()));
+                time += MeasureMsec([&]{ sprite.End(); });
+            }
+            best   = std::min(best, time / kFrameCount);
+            pixels = double(backend.GetShadedPixelCount() - before) / kFrameCount;
+        }
+
+        printf("%8u %12.2f %14.0f %14.1f\n", threadCount, best, pixels, pixels / (best * 1000.0));
+
+        sprite.Term();
+        backend.Term();
+    }
+
+    return 0;
+}
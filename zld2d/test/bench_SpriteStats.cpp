@@ -0,0 +1,107 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_SpriteStats.cpp
+// Desc : Benchmark for Sprite Pipeline Statistics Overhead.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteSystem.h>
+#include <SpriteCaptureBackend.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kTextureCount = 8;
+static const uint32_t kFrameCount   = 500;
+static const uint32_t kTrialCount   = 5;
+
+
+//-----------------------------------------------------------------------------
+//      ランダムなテクスチャとレイヤーのスプライトを用意します.
+//-----------------------------------------------------------------------------
+std::vector<SpriteDesc> MakeScene(uint32_t count)
+{
+    asdx::PCG rng(count);
+    std::vector<SpriteDesc> result(count);
+    for(auto& desc : result)
+    {
+        TextureRegion region(FakePointer<ID3D11ShaderResourceView>(rng.GetAsU32() % kTextureCount));
+        SetSpriteDesc(desc, region,
+            int(rng.GetAsU32() % 1280),
+            int(rng.GetAsU32() % 720),
+            32, 32, int(rng.GetAsU32() % 16));
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      1フレームあたりの End() の時間(マイクロ秒)を計測します. 最も速かった回を返します.
+//-----------------------------------------------------------------------------
+double MeasureEnd(SpriteSystem& sprite, SpriteCaptureBackend& backend, const std::vector<SpriteDesc>& scene)
+{
+    auto best = 1e30;
+    for(auto trial=0u; trial<kTrialCount; ++trial)
+    {
+        auto time = 0.0;
+        for(auto f=0u; f<kFrameCount; ++f)
+        {
+            backend.Clear();
+            sprite.Begin();
+            sprite.DrawBatch(scene.data(), uint32_t(scene.size()));
+            time += MeasureMsec([&]{ sprite.End(); });
+            sprite.FlushStats();
+        }
+        best = std::min(best, time * 1000.0 / kFrameCount);
+    }
+    return best;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    printf("SpriteSystem::End() with stats off / on, %u frames, best of %u\n", kFrameCount, kTrialCount);
+    printf("%8s %10s %10s %10s %8s\n", "sprites", "off[us]", "on[us]", "diff[us]", "draws");
+
+    for(auto count : { 100u, 1000u, 4000u })
+    {
+        auto scene = MakeScene(count);
+
+        SpriteCaptureBackend backend;
+        SpriteSystem sprite;
+        sprite.Init(&backend, 1280.0f, 720.0f);
+        sprite.SetSortMode(true);
+
+        // 交互に計測して，キャッシュやクロックの偏りを減らす.
+        auto off = 1e30;
+        auto on  = 1e30;
+        for(auto round=0; round<2; ++round)
+        {
+            sprite.SetStatsEnabled(false);
+            off = std::min(off, MeasureEnd(sprite, backend, scene));
+
+            sprite.SetStatsEnabled(true);
+            on  = std::min(on,  MeasureEnd(sprite, backend, scene));
+        }
+
+        auto draws = sprite.GetStats().GetLast().Values[SPRITE_STAT_DRAW_CALLS];
+        printf("%8u %10.2f %10.2f %10.2f %8u\n", count, off, on, on - off, uint32_t(draws));
+
+        sprite.Term();
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_TextLayout.cpp
+// Desc : Benchmark for Text Layout.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <TextLayout.h>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// FixedMetrics structure
+///////////////////////////////////////////////////////////////////////////////
+struct FixedMetrics : public ITextMetrics
+{
+    int32_t GetAdvance(uint32_t code) override
+    { return (code >= 0x2E80) ? 32 : 16; }
+};
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    const uint32_t kTextCount = 20000;
+    const uint32_t kRepeat    = 20;
+
+    // 会話ウィンドウ1つ分の長さのテキストを，数字を変えて別々の文字列にする.
+    std::vector<std::wstring> texts;
+    for(auto i=0u; i<kTextCount; ++i)
+    {
+        std::wstring text = L"これは会話のテストです。勇者よ、";
+        text += std::to_wstring(i);
+        text += L"番目の「試練」を乗り越えるのだ！ほんとうに？はい、いいえ";
+        texts.push_back(text);
+    }
+
+    FixedMetrics     metrics;
+    TextLayoutCache  cache;
+    TextLayoutResult result = {};
+    TextLayoutBox    box    = { 958, 4 };
+
+    // 初回は全てキャッシュに無い.
+    auto miss = MeasureMsec([&]
+    {
+        for(auto& text : texts)
+        { cache.Get(&metrics, text.c_str(), 0, box, result); }
+    });
+
+    auto hit = MeasureMsec([&]
+    {
+        for(auto r=0u; r<kRepeat; ++r)
+        {
+            for(auto& text : texts)
+            { cache.Get(&metrics, text.c_str(), 0, box, result); }
+        }
+    });
+
+    // 同じ台詞を毎フレーム引く場合.
+    const uint32_t kHotCount = 1000000;
+    auto hot = MeasureMsec([&]
+    {
+        for(auto r=0u; r<kHotCount; ++r)
+        { cache.Get(&metrics, texts[5].c_str(), 0, box, result); }
+    });
+
+    printf("TextLayoutCache : %u texts (%zu chars, %u lines)\n", kTextCount, texts[0].size(), result.LineCount);
+    printf("  layout (miss) : %8.0f ns/text, %6.1f ns/char\n",
+        miss * 1e6 / kTextCount, miss * 1e6 / (double(kTextCount) * texts[0].size()));
+    printf("  lookup (hit)  : %8.0f ns/text\n", hit * 1e6 / (double(kTextCount) * kRepeat));
+    printf("  hot lookup    : %8.1f ns/text\n", hot * 1e6 / kHotCount);
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_TileCache.cpp
+// Desc : Benchmark for Pre-Expanded Tile Layer Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <TileCache.h>
+#include <SpriteSystem.h>
+#include <SpriteCaptureBackend.h>
+#include <asdxMath.h>
+#include <algorithm>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kPaletteCount = 4;
+static const uint32_t kFrameCount   = 10000;
+static const uint32_t kTrialCount   = 5;
+
+
+//-----------------------------------------------------------------------------
+//      テクスチャ番号毎に別の領域を返します.
+//-----------------------------------------------------------------------------
+const TextureRegion& ResolveTexture(uint32_t textureId)
+{
+    static TextureRegion s_Regions[kPaletteCount] = {
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(0), 0.00f, 0.0f, 0.25f, 1.0f),
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(0), 0.25f, 0.0f, 0.50f, 1.0f),
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(0), 0.50f, 0.0f, 0.75f, 1.0f),
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(0), 0.75f, 0.0f, 1.00f, 1.0f),
+    };
+    return s_Regions[textureId % kPaletteCount];
+}
+
+//-----------------------------------------------------------------------------
+//      以前の描画です. 毎フレーム全タイルのテクスチャを引いて1枚ずつ描画します.
+//-----------------------------------------------------------------------------
+void DrawPerTile(SpriteSystem& sprite, const TileLayer& layer, int offsetX, int offsetY, int playerY)
+{
+    for(auto i=0u; i<kTileTotalCount; ++i)
+    {
+        auto& tile = layer.GetTile(i);
+        auto  x    = kTileOffsetX + kTileSize * int(i % kTileCountX) + offsetX;
+        auto  y    = kTileOffsetY + kTileSize * int(i / kTileCountX) + offsetY;
+        auto  z    = (!tile.Moveable && (playerY < y)) ? 0 : 2;
+        sprite.Draw(ResolveTexture(tile.TextureId), x, y, kTileSize, kTileSize, z);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      キャッシュした範囲を平行移動して描画します. MapSystem::DrawTiles() と同じ処理です.
+//-----------------------------------------------------------------------------
+void DrawCached(SpriteSystem& sprite, TileCache& cache, const TileLayer& layer, int offsetX, int offsetY, int playerY)
+{
+    cache.Build(layer, ResolveTexture);
+
+    for(auto& range : cache.GetRanges())
+    {
+        auto y = range.Y + offsetY;
+        auto z = (range.Obstacle && (playerY < y)) ? 0 : 2;
+        sprite.DrawInstances(
+            cache.GetInstances() + range.Start,
+            cache.GetTextures()  + range.Start,
+            range.Count,
+            offsetX,
+            offsetY,
+            z);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      1フレームあたりの記録時間(マイクロ秒)を計測します. 最も速かった回を返します.
+//-----------------------------------------------------------------------------
+template<typename Func>
+double MeasureFrame(SpriteSystem& sprite, SpriteCaptureBackend& backend, Func func)
+{
+    auto best = 1e30;
+    for(auto trial=0u; trial<kTrialCount; ++trial)
+    {
+        double record = 0.0;
+        for(auto f=0u; f<kFrameCount; ++f)
+        {
+            backend.Clear();
+            sprite.Begin();
+            record += MeasureMsec([&]{ func(f); });
+            sprite.End();
+        }
+        best = std::min(best, record * 1000.0 / kFrameCount);
+    }
+    return best;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    asdx::PCG rng(1);
+    Tile    palette[kPaletteCount];
+    uint8_t indices[2][kTileTotalCount];
+    for(auto i=0u; i<kPaletteCount; ++i)
+    {
+        palette[i] = Tile();
+        palette[i].TextureId = uint8_t(i);
+        palette[i].Moveable  = (i < 2);
+    }
+    for(auto r=0; r<2; ++r)
+    {
+        for(auto i=0u; i<kTileTotalCount; ++i)
+        { indices[r][i] = uint8_t(rng.GetAsU32() % kPaletteCount); }
+    }
+
+    TileLayer layers[2];
+    TileCache caches[2];
+    for(auto r=0; r<2; ++r)
+    { layers[r].Init(indices[r], palette, kPaletteCount); }
+
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    sprite.Init(&backend, 1280.0f, 720.0f);
+
+    printf("TileCache : %u frames, best of %u, record time per frame\n", kFrameCount, kTrialCount);
+    printf("%10s %8s %14s %14s\n", "case", "tiles", "per-tile[us]", "cached[us]");
+
+    // 1部屋.
+    {
+        auto perTile = MeasureFrame(sprite, backend, [&](uint32_t f)
+        { DrawPerTile(sprite, layers[0], 0, 0, int(f % 720)); });
+
+        auto cached = MeasureFrame(sprite, backend, [&](uint32_t f)
+        { DrawCached(sprite, caches[0], layers[0], 0, 0, int(f % 720)); });
+
+        printf("%10s %8u %14.2f %14.2f\n", "room", kTileTotalCount, perTile, cached);
+    }
+
+    // スクロール中. 隣の部屋も並べて描画する.
+    {
+        auto perTile = MeasureFrame(sprite, backend, [&](uint32_t f)
+        {
+            auto scroll = -int(f % kTileTotalW);
+            DrawPerTile(sprite, layers[0], scroll, 0, 360);
+            DrawPerTile(sprite, layers[1], scroll + kTileTotalW, 0, 360);
+        });
+
+        auto cached = MeasureFrame(sprite, backend, [&](uint32_t f)
+        {
+            auto scroll = -int(f % kTileTotalW);
+            DrawCached(sprite, caches[0], layers[0], scroll, 0, 360);
+            DrawCached(sprite, caches[1], layers[1], scroll + kTileTotalW, 0, 360);
+        });
+
+        printf("%10s %8u %14.2f %14.2f\n", "scroll", kTileTotalCount * 2, perTile, cached);
+    }
+
+    printf("cache builds : %u, %u\n", caches[0].GetBuildCount(), caches[1].GetBuildCount());
+
+    sprite.Term();
+    return 0;
+}
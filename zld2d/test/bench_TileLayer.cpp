@@ -0,0 +1,167 @@
+﻿//-----------------------------------------------------------------------------
+// File : bench_TileLayer.cpp
+// Desc : Benchmark for Tile Collision.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <TileLayer.h>
+#include <MapSystem.h>
+#include <TextureId.h>
+#include <TextureMgr.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kBoxCount     = 4096;
+static const uint32_t kRepeatCount  = 200;
+static const uint32_t kTrialCount   = 5;
+
+//-----------------------------------------------------------------------------
+//      以前の判定です. 矩形の中心が乗ったタイルだけを調べます.
+//-----------------------------------------------------------------------------
+bool TestCenter(const TileLayer& layer, const Box& box)
+{
+    auto index = CalcTileIndex(box.Pos.x + box.Size.x / 2, box.Pos.y + box.Size.y / 2);
+    return layer.GetTile(CalcTileId(index)).Moveable;
+}
+
+//-----------------------------------------------------------------------------
+//      矩形に掛かるタイルを1つずつ調べます.
+//-----------------------------------------------------------------------------
+bool TestEach(const TileLayer& layer, const Box& box)
+{
+    auto lt = CalcTileIndex(box.Pos.x, box.Pos.y);
+    auto rb = CalcTileIndex(box.Pos.x + box.Size.x - 1, box.Pos.y + box.Size.y - 1);
+    for(auto y=lt.y; y<=rb.y; ++y)
+    {
+        for(auto x=lt.x; x<=rb.x; ++x)
+        {
+            if (!layer.GetTile(CalcTileId(Vector2i(x, y))).Moveable)
+            { return false; }
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      歩いているキャラのように少しずつずれる矩形を生成します.
+//-----------------------------------------------------------------------------
+void MakeWalk(asdx::PCG& rng, int size, std::vector<Box>& boxes)
+{
+    auto x = kTileTotalW / 2;
+    auto y = kTileTotalH / 2;
+
+    boxes.resize(kBoxCount);
+    for(auto& box : boxes)
+    {
+        x = std::min(std::max(x + int(rng.GetAsU32() % 5) - 2, 0), kTileTotalW - size);
+        y = std::min(std::max(y + int(rng.GetAsU32() % 5) - 2, 0), kTileTotalH - size);
+        box = Box(x, y, size, size);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      1秒あたりの判定回数(百万回)を計測します. 最も速かった回を返します.
+//-----------------------------------------------------------------------------
+template<typename Func>
+double MeasureQuery(const std::vector<Box>& boxes, uint32_t& sum, Func func)
+{
+    double best = 0.0;
+    for(auto trial=0u; trial<kTrialCount; ++trial)
+    {
+        auto msec = MeasureMsec([&]()
+        {
+            for(auto i=0u; i<kRepeatCount; ++i)
+            {
+                for(auto& box : boxes)
+                { sum += func(box) ? 1 : 0; }
+            }
+        });
+        best = std::max(best, double(kRepeatCount) * boxes.size() / (msec * 1000.0));
+    }
+    return best;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    asdx::PCG rng(1);
+
+    // 1/8 が通行不可のランダムな部屋.
+    Tile palette[2] = {};
+    palette[1].Moveable = true;
+
+    std::vector<uint8_t> indices(kTileTotalCount);
+    for(auto& itr : indices)
+    { itr = (rng.GetAsU32() % 8) != 0 ? 1 : 0; }
+
+    TileLayer layer;
+    layer.Init(indices.data(), palette, 2);
+
+    printf("TileLayer : %u boxes x %u, best of %u (M queries / sec)\n", kBoxCount, kRepeatCount, kTrialCount);
+
+    uint32_t sum = 0;
+    std::vector<Box> boxes;
+    for(auto size : { 32, 64, 192 })
+    {
+        MakeWalk(rng, size, boxes);
+
+        // 全タイル判定の2つは結果が一致すること.
+        auto mismatch = 0u;
+        for(auto& box : boxes)
+        {
+            if (layer.TestAll(TILE_FLAG_MOVEABLE, box) != TestEach(layer, box))
+            { mismatch++; }
+        }
+
+        auto center = MeasureQuery(boxes, sum, [&](const Box& box) { return TestCenter(layer, box); });
+        auto each   = MeasureQuery(boxes, sum, [&](const Box& box) { return TestEach(layer, box); });
+        auto bits   = MeasureQuery(boxes, sum, [&](const Box& box) { return layer.TestAll(TILE_FLAG_MOVEABLE, box); });
+
+        printf("  box %3d : center tile (old) %6.1f, per tile %6.1f, TestAll %6.1f, mismatch %u\n",
+            size, center, each, bits, mismatch);
+
+        if (mismatch != 0)
+        { return 1; }
+    }
+
+    // MapSystem::CanMove() はギミックの検索も含む.
+    if (!TextureMgr::Instance().Load(TEXTURE_COUNT, kTextureNames))
+    { return 1; }
+
+    {
+        MapInstance instance;
+        if (!instance.Load("../res/map/room_000.map"))
+        { return 1; }
+        instance.Activate();
+
+        MapSystem system;
+        system.SetData(&instance);
+
+        MakeWalk(rng, kTileSize, boxes);
+        auto canMove = MeasureQuery(boxes, sum, [&](const Box& box) { return system.CanMove(box); });
+        printf("  MapSystem::CanMove (room_000, box %d) : %6.1f\n", kTileSize, canMove);
+
+        system.SetData(nullptr);
+        instance.Dispose();
+    }
+
+    TextureMgr::Instance().Term();
+    printf("  (sum %u)\n", sum);
+    return 0;
+}
@@ -0,0 +1,66 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxFrameHeap.h
+// Desc : Frame Heap for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+
+namespace asdx {
+
+// 確保した領域を Reset() でまとめて返す線形アロケータ.
+class FrameHeap
+{
+public:
+    FrameHeap() = default;
+    ~FrameHeap() { Term(); }
+
+    bool Init(size_t size)
+    {
+        Term();
+        m_pBuffer = static_cast<uint8_t*>(malloc(size));
+        m_Size    = size;
+        m_Offset  = 0;
+        return m_pBuffer != nullptr;
+    }
+
+    void Term()
+    {
+        free(m_pBuffer);
+        m_pBuffer = nullptr;
+        m_Size    = 0;
+        m_Offset  = 0;
+    }
+
+    void* Alloc(size_t size)
+    {
+        auto offset = (m_Offset + 15) & ~size_t(15);
+        if (m_pBuffer == nullptr || offset + size > m_Size)
+        { return nullptr; }
+
+        m_Offset = offset + size;
+        return m_pBuffer + offset;
+    }
+
+    void Reset()
+    { m_Offset = 0; }
+
+private:
+    uint8_t*    m_pBuffer = nullptr;
+    size_t      m_Size    = 0;
+    size_t      m_Offset  = 0;
+
+    FrameHeap             (const FrameHeap&) = delete;
+    FrameHeap& operator = (const FrameHeap&) = delete;
+};
+
+} // namespace asdx
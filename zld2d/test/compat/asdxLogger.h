@@ -0,0 +1,29 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxLogger.h
+// Desc : Logger for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdio>
+
+// asdx11 は Windows 専用なので，テストではランタイムのソースが使う分だけここで用意する.
+#define ELOGA(fmt, ...)     fprintf(stderr, fmt "\n", ##__VA_ARGS__)
+#define WLOGA(fmt, ...)     fprintf(stderr, fmt "\n", ##__VA_ARGS__)
+#define ILOGA(fmt, ...)     fprintf(stdout, fmt "\n", ##__VA_ARGS__)
+#define DLOGA(fmt, ...)     fprintf(stdout, fmt "\n", ##__VA_ARGS__)
+#define ELOG(fmt, ...)      ELOGA(fmt, ##__VA_ARGS__)
+
+#if !defined(_MSC_VER)
+//-----------------------------------------------------------------------------
+//      ファイルを開きます.
+//-----------------------------------------------------------------------------
+inline int fopen_s(FILE** ppFile, const char* path, const char* mode)
+{
+    *ppFile = fopen(path, mode);
+    return (*ppFile != nullptr) ? 0 : 1;
+}
+#endif
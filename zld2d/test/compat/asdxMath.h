@@ -0,0 +1,97 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxMath.h
+// Desc : Math for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+
+
+// asdx11 は Windows 専用なので，テストではランタイムのソースが使う分だけここで用意する.
+namespace asdx {
+
+template<typename T> inline T Min(T a, T b)
+{ return (a < b) ? a : b; }
+
+template<typename T> inline T Max(T a, T b)
+{ return (a > b) ? a : b; }
+
+template<typename T> inline T Clamp(T value, T mini, T maxi)
+{ return Max(mini, Min(maxi, value)); }
+
+inline float Saturate(float value)
+{ return Clamp(value, 0.0f, 1.0f); }
+
+struct Vector2
+{
+    float x, y;
+
+    Vector2() = default;
+    Vector2(float nx, float ny) : x(nx), y(ny) {}
+};
+
+struct Vector3
+{
+    float x, y, z;
+
+    Vector3() = default;
+    Vector3(float nx, float ny, float nz) : x(nx), y(ny), z(nz) {}
+};
+
+struct Vector4
+{
+    float x, y, z, w;
+
+    Vector4() = default;
+    Vector4(float nx, float ny, float nz, float nw) : x(nx), y(ny), z(nz), w(nw) {}
+};
+
+struct Matrix
+{
+    float _11, _12, _13, _14;
+    float _21, _22, _23, _24;
+    float _31, _32, _33, _34;
+    float _41, _42, _43, _44;
+
+    Matrix() = default;
+    Matrix(
+        float m11, float m12, float m13, float m14,
+        float m21, float m22, float m23, float m24,
+        float m31, float m32, float m33, float m34,
+        float m41, float m42, float m43, float m44)
+    : _11(m11), _12(m12), _13(m13), _14(m14)
+    , _21(m21), _22(m22), _23(m23), _24(m24)
+    , _31(m31), _32(m32), _33(m33), _34(m34)
+    , _41(m41), _42(m42), _43(m43), _44(m44)
+    {}
+
+    static Matrix CreateIdentity()
+    { return Matrix(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1); }
+};
+
+// 再現性のある乱数列が得られれば良いので，PCG32 をそのまま実装する.
+class PCG
+{
+public:
+    explicit PCG(uint64_t seed = 0x853c49e6748fea9bULL)
+    : m_State(seed)
+    { /* DO_NOTHING */ }
+
+    uint32_t GetAsU32()
+    {
+        auto old = m_State;
+        m_State = old * 6364136223846793005ULL + 1442695040888963407ULL;
+        auto shifted = uint32_t(((old >> 18u) ^ old) >> 27u);
+        auto rot     = uint32_t(old >> 59u);
+        return (shifted >> rot) | (shifted << ((0u - rot) & 31u));
+    }
+
+private:
+    uint64_t m_State;
+};
+
+} // namespace asdx
@@ -0,0 +1,8 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxMisc.h
+// Desc : Misc Utilities for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+// SpriteSystem.cpp がインクルードするだけで，テスト対象からは何も使わない.
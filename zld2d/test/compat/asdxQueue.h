@@ -0,0 +1,58 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxQueue.h
+// Desc : Intrusive Queue for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+
+namespace asdx {
+
+// 要素が Node を継承して次の要素を持つ，片方向リストの FIFO.
+template<typename T>
+class Queue
+{
+public:
+    class Node
+    {
+        friend class Queue<T>;
+        T* m_pNext = nullptr;
+    };
+
+    void Push(T* value)
+    {
+        value->m_pNext = nullptr;
+        if (m_pTail != nullptr)
+        { m_pTail->m_pNext = value; }
+        else
+        { m_pHead = value; }
+        m_pTail = value;
+    }
+
+    T* Pop()
+    {
+        auto value = m_pHead;
+        if (value == nullptr)
+        { return nullptr; }
+
+        m_pHead = value->m_pNext;
+        if (m_pHead == nullptr)
+        { m_pTail = nullptr; }
+        return value;
+    }
+
+    bool IsEmpty() const
+    { return m_pHead == nullptr; }
+
+    void Clear()
+    {
+        m_pHead = nullptr;
+        m_pTail = nullptr;
+    }
+
+private:
+    T*  m_pHead = nullptr;
+    T*  m_pTail = nullptr;
+};
+
+} // namespace asdx
@@ -0,0 +1,28 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxRef.h
+// Desc : Reference Pointer for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+
+namespace asdx {
+
+// テストでは COM オブジェクトを生成しないので，参照カウントは扱わない.
+template<typename T>
+class RefPtr
+{
+public:
+    RefPtr() = default;
+    RefPtr(T* value) : m_pPtr(value) {}
+
+    T*  GetPtr() const      { return m_pPtr; }
+    T** GetAddress()        { return &m_pPtr; }
+    void Reset()            { m_pPtr = nullptr; }
+    T*  operator -> () const { return m_pPtr; }
+
+private:
+    T*  m_pPtr = nullptr;
+};
+
+} // namespace asdx
@@ -0,0 +1,28 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxTexture.h
+// Desc : Texture Declarations for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <d3d11.h>
+
+
+namespace asdx {
+
+// TextureMgr.h がメンバーに持つだけなので，使う関数だけ用意する.
+class ResTexture
+{
+};
+
+class Texture2D
+{
+public:
+    void Release() {}
+    ID3D11ShaderResourceView* GetSRV() const { return nullptr; }
+};
+
+} // namespace asdx
@@ -0,0 +1,11 @@
+﻿//-----------------------------------------------------------------------------
+// File : d3d11.h
+// Desc : Direct3D 11 Declarations for Headless Tests.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+// テスト対象はテクスチャをポインタとしてしか扱わないので，宣言だけ用意する.
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+struct ID3D11ShaderResourceView;
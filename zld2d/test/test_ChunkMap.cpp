@@ -0,0 +1,224 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_ChunkMap.cpp
+// Desc : Tests for Chunked Tile Map.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <ChunkMap.h>
+#include <SpriteSystem.h>
+#include <SpriteCaptureBackend.h>
+#include <asdxMath.h>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const int32_t  kWorldSize    = 4096;     // 縦横タイル数.
+static const int32_t  kMargin       = 4;        // Cull() に渡す画面外のタイル数.
+static const uint32_t kFrameCount   = 2000;     // スクロールするフレーム数.
+
+//-----------------------------------------------------------------------------
+//      タイルのテクスチャ領域を引きます.
+//-----------------------------------------------------------------------------
+const TextureRegion& ResolveTile(uint32_t textureId)
+{
+    static const TextureRegion kRegions[] = {
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(0)),
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(1)),
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(2)),
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(3)),
+    };
+    return kRegions[textureId & 3];
+}
+
+//-----------------------------------------------------------------------------
+//      座標から決まるタイルを生成します.
+//-----------------------------------------------------------------------------
+Tile MakeTile(int32_t x, int32_t y)
+{
+    Tile tile = {};
+    tile.TextureId = uint8_t((x ^ y) & 3);
+    tile.Moveable  = ((x * 7 + y * 13) % 11) != 0;
+    return tile;
+}
+
+//-----------------------------------------------------------------------------
+//      キャプチャしたドローコールのスプライト数を合計します.
+//-----------------------------------------------------------------------------
+uint32_t CountDrawn(const SpriteFrameCapture& capture)
+{
+    uint32_t result = 0;
+    for(auto& cmd : capture.Commands)
+    {
+        if (cmd.Op == SPRITE_CAPTURE_DRAW)
+        { result += cmd.Arg1; }
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      カメラの移動でタイル座標とサブピクセルが正規化されることを確認します.
+//-----------------------------------------------------------------------------
+void TestCamera()
+{
+    MapCamera camera;
+    camera.Move(-1, -1);
+    CHECK_EQ(camera.TileX, -1);
+    CHECK_EQ(camera.TileY, -1);
+    CHECK_EQ(camera.SubX, kTileSize - 1);
+    CHECK_EQ(camera.SubY, kTileSize - 1);
+
+    camera.Move(1, kTileSize * 3 + 1);
+    CHECK_EQ(camera.TileX, 0);
+    CHECK_EQ(camera.TileY, 3);
+    CHECK_EQ(camera.SubX, 0);
+    CHECK_EQ(camera.SubY, 0);
+
+    // サブピクセルが 0 なら画面ちょうど，ずれていれば1タイル分はみ出す.
+    auto rect = camera.GetVisibleRect();
+    CHECK_EQ(rect.W, kTileCountX);
+    CHECK_EQ(rect.H, kTileCountY);
+
+    camera.Move(1, 1);
+    rect = camera.GetVisibleRect();
+    CHECK_EQ(rect.W, kTileCountX + 1);
+    CHECK_EQ(rect.H, kTileCountY + 1);
+}
+
+//-----------------------------------------------------------------------------
+//      負の座標も16x16のチャンクに切り分けることを確認します.
+//-----------------------------------------------------------------------------
+void TestNegative()
+{
+    ChunkMap map;
+
+    Tile empty = {};
+    empty.Moveable = false;
+    map.SetEmptyTile(empty);
+
+    Tile tile = {};
+    tile.Moveable = true;
+    map.SetTile(-1, -1, tile);
+
+    CHECK(map.GetTile(-1, -1).Moveable);
+    CHECK(!map.GetTile(-17, -1).Moveable);
+    CHECK(!map.GetTile(0, 0).Moveable);
+    CHECK_EQ(map.GetChunkCount(), 1u);
+
+    auto pChunk = map.FindChunk(-1, -1);
+    CHECK(pChunk != nullptr);
+    if (pChunk != nullptr)
+    {
+        CHECK_EQ(pChunk->ChunkX, -1);
+        CHECK_EQ(pChunk->ChunkY, -1);
+        CHECK(pChunk->Tiles[kChunkTileCount - 1].Moveable);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      4096x4096 タイルのマップをスクロールしても処理が画面分で済むことを確認します.
+//-----------------------------------------------------------------------------
+void TestStress()
+{
+    ChunkMap map;
+
+    std::vector<Tile> row(kWorldSize);
+    auto buildMsec = MeasureMsec([&]()
+    {
+        for(auto y=0; y<kWorldSize; ++y)
+        {
+            for(auto x=0; x<kWorldSize; ++x)
+            { row[x] = MakeTile(x, y); }
+            map.Paste(0, y, row.data(), kWorldSize, 1);
+        }
+    });
+
+    auto chunkCount = uint32_t(kWorldSize / kChunkSize) * uint32_t(kWorldSize / kChunkSize);
+    CHECK_EQ(map.GetChunkCount(), chunkCount);
+    CHECK(map.GetMemorySize() >= size_t(chunkCount) * sizeof(TileChunk));
+
+    asdx::PCG rng(3);
+    auto mismatch = 0u;
+    for(auto i=0; i<100000; ++i)
+    {
+        auto x = int32_t(rng.GetAsU32() % kWorldSize);
+        auto y = int32_t(rng.GetAsU32() % kWorldSize);
+        auto& tile   = map.GetTile(x, y);
+        auto  expect = MakeTile(x, y);
+        if (tile.TextureId != expect.TextureId || tile.Moveable != expect.Moveable)
+        { mismatch++; }
+    }
+    CHECK_EQ(mismatch, 0u);
+
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, float(kTileTotalW), float(kTileTotalH)));
+
+    // 画面に掛かるチャンクは表示範囲 + マージンを16で割った数 + 両端の1つずつまで.
+    auto maxChunkX = uint32_t((kTileCountX + 1 + kMargin * 2) / kChunkSize + 2);
+    auto maxChunkY = uint32_t((kTileCountY + 1 + kMargin * 2) / kChunkSize + 2);
+
+    MapCamera camera;
+    camera.LookAt(kWorldSize / 2, kWorldSize / 2);
+
+    auto maxVisible  = 0u;
+    auto wrongCount  = 0u;
+    auto wrongActive = 0u;
+    auto frameMsec = MeasureMsec([&]()
+    {
+        for(auto frame=0u; frame<kFrameCount; ++frame)
+        {
+            // 斜めに行き来しながら，チャンクの境界を何度もまたぐ.
+            camera.Move((frame / 500) % 2 ? -3 : 5, (frame / 700) % 2 ? 4 : -2);
+
+            map.Cull(camera, kMargin);
+            maxVisible = std::max(maxVisible, uint32_t(map.GetVisibleChunks().size()));
+
+            backend.Clear();
+            sprite.Begin();
+            map.Draw(sprite, camera, ResolveTile, kTileTotalH / 2);
+            sprite.End();
+
+            auto rect = camera.GetVisibleRect();
+            if (CountDrawn(backend.GetCapture()) != uint32_t(rect.W * rect.H))
+            { wrongCount++; }
+
+            if (!map.IsActive(rect.X - kMargin, rect.Y - kMargin)
+             || !map.IsActive(rect.X + rect.W + kMargin - 1, rect.Y + rect.H + kMargin - 1)
+             ||  map.IsActive(rect.X - kMargin - 1, rect.Y)
+             ||  map.IsActive(rect.X, rect.Y + rect.H + kMargin))
+            { wrongActive++; }
+        }
+    });
+
+    CHECK_EQ(wrongCount, 0u);
+    CHECK_EQ(wrongActive, 0u);
+    CHECK(maxVisible <= maxChunkX * maxChunkY);
+
+    printf("  %d x %d tiles : %u chunks, %.1f MB, build %.0f ms, %.1f us / frame, %u chunks visible\n",
+        kWorldSize, kWorldSize, map.GetChunkCount(), map.GetMemorySize() / (1024.0 * 1024.0),
+        buildMsec, frameMsec * 1000.0 / kFrameCount, maxVisible);
+
+    sprite.Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("ChunkMap : camera",            TestCamera);
+    RunTest("ChunkMap : negative coords",   TestNegative);
+    RunTest("ChunkMap : 4096x4096 stress",  TestStress);
+    return TestResult();
+}
@@ -0,0 +1,221 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_GimmickGrid.cpp
+// Desc : Tests for Gimmick Grid.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <GimmickGrid.h>
+#include <GimmickPool.h>
+#include <gimmick/Block.h>
+#include <MapTile.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+
+namespace {
+
+// グリッドが this を保持するので，ギミックは複製も移動もできないこと.
+static_assert(!std::is_copy_constructible<Block>::value, "Block must not be copyable.");
+static_assert(!std::is_move_constructible<Block>::value, "Block must not be movable.");
+static_assert(!std::is_copy_assignable<Block>::value,    "Block must not be copyable.");
+static_assert(!std::is_move_assignable<Block>::value,    "Block must not be movable.");
+
+
+///////////////////////////////////////////////////////////////////////////////
+// PoolItem structure
+///////////////////////////////////////////////////////////////////////////////
+struct alignas(16) PoolItem
+{
+    static int  Alive;
+    int         Value = 0;
+
+    PoolItem () { Alive++; }
+    ~PoolItem() { Alive--; }
+
+    PoolItem             (const PoolItem&) = delete;
+    PoolItem& operator = (const PoolItem&) = delete;
+};
+
+int PoolItem::Alive = 0;
+
+//-----------------------------------------------------------------------------
+//      全件を調べて矩形と重なるものを求めます.
+//-----------------------------------------------------------------------------
+std::vector<Gimmick*> QueryAll(const std::vector<Box>& boxes, const std::vector<bool>& alive, const Box& box)
+{
+    std::vector<Gimmick*> result;
+    for(size_t i=0; i<boxes.size(); ++i)
+    {
+        if (alive[i] && IsHit(box, boxes[i]))
+        { result.push_back(FakePointer<Gimmick>(uint32_t(i))); }
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      複数セルに掛かるギミックが1度だけ返ることを確認します.
+//-----------------------------------------------------------------------------
+void TestMultiCell()
+{
+    GimmickGrid grid;
+    grid.Init(0, 0, kTileSize, kTileCountX, kTileCountY);
+
+    // 3x3 セルに掛かる大きなギミックと，1セルの小さなギミック.
+    auto pLarge = FakePointer<Gimmick>(0);
+    auto pSmall = FakePointer<Gimmick>(1);
+    auto large  = grid.Insert(pLarge, Box(kTileSize + 8, kTileSize + 8, kTileSize * 2, kTileSize * 2));
+    grid.Insert(pSmall, Box(kTileSize * 2, kTileSize * 2, 16, 16));
+
+    std::vector<Gimmick*> hits;
+    for(auto i=0; i<3; ++i)
+    {
+        grid.Query(Box(0, 0, kTileSize * 5, kTileSize * 5), hits);
+        CHECK_EQ(hits.size(), 2u);
+        CHECK_EQ(std::count(hits.begin(), hits.end(), pLarge), 1);
+        CHECK_EQ(std::count(hits.begin(), hits.end(), pSmall), 1);
+    }
+
+    // 掛かるセルが変わっても1度だけ.
+    grid.Move(large, Box(kTileSize * 5 - 8, kTileSize * 3 - 8, kTileSize * 3, kTileSize));
+    grid.Query(Box(kTileSize * 4, kTileSize * 2, kTileSize * 6, kTileSize * 3), hits);
+    CHECK_EQ(hits.size(), 1u);
+    CHECK_EQ(std::count(hits.begin(), hits.end(), pLarge), 1);
+
+    // 同じセルにいても重なっていなければ返らない.
+    grid.Query(Box(kTileSize * 2 + 32, kTileSize * 2 + 32, 8, 8), hits);
+    CHECK(hits.empty());
+
+    // 部屋の外へ出た部分は端のセルで引ける.
+    grid.Move(large, Box(-kTileSize * 3, -kTileSize, kTileSize * 4, kTileSize * 2));
+    grid.Query(Box(-kTileSize * 2, -kTileSize / 2, 16, 16), hits);
+    CHECK_EQ(hits.size(), 1u);
+
+    grid.Remove(large);
+    grid.Query(Box(0, 0, kTileTotalW, kTileTotalH), hits);
+    CHECK_EQ(hits.size(), 1u);
+    CHECK_EQ(grid.GetCount(), 1u);
+}
+
+//-----------------------------------------------------------------------------
+//      移動と削除を挟んでも全件の検索と一致することを確認します.
+//-----------------------------------------------------------------------------
+void TestRandom()
+{
+    GimmickGrid grid;
+    grid.Init(0, 0, kTileSize, kTileCountX, kTileCountY);
+
+    asdx::PCG rng(5);
+    auto randomBox = [&]()
+    {
+        // 部屋の外にはみ出すものも混ぜる.
+        auto w = int(16 + rng.GetAsU32() % (kTileSize * 3));
+        auto h = int(16 + rng.GetAsU32() % (kTileSize * 3));
+        auto x = int(rng.GetAsU32() % (kTileTotalW + kTileSize * 2)) - kTileSize;
+        auto y = int(rng.GetAsU32() % (kTileTotalH + kTileSize * 2)) - kTileSize;
+        return Box(x, y, w, h);
+    };
+
+    std::vector<Box>      boxes(300);
+    std::vector<bool>     alive(boxes.size(), true);
+    std::vector<uint32_t> ids  (boxes.size());
+    for(size_t i=0; i<boxes.size(); ++i)
+    {
+        boxes[i] = randomBox();
+        ids[i]   = grid.Insert(FakePointer<Gimmick>(uint32_t(i)), boxes[i]);
+    }
+
+    std::vector<Gimmick*> hits;
+    auto mismatch = 0u;
+    for(auto round=0; round<20; ++round)
+    {
+        for(auto i=0; i<50; ++i)
+        {
+            auto index = rng.GetAsU32() % boxes.size();
+            if (!alive[index])
+            { continue; }
+
+            if (round % 5 == 4 && i == 0)
+            {
+                grid.Remove(ids[index]);
+                alive[index] = false;
+                continue;
+            }
+
+            boxes[index].Pos.x += int(rng.GetAsU32() % 33) - 16;
+            boxes[index].Pos.y += int(rng.GetAsU32() % 33) - 16;
+            grid.Move(ids[index], boxes[index]);
+        }
+
+        for(auto i=0; i<100; ++i)
+        {
+            auto box = randomBox();
+            grid.Query(box, hits);
+
+            auto expect = QueryAll(boxes, alive, box);
+            std::sort(hits.begin(), hits.end());
+            if (hits != expect)
+            { mismatch++; }
+        }
+    }
+
+    CHECK_EQ(mismatch, 0u);
+    CHECK_EQ(grid.GetCount(), uint32_t(std::count(alive.begin(), alive.end(), true)));
+}
+
+//-----------------------------------------------------------------------------
+//      複製も移動もできない型を GimmickPool が直接構築・破棄することを確認します.
+//-----------------------------------------------------------------------------
+void TestPool()
+{
+    {
+        GimmickPool<PoolItem> pool;
+        pool.Init(8);
+        for(auto i=0; i<8; ++i)
+        { pool.Add().Value = i; }
+        CHECK_EQ(pool.GetCount(), 8u);
+        CHECK_EQ(PoolItem::Alive, 8);
+        CHECK_EQ(uintptr_t(pool.begin()) % alignof(PoolItem), 0u);
+
+        auto expect = 0;
+        for(auto& itr : pool)
+        { CHECK_EQ(itr.Value, expect++); }
+
+        // 容量以下なら領域を使い回すので，先頭のアドレスは変わらない.
+        auto pHead = pool.begin();
+        pool.Init(4);
+        CHECK_EQ(PoolItem::Alive, 0);
+        CHECK_EQ(pool.GetCount(), 0u);
+        pool.Add();
+        CHECK(pool.begin() == pHead);
+
+        // 容量を増やしても構築済みの要素は無い.
+        pool.Init(32);
+        CHECK_EQ(PoolItem::Alive, 0);
+        for(auto i=0; i<32; ++i)
+        { pool.Add(); }
+        CHECK_EQ(PoolItem::Alive, 32);
+    }
+
+    // デストラクタで全て破棄される.
+    CHECK_EQ(PoolItem::Alive, 0);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("GimmickGrid : multi cell once",    TestMultiCell);
+    RunTest("GimmickGrid : random vs all",      TestRandom);
+    RunTest("GimmickPool : in place",           TestPool);
+    return TestResult();
+}
@@ -0,0 +1,360 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_GlyphCache.cpp
+// Desc : Tests for Glyph Atlas Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <GlyphCache.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char* kFixturePath = "fixture/bitmap_font.txt";
+
+
+///////////////////////////////////////////////////////////////////////////////
+// BitmapFont class
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      テキストで書いたビットマップフォントです. 書式は fixture/bitmap_font.txt を参照.
+///////////////////////////////////////////////////////////////////////////////
+class BitmapFont : public IGlyphRasterizer
+{
+public:
+    uint32_t RasterizeCount = 0;    //!< Rasterize() を呼ばれた回数.
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルから読み込みます.
+    //-------------------------------------------------------------------------
+    bool Load(const char* path)
+    {
+        FILE* pFile = fopen(path, "r");
+        if (pFile == nullptr)
+        {
+            fprintf(stderr, "Error : File Open Failed. path = %s\n", path);
+            return false;
+        }
+
+        char        line[256];
+        GlyphBitmap* pGlyph = nullptr;
+        while(fgets(line, sizeof(line), pFile) != nullptr)
+        {
+            line[strcspn(line, "\r\n")] = '\0';
+
+            unsigned code = 0;
+            int advance = 0, offsetX = 0, offsetY = 0;
+
+            if (line[0] == ';' || line[0] == '\0')
+            { continue; }
+            else if (sscanf(line, "ascent %d", &m_Ascent) == 1)
+            { continue; }
+            else if (sscanf(line, "line %d", &m_LineHeight) == 1)
+            { continue; }
+            else if (sscanf(line, "glyph %x %d %d %d", &code, &advance, &offsetX, &offsetY) == 4)
+            {
+                pGlyph = &m_Glyphs[code];
+                pGlyph->Advance = advance;
+                pGlyph->OffsetX = offsetX;
+                pGlyph->OffsetY = offsetY;
+                pGlyph->Width   = 0;
+                pGlyph->Height  = 0;
+            }
+            else if (strcmp(line, "end") == 0)
+            { pGlyph = nullptr; }
+            else if (pGlyph != nullptr)
+            {
+                pGlyph->Width = uint32_t(strlen(line));
+                pGlyph->Height++;
+                for(auto p = line; *p != '\0'; ++p)
+                { pGlyph->Coverage.push_back((*p == '#') ? 255 : (*p == '+') ? 128 : 0); }
+            }
+        }
+
+        fclose(pFile);
+        return !m_Glyphs.empty();
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字の画素を取得します.
+    //-------------------------------------------------------------------------
+    const GlyphBitmap* GetGlyph(uint32_t code) const
+    {
+        auto itr = m_Glyphs.find(code);
+        return (itr != m_Glyphs.end()) ? &itr->second : nullptr;
+    }
+
+    bool Rasterize(uint32_t code, GlyphBitmap& result) override
+    {
+        RasterizeCount++;
+        auto pGlyph = GetGlyph(code);
+        if (pGlyph == nullptr)
+        { return false; }
+
+        result = *pGlyph;
+        return true;
+    }
+
+    int32_t GetAdvance(uint32_t code) override
+    {
+        auto pGlyph = GetGlyph(code);
+        return (pGlyph != nullptr) ? pGlyph->Advance : 0;
+    }
+
+    int32_t GetAscent() const override
+    { return m_Ascent; }
+
+    int32_t GetLineHeight() const override
+    { return m_LineHeight; }
+
+private:
+    std::unordered_map<uint32_t, GlyphBitmap>   m_Glyphs;
+    int32_t                                     m_Ascent     = 0;
+    int32_t                                     m_LineHeight = 0;
+};
+
+//-----------------------------------------------------------------------------
+//      テクスチャ座標の左上の画素を取得します.
+//-----------------------------------------------------------------------------
+uint8_t GetPixel(const GlyphCache& cache, uint32_t page, const float* texRect, int x, int y)
+{
+    auto size = int(cache.GetDesc().PageSize);
+    auto left = int(texRect[0] * size + 0.5f);
+    auto top  = int(texRect[1] * size + 0.5f);
+    return cache.GetPagePixels(page)[(top + y) * size + left + x];
+}
+
+//-----------------------------------------------------------------------------
+//      縁取りを先に，塗りつぶしを後に並べることを確認します.
+//-----------------------------------------------------------------------------
+void TestQuadOrder()
+{
+    BitmapFont font;
+    CHECK(font.Load(kFixturePath));
+
+    GlyphCache cache;
+    CHECK(cache.Init(&font, GlyphCacheDesc{ 256, 1, 16, 2 }));
+    cache.NewFrame();
+
+    std::vector<GlyphQuad> quads;
+    auto count = cache.BuildQuads(L"AB \x3042.", 100, 50, quads);
+
+    // 空白は矩形を作らないが，送り幅は進める.
+    CHECK_EQ(count, 4u);
+    CHECK_EQ(quads.size(), 8u);
+    if (quads.size() != 8)
+    { return; }
+
+    const int32_t penX[] = { 100, 106, 116, 126 };
+    const uint32_t codes[] = { 'A', 'B', 0x3042, '.' };
+    for(auto i=0u; i<4; ++i)
+    {
+        auto& line  = quads[i];
+        auto& fill  = quads[i + 4];
+        auto  glyph = font.GetGlyph(codes[i]);
+
+        CHECK(line.Outline);
+        CHECK(!fill.Outline);
+        CHECK_EQ(line.X, penX[i] + glyph->OffsetX - 2);
+        CHECK_EQ(line.Y, 50 + 9 + glyph->OffsetY - 2);
+        CHECK_EQ(line.W, int32_t(glyph->Width  + 4));
+        CHECK_EQ(line.H, int32_t(glyph->Height + 4));
+
+        // 塗りつぶしは同じ矩形で，テクスチャ座標だけが異なる.
+        CHECK_EQ(fill.X, line.X);
+        CHECK_EQ(fill.Y, line.Y);
+        CHECK_EQ(fill.W, line.W);
+        CHECK_EQ(fill.H, line.H);
+        CHECK(fill.TexRect[0] != line.TexRect[0]);
+    }
+
+    CHECK_EQ(cache.Measure(L"AB \x3042."), 6 + 6 + 4 + 10 + 3);
+}
+
+//-----------------------------------------------------------------------------
+//      追加した文字のセルの行だけが更新範囲になることを確認します.
+//-----------------------------------------------------------------------------
+void TestDirtyRows()
+{
+    BitmapFont font;
+    CHECK(font.Load(kFixturePath));
+
+    // 1行に 64 / (16 * 2) = 2 文字.
+    GlyphCache cache;
+    CHECK(cache.Init(&font, GlyphCacheDesc{ 64, 1, 16, 2 }));
+    cache.NewFrame();
+
+    // 初回は全体.
+    uint32_t top = 0, bottom = 0;
+    CHECK(cache.GetDirtyRows(0, top, bottom));
+    CHECK_EQ(top, 0u);
+    CHECK_EQ(bottom, 64u);
+
+    cache.ClearDirty(0);
+    CHECK(!cache.GetDirtyRows(0, top, bottom));
+
+    cache.Find('A');
+    cache.Find('B');
+    CHECK(cache.GetDirtyRows(0, top, bottom));
+    CHECK_EQ(top, 0u);
+    CHECK_EQ(bottom, 16u);
+
+    // 登録済みの文字は書き込まない.
+    cache.ClearDirty(0);
+    cache.Find('A');
+    CHECK(!cache.GetDirtyRows(0, top, bottom));
+
+    // 3文字目は2行目のセル.
+    cache.Find('C');
+    CHECK(cache.GetDirtyRows(0, top, bottom));
+    CHECK_EQ(top, 16u);
+    CHECK_EQ(bottom, 32u);
+}
+
+//-----------------------------------------------------------------------------
+//      縁取りが角を丸めた半径で膨張した形になることを確認します.
+//-----------------------------------------------------------------------------
+void TestOutlineDilation()
+{
+    BitmapFont font;
+    CHECK(font.Load(kFixturePath));
+
+    GlyphCache cache;
+    CHECK(cache.Init(&font, GlyphCacheDesc{ 64, 1, 16, 2 }));
+    cache.NewFrame();
+
+    // 1画素の点を半径2で膨張させると，5x5 から四隅を除いた形になる.
+    const char* kExpected[] =
+    {
+        ".###.",
+        "#####",
+        "#####",
+        "#####",
+        ".###.",
+    };
+
+    auto entry = cache.Find('.');
+    CHECK(entry != nullptr);
+    if (entry == nullptr)
+    { return; }
+
+    CHECK_EQ(entry->Width,  5u);
+    CHECK_EQ(entry->Height, 5u);
+    for(auto y=0; y<5; ++y)
+    {
+        for(auto x=0; x<5; ++x)
+        {
+            auto line = GetPixel(cache, entry->Page, entry->OutlineRect, x, y);
+            auto fill = GetPixel(cache, entry->Page, entry->FillRect,    x, y);
+            CHECK_EQ(line, (kExpected[y][x] == '#') ? 255 : 0);
+            CHECK_EQ(fill, (x == 2 && y == 2) ? 255 : 0);
+        }
+    }
+
+    // 縁取りは半径内の最大値なので，'+' (128) の隣でも '#' があれば 255.
+    auto g     = cache.Find('G');
+    auto glyph = font.GetGlyph('G');
+    CHECK(g != nullptr);
+    if (g == nullptr)
+    { return; }
+
+    for(auto y=0; y<int(g->Height); ++y)
+    {
+        for(auto x=0; x<int(g->Width); ++x)
+        {
+            uint8_t expected = 0;
+            for(auto dy=-2; dy<=2; ++dy)
+            {
+                for(auto dx=-2; dx<=2; ++dx)
+                {
+                    auto sx = x - 2 + dx;
+                    auto sy = y - 2 + dy;
+                    if (sx < 0 || sy < 0 || sx >= int(glyph->Width) || sy >= int(glyph->Height))
+                    { continue; }
+                    if (dx * dx + dy * dy > 2 * 2 + 2)
+                    { continue; }
+                    expected = std::max(expected, glyph->Coverage[sy * glyph->Width + sx]);
+                }
+            }
+            CHECK_EQ(GetPixel(cache, g->Page, g->OutlineRect, x, y), expected);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      最も長く使われていないページを追い出し，現在のフレームで使ったページは残すことを確認します.
+//-----------------------------------------------------------------------------
+void TestEviction()
+{
+    BitmapFont font;
+    CHECK(font.Load(kFixturePath));
+
+    // 1ページに 1列 x 2行 = 2文字, 全体で4文字.
+    GlyphCache cache;
+    CHECK(cache.Init(&font, GlyphCacheDesc{ 32, 2, 16, 2 }));
+
+    cache.NewFrame();
+    CHECK(cache.Find('A') != nullptr);
+    CHECK(cache.Find('B') != nullptr);
+    cache.NewFrame();
+    CHECK(cache.Find('C') != nullptr);
+    CHECK(cache.Find('D') != nullptr);
+    CHECK_EQ(cache.GetGlyphCount(), 4u);
+    CHECK_EQ(cache.GetEvictCount(), 0u);
+
+    // A のページ(0)を今のフレームで使うので，古い方ではなくページ1を追い出す.
+    cache.NewFrame();
+    auto a = cache.Find('A');
+    CHECK(a != nullptr);
+    auto e = cache.Find('E');
+    CHECK(e != nullptr);
+    CHECK_EQ(cache.GetEvictCount(), 1u);
+    if (a != nullptr && e != nullptr)
+    { CHECK(e->Page != a->Page); }
+
+    // A と B は残り，C と D は消える.
+    auto before = font.RasterizeCount;
+    CHECK(cache.Find('B') != nullptr);
+    CHECK_EQ(font.RasterizeCount, before);
+
+    // 全ページを使っている間は追い出さずに失敗する.
+    CHECK(cache.Find('F') != nullptr);
+    CHECK(cache.Find('G') == nullptr);
+    CHECK_EQ(cache.GetEvictCount(), 1u);
+    CHECK_EQ(cache.GetGlyphCount(), 4u);
+
+    // 表示中の文字の画素は壊れていない.
+    a = cache.Find('A');
+    CHECK(a != nullptr);
+    if (a != nullptr)
+    { CHECK_EQ(GetPixel(cache, a->Page, a->FillRect, 2 + 0, 2 + 3), 255); }
+
+    // 次のフレームなら空けられる.
+    cache.NewFrame();
+    CHECK(cache.Find('G') != nullptr);
+    CHECK_EQ(cache.GetEvictCount(), 2u);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("GlyphCache : quad order",       TestQuadOrder);
+    RunTest("GlyphCache : dirty rows",       TestDirtyRows);
+    RunTest("GlyphCache : outline dilation", TestOutlineDilation);
+    RunTest("GlyphCache : eviction",         TestEviction);
+    return TestResult();
+}
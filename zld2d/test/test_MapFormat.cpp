@@ -0,0 +1,303 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_MapFormat.cpp
+// Desc : Tests for Binary Map File Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <MapFormat.h>
+#include <MappedFile.h>
+#include <TextureId.h>
+#include <DirectionState.h>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char* kTempPath  = "obj/test_MapFormat.map";
+static const char* kTempPath2 = "obj/test_MapFormat2.map";
+
+//-----------------------------------------------------------------------------
+//      外周が木，内側が床の部屋を作ります.
+//-----------------------------------------------------------------------------
+void MakeRoom(Tile* pTiles, std::vector<MapGimmickDesc>& gimmicks)
+{
+    for(auto y=0u; y<kTileCountY; ++y)
+    {
+        for(auto x=0u; x<kTileCountX; ++x)
+        {
+            auto  edge = (x == 0 || y == 0 || x == kTileCountX - 1u || y == kTileCountY - 1u);
+            auto& tile = pTiles[x + y * kTileCountX];
+            tile = Tile();
+            tile.TextureId  = uint8_t(edge ? TEXTURE_MAP_TREE : TEXTURE_WHITE);
+            tile.Moveable   = !edge;
+            tile.Scrollable = (y == 5 && (x == 0 || x == kTileCountX - 1u));
+            tile.Moveable  |= tile.Scrollable;
+        }
+    }
+    pTiles[4 + 3 * kTileCountX].TextureId = TEXTURE_MAP_ROCK;
+    pTiles[4 + 3 * kTileCountX].Moveable  = false;
+
+    gimmicks.clear();
+    for(auto i=0u; i<3; ++i)
+    {
+        MapGimmickDesc desc = {};
+        desc.Type      = MAP_GIMMICK_BLOCK;
+        desc.TileX     = uint8_t(4 + i);
+        desc.TileY     = 5;
+        desc.Width     = kTileSize;
+        desc.Height    = kTileSize;
+        desc.TextureId = TEXTURE_MAP_BLOCK;
+        desc.Dir       = uint8_t(DIRECTION_NONE);
+        gimmicks.push_back(desc);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルを読み込みます.
+//-----------------------------------------------------------------------------
+std::vector<uint8_t> ReadFile(const char* path)
+{
+    std::vector<uint8_t> result;
+    FILE* pFile = fopen(path, "rb");
+    if (pFile == nullptr)
+    { return result; }
+
+    fseek(pFile, 0, SEEK_END);
+    result.resize(size_t(ftell(pFile)));
+    fseek(pFile, 0, SEEK_SET);
+    if (fread(result.data(), 1, result.size(), pFile) != result.size())
+    { result.clear(); }
+    fclose(pFile);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      ResolveMapFile() 用に 16byte 境界に置いたコピーを検証します.
+//-----------------------------------------------------------------------------
+bool Resolve(const std::vector<uint8_t>& data, size_t size, MapFileView& view, std::vector<uint64_t>& storage)
+{
+    storage.assign((data.size() + 15) / 8 + 2, 0);
+    auto pData = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(storage.data()) + 15) & ~uintptr_t(15));
+    memcpy(pData, data.data(), data.size());
+    return ResolveMapFile(pData, size, view);
+}
+
+//-----------------------------------------------------------------------------
+//      書き出して読み込んだ内容が一致することを確認します.
+//-----------------------------------------------------------------------------
+void TestRoundTrip(bool checksum)
+{
+    Tile tiles[kTileTotalCount];
+    std::vector<MapGimmickDesc> gimmicks;
+    MakeRoom(tiles, gimmicks);
+
+    CHECK(WriteMapFile(kTempPath, tiles, gimmicks.data(), uint32_t(gimmicks.size()), checksum));
+
+    MappedFile file;
+    CHECK(file.Open(kTempPath));
+
+    MapFileView view = {};
+    CHECK(ResolveMapFile(file.GetData(), file.GetSize(), view));
+    if (view.pHeader == nullptr)
+    { return; }
+
+    CHECK_EQ(view.pHeader->Magic,   kMapFileMagic);
+    CHECK_EQ(view.pHeader->Version, kMapFileVersion);
+    CHECK_EQ(view.pHeader->FileSize, file.GetSize());
+    CHECK_EQ((view.pHeader->Flags & MAP_FILE_FLAG_CHECKSUM) != 0, checksum);
+    CHECK_EQ(view.pHeader->TileOffset    % kMapFileAlignment, 0u);
+    CHECK_EQ(view.pHeader->PaletteOffset % kMapFileAlignment, 0u);
+    CHECK_EQ(view.pHeader->GimmickOffset % kMapFileAlignment, 0u);
+
+    // 床, 木, スクロール, 岩 の4種.
+    CHECK_EQ(view.PaletteCount, 4u);
+    for(auto i=0u; i<kTileTotalCount; ++i)
+    {
+        CHECK(view.pTileIndices[i] < view.PaletteCount);
+        CHECK(memcmp(&view.pPalette[view.pTileIndices[i]], &tiles[i], sizeof(Tile)) == 0);
+    }
+
+    CHECK_EQ(view.GimmickCount, uint32_t(gimmicks.size()));
+    CHECK(memcmp(view.pGimmicks, gimmicks.data(), sizeof(MapGimmickDesc) * gimmicks.size()) == 0);
+
+    // マッピングはコピーオンライトなので，書き換えてもファイルは変わらない.
+    view.pTileIndices[20] = 0;
+    MappedFile other;
+    CHECK(other.Open(kTempPath));
+    MapFileView otherView = {};
+    CHECK(ResolveMapFile(other.GetData(), other.GetSize(), otherView));
+    if (otherView.pHeader != nullptr)
+    { CHECK(memcmp(&otherView.pPalette[otherView.pTileIndices[20]], &tiles[20], sizeof(Tile)) == 0); }
+
+    // 同じ内容なら同じバイト列.
+    CHECK(WriteMapFile(kTempPath2, tiles, gimmicks.data(), uint32_t(gimmicks.size()), checksum));
+    CHECK(ReadFile(kTempPath) == ReadFile(kTempPath2));
+
+    file .Close();
+    other.Close();
+    remove(kTempPath);
+    remove(kTempPath2);
+}
+
+//-----------------------------------------------------------------------------
+//      壊れたファイルを拒否することを確認します.
+//-----------------------------------------------------------------------------
+void TestReject()
+{
+    Tile tiles[kTileTotalCount];
+    std::vector<MapGimmickDesc> gimmicks;
+    MakeRoom(tiles, gimmicks);
+
+    CHECK(WriteMapFile(kTempPath, tiles, gimmicks.data(), uint32_t(gimmicks.size()), true));
+    auto data = ReadFile(kTempPath);
+    remove(kTempPath);
+    CHECK(data.size() > sizeof(MapFileHeader));
+    if (data.size() <= sizeof(MapFileHeader))
+    { return; }
+
+    std::vector<uint64_t> storage;
+    MapFileView view = {};
+    CHECK(Resolve(data, data.size(), view, storage));
+
+    // 切り詰め.
+    CHECK(!Resolve(data, data.size() - 16, view, storage));
+    CHECK(!Resolve(data, sizeof(MapFileHeader) - 1, view, storage));
+
+    // 本体の1bitの化け.
+    auto broken = data;
+    broken[sizeof(MapFileHeader) + 5] ^= 1;
+    CHECK(!Resolve(broken, broken.size(), view, storage));
+
+    // ヘッダの各項目.
+    auto header = [&](size_t offset, uint8_t value)
+    {
+        auto copy = data;
+        copy[offset] = value;
+        return Resolve(copy, copy.size(), view, storage);
+    };
+    CHECK(!header(offsetof(MapFileHeader, Magic),         0));
+    CHECK(!header(offsetof(MapFileHeader, Version),       99));
+    CHECK(!header(offsetof(MapFileHeader, HeaderSize),    40));
+    CHECK(!header(offsetof(MapFileHeader, TileCountX),    kTileCountX + 1));
+    CHECK(!header(offsetof(MapFileHeader, PaletteStride), 6));
+    CHECK(!header(offsetof(MapFileHeader, GimmickCount),  200));
+
+    // チェックサム無しなら本体の化けは検出しないが，範囲外のパレット番号は拒否する.
+    CHECK(WriteMapFile(kTempPath, tiles, gimmicks.data(), uint32_t(gimmicks.size()), false));
+    auto plain = ReadFile(kTempPath);
+    remove(kTempPath);
+    CHECK(Resolve(plain, plain.size(), view, storage));
+    if (view.pHeader != nullptr)
+    {
+        auto copy = plain;
+        copy[view.pHeader->TileOffset] = 200;
+        CHECK(!Resolve(copy, copy.size(), view, storage));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      パレットの bool に 0/1 以外の値があれば拒否することを確認します.
+//-----------------------------------------------------------------------------
+void TestRejectTileFlag()
+{
+    Tile tiles[kTileTotalCount];
+    std::vector<MapGimmickDesc> gimmicks;
+    MakeRoom(tiles, gimmicks);
+
+    // チェックサムで弾かれないように，チェックサム無しで書き出す.
+    CHECK(WriteMapFile(kTempPath, tiles, gimmicks.data(), uint32_t(gimmicks.size()), false));
+    auto data = ReadFile(kTempPath);
+    remove(kTempPath);
+
+    std::vector<uint64_t> storage;
+    MapFileView view = {};
+    CHECK(Resolve(data, data.size(), view, storage));
+    if (view.pHeader == nullptr)
+    { return; }
+
+    auto paletteOffset = view.pHeader->PaletteOffset;
+    auto paletteCount  = view.PaletteCount;
+
+    const size_t kOffsets[] = {
+        offsetof(Tile, Moveable),
+        offsetof(Tile, Scrollable),
+        offsetof(Tile, Switchable),
+        offsetof(Tile, Fallable),
+    };
+
+    for(auto i=0u; i<paletteCount; ++i)
+    {
+        for(auto offset : kOffsets)
+        {
+            auto copy = data;
+            auto pos  = paletteOffset + i * sizeof(Tile) + offset;
+
+            // 0 と 1 は受け付ける.
+            copy[pos] = 0;
+            CHECK(Resolve(copy, copy.size(), view, storage));
+            copy[pos] = 1;
+            CHECK(Resolve(copy, copy.size(), view, storage));
+
+            for(auto value : { 2, 0x80, 0xff })
+            {
+                copy[pos] = uint8_t(value);
+                CHECK(!Resolve(copy, copy.size(), view, storage));
+            }
+        }
+
+        // テクスチャ番号は bool ではないので任意の値を許す.
+        auto copy = data;
+        copy[paletteOffset + i * sizeof(Tile) + offsetof(Tile, TextureId)] = 0xff;
+        CHECK(Resolve(copy, copy.size(), view, storage));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      リポジトリの部屋ファイルが読み込めることを確認します.
+//-----------------------------------------------------------------------------
+void TestRepositoryRooms()
+{
+    const char* kPaths[] =
+    {
+        "../res/map/room_000.map",
+        "../res/map/room_001.map",
+        "../res/map/room_002.map",
+        "../res/map/room_003.map",
+        "../res/map/room_004.map",
+    };
+
+    for(auto path : kPaths)
+    {
+        MappedFile file;
+        CHECK(file.Open(path));
+
+        MapFileView view = {};
+        CHECK(ResolveMapFile(file.GetData(), file.GetSize(), view));
+        CHECK(view.pHeader != nullptr && (view.pHeader->Flags & MAP_FILE_FLAG_CHECKSUM) != 0);
+    }
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("MapFormat : round trip (checksum)",    []{ TestRoundTrip(true);  });
+    RunTest("MapFormat : round trip (no checksum)", []{ TestRoundTrip(false); });
+    RunTest("MapFormat : reject",                   TestReject);
+    RunTest("MapFormat : reject tile flag",         TestRejectTileFlag);
+    RunTest("MapFormat : repository rooms",         TestRepositoryRooms);
+    return TestResult();
+}
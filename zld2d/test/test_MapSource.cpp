@@ -0,0 +1,314 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_MapSource.cpp
+// Desc : Tests for Map Compiler Text Sources.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <MapSource.h>
+#include <TextureId.h>
+#include <DirectionState.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char* kWorkDir = "obj/test_MapSource";
+
+// 左右の境界の中央にスクロールタイルがある部屋.
+static const char* kTileDefs =
+    "tile\tT\tmap_tree\n"
+    "tile\tS\twhite\tmove\tscroll\n"
+    "tile\t.\twhite\tmove\n";
+
+static const char* kRows[kTileCountY] = {
+    "row\tTTTTTTTTTTTTTTTTTTT\n",
+    "row\tT.................T\n",
+    "row\tT.................T\n",
+    "row\tT.................T\n",
+    "row\tT.................T\n",
+    "row\tS.................S\n",
+    "row\tT.................T\n",
+    "row\tT.................T\n",
+    "row\tT.................T\n",
+    "row\tT.................T\n",
+    "row\tTTTTTTTTTTTTTTTTTTT\n",
+};
+
+
+//-----------------------------------------------------------------------------
+//      作業ディレクトリ内のパスを取得します.
+//-----------------------------------------------------------------------------
+std::string GetPath(const char* name)
+{ return std::string(kWorkDir) + "/" + name; }
+
+//-----------------------------------------------------------------------------
+//      テキストファイルを書き出します.
+//-----------------------------------------------------------------------------
+std::string WriteText(const char* name, const std::string& text)
+{
+    auto path  = GetPath(name);
+    auto pFile = fopen(path.c_str(), "wb");
+    CHECK(pFile != nullptr);
+    if (pFile != nullptr)
+    {
+        fwrite(text.data(), 1, text.size(), pFile);
+        fclose(pFile);
+    }
+    return path;
+}
+
+//-----------------------------------------------------------------------------
+//      行を指定数だけ並べた部屋ソースを作ります.
+//-----------------------------------------------------------------------------
+std::string MakeRoom(uint32_t rowCount, const char* extra = "")
+{
+    std::string result = kTileDefs;
+    for(auto i=0u; i<rowCount; ++i)
+    { result += kRows[i % kTileCountY]; }
+    result += extra;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      部屋ソースを書き出して読み込みます.
+//-----------------------------------------------------------------------------
+bool LoadText(const char* name, const std::string& text, RoomSource& room)
+{
+    auto path = WriteText(name, text);
+    return LoadRoomSource(path.c_str(), room);
+}
+
+//-----------------------------------------------------------------------------
+//      接続ファイルを書き出して，部屋ソースと合わせて検証します.
+//-----------------------------------------------------------------------------
+bool Validate(const std::string& worldText, const std::vector<RoomSource>& rooms, bool strictLinks)
+{
+    auto path = WriteText("world.txt", worldText);
+
+    WorldSource world;
+    CHECK(LoadWorldSource(path.c_str(), world));
+    CHECK_EQ(world.Rooms.size(), rooms.size());
+    if (world.Rooms.size() != rooms.size())
+    { return false; }
+
+    return ValidateLinks(path.c_str(), world, rooms, strictLinks);
+}
+
+//-----------------------------------------------------------------------------
+//      正しい部屋ソースを読み込めることを確認します.
+//-----------------------------------------------------------------------------
+void TestValidRoom()
+{
+    RoomSource room;
+    CHECK(LoadText("valid.room",
+        "# comment\n\n" + MakeRoom(kTileCountY,
+        "gimmick\tblock\t7\t4\tmap_block\tnone\n"
+        "gimmick\tblock\t3\t2\tmap_block\tleft\t32\t48\n"),
+        room));
+
+    auto& wall   = room.Tiles[0];
+    auto& floor  = room.Tiles[1 + kTileCountX];
+    auto& scroll = room.Tiles[5 * kTileCountX];
+    CHECK_EQ(wall.TextureId, uint8_t(TEXTURE_MAP_TREE));
+    CHECK(!wall.Moveable && !wall.Scrollable);
+    CHECK_EQ(floor.TextureId, uint8_t(TEXTURE_WHITE));
+    CHECK(floor.Moveable && !floor.Scrollable);
+    CHECK(scroll.Moveable && scroll.Scrollable && !scroll.Switchable && !scroll.Fallable);
+    CHECK(room.Tiles[kTileTotalCount - 1].TextureId == TEXTURE_MAP_TREE);
+
+    CHECK_EQ(room.Gimmicks.size(), 2u);
+    if (room.Gimmicks.size() == 2)
+    {
+        auto& a = room.Gimmicks[0];
+        CHECK_EQ(a.Type,  uint8_t(MAP_GIMMICK_BLOCK));
+        CHECK_EQ(a.TileX, 7u);
+        CHECK_EQ(a.TileY, 4u);
+        CHECK_EQ(a.Width,  uint16_t(kTileSize));
+        CHECK_EQ(a.Height, uint16_t(kTileSize));
+        CHECK_EQ(a.Dir,   uint8_t(DIRECTION_NONE));
+
+        auto& b = room.Gimmicks[1];
+        CHECK_EQ(b.Width,  32u);
+        CHECK_EQ(b.Height, 48u);
+        CHECK_EQ(b.Dir,   uint8_t(DIRECTION_LEFT));
+    }
+
+    // CSV でも同じタイルになる.
+    std::string csv;
+    for(auto y=0u; y<kTileCountY; ++y)
+    {
+        std::string row = kRows[y] + 4;
+        row.pop_back();
+        for(auto x=0u; x<kTileCountX; ++x)
+        {
+            csv += row[x];
+            csv += (x + 1 < kTileCountX) ? ", " : "\n";
+        }
+    }
+    WriteText("valid.csv", csv);
+
+    RoomSource fromCsv;
+    CHECK(LoadText("valid_csv.room", std::string(kTileDefs) + "csv\tvalid.csv\n", fromCsv));
+    CHECK_EQ(fromCsv.Depends.size(), 2u);
+
+    auto mismatch = 0u;
+    for(auto i=0u; i<kTileTotalCount; ++i)
+    {
+        auto& a = room.Tiles[i];
+        auto& b = fromCsv.Tiles[i];
+        if (a.TextureId != b.TextureId || a.Moveable != b.Moveable || a.Scrollable != b.Scrollable)
+        { mismatch++; }
+    }
+    CHECK_EQ(mismatch, 0u);
+}
+
+//-----------------------------------------------------------------------------
+//      行数や行の長さが合わない部屋ソースを拒否することを確認します.
+//-----------------------------------------------------------------------------
+void TestMalformedRows()
+{
+    RoomSource room;
+    CHECK(!LoadText("short.room", MakeRoom(kTileCountY - 1), room));
+    CHECK(!LoadText("long.room",  MakeRoom(kTileCountY + 1), room));
+    CHECK(!LoadText("empty.room", MakeRoom(0), room));
+
+    // 1文字足りない行.
+    auto text = MakeRoom(kTileCountY);
+    auto pos  = text.find("T.................T");
+    text.erase(pos + 1, 1);
+    CHECK(!LoadText("narrow.room", text, room));
+
+    // row と csv は混ぜられない.
+    WriteText("mixed.csv", "T\n");
+    CHECK(!LoadText("mixed.room", MakeRoom(1, "csv\tmixed.csv\n"), room));
+
+    // ギミックの位置が部屋の外.
+    CHECK(!LoadText("gimmick.room", MakeRoom(kTileCountY, "gimmick\tblock\t19\t4\tmap_block\tnone\n"), room));
+}
+
+//-----------------------------------------------------------------------------
+//      定義されていない記号やキーワードを拒否することを確認します.
+//-----------------------------------------------------------------------------
+void TestUnknownKey()
+{
+    RoomSource room;
+
+    // パレットに無い記号.
+    auto text = MakeRoom(kTileCountY);
+    text[text.find("T.................T") + 3] = 'X';
+    CHECK(!LoadText("unknown_tile.room", text, room));
+
+    // 未知の行, タイルの属性, テクスチャ, ギミック, 方向.
+    CHECK(!LoadText("unknown_line.room",    MakeRoom(kTileCountY, "wall\tT\n"), room));
+    CHECK(!LoadText("unknown_flag.room",    "tile\tW\twhite\tswim\n" + MakeRoom(kTileCountY), room));
+    CHECK(!LoadText("unknown_texture.room", "tile\tW\tno_such_texture\n" + MakeRoom(kTileCountY), room));
+    CHECK(!LoadText("unknown_gimmick.room", MakeRoom(kTileCountY, "gimmick\tspike\t7\t4\tmap_block\tnone\n"), room));
+    CHECK(!LoadText("unknown_dir.room",     MakeRoom(kTileCountY, "gimmick\tblock\t7\t4\tmap_block\tnorth\n"), room));
+
+    // 同じ記号の再定義.
+    CHECK(!LoadText("duplicate_tile.room", "tile\tT\twhite\n" + MakeRoom(kTileCountY), room));
+
+    // 接続ファイルの未知の行と部屋名.
+    WorldSource world;
+    auto path = WriteText("unknown_world.txt", "room\ta\ta.map\nportal\ta\tb\n");
+    CHECK(!LoadWorldSource(path.c_str(), world));
+    path = WriteText("unknown_link.txt", "room\ta\ta.map\nlink\ta\tleft\tb\n");
+    CHECK(!LoadWorldSource(path.c_str(), world));
+    path = WriteText("unknown_dir.txt", "room\ta\ta.map\nroom\tb\tb.map\nlink\ta\twest\tb\n");
+    CHECK(!LoadWorldSource(path.c_str(), world));
+}
+
+//-----------------------------------------------------------------------------
+//      接続の検証を確認します.
+//-----------------------------------------------------------------------------
+void TestLinks()
+{
+    RoomSource room;
+    CHECK(LoadText("link.room", MakeRoom(kTileCountY), room));
+    std::vector<RoomSource> rooms(3, room);
+
+    const std::string kRooms =
+        "root\t../res/map/\n"
+        "room\ta\ta.map\n"
+        "room\tb\tb.map\n"
+        "room\tc\tc.map\n";
+
+    // a の右に b と c の両方を繋ぐのは食い違い.
+    CHECK(!Validate(kRooms + "link\ta\tright\tb\nlink\ta\tright\tc\n", rooms, false));
+
+    // 逆方向から見て食い違う接続.
+    CHECK(!Validate(kRooms + "link\ta\tright\tb\nlink\tc\tright\tb\n", rooms, false));
+
+    // 境界のスクロールタイルが無い方向への接続.
+    CHECK(!Validate(kRooms + "link\ta\tup\tb\n", rooms, false));
+
+    // 境界のスクロールタイルの位置が揃っていない.
+    auto moved = room;
+    moved.Tiles[5 * kTileCountX]     = room.Tiles[kTileCountX];
+    moved.Tiles[4 * kTileCountX]     = room.Tiles[5 * kTileCountX];
+    auto shifted = rooms;
+    shifted[1] = moved;
+    CHECK(!Validate(kRooms + "link\ta\tright\tb\n", shifted, false));
+
+    // a-b-c を左右に繋ぐ. 同じ接続の重複は食い違いではない.
+    // a の左と c の右は接続が無いので，既定は警告だけで通り，strictLinks なら誤り.
+    auto chain = kRooms + "link\ta\tright\tb\nlink\tb\tright\tc\nlink\tc\tleft\tb\n";
+    CHECK( Validate(chain, rooms, false));
+    CHECK(!Validate(chain, rooms, true));
+
+    // 輪にすると全ての境界が繋がるので strictLinks でも通る.
+    CHECK(Validate(chain + "link\tc\tright\ta\n", rooms, true));
+}
+
+//-----------------------------------------------------------------------------
+//      リポジトリの部屋ソースを確認します.
+//-----------------------------------------------------------------------------
+void TestRepositoryWorld()
+{
+    const char* kWorldPath = "../res/map/world.txt";
+
+    WorldSource world;
+    CHECK(LoadWorldSource(kWorldPath, world));
+    CHECK_EQ(world.Rooms.size(), 5u);
+
+    std::vector<RoomSource> rooms(world.Rooms.size());
+    for(auto i=0u; i<world.Rooms.size(); ++i)
+    {
+        auto path = "../res/map/src/" + world.Rooms[i].Name + ".room";
+        CHECK(LoadRoomSource(path.c_str(), rooms[i]));
+    }
+
+    // 周りの部屋は接続の無い境界にもスクロールタイルを残しているので，既定の警告なら通る.
+    CHECK( ValidateLinks(kWorldPath, world, rooms, false));
+    CHECK(!ValidateLinks(kWorldPath, world, rooms, true));
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    std::error_code err;
+    std::filesystem::create_directories(kWorkDir, err);
+
+    RunTest("MapSource : valid room",       TestValidRoom);
+    RunTest("MapSource : malformed rows",   TestMalformedRows);
+    RunTest("MapSource : unknown key",      TestUnknownKey);
+    RunTest("MapSource : links",            TestLinks);
+    RunTest("MapSource : repository world", TestRepositoryWorld);
+
+    std::filesystem::remove_all(kWorkDir, err);
+    return TestResult();
+}
@@ -0,0 +1,163 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_MapSystem.cpp
+// Desc : Tests for MapSystem Scroll Drawing.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <MapSystem.h>
+#include <MessageId.h>
+#include <MessageMgr.h>
+#include <SpriteSystem.h>
+#include <SpriteCaptureBackend.h>
+#include <TextureId.h>
+#include <TextureMgr.h>
+#include <UpdateContext.h>
+
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// ScrollCase structure
+///////////////////////////////////////////////////////////////////////////////
+struct ScrollCase
+{
+    const char*     Name;           // 方向の名前.
+    DIRECTION_STATE Dir;            // スクロール方向.
+    const char*     NextPath;       // world.txt でこの方向に繋がっている部屋.
+    uint32_t        TotalCulled;    // スクロール中に間引かれるスプライト数の合計.
+};
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+
+// 1フレームに左右は19ピクセル，上下は11ピクセル動くので，タイルの境界がシザー矩形の辺に揃うのは
+// 最終フレームだけ. それ以外のフレームは両端に1列(1行)ずつ一部が見えるタイルが残り，
+// 2部屋 38列(22行)のうち 18列(10行)分のタイルが間引かれる.
+//   左右 : 198 x 63 + 209 = 12683, 上下 : 190 x 63 + 209 = 12179.
+// 残りはブロック. 部屋毎の位置からシザー矩形の外にいるフレーム数を数えた値.
+static const ScrollCase kCases[] = {
+    { "LEFT",  DIRECTION_LEFT,  "../res/map/room_001.map", 12683 + 51 },
+    { "RIGHT", DIRECTION_RIGHT, "../res/map/room_002.map", 12683 + 81 },
+    { "UP",    DIRECTION_UP,    "../res/map/room_003.map", 12179 + 47 },
+    { "DOWN",  DIRECTION_DOWN,  "../res/map/room_004.map", 12179 + 47 },
+};
+
+
+//-----------------------------------------------------------------------------
+//      GameApp と同じシザー矩形を設定して部屋を描画し，間引かれた数を返します.
+//-----------------------------------------------------------------------------
+uint32_t DrawMap(SpriteSystem& sprite, SpriteCaptureBackend& backend, MapSystem& system, uint32_t* pRecorded = nullptr)
+{
+    backend.Clear();
+    sprite.Begin();
+    sprite.SetCullRect(Box(kMarginX, kMarginY, kTileTotalW, kTileTotalH));
+    system.Draw(sprite, kTileTotalH / 2);
+    sprite.ResetCullRect();
+
+    auto result = sprite.GetCulledCount();
+    if (pRecorded != nullptr)
+    { *pRecorded = sprite.GetSpriteCount(); }
+
+    sprite.End();
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      1方向のスクロールを最後まで描画して，間引かれた数を確認します.
+//-----------------------------------------------------------------------------
+void TestScroll(const ScrollCase& test)
+{
+    CHECK(MessageMgr::Instance().Init(4096));
+
+    MapInstance current;
+    MapInstance next;
+    CHECK(current.Load("../res/map/room_000.map"));
+    CHECK(next   .Load(test.NextPath));
+    current.Activate();
+    next   .Activate();
+
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 1280.0f, 720.0f));
+
+    MapSystem system;
+    system.SetData(&current);
+    system.SetNext(&next);
+
+    // スクロール前は全て画面内.
+    CHECK_EQ(DrawMap(sprite, backend, system), 0u);
+
+    Box red = {};
+    UpdateContext context = {};
+    context.Map       = &system;
+    context.BoxRed    = &red;
+    context.PlayerDir = uint8_t(test.Dir);
+
+    Message msg(MESSAGE_ID_MAP_SCROLL);
+    system.OnMessage(msg);
+
+    auto frames = 0u;
+    auto total  = 0u;
+    auto last   = 0u;
+    auto mismatch = 0u;
+    for(; frames<kScrollFrame * 2; ++frames)
+    {
+        system.Update(context);
+        MessageMgr::Instance().Process();
+        if (!system.IsScroll())
+        { break; }
+
+        auto recorded = 0u;
+        last   = DrawMap(sprite, backend, system, &recorded);
+        total += last;
+
+        // 2部屋分のタイルとブロックは，記録されるか間引かれるかのどちらか.
+        if (recorded + last != (kTileTotalCount + 1) * 2)
+        { mismatch++; }
+    }
+
+    CHECK_EQ(frames, uint32_t(kScrollFrame));
+    CHECK_EQ(total, test.TotalCulled);
+    CHECK_EQ(mismatch, 0u);
+
+    // 最終フレームでは元の部屋(タイルとブロック)が丸ごと画面外.
+    CHECK_EQ(last, kTileTotalCount + 1);
+
+    // 切り替わった後は次の部屋だけを描画する.
+    CHECK_EQ(DrawMap(sprite, backend, system), 0u);
+
+    system.SetData(nullptr);
+    system.SetNext(nullptr);
+    sprite.Term();
+    next   .Dispose();
+    current.Dispose();
+    MessageMgr::Instance().Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    // ギミックがテクスチャ領域を引くので，先に登録しておく.
+    if (!TextureMgr::Instance().Load(TEXTURE_COUNT, kTextureNames))
+    { return EXIT_FAILURE; }
+
+    for(auto& test : kCases)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "MapSystem : scroll cull %s", test.Name);
+        RunTest(name, [&]{ TestScroll(test); });
+    }
+
+    TextureMgr::Instance().Term();
+    return TestResult();
+}
@@ -0,0 +1,188 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_MapWorld.cpp
+// Desc : Tests for Room Streaming.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <MapWorld.h>
+#include <TextureId.h>
+#include <TextureMgr.h>
+#include <asdxMath.h>
+#include <chrono>
+#include <string>
+#include <thread>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kGridW      = 12;
+static const uint32_t kGridH      = 10;
+static const uint32_t kBudget     = 9;
+static const uint32_t kStepCount  = 400;
+
+//-----------------------------------------------------------------------------
+//      kGridW x kGridH の格子状に部屋を繋ぎます. 部屋ファイルは res/map のものを使い回します.
+//-----------------------------------------------------------------------------
+bool BuildGrid(MapWorld& world)
+{
+    const char* kFiles[] =
+    {
+        "../res/map/room_000.map",
+        "../res/map/room_001.map",
+        "../res/map/room_002.map",
+        "../res/map/room_003.map",
+        "../res/map/room_004.map",
+    };
+
+    for(auto y=0u; y<kGridH; ++y)
+    {
+        for(auto x=0u; x<kGridW; ++x)
+        {
+            auto name = "room_" + std::to_string(x) + "_" + std::to_string(y);
+            auto id   = world.AddRoom(name.c_str(), kFiles[(x + y) % 5]);
+            if (id != y * kGridW + x)
+            { return false; }
+        }
+    }
+
+    for(auto y=0u; y<kGridH; ++y)
+    {
+        for(auto x=0u; x<kGridW; ++x)
+        {
+            auto id = y * kGridW + x;
+            if (x + 1 < kGridW && !world.Link(id, DIRECTION_RIGHT, id + 1))
+            { return false; }
+            if (y + 1 < kGridH && !world.Link(id, DIRECTION_DOWN, id + kGridW))
+            { return false; }
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      スクロール中のフレームを模して，先読みが終わるまで Update() を回します.
+//-----------------------------------------------------------------------------
+bool WaitPrefetch(MapWorld& world)
+{
+    auto limit = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while(!world.IsIdle())
+    {
+        world.Update();
+        if (std::chrono::steady_clock::now() > limit)
+        { return false; }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(250));
+    }
+
+    // 最後に読み終わった部屋の反映.
+    world.Update();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      行き先のある向きをランダムに選びます.
+//-----------------------------------------------------------------------------
+DIRECTION_STATE ChooseDirection(MapWorld& world, asdx::PCG& rng)
+{
+    DIRECTION_STATE dir;
+    do
+    { dir = DIRECTION_STATE(DIRECTION_LEFT + rng.GetAsU32() % kRoomLinkCount); }
+    while(world.GetLink(world.GetCurrentRoom(), dir) == kInvalidRoomId);
+    return dir;
+}
+
+//-----------------------------------------------------------------------------
+//      先読みを待って歩けば同期読み込みが起こらないことを確認します.
+//-----------------------------------------------------------------------------
+void TestWalk()
+{
+    MapWorld world;
+    CHECK(world.Init(kBudget));
+    CHECK(BuildGrid(world));
+    CHECK_EQ(world.GetRoomCount(), kGridW * kGridH);
+    CHECK(world.Start(kGridW * (kGridH / 2) + kGridW / 2));
+
+    asdx::PCG rng(7);
+    auto maxResident = 0u;
+    for(auto step=0u; step<kStepCount; ++step)
+    {
+        CHECK(WaitPrefetch(world));
+
+        // 隣接する部屋は全て常駐している.
+        for(auto dir=uint32_t(DIRECTION_LEFT); dir<DIRECTION_LEFT + kRoomLinkCount; ++dir)
+        {
+            auto next = world.GetLink(world.GetCurrentRoom(), DIRECTION_STATE(dir));
+            if (next != kInvalidRoomId)
+            { CHECK(world.IsResident(next)); }
+        }
+
+        auto prev = world.GetCurrentRoom();
+        auto dir  = ChooseDirection(world, rng);
+        CHECK(world.Enter(dir));
+        CHECK_EQ(world.GetCurrentRoom(), world.GetLink(prev, dir));
+        CHECK(world.GetCurrent() != nullptr);
+
+        maxResident = std::max(maxResident, world.GetResidentCount());
+        CHECK(world.GetResidentCount() <= kBudget);
+    }
+
+    CHECK_EQ(world.GetSyncLoadCount(), 0u);
+    CHECK(maxResident <= kBudget);
+    CHECK(world.GetAsyncLoadCount() > kStepCount / 2);
+    CHECK(world.GetEvictCount() > 0);
+
+    printf("  %u enters, async = %u, sync = %u, evict = %u, max resident = %u / %u\n",
+        kStepCount, world.GetAsyncLoadCount(), world.GetSyncLoadCount(),
+        world.GetEvictCount(), maxResident, kBudget);
+
+    world.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      先読みを待たずに移動すると同期読み込みとして数えることを確認します.
+//-----------------------------------------------------------------------------
+void TestWalkWithoutWait()
+{
+    MapWorld world;
+    CHECK(world.Init(kBudget));
+    CHECK(BuildGrid(world));
+    CHECK(world.Start(0));
+
+    asdx::PCG rng(11);
+    for(auto step=0u; step<50; ++step)
+    {
+        CHECK(world.Enter(ChooseDirection(world, rng)));
+        CHECK(world.GetCurrent() != nullptr);
+        CHECK(world.GetResidentCount() <= kBudget);
+    }
+
+    CHECK(world.GetSyncLoadCount() > 0);
+    world.Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    // ギミックがテクスチャ領域を引くので，先に登録しておく.
+    if (!TextureMgr::Instance().Load(TEXTURE_COUNT, kTextureNames))
+    { return EXIT_FAILURE; }
+
+    RunTest("MapWorld : walk 120 rooms",        TestWalk);
+    RunTest("MapWorld : walk without waiting",  TestWalkWithoutWait);
+
+    TextureMgr::Instance().Term();
+    return TestResult();
+}
@@ -0,0 +1,277 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_PathFinder.cpp
+// Desc : Tests for Path Finder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <PathFinder.h>
+#include <MapSystem.h>
+#include <MessageMgr.h>
+#include <TextureId.h>
+#include <TextureMgr.h>
+#include <asdxMath.h>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      タイル座標からIDを求めます.
+//-----------------------------------------------------------------------------
+uint32_t TileId(int x, int y)
+{ return CalcTileId(Vector2i(x, y)); }
+
+//-----------------------------------------------------------------------------
+//      フローフィールドに沿って目標まで辿った歩数を求めます. 辿り着けなければ -1.
+//-----------------------------------------------------------------------------
+int FollowFlow(PathFinder& finder, uint32_t start, uint32_t goal)
+{
+    auto id = start;
+    for(auto step=0; step<int(kTileTotalCount); ++step)
+    {
+        if (id == goal)
+        { return step; }
+
+        auto dir = finder.GetFlowDir(id);
+        if (dir == DIRECTION_NONE)
+        { return -1; }
+
+        auto move = GetMoveDir(dir);
+        id = uint32_t(int(id) + move.x + move.y * kTileCountX);
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+//      壁で囲った部屋を作ります. walls に列挙したタイルも塞ぎます.
+//-----------------------------------------------------------------------------
+void MakeLayer(std::vector<uint8_t>& indices, TileLayer& layer, const Tile* pPalette, const std::vector<Vector2i>& walls)
+{
+    indices.assign(kTileTotalCount, 1);
+    for(auto& wall : walls)
+    { indices[TileId(wall.x, wall.y)] = 0; }
+    layer.Init(indices.data(), pPalette, 2);
+}
+
+//-----------------------------------------------------------------------------
+//      全ての組で A* の歩数とフローフィールドの歩数が一致することを確認します.
+//-----------------------------------------------------------------------------
+void TestAStarMatchesFlow()
+{
+    Tile palette[2] = {};
+    palette[1].Moveable = true;
+
+    asdx::PCG rng(11);
+    std::vector<uint8_t> indices(kTileTotalCount);
+    for(auto& itr : indices)
+    { itr = (rng.GetAsU32() % 100) < 25 ? 0 : 1; }
+
+    TileLayer layer;
+    layer.Init(indices.data(), palette, 2);
+
+    PathFinder finder;
+    finder.SetLayer(layer);
+    finder.AddObstacle(Box(kTileOffsetX + kTileSize * 5, kTileOffsetY + kTileSize * 5, kTileSize, kTileSize));
+    CHECK(!finder.IsWalkable(TileId(5, 5)));
+
+    std::vector<uint32_t> path;
+    auto pairs    = 0u;
+    auto mismatch = 0u;
+    for(auto goal=0u; goal<kTileTotalCount; ++goal)
+    {
+        finder.SetGoal(goal);
+        for(auto start=0u; start<kTileTotalCount; ++start)
+        {
+            if (start == goal || !finder.IsWalkable(start))
+            { continue; }
+
+            pairs++;
+            auto found = finder.FindPath(start, goal, path);
+            auto dist  = finder.GetFlowDist(start);
+            if (found != (dist != kInvalidPathDist))
+            {
+                mismatch++;
+                continue;
+            }
+
+            if (found && (path.size() != dist || path.back() != goal || FollowFlow(finder, start, goal) != dist))
+            { mismatch++; }
+        }
+    }
+
+    CHECK(pairs > 10000);
+    CHECK_EQ(mismatch, 0u);
+}
+
+//-----------------------------------------------------------------------------
+//      通行不可のタイルにいる目標と，囲まれた目標を確認します.
+//-----------------------------------------------------------------------------
+void TestBlockedGoal()
+{
+    Tile palette[2] = {};
+    palette[1].Moveable = true;
+
+    // (3, 3) を囲む壁と，通行不可の (10, 5).
+    std::vector<Vector2i> walls = {
+        Vector2i(3, 2), Vector2i(2, 3), Vector2i(4, 3), Vector2i(3, 4),
+        Vector2i(10, 5),
+    };
+
+    std::vector<uint8_t> indices;
+    TileLayer layer;
+    MakeLayer(indices, layer, palette, walls);
+
+    PathFinder finder;
+    finder.SetLayer(layer);
+
+    // 目標はプレイヤーが乗っているタイルなので，通行不可でも隣までは辿り着く.
+    std::vector<uint32_t> path;
+    CHECK(!finder.IsWalkable(TileId(10, 5)));
+    CHECK(finder.FindPath(TileId(7, 5), TileId(10, 5), path));
+    CHECK_EQ(path.size(), 3u);
+
+    finder.SetGoal(TileId(10, 5));
+    CHECK_EQ(finder.GetFlowDist(TileId(7, 5)), 3u);
+    CHECK_EQ(finder.GetFlowDir (TileId(9, 5)), DIRECTION_RIGHT);
+    CHECK_EQ(finder.GetFlowDir (TileId(10, 5)), DIRECTION_NONE);
+
+    // 囲まれた目標には辿り着けない.
+    CHECK(!finder.FindPath(TileId(7, 5), TileId(3, 3), path));
+    CHECK(path.empty());
+
+    finder.SetGoal(TileId(3, 3));
+    CHECK_EQ(finder.GetFlowDist(TileId(3, 3)), 0u);
+    CHECK_EQ(finder.GetFlowDist(TileId(7, 5)), kInvalidPathDist);
+    CHECK_EQ(finder.GetFlowDir (TileId(7, 5)), DIRECTION_NONE);
+
+    // 範囲外.
+    CHECK(!finder.FindPath(kTileTotalCount, TileId(3, 3), path));
+    CHECK_EQ(finder.GetFlowDir(kTileTotalCount), DIRECTION_NONE);
+}
+
+//-----------------------------------------------------------------------------
+//      フローフィールドは引いた時だけ作り直すことを確認します.
+//-----------------------------------------------------------------------------
+void TestLazyRebuild()
+{
+    Tile palette[2] = {};
+    palette[1].Moveable = true;
+
+    std::vector<uint8_t> indices;
+    TileLayer layer;
+    MakeLayer(indices, layer, palette, {});
+
+    PathFinder finder;
+    finder.SetLayer(layer);
+
+    // 引く者がいなければ何度目標が変わっても作り直さない.
+    for(auto i=0u; i<10; ++i)
+    { finder.SetGoal(TileId(i, 1)); }
+    CHECK(finder.Update());
+    CHECK(!finder.Update());
+
+    // 同じタイルなら予約しない.
+    finder.SetGoal(TileId(9, 1));
+    CHECK(!finder.Update());
+
+    // 引いた時に作り直されるので，Update() には残らない.
+    finder.SetGoal(TileId(2, 2));
+    CHECK_EQ(finder.GetFlowDist(TileId(2, 5)), 3u);
+    CHECK(!finder.Update());
+
+    // 通行可否が変わっても同じ.
+    finder.SetLayer(layer);
+    finder.AddObstacle(Box(kTileOffsetX + kTileSize * 2, kTileOffsetY + kTileSize * 3, kTileSize, kTileSize));
+    CHECK_EQ(finder.GetFlowDist(TileId(2, 5)), 5u);
+    CHECK(!finder.Update());
+}
+
+//-----------------------------------------------------------------------------
+//      押し終わったブロックの位置で通行可否が作り直されることを確認します.
+//-----------------------------------------------------------------------------
+void TestBlockMoved()
+{
+    CHECK(MessageMgr::Instance().Init(4096));
+
+    // room_000 のブロックは (4, 5) にあり，方向の指定は無い.
+    MapInstance instance;
+    CHECK(instance.Load("../res/map/room_000.map"));
+    instance.Activate();
+
+    MapSystem system;
+    system.SetData(&instance);
+
+    auto before = TileId(4, 5);
+    auto after  = TileId(5, 5);
+    auto& path  = instance.Path;
+    CHECK(!path.IsWalkable(before));
+    CHECK( path.IsWalkable(after));
+
+    // 右端の通路を目標にすると，ブロックの右隣からは真っ直ぐ右へ向かう.
+    Box goal(CalcPosFromTile(18, 5).x, CalcPosFromTile(18, 5).y, kTileSize, kTileSize);
+    system.SetPathGoal(goal);
+    CHECK_EQ(path.GetFlowDist(after), 13u);
+
+    // ブロックの左からプレイヤーが右へ押し続ける.
+    auto pos = CalcPosFromTile(4, 5);
+    Box player(pos.x - kTileSize + 4, pos.y, kTileSize, kTileSize);
+    Box red = {};
+
+    UpdateContext context = {};
+    context.Map       = &system;
+    context.BoxRed    = &red;
+    context.PlayerDir = DIRECTION_RIGHT;
+
+    // 押し始めるまでは重なって止められる. 動き出したらプレイヤーは止まったまま.
+    CHECK(!system.CanMove(player));
+
+    auto frame = 0;
+    for(; frame<200 && path.IsWalkable(after); ++frame)
+    {
+        system.CanMove(player);
+        system.Update(context);
+        MessageMgr::Instance().Process();
+
+        // 押している途中はまだ通行可否を変えない.
+        if (path.IsWalkable(after))
+        { CHECK(!path.IsWalkable(before)); }
+    }
+
+    CHECK(frame < 200);
+    CHECK( path.IsWalkable(before));
+    CHECK(!path.IsWalkable(after));
+
+    // ブロックを避けて回り込むので，真っ直ぐ向かう14歩より増える.
+    CHECK(path.GetFlowDist(TileId(4, 5)) > 14u);
+    CHECK(path.GetFlowDist(TileId(4, 5)) != kInvalidPathDist);
+    CHECK(path.GetFlowDir(TileId(4, 5)) != DIRECTION_RIGHT);
+
+    system.SetData(nullptr);
+    instance.Dispose();
+    MessageMgr::Instance().Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    // ギミックがテクスチャ領域を引くので，先に登録しておく.
+    if (!TextureMgr::Instance().Load(TEXTURE_COUNT, kTextureNames))
+    { return EXIT_FAILURE; }
+
+    RunTest("PathFinder : A* matches flow field",   TestAStarMatchesFlow);
+    RunTest("PathFinder : blocked goal",            TestBlockedGoal);
+    RunTest("PathFinder : lazy rebuild",            TestLazyRebuild);
+    RunTest("PathFinder : block moved",             TestBlockMoved);
+
+    TextureMgr::Instance().Term();
+    return TestResult();
+}
@@ -0,0 +1,419 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SaveFormat.cpp
+// Desc : Tests for Binary Save File Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SaveFormat.h>
+#include <MapWorld.h>
+#include <MessageMgr.h>
+#include <TextureId.h>
+#include <TextureMgr.h>
+#include <gimmick/Block.h>
+#include <asdxMath.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kWorldRoomCount = 12;
+static const uint32_t kWorldBudget    = 5;
+
+//-----------------------------------------------------------------------------
+//      部屋毎の状態が一致するかどうか?
+//-----------------------------------------------------------------------------
+bool IsEqual(const std::vector<RoomState>& lhs, const std::vector<RoomState>& rhs)
+{
+    if (lhs.size() != rhs.size())
+    { return false; }
+
+    for(size_t i=0; i<lhs.size(); ++i)
+    {
+        if (lhs[i].Name != rhs[i].Name || lhs[i].Gimmicks.size() != rhs[i].Gimmicks.size())
+        { return false; }
+
+        if (!lhs[i].Gimmicks.empty()
+          && memcmp(lhs[i].Gimmicks.data(), rhs[i].Gimmicks.data(), lhs[i].Gimmicks.size() * sizeof(MapGimmickState)) != 0)
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      ギミック n 個分の変化を持つ部屋を生成します.
+//-----------------------------------------------------------------------------
+RoomState MakeRoom(const std::string& name, uint32_t n, asdx::PCG& rng)
+{
+    RoomState result;
+    result.Name = name;
+    for(auto i=0u; i<n; ++i)
+    {
+        MapGimmickState state = {};
+        state.Index = uint16_t(i * 3);
+        state.TileX = uint8_t(rng.GetAsU32() % kTileCountX);
+        state.TileY = uint8_t(rng.GetAsU32() % kTileCountY);
+        state.Flags = uint8_t(rng.GetAsU32());
+        result.Gimmicks.push_back(state);
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルサイズを取得します.
+//-----------------------------------------------------------------------------
+long GetFileSize(const char* path)
+{
+    FILE* pFile = fopen(path, "rb");
+    if (pFile == nullptr)
+    { return -1; }
+
+    fseek(pFile, 0, SEEK_END);
+    auto size = ftell(pFile);
+    fclose(pFile);
+    return size;
+}
+
+//-----------------------------------------------------------------------------
+//      メモリとファイルの往復を確認します.
+//-----------------------------------------------------------------------------
+void TestRoundTrip()
+{
+    std::vector<RoomState>  rooms;
+    std::vector<RoomState>  result;
+    std::vector<uint8_t>    buffer;
+
+    // 部屋が無ければヘッダだけ.
+    CHECK(WriteSaveData(rooms, buffer));
+    CHECK_EQ(buffer.size(), sizeof(SaveFileHeader));
+    CHECK(ReadSaveData(buffer.data(), buffer.size(), result));
+    CHECK(result.empty());
+
+    asdx::PCG rng(3);
+    for(auto i=0u; i<500; ++i)
+    { rooms.push_back(MakeRoom("room_" + std::to_string(i), rng.GetAsU32() % 5, rng)); }
+
+    CHECK(WriteSaveData(rooms, buffer));
+    CHECK(ReadSaveData(buffer.data(), buffer.size(), result));
+    CHECK(IsEqual(rooms, result));
+
+    const char* kPath = "obj/test_SaveFormat.sav";
+    CHECK(WriteSaveFile(kPath, rooms));
+    CHECK_EQ(GetFileSize(kPath), long(buffer.size()));
+    CHECK(ReadSaveFile(kPath, result));
+    CHECK(IsEqual(rooms, result));
+    remove(kPath);
+
+    CHECK(!ReadSaveFile(kPath, result));
+}
+
+//-----------------------------------------------------------------------------
+//      壊れたデータを拒否することを確認します.
+//-----------------------------------------------------------------------------
+void TestReject()
+{
+    asdx::PCG rng(5);
+    std::vector<RoomState> rooms;
+    rooms.push_back(MakeRoom("room_000", 2, rng));
+    rooms.push_back(MakeRoom("room_001", 0, rng));
+    rooms.push_back(MakeRoom("room_002", 3, rng));
+
+    std::vector<uint8_t>   buffer;
+    std::vector<RoomState> result;
+    CHECK(WriteSaveData(rooms, buffer));
+
+    // 途中で切れている.
+    auto accepted = 0u;
+    for(size_t size=0; size<buffer.size(); ++size)
+    {
+        if (ReadSaveData(buffer.data(), size, result))
+        { accepted++; }
+    }
+    CHECK_EQ(accepted, 0u);
+
+    // 後ろに余分なデータがある.
+    auto extra = buffer;
+    extra.push_back(0);
+    CHECK(!ReadSaveData(extra.data(), extra.size(), result));
+
+    // チェックサムの範囲を1ビットでも書き換えた.
+    accepted = 0;
+    for(auto i=sizeof(SaveFileHeader); i<buffer.size(); ++i)
+    {
+        for(auto bit=0; bit<8; ++bit)
+        {
+            auto copy = buffer;
+            copy[i] ^= uint8_t(1u << bit);
+            if (ReadSaveData(copy.data(), copy.size(), result))
+            { accepted++; }
+        }
+    }
+    CHECK_EQ(accepted, 0u);
+
+    // チェックサムの値が違う.
+    auto copy = buffer;
+    reinterpret_cast<SaveFileHeader*>(copy.data())->Checksum ^= 1;
+    CHECK(!ReadSaveData(copy.data(), copy.size(), result));
+
+    // 部屋数はチェックサムの範囲外なので，並びと食い違えば拒否する.
+    for(auto count : { 0u, 2u, 4u, 0xffffffffu })
+    {
+        copy = buffer;
+        reinterpret_cast<SaveFileHeader*>(copy.data())->RoomCount = count;
+        CHECK(!ReadSaveData(copy.data(), copy.size(), result));
+    }
+
+    // 失敗しても元の内容は壊れていない.
+    CHECK(ReadSaveData(buffer.data(), buffer.size(), result));
+    CHECK(IsEqual(rooms, result));
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルサイズが動かしたギミックの数に比例することを確認します.
+//-----------------------------------------------------------------------------
+void TestSize()
+{
+    asdx::PCG rng(7);
+    std::vector<uint8_t> buffer;
+
+    for(auto n : { 0u, 1u, 16u, 1000u })
+    {
+        std::vector<RoomState> rooms;
+        rooms.push_back(MakeRoom("room_000", n, rng));
+        CHECK(WriteSaveData(rooms, buffer));
+
+        auto expect = sizeof(SaveFileHeader) + sizeof(SaveRoomHeader) + rooms[0].Name.size() + n * sizeof(MapGimmickState);
+        CHECK_EQ(buffer.size(), expect);
+    }
+
+    // 1部屋1個ずつなら部屋ごとのヘッダと名前が付く.
+    std::vector<RoomState> rooms;
+    for(auto i=0u; i<100; ++i)
+    { rooms.push_back(MakeRoom("room_" + std::to_string(100 + i), 1, rng)); }
+
+    CHECK(WriteSaveData(rooms, buffer));
+    CHECK_EQ(buffer.size(), sizeof(SaveFileHeader) + 100 * (sizeof(SaveRoomHeader) + 8 + sizeof(MapGimmickState)));
+    CHECK_EQ(sizeof(MapGimmickState), 6u);
+}
+
+//-----------------------------------------------------------------------------
+//      部屋番号のギミックを検索します.
+//-----------------------------------------------------------------------------
+Block* FindBlock(MapInstance* pInstance, uint32_t index)
+{
+    for(auto& itr : pInstance->Blocks)
+    {
+        if (itr.GetDescIndex() == index)
+        { return &itr; }
+    }
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      ブロックを1タイル押し切ります. ゲームと同じく CanMove() -> Update() の順に呼びます.
+//-----------------------------------------------------------------------------
+void PushBlock(Block* pBlock, DIRECTION_STATE dir)
+{
+    auto box = pBlock->GetBox();
+    box.Pos -= GetMoveDir(dir) * 8;
+
+    Box red = box;
+    UpdateContext context = {};
+    context.BoxRed    = &red;
+    context.PlayerDir = uint8_t(dir);
+
+    for(auto frame=0; frame<200; ++frame)
+    {
+        pBlock->CanMove(box);
+        pBlock->Update(context);
+        MessageMgr::Instance().Process();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ブロックがタイルの位置にあるかどうか?
+//-----------------------------------------------------------------------------
+bool IsAt(MapInstance* pInstance, uint32_t index, int tileX, int tileY)
+{
+    auto pBlock = FindBlock(pInstance, index);
+    if (pBlock == nullptr)
+    { return false; }
+
+    auto pos = CalcPosFromTile(tileX, tileY);
+    return pBlock->GetBox().Pos.x == pos.x && pBlock->GetBox().Pos.y == pos.y;
+}
+
+//-----------------------------------------------------------------------------
+//      先読みが終わるまで Update() を回しながら移動します.
+//-----------------------------------------------------------------------------
+void Walk(MapWorld& world, DIRECTION_STATE dir, uint32_t count)
+{
+    for(auto i=0u; i<count; ++i)
+    {
+        CHECK(world.Enter(dir));
+        while(!world.IsIdle())
+        { world.Update(); }
+        world.Update();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ブロックが3つある部屋を横一列に並べます.
+//-----------------------------------------------------------------------------
+bool BuildWorld(MapWorld& world)
+{
+    if (!world.Init(kWorldBudget))
+    { return false; }
+
+    Tile tiles[kTileTotalCount] = {};
+    for(auto& itr : tiles)
+    { itr.Moveable = true; }
+
+    MapGimmickDesc gimmicks[3] = {};
+    for(auto i=0; i<3; ++i)
+    {
+        gimmicks[i].Type   = MAP_GIMMICK_BLOCK;
+        gimmicks[i].TileX  = uint8_t(3 + i * 4);
+        gimmicks[i].TileY  = uint8_t(2 + i * 3);
+        gimmicks[i].Width  = kTileSize;
+        gimmicks[i].Height = kTileSize;
+        gimmicks[i].Dir    = DIRECTION_NONE;
+    }
+
+    const char* kPath = "obj/test_SaveFormat.map";
+    if (!WriteMapFile(kPath, tiles, gimmicks, 3, true))
+    { return false; }
+
+    for(auto i=0u; i<kWorldRoomCount; ++i)
+    {
+        char name[16];
+        sprintf(name, "r%02u", i);
+        world.AddRoom(name, kPath);
+
+        if (i > 0 && !world.Link(i - 1, DIRECTION_RIGHT, i))
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      追い出した部屋を読み直しても押したブロックが戻らないことを確認します.
+//-----------------------------------------------------------------------------
+void TestWorldEvict()
+{
+    CHECK(MessageMgr::Instance().Init(4096));
+
+    MapWorld world;
+    CHECK(BuildWorld(world));
+    CHECK(world.Start(0));
+
+    // r00 のブロック1を右へ，ブロック2を上へ押す.
+    PushBlock(FindBlock(world.GetCurrent(), 1), DIRECTION_RIGHT);
+    PushBlock(FindBlock(world.GetCurrent(), 2), DIRECTION_UP);
+    CHECK(IsAt(world.GetCurrent(), 1, 8, 5));
+    CHECK(IsAt(world.GetCurrent(), 2, 11, 7));
+
+    // 右端まで歩いて r00 を追い出してから戻る.
+    Walk(world, DIRECTION_RIGHT, kWorldRoomCount - 1);
+    CHECK(!world.IsResident(0));
+    CHECK(world.GetEvictCount() > 0);
+
+    Walk(world, DIRECTION_LEFT, kWorldRoomCount - 1);
+    auto pInstance = world.GetCurrent();
+    CHECK(IsAt(pInstance, 0, 3, 2));
+    CHECK(IsAt(pInstance, 1, 8, 5));
+    CHECK(IsAt(pInstance, 2, 11, 7));
+
+    // 押した後の位置でグリッドと経路探索に載っている.
+    std::vector<Gimmick*> hits;
+    pInstance->Grid.Query(FindBlock(pInstance, 1)->GetBox(), hits);
+    CHECK_EQ(hits.size(), 1u);
+    CHECK(!pInstance->Path.IsWalkable(CalcTileId(Vector2i(8, 5))));
+    CHECK( pInstance->Path.IsWalkable(CalcTileId(Vector2i(7, 5))));
+
+    // r05 のブロックも押して，常駐中と追い出し済みの部屋を混ぜる.
+    Walk(world, DIRECTION_RIGHT, 5);
+    PushBlock(FindBlock(world.GetCurrent(), 0), DIRECTION_DOWN);
+
+    std::vector<RoomState> states;
+    world.CaptureState(states);
+    CHECK_EQ(states.size(), 2u);
+    if (states.size() == 2)
+    {
+        CHECK(states[0].Name == "r00");
+        CHECK_EQ(states[0].Gimmicks.size(), 2u);
+        CHECK(states[1].Name == "r05");
+        CHECK_EQ(states[1].Gimmicks.size(), 1u);
+    }
+
+    // 3つ押しただけなら部屋ごとのヘッダと名前とギミック分.
+    const char* kPath = "obj/test_SaveFormat_world.sav";
+    CHECK(world.SaveState(kPath));
+    CHECK_EQ(GetFileSize(kPath), long(sizeof(SaveFileHeader) + 2 * (sizeof(SaveRoomHeader) + 3) + 3 * sizeof(MapGimmickState)));
+
+    // 常駐している部屋があれば設定できない.
+    CHECK(!world.RestoreState(states));
+    world.Term();
+
+    // 別の MapWorld で読み直す.
+    MapWorld other;
+    CHECK(BuildWorld(other));
+    CHECK(other.LoadState(kPath));
+    CHECK(other.Start(5));
+    CHECK(IsAt(other.GetCurrent(), 0, 3, 3));
+
+    std::vector<RoomState> result;
+    other.CaptureState(result);
+    CHECK(IsEqual(states, result));
+
+    // 配置時に戻せば変化も消える.
+    FindBlock(other.GetCurrent(), 0)->Reset();
+    CHECK(IsAt(other.GetCurrent(), 0, 3, 2));
+    other.CaptureState(result);
+    CHECK_EQ(result.size(), 1u);
+    other.Term();
+
+    // Start() の前なら RestoreState() で直接設定できる.
+    MapWorld restored;
+    CHECK(BuildWorld(restored));
+    CHECK(restored.RestoreState(states));
+    CHECK(restored.Start(0));
+    CHECK(IsAt(restored.GetCurrent(), 1, 8, 5));
+    CHECK(IsAt(restored.GetCurrent(), 2, 11, 7));
+    restored.Term();
+
+    remove(kPath);
+    remove("obj/test_SaveFormat.map");
+    MessageMgr::Instance().Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    // ギミックがテクスチャ領域を引くので，先に登録しておく.
+    if (!TextureMgr::Instance().Load(TEXTURE_COUNT, kTextureNames))
+    { return EXIT_FAILURE; }
+
+    RunTest("SaveFormat : round trip",      TestRoundTrip);
+    RunTest("SaveFormat : reject",          TestReject);
+    RunTest("SaveFormat : size",            TestSize);
+    RunTest("SaveFormat : world evict",     TestWorldEvict);
+
+    TextureMgr::Instance().Term();
+    return TestResult();
+}
@@ -0,0 +1,234 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SpriteAnimation.cpp
+// Desc : Tests for Sprite Sheet Animation.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteAnimation.h>
+#include <TextureMgr.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      コマ毎に異なる領域を作ります.
+//-----------------------------------------------------------------------------
+TextureRegion MakeRegion(uint32_t id)
+{ return TextureRegion(FakePointer<ID3D11ShaderResourceView>(id)); }
+
+//-----------------------------------------------------------------------------
+//      テスト用のクリップを作ります.
+//      0 : loop (2, 3, 1 フレーム), 1 : once (1, 2 フレーム), 2 : 向き違い loop (2, 2 フレーム).
+//-----------------------------------------------------------------------------
+void MakeLibrary(SpriteAnimLibrary& library)
+{
+    library.AddClip("loop", true, 1);
+    for(auto i=0u; i<3; ++i)
+    {
+        auto region = MakeRegion(i);
+        library.AddFrame(i == 0 ? 2 : (i == 1 ? 3 : 1), &region);
+    }
+
+    library.AddClip("once", false, 1);
+    for(auto i=0u; i<2; ++i)
+    {
+        auto region = MakeRegion(10 + i);
+        library.AddFrame(i + 1, &region);
+    }
+
+    library.AddClip("dir", true, kSpriteAnimDirCount);
+    for(auto i=0u; i<2; ++i)
+    {
+        TextureRegion regions[kSpriteAnimDirCount];
+        for(auto d=0u; d<kSpriteAnimDirCount; ++d)
+        { regions[d] = MakeRegion(20 + i * kSpriteAnimDirCount + d); }
+        library.AddFrame(2, regions);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      経過フレームからコマ番号を引けることを確認します.
+//-----------------------------------------------------------------------------
+void TestLoop()
+{
+    SpriteAnimLibrary library;
+    MakeLibrary(library);
+    CHECK_EQ(library.GetClipCount(), 3u);
+    CHECK_EQ(library.Find("loop"), 0);
+    CHECK_EQ(library.Find("once"), 1);
+    CHECK_EQ(library.Find("none"), kInvalidSpriteAnimClip);
+    CHECK_EQ(library.GetClip(0).Length, 6u);
+
+    SpriteAnimSystem system;
+    CHECK(system.Init(&library, 4));
+
+    auto handle = system.Create(0);
+    const uint32_t expected[] = { 0, 0, 1, 1, 1, 2, 0, 0, 1, 1, 1, 2, 0 };
+    for(auto t=0u; t<13; ++t)
+    {
+        CHECK_EQ(system.GetFrame(handle), expected[t]);
+        CHECK(system.GetRegion(handle).pSRV == MakeRegion(expected[t]).pSRV);
+        CHECK(!system.IsFinished(handle));
+        system.Update();
+    }
+
+    // 複数フレームまとめて進めても同じ.
+    system.Play(handle, 0, true);
+    system.Update(6 * 100 + 3);
+    CHECK_EQ(system.GetFrame(handle), 1u);
+
+    system.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      ループしないクリップが最後のコマで止まることを確認します.
+//-----------------------------------------------------------------------------
+void TestOnce()
+{
+    SpriteAnimLibrary library;
+    MakeLibrary(library);
+
+    SpriteAnimSystem system;
+    CHECK(system.Init(&library, 4));
+
+    auto handle = system.Create(1);
+    CHECK_EQ(system.GetFrame(handle), 0u);
+    CHECK(!system.IsFinished(handle));
+
+    system.Update();
+    CHECK_EQ(system.GetFrame(handle), 1u);
+    CHECK(!system.IsFinished(handle));
+
+    system.Update();
+    CHECK_EQ(system.GetFrame(handle), 1u);
+    CHECK(system.IsFinished(handle));
+
+    system.Update(1000);
+    CHECK_EQ(system.GetFrame(handle), 1u);
+    CHECK(system.IsFinished(handle));
+
+    // 同じクリップは restart しなければ続きから.
+    system.Play(handle, 1);
+    CHECK(system.IsFinished(handle));
+    system.Play(handle, 1, true);
+    CHECK(!system.IsFinished(handle));
+    CHECK_EQ(system.GetFrame(handle), 0u);
+
+    system.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      向きと一時停止を確認します.
+//-----------------------------------------------------------------------------
+void TestDirectionAndPause()
+{
+    SpriteAnimLibrary library;
+    MakeLibrary(library);
+
+    SpriteAnimSystem system;
+    CHECK(system.Init(&library, 4));
+
+    auto handle = system.Create(2, 3);
+    CHECK(system.GetRegion(handle).pSRV == MakeRegion(23).pSRV);
+
+    system.Update(2);
+    system.SetDirection(handle, 1);
+    CHECK(system.GetRegion(handle).pSRV == MakeRegion(25).pSRV);
+
+    system.SetPaused(handle, true);
+    system.Update(3);
+    CHECK_EQ(system.GetFrame(handle), 1u);
+
+    system.SetPaused(handle, false);
+    system.Update(2);
+    CHECK_EQ(system.GetFrame(handle), 0u);
+
+    system.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      破棄したハンドルが再利用され，他の再生状態が保たれることを確認します.
+//-----------------------------------------------------------------------------
+void TestHandleReuse()
+{
+    SpriteAnimLibrary library;
+    MakeLibrary(library);
+
+    SpriteAnimSystem system;
+    CHECK(system.Init(&library, 3));
+
+    auto h0 = system.Create(0);
+    auto h1 = system.Create(1);
+    system.Update(2);
+    auto h2 = system.Create(0);
+    system.Update(1);
+
+    // 上限.
+    CHECK_EQ(system.Create(0), kInvalidSpriteAnimHandle);
+    CHECK_EQ(system.Create(99), kInvalidSpriteAnimHandle);
+
+    // 先頭を破棄すると末尾が詰められるが，ハンドルから見た状態は変わらない.
+    system.Destroy(h0);
+    CHECK_EQ(system.GetCount(), 2u);
+    CHECK_EQ(system.GetFrame(h1), 1u);
+    CHECK_EQ(system.GetFrame(h2), 0u);
+    CHECK(system.GetRegion(h0).pSRV == nullptr);
+    CHECK(system.IsFinished(h0));
+
+    // 二重に破棄しても何も起きない.
+    system.Destroy(h0);
+    CHECK_EQ(system.GetCount(), 2u);
+
+    // 空いたハンドルを再利用し，状態は初期化される.
+    auto h3 = system.Create(0);
+    CHECK_EQ(h3, h0);
+    CHECK_EQ(system.GetFrame(h3), 0u);
+    system.Update(2);
+    CHECK_EQ(system.GetFrame(h3), 1u);
+    CHECK_EQ(system.GetFrame(h2), 1u);
+    CHECK_EQ(system.GetCount(), 3u);
+
+    system.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      クリップファイルを読み込めることを確認します.
+//-----------------------------------------------------------------------------
+void TestLoadFile()
+{
+    SpriteAnimLibrary library;
+    CHECK(library.Load("../res/anim/player.anim"));
+
+    auto walk = library.Find("player_walk");
+    CHECK(walk != kInvalidSpriteAnimClip);
+    if (walk == kInvalidSpriteAnimClip)
+    { return; }
+
+    auto& clip = library.GetClip(walk);
+    CHECK(clip.Loop);
+    CHECK_EQ(clip.FrameCount, 2u);
+    CHECK_EQ(clip.DirCount,   uint8_t(kSpriteAnimDirCount));
+    CHECK_EQ(clip.Length,     8u);
+
+    TextureMgr::Instance().Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("SpriteAnimation : loop",                TestLoop);
+    RunTest("SpriteAnimation : once",                TestOnce);
+    RunTest("SpriteAnimation : direction and pause", TestDirectionAndPause);
+    RunTest("SpriteAnimation : handle reuse",        TestHandleReuse);
+    RunTest("SpriteAnimation : load file",           TestLoadFile);
+    return TestResult();
+}
@@ -0,0 +1,131 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SpriteBatch.cpp
+// Desc : Tests for SpriteBatch Radix Sort.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteBatch.h>
+#include <SpriteBackend.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      ランダムなレイヤーとテクスチャのスプライトを作ります.
+//-----------------------------------------------------------------------------
+void MakeSprites
+(
+    uint32_t                        count,
+    uint32_t                        layerCount,
+    uint32_t                        textureCount,
+    std::vector<SpriteInstance>&    instances,
+    std::vector<const void*>&       textures
+)
+{
+    asdx::PCG rng(count * 31 + layerCount);
+    instances.assign(count, SpriteInstance());
+    textures .assign(count, nullptr);
+    for(auto i=0u; i<count; ++i)
+    {
+        instances[i].Layer = uint16_t(rng.GetAsU32() % layerCount);
+        textures [i]       = FakePointer<const void>(rng.GetAsU32() % textureCount);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      std::stable_sort で求めた描画順と一致することを確認します.
+//-----------------------------------------------------------------------------
+void CheckOrder(uint32_t count, uint32_t layerCount, bool groupByTexture)
+{
+    std::vector<SpriteInstance> instances;
+    std::vector<const void*>    textures;
+    MakeSprites(count, layerCount, 13, instances, textures);
+
+    // テクスチャ番号は初出順.
+    std::unordered_map<const void*, uint32_t> ids;
+    std::vector<uint32_t> textureIds(count);
+    for(auto i=0u; i<count; ++i)
+    { textureIds[i] = ids.emplace(textures[i], uint32_t(ids.size())).first->second; }
+
+    std::vector<uint32_t> expected(count);
+    for(auto i=0u; i<count; ++i)
+    { expected[i] = i; }
+
+    std::stable_sort(expected.begin(), expected.end(), [&](uint32_t lhs, uint32_t rhs)
+    {
+        if (instances[lhs].Layer != instances[rhs].Layer)
+        { return instances[lhs].Layer > instances[rhs].Layer; }
+        return groupByTexture && textureIds[lhs] < textureIds[rhs];
+    });
+
+    SpriteBatch batch;
+    batch.Build(instances.data(), textures.data(), count, groupByTexture, kSpritePageSize);
+
+    auto mismatch = 0u;
+    for(auto i=0u; i<count; ++i)
+    {
+        auto index = batch.IsSorted() ? batch.GetOrder()[i] : i;
+        mismatch += (index != expected[i]) ? 1 : 0;
+    }
+    CHECK_EQ(mismatch, 0u);
+
+    // コマンドはレイヤー降順で，全スプライトを1回ずつ含み，ページをまたがない.
+    auto prevLayer = UINT32_MAX;
+    auto total     = 0u;
+    for(auto& cmd : batch.GetCommands())
+    {
+        CHECK(cmd.Layer <= prevLayer);
+        CHECK(cmd.Start + cmd.Count <= kSpritePageSize);
+        CHECK_EQ(cmd.Page * kSpritePageSize + cmd.Start, total);
+        prevLayer = cmd.Layer;
+        total    += cmd.Count;
+    }
+    CHECK_EQ(total, count);
+}
+
+//-----------------------------------------------------------------------------
+//      既に並んでいれば並べ替えないことを確認します.
+//-----------------------------------------------------------------------------
+void TestAlreadySorted()
+{
+    std::vector<SpriteInstance> instances(1000);
+    std::vector<const void*>    textures (1000, FakePointer<const void>(0));
+    for(auto i=0u; i<instances.size(); ++i)
+    { instances[i].Layer = uint16_t(1000 - i); }
+
+    SpriteBatch batch;
+    batch.Build(instances.data(), textures.data(), 1000, true, kSpritePageSize);
+    CHECK(!batch.IsSorted());
+    CHECK_EQ(batch.GetCommands().size(), 1000u);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("SpriteBatch : radix order", []
+    {
+        for(auto count : { 1u, 511u, 513u, 10000u, 100000u })
+        {
+            for(auto layers : { 1u, 4u, 300u, 65536u })
+            {
+                CheckOrder(count, layers, false);
+                CheckOrder(count, layers, true);
+            }
+        }
+    });
+    RunTest("SpriteBatch : already sorted", TestAlreadySorted);
+    return TestResult();
+}
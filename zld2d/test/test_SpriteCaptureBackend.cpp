@@ -0,0 +1,194 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SpriteCaptureBackend.cpp
+// Desc : Tests for Recording Sprite Render Backend.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteSystem.h>
+#include <SpriteCaptureBackend.h>
+#include <cstdio>
+#include <string>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char*    kCapturePath = "obj/test_SpriteCaptureBackend.txt";
+static const uint32_t kSpriteCount = 40;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// SceneParam structure
+///////////////////////////////////////////////////////////////////////////////
+struct SceneParam
+{
+    uintptr_t   TextureBase = 0;    // SRVのアドレス(ビルド毎に変わる値の代わり).
+    int         MoveIndex   = -1;   // 1ピクセルずらすスプライト番号.
+    int         OtherIndex  = -1;   // 3枚目のテクスチャで描画するスプライト番号.
+};
+
+//-----------------------------------------------------------------------------
+//      2種類のテクスチャを交互に使う場面を1フレーム記録します.
+//-----------------------------------------------------------------------------
+SpriteFrameCapture Capture(const SceneParam& param)
+{
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 1280.0f, 720.0f));
+
+    TextureRegion a(FakePointer<ID3D11ShaderResourceView>(param.TextureBase + 0));
+    TextureRegion b(FakePointer<ID3D11ShaderResourceView>(param.TextureBase + 1));
+    TextureRegion c(FakePointer<ID3D11ShaderResourceView>(param.TextureBase + 2));
+
+    sprite.SetSortMode(false);
+    sprite.Begin();
+    for(auto i=0u; i<kSpriteCount; ++i)
+    {
+        auto& region = (int(i) == param.OtherIndex) ? c : ((i / 4) % 2 == 0) ? a : b;
+        auto  x      = int(i * 16) + ((int(i) == param.MoveIndex) ? 1 : 0);
+        sprite.Draw(region, x, int(i % 8) * 16, 16, 16, 0);
+    }
+    sprite.End();
+
+    // 常駐バッファの命令も含めておく.
+    SpriteInstance instances[3] = {};
+    for(auto i=0; i<3; ++i)
+    { instances[i] = PackSprite(i * 8, 0, 8, 8, 0.0f, 0.0f, 1.0f, 1.0f, 0xffffffff, 1); }
+    CHECK(backend.UpdateRetained(16, instances, 3));
+    backend.DrawRetained(16, 3);
+
+    sprite.Term();
+    return backend.GetCapture();
+}
+
+//-----------------------------------------------------------------------------
+//      指定番号の命令の種類を取得します.
+//-----------------------------------------------------------------------------
+uint32_t GetOp(const SpriteFrameCapture& capture, uint32_t index)
+{ return (index < capture.Commands.size()) ? capture.Commands[index].Op : UINT32_MAX; }
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("SpriteCaptureBackend : identical frames", []
+    {
+        // SRVのアドレスが違っても出現順の番号で記録されるので同じ内容になる.
+        SceneParam p0;
+        SceneParam p1;
+        p1.TextureBase = 0x1000;
+
+        auto c0 = Capture(p0);
+        auto c1 = Capture(p1);
+        CHECK(!c0.Commands.empty());
+        CHECK_EQ(c0.FrameCount, 1u);
+        CHECK_EQ(c0.DrawCount,  c0.BindCount + 1);
+        CHECK_EQ(c0.FindMismatch(c1), UINT32_MAX);
+        CHECK(c0.Serialize() == c1.Serialize());
+    });
+
+    RunTest("SpriteCaptureBackend : serialize round trip", []
+    {
+        auto capture = Capture(SceneParam());
+        auto text    = capture.Serialize();
+
+        SpriteFrameCapture result;
+        CHECK(result.Deserialize(text));
+        CHECK_EQ(result.FindMismatch(capture), UINT32_MAX);
+        CHECK_EQ(result.Commands.size(), capture.Commands.size());
+
+        // 集計値は読み込み時に再計算される.
+        CHECK_EQ(result.FrameCount,  capture.FrameCount);
+        CHECK_EQ(result.DrawCount,   capture.DrawCount);
+        CHECK_EQ(result.BindCount,   capture.BindCount);
+        CHECK_EQ(result.UploadCount, capture.UploadCount);
+        CHECK_EQ(result.UploadBytes, capture.UploadBytes);
+        CHECK(result.Serialize() == text);
+
+        // 改行コードが CRLF でも読める.
+        std::string crlf;
+        for(auto c : text)
+        {
+            if (c == '\n')
+            { crlf += '\r'; }
+            crlf += c;
+        }
+        CHECK(result.Deserialize(crlf));
+        CHECK_EQ(result.FindMismatch(capture), UINT32_MAX);
+    });
+
+    RunTest("SpriteCaptureBackend : save and load", []
+    {
+        auto capture = Capture(SceneParam());
+        CHECK(capture.Save(kCapturePath));
+
+        SpriteFrameCapture result;
+        CHECK(result.Load(kCapturePath));
+        CHECK_EQ(result.FindMismatch(capture), UINT32_MAX);
+        CHECK(result.Serialize() == capture.Serialize());
+
+        remove(kCapturePath);
+        CHECK(!result.Load(kCapturePath));
+    });
+
+    RunTest("SpriteCaptureBackend : changed frame", []
+    {
+        auto base = Capture(SceneParam());
+
+        // 1ピクセル動かすと転送内容のハッシュが変わる.
+        SceneParam moved;
+        moved.MoveIndex = 5;
+        auto c0 = Capture(moved);
+        auto i0 = base.FindMismatch(c0);
+        CHECK(i0 != UINT32_MAX);
+        CHECK_EQ(GetOp(base, i0), uint32_t(SPRITE_CAPTURE_UPLOAD));
+        CHECK_EQ(c0.FindMismatch(base), i0);
+        CHECK(base.Serialize() != c0.Serialize());
+
+        // 保存して読み込んでも同じ位置で食い違う.
+        CHECK(c0.Save(kCapturePath));
+        SpriteFrameCapture loaded;
+        CHECK(loaded.Load(kCapturePath));
+        CHECK_EQ(base.FindMismatch(loaded), i0);
+        remove(kCapturePath);
+
+        // 転送内容が同じでもテクスチャが変われば，そのスプライトを含む描画で食い違う.
+        SceneParam other;
+        other.OtherIndex = 5;
+        auto c1 = Capture(other);
+        auto i1 = base.FindMismatch(c1);
+        CHECK(i1 != UINT32_MAX);
+        CHECK_EQ(GetOp(base, i1), uint32_t(SPRITE_CAPTURE_DRAW));
+        CHECK_EQ(c1.DrawCount, base.DrawCount + 2);
+
+        // 末尾の命令が足りない場合は短い方の長さを返す.
+        auto cut = base;
+        cut.Commands.pop_back();
+        CHECK_EQ(base.FindMismatch(cut), uint32_t(cut.Commands.size()));
+        CHECK_EQ(cut.FindMismatch(base), uint32_t(cut.Commands.size()));
+    });
+
+    RunTest("SpriteCaptureBackend : malformed text", []
+    {
+        auto text = Capture(SceneParam()).Serialize();
+
+        SpriteFrameCapture result;
+        CHECK(!result.Deserialize("sprite-capture 0\n"));
+        CHECK(!result.Deserialize(text + "jump 1 2\n"));
+        CHECK(!result.Deserialize(text + "draw 1\n"));
+        CHECK(!result.Deserialize(text + "upload x y z\n"));
+        CHECK(result.Deserialize(text + "\n# comment\n"));
+    });
+
+    return TestResult();
+}
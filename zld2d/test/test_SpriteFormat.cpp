@@ -0,0 +1,265 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SpriteFormat.cpp
+// Desc : Tests for Packed Sprite Instance Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteFormat.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const float kUVError     = 0.5f / 65535.0f + 1e-7f;  // 16bit量子化の許容誤差.
+static const float kColorError  = 0.5f / 255.0f   + 1e-6f;  // 8bit量子化の許容誤差.
+
+
+//-----------------------------------------------------------------------------
+//      [0, 1]の乱数を取得します.
+//-----------------------------------------------------------------------------
+float RandomUnorm(asdx::PCG& rng)
+{ return float(rng.GetAsU32() & 0xffffff) / float(0xffffff); }
+
+//-----------------------------------------------------------------------------
+//      量子化の境界を含む浮動小数値を取得します.
+//-----------------------------------------------------------------------------
+float RandomEdgeFloat(asdx::PCG& rng)
+{
+    const float kEdges[] = { -1.0f, -0.0f, 0.0f, 0.5f / 65535.0f, 0.5f / 255.0f, 0.5f, 1.0f, 2.0f, NAN, INFINITY, -INFINITY };
+    auto r = rng.GetAsU32() % 4;
+    if (r == 0)
+    { return kEdges[rng.GetAsU32() % (sizeof(kEdges) / sizeof(kEdges[0]))]; }
+    return RandomUnorm(rng) * 2.0f - 0.5f;
+}
+
+//-----------------------------------------------------------------------------
+//      符号付きで int16 の範囲を超える値も含む整数値を取得します.
+//-----------------------------------------------------------------------------
+int32_t RandomEdgeInt(asdx::PCG& rng)
+{
+    const int32_t kEdges[] = { INT32_MIN, -70000, -32769, -32768, -1, 0, 1, 32767, 32768, 65535, 65536, INT32_MAX };
+    auto r = rng.GetAsU32() % 4;
+    if (r == 0)
+    { return kEdges[rng.GetAsU32() % (sizeof(kEdges) / sizeof(kEdges[0]))]; }
+    return int32_t(rng.GetAsU32() % 4096) - 2048;
+}
+
+//-----------------------------------------------------------------------------
+//      ランダムなスプライト記述子を作ります.
+//-----------------------------------------------------------------------------
+void MakeDescs(asdx::PCG& rng, std::vector<SpriteDesc>& descs)
+{
+    for(auto& desc : descs)
+    {
+        desc.pSRV = nullptr;
+        for(auto i=0; i<4; ++i)
+        {
+            desc.Rect   [i] = RandomEdgeInt(rng);
+            desc.TexRect[i] = RandomEdgeFloat(rng);
+            desc.Color  [i] = RandomEdgeFloat(rng);
+        }
+        desc.Layer    = RandomEdgeInt(rng);
+        desc.Reserved = 0;
+    }
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+#if defined(TEST_SPRITE_PACK_AVX2)
+    if (!__builtin_cpu_supports("avx2"))
+    {
+        printf("[ SKIP ] SpriteFormat : AVX2 is not supported on this CPU.\n");
+        return TestResult();
+    }
+#endif
+
+    RunTest("SpriteFormat : corners", []
+    {
+        auto sprite = PackSprite(10, 20, 30, 40, 0.25f, 0.5f, 0.75f, 1.0f, PackColor(1.0f, 0.0f, 0.0f, 1.0f), 3);
+
+        SpriteVertex v[4];
+        ExpandSprite(sprite, v);
+
+        // 0:左上, 1:右上, 2:左下, 3:右下. V は SpriteInstVS.hlsl と同じく上下反転.
+        CHECK(v[0].Position[0] == 10.0f && v[0].Position[1] == 20.0f);
+        CHECK(v[1].Position[0] == 40.0f && v[1].Position[1] == 20.0f);
+        CHECK(v[2].Position[0] == 10.0f && v[2].Position[1] == 60.0f);
+        CHECK(v[3].Position[0] == 40.0f && v[3].Position[1] == 60.0f);
+        CHECK(std::fabs(v[0].TexCoord[0] - 0.25f) <= kUVError && v[0].TexCoord[1] == 1.0f);
+        CHECK(std::fabs(v[3].TexCoord[0] - 0.75f) <= kUVError);
+        CHECK(std::fabs(v[3].TexCoord[1] - 0.5f)  <= kUVError);
+
+        for(auto i=0; i<4; ++i)
+        {
+            CHECK(v[i].Color[0] == 1.0f && v[i].Color[1] == 0.0f);
+            CHECK(v[i].Color[2] == 0.0f && v[i].Color[3] == 1.0f);
+            CHECK(v[i].TexCoord[2] == 0.0f);
+        }
+    });
+
+    RunTest("SpriteFormat : uv quantization", []
+    {
+        asdx::PCG rng(12345);
+        auto maxError = 0.0f;
+        for(auto i=0; i<100000; ++i)
+        {
+            float uv[4] = { RandomUnorm(rng), RandomUnorm(rng), RandomUnorm(rng), RandomUnorm(rng) };
+            auto sprite = PackSprite(0, 0, 1, 1, uv[0], uv[1], uv[2], uv[3], 0, 0);
+
+            SpriteVertex v[4];
+            ExpandSprite(sprite, v);
+            maxError = std::max(maxError, std::fabs(v[0].TexCoord[0] - uv[0]));
+            maxError = std::max(maxError, std::fabs(v[2].TexCoord[1] - uv[1]));
+            maxError = std::max(maxError, std::fabs(v[1].TexCoord[0] - uv[2]));
+            maxError = std::max(maxError, std::fabs(v[0].TexCoord[1] - uv[3]));
+        }
+        CHECK(maxError <= kUVError);
+
+        // 範囲外とNaNは[0, 1]に丸める.
+        auto sprite = PackSprite(0, 0, 1, 1, -0.5f, NAN, 1.5f, 1.0f, 0, 0);
+        CHECK_EQ(sprite.TexRect[0], 0);
+        CHECK_EQ(sprite.TexRect[1], 0);
+        CHECK_EQ(sprite.TexRect[2], 65535);
+        CHECK_EQ(sprite.TexRect[3], 65535);
+    });
+
+    RunTest("SpriteFormat : color quantization", []
+    {
+        asdx::PCG rng(678);
+        auto maxError = 0.0f;
+        for(auto i=0; i<10000; ++i)
+        {
+            float c[4] = { RandomUnorm(rng), RandomUnorm(rng), RandomUnorm(rng), RandomUnorm(rng) };
+            float result[4];
+            UnpackColor(PackColor(c[0], c[1], c[2], c[3]), result);
+            for(auto j=0; j<4; ++j)
+            { maxError = std::max(maxError, std::fabs(result[j] - c[j])); }
+        }
+        CHECK(maxError <= kColorError);
+        CHECK_EQ(PackColor(-1.0f, 2.0f, 0.0f, 1.0f), 0xff00ff00u);
+    });
+
+    RunTest("SpriteFormat : rect clamp", []
+    {
+        auto sprite = PackSprite(40000, -40000, 70000, -1, 0.0f, 0.0f, 1.0f, 1.0f, 0, 0);
+        CHECK_EQ(sprite.Rect[0], INT16_MAX);
+        CHECK_EQ(sprite.Rect[1], INT16_MIN);
+        CHECK_EQ(sprite.Rect[2], INT16_MAX);
+        CHECK_EQ(sprite.Rect[3], -1);
+
+        // 範囲内の値はそのまま.
+        sprite = PackSprite(-32768, 32767, 0, 1234, 0.0f, 0.0f, 1.0f, 1.0f, 0, 0);
+        SpriteVertex v[4];
+        ExpandSprite(sprite, v);
+        CHECK(v[0].Position[0] == -32768.0f);
+        CHECK(v[0].Position[1] ==  32767.0f);
+        CHECK(v[3].Position[0] == -32768.0f);
+        CHECK(v[3].Position[1] ==  32767.0f + 1234.0f);
+    });
+
+    RunTest("SpriteFormat : layer to depth", []
+    {
+        const int kLayers[]   = { -5, 0, 1, 255, 256, 65535, 70000 };
+        const int kExpected[] = {  0, 0, 1, 255, 256, 65535, 65535 };
+
+        auto prevDepth = -1.0f;
+        for(auto i=0u; i<sizeof(kLayers) / sizeof(kLayers[0]); ++i)
+        {
+            auto sprite = PackSprite(0, 0, 1, 1, 0.0f, 0.0f, 1.0f, 1.0f, 0, kLayers[i]);
+            CHECK_EQ(sprite.Layer, kExpected[i]);
+
+            SpriteVertex v[4];
+            ExpandSprite(sprite, v);
+            for(auto j=0; j<4; ++j)
+            { CHECK(v[j].Position[2] == float(kExpected[i])); }
+
+            // シェーダと同じ変換で深度にしたとき，並びが逆転しないこと.
+            auto depth = std::min(v[0].Position[2] * kSpriteLayerScale, 1.0f);
+            CHECK(depth >= prevDepth);
+            prevDepth = depth;
+        }
+        CHECK(256.0f * kSpriteLayerScale == 1.0f);
+    });
+
+    RunTest("SpriteFormat : PackSprites matches scalar", []
+    {
+        // 8 の倍数でない個数と，先頭をずらした入出力で SIMD 版の端数処理を通す.
+        asdx::PCG rng(2024);
+        std::vector<SpriteDesc>     descs   (80);
+        std::vector<SpriteInstance> expected(80);
+        std::vector<SpriteInstance> actual  (80);
+
+        for(auto trial=0; trial<64; ++trial)
+        {
+            MakeDescs(rng, descs);
+            for(auto offset=0u; offset<3; ++offset)
+            {
+                for(auto count=0u; count + offset<=descs.size(); ++count)
+                {
+                    memset(expected.data(), 0xcd, expected.size() * sizeof(SpriteInstance));
+                    memset(actual  .data(), 0xcd, actual  .size() * sizeof(SpriteInstance));
+
+                    PackSpritesScalar(descs.data() + offset, count, expected.data() + offset);
+                    PackSprites      (descs.data() + offset, count, actual  .data() + offset);
+
+                    // 範囲外の領域に書き込まないことも含めて比較する.
+                    auto same = memcmp(expected.data(), actual.data(), expected.size() * sizeof(SpriteInstance)) == 0;
+                    CHECK(same);
+                    if (!same)
+                    {
+                        fprintf(stderr, "  trial = %d, offset = %u, count = %u\n", trial, offset, count);
+                        return;
+                    }
+                }
+            }
+        }
+    });
+
+    RunTest("SpriteFormat : PackSprites clamps", []
+    {
+        SpriteDesc desc;
+        SetSpriteDesc(desc, TextureRegion(nullptr, -1.0f, NAN, 2.0f, 1.0f), -40000, 40000, -1, 70000, -3);
+        desc.Color[0] = -1.0f;
+        desc.Color[1] = NAN;
+        desc.Color[2] = 2.0f;
+        desc.Color[3] = 0.5f;
+
+        // 全経路(AVX2 の8個単位，SSE2 の4個単位，端数)で同じ結果になること.
+        std::vector<SpriteDesc>     descs(15, desc);
+        std::vector<SpriteInstance> result(15);
+        PackSprites(descs.data(), uint32_t(descs.size()), result.data());
+        for(auto& sprite : result)
+        {
+            CHECK_EQ(sprite.Rect[0], INT16_MIN);
+            CHECK_EQ(sprite.Rect[1], INT16_MAX);
+            CHECK_EQ(sprite.Rect[2], -1);
+            CHECK_EQ(sprite.Rect[3], INT16_MAX);
+            CHECK_EQ(sprite.TexRect[0], 0);
+            CHECK_EQ(sprite.TexRect[1], 0);
+            CHECK_EQ(sprite.TexRect[2], 65535);
+            CHECK_EQ(sprite.TexRect[3], 65535);
+            CHECK_EQ(sprite.Color, 0x80ff0000u);
+            CHECK_EQ(sprite.Layer, 0);
+            CHECK_EQ(sprite.Reserved, 0);
+        }
+    });
+
+    return TestResult();
+}
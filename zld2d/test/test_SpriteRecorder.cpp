@@ -0,0 +1,106 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SpriteRecorder.cpp
+// Desc : Tests for Multi-Threaded Sprite Recording.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteSystem.h>
+#include <SpriteCaptureBackend.h>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kSpriteCount = 20000;
+
+//-----------------------------------------------------------------------------
+//      i 番目のスプライトを記録します. SpriteSystem と SpriteRecorder の両方で使います.
+//-----------------------------------------------------------------------------
+template<typename T>
+void DrawSprite(T& target, uint32_t i)
+{
+    TextureRegion region(FakePointer<ID3D11ShaderResourceView>(i % 7));
+    target.SetColor(1.0f, 1.0f, 1.0f, float(i % 4) / 3.0f);
+    target.Draw(region, int(i % 1280), int((i / 1280) % 720), 16, 16, int((i * 7) % 5));
+}
+
+//-----------------------------------------------------------------------------
+//      [begin, end) のスプライトを記録します.
+//-----------------------------------------------------------------------------
+void Record(SpriteRecorder& recorder, uint32_t begin, uint32_t end)
+{
+    for(auto i=begin; i<end; ++i)
+    { DrawSprite(recorder, i); }
+}
+
+//-----------------------------------------------------------------------------
+//      1スレッドで直接描画した結果と，複数スレッドで記録して提出した結果を比較します.
+//-----------------------------------------------------------------------------
+void TestSerialEqualsThreaded(bool sort, uint32_t threadCount)
+{
+    SpriteCaptureBackend serialBackend;
+    SpriteSystem serial;
+    CHECK(serial.Init(&serialBackend, 1280.0f, 720.0f));
+    serial.SetSortMode(sort);
+
+    serial.Begin();
+    for(auto i=0u; i<kSpriteCount; ++i)
+    { DrawSprite(serial, i); }
+    serial.End();
+
+    SpriteCaptureBackend threadedBackend;
+    SpriteSystem threaded;
+    CHECK(threaded.Init(&threadedBackend, 1280.0f, 720.0f));
+    threaded.SetSortMode(sort);
+
+    // 割り切れない分割も試すため，スレッド数で等分しない.
+    std::vector<SpriteRecorder> recorders(threadCount);
+    std::vector<std::thread>    threads;
+    for(auto t=0u; t<threadCount; ++t)
+    {
+        auto begin = uint32_t(uint64_t(kSpriteCount) * t       / threadCount);
+        auto end   = uint32_t(uint64_t(kSpriteCount) * (t + 1) / threadCount);
+        threads.emplace_back(Record, std::ref(recorders[t]), begin, end);
+    }
+    for(auto& thread : threads)
+    { thread.join(); }
+
+    threaded.Begin();
+    for(auto& recorder : recorders)
+    { threaded.Submit(recorder); }
+    threaded.End();
+
+    auto& expected = serialBackend  .GetCapture();
+    auto& actual   = threadedBackend.GetCapture();
+    CHECK_EQ(threaded.GetSpriteCount(), kSpriteCount);
+    CHECK_EQ(actual.DrawCount,   expected.DrawCount);
+    CHECK_EQ(actual.UploadBytes, expected.UploadBytes);
+    CHECK_EQ(actual.FindMismatch(expected), UINT32_MAX);
+
+    serial  .Term();
+    threaded.Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("SpriteRecorder : serial == 1 thread",             []{ TestSerialEqualsThreaded(false, 1); });
+    RunTest("SpriteRecorder : serial == 3 threads",            []{ TestSerialEqualsThreaded(false, 3); });
+    RunTest("SpriteRecorder : serial == 8 threads",            []{ TestSerialEqualsThreaded(false, 8); });
+    RunTest("SpriteRecorder : serial == 3 threads (sorted)",   []{ TestSerialEqualsThreaded(true,  3); });
+    RunTest("SpriteRecorder : serial == 8 threads (sorted)",   []{ TestSerialEqualsThreaded(true,  8); });
+    return TestResult();
+}
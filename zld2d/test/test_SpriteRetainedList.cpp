@@ -0,0 +1,207 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SpriteRetainedList.cpp
+// Desc : Tests for Retained Sprite Uploads.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteSystem.h>
+#include <SpriteRetainedList.h>
+#include <SpriteCaptureBackend.h>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kSpriteCount   = 100;
+static const uint64_t kInstanceBytes = sizeof(SpriteInstance);
+
+//-----------------------------------------------------------------------------
+//      同じテクスチャ・同じレイヤーのスプライトを生成します. 描画順はハンドル順になります.
+//-----------------------------------------------------------------------------
+void CreateSprites(SpriteRetainedList& list, std::vector<SpriteHandle>& handles)
+{
+    TextureRegion region(FakePointer<ID3D11ShaderResourceView>(0));
+    for(auto i=0u; i<kSpriteCount; ++i)
+    { handles.push_back(list.Create(region, int(i), 0, 16, 16, 0, asdx::Vector4(1.0f, 1.0f, 1.0f, 1.0f))); }
+}
+
+//-----------------------------------------------------------------------------
+//      キャプチャから常駐バッファの転送を取り出します.
+//-----------------------------------------------------------------------------
+std::vector<SpriteCaptureCommand> CollectRetainedUploads(const SpriteFrameCapture& capture)
+{
+    std::vector<SpriteCaptureCommand> result;
+    for(auto& cmd : capture.Commands)
+    {
+        if (cmd.Op == SPRITE_CAPTURE_RETAINED_UPLOAD)
+        { result.push_back(cmd); }
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      隙間が4以下の転送範囲がまとまることを確認します.
+//-----------------------------------------------------------------------------
+void TestMergeGap()
+{
+    SpriteRetainedList list;
+    CHECK(list.Init(kSpriteCount));
+
+    std::vector<SpriteHandle> handles;
+    CreateSprites(list, handles);
+    list.Flush();
+    list.ClearDirty();
+
+    // 10 と 14 は隙間3, 14 と 20 は隙間5, 20 と 25 は隙間4.
+    list.SetPosition(handles[10], 0, 1);
+    list.SetPosition(handles[14], 0, 1);
+    list.SetPosition(handles[20], 0, 1);
+    list.SetPosition(handles[25], 0, 1);
+    CHECK(!list.IsLayoutDirty());
+
+    std::vector<SpriteDirtyRange> ranges;
+    list.GetDirtyRanges(ranges);
+    CHECK_EQ(ranges.size(), 2u);
+    if (ranges.size() == 2)
+    {
+        CHECK_EQ(ranges[0].Start, 10u); CHECK_EQ(ranges[0].Count, 5u);
+        CHECK_EQ(ranges[1].Start, 20u); CHECK_EQ(ranges[1].Count, 6u);
+    }
+
+    // 値が変わらなければ転送しない.
+    list.ClearDirty();
+    list.SetPosition(handles[10], 0, 1);
+    list.GetDirtyRanges(ranges);
+    CHECK(ranges.empty());
+}
+
+//-----------------------------------------------------------------------------
+//      並び順が変わる変更で全体を転送し直すことを確認します.
+//-----------------------------------------------------------------------------
+void TestLayoutChange()
+{
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+
+    SpriteRetainedList list;
+    CHECK(list.Init(kSpriteCount));
+
+    std::vector<SpriteHandle> handles;
+    CreateSprites(list, handles);
+
+    // 描画するたびに常駐バッファの転送だけを取り出す.
+    auto frame = [&]()
+    {
+        backend.Clear();
+        sprite.Begin();
+        sprite.DrawRetained(list);
+        sprite.End();
+        return CollectRetainedUploads(backend.GetCapture());
+    };
+
+    // 初回は全体.
+    auto uploads = frame();
+    CHECK_EQ(uploads.size(), 1u);
+    if (!uploads.empty())
+    { CHECK_EQ(uploads[0].Arg1, kSpriteCount); }
+
+    // 変更が無ければ転送しない.
+    uploads = frame();
+    CHECK(uploads.empty());
+    CHECK_EQ(sprite.GetUploadedBytes(), 0u);
+
+    // 位置だけなら1つ分.
+    list.SetPosition(handles[50], 7, 7);
+    uploads = frame();
+    CHECK_EQ(uploads.size(), 1u);
+    if (!uploads.empty())
+    { CHECK_EQ(uploads[0].Arg1, 1u); }
+
+    // 非表示にすると並びが詰まるので全体.
+    list.SetVisible(handles[3], false);
+    CHECK(list.IsLayoutDirty());
+    uploads = frame();
+    CHECK_EQ(uploads.size(), 1u);
+    if (!uploads.empty())
+    { CHECK_EQ(uploads[0].Arg1, kSpriteCount - 1); }
+    CHECK_EQ(sprite.GetUploadedBytes(), (kSpriteCount - 1) * kInstanceBytes);
+
+    // テクスチャが変わると描画コマンドの区切りが変わるので全体.
+    list.SetTexture(handles[60], TextureRegion(FakePointer<ID3D11ShaderResourceView>(1)));
+    CHECK(list.IsLayoutDirty());
+    uploads = frame();
+    CHECK_EQ(uploads.size(), 1u);
+    if (!uploads.empty())
+    { CHECK_EQ(uploads[0].Arg1, kSpriteCount - 1); }
+
+    sprite.ReleaseRetained(list);
+    sprite.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      SPRITE_STAT_UPLOAD_BYTES が実際の転送量と一致することを確認します.
+//-----------------------------------------------------------------------------
+void TestUploadStats()
+{
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+    sprite.SetStatsEnabled(true);
+
+    SpriteRetainedList list;
+    CHECK(list.Init(kSpriteCount));
+
+    std::vector<SpriteHandle> handles;
+    CreateSprites(list, handles);
+
+    TextureRegion region(FakePointer<ID3D11ShaderResourceView>(2));
+
+    const uint32_t kFrameCount = 4;
+    uint64_t total = 0;
+    for(auto f=0u; f<kFrameCount; ++f)
+    {
+        if (f == 2)
+        { list.SetColor(handles[5], 1.0f, 0.0f, 0.0f, 1.0f); }
+
+        sprite.Begin();
+        for(auto i=0u; i<10; ++i)
+        { sprite.Draw(region, int(i), 0, 8, 8, 1); }
+        sprite.DrawRetained(list);
+        sprite.End();
+        sprite.FlushStats();
+
+        auto& last = sprite.GetStats().GetLast();
+        CHECK_EQ(last.Values[SPRITE_STAT_UPLOAD_BYTES], sprite.GetUploadedBytes());
+        total += last.Values[SPRITE_STAT_UPLOAD_BYTES];
+    }
+
+    // 即時スプライトは毎フレーム全て，常駐スプライトは初回の全体と変更した1つ.
+    auto expected = (10 * kFrameCount + kSpriteCount + 1) * kInstanceBytes;
+    CHECK_EQ(total, expected);
+    CHECK_EQ(backend.GetCapture().UploadBytes, expected);
+
+    sprite.ReleaseRetained(list);
+    sprite.Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("SpriteRetainedList : merge gap",       TestMergeGap);
+    RunTest("SpriteRetainedList : layout change",   TestLayoutChange);
+    RunTest("SpriteRetainedList : upload stats",    TestUploadStats);
+    return TestResult();
+}
@@ -0,0 +1,327 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SpriteSoftwareBackend.cpp
+// Desc : Tests for Software Sprite Backend.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteSystem.h>
+#include <SpriteSoftwareBackend.h>
+#include <asdxMath.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kRed   = 0xff0000ff;
+static const uint32_t kGreen = 0xff00ff00;
+static const uint32_t kBlack = 0xff000000;
+static const uint32_t kSceneW       = 320;
+static const uint32_t kSceneH       = 200;
+static const uint32_t kSceneSprites = 600;
+static const char*    kTGAPath      = "obj/test_SpriteSoftwareBackend.tga";
+
+
+//-----------------------------------------------------------------------------
+//      RGBA8 の1チャンネルを取り出します.
+//-----------------------------------------------------------------------------
+inline int Channel(uint32_t color, int index)
+{ return int((color >> (index * 8)) & 0xff); }
+
+//-----------------------------------------------------------------------------
+//      α付きのテクスチャを登録します.
+//-----------------------------------------------------------------------------
+void RegisterSceneTextures(SpriteSoftwareBackend& backend)
+{
+    // 8x8 の市松模様. 半分は半透明.
+    uint32_t checker[8 * 8];
+    for(auto i=0u; i<8 * 8; ++i)
+    { checker[i] = (((i % 8) + (i / 8)) % 2 == 0) ? 0xff2080ff : 0x80ff4010; }
+
+    // 16x16 のグラデーション. 線形補間で中間色が出る.
+    uint32_t gradient[16 * 16];
+    for(auto y=0u; y<16; ++y)
+    {
+        for(auto x=0u; x<16; ++x)
+        { gradient[y * 16 + x] = (uint32_t(x * 17) << 24) | (uint32_t(y * 17) << 8) | (x * 17); }
+    }
+
+    CHECK(backend.RegisterTexture(FakePointer<ID3D11ShaderResourceView>(0), 8,  8,  8  * 4, checker));
+    CHECK(backend.RegisterTexture(FakePointer<ID3D11ShaderResourceView>(1), 16, 16, 16 * 4, gradient));
+    CHECK(backend.RegisterTexture(FakePointer<ID3D11ShaderResourceView>(2), 1,  1,  4, &kGreen));
+}
+
+//-----------------------------------------------------------------------------
+//      画面外にはみ出すものを含むランダムな場面を描画します.
+//-----------------------------------------------------------------------------
+void DrawScene(SpriteSystem& sprite, uint32_t seed)
+{
+    asdx::PCG rng(seed);
+    std::vector<SpriteDesc> descs(kSceneSprites);
+    for(auto& desc : descs)
+    {
+        auto id = rng.GetAsU32() % 4;   // 3 はテクスチャ無し.
+        auto w  = int(1 + rng.GetAsU32() % 96);
+        auto h  = int(1 + rng.GetAsU32() % 96);
+        auto x  = int(rng.GetAsU32() % (kSceneW + 64)) - 32;
+        auto y  = int(rng.GetAsU32() % (kSceneH + 64)) - 32;
+
+        TextureRegion region(
+            (id < 3) ? FakePointer<ID3D11ShaderResourceView>(id) : nullptr,
+            float(rng.GetAsU32() % 64) / 256.0f,
+            float(rng.GetAsU32() % 64) / 256.0f,
+            1.0f - float(rng.GetAsU32() % 64) / 256.0f,
+            1.0f - float(rng.GetAsU32() % 64) / 256.0f);
+        SetSpriteDesc(desc, region, x, y, w, h, int(rng.GetAsU32() % 16));
+
+        for(auto& c : desc.Color)
+        { c = float(rng.GetAsU32() % 256) / 255.0f; }
+    }
+    sprite.DrawBatch(descs.data(), uint32_t(descs.size()));
+}
+
+//-----------------------------------------------------------------------------
+//      指定スレッド数で場面を描画した結果を返します.
+//-----------------------------------------------------------------------------
+std::vector<uint32_t> RenderScene(uint32_t threadCount, uint32_t seed, uint64_t& shaded)
+{
+    SpriteSoftwareBackend backend;
+    CHECK(backend.Init(kSceneW, kSceneH, threadCount));
+    RegisterSceneTextures(backend);
+
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, float(kSceneW), float(kSceneH)));
+    sprite.SetSortMode(true);
+
+    backend.Clear(0.1f, 0.2f, 0.3f, 1.0f);
+    sprite.Begin();
+    DrawScene(sprite, seed);
+    sprite.End();
+
+    // シザー矩形を掛けて2回目.
+    backend.SetScissor(37, 21, 150, 101);
+    sprite.Begin();
+    DrawScene(sprite, seed + 1);
+    sprite.End();
+    backend.ResetScissor();
+
+    std::vector<uint32_t> result(backend.GetPixels(), backend.GetPixels() + kSceneW * kSceneH);
+    shaded = backend.GetShadedPixelCount();
+
+    sprite.Term();
+    backend.Term();
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      深度 1.0 を超えるレイヤーも GPU と同じく丸めて描画することを確認します.
+//-----------------------------------------------------------------------------
+void TestLayerClamp()
+{
+    auto pRed   = FakePointer<ID3D11ShaderResourceView>(0);
+    auto pGreen = FakePointer<ID3D11ShaderResourceView>(1);
+
+    SpriteSoftwareBackend backend;
+    CHECK(backend.Init(64, 64, 1));
+    CHECK(backend.RegisterTexture(pRed,   1, 1, 4, &kRed));
+    CHECK(backend.RegisterTexture(pGreen, 1, 1, 4, &kGreen));
+
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 64.0f, 64.0f));
+    sprite.SetSortMode(true);
+
+    backend.Clear(0.0f, 0.0f, 0.0f, 1.0f);
+    sprite.Begin();
+    sprite.Draw(TextureRegion(pGreen),  0, 0, 32, 32, 10);     // 手前.
+    sprite.Draw(TextureRegion(pRed),    0, 0, 32, 32, 1000);   // 深度 1.0 を超える奥.
+    sprite.Draw(TextureRegion(pRed),   32, 0, 32, 32, 65535);  // 最奥.
+    sprite.End();
+
+    auto pixels = backend.GetPixels();
+    CHECK_EQ(pixels[ 8 * 64 +  8], kGreen); // 手前が上に描かれる.
+    CHECK_EQ(pixels[ 8 * 64 + 40], kRed);   // 破棄されない.
+    CHECK_EQ(pixels[40 * 64 +  8], kBlack);
+
+    sprite.Term();
+    backend.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      スレッド数を変えても同じ画像になることを確認します.
+//-----------------------------------------------------------------------------
+void TestThreadGolden()
+{
+    for(auto seed=1u; seed<=3; ++seed)
+    {
+        uint64_t goldenShaded = 0;
+        auto golden = RenderScene(1, seed, goldenShaded);
+        CHECK(goldenShaded > 0);
+
+        for(auto threadCount : { 2u, 3u, 4u, 8u, 0u })
+        {
+            uint64_t shaded = 0;
+            auto pixels = RenderScene(threadCount, seed, shaded);
+
+            auto mismatch = 0u;
+            for(auto i=0u; i<kSceneW * kSceneH; ++i)
+            {
+                if (pixels[i] != golden[i])
+                { mismatch++; }
+            }
+            CHECK_EQ(mismatch, 0u);
+            CHECK_EQ(shaded, goldenShaded);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      画面切り替えの合成が SwitchPS.hlsl の式と一致することを確認します.
+//-----------------------------------------------------------------------------
+void TestApplySwitch()
+{
+    const uint32_t kW = 64;
+    const uint32_t kH = 32;
+
+    SpriteSoftwareBackend backend;
+    CHECK(backend.Init(kW, kH, 1));
+
+    // フェード : 全ピクセルが同じα(0.25)で合成される.
+    // dst = (0.2, 0.4, 0.6, 1.0), src = (1.0, 0.0, 0.0, 0.25)
+    //   → (0.4, 0.3, 0.45, 0.8125) * 255 = (102, 76.5, 114.75, 207.19).
+    backend.Clear(0.2f, 0.4f, 0.6f, 1.0f);
+    backend.ApplySwitch(asdx::Vector4(1.0f, 0.0f, 0.0f, 0.25f), asdx::Vector2(0.5f, 0.5f), 0.0f);
+
+    const uint32_t kFade = 0xcf734c66;
+    auto mismatch = 0u;
+    for(auto i=0u; i<kW * kH; ++i)
+    {
+        if (backend.GetPixels()[i] != kFade)
+        { mismatch++; }
+    }
+    CHECK_EQ(mismatch, 0u);
+
+    // 穴あき : 中心からの距離(UV空間)が radius - 0.1 未満なら元のまま，radius 以上なら塗りつぶし.
+    const float kRadius = 0.3f;
+    const asdx::Vector2 kCenter(0.25f, 0.5f);
+
+    backend.Clear(0.0f, 0.0f, 1.0f, 1.0f);
+    backend.ApplySwitch(asdx::Vector4(0.0f, 0.0f, 0.0f, 1.0f), kCenter, kRadius);
+
+    auto inside  = 0u;
+    auto outside = 0u;
+    auto ring    = 0u;
+    mismatch = 0;
+    for(auto y=0u; y<kH; ++y)
+    {
+        for(auto x=0u; x<kW; ++x)
+        {
+            auto dx = kCenter.x - (float(x) + 0.5f) / float(kW);
+            auto dy = kCenter.y - (float(y) + 0.5f) / float(kH);
+            auto d  = std::sqrt(dx * dx + dy * dy);
+            auto t  = asdx::Saturate((d - (kRadius - 0.1f)) / 0.1f);
+            auto a  = t * t * (3.0f - 2.0f * t);
+
+            // 青(0, 0, 1, 1) に黒(0, 0, 0, a) を a で合成 → 青 = 1 - a, α = a * a + (1 - a).
+            auto pixel = backend.GetPixels()[y * kW + x];
+            auto blue  = std::lround((1.0f - a) * 255.0f);
+            auto alpha = std::lround((a * a + 1.0f - a) * 255.0f);
+            if (Channel(pixel, 0) != 0 || Channel(pixel, 1) != 0
+             || std::abs(Channel(pixel, 2) - blue)  > 1
+             || std::abs(Channel(pixel, 3) - alpha) > 1)
+            { mismatch++; }
+
+            if (a == 0.0f)      { inside++;  CHECK_EQ(pixel, 0xffff0000u); }
+            else if (a == 1.0f) { outside++; CHECK_EQ(pixel, 0xff000000u); }
+            else                { ring++; }
+        }
+    }
+    CHECK_EQ(mismatch, 0u);
+    CHECK(inside  > 0);
+    CHECK(outside > 0);
+    CHECK(ring    > 0);
+
+    backend.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      TGA に保存した内容を読み戻して一致することを確認します.
+//-----------------------------------------------------------------------------
+void TestSaveTGA()
+{
+    SpriteSoftwareBackend backend;
+    CHECK(backend.Init(kSceneW, kSceneH, 1));
+    RegisterSceneTextures(backend);
+
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, float(kSceneW), float(kSceneH)));
+    sprite.SetSortMode(true);
+    backend.Clear(0.1f, 0.2f, 0.3f, 1.0f);
+    sprite.Begin();
+    DrawScene(sprite, 7);
+    sprite.End();
+    CHECK(backend.SaveTGA(kTGAPath));
+
+    std::vector<uint8_t> file;
+    auto pFile = fopen(kTGAPath, "rb");
+    CHECK(pFile != nullptr);
+    if (pFile != nullptr)
+    {
+        uint8_t buffer[4096];
+        size_t  size = 0;
+        while((size = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+        { file.insert(file.end(), buffer, buffer + size); }
+        fclose(pFile);
+    }
+    remove(kTGAPath);
+
+    // 無圧縮32bit, 左上原点のヘッダー + BGRA.
+    CHECK_EQ(file.size(), size_t(18 + kSceneW * kSceneH * 4));
+    if (file.size() != size_t(18 + kSceneW * kSceneH * 4))
+    { return; }
+
+    CHECK_EQ(file[ 2], 2);
+    CHECK_EQ(uint32_t(file[12] | (file[13] << 8)), kSceneW);
+    CHECK_EQ(uint32_t(file[14] | (file[15] << 8)), kSceneH);
+    CHECK_EQ(file[16], 32);
+    CHECK_EQ(file[17], 0x28);
+
+    auto mismatch = 0u;
+    for(auto i=0u; i<kSceneW * kSceneH; ++i)
+    {
+        auto p = &file[18 + i * 4];
+        auto c = uint32_t(p[2]) | (uint32_t(p[1]) << 8) | (uint32_t(p[0]) << 16) | (uint32_t(p[3]) << 24);
+        if (c != backend.GetPixels()[i])
+        { mismatch++; }
+    }
+    CHECK_EQ(mismatch, 0u);
+
+    // 書き込めないパスは失敗する.
+    CHECK(!backend.SaveTGA("obj/no_such_dir/out.tga"));
+
+    sprite.Term();
+    backend.Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("SpriteSoftwareBackend : layer clamp",   TestLayerClamp);
+    RunTest("SpriteSoftwareBackend : thread golden", TestThreadGolden);
+    RunTest("SpriteSoftwareBackend : apply switch",  TestApplySwitch);
+    RunTest("SpriteSoftwareBackend : save tga",      TestSaveTGA);
+    return TestResult();
+}
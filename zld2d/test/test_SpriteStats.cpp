@@ -0,0 +1,294 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SpriteStats.cpp
+// Desc : Tests for Sprite Pipeline Statistics.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteSystem.h>
+#include <SpriteCaptureBackend.h>
+#include <SpriteRetainedList.h>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      直前のフレームの値を取得します.
+//-----------------------------------------------------------------------------
+uint64_t GetLast(const SpriteSystem& sprite, SPRITE_STAT stat)
+{ return sprite.GetStats().GetLast().Values[stat]; }
+
+//-----------------------------------------------------------------------------
+//      1つの値だけを持つフレームを作ります.
+//-----------------------------------------------------------------------------
+SpriteFrameStats MakeFrame(SPRITE_STAT stat, uint64_t value)
+{
+    SpriteFrameStats result;
+    result.Values[stat] = value;
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      履歴の巡回と最小・平均・最大を確認します.
+//-----------------------------------------------------------------------------
+void TestHistory()
+{
+    SpriteStats stats;
+    CHECK_EQ(stats.GetFrameCount(), 0u);
+
+    auto empty = stats.GetSummary(SPRITE_STAT_DRAW_CALLS);
+    CHECK_EQ(empty.Min, 0u);
+    CHECK_EQ(empty.Max, 0u);
+    CHECK_EQ(empty.Avg, 0.0);
+
+    // 10, 20, 30.
+    for(auto i=1u; i<=3; ++i)
+    { stats.Push(MakeFrame(SPRITE_STAT_DRAW_CALLS, i * 10)); }
+
+    auto summary = stats.GetSummary(SPRITE_STAT_DRAW_CALLS);
+    CHECK_EQ(stats.GetFrameCount(), 3u);
+    CHECK_EQ(summary.Last, 30u);
+    CHECK_EQ(summary.Min,  10u);
+    CHECK_EQ(summary.Max,  30u);
+    CHECK_EQ(summary.Avg,  20.0);
+    CHECK_EQ(stats.GetHistory(SPRITE_STAT_DRAW_CALLS, 0), 10u);
+    CHECK_EQ(stats.GetHistory(SPRITE_STAT_DRAW_CALLS, 2), 30u);
+
+    // 1..(履歴数 + 50) を積むと古い50フレームは外れる.
+    stats.Reset();
+    CHECK_EQ(stats.GetFrameCount(), 0u);
+
+    const uint32_t kTotal = kSpriteStatsHistory + 50;
+    for(auto i=1u; i<=kTotal; ++i)
+    { stats.Push(MakeFrame(SPRITE_STAT_UPLOAD_BYTES, i)); }
+
+    summary = stats.GetSummary(SPRITE_STAT_UPLOAD_BYTES);
+    CHECK_EQ(stats.GetFrameCount(), kSpriteStatsHistory);
+    CHECK_EQ(summary.Last, uint64_t(kTotal));
+    CHECK_EQ(summary.Min,  51u);
+    CHECK_EQ(summary.Max,  uint64_t(kTotal));
+    CHECK(std::fabs(summary.Avg - (51.0 + kTotal) * 0.5) < 1e-9);
+
+    auto ordered = 0u;
+    for(auto i=0u; i<kSpriteStatsHistory; ++i)
+    {
+        if (stats.GetHistory(SPRITE_STAT_UPLOAD_BYTES, i) == 51u + i)
+        { ordered++; }
+    }
+    CHECK_EQ(ordered, kSpriteStatsHistory);
+
+    // 他の項目は0のまま.
+    summary = stats.GetSummary(SPRITE_STAT_DRAW_CALLS);
+    CHECK_EQ(summary.Max, 0u);
+
+    CHECK(strcmp(SpriteStats::GetName(SPRITE_STAT_DRAW_CALLS), "draw calls") == 0);
+    CHECK(strcmp(SpriteStats::GetName(SPRITE_STAT_COUNT), "unknown") == 0);
+}
+
+//-----------------------------------------------------------------------------
+//      ドローコール・SRV切り替え・状態切り替え・転送量を確認します.
+//-----------------------------------------------------------------------------
+void TestCounters()
+{
+    TextureRegion a(FakePointer<ID3D11ShaderResourceView>(0));
+    TextureRegion b(FakePointer<ID3D11ShaderResourceView>(1));
+
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+    sprite.SetSortMode(false);
+    sprite.SetStatsEnabled(true);
+    CHECK(sprite.IsStatsEnabled());
+
+    // A,A,B,B,A → 3回のドローコールと3回のSRV切り替え.
+    backend.Clear();
+    sprite.Begin();
+    sprite.Draw(a,  0, 0, 16, 16, 0);
+    sprite.Draw(a, 16, 0, 16, 16, 0);
+    sprite.Draw(b, 32, 0, 16, 16, 0);
+    sprite.Draw(b, 48, 0, 16, 16, 0);
+    sprite.Draw(a, 64, 0, 16, 16, 0);
+    sprite.End();
+    sprite.FlushStats();
+
+    auto& capture = backend.GetCapture();
+    CHECK_EQ(sprite.GetStats().GetFrameCount(), 1u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_SUBMITTED),        5u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_DROPPED),          0u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_DRAW_CALLS),       3u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_TEXTURE_SWITCHES), 3u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_STATE_CHANGES),    1u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_UPLOAD_BYTES),     5u * sizeof(SpriteInstance));
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_DRAW_CALLS),       uint64_t(capture.DrawCount));
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_TEXTURE_SWITCHES), uint64_t(capture.BindCount));
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_UPLOAD_BYTES),     capture.UploadBytes);
+
+    // 常駐スプライトを挟むと，インスタンスバッファの切り替えが2回増える.
+    // レイヤー 10(A) → 常駐 5(B) → 0(A) の順に描かれる.
+    SpriteRetainedList list;
+    CHECK(list.Init(4));
+    list.Create(b, 0, 32, 16, 16, 5, asdx::Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+
+    sprite.SetSortMode(true);
+    backend.Clear();
+    sprite.Begin();
+    sprite.Draw(a,  0, 0, 16, 16, 10);
+    sprite.Draw(a, 16, 0, 16, 16, 0);
+    sprite.DrawRetained(list);
+    sprite.End();
+    sprite.FlushStats();
+
+    CHECK_EQ(sprite.GetStats().GetFrameCount(), 2u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_SUBMITTED),        3u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_DRAW_CALLS),       3u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_TEXTURE_SWITCHES), 3u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_STATE_CHANGES),    3u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_UPLOAD_BYTES),     3u * sizeof(SpriteInstance));
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_UPLOAD_BYTES),     capture.UploadBytes);
+
+    // 変更が無ければ常駐スプライトは転送しない.
+    backend.Clear();
+    sprite.Begin();
+    sprite.Draw(a,  0, 0, 16, 16, 10);
+    sprite.Draw(a, 16, 0, 16, 16, 0);
+    sprite.DrawRetained(list);
+    sprite.End();
+    sprite.FlushStats();
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_UPLOAD_BYTES), 2u * sizeof(SpriteInstance));
+
+    // カリングされた数.
+    sprite.SetSortMode(false);
+    sprite.Begin();
+    sprite.SetCullRect(Box(0, 0, 100, 100));
+    sprite.Draw(a,   0,   0, 16, 16, 0);
+    sprite.Draw(a, 200,   0, 16, 16, 0);
+    sprite.Draw(a,   0, 200, 16, 16, 0);
+    sprite.ResetCullRect();
+    sprite.End();
+    sprite.FlushStats();
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_SUBMITTED), 1u);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_CULLED),    2u);
+
+    sprite.ReleaseRetained(list);
+    list.Term();
+    sprite.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      上限を超えて破棄された数を確認します.
+//-----------------------------------------------------------------------------
+void TestDropped()
+{
+    TextureRegion a(FakePointer<ID3D11ShaderResourceView>(0));
+
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+    sprite.SetSortMode(false);
+    sprite.SetStatsEnabled(true);
+
+    const uint32_t kOver = 37;
+    sprite.Begin();
+    for(auto i=0u; i<kSpriteMaxCount + kOver; ++i)
+    { sprite.Draw(a, int(i % 256), 0, 1, 1, 0); }
+    sprite.End();
+    sprite.FlushStats();
+
+    CHECK_EQ(sprite.GetDroppedCount(), kOver);
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_SUBMITTED),    uint64_t(kSpriteMaxCount));
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_DROPPED),      uint64_t(kOver));
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_UPLOAD_BYTES), uint64_t(kSpriteMaxCount) * sizeof(SpriteInstance));
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_DRAW_CALLS),   uint64_t(backend.GetCapture().DrawCount));
+
+    // 次のフレームでは0に戻る.
+    sprite.Begin();
+    sprite.Draw(a, 0, 0, 1, 1, 0);
+    sprite.End();
+    sprite.FlushStats();
+    CHECK_EQ(GetLast(sprite, SPRITE_STAT_DROPPED), 0u);
+
+    auto summary = sprite.GetStats().GetSummary(SPRITE_STAT_DROPPED);
+    CHECK_EQ(summary.Min, 0u);
+    CHECK_EQ(summary.Max, uint64_t(kOver));
+
+    sprite.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      FlushStats() までの End() の合計が1フレームになることを確認します.
+//-----------------------------------------------------------------------------
+void TestFlush()
+{
+    TextureRegion a(FakePointer<ID3D11ShaderResourceView>(0));
+
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+
+    // 無効時は何も積まない.
+    CHECK(!sprite.IsStatsEnabled());
+    sprite.Begin();
+    sprite.Draw(a, 0, 0, 16, 16, 0);
+    sprite.End();
+    sprite.FlushStats();
+    CHECK_EQ(sprite.GetStats().GetFrameCount(), 0u);
+
+    // フレーム f では f+1 個のスプライトを2回の End() に分けて描く.
+    sprite.SetStatsEnabled(true);
+    const uint32_t kFrames = 10;
+    for(auto f=0u; f<kFrames; ++f)
+    {
+        for(auto pass=0u; pass<2; ++pass)
+        {
+            sprite.Begin();
+            for(auto i=0u; i<f + 1; ++i)
+            { sprite.Draw(a, int(i), 0, 16, 16, 0); }
+            sprite.End();
+        }
+        sprite.FlushStats();
+    }
+
+    auto& stats = sprite.GetStats();
+    CHECK_EQ(stats.GetFrameCount(), kFrames);
+    for(auto f=0u; f<kFrames; ++f)
+    {
+        CHECK_EQ(stats.GetHistory(SPRITE_STAT_SUBMITTED,  f), uint64_t(2 * (f + 1)));
+        CHECK_EQ(stats.GetHistory(SPRITE_STAT_DRAW_CALLS, f), 2u);
+    }
+
+    auto summary = stats.GetSummary(SPRITE_STAT_SUBMITTED);
+    CHECK_EQ(summary.Last, uint64_t(2 * kFrames));
+    CHECK_EQ(summary.Min,  2u);
+    CHECK_EQ(summary.Max,  uint64_t(2 * kFrames));
+    CHECK_EQ(summary.Avg,  double(kFrames + 1));
+
+    summary = stats.GetSummary(SPRITE_STAT_UPLOAD_BYTES);
+    CHECK_EQ(summary.Min, 2u * sizeof(SpriteInstance));
+    CHECK_EQ(summary.Max, uint64_t(2 * kFrames) * sizeof(SpriteInstance));
+
+    // 時間は End() 毎の差分なので，桁外れの値(負の差分の折り返し)にはならない.
+    CHECK(stats.GetSummary(SPRITE_STAT_RECORD_TIME).Max < 1000000u);
+    CHECK(stats.GetSummary(SPRITE_STAT_SUBMIT_TIME).Max < 1000000u);
+
+    sprite.Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("SpriteStats : history",  TestHistory);
+    RunTest("SpriteStats : counters", TestCounters);
+    RunTest("SpriteStats : dropped",  TestDropped);
+    RunTest("SpriteStats : flush",    TestFlush);
+    return TestResult();
+}
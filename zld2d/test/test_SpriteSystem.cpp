@@ -0,0 +1,269 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_SpriteSystem.cpp
+// Desc : Tests for SpriteSystem Batching.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <SpriteSystem.h>
+#include <SpriteCaptureBackend.h>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      キャプチャから指定した種類の命令を取り出します.
+//-----------------------------------------------------------------------------
+std::vector<SpriteCaptureCommand> Collect(const SpriteFrameCapture& capture, SPRITE_CAPTURE_OP op)
+{
+    std::vector<SpriteCaptureCommand> result;
+    for(auto& cmd : capture.Commands)
+    {
+        if (cmd.Op == op)
+        { result.push_back(cmd); }
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      A,A,A,B,B,A を同じレイヤーに描画します. X座標に記録順を入れておきます.
+//-----------------------------------------------------------------------------
+void DrawRuns(SpriteSystem& sprite)
+{
+    TextureRegion a(FakePointer<ID3D11ShaderResourceView>(0));
+    TextureRegion b(FakePointer<ID3D11ShaderResourceView>(1));
+
+    const TextureRegion* order[] = { &a, &a, &a, &b, &b, &a };
+    for(auto i=0; i<6; ++i)
+    { sprite.Draw(*order[i], i, 0, 16, 16, 0); }
+}
+
+//-----------------------------------------------------------------------------
+//      ソート無しでは連続する同じテクスチャだけがまとまることを確認します.
+//-----------------------------------------------------------------------------
+void TestMergeUnsorted()
+{
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+
+    sprite.SetSortMode(false);
+    sprite.Begin();
+    DrawRuns(sprite);
+    sprite.End();
+
+    auto& capture = backend.GetCapture();
+    auto  draws   = Collect(capture, SPRITE_CAPTURE_DRAW);
+    auto  binds   = Collect(capture, SPRITE_CAPTURE_TEXTURE);
+
+    // A(3), B(2), A(1) の3回.
+    CHECK_EQ(sprite.GetDrawCallCount(), 3u);
+    CHECK_EQ(capture.DrawCount, 3u);
+    CHECK_EQ(draws.size(), 3u);
+    CHECK_EQ(binds.size(), 3u);
+    if (draws.size() == 3 && binds.size() == 3)
+    {
+        CHECK_EQ(draws[0].Arg0, 0u); CHECK_EQ(draws[0].Arg1, 3u);
+        CHECK_EQ(draws[1].Arg0, 3u); CHECK_EQ(draws[1].Arg1, 2u);
+        CHECK_EQ(draws[2].Arg0, 5u); CHECK_EQ(draws[2].Arg1, 1u);
+
+        CHECK_EQ(binds[0].Arg0, 0u);
+        CHECK_EQ(binds[1].Arg0, 1u);
+        CHECK_EQ(binds[2].Arg0, 0u);
+    }
+
+    // 記録順のまま転送される.
+    CHECK_EQ(backend.GetPageCount(), 6u);
+    for(auto i=0u; i<backend.GetPageCount(); ++i)
+    { CHECK_EQ(backend.GetPage()[i].Rect[0], int(i)); }
+
+    sprite.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      ソート有りでは同じレイヤーの同じテクスチャが1回にまとまることを確認します.
+//-----------------------------------------------------------------------------
+void TestMergeSorted()
+{
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+
+    sprite.SetSortMode(true);
+    sprite.Begin();
+    DrawRuns(sprite);
+    sprite.End();
+
+    auto& capture = backend.GetCapture();
+    auto  draws   = Collect(capture, SPRITE_CAPTURE_DRAW);
+    auto  binds   = Collect(capture, SPRITE_CAPTURE_TEXTURE);
+
+    // A(4), B(2) の2回. 初出順なので A が先.
+    CHECK_EQ(sprite.GetDrawCallCount(), 2u);
+    CHECK_EQ(draws.size(), 2u);
+    CHECK_EQ(binds.size(), 2u);
+    if (draws.size() == 2 && binds.size() == 2)
+    {
+        CHECK_EQ(draws[0].Arg0, 0u); CHECK_EQ(draws[0].Arg1, 4u);
+        CHECK_EQ(draws[1].Arg0, 4u); CHECK_EQ(draws[1].Arg1, 2u);
+        CHECK_EQ(binds[0].Arg0, 0u);
+        CHECK_EQ(binds[1].Arg0, 1u);
+    }
+
+    // 同じテクスチャの中では記録順を保つ.
+    const int expected[] = { 0, 1, 2, 5, 3, 4 };
+    CHECK_EQ(backend.GetPageCount(), 6u);
+    for(auto i=0u; i<backend.GetPageCount() && i<6; ++i)
+    { CHECK_EQ(backend.GetPage()[i].Rect[0], expected[i]); }
+
+    sprite.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      レイヤーをまたぐテクスチャはまとめず，奥から手前の順に描くことを確認します.
+//-----------------------------------------------------------------------------
+void TestLayerOrder()
+{
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+
+    TextureRegion a(FakePointer<ID3D11ShaderResourceView>(0));
+    TextureRegion b(FakePointer<ID3D11ShaderResourceView>(1));
+
+    sprite.SetSortMode(true);
+    sprite.Begin();
+    sprite.Draw(a, 0, 0, 16, 16, 1);    // 手前.
+    sprite.Draw(b, 1, 0, 16, 16, 5);    // 奥.
+    sprite.Draw(a, 2, 0, 16, 16, 5);    // 奥.
+    sprite.Draw(b, 3, 0, 16, 16, 1);    // 手前.
+    sprite.Draw(a, 4, 0, 16, 16, 5);    // 奥.
+    sprite.End();
+
+    // レイヤー5 : A(2), B(1). レイヤー1 : A(1), B(1). テクスチャは初出順.
+    auto draws = Collect(backend.GetCapture(), SPRITE_CAPTURE_DRAW);
+    CHECK_EQ(sprite.GetDrawCallCount(), 4u);
+    CHECK_EQ(draws.size(), 4u);
+
+    const int expected[] = { 2, 4, 1, 0, 3 };
+    CHECK_EQ(backend.GetPageCount(), 5u);
+    for(auto i=0u; i<backend.GetPageCount() && i<5; ++i)
+    { CHECK_EQ(backend.GetPage()[i].Rect[0], expected[i]); }
+
+    // 奥のレイヤーが先.
+    for(auto i=1u; i<backend.GetPageCount(); ++i)
+    { CHECK(backend.GetPage()[i - 1].Layer >= backend.GetPage()[i].Layer); }
+
+    sprite.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      ページをまたぐ区間は分割されることを確認します.
+//-----------------------------------------------------------------------------
+void TestPageSplit()
+{
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+
+    TextureRegion a(FakePointer<ID3D11ShaderResourceView>(0));
+
+    const auto count = kSpritePageSize + 10;
+    sprite.SetSortMode(true);
+    sprite.Begin();
+    for(auto i=0u; i<count; ++i)
+    { sprite.Draw(a, 0, 0, 16, 16, 0); }
+    sprite.End();
+
+    // テクスチャは1回だけ設定し，ページごとに描画する.
+    auto& capture = backend.GetCapture();
+    CHECK_EQ(capture.DrawCount,   2u);
+    CHECK_EQ(capture.BindCount,   1u);
+    CHECK_EQ(capture.UploadCount, 2u);
+    CHECK_EQ(capture.UploadBytes, uint64_t(sizeof(SpriteInstance) * count));
+    CHECK_EQ(sprite.GetUploadedBytes(), uint64_t(sizeof(SpriteInstance) * count));
+
+    sprite.Term();
+}
+
+//-----------------------------------------------------------------------------
+//      カリング矩形の外側だけが数えられて記録されないことを確認します.
+//-----------------------------------------------------------------------------
+void TestCull()
+{
+    SpriteCaptureBackend backend;
+    SpriteSystem sprite;
+    CHECK(sprite.Init(&backend, 320.0f, 240.0f));
+
+    TextureRegion a(FakePointer<ID3D11ShaderResourceView>(0));
+
+    // 辺が接するだけの矩形は外側. 1ピクセルでも重なれば内側.
+    const int kRects[][4] = {
+        { -16,  50, 16, 16 },   // 左に接する.
+        { 100,  50, 16, 16 },   // 右に接する.
+        {  50, -16, 16, 16 },   // 上に接する.
+        {  50, 100, 16, 16 },   // 下に接する.
+        { -15,  50, 16, 16 },   // 左に1ピクセル掛かる.
+        {  99,  99, 16, 16 },   // 右下に1ピクセル掛かる.
+        { -50, -50, 200, 200 }, // 全体を覆う.
+    };
+    const uint32_t kCulled = 4;
+    const uint32_t kCount  = sizeof(kRects) / sizeof(kRects[0]);
+
+    std::vector<SpriteDesc> descs(kCount);
+    std::vector<SpriteInstance> instances(kCount);
+    std::vector<ID3D11ShaderResourceView*> textures(kCount, a.pSRV);
+    for(auto i=0u; i<kCount; ++i)
+    {
+        SetSpriteDesc(descs[i], a, kRects[i][0], kRects[i][1], kRects[i][2], kRects[i][3], 0);
+        instances[i] = PackSprite(kRects[i][0] - 7, kRects[i][1] + 3, kRects[i][2], kRects[i][3], 0.0f, 0.0f, 1.0f, 1.0f, 0xffffffff, 0);
+    }
+
+    sprite.Begin();
+    sprite.SetCullRect(Box(0, 0, 100, 100));
+
+    for(auto i=0u; i<kCount; ++i)
+    { sprite.Draw(a, kRects[i][0], kRects[i][1], kRects[i][2], kRects[i][3], 0); }
+    CHECK_EQ(sprite.GetCulledCount(), kCulled);
+
+    sprite.DrawBatch(descs.data(), kCount);
+    CHECK_EQ(sprite.GetCulledCount(), kCulled * 2);
+
+    // 平行移動後の位置で判定する.
+    sprite.DrawInstances(instances.data(), textures.data(), kCount, 7, -3, 0);
+    CHECK_EQ(sprite.GetCulledCount(), kCulled * 3);
+
+    // 解除すると全て記録される.
+    sprite.ResetCullRect();
+    sprite.Draw(a, kRects[0][0], kRects[0][1], kRects[0][2], kRects[0][3], 0);
+    CHECK_EQ(sprite.GetCulledCount(), kCulled * 3);
+    CHECK_EQ(sprite.GetSpriteCount(), (kCount - kCulled) * 3 + 1);
+    sprite.End();
+
+    // 数は Begin() で戻る.
+    sprite.Begin();
+    CHECK_EQ(sprite.GetCulledCount(), 0u);
+    sprite.End();
+
+    sprite.Term();
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("SpriteSystem : merge unsorted runs", TestMergeUnsorted);
+    RunTest("SpriteSystem : merge sorted runs",   TestMergeSorted);
+    RunTest("SpriteSystem : layer order",         TestLayerOrder);
+    RunTest("SpriteSystem : page split",          TestPageSplit);
+    RunTest("SpriteSystem : cull rect",           TestCull);
+    return TestResult();
+}
@@ -0,0 +1,218 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_TextLayout.cpp
+// Desc : Tests for Text Layout and Kinsoku.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <TextLayout.h>
+#include <string>
+
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// FixedMetrics structure
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      全角 32 ピクセル，半角 16 ピクセルの送り幅です.
+///////////////////////////////////////////////////////////////////////////////
+struct FixedMetrics : public ITextMetrics
+{
+    uint64_t CallCount = 0;
+
+    int32_t GetAdvance(uint32_t code) override
+    {
+        CallCount++;
+        return (code >= 0x2E80) ? 32 : 16;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ExpectedLine structure
+///////////////////////////////////////////////////////////////////////////////
+struct ExpectedLine
+{
+    const wchar_t*  Text;
+    int32_t         Width;
+};
+
+//-----------------------------------------------------------------------------
+//      レイアウト結果が期待した行と一致することを確認します.
+//-----------------------------------------------------------------------------
+template<size_t N>
+void CheckLayout(const wchar_t* text, int32_t width, const ExpectedLine (&expected)[N])
+{
+    FixedMetrics      metrics;
+    TextLayoutCache   cache;
+    TextLayoutResult  result;
+    TextLayoutBox     box = { width, 0 };
+
+    CHECK(cache.Get(&metrics, text, 0, box, result));
+    CHECK_EQ(result.LineCount, N);
+    if (result.LineCount != N)
+    { return; }
+
+    for(auto i=0u; i<N; ++i)
+    {
+        auto& line = result.pLines[i];
+        auto  str  = std::wstring(text + line.Offset, line.Length);
+        if (str != expected[i].Text)
+        {
+            fprintf(stderr, "line %u mismatch : \"%ls\" != \"%ls\"\n", i, str.c_str(), expected[i].Text);
+            ++TestFailCount();
+        }
+        CHECK_EQ(line.Width, expected[i].Width);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      句読点のぶら下げを確認します.
+//-----------------------------------------------------------------------------
+void TestHanging()
+{
+    // 1文字だけぶら下げる.
+    const ExpectedLine kOne[] = { { L"あいうえお。", 192 }, { L"かきくけこ", 160 } };
+    CheckLayout(L"あいうえお。かきくけこ", 160, kOne);
+
+    // 2文字目はぶら下げず，行頭禁則で前の文字ごと追い出す.
+    const ExpectedLine kTwo[] = { { L"あいうえ", 128 }, { L"お、。かき", 160 } };
+    CheckLayout(L"あいうえお、。かき", 160, kTwo);
+
+    // 句読点だけが続いても1行が箱の幅を大きく超えない.
+    const ExpectedLine kRun[] = { { L"。。", 64 }, { L"。。", 64 }, { L"。。", 64 }, { L"。。", 64 } };
+    CheckLayout(L"。。。。。。。。", 64, kRun);
+}
+
+//-----------------------------------------------------------------------------
+//      句読点が連続しても，ぶら下げは1行に1文字までであることを確認します.
+//-----------------------------------------------------------------------------
+void TestHangingLimit()
+{
+    const wchar_t* kTexts[] =
+    {
+        L"。。。。。。。。。。。。。。。。",
+        L"あ、、、、、、、、、、、、",
+        L"ab,,,,,,,,,,,,,,,,,,cd",
+        L"あいう．。、，。あいう。。。。",
+    };
+
+    for(auto text : kTexts)
+    {
+        for(auto width : { 32, 64, 96, 160 })
+        {
+            FixedMetrics     metrics;
+            TextLayoutCache  cache;
+            TextLayoutResult result;
+            TextLayoutBox    box = { width, 0 };
+            CHECK(cache.Get(&metrics, text, 0, box, result));
+
+            for(auto i=0u; i<result.LineCount; ++i)
+            {
+                auto& line = result.pLines[i];
+                CHECK(line.Width <= width + 32);
+
+                // 箱からはみ出すのは行末の1文字だけ.
+                int32_t x = 0;
+                auto outside = 0u;
+                for(auto j=0u; j<line.Length; ++j)
+                {
+                    x += metrics.GetAdvance(text[line.Offset + j]);
+                    outside += (x > width) ? 1 : 0;
+                }
+                CHECK(outside <= 1);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      行頭禁則・行末禁則を確認します.
+//-----------------------------------------------------------------------------
+void TestKinsoku()
+{
+    // 行頭禁則の小書き文字は前の文字ごと追い出す.
+    const ExpectedLine kNoStart[] = { { L"あいうえ", 128 }, { L"おっかき", 128 } };
+    CheckLayout(L"あいうえおっかき", 160, kNoStart);
+
+    // 行末禁則の開き括弧は次の行へ送る.
+    const ExpectedLine kNoEnd[] = { { L"あいうえ", 128 }, { L"「かきくけ", 160 } };
+    CheckLayout(L"あいうえ「かきくけ", 160, kNoEnd);
+
+    // 閉じ括弧も行頭に置かない.
+    const ExpectedLine kClose[] = { { L"あいう", 96 }, { L"え」かき", 128 } };
+    CheckLayout(L"あいうえ」かき", 128, kClose);
+}
+
+//-----------------------------------------------------------------------------
+//      欧文の折り返しと強制改行を確認します.
+//-----------------------------------------------------------------------------
+void TestLatin()
+{
+    const ExpectedLine kWords[] = { { L"hello", 80 }, { L"world foo", 144 }, { L"bar", 48 } };
+    CheckLayout(L"hello world foo bar", 160, kWords);
+
+    const ExpectedLine kNewLine[] = { { L"abc", 48 }, { L"def", 48 } };
+    CheckLayout(L"abc\ndef", 160, kNewLine);
+}
+
+//-----------------------------------------------------------------------------
+//      最大行数・UTF-8・キャッシュを確認します.
+//-----------------------------------------------------------------------------
+void TestCache()
+{
+    FixedMetrics     metrics;
+    TextLayoutCache  cache;
+    TextLayoutResult result;
+
+    // 最大行数を超えた分は切り捨てる.
+    TextLayoutBox limited = { 160, 2 };
+    CHECK(cache.Get(&metrics, L"あいうえおかきくけこさしすせそたち", 0, limited, result));
+    CHECK_EQ(result.LineCount, 2u);
+    CHECK(result.Truncated);
+
+    // UTF-8 はバイト単位の位置を返す.
+    TextLayoutBox box = { 160, 0 };
+    CHECK(cache.Get(&metrics, u8"あいうえおかきくけこ", 0, box, result));
+    CHECK_EQ(result.LineCount, 2u);
+    if (result.LineCount == 2)
+    {
+        CHECK_EQ(result.pLines[0].Length, 15u);
+        CHECK_EQ(result.pLines[1].Offset, 15u);
+    }
+
+    // 同じテキストと箱は計測し直さない.
+    const wchar_t* text = L"あいうえお。かきくけこ";
+    CHECK(cache.Get(&metrics, text, 0, box, result));
+    auto calls = metrics.CallCount;
+    auto hits  = cache.GetHitCount();
+    CHECK(cache.Get(&metrics, text, 0, box, result));
+    CHECK_EQ(metrics.CallCount, calls);
+    CHECK_EQ(cache.GetHitCount(), hits + 1);
+
+    // 箱が変われば別の結果.
+    TextLayoutBox wide = { 1000, 0 };
+    CHECK(cache.Get(&metrics, text, 0, wide, result));
+    CHECK_EQ(result.LineCount, 1u);
+
+    cache.Clear();
+    CHECK_EQ(cache.GetEntryCount(), 0u);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("TextLayout : hanging",         TestHanging);
+    RunTest("TextLayout : hanging limit",   TestHangingLimit);
+    RunTest("TextLayout : kinsoku",         TestKinsoku);
+    RunTest("TextLayout : latin",           TestLatin);
+    RunTest("TextLayout : cache",           TestCache);
+    return TestResult();
+}
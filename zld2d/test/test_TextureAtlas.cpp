@@ -0,0 +1,285 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_TextureAtlas.cpp
+// Desc : Tests for Texture Atlas Builder.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <TextureAtlas.h>
+#include <asdxMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kPadding = 2;
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Image structure
+///////////////////////////////////////////////////////////////////////////////
+struct Image
+{
+    uint32_t                Width;
+    uint32_t                Height;
+    std::vector<uint8_t>    Pixels;
+};
+
+//-----------------------------------------------------------------------------
+//      画像番号と位置が分かるピクセルで埋めた画像を作ります.
+//-----------------------------------------------------------------------------
+Image MakeImage(uint32_t id, uint32_t w, uint32_t h)
+{
+    Image result;
+    result.Width  = w;
+    result.Height = h;
+    result.Pixels.resize(w * h * 4);
+    for(auto y=0u; y<h; ++y)
+    {
+        for(auto x=0u; x<w; ++x)
+        {
+            auto p = &result.Pixels[(y * w + x) * 4];
+            p[0] = uint8_t(id);
+            p[1] = uint8_t(x);
+            p[2] = uint8_t(y);
+            p[3] = uint8_t(0x80 | (id >> 8));
+        }
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      ページ内のピクセルを取得します.
+//-----------------------------------------------------------------------------
+const uint8_t* GetTexel(const TextureAtlas& atlas, uint32_t page, uint32_t x, uint32_t y)
+{ return &atlas.GetPixels(page)[(y * atlas.GetWidth(page) + x) * 4]; }
+
+//-----------------------------------------------------------------------------
+//      構築結果を検証します.
+//
+//      パディングを含む矩形がページ内に収まって重ならないこと，
+//      画素とパディングが元画像と一致すること，UVが元画像のテクセルを指すことを確認します.
+//-----------------------------------------------------------------------------
+void CheckAtlas(const TextureAtlas& atlas, const std::vector<Image>& images)
+{
+    CHECK_EQ(atlas.GetEntryCount(), uint32_t(images.size()));
+
+    for(auto i=0u; i<atlas.GetEntryCount(); ++i)
+    {
+        auto& a = atlas.GetEntry(i);
+        CHECK(a.Page < atlas.GetPageCount());
+        CHECK_EQ(a.Rect.W, images[i].Width);
+        CHECK_EQ(a.Rect.H, images[i].Height);
+        CHECK(a.Rect.X >= kPadding && a.Rect.Y >= kPadding);
+        CHECK(a.Rect.X + a.Rect.W + kPadding <= atlas.GetWidth (a.Page));
+        CHECK(a.Rect.Y + a.Rect.H + kPadding <= atlas.GetHeight(a.Page));
+
+        for(auto j=i + 1; j<atlas.GetEntryCount(); ++j)
+        {
+            auto& b = atlas.GetEntry(j);
+            if (a.Page != b.Page)
+            { continue; }
+
+            auto overlap = a.Rect.X < b.Rect.X + b.Rect.W + kPadding * 2
+                        && b.Rect.X < a.Rect.X + a.Rect.W + kPadding * 2
+                        && a.Rect.Y < b.Rect.Y + b.Rect.H + kPadding * 2
+                        && b.Rect.Y < a.Rect.Y + a.Rect.H + kPadding * 2;
+            CHECK(!overlap);
+            if (overlap)
+            { fprintf(stderr, "  entry %u and %u overlap.\n", i, j); }
+        }
+    }
+
+    for(auto i=0u; i<atlas.GetEntryCount(); ++i)
+    {
+        auto& entry = atlas.GetEntry(i);
+        auto& image = images[i];
+        auto  pageW = float(atlas.GetWidth (entry.Page));
+        auto  pageH = float(atlas.GetHeight(entry.Page));
+
+        auto mismatch = 0u;
+        for(auto y=-int(kPadding); y<int(image.Height + kPadding); ++y)
+        {
+            for(auto x=-int(kPadding); x<int(image.Width + kPadding); ++x)
+            {
+                // パディングは端のピクセルを引き延ばしたもの.
+                auto sx = std::min(std::max(x, 0), int(image.Width  - 1));
+                auto sy = std::min(std::max(y, 0), int(image.Height - 1));
+                auto pSrc = &image.Pixels[(sy * image.Width + sx) * 4];
+                auto pDst = GetTexel(atlas, entry.Page, entry.Rect.X + x, entry.Rect.Y + y);
+                if (memcmp(pSrc, pDst, 4) != 0)
+                { mismatch++; }
+            }
+        }
+        CHECK_EQ(mismatch, 0u);
+
+        // 元画像のテクセル中心を変換したUVが，アトラス上で同じテクセルを指すこと.
+        for(auto y=0u; y<image.Height; ++y)
+        {
+            for(auto x=0u; x<image.Width; ++x)
+            {
+                float u, v;
+                RemapTexCoord(entry.TexRect,
+                    (float(x) + 0.5f) / float(image.Width),
+                    (float(y) + 0.5f) / float(image.Height), u, v);
+
+                auto tx = uint32_t(std::floor(u * pageW));
+                auto ty = uint32_t(std::floor(v * pageH));
+                auto pSrc = &image.Pixels[(y * image.Width + x) * 4];
+                if (tx >= uint32_t(pageW) || ty >= uint32_t(pageH)
+                 || memcmp(pSrc, GetTexel(atlas, entry.Page, tx, ty), 4) != 0)
+                { mismatch++; }
+            }
+        }
+        CHECK_EQ(mismatch, 0u);
+    }
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("TextureAtlas : random images", []
+    {
+        asdx::PCG rng(42);
+        std::vector<Image> images;
+        for(auto i=0u; i<120; ++i)
+        { images.push_back(MakeImage(i, 1 + rng.GetAsU32() % 64, 1 + rng.GetAsU32() % 64)); }
+
+        TextureAtlas atlas;
+        for(auto& image : images)
+        { atlas.Add(image.Width, image.Height, image.Width * 4, image.Pixels.data()); }
+
+        CHECK(atlas.Build(kPadding, 4096));
+        CHECK_EQ(atlas.GetPageCount(), 1u);
+        CheckAtlas(atlas, images);
+    });
+
+    RunTest("TextureAtlas : pitch", []
+    {
+        // 行末に余白がある画像でも，余白は書き込まれない.
+        auto image = MakeImage(7, 10, 6);
+        std::vector<uint8_t> padded(64 * 6, 0xee);
+        for(auto y=0u; y<6; ++y)
+        { memcpy(&padded[y * 64], &image.Pixels[y * 40], 40); }
+
+        TextureAtlas atlas;
+        atlas.Add(10, 6, 64, padded.data());
+        CHECK(atlas.Build(kPadding, 4096));
+        CheckAtlas(atlas, { image });
+    });
+
+    RunTest("TextureAtlas : spill to new page", []
+    {
+        // パディング込みで 104 x 104. 256 x 256 のページには 4 枚ずつ入る.
+        std::vector<Image> images;
+        for(auto i=0u; i<18; ++i)
+        { images.push_back(MakeImage(i, 100, 100)); }
+
+        TextureAtlas atlas;
+        for(auto& image : images)
+        { atlas.Add(image.Width, image.Height, image.Width * 4, image.Pixels.data()); }
+
+        CHECK(atlas.Build(kPadding, 256));
+        CHECK_EQ(atlas.GetPageCount(), 5u);
+        CheckAtlas(atlas, images);
+
+        auto total = 0u;
+        for(auto i=0u; i<atlas.GetPageCount(); ++i)
+        {
+            auto report = atlas.GetReport(i);
+            CHECK(report.Width  <= 256);
+            CHECK(report.Height <= 256);
+            total += report.ImageCount;
+        }
+        CHECK_EQ(total, 18u);
+
+        // 最後のページは残りの 2 枚が収まる大きさまで縮める.
+        auto last = atlas.GetReport(atlas.GetPageCount() - 1);
+        CHECK_EQ(last.ImageCount, 2u);
+        CHECK_EQ(last.Width,  256u);
+        CHECK_EQ(last.Height, 128u);
+    });
+
+    RunTest("TextureAtlas : image larger than page", []
+    {
+        auto image = MakeImage(0, 253, 8);
+
+        TextureAtlas atlas;
+        atlas.Add(image.Width, image.Height, image.Width * 4, image.Pixels.data());
+        CHECK(!atlas.Build(kPadding, 256));
+        CHECK_EQ(atlas.GetPageCount(), 0u);
+        CHECK_EQ(atlas.GetEntryCount(), 0u);
+
+        // 空なら成功扱い.
+        atlas.Reset();
+        CHECK(atlas.Build(kPadding, 256));
+        CHECK_EQ(atlas.GetPageCount(), 0u);
+    });
+
+    RunTest("TextureAtlas : report", []
+    {
+        auto image = MakeImage(0, 60, 60);
+
+        TextureAtlas atlas;
+        atlas.Add(image.Width, image.Height, image.Width * 4, image.Pixels.data());
+        CHECK(atlas.Build(kPadding, 4096));
+
+        auto report = atlas.GetReport(0);
+        CHECK_EQ(report.Width,        64u);
+        CHECK_EQ(report.Height,       64u);
+        CHECK_EQ(report.ImageCount,   1u);
+        CHECK_EQ(report.ImagePixels,  3600u);
+        CHECK_EQ(report.PackedPixels, 4096u);
+        CHECK(std::fabs(report.Occupancy - 3600.0f / 4096.0f) < 1e-6f);
+
+        // 複数ページでも各ページの値が画像とパディングの合計に一致する.
+        std::vector<Image> images;
+        asdx::PCG rng(7);
+        for(auto i=0u; i<200; ++i)
+        { images.push_back(MakeImage(i, 8 + rng.GetAsU32() % 56, 8 + rng.GetAsU32() % 56)); }
+
+        atlas.Reset();
+        for(auto& item : images)
+        { atlas.Add(item.Width, item.Height, item.Width * 4, item.Pixels.data()); }
+        CHECK(atlas.Build(kPadding, 256));
+        CHECK(atlas.GetPageCount() > 1);
+        CheckAtlas(atlas, images);
+
+        uint64_t imagePixels  = 0;
+        uint64_t packedPixels = 0;
+        for(auto& item : images)
+        {
+            imagePixels  += item.Width * item.Height;
+            packedPixels += (item.Width + kPadding * 2) * (item.Height + kPadding * 2);
+        }
+
+        uint64_t sumImage  = 0;
+        uint64_t sumPacked = 0;
+        for(auto i=0u; i<atlas.GetPageCount(); ++i)
+        {
+            auto page = atlas.GetReport(i);
+            sumImage  += page.ImagePixels;
+            sumPacked += page.PackedPixels;
+            CHECK(page.PackedPixels <= uint64_t(page.Width) * page.Height);
+            CHECK(std::fabs(page.Occupancy - float(double(page.ImagePixels) / (double(page.Width) * page.Height))) < 1e-6f);
+        }
+        CHECK_EQ(sumImage,  imagePixels);
+        CHECK_EQ(sumPacked, packedPixels);
+    });
+
+    return TestResult();
+}
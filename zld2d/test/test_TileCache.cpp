@@ -0,0 +1,268 @@
+﻿//-----------------------------------------------------------------------------
+// File : test_TileCache.cpp
+// Desc : Tests for Pre-Expanded Tile Layer Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TestCommon.h>
+#include <TileCache.h>
+#include <asdxMath.h>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kPaletteCount = 4;    // 0,1 : 移動可能. 2,3 : 移動不可.
+
+
+//-----------------------------------------------------------------------------
+//      テクスチャ番号毎に別の領域を返します.
+//-----------------------------------------------------------------------------
+const TextureRegion& ResolveTexture(uint32_t textureId)
+{
+    static TextureRegion s_Regions[kPaletteCount] = {
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(0), 0.00f, 0.0f, 0.25f, 1.0f),
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(0), 0.25f, 0.0f, 0.50f, 1.0f),
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(1), 0.00f, 0.0f, 1.00f, 1.0f),
+        TextureRegion(FakePointer<ID3D11ShaderResourceView>(2), 0.50f, 0.5f, 1.00f, 1.0f),
+    };
+    return s_Regions[textureId % kPaletteCount];
+}
+
+//-----------------------------------------------------------------------------
+//      パレットを作ります. テクスチャ番号はパレット番号と同じにします.
+//-----------------------------------------------------------------------------
+void MakePalette(Tile* pPalette)
+{
+    for(auto i=0u; i<kPaletteCount; ++i)
+    {
+        pPalette[i] = Tile();
+        pPalette[i].TextureId = uint8_t(i);
+        pPalette[i].Moveable  = (i < 2);
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      外周が壁で，内側にランダムな障害物がある部屋を作ります.
+//-----------------------------------------------------------------------------
+void MakeRoom(asdx::PCG& rng, uint8_t* pIndices)
+{
+    for(auto y=0u; y<kTileCountY; ++y)
+    {
+        for(auto x=0u; x<kTileCountX; ++x)
+        {
+            auto edge = (x == 0 || y == 0 || x == kTileCountX - 1u || y == kTileCountY - 1u);
+            auto wall = edge || (rng.GetAsU32() % 5 == 0);
+            pIndices[x + y * kTileCountX] = uint8_t((wall ? 2 : 0) + rng.GetAsU32() % 2);
+        }
+    }
+
+    // 障害物の無い行も作っておく(外周の左右は壁のまま).
+    for(auto x=1u; x<kTileCountX - 1u; ++x)
+    { pIndices[x + 4 * kTileCountX] = 0; }
+}
+
+//-----------------------------------------------------------------------------
+//      キャッシュの範囲と中身がタイルと一致することを確認します.
+//-----------------------------------------------------------------------------
+void CheckRanges(const TileCache& cache, const TileLayer& layer)
+{
+    auto& ranges     = cache.GetRanges();
+    auto  pInstances = cache.GetInstances();
+    auto  pTextures  = cache.GetTextures();
+
+    // 先頭は移動可能タイルの範囲.
+    auto moveable = 0u;
+    for(auto i=0u; i<kTileTotalCount; ++i)
+    {
+        if (layer.GetTile(i).Moveable)
+        { moveable++; }
+    }
+
+    CHECK(!ranges.empty());
+    CHECK(!ranges[0].Obstacle);
+    CHECK_EQ(ranges[0].Start, 0u);
+    CHECK_EQ(ranges[0].Count, moveable);
+
+    // 以降は障害物のある行毎の範囲. 障害物の無い行は範囲を作らない.
+    auto next  = 1u;
+    auto start = moveable;
+    for(auto row=0u; row<kTileCountY; ++row)
+    {
+        auto count = 0u;
+        for(auto col=0u; col<kTileCountX; ++col)
+        {
+            if (!layer.GetTile(row * kTileCountX + col).Moveable)
+            { count++; }
+        }
+
+        if (count == 0)
+        { continue; }
+
+        CHECK(next < ranges.size());
+        if (next >= ranges.size())
+        { return; }
+
+        auto& range = ranges[next++];
+        CHECK(range.Obstacle);
+        CHECK_EQ(range.Start, start);
+        CHECK_EQ(range.Count, count);
+        CHECK_EQ(range.Y, kTileOffsetY + kTileSize * int(row));
+        start += count;
+    }
+    CHECK_EQ(next, uint32_t(ranges.size()));
+    CHECK_EQ(start, kTileTotalCount);
+
+    // 各スプライトの位置とテクスチャがタイルと一致すること.
+    auto mismatch = 0u;
+    for(auto& range : ranges)
+    {
+        for(auto i=range.Start; i<range.Start + range.Count; ++i)
+        {
+            auto& sprite = pInstances[i];
+            auto  col    = uint32_t(sprite.Rect[0] - kTileOffsetX) / kTileSize;
+            auto  row    = uint32_t(sprite.Rect[1] - kTileOffsetY) / kTileSize;
+            auto& tile   = layer.GetTile(row * kTileCountX + col);
+            auto& region = ResolveTexture(tile.TextureId);
+
+            if (tile.Moveable == range.Obstacle
+             || (range.Obstacle && sprite.Rect[1] != range.Y)
+             || sprite.Rect[2] != kTileSize
+             || sprite.Rect[3] != kTileSize
+             || sprite.TexRect[0] != QuantizeUnorm16(region.TexRect[0])
+             || sprite.TexRect[3] != QuantizeUnorm16(region.TexRect[3])
+             || pTextures[i] != region.pSRV)
+            { mismatch++; }
+        }
+    }
+    CHECK_EQ(mismatch, 0u);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main()
+{
+    RunTest("TileCache : build once", []
+    {
+        asdx::PCG rng(1);
+        Tile    palette[kPaletteCount];
+        uint8_t indices[kTileTotalCount];
+        MakePalette(palette);
+        MakeRoom(rng, indices);
+
+        TileLayer layer;
+        layer.Init(indices, palette, kPaletteCount);
+
+        TileCache cache;
+        CHECK(cache.IsDirty());
+        CHECK_EQ(cache.GetBuildCount(), 0u);
+
+        cache.Build(layer, ResolveTexture);
+        CHECK(!cache.IsDirty());
+        CHECK_EQ(cache.GetBuildCount(), 1u);
+        CheckRanges(cache, layer);
+
+        // 無効にしていなければ何度呼んでも作り直さない.
+        auto pInstances = cache.GetInstances();
+        for(auto i=0; i<10; ++i)
+        { cache.Build(layer, ResolveTexture); }
+        CHECK_EQ(cache.GetBuildCount(), 1u);
+        CHECK(cache.GetInstances() == pInstances);
+    });
+
+    RunTest("TileCache : invalidate", []
+    {
+        asdx::PCG rng(2);
+        Tile    palette[kPaletteCount];
+        uint8_t indices[kTileTotalCount];
+        MakePalette(palette);
+        MakeRoom(rng, indices);
+
+        TileLayer layer;
+        layer.Init(indices, palette, kPaletteCount);
+
+        TileCache cache;
+        cache.Build(layer, ResolveTexture);
+
+        auto moveable = cache.GetRanges()[0].Count;
+
+        // 障害物の無い行に壁を置き，外周の壁を1つ床にする.
+        CHECK(layer.GetTile(1 + 4 * kTileCountX).Moveable);
+        CHECK(!layer.GetTile(0).Moveable);
+        layer.SetIndex(1 + 4 * kTileCountX, 3);
+        layer.SetIndex(2 + 4 * kTileCountX, 2);
+        layer.SetIndex(0, 1);
+
+        // 無効にするまでは古いまま.
+        cache.Build(layer, ResolveTexture);
+        CHECK_EQ(cache.GetBuildCount(), 1u);
+        CHECK_EQ(cache.GetRanges()[0].Count, moveable);
+
+        cache.Invalidate();
+        CHECK(cache.IsDirty());
+        cache.Build(layer, ResolveTexture);
+        CHECK(!cache.IsDirty());
+        CHECK_EQ(cache.GetBuildCount(), 2u);
+        CHECK_EQ(cache.GetRanges()[0].Count, moveable - 1);
+        CheckRanges(cache, layer);
+
+        cache.Build(layer, ResolveTexture);
+        CHECK_EQ(cache.GetBuildCount(), 2u);
+    });
+
+    RunTest("TileCache : random rooms", []
+    {
+        asdx::PCG rng(3);
+        Tile palette[kPaletteCount];
+        MakePalette(palette);
+
+        TileCache cache;
+        for(auto trial=0u; trial<100; ++trial)
+        {
+            uint8_t indices[kTileTotalCount];
+            MakeRoom(rng, indices);
+
+            TileLayer layer;
+            layer.Init(indices, palette, kPaletteCount);
+
+            cache.Invalidate();
+            cache.Build(layer, ResolveTexture);
+            CheckRanges(cache, layer);
+        }
+        CHECK_EQ(cache.GetBuildCount(), 100u);
+    });
+
+    RunTest("TileCache : all walls", []
+    {
+        Tile    palette[kPaletteCount];
+        uint8_t indices[kTileTotalCount];
+        MakePalette(palette);
+        for(auto& index : indices)
+        { index = 2; }
+
+        TileLayer layer;
+        layer.Init(indices, palette, kPaletteCount);
+
+        // 移動可能タイルが無ければ行の範囲だけになる.
+        TileCache cache;
+        cache.Build(layer, ResolveTexture);
+        CHECK_EQ(uint32_t(cache.GetRanges().size()), kTileCountY);
+        for(auto& range : cache.GetRanges())
+        {
+            CHECK(range.Obstacle);
+            CHECK_EQ(range.Count, kTileCountX);
+        }
+    });
+
+    return TestResult();
+}
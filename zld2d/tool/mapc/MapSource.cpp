@@ -0,0 +1,617 @@
+﻿//-----------------------------------------------------------------------------
+// File : MapSource.cpp
+// Desc : Text Sources for Map Compiler.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MapSource.h>
+#include <TextureId.h>
+#include <DirectionState.h>
+#include <asdxLogger.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t   kMaxLineLength  = 1024;     // 1行の最大文字数.
+static const uint32_t   kMaxTokens      = 8;        // 1行の最大項目数.
+static const uint32_t   kDirCount       = 4;        // DIRECTION_LEFT ～ DIRECTION_DOWN.
+
+// 方向名. DIRECTION_STATE の順.
+static const char* kDirNames[] = {
+    "left",
+    "right",
+    "up",
+    "down",
+    "none",
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// TextFile class
+///////////////////////////////////////////////////////////////////////////////
+class TextFile
+{
+public:
+    TextFile(const char* path)
+    {
+        auto err = fopen_s(&m_pFile, path, "r");
+        if (err != 0)
+        { m_pFile = nullptr; }
+    }
+
+    ~TextFile()
+    {
+        if (m_pFile != nullptr)
+        { fclose(m_pFile); }
+    }
+
+    bool IsOpen() const
+    { return m_pFile != nullptr; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      1行読み込みます. UTF-8 BOM と改行は取り除きます.
+    //-------------------------------------------------------------------------
+    bool ReadLine()
+    {
+        if (fgets(m_Line, kMaxLineLength, m_pFile) == nullptr)
+        { return false; }
+
+        m_LineNo++;
+        m_pHead = m_Line;
+        if (m_LineNo == 1 && strncmp(m_pHead, "\xEF\xBB\xBF", 3) == 0)
+        { m_pHead += 3; }
+
+        auto len = strlen(m_pHead);
+        while(len > 0 && (m_pHead[len - 1] == '\n' || m_pHead[len - 1] == '\r'))
+        { m_pHead[--len] = '\0'; }
+
+        return true;
+    }
+
+    char* GetLine() const
+    { return m_pHead; }
+
+    uint32_t GetLineNo() const
+    { return m_LineNo; }
+
+private:
+    FILE*       m_pFile  = nullptr;
+    char        m_Line[kMaxLineLength];
+    char*       m_pHead  = m_Line;
+    uint32_t    m_LineNo = 0;
+
+    TextFile            (const TextFile&) = delete;     // アクセス禁止.
+    TextFile& operator= (const TextFile&) = delete;     // アクセス禁止.
+};
+
+//-----------------------------------------------------------------------------
+//      区切り文字で分割します. 連続した区切りは1つとみなします.
+//-----------------------------------------------------------------------------
+uint32_t Split(char* line, char separator, char** tokens, uint32_t maxTokens)
+{
+    auto count = 0u;
+    auto head  = line;
+    while(count < maxTokens)
+    {
+        auto sep = strchr(head, separator);
+        if (sep != nullptr)
+        { *sep = '\0'; }
+
+        if (head[0] != '\0')
+        { tokens[count++] = head; }
+
+        if (sep == nullptr)
+        { break; }
+
+        head = sep + 1;
+    }
+
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//      行をハードタブで分割します. 空行とコメントは 0 を返却します.
+//-----------------------------------------------------------------------------
+uint32_t SplitLine(char* line, char** tokens)
+{
+    if (line[0] == '\0' || line[0] == '#')
+    { return 0; }
+
+    return Split(line, '\t', tokens, kMaxTokens);
+}
+
+//-----------------------------------------------------------------------------
+//      前後の空白を取り除きます.
+//-----------------------------------------------------------------------------
+char* Trim(char* text)
+{
+    while(*text == ' ')
+    { text++; }
+
+    auto len = strlen(text);
+    while(len > 0 && text[len - 1] == ' ')
+    { text[--len] = '\0'; }
+
+    return text;
+}
+
+//-----------------------------------------------------------------------------
+//      符号無し整数を読み取ります.
+//-----------------------------------------------------------------------------
+bool ParseUint(const char* text, uint32_t maxValue, uint32_t& result)
+{
+    char* end = nullptr;
+    auto value = strtoul(text, &end, 10);
+    if (end == text || *end != '\0' || value > maxValue)
+    { return false; }
+
+    result = uint32_t(value);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      方向名から方向を取得します.
+//-----------------------------------------------------------------------------
+uint32_t FindDir(const char* name, uint32_t count)
+{
+    for(auto i=0u; i<count; ++i)
+    {
+        if (strcmp(kDirNames[i], name) == 0)
+        { return i; }
+    }
+
+    return UINT32_MAX;
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャ名から TEXTURE_ID を取得します.
+//-----------------------------------------------------------------------------
+uint32_t FindTexture(const char* name)
+{
+    for(auto i=0u; i<TEXTURE_COUNT; ++i)
+    {
+        if (strcmp(kTextureNames[i], name) == 0)
+        { return i; }
+    }
+
+    return UINT32_MAX;
+}
+
+//-----------------------------------------------------------------------------
+//      ファイルと同じディレクトリのパスを求めます.
+//-----------------------------------------------------------------------------
+std::string GetSiblingPath(const char* path, const char* name)
+{
+    std::string result = path;
+    auto pos = result.find_last_of("/\\");
+    result = (pos == std::string::npos) ? std::string() : result.substr(0, pos + 1);
+    return result + name;
+}
+
+//-----------------------------------------------------------------------------
+//      部屋の境界にあるスクロールタイルの位置をビット列で求めます.
+//-----------------------------------------------------------------------------
+uint32_t GetEdgeMask(const RoomSource& room, uint32_t dir)
+{
+    auto mask = 0u;
+    switch(dir)
+    {
+    case DIRECTION_LEFT:
+    case DIRECTION_RIGHT:
+        {
+            auto x = (dir == DIRECTION_LEFT) ? 0u : kTileCountX - 1u;
+            for(auto y=0u; y<kTileCountY; ++y)
+            {
+                if (room.Tiles[y * kTileCountX + x].Scrollable)
+                { mask |= 1u << y; }
+            }
+        }
+        break;
+
+    case DIRECTION_UP:
+    case DIRECTION_DOWN:
+        {
+            auto y = (dir == DIRECTION_UP) ? 0u : kTileCountY - 1u;
+            for(auto x=0u; x<kTileCountX; ++x)
+            {
+                if (room.Tiles[y * kTileCountX + x].Scrollable)
+                { mask |= 1u << x; }
+            }
+        }
+        break;
+    }
+
+    return mask;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// RoomParser class
+///////////////////////////////////////////////////////////////////////////////
+class RoomParser
+{
+public:
+    RoomParser(const char* path, RoomSource& result)
+    : m_Path  (path)
+    , m_Result(result)
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      部屋ソースを読み込みます.
+    //-------------------------------------------------------------------------
+    bool Parse()
+    {
+        m_Result.Gimmicks.clear();
+        m_Result.Depends.clear();
+        m_Result.Depends.push_back(m_Path);
+
+        TextFile file(m_Path);
+        if (!file.IsOpen())
+        {
+            ELOGA("Error : File Open Failed. path = %s", m_Path);
+            return false;
+        }
+
+        char* tokens[kMaxTokens];
+        while(file.ReadLine())
+        {
+            m_LineNo = file.GetLineNo();
+
+            auto count = SplitLine(file.GetLine(), tokens);
+            if (count == 0)
+            { continue; }
+
+            auto ok = false;
+            if (strcmp(tokens[0], "tile") == 0 && count >= 3)
+            { ok = ParseTile(tokens + 1, count - 1); }
+            else if (strcmp(tokens[0], "row") == 0 && count == 2)
+            { ok = ParseRow(tokens[1]); }
+            else if (strcmp(tokens[0], "csv") == 0 && count == 2)
+            { ok = ParseCsv(tokens[1]); }
+            else if (strcmp(tokens[0], "gimmick") == 0 && (count == 6 || count == 8))
+            { ok = ParseGimmick(tokens + 1, count - 1); }
+            else
+            { Error("Invalid Line."); }
+
+            if (!ok)
+            { return false; }
+        }
+
+        if (m_RowCount != kTileCountY)
+        {
+            ELOGA("Error : Tile Rows Missing. path = %s, rows = %u / %u", m_Path, m_RowCount, kTileCountY);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    const char*                             m_Path;
+    RoomSource&                             m_Result;
+    std::unordered_map<std::string, Tile>   m_Palette;
+    uint32_t                                m_LineNo   = 0;
+    uint32_t                                m_RowCount = 0;
+    bool                                    m_UseCsv   = false;
+
+    //-------------------------------------------------------------------------
+    //! @brief      エラーを出力します.
+    //-------------------------------------------------------------------------
+    bool Error(const char* message, const char* detail = "")
+    {
+        ELOGA("Error : %s %s path = %s, line = %u", message, detail, m_Path, m_LineNo);
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      tile <記号> <テクスチャ名> [move] [scroll] [switch] [fall]
+    //-------------------------------------------------------------------------
+    bool ParseTile(char** tokens, uint32_t count)
+    {
+        auto texture = FindTexture(tokens[1]);
+        if (texture == UINT32_MAX)
+        { return Error("Unknown Texture.", tokens[1]); }
+
+        Tile tile = {};
+        tile.TextureId = uint8_t(texture);
+
+        for(auto i=2u; i<count; ++i)
+        {
+            if      (strcmp(tokens[i], "move")   == 0) { tile.Moveable   = true; }
+            else if (strcmp(tokens[i], "scroll") == 0) { tile.Scrollable = true; }
+            else if (strcmp(tokens[i], "switch") == 0) { tile.Switchable = true; }
+            else if (strcmp(tokens[i], "fall")   == 0) { tile.Fallable   = true; }
+            else
+            { return Error("Unknown Tile Flag.", tokens[i]); }
+        }
+
+        if (!m_Palette.emplace(tokens[0], tile).second)
+        { return Error("Duplicate Tile.", tokens[0]); }
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      1行分のタイルを設定します.
+    //-------------------------------------------------------------------------
+    bool SetRow(char** keys, uint32_t count)
+    {
+        if (m_RowCount >= kTileCountY)
+        { return Error("Too Many Tile Rows."); }
+
+        if (count != kTileCountX)
+        { return Error("Tile Row Length Mismatch."); }
+
+        for(auto x=0u; x<kTileCountX; ++x)
+        {
+            auto itr = m_Palette.find(keys[x]);
+            if (itr == m_Palette.end())
+            { return Error("Unknown Tile.", keys[x]); }
+
+            m_Result.Tiles[m_RowCount * kTileCountX + x] = itr->second;
+        }
+
+        m_RowCount++;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      row <1文字の記号を kTileCountX 個>
+    //-------------------------------------------------------------------------
+    bool ParseRow(const char* text)
+    {
+        if (m_UseCsv)
+        { return Error("Cannot Mix row And csv."); }
+
+        char  keys[kTileCountX][2] = {};
+        char* ptrs[kTileCountX];
+
+        auto count = uint32_t(strlen(text));
+        if (count != kTileCountX)
+        { return Error("Tile Row Length Mismatch."); }
+
+        for(auto x=0u; x<kTileCountX; ++x)
+        {
+            keys[x][0] = text[x];
+            ptrs[x]    = keys[x];
+        }
+
+        return SetRow(ptrs, count);
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      csv <ファイル名>. 記号をカンマ区切りで kTileCountY 行並べたファイルです.
+    //-------------------------------------------------------------------------
+    bool ParseCsv(const char* name)
+    {
+        if (m_RowCount > 0)
+        { return Error("Cannot Mix row And csv."); }
+
+        auto path = GetSiblingPath(m_Path, name);
+        m_Result.Depends.push_back(path);
+        m_UseCsv = true;
+
+        TextFile file(path.c_str());
+        if (!file.IsOpen())
+        { return Error("CSV Open Failed.", path.c_str()); }
+
+        char* keys[kTileCountX + 1];
+        while(file.ReadLine())
+        {
+            auto line = file.GetLine();
+            if (line[0] == '\0')
+            { continue; }
+
+            // 空のセルも数えたいので，連続したカンマを1つにまとめる Split() は使わない.
+            auto count = 0u;
+            auto head  = line;
+            while(count <= kTileCountX)
+            {
+                auto comma = strchr(head, ',');
+                if (comma != nullptr)
+                { *comma = '\0'; }
+
+                keys[count++] = Trim(head);
+
+                if (comma == nullptr)
+                { break; }
+
+                head = comma + 1;
+            }
+
+            if (!SetRow(keys, count))
+            {
+                ELOGA("Error : Invalid CSV Row. path = %s, line = %u", path.c_str(), file.GetLineNo());
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      gimmick block <タイルX> <タイルY> <テクスチャ名> <方向> [幅 高さ]
+    //-------------------------------------------------------------------------
+    bool ParseGimmick(char** tokens, uint32_t count)
+    {
+        MapGimmickDesc desc = {};
+
+        if (strcmp(tokens[0], "block") == 0)
+        { desc.Type = MAP_GIMMICK_BLOCK; }
+        else
+        { return Error("Unknown Gimmick.", tokens[0]); }
+
+        uint32_t x, y;
+        if (!ParseUint(tokens[1], kTileCountX - 1, x) || !ParseUint(tokens[2], kTileCountY - 1, y))
+        { return Error("Gimmick Position Out Of Range."); }
+
+        auto texture = FindTexture(tokens[3]);
+        if (texture == UINT32_MAX)
+        { return Error("Unknown Texture.", tokens[3]); }
+
+        auto dir = FindDir(tokens[4], DIRECTION_NONE + 1);
+        if (dir == UINT32_MAX)
+        { return Error("Unknown Direction.", tokens[4]); }
+
+        uint32_t w = kTileSize;
+        uint32_t h = kTileSize;
+        if (count == 7 && (!ParseUint(tokens[5], UINT16_MAX, w) || !ParseUint(tokens[6], UINT16_MAX, h) || w == 0 || h == 0))
+        { return Error("Invalid Gimmick Size."); }
+
+        desc.TileX     = uint8_t(x);
+        desc.TileY     = uint8_t(y);
+        desc.Width     = uint16_t(w);
+        desc.Height    = uint16_t(h);
+        desc.TextureId = uint16_t(texture);
+        desc.Dir       = uint8_t(dir);
+        m_Result.Gimmicks.push_back(desc);
+        return true;
+    }
+};
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      部屋の接続ファイルを読み込みます.
+//-----------------------------------------------------------------------------
+bool LoadWorldSource(const char* path, WorldSource& result)
+{
+    result.Rooms.clear();
+    result.Links.clear();
+
+    TextFile file(path);
+    if (!file.IsOpen())
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    std::unordered_map<std::string, uint32_t> ids;
+    char* tokens[kMaxTokens];
+
+    while(file.ReadLine())
+    {
+        auto count = SplitLine(file.GetLine(), tokens);
+        if (count == 0)
+        { continue; }
+
+        if (strcmp(tokens[0], "root") == 0 && count == 2)
+        {
+            /* 実行時のパスなので使わない */
+        }
+        else if (strcmp(tokens[0], "room") == 0 && count == 3)
+        {
+            if (!ids.emplace(tokens[1], uint32_t(result.Rooms.size())).second)
+            {
+                ELOGA("Error : Duplicate Room. path = %s, line = %u", path, file.GetLineNo());
+                return false;
+            }
+
+            RoomEntry entry;
+            entry.Name = tokens[1];
+            entry.File = tokens[2];
+            result.Rooms.push_back(entry);
+        }
+        else if (strcmp(tokens[0], "link") == 0 && count == 4)
+        {
+            auto from = ids.find(tokens[1]);
+            auto to   = ids.find(tokens[3]);
+            auto dir  = FindDir(tokens[2], kDirCount);
+            if (from == ids.end() || to == ids.end() || dir == UINT32_MAX)
+            {
+                ELOGA("Error : Invalid Link. path = %s, line = %u", path, file.GetLineNo());
+                return false;
+            }
+
+            RoomLink link;
+            link.From = from->second;
+            link.Dir  = dir;
+            link.To   = to->second;
+            link.Line = file.GetLineNo();
+            result.Links.push_back(link);
+        }
+        else
+        {
+            ELOGA("Error : Invalid Line. path = %s, line = %u", path, file.GetLineNo());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      部屋ソースを読み込みます.
+//-----------------------------------------------------------------------------
+bool LoadRoomSource(const char* path, RoomSource& result)
+{
+    RoomParser parser(path, result);
+    return parser.Parse();
+}
+
+//-----------------------------------------------------------------------------
+//      接続した部屋同士で，境界のスクロールタイルの位置が揃っているか検証します.
+//-----------------------------------------------------------------------------
+bool ValidateLinks(const char* path, const WorldSource& world, const std::vector<RoomSource>& rooms, bool strictLinks)
+{
+    auto result = true;
+
+    // 実行時は後から書いた接続で上書きされるので，食い違う接続は誤りとして扱う.
+    std::vector<uint32_t> links(world.Rooms.size() * kDirCount, UINT32_MAX);
+    for(auto& link : world.Links)
+    {
+        auto& forward = links[link.From * kDirCount + link.Dir];
+        auto& reverse = links[link.To   * kDirCount + (link.Dir ^ 1)];
+        if ((forward != UINT32_MAX && forward != link.To) || (reverse != UINT32_MAX && reverse != link.From))
+        {
+            ELOGA("Error : Conflicting Link. path = %s, line = %u", path, link.Line);
+            result = false;
+        }
+
+        forward = link.To;
+        reverse = link.From;
+
+        auto from = GetEdgeMask(rooms[link.From], link.Dir);
+        auto to   = GetEdgeMask(rooms[link.To],   link.Dir ^ 1);
+        if (from == 0 || from != to)
+        {
+            ELOGA("Error : Edge Mismatch. %s %s -> %s, edge = 0x%x / 0x%x, path = %s, line = %u",
+                world.Rooms[link.From].Name.c_str(),
+                kDirNames[link.Dir],
+                world.Rooms[link.To].Name.c_str(),
+                from, to, path, link.Line);
+            result = false;
+        }
+    }
+
+    // 接続の無い境界にスクロールタイルがあっても実行時は部屋に留まるだけなので，警告に留める.
+    // 接続の書き忘れを出力前に止めたい場合は strictLinks で誤りとして扱う.
+    for(auto i=0u; i<world.Rooms.size(); ++i)
+    {
+        for(auto dir=0u; dir<kDirCount; ++dir)
+        {
+            if (links[i * kDirCount + dir] != UINT32_MAX || GetEdgeMask(rooms[i], dir) == 0)
+            { continue; }
+
+            if (!strictLinks)
+            {
+                WLOGA("Warning : Scroll Tile Without Link. %s %s", world.Rooms[i].Name.c_str(), kDirNames[dir]);
+                continue;
+            }
+
+            ELOGA("Error : Scroll Tile Without Link. %s %s", world.Rooms[i].Name.c_str(), kDirNames[dir]);
+            result = false;
+        }
+    }
+
+    return result;
+}
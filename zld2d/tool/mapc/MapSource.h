@@ -0,0 +1,90 @@
+﻿//-----------------------------------------------------------------------------
+// File : MapSource.h
+// Desc : Text Sources for Map Compiler.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <MapFormat.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RoomEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct RoomEntry
+{
+    std::string     Name;       //!< 部屋名.
+    std::string     File;       //!< 出力するマップファイル名.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RoomLink structure
+///////////////////////////////////////////////////////////////////////////////
+struct RoomLink
+{
+    uint32_t        From;       //!< 接続元の部屋番号.
+    uint32_t        Dir;        //!< 方向(DIRECTION_STATE).
+    uint32_t        To;         //!< 接続先の部屋番号.
+    uint32_t        Line;       //!< 定義した行番号.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// WorldSource structure
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      部屋の接続ファイル(res/map/world.txt)の内容です.
+///////////////////////////////////////////////////////////////////////////////
+struct WorldSource
+{
+    std::vector<RoomEntry>  Rooms;
+    std::vector<RoomLink>   Links;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RoomSource structure
+///////////////////////////////////////////////////////////////////////////////
+//! @brief      部屋ソースの内容です.
+//!
+//! @note       書式は res/map/src/room_000.room を参照してください.
+///////////////////////////////////////////////////////////////////////////////
+struct RoomSource
+{
+    Tile                        Tiles[kTileTotalCount];     //!< タイル.
+    std::vector<MapGimmickDesc> Gimmicks;                   //!< ギミックの配置.
+    std::vector<std::string>    Depends;                    //!< 読み込んだファイル. 更新の判定に使います.
+};
+
+
+//-----------------------------------------------------------------------------
+//! @brief      部屋の接続ファイルを読み込みます.
+//!
+//! @note       root は実行時のパスなので読み飛ばします.
+//-----------------------------------------------------------------------------
+bool LoadWorldSource(const char* path, WorldSource& result);
+
+//-----------------------------------------------------------------------------
+//! @brief      部屋ソースを読み込みます.
+//!
+//! @note       別スレッドから同時に呼び出せます. エラーはファイル名と行番号を付けて出力します.
+//-----------------------------------------------------------------------------
+bool LoadRoomSource(const char* path, RoomSource& result);
+
+//-----------------------------------------------------------------------------
+//! @brief      接続した部屋同士で，境界のスクロールタイルの位置が揃っているか検証します.
+//!
+//! @param[in]      path        部屋の接続ファイル. エラーの出力に使います.
+//! @param[in]      world       部屋の接続.
+//! @param[in]      rooms       部屋ソース. world.Rooms と同じ順番です.
+//! @param[in]      strictLinks 接続の無い境界のスクロールタイルを誤りとして扱うかどうか. 偽なら警告に留めます.
+//! @retval true    揃っている.
+//! @retval false   揃っていない接続がある. strictLinks が真なら，接続の無い境界のスクロールタイルも含みます.
+//-----------------------------------------------------------------------------
+bool ValidateLinks(const char* path, const WorldSource& world, const std::vector<RoomSource>& rooms, bool strictLinks);
@@ -0,0 +1,32 @@
+﻿//-----------------------------------------------------------------------------
+// File : asdxMath.h
+// Desc : Math for Map Compiler.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+
+// asdx11 は Windows 専用なので，マップコンパイラではランタイムのヘッダが使う分だけここで用意する.
+namespace asdx {
+
+template<typename T> inline T Min(T a, T b)
+{ return (a < b) ? a : b; }
+
+template<typename T> inline T Max(T a, T b)
+{ return (a > b) ? a : b; }
+
+template<typename T> inline T Clamp(T value, T mini, T maxi)
+{ return Max(mini, Min(maxi, value)); }
+
+// DirectionState.h の RollDice() が参照するだけで，マップコンパイラでは使わない.
+class PCG
+{
+public:
+    uint32_t GetAsU32();
+};
+
+} // namespace asdx
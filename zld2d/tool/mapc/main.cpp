@@ -0,0 +1,235 @@
+﻿//-----------------------------------------------------------------------------
+// File : main.cpp
+// Desc : Map Compiler.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MapSource.h>
+#include <MapFormat.h>
+#include <asdxLogger.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Type Alias.
+//-----------------------------------------------------------------------------
+namespace fs = std::filesystem;
+
+///////////////////////////////////////////////////////////////////////////////
+// Option structure
+///////////////////////////////////////////////////////////////////////////////
+struct Option
+{
+    const char*     WorldPath = nullptr;    // 部屋の接続ファイル.
+    std::string     SourceDir;              // 部屋ソースのディレクトリ.
+    std::string     OutputDir;              // マップファイルの出力先.
+    uint32_t        JobCount  = 0;          // 0 ならハードウェアスレッド数.
+    bool            Force     = false;      // 更新が無くても全て書き出すかどうか.
+    bool            Strict    = false;      // 接続の無い境界のスクロールタイルを誤りとして扱うかどうか.
+};
+
+//-----------------------------------------------------------------------------
+//      使い方を表示します.
+//-----------------------------------------------------------------------------
+void PrintUsage()
+{
+    fprintf(stderr,
+        "usage : mapc [-j jobs] [-f] [-e] [-s srcdir] [-o outdir] <world.txt>\n"
+        "  -j jobs    number of worker threads (default: hardware threads)\n"
+        "  -f         rebuild every room even if it is up to date\n"
+        "  -e         treat scroll tiles without a link as errors, not warnings\n"
+        "  -s srcdir  directory of <room>.room sources (default: <world dir>/src)\n"
+        "  -o outdir  directory of .map outputs (default: <world dir>)\n");
+}
+
+//-----------------------------------------------------------------------------
+//      コマンドライン引数を解析します.
+//-----------------------------------------------------------------------------
+bool ParseOption(int argc, char** argv, Option& option)
+{
+    for(auto i=1; i<argc; ++i)
+    {
+        auto arg     = argv[i];
+        auto hasNext = (i + 1 < argc);
+
+        if (strcmp(arg, "-j") == 0 && hasNext)
+        {
+            option.JobCount = uint32_t(strtoul(argv[++i], nullptr, 10));
+            if (option.JobCount == 0)
+            { return false; }
+        }
+        else if (strcmp(arg, "-f") == 0)
+        { option.Force = true; }
+        else if (strcmp(arg, "-e") == 0)
+        { option.Strict = true; }
+        else if (strcmp(arg, "-s") == 0 && hasNext)
+        { option.SourceDir = argv[++i]; }
+        else if (strcmp(arg, "-o") == 0 && hasNext)
+        { option.OutputDir = argv[++i]; }
+        else if (arg[0] != '-' && option.WorldPath == nullptr)
+        { option.WorldPath = arg; }
+        else
+        { return false; }
+    }
+
+    if (option.WorldPath == nullptr)
+    { return false; }
+
+    auto dir = fs::path(option.WorldPath).parent_path();
+    if (option.SourceDir.empty())
+    { option.SourceDir = (dir / "src").string(); }
+    if (option.OutputDir.empty())
+    { option.OutputDir = dir.string(); }
+
+    if (option.JobCount == 0)
+    { option.JobCount = std::max(1u, std::thread::hardware_concurrency()); }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      0 ～ count-1 を複数スレッドで処理します.
+//-----------------------------------------------------------------------------
+void ParallelFor(uint32_t count, uint32_t jobCount, const std::function<void(uint32_t)>& func)
+{
+    // 部屋ごとの処理時間はほぼ同じなので，番号を1つずつ取り合うだけで偏らない.
+    std::atomic<uint32_t> next(0);
+    auto worker = [&]()
+    {
+        for(auto i = next++; i < count; i = next++)
+        { func(i); }
+    };
+
+    auto threadCount = std::min(jobCount, count);
+    std::vector<std::thread> threads;
+    for(auto i=1u; i<threadCount; ++i)
+    { threads.emplace_back(worker); }
+
+    worker();
+
+    for(auto& thread : threads)
+    { thread.join(); }
+}
+
+//-----------------------------------------------------------------------------
+//      出力が古いかどうか? 出力が無いか，読み込んだファイルより古ければ真.
+//-----------------------------------------------------------------------------
+bool IsStale(const std::string& output, const std::vector<std::string>& depends)
+{
+    std::error_code err;
+    auto time = fs::last_write_time(output, err);
+    if (err)
+    { return true; }
+
+    for(auto& depend : depends)
+    {
+        auto dependTime = fs::last_write_time(depend, err);
+        if (err || dependTime > time)
+        { return true; }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      マップファイルを書き出します. 途中で失敗しても古い出力を壊さないよう，一時ファイルから置き換えます.
+//-----------------------------------------------------------------------------
+bool WriteRoom(const std::string& output, const RoomSource& room)
+{
+    auto temp = output + ".tmp";
+    if (!WriteMapFile(temp.c_str(), room.Tiles, room.Gimmicks.data(), uint32_t(room.Gimmicks.size()), true))
+    { return false; }
+
+    std::error_code err;
+    fs::rename(temp, output, err);
+    if (err)
+    {
+        ELOGA("Error : File Rename Failed. path = %s", output.c_str());
+        fs::remove(temp, err);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      メインエントリーポイントです.
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    Option option;
+    if (!ParseOption(argc, argv, option))
+    {
+        PrintUsage();
+        return EXIT_FAILURE;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+
+    WorldSource world;
+    if (!LoadWorldSource(option.WorldPath, world))
+    { return EXIT_FAILURE; }
+
+    auto roomCount = uint32_t(world.Rooms.size());
+    std::vector<RoomSource>  rooms  (roomCount);
+    std::vector<std::string> outputs(roomCount);
+    std::vector<uint8_t>     results(roomCount, 0);     // vector<bool> は別スレッドから書けないので uint8_t.
+
+    for(auto i=0u; i<roomCount; ++i)
+    { outputs[i] = (fs::path(option.OutputDir) / world.Rooms[i].File).string(); }
+
+    // 接続の検証に全部屋が要るので，更新の有無に関わらず全て読み込む.
+    ParallelFor(roomCount, option.JobCount, [&](uint32_t i)
+    {
+        auto path = (fs::path(option.SourceDir) / (world.Rooms[i].Name + ".room")).string();
+        results[i] = LoadRoomSource(path.c_str(), rooms[i]);
+    });
+
+    auto failed = false;
+    for(auto i=0u; i<roomCount; ++i)
+    { failed |= (results[i] == 0); }
+
+    // 1つでも誤りがあれば何も書き出さない.
+    if (failed || !ValidateLinks(option.WorldPath, world, rooms, option.Strict))
+    { return EXIT_FAILURE; }
+
+    // 部屋の接続ファイルは出力に含まれないので，更新の判定には部屋ソースだけを使う.
+    std::vector<uint32_t> stale;
+    for(auto i=0u; i<roomCount; ++i)
+    {
+        if (option.Force || IsStale(outputs[i], rooms[i].Depends))
+        { stale.push_back(i); }
+    }
+
+    ParallelFor(uint32_t(stale.size()), option.JobCount, [&](uint32_t i)
+    {
+        auto index = stale[i];
+        results[index] = WriteRoom(outputs[index], rooms[index]);
+    });
+
+    for(auto index : stale)
+    { failed |= (results[index] == 0); }
+
+    auto end  = std::chrono::steady_clock::now();
+    auto msec = std::chrono::duration<double, std::milli>(end - begin).count();
+
+    ILOGA("mapc : %u rooms, %zu built, %zu up to date, %.1f ms (%u jobs)",
+        roomCount, stale.size(), roomCount - stale.size(), msec, option.JobCount);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}